@@ -0,0 +1,187 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLSegmentationNode.h"
+#include "vtkMRMLSegmentationStorageNode.h"
+
+// SegmentationCore includes
+#include "vtkBinaryLabelmapToClosedSurfaceConversionRule.h"
+#include "vtkClosedSurfaceToBinaryLabelmapConversionRule.h"
+#include "vtkSegmentationConverterFactory.h"
+
+// VTK includes
+#include <vtkMathUtilities.h>
+#include <vtkNew.h>
+#include <vtkPolyData.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+/// Load segmentation and add copies of all segments to have enough work items for the thread pool.
+/// Copies are deep, therefore each copy gets its own labelmap layer.
+bool LoadSegmentation(vtkMRMLScene* scene, const char* filename, int numberOfCopies, vtkMRMLSegmentationNode* segmentationNode)
+{
+  scene->AddNode(segmentationNode);
+  vtkNew<vtkMRMLSegmentationStorageNode> storageNode;
+  scene->AddNode(storageNode);
+  storageNode->SetFileName(filename);
+  if (!storageNode->ReadData(segmentationNode))
+    {
+    std::cerr << "Failed to read segmentation: " << filename << std::endl;
+    return false;
+    }
+  vtkSegmentation* segmentation = segmentationNode->GetSegmentation();
+  std::vector<std::string> segmentIDs;
+  segmentation->GetSegmentIDs(segmentIDs);
+  for (int copyIndex = 1; copyIndex < numberOfCopies; ++copyIndex)
+    {
+    for (const std::string& segmentID : segmentIDs)
+      {
+      vtkNew<vtkSegment> segmentCopy;
+      segmentCopy->DeepCopy(segmentation->GetSegment(segmentID));
+      std::stringstream copyID;
+      copyID << segmentID << "_" << copyIndex;
+      segmentation->AddSegment(segmentCopy, copyID.str());
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+double ConvertToClosedSurface(vtkSegmentation* segmentation, bool parallel,
+  std::vector<vtkSmartPointer<vtkPolyData> >& surfaces)
+{
+  segmentation->SetParallelConversion(parallel);
+  double startTime = vtkTimerLog::GetUniversalTime();
+  segmentation->CreateRepresentation(vtkSegmentationConverter::GetClosedSurfaceRepresentationName(), true);
+  double elapsedTime = vtkTimerLog::GetUniversalTime() - startTime;
+
+  surfaces.clear();
+  std::vector<std::string> segmentIDs;
+  segmentation->GetSegmentIDs(segmentIDs);
+  for (const std::string& segmentID : segmentIDs)
+    {
+    vtkSmartPointer<vtkPolyData> surface = vtkSmartPointer<vtkPolyData>::New();
+    surface->DeepCopy(segmentation->GetSegment(segmentID)->GetRepresentation(
+      vtkSegmentationConverter::GetClosedSurfaceRepresentationName()));
+    surfaces.push_back(surface);
+    }
+  return elapsedTime;
+}
+
+//----------------------------------------------------------------------------
+bool CompareSurfaces(const std::vector<vtkSmartPointer<vtkPolyData> >& surfaces1,
+  const std::vector<vtkSmartPointer<vtkPolyData> >& surfaces2)
+{
+  if (surfaces1.size() != surfaces2.size())
+    {
+    std::cerr << "Number of surfaces mismatch: " << surfaces1.size() << " != " << surfaces2.size() << std::endl;
+    return false;
+    }
+  for (size_t index = 0; index < surfaces1.size(); ++index)
+    {
+    vtkPolyData* surface1 = surfaces1[index];
+    vtkPolyData* surface2 = surfaces2[index];
+    double bounds1[6] = { 0.0, -1.0, 0.0, -1.0, 0.0, -1.0 };
+    double bounds2[6] = { 0.0, -1.0, 0.0, -1.0, 0.0, -1.0 };
+    surface1->GetBounds(bounds1);
+    surface2->GetBounds(bounds2);
+    if (surface1->GetNumberOfPoints() != surface2->GetNumberOfPoints()
+      || surface1->GetNumberOfPolys() != surface2->GetNumberOfPolys()
+      || !vtkMathUtilities::FuzzyCompare(bounds1[0], bounds2[0]) || !vtkMathUtilities::FuzzyCompare(bounds1[1], bounds2[1])
+      || !vtkMathUtilities::FuzzyCompare(bounds1[2], bounds2[2]) || !vtkMathUtilities::FuzzyCompare(bounds1[3], bounds2[3])
+      || !vtkMathUtilities::FuzzyCompare(bounds1[4], bounds2[4]) || !vtkMathUtilities::FuzzyCompare(bounds1[5], bounds2[5]))
+      {
+      std::cerr << "Surface " << index << " mismatch: " << surface1->GetNumberOfPoints() << " points, "
+        << surface1->GetNumberOfPolys() << " polys != " << surface2->GetNumberOfPoints() << " points, "
+        << surface2->GetNumberOfPolys() << " polys" << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool RunBenchmark(vtkSegmentation* segmentation, const std::string& name)
+{
+  std::vector<vtkSmartPointer<vtkPolyData> > sequentialSurfaces;
+  std::vector<vtkSmartPointer<vtkPolyData> > parallelSurfaces;
+  double sequentialTime = ConvertToClosedSurface(segmentation, false, sequentialSurfaces);
+  double parallelTime = ConvertToClosedSurface(segmentation, true, parallelSurfaces);
+  std::cout << name << ": " << segmentation->GetNumberOfSegments() << " segments, "
+    << segmentation->GetNumberOfLayers() << " layers, "
+    << vtkSMPTools::GetEstimatedNumberOfThreads() << " threads" << std::endl;
+  std::cout << "  sequential: " << sequentialTime << "s, parallel: " << parallelTime << "s, speedup: "
+    << (parallelTime > 0.0 ? sequentialTime / parallelTime : 0.0) << "x" << std::endl;
+  return CompareSurfaces(sequentialSurfaces, parallelSurfaces);
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkMRMLSegmentationConversionBenchmark(int argc, char * argv[])
+{
+  if (argc < 3)
+    {
+    std::cerr << "Line " << __LINE__
+              << " - Missing parameters !\n"
+              << "Usage: " << argv[0] << " /path/to/OldSlicerSegmentation.seg.nrrd /path/to/SlicerSegmentation.seg.nrrd [numberOfCopies]"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+  int numberOfCopies = (argc > 3 ? atoi(argv[3]) : 8);
+
+  vtkSegmentationConverterFactory* converterFactory = vtkSegmentationConverterFactory::GetInstance();
+  converterFactory->RegisterConverterRule(vtkSmartPointer<vtkBinaryLabelmapToClosedSurfaceConversionRule>::New());
+  converterFactory->RegisterConverterRule(vtkSmartPointer<vtkClosedSurfaceToBinaryLabelmapConversionRule>::New());
+
+  vtkNew<vtkMRMLScene> scene;
+
+  // Segmentation with a separate labelmap for each segment
+  {
+  vtkNew<vtkMRMLSegmentationNode> segmentationNode;
+  CHECK_BOOL(LoadSegmentation(scene, argv[1], numberOfCopies, segmentationNode), true);
+  CHECK_BOOL(RunBenchmark(segmentationNode->GetSegmentation(), "Separate labelmaps"), true);
+  }
+
+  // Segmentation with shared labelmaps, joint smoothing computes one surface per layer
+  {
+  vtkNew<vtkMRMLSegmentationNode> segmentationNode;
+  CHECK_BOOL(LoadSegmentation(scene, argv[2], numberOfCopies, segmentationNode), true);
+  vtkSegmentation* segmentation = segmentationNode->GetSegmentation();
+  CHECK_BOOL(RunBenchmark(segmentation, "Shared labelmaps"), true);
+  segmentation->SetConversionParameter(
+    vtkBinaryLabelmapToClosedSurfaceConversionRule::GetJointSmoothingParameterName(), "1");
+  CHECK_BOOL(RunBenchmark(segmentation, "Shared labelmaps, joint smoothing"), true);
+  segmentation->SetConversionParameter(
+    vtkBinaryLabelmapToClosedSurfaceConversionRule::GetSurfaceNetsParameterName(), "1");
+  CHECK_BOOL(RunBenchmark(segmentation, "Shared labelmaps, surface nets"), true);
+  }
+
+  std::cout << "Benchmark completed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -32,6 +32,37 @@ Care Ontario.
 #include "vtkFractionalLabelmapToClosedSurfaceConversionRule.h"
 #include "vtkClosedSurfaceToFractionalLabelmapConversionRule.h"
 
+// Segmentation core includes
+#include "vtkOrientedImageData.h"
+#include "vtkOrientedImageDataResample.h"
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkMatrix4x4.h>
+#include <vtkPointData.h>
+#include <vtkTeemNRRDReader.h>
+
+// STD includes
+#include <sstream>
+
+//----------------------------------------------------------------------------
+namespace
+{
+  vtkIdType GetNumberOfNonZeroVoxels(vtkImageData* image)
+    {
+    vtkDataArray* scalars = image->GetPointData()->GetScalars();
+    vtkIdType numberOfNonZeroVoxels = 0;
+    for (vtkIdType pointIndex = 0; scalars && pointIndex < scalars->GetNumberOfTuples(); ++pointIndex)
+      {
+      if (scalars->GetTuple1(pointIndex) != 0.0)
+        {
+        ++numberOfNonZeroVoxels;
+        }
+      }
+    return numberOfNonZeroVoxels;
+    }
+}
+
 int vtkMRMLSegmentationStorageNodeTest1(int argc, char * argv[] )
 {
   vtkNew<vtkMRMLSegmentationStorageNode> node1;
@@ -39,11 +70,12 @@ int vtkMRMLSegmentationStorageNodeTest1(int argc, char * argv[] )
   scene->AddNode(node1.GetPointer());
   EXERCISE_ALL_BASIC_MRML_METHODS(node1.GetPointer());
 
-  if (argc != 4)
+  if (argc != 5)
     {
     std::cerr << "Line " << __LINE__
               << " - Missing parameters !\n"
               << "Usage: " << argv[0] << " /path/to/ITKSnapSegmentation.nii.gz /path/to/OldSlicerSegmentation.seg.nrrd /path/to/SlicerSegmentation.seg.nrrd"
+              << " /path/to/temp"
               << std::endl;
     return EXIT_FAILURE;
     }
@@ -57,6 +89,7 @@ int vtkMRMLSegmentationStorageNodeTest1(int argc, char * argv[] )
   const char* itkSnapSegmentationFilename = argv[1]; // ITKSnapSegmentation.nii.gz
   const char* oldSlicerSegmentationFilename = argv[2]; // OldSlicerSegmentation.seg.nrrd: Segmentation before shared labelmaps implemented.
   const char* slicerSegmentationFilename = argv[3]; // SlicerSegmentation.seg.nrrd: Segmentation with shared labelmaps.
+  std::string tempDir = argv[4];
 
   // Test segmentation exported from ITK-SNAP
   std::cout << "Testing ITK-SNAP segmentation" << std::endl;
@@ -114,5 +147,118 @@ int vtkMRMLSegmentationStorageNodeTest1(int argc, char * argv[] )
     CHECK_INT(numberOfLayers, 2);
   }
 
+  std::cout << "Testing segmentation with layers cropped to effective extent" << std::endl;
+  {
+    vtkNew<vtkMRMLSegmentationNode> segmentationNode;
+    scene->AddNode(segmentationNode);
+    vtkNew<vtkMRMLSegmentationStorageNode> segmentationStorageNode;
+    scene->AddNode(segmentationStorageNode);
+    segmentationStorageNode->SetFileName(slicerSegmentationFilename);
+    CHECK_BOOL(segmentationStorageNode->ReadData(segmentationNode) != 0, true);
+    vtkSegmentation* segmentation = segmentationNode->GetSegmentation();
+
+    std::string croppedSegmentationFilename = tempDir + "/SlicerSegmentationCroppedLayers.seg.nrrd";
+    segmentationStorageNode->SetFileName(croppedSegmentationFilename.c_str());
+    segmentationStorageNode->CropLayersToEffectiveExtentOn();
+    CHECK_BOOL(segmentationStorageNode->WriteData(segmentationNode) != 0, true);
+
+    vtkNew<vtkMRMLSegmentationNode> croppedSegmentationNode;
+    scene->AddNode(croppedSegmentationNode);
+    vtkNew<vtkMRMLSegmentationStorageNode> croppedSegmentationStorageNode;
+    scene->AddNode(croppedSegmentationStorageNode);
+    croppedSegmentationStorageNode->SetFileName(croppedSegmentationFilename.c_str());
+    CHECK_BOOL(croppedSegmentationStorageNode->ReadData(croppedSegmentationNode) != 0, true);
+    vtkSegmentation* croppedSegmentation = croppedSegmentationNode->GetSegmentation();
+
+    CHECK_INT(croppedSegmentation->GetNumberOfSegments(), segmentation->GetNumberOfSegments());
+    CHECK_INT(croppedSegmentation->GetNumberOfLayers(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()),
+      segmentation->GetNumberOfLayers(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+    std::vector<std::string> segmentIDs;
+    segmentation->GetSegmentIDs(segmentIDs);
+    for (const std::string& segmentID : segmentIDs)
+      {
+      vtkNew<vtkOrientedImageData> labelmap;
+      CHECK_BOOL(segmentationNode->GetBinaryLabelmapRepresentation(segmentID, labelmap), true);
+      vtkNew<vtkOrientedImageData> croppedLabelmap;
+      CHECK_BOOL(croppedSegmentationNode->GetBinaryLabelmapRepresentation(segmentID, croppedLabelmap), true);
+      CHECK_BOOL(vtkOrientedImageDataResample::DoGeometriesMatch(labelmap, croppedLabelmap), true);
+      CHECK_INT(GetNumberOfNonZeroVoxels(croppedLabelmap), GetNumberOfNonZeroVoxels(labelmap));
+      int effectiveExtent[6] = { 0, -1, 0, -1, 0, -1 };
+      int croppedEffectiveExtent[6] = { 0, -1, 0, -1, 0, -1 };
+      vtkOrientedImageDataResample::CalculateEffectiveExtent(labelmap, effectiveExtent);
+      vtkOrientedImageDataResample::CalculateEffectiveExtent(croppedLabelmap, croppedEffectiveExtent);
+      for (int i = 0; i < 6; ++i)
+        {
+        CHECK_INT(croppedEffectiveExtent[i], effectiveExtent[i]);
+        }
+      }
+
+    // The file must be a regular 4D image, placed correctly by readers that ignore segmentation fields:
+    // it is cropped to the union of effective extents of the layers, with origin shifted accordingly.
+    vtkNew<vtkOrientedImageData> expectedGeometryImage;
+    CHECK_BOOL(vtkSegmentationConverter::DeserializeImageGeometry(
+      segmentation->DetermineCommonLabelmapGeometry(vtkSegmentation::EXTENT_UNION_OF_EFFECTIVE_SEGMENTS), expectedGeometryImage, false), true);
+    int expectedExtent[6] = { 0, -1, 0, -1, 0, -1 };
+    expectedGeometryImage->GetExtent(expectedExtent);
+    vtkNew<vtkMatrix4x4> expectedImageToWorldMatrix;
+    expectedGeometryImage->GetImageToWorldMatrix(expectedImageToWorldMatrix);
+
+    vtkNew<vtkTeemNRRDReader> nrrdReader;
+    nrrdReader->SetFileName(croppedSegmentationFilename.c_str());
+    nrrdReader->Update();
+    CHECK_INT(nrrdReader->GetReadStatus(), 0);
+    vtkImageData* fileImage = nrrdReader->GetOutput();
+    int* fileDimensions = fileImage->GetDimensions();
+    for (int i = 0; i < 3; ++i)
+      {
+      CHECK_INT(fileDimensions[i], expectedExtent[i * 2 + 1] - expectedExtent[i * 2] + 1);
+      }
+    CHECK_INT(fileImage->GetNumberOfScalarComponents(),
+      segmentation->GetNumberOfLayers(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+
+    // First voxel of the file is the first voxel of the cropped extent, axes and spacing are unchanged
+    vtkNew<vtkMatrix4x4> fileIjkToRasMatrix;
+    vtkMatrix4x4::Invert(nrrdReader->GetRasToIjkMatrix(), fileIjkToRasMatrix);
+    double expectedOrigin[4] = { static_cast<double>(expectedExtent[0]), static_cast<double>(expectedExtent[2]),
+      static_cast<double>(expectedExtent[4]), 1.0 };
+    expectedImageToWorldMatrix->MultiplyPoint(expectedOrigin, expectedOrigin);
+    for (int row = 0; row < 3; ++row)
+      {
+      CHECK_DOUBLE_TOLERANCE(fileIjkToRasMatrix->GetElement(row, 3), expectedOrigin[row], 1e-3);
+      for (int column = 0; column < 3; ++column)
+        {
+        CHECK_DOUBLE_TOLERANCE(fileIjkToRasMatrix->GetElement(row, column), expectedImageToWorldMatrix->GetElement(row, column), 1e-3);
+        }
+      }
+
+    // Segmentation fields are consistent with the cropped image
+    std::stringstream expectedOffsetSS;
+    expectedOffsetSS << expectedExtent[0] << " " << expectedExtent[2] << " " << expectedExtent[4];
+    const char* offsetValue = nrrdReader->GetHeaderValue("Segmentation_ReferenceImageExtentOffset");
+    CHECK_NOT_NULL(offsetValue);
+    CHECK_STD_STRING(std::string(offsetValue), expectedOffsetSS.str());
+    for (int segmentIndex = 0; segmentIndex < static_cast<int>(segmentIDs.size()); ++segmentIndex)
+      {
+      vtkOrientedImageData* layerLabelmap = vtkOrientedImageData::SafeDownCast(
+        segmentation->GetSegment(segmentIDs[segmentIndex])->GetRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+      CHECK_NOT_NULL(layerLabelmap);
+      int layerEffectiveExtent[6] = { 0, -1, 0, -1, 0, -1 };
+      CHECK_BOOL(vtkOrientedImageDataResample::CalculateEffectiveExtent(layerLabelmap, layerEffectiveExtent), true);
+      std::stringstream segmentExtentKey;
+      segmentExtentKey << "Segment" << segmentIndex << "_Extent";
+      const char* segmentExtentValue = nrrdReader->GetHeaderValue(segmentExtentKey.str().c_str());
+      CHECK_NOT_NULL(segmentExtentValue);
+      std::stringstream segmentExtentSS(segmentExtentValue);
+      int segmentExtentInFile[6] = { 0, -1, 0, -1, 0, -1 };
+      segmentExtentSS >> segmentExtentInFile[0] >> segmentExtentInFile[1] >> segmentExtentInFile[2]
+        >> segmentExtentInFile[3] >> segmentExtentInFile[4] >> segmentExtentInFile[5];
+      for (int i = 0; i < 6; ++i)
+        {
+        // segment extent in the file is relative to the cropped image
+        CHECK_INT(segmentExtentInFile[i], layerEffectiveExtent[i] - expectedExtent[(i / 2) * 2]);
+        }
+      }
+  }
+
   return EXIT_SUCCESS;
 }
@@ -48,10 +48,12 @@
 #include <vtkITKArchetypeImageSeriesVectorReaderFile.h>
 #include <vtkMultiBlockDataSet.h>
 #include <vtkNew.h>
+#include <vtkTeemNRRDReader.h>
 #include <vtkTeemNRRDWriter.h>
 #include <vtkObjectFactory.h>
 #include <vtkPointData.h>
 #include <vtkPolyData.h>
+#include <vtkStreamingDemandDrivenPipeline.h>
 #include <vtkStringArray.h>
 #include <vtkTransform.h>
 #include <vtkXMLMultiBlockDataWriter.h>
@@ -69,6 +71,7 @@
 #endif
 
 // STL & C++ includes
+#include <algorithm>
 #include <iterator>
 #include <sstream>
 
@@ -90,11 +93,28 @@ static const std::string KEY_SEGMENTATION_REFERENCE_IMAGE_EXTENT_OFFSET = "Refer
 static const std::string KEY_SEGMENTATION_CONTAINED_REPRESENTATION_NAMES = "ContainedRepresentationNames";
 
 static const int SINGLE_SEGMENT_INDEX = -1; // used as segment index when there is only a single segment
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+bool IsExtentValid(const int extent[6])
+{
+  return extent[0] <= extent[1] && extent[2] <= extent[3] && extent[4] <= extent[5];
+}
+
+} // end of anonymous namespace
 //----------------------------------------------------------------------------
 vtkMRMLNodeNewMacro(vtkMRMLSegmentationStorageNode);
 
 //----------------------------------------------------------------------------
-vtkMRMLSegmentationStorageNode::vtkMRMLSegmentationStorageNode() = default;
+vtkMRMLSegmentationStorageNode::vtkMRMLSegmentationStorageNode()
+{
+  this->CompressionPresets.emplace_back(this->GetCompressionParameterFastest(), "Fastest");
+  this->CompressionPresets.emplace_back(this->GetCompressionParameterNormal(), "Normal");
+
+  this->CompressionParameter = this->GetCompressionParameterNormal();
+}
 
 //----------------------------------------------------------------------------
 vtkMRMLSegmentationStorageNode::~vtkMRMLSegmentationStorageNode() = default;
@@ -105,6 +125,7 @@ void vtkMRMLSegmentationStorageNode::PrintSelf(ostream& os, vtkIndent indent)
   Superclass::PrintSelf(os,indent);
   vtkMRMLPrintBeginMacro(os, indent);
   vtkMRMLPrintBooleanMacro(CropToMinimumExtent);
+  vtkMRMLPrintBooleanMacro(CropLayersToEffectiveExtent);
   vtkMRMLPrintEndMacro();
 }
 
@@ -115,6 +136,7 @@ void vtkMRMLSegmentationStorageNode::ReadXMLAttributes(const char** atts)
   Superclass::ReadXMLAttributes(atts);
   vtkMRMLReadXMLBeginMacro(atts);
   vtkMRMLReadXMLBooleanMacro(CropToMinimumExtent, CropToMinimumExtent);
+  vtkMRMLReadXMLBooleanMacro(CropLayersToEffectiveExtent, CropLayersToEffectiveExtent);
   vtkMRMLReadXMLEndMacro();
 }
 
@@ -124,6 +146,7 @@ void vtkMRMLSegmentationStorageNode::WriteXML(ostream& of, int nIndent)
   Superclass::WriteXML(of, nIndent);
   vtkMRMLWriteXMLBeginMacro(of);
   vtkMRMLWriteXMLBooleanMacro(CropToMinimumExtent, CropToMinimumExtent);
+  vtkMRMLWriteXMLBooleanMacro(CropLayersToEffectiveExtent, CropLayersToEffectiveExtent);
   vtkMRMLWriteXMLEndMacro();
 }
 
@@ -136,6 +159,7 @@ void vtkMRMLSegmentationStorageNode::Copy(vtkMRMLNode *anode)
   Superclass::Copy(anode);
   vtkMRMLCopyBeginMacro(anode);
   vtkMRMLCopyBooleanMacro(CropToMinimumExtent);
+  vtkMRMLCopyBooleanMacro(CropLayersToEffectiveExtent);
   vtkMRMLCopyEndMacro();
 }
 
@@ -575,7 +599,29 @@ int vtkMRMLSegmentationStorageNode::ReadBinaryLabelmapRepresentation(vtkMRMLSegm
     {
     // Read the volume
     this->GetUserMessages()->SetObservedObject(archetypeImageReader);
-    archetypeImageReader->Update();
+    archetypeImageReader->UpdateInformation();
+    if (archetypeImageReader->GetErrorCode() == vtkErrorCode::NoError
+      && archetypeImageReader->GetMetaDataDictionary().HasKey(vtkTeemNRRDWriter::GetCompressedChunksKey()))
+      {
+      // Voxel data is compressed in chunks, decompress them in parallel
+      vtkInformation* outInfo = archetypeImageReader->GetOutputInformation(0);
+      int wholeExtent[6] = { 0, -1, 0, -1, 0, -1 };
+      outInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), wholeExtent);
+      imageData = vtkSmartPointer<vtkImageData>::New();
+      imageData->SetExtent(wholeExtent);
+      imageData->SetSpacing(outInfo->Get(vtkDataObject::SPACING()));
+      imageData->SetOrigin(outInfo->Get(vtkDataObject::ORIGIN()));
+      imageData->AllocateScalars(archetypeImageReader->GetOutputScalarType(), archetypeImageReader->GetNumberOfComponents());
+      if (!vtkTeemNRRDReader::ReadCompressedChunks(path.c_str(), imageData))
+        {
+        vtkDebugMacro("ReadBinaryLabelmapRepresentation: Failed to read compressed chunks, reading as regular NRRD file");
+        imageData = nullptr;
+        }
+      }
+    if (!imageData)
+      {
+      archetypeImageReader->Update();
+      }
     this->GetUserMessages()->SetObservedObject(nullptr);
     if (archetypeImageReader->GetErrorCode() != vtkErrorCode::NoError)
       {
@@ -585,7 +631,10 @@ int vtkMRMLSegmentationStorageNode::ReadBinaryLabelmapRepresentation(vtkMRMLSegm
       }
 
     // Copy image data to sequence of volume nodes
-    imageData = archetypeImageReader->GetOutput();
+    if (!imageData)
+      {
+      imageData = archetypeImageReader->GetOutput();
+      }
     rasToFileIjk = archetypeImageReader->GetRasToIjkMatrix();
     imageData->GetExtent(imageExtentInFile);
     imageData->GetExtent(commonGeometryExtent);
@@ -1230,7 +1279,7 @@ int vtkMRMLSegmentationStorageNode::WriteBinaryLabelmapRepresentation(vtkMRMLSeg
   if (segmentation->GetNumberOfSegments() > 0)
     {
     std::string commonGeometryString = segmentation->DetermineCommonLabelmapGeometry(
-      this->CropToMinimumExtent ?
+      (this->CropToMinimumExtent || this->CropLayersToEffectiveExtent) ?
         vtkSegmentation::EXTENT_UNION_OF_EFFECTIVE_SEGMENTS : vtkSegmentation::EXTENT_UNION_OF_EFFECTIVE_SEGMENTS_AND_REFERENCE_GEOMETRY);
     vtkSegmentationConverter::DeserializeImageGeometry(commonGeometryString, commonGeometryImage, true, scalarType, 1);
     commonGeometryImage->GetExtent(commonGeometryExtent);
@@ -1255,6 +1304,9 @@ int vtkMRMLSegmentationStorageNode::WriteBinaryLabelmapRepresentation(vtkMRMLSeg
   vtkNew<vtkTeemNRRDWriter> writer;
   writer->SetFileName(fullName.c_str());
   writer->SetUseCompression(this->GetUseCompression());
+  // Compress in chunks in parallel, the file remains readable by any NRRD reader
+  writer->SetParallelCompression(true);
+  writer->SetRunLengthCompression(this->CompressionParameter == this->GetCompressionParameterFastest());
   writer->SetSpace(nrrdSpaceLeftPosteriorSuperior);
   writer->SetMeasurementFrameMatrix(nullptr);
 
@@ -1291,6 +1343,7 @@ int vtkMRMLSegmentationStorageNode::WriteBinaryLabelmapRepresentation(vtkMRMLSeg
   writer->SetAttribute(GetSegmentationMetaDataKey(KEY_SEGMENTATION_CONTAINED_REPRESENTATION_NAMES).c_str(), containedRepresentationNames);
 
   vtkNew<vtkImageAppendComponents> appender;
+  int emptyExtent[6] = { 0, -1, 0, -1, 0, -1 };
 
   unsigned int layerIndex = 0;
   std::map<vtkDataObject*, int> labelmapLayers;
@@ -1325,17 +1378,58 @@ int vtkMRMLSegmentationStorageNode::WriteBinaryLabelmapRepresentation(vtkMRMLSeg
       vtkOrientedImageDataResample::GetTransformBetweenOrientedImages(currentBinaryLabelmap, commonGeometryImage, currentBinaryLabelmapToCommonGeometryImageTransform.GetPointer());
       int currentBinaryLabelmapExtentInCommonGeometryImageFrame[6] = { 0, -1, 0, -1, 0, -1 };
       vtkOrientedImageDataResample::TransformExtent(currentBinaryLabelmapExtent, currentBinaryLabelmapToCommonGeometryImageTransform.GetPointer(), currentBinaryLabelmapExtentInCommonGeometryImageFrame);
+      if (this->CropLayersToEffectiveExtent)
+        {
+        // Only the non-empty region of the layer is stored in the segment extent
+        int effectiveExtent[6] = { 0, -1, 0, -1, 0, -1 };
+        if (vtkOrientedImageDataResample::CalculateEffectiveExtent(currentBinaryLabelmap, effectiveExtent))
+          {
+          vtkOrientedImageDataResample::TransformExtent(effectiveExtent, currentBinaryLabelmapToCommonGeometryImageTransform.GetPointer(), currentBinaryLabelmapExtentInCommonGeometryImageFrame);
+          }
+        else
+          {
+          std::copy(emptyExtent, emptyExtent + 6, currentBinaryLabelmapExtentInCommonGeometryImageFrame);
+          }
+        }
       for (int i = 0; i < 3; i++)
         {
         currentBinaryLabelmapExtent[i * 2] = std::max(currentBinaryLabelmapExtentInCommonGeometryImageFrame[i * 2], commonGeometryExtent[i * 2]);
         currentBinaryLabelmapExtent[i * 2 + 1] = std::min(currentBinaryLabelmapExtentInCommonGeometryImageFrame[i * 2 + 1], commonGeometryExtent[i * 2 + 1]);
         }
-      // TODO: maybe calculate effective extent to make sure the data is as compact as possible? (saving may be a good time to make segments more compact)
 
       // Pad/resample current binary labelmap representation to common geometry
       vtkSmartPointer<vtkOrientedImageData> resampledCurrentBinaryLabelmap = vtkSmartPointer<vtkOrientedImageData>::New();
-      bool success = vtkOrientedImageDataResample::ResampleOrientedImageToReferenceOrientedImage(
-        currentBinaryLabelmap, commonGeometryImage, resampledCurrentBinaryLabelmap);
+      bool success = true;
+      if (!this->CropLayersToEffectiveExtent)
+        {
+        success = vtkOrientedImageDataResample::ResampleOrientedImageToReferenceOrientedImage(
+          currentBinaryLabelmap, commonGeometryImage, resampledCurrentBinaryLabelmap);
+        }
+      else if (IsExtentValid(currentBinaryLabelmapExtent))
+        {
+        // Resample only the non-empty region of the layer, the rest of the common geometry is padded with 0
+        vtkNew<vtkOrientedImageData> referenceGeometryImage;
+        vtkNew<vtkMatrix4x4> commonGeometryImageToWorldMatrix;
+        commonGeometryImage->GetImageToWorldMatrix(commonGeometryImageToWorldMatrix.GetPointer());
+        referenceGeometryImage->SetImageToWorldMatrix(commonGeometryImageToWorldMatrix.GetPointer());
+        referenceGeometryImage->SetExtent(currentBinaryLabelmapExtent);
+        success = vtkOrientedImageDataResample::ResampleOrientedImageToReferenceOrientedImage(
+          currentBinaryLabelmap, referenceGeometryImage, resampledCurrentBinaryLabelmap);
+        if (success)
+          {
+          vtkNew<vtkImageConstantPad> padder;
+          padder->SetInputData(resampledCurrentBinaryLabelmap);
+          padder->SetOutputWholeExtent(commonGeometryExtent);
+          padder->SetConstant(0);
+          padder->Update();
+          resampledCurrentBinaryLabelmap->ShallowCopy(padder->GetOutput());
+          }
+        }
+      else
+        {
+        // layer is empty, use the commonGeometryImage (filled with 0)
+        resampledCurrentBinaryLabelmap = commonGeometryImage;
+        }
       if (!success)
         {
         vtkWarningToMessageCollectionMacro(this->GetUserMessages(), "vtkMRMLSegmentationStorageNode::WriteBinaryLabelmapRepresentation",
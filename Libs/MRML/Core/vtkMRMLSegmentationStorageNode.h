@@ -111,6 +111,21 @@ public:
   vtkGetMacro(CropToMinimumExtent, bool);
   vtkBooleanMacro(CropToMinimumExtent, bool);
 
+  /// Controls if labelmap layers are cropped to their effective extent (extent of non-empty voxels) when written.
+  /// If false (default): segment extents are stored as they are in the segmentation.
+  /// If true: the image is cropped to the union of the effective extents of all layers (as with CropToMinimumExtent),
+  /// each layer is resampled only within its effective extent, and the extent stored for each segment is
+  /// the effective extent of its layer. Segments are therefore loaded with minimal extent.
+  /// The file is a regular 4D (i, j, k, layer) image with the same header keys in both cases.
+  vtkSetMacro(CropLayersToEffectiveExtent, bool);
+  vtkGetMacro(CropLayersToEffectiveExtent, bool);
+  vtkBooleanMacro(CropLayersToEffectiveExtent, bool);
+
+  /// Compression parameter corresponding to run-length encoding strategy of gzip compression (fast)
+  std::string GetCompressionParameterFastest() { return "gzip_rle"; };
+  /// Compression parameter corresponding to default gzip compression
+  std::string GetCompressionParameterNormal() { return "gzip_normal"; };
+
 protected:
   /// Initialize all the supported read file types
   void InitializeSupportedReadFileTypes() override;
@@ -176,6 +191,7 @@ protected:
 
 protected:
   bool CropToMinimumExtent{false};
+  bool CropLayersToEffectiveExtent{false};
 
 protected:
   vtkMRMLSegmentationStorageNode();
@@ -0,0 +1,156 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRMLDisplayableManager includes
+#include <vtkMRMLDisplayableManagerGroup.h>
+#include <vtkMRMLModelDisplayableManager.h>
+
+// MRMLLogic includes
+#include <vtkMRMLApplicationLogic.h>
+
+// MRML includes
+#include <vtkMRMLCoreTestingMacros.h>
+#include <vtkMRMLModelDisplayNode.h>
+#include <vtkMRMLModelNode.h>
+#include <vtkMRMLScene.h>
+#include <vtkMRMLViewNode.h>
+
+// VTK includes
+#include <vtkActor.h>
+#include <vtkNew.h>
+#include <vtkPropCollection.h>
+#include <vtkProperty.h>
+#include <vtkRenderer.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkSmartPointer.h>
+#include <vtkSphereSource.h>
+
+// STD includes
+#include <string>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+vtkMRMLModelDisplayNode* AddSphereModel(vtkMRMLScene* scene, double center)
+{
+  vtkNew<vtkSphereSource> sphereSource;
+  sphereSource->SetCenter(center, 0.0, 0.0);
+  sphereSource->SetRadius(1.0);
+  sphereSource->Update();
+  vtkNew<vtkMRMLModelNode> modelNode;
+  modelNode->SetAndObservePolyData(sphereSource->GetOutput());
+  scene->AddNode(modelNode);
+  vtkNew<vtkMRMLModelDisplayNode> displayNode;
+  scene->AddNode(displayNode);
+  modelNode->SetAndObserveDisplayNodeID(displayNode->GetID());
+  return displayNode;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkMRMLModelDisplayableManagerBatchRenderingTest(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  vtkNew<vtkRenderer> renderer;
+  vtkNew<vtkRenderWindow> renderWindow;
+  vtkNew<vtkRenderWindowInteractor> renderWindowInteractor;
+  renderWindow->SetSize(200, 200);
+  renderWindow->AddRenderer(renderer);
+  renderWindow->SetInteractor(renderWindowInteractor);
+
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLApplicationLogic> applicationLogic;
+  applicationLogic->SetMRMLScene(scene);
+
+  vtkNew<vtkMRMLViewNode> viewNode;
+  scene->AddNode(viewNode);
+
+  vtkNew<vtkMRMLDisplayableManagerGroup> displayableManagerGroup;
+  displayableManagerGroup->SetRenderer(renderer);
+  displayableManagerGroup->SetMRMLDisplayableNode(viewNode);
+
+  vtkNew<vtkMRMLModelDisplayableManager> modelDisplayableManager;
+  modelDisplayableManager->SetMRMLApplicationLogic(applicationLogic);
+  displayableManagerGroup->AddDisplayableManager(modelDisplayableManager);
+  displayableManagerGroup->GetInteractor()->Initialize();
+
+  CHECK_BOOL(modelDisplayableManager->GetBatchRendering(), false);
+
+  std::vector<vtkMRMLModelDisplayNode*> displayNodes;
+  for (int i = 0; i < 5; ++i)
+    {
+    displayNodes.push_back(AddSphereModel(scene, 3.0 * i));
+    }
+  int numberOfIndividualProps = renderer->GetViewProps()->GetNumberOfItems();
+  CHECK_BOOL(numberOfIndividualProps >= 5, true);
+  CHECK_INT(modelDisplayableManager->GetNumberOfBatchGroups(), 0);
+
+  // Models with the same display properties share a single actor
+  modelDisplayableManager->BatchRenderingOn();
+  CHECK_INT(modelDisplayableManager->GetNumberOfBatchGroups(), 1);
+  CHECK_INT(renderer->GetViewProps()->GetNumberOfItems(), numberOfIndividualProps - 4);
+  vtkSmartPointer<vtkProp3D> batchActor = modelDisplayableManager->GetActorByID(displayNodes[0]->GetID());
+  CHECK_NOT_NULL(batchActor);
+  for (vtkMRMLModelDisplayNode* displayNode : displayNodes)
+    {
+    CHECK_POINTER(modelDisplayableManager->GetActorByID(displayNode->GetID()), batchActor);
+    }
+  renderWindow->Render();
+
+  // Visibility, color and opacity changes keep the batch
+  displayNodes[1]->SetVisibility(false);
+  displayNodes[2]->SetColor(1.0, 0.0, 0.0);
+  displayNodes[3]->SetOpacity(0.5);
+  CHECK_INT(modelDisplayableManager->GetNumberOfBatchGroups(), 1);
+  CHECK_POINTER(modelDisplayableManager->GetActorByID(displayNodes[1]->GetID()), batchActor);
+  CHECK_BOOL(batchActor->GetVisibility() != 0, true);
+  renderWindow->Render();
+
+  // Different representation moves the model to another group
+  displayNodes[4]->SetRepresentation(vtkMRMLDisplayNode::WireframeRepresentation);
+  CHECK_INT(modelDisplayableManager->GetNumberOfBatchGroups(), 2);
+  vtkActor* wireframeActor = vtkActor::SafeDownCast(modelDisplayableManager->GetActorByID(displayNodes[4]->GetID()));
+  CHECK_NOT_NULL(wireframeActor);
+  CHECK_BOOL(wireframeActor != batchActor, true);
+  CHECK_INT(wireframeActor->GetProperty()->GetRepresentation(), VTK_WIREFRAME);
+
+  // Scalar visibility requires an individual actor
+  displayNodes[4]->SetScalarVisibility(true);
+  CHECK_INT(modelDisplayableManager->GetNumberOfBatchGroups(), 1);
+  CHECK_NOT_NULL(modelDisplayableManager->GetActorByID(displayNodes[4]->GetID()));
+  CHECK_BOOL(modelDisplayableManager->GetActorByID(displayNodes[4]->GetID()) != batchActor, true);
+  renderWindow->Render();
+
+  // Removing models removes their blocks
+  std::string removedDisplayNodeID = displayNodes[0]->GetID();
+  scene->RemoveNode(displayNodes[0]->GetDisplayableNode());
+  CHECK_NULL(modelDisplayableManager->GetActorByID(removedDisplayNodeID.c_str()));
+  CHECK_INT(modelDisplayableManager->GetNumberOfBatchGroups(), 1);
+
+  // Disabling batch rendering restores individual actors
+  modelDisplayableManager->BatchRenderingOff();
+  CHECK_INT(modelDisplayableManager->GetNumberOfBatchGroups(), 0);
+  vtkProp3D* firstActor = modelDisplayableManager->GetActorByID(displayNodes[1]->GetID());
+  CHECK_NOT_NULL(firstActor);
+  CHECK_BOOL(firstActor != modelDisplayableManager->GetActorByID(displayNodes[2]->GetID()), true);
+  CHECK_BOOL(firstActor->GetVisibility() != 0, false);
+  renderWindow->Render();
+
+  modelDisplayableManager->SetMRMLApplicationLogic(nullptr);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,650 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Copyright (c) Kitware Inc.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Headless benchmark of the slice view rendering pipeline.
+//
+// A slice logic and the slice view displayable managers are set up on an
+// offscreen render window. Synthetic volumes, segmentations and models are
+// added to the scene, then the slice offset is swept through the volume and
+// the time spent in each stage of a frame is recorded:
+//
+//   displayableManagers: slice node update, including all displayable manager callbacks
+//   reslice:             vtkImageReslice update of each volume layer
+//   blend:               color mapping and blending of the layers
+//   render:              render window update (lazy pipelines, e.g. plane cutting, run here)
+//
+// Results are printed as JSON (to stdout or to the file given with --json) so
+// that they can be compared between releases.
+//
+// Usage:
+//   vtkMRMLSliceViewRenderingBenchmark [--volume-size N] [--view-size N]
+//     [--volume-layers 0-3] [--segmentations N] [--segments N] [--models N]
+//     [--model-resolution N] [--frames N] [--warmup N]
+//     [--displayable-managers name1,name2,...] [--require-displayable-managers]
+//     [--json file] [--per-frame]
+//
+// The segmentations displayable manager is in the Segmentations module, therefore
+// segmentations are only rendered by the build of this benchmark in that module
+// (vtkSlicerSegmentationsSliceViewRenderingBenchmark).
+
+// MRMLDisplayableManager includes
+#include <vtkMRMLDisplayableManagerGroup.h>
+#include <vtkMRMLSliceViewDisplayableManagerFactory.h>
+
+// MRMLLogic includes
+#include <vtkMRMLApplicationLogic.h>
+#include <vtkMRMLSliceLayerLogic.h>
+#include <vtkMRMLSliceLogic.h>
+
+// MRML includes
+#include <vtkMRMLColorTableNode.h>
+#include <vtkMRMLLabelMapVolumeDisplayNode.h>
+#include <vtkMRMLLabelMapVolumeNode.h>
+#include <vtkMRMLModelDisplayNode.h>
+#include <vtkMRMLModelNode.h>
+#include <vtkMRMLScalarVolumeDisplayNode.h>
+#include <vtkMRMLScalarVolumeNode.h>
+#include <vtkMRMLScene.h>
+#include <vtkMRMLSegmentationDisplayNode.h>
+#include <vtkMRMLSegmentationNode.h>
+#include <vtkMRMLSliceCompositeNode.h>
+#include <vtkMRMLSliceNode.h>
+
+// SegmentationCore includes
+#include <vtkOrientedImageData.h>
+#include <vtkSegmentation.h>
+
+// VTK includes
+#include <vtkActor2D.h>
+#include <vtkImageBlend.h>
+#include <vtkImageData.h>
+#include <vtkImageMapper.h>
+#include <vtkImageReslice.h>
+#include <vtkNew.h>
+#include <vtkRenderer.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkSmartPointer.h>
+#include <vtkSphereSource.h>
+#include <vtkTimerLog.h>
+
+#ifdef vtkMRMLSliceViewRenderingBenchmark_WITH_SEGMENTATIONS
+// Register the segmentations displayable managers
+#include <vtkAutoInit.h>
+VTK_MODULE_INIT(vtkSlicerSegmentationsModuleMRMLDisplayableManager)
+#endif
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+struct BenchmarkParameters
+{
+  int VolumeSize{ 256 };
+  int ViewSize{ 512 };
+  int VolumeLayers{ 1 };
+  int Segmentations{ 1 };
+  int Segments{ 10 };
+  int Models{ 5 };
+  int ModelResolution{ 64 };
+  int Frames{ 100 };
+  int Warmup{ 5 };
+  bool PerFrame{ false };
+  bool RequireDisplayableManagers{ false };
+  std::string JsonFileName;
+  std::vector<std::string> DisplayableManagers;
+};
+
+//----------------------------------------------------------------------------
+const char* StageNames[] = { "displayableManagers", "reslice", "blend", "render", "total" };
+const int NumberOfStages = sizeof(StageNames) / sizeof(StageNames[0]);
+
+//----------------------------------------------------------------------------
+void PrintUsage(const char* executableName)
+{
+  std::cerr << "Usage: " << executableName << std::endl
+    << "  [--volume-size N]      Number of voxels along each axis of the synthetic volumes (default: 256)" << std::endl
+    << "  [--view-size N]        Width and height of the offscreen slice view in pixels (default: 512)" << std::endl
+    << "  [--volume-layers N]    Number of volume layers shown: 0-3 (background, foreground, label) (default: 1)" << std::endl
+    << "  [--segmentations N]    Number of segmentation nodes (default: 1)" << std::endl
+    << "  [--segments N]         Number of segments in each segmentation (default: 10)" << std::endl
+    << "  [--models N]           Number of model nodes (default: 5)" << std::endl
+    << "  [--model-resolution N] Theta and phi resolution of the sphere models (default: 64)" << std::endl
+    << "  [--frames N]           Number of measured frames (default: 100)" << std::endl
+    << "  [--warmup N]           Number of frames rendered before measurement starts (default: 5)" << std::endl
+    << "  [--displayable-managers name1,name2,...] Slice view displayable managers to instantiate" << std::endl
+    << "  [--require-displayable-managers] Fail if any of the displayable managers is not available" << std::endl
+    << "  [--json file]          Write results to file instead of standard output" << std::endl
+    << "  [--per-frame]          Include timing of each frame in the results" << std::endl;
+}
+
+//----------------------------------------------------------------------------
+bool ParseArguments(int argc, char* argv[], BenchmarkParameters& parameters)
+{
+  std::map<std::string, int*> intOptions;
+  intOptions["--volume-size"] = &parameters.VolumeSize;
+  intOptions["--view-size"] = &parameters.ViewSize;
+  intOptions["--volume-layers"] = &parameters.VolumeLayers;
+  intOptions["--segmentations"] = &parameters.Segmentations;
+  intOptions["--segments"] = &parameters.Segments;
+  intOptions["--models"] = &parameters.Models;
+  intOptions["--model-resolution"] = &parameters.ModelResolution;
+  intOptions["--frames"] = &parameters.Frames;
+  intOptions["--warmup"] = &parameters.Warmup;
+
+  for (int i = 1; i < argc; ++i)
+    {
+    std::string arg = argv[i];
+    if (arg == "--per-frame")
+      {
+      parameters.PerFrame = true;
+      continue;
+      }
+    if (arg == "--require-displayable-managers")
+      {
+      parameters.RequireDisplayableManagers = true;
+      continue;
+      }
+    if (i + 1 >= argc)
+      {
+      std::cerr << "Missing value for argument: " << arg << std::endl;
+      return false;
+      }
+    std::string value = argv[++i];
+    if (intOptions.find(arg) != intOptions.end())
+      {
+      *intOptions[arg] = atoi(value.c_str());
+      }
+    else if (arg == "--json")
+      {
+      parameters.JsonFileName = value;
+      }
+    else if (arg == "--displayable-managers")
+      {
+      parameters.DisplayableManagers.clear();
+      std::stringstream ss(value);
+      std::string name;
+      while (std::getline(ss, name, ','))
+        {
+        if (!name.empty())
+          {
+          parameters.DisplayableManagers.push_back(name);
+          }
+        }
+      }
+    else
+      {
+      std::cerr << "Unknown argument: " << arg << std::endl;
+      return false;
+      }
+    }
+
+  if (parameters.VolumeSize < 2 || parameters.ViewSize < 1 || parameters.Frames < 1
+    || parameters.VolumeLayers < 0 || parameters.VolumeLayers > 3
+    || parameters.Segmentations < 0 || parameters.Segments < 0 || parameters.Models < 0
+    || parameters.ModelResolution < 3 || parameters.Warmup < 0)
+    {
+    std::cerr << "Invalid argument value" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+/// Fill a volume with a smooth synthetic pattern so that reslicing and
+/// window/level mapping work on non-constant data.
+void FillSyntheticVolume(vtkImageData* image, int size, int seed)
+{
+  image->SetDimensions(size, size, size);
+  image->AllocateScalars(VTK_SHORT, 1);
+  short* voxelPtr = static_cast<short*>(image->GetScalarPointer());
+  double center = (size - 1) / 2.0;
+  for (int k = 0; k < size; ++k)
+    {
+    for (int j = 0; j < size; ++j)
+      {
+      for (int i = 0; i < size; ++i)
+        {
+        double r = sqrt((i - center) * (i - center) + (j - center) * (j - center) + (k - center) * (k - center));
+        *(voxelPtr++) = static_cast<short>(1000.0 * cos(r * (0.1 + 0.02 * seed)) + (i + j + k) % 64);
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLScalarVolumeNode* AddSyntheticVolume(vtkMRMLScene* scene, int size, int seed, bool labelmap)
+{
+  vtkNew<vtkImageData> image;
+  if (labelmap)
+    {
+    image->SetDimensions(size, size, size);
+    image->AllocateScalars(VTK_SHORT, 1);
+    short* voxelPtr = static_cast<short*>(image->GetScalarPointer());
+    int blockSize = std::max(1, size / 8);
+    for (int k = 0; k < size; ++k)
+      {
+      for (int j = 0; j < size; ++j)
+        {
+        for (int i = 0; i < size; ++i)
+          {
+          *(voxelPtr++) = static_cast<short>(((i / blockSize) + (j / blockSize) + (k / blockSize)) % 8);
+          }
+        }
+      }
+    }
+  else
+    {
+    FillSyntheticVolume(image, size, seed);
+    }
+
+  vtkNew<vtkMRMLColorTableNode> colorNode;
+  if (labelmap)
+    {
+    colorNode->SetTypeToLabels();
+    }
+  else
+    {
+    colorNode->SetTypeToGrey();
+    }
+  scene->AddNode(colorNode);
+
+  vtkSmartPointer<vtkMRMLScalarVolumeNode> volumeNode;
+  vtkSmartPointer<vtkMRMLVolumeDisplayNode> displayNode;
+  if (labelmap)
+    {
+    volumeNode = vtkSmartPointer<vtkMRMLLabelMapVolumeNode>::New();
+    displayNode = vtkSmartPointer<vtkMRMLLabelMapVolumeDisplayNode>::New();
+    }
+  else
+    {
+    volumeNode = vtkSmartPointer<vtkMRMLScalarVolumeNode>::New();
+    vtkNew<vtkMRMLScalarVolumeDisplayNode> scalarDisplayNode;
+    scalarDisplayNode->SetAutoWindowLevel(false);
+    scalarDisplayNode->SetWindowLevel(2000, 0);
+    displayNode = scalarDisplayNode.GetPointer();
+    }
+  scene->AddNode(displayNode);
+  displayNode->SetAndObserveColorNodeID(colorNode->GetID());
+
+  volumeNode->SetSpacing(1.0, 1.0, 1.0);
+  volumeNode->SetOrigin(-size / 2.0, -size / 2.0, -size / 2.0);
+  volumeNode->SetAndObserveImageData(image);
+  scene->AddNode(volumeNode);
+  volumeNode->SetAndObserveDisplayNodeID(displayNode->GetID());
+  return volumeNode;
+}
+
+//----------------------------------------------------------------------------
+/// Add a segmentation with spherical segments spread over the volume.
+/// Non-overlapping segments are collapsed into shared labelmap layers, as the
+/// Segment Editor does.
+void AddSyntheticSegmentation(vtkMRMLScene* scene, int volumeSize, int numberOfSegments, int seed)
+{
+  vtkNew<vtkMRMLSegmentationNode> segmentationNode;
+  scene->AddNode(segmentationNode);
+  segmentationNode->CreateDefaultDisplayNodes();
+
+  double origin = -volumeSize / 2.0;
+  int radius = std::max(2, volumeSize / 12);
+  for (int segmentIndex = 0; segmentIndex < numberOfSegments; ++segmentIndex)
+    {
+    // Place segment centers on a pseudo-random but reproducible grid
+    int center[3] =
+      {
+      radius + ((segmentIndex * 37 + seed * 11) % std::max(1, volumeSize - 2 * radius)),
+      radius + ((segmentIndex * 53 + seed * 7) % std::max(1, volumeSize - 2 * radius)),
+      radius + ((segmentIndex * 71 + seed * 3) % std::max(1, volumeSize - 2 * radius))
+      };
+
+    vtkNew<vtkOrientedImageData> labelmap;
+    labelmap->SetSpacing(1.0, 1.0, 1.0);
+    labelmap->SetOrigin(origin, origin, origin);
+    labelmap->SetExtent(center[0] - radius, center[0] + radius,
+                        center[1] - radius, center[1] + radius,
+                        center[2] - radius, center[2] + radius);
+    labelmap->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+    unsigned char* voxelPtr = static_cast<unsigned char*>(labelmap->GetScalarPointer());
+    for (int k = -radius; k <= radius; ++k)
+      {
+      for (int j = -radius; j <= radius; ++j)
+        {
+        for (int i = -radius; i <= radius; ++i)
+          {
+          *(voxelPtr++) = (i * i + j * j + k * k <= radius * radius) ? 1 : 0;
+          }
+        }
+      }
+    std::stringstream segmentName;
+    segmentName << "Segment_" << segmentIndex;
+    segmentationNode->AddSegmentFromBinaryLabelmapRepresentation(labelmap, segmentName.str());
+    }
+  segmentationNode->GetSegmentation()->CollapseBinaryLabelmaps(false);
+
+  vtkMRMLSegmentationDisplayNode* displayNode = vtkMRMLSegmentationDisplayNode::SafeDownCast(segmentationNode->GetDisplayNode());
+  if (displayNode)
+    {
+    displayNode->SetVisibility2DFill(true);
+    displayNode->SetVisibility2DOutline(true);
+    }
+}
+
+//----------------------------------------------------------------------------
+void AddSyntheticModel(vtkMRMLScene* scene, int volumeSize, int resolution, int seed)
+{
+  vtkNew<vtkSphereSource> sphereSource;
+  sphereSource->SetThetaResolution(resolution);
+  sphereSource->SetPhiResolution(resolution);
+  sphereSource->SetRadius(volumeSize / 6.0 + seed % 5);
+  sphereSource->SetCenter((seed % 3 - 1) * volumeSize / 5.0, ((seed / 3) % 3 - 1) * volumeSize / 5.0, 0.0);
+  sphereSource->Update();
+
+  vtkNew<vtkMRMLModelNode> modelNode;
+  modelNode->SetAndObservePolyData(sphereSource->GetOutput());
+  scene->AddNode(modelNode);
+  modelNode->CreateDefaultDisplayNodes();
+  vtkMRMLDisplayNode* displayNode = modelNode->GetDisplayNode();
+  if (displayNode)
+    {
+    displayNode->SetVisibility2D(true);
+    }
+}
+
+//----------------------------------------------------------------------------
+struct StageStatistics
+{
+  double Mean{ 0.0 };
+  double Median{ 0.0 };
+  double Min{ 0.0 };
+  double Max{ 0.0 };
+};
+
+//----------------------------------------------------------------------------
+StageStatistics ComputeStatistics(std::vector<double> values)
+{
+  StageStatistics stats;
+  if (values.empty())
+    {
+    return stats;
+    }
+  std::sort(values.begin(), values.end());
+  double sum = 0.0;
+  for (double value : values)
+    {
+    sum += value;
+    }
+  stats.Mean = sum / values.size();
+  stats.Min = values.front();
+  stats.Max = values.back();
+  size_t mid = values.size() / 2;
+  stats.Median = (values.size() % 2) ? values[mid] : 0.5 * (values[mid - 1] + values[mid]);
+  return stats;
+}
+
+//----------------------------------------------------------------------------
+void WriteJson(std::ostream& os, const BenchmarkParameters& parameters,
+  const std::vector<std::string>& displayableManagers,
+  const std::vector<std::vector<double> >& stageTimes)
+{
+  os << "{" << std::endl;
+  os << "  \"benchmark\": \"vtkMRMLSliceViewRenderingBenchmark\"," << std::endl;
+  os << "  \"parameters\": {" << std::endl;
+  os << "    \"volumeSize\": " << parameters.VolumeSize << "," << std::endl;
+  os << "    \"viewSize\": " << parameters.ViewSize << "," << std::endl;
+  os << "    \"volumeLayers\": " << parameters.VolumeLayers << "," << std::endl;
+  os << "    \"segmentations\": " << parameters.Segmentations << "," << std::endl;
+  os << "    \"segments\": " << parameters.Segments << "," << std::endl;
+  os << "    \"models\": " << parameters.Models << "," << std::endl;
+  os << "    \"modelResolution\": " << parameters.ModelResolution << "," << std::endl;
+  os << "    \"frames\": " << parameters.Frames << "," << std::endl;
+  os << "    \"warmup\": " << parameters.Warmup << "," << std::endl;
+  os << "    \"displayableManagers\": [";
+  for (size_t i = 0; i < displayableManagers.size(); ++i)
+    {
+    os << (i > 0 ? ", " : "") << "\"" << displayableManagers[i] << "\"";
+    }
+  os << "]" << std::endl;
+  os << "  }," << std::endl;
+
+  os << "  \"stages\": {" << std::endl;
+  for (int stage = 0; stage < NumberOfStages; ++stage)
+    {
+    StageStatistics stats = ComputeStatistics(stageTimes[stage]);
+    os << "    \"" << StageNames[stage] << "\": { "
+      << "\"meanMs\": " << stats.Mean * 1000.0 << ", "
+      << "\"medianMs\": " << stats.Median * 1000.0 << ", "
+      << "\"minMs\": " << stats.Min * 1000.0 << ", "
+      << "\"maxMs\": " << stats.Max * 1000.0 << " }"
+      << (stage + 1 < NumberOfStages ? "," : "") << std::endl;
+    }
+  os << "  }";
+
+  if (parameters.PerFrame)
+    {
+    os << "," << std::endl << "  \"perFrameMs\": [" << std::endl;
+    for (int frame = 0; frame < parameters.Frames; ++frame)
+      {
+      os << "    {";
+      for (int stage = 0; stage < NumberOfStages; ++stage)
+        {
+        os << (stage > 0 ? ", " : " ") << "\"" << StageNames[stage] << "\": " << stageTimes[stage][frame] * 1000.0;
+        }
+      os << " }" << (frame + 1 < parameters.Frames ? "," : "") << std::endl;
+      }
+    os << "  ]";
+    }
+  os << std::endl << "}" << std::endl;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+  BenchmarkParameters parameters;
+  parameters.DisplayableManagers.push_back("vtkMRMLVolumeGlyphSliceDisplayableManager");
+  parameters.DisplayableManagers.push_back("vtkMRMLModelSliceDisplayableManager");
+  parameters.DisplayableManagers.push_back("vtkMRMLCrosshairDisplayableManager");
+  // Only available if the Segmentations module displayable managers are loaded
+  parameters.DisplayableManagers.push_back("vtkMRMLSegmentationsDisplayableManager2D");
+  if (!ParseArguments(argc, argv, parameters))
+    {
+    PrintUsage(argv[0]);
+    return EXIT_FAILURE;
+    }
+
+  // Offscreen renderer
+  vtkNew<vtkRenderer> renderer;
+  vtkNew<vtkRenderWindow> renderWindow;
+  vtkNew<vtkRenderWindowInteractor> renderWindowInteractor;
+  renderWindow->SetOffScreenRendering(1);
+  renderWindow->SetSize(parameters.ViewSize, parameters.ViewSize);
+  renderWindow->SetMultiSamples(0);
+  renderWindow->AddRenderer(renderer);
+  renderWindow->SetInteractor(renderWindowInteractor);
+
+  // Scene and logic
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLApplicationLogic> applicationLogic;
+  applicationLogic->SetMRMLScene(scene);
+  vtkMRMLSliceNode::AddDefaultSliceOrientationPresets(scene);
+
+  vtkNew<vtkMRMLSliceLogic> sliceLogic;
+  sliceLogic->SetMRMLApplicationLogic(applicationLogic);
+  sliceLogic->SetMRMLScene(scene);
+  vtkMRMLSliceNode* sliceNode = sliceLogic->AddSliceNode("Red");
+  sliceLogic->ResizeSliceNode(parameters.ViewSize, parameters.ViewSize);
+  sliceNode->SetSliceResolutionMode(vtkMRMLSliceNode::SliceResolutionMatch2DView);
+
+  // Slice image is displayed the same way as in ctkVTKSliceView
+  vtkNew<vtkImageMapper> imageMapper;
+  imageMapper->SetColorWindow(255);
+  imageMapper->SetColorLevel(127.5);
+  imageMapper->SetInputConnection(sliceLogic->GetImageDataConnection());
+  vtkNew<vtkActor2D> imageActor;
+  imageActor->SetMapper(imageMapper);
+  renderer->AddActor2D(imageActor);
+
+  // Displayable managers
+  vtkMRMLSliceViewDisplayableManagerFactory* factory = vtkMRMLSliceViewDisplayableManagerFactory::GetInstance();
+  factory->SetMRMLApplicationLogic(applicationLogic);
+  std::vector<std::string> instantiatedDisplayableManagers;
+  for (const std::string& name : parameters.DisplayableManagers)
+    {
+    if (!vtkMRMLDisplayableManagerGroup::IsADisplayableManager(name.c_str()))
+      {
+      if (parameters.RequireDisplayableManagers)
+        {
+        std::cerr << "Displayable manager is not available: " << name << std::endl;
+        return EXIT_FAILURE;
+        }
+      std::cerr << "Displayable manager is not available, skipped: " << name << std::endl;
+      continue;
+      }
+    if (!factory->IsDisplayableManagerRegistered(name.c_str()))
+      {
+      factory->RegisterDisplayableManager(name.c_str());
+      }
+    instantiatedDisplayableManagers.push_back(name);
+    }
+  vtkSmartPointer<vtkMRMLDisplayableManagerGroup> displayableManagerGroup =
+    vtkSmartPointer<vtkMRMLDisplayableManagerGroup>::Take(factory->InstantiateDisplayableManagers(renderer));
+  if (!displayableManagerGroup)
+    {
+    std::cerr << "Failed to instantiate displayable managers" << std::endl;
+    return EXIT_FAILURE;
+    }
+  displayableManagerGroup->SetMRMLDisplayableNode(sliceNode);
+
+  // Synthetic data
+  vtkMRMLSliceCompositeNode* sliceCompositeNode = sliceLogic->GetSliceCompositeNode();
+  if (parameters.VolumeLayers > 0)
+    {
+    vtkMRMLScalarVolumeNode* volumeNode = AddSyntheticVolume(scene, parameters.VolumeSize, 0, false);
+    sliceCompositeNode->SetBackgroundVolumeID(volumeNode->GetID());
+    }
+  if (parameters.VolumeLayers > 1)
+    {
+    vtkMRMLScalarVolumeNode* volumeNode = AddSyntheticVolume(scene, parameters.VolumeSize, 1, false);
+    sliceCompositeNode->SetForegroundVolumeID(volumeNode->GetID());
+    sliceCompositeNode->SetForegroundOpacity(0.5);
+    }
+  if (parameters.VolumeLayers > 2)
+    {
+    vtkMRMLScalarVolumeNode* volumeNode = AddSyntheticVolume(scene, parameters.VolumeSize, 2, true);
+    sliceCompositeNode->SetLabelVolumeID(volumeNode->GetID());
+    }
+  for (int i = 0; i < parameters.Segmentations; ++i)
+    {
+    AddSyntheticSegmentation(scene, parameters.VolumeSize, parameters.Segments, i);
+    }
+  for (int i = 0; i < parameters.Models; ++i)
+    {
+    AddSyntheticModel(scene, parameters.VolumeSize, parameters.ModelResolution, i);
+    }
+
+  sliceLogic->FitSliceToAll(parameters.ViewSize, parameters.ViewSize);
+  renderer->ResetCamera();
+  renderWindow->Render();
+
+  std::vector<vtkMRMLSliceLayerLogic*> layers;
+  layers.push_back(sliceLogic->GetBackgroundLayer());
+  layers.push_back(sliceLogic->GetForegroundLayer());
+  layers.push_back(sliceLogic->GetLabelLayer());
+
+  // Sweep the slice through the central 80% of the volume
+  double sweepRange = parameters.VolumeSize * 0.8;
+  int numberOfFrames = parameters.Warmup + parameters.Frames;
+  std::vector<std::vector<double> > stageTimes(NumberOfStages);
+  vtkNew<vtkTimerLog> timer;
+  for (int frame = 0; frame < numberOfFrames; ++frame)
+    {
+    double offset = -sweepRange / 2.0 + sweepRange * (frame % parameters.Frames) / parameters.Frames;
+    double times[NumberOfStages] = { 0.0 };
+
+    double frameStartTime = vtkTimerLog::GetUniversalTime();
+
+    timer->StartTimer();
+    sliceLogic->SetSliceOffset(offset);
+    timer->StopTimer();
+    times[0] = timer->GetElapsedTime();
+
+    timer->StartTimer();
+    for (vtkMRMLSliceLayerLogic* layer : layers)
+      {
+      if (layer && layer->GetVolumeNode() && layer->GetReslice())
+        {
+        layer->GetReslice()->Update();
+        }
+      }
+    timer->StopTimer();
+    times[1] = timer->GetElapsedTime();
+
+    timer->StartTimer();
+    if (sliceLogic->GetBlend())
+      {
+      sliceLogic->GetBlend()->Update();
+      }
+    timer->StopTimer();
+    times[2] = timer->GetElapsedTime();
+
+    timer->StartTimer();
+    renderWindow->Render();
+    timer->StopTimer();
+    times[3] = timer->GetElapsedTime();
+
+    times[4] = vtkTimerLog::GetUniversalTime() - frameStartTime;
+
+    if (frame < parameters.Warmup)
+      {
+      continue;
+      }
+    for (int stage = 0; stage < NumberOfStages; ++stage)
+      {
+      stageTimes[stage].push_back(times[stage]);
+      }
+    }
+
+  if (parameters.JsonFileName.empty())
+    {
+    WriteJson(std::cout, parameters, instantiatedDisplayableManagers, stageTimes);
+    }
+  else
+    {
+    std::ofstream jsonFile(parameters.JsonFileName.c_str());
+    if (!jsonFile.is_open())
+      {
+      std::cerr << "Failed to open output file: " << parameters.JsonFileName << std::endl;
+      return EXIT_FAILURE;
+      }
+    WriteJson(jsonFile, parameters, instantiatedDisplayableManagers, stageTimes);
+    }
+
+  displayableManagerGroup->SetMRMLDisplayableNode(nullptr);
+  return EXIT_SUCCESS;
+}
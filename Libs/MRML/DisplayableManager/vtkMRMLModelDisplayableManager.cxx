@@ -41,6 +41,8 @@
 #include <vtkClipDataSet.h>
 #include <vtkClipPolyData.h>
 #include <vtkColorTransferFunction.h>
+#include <vtkCompositeDataDisplayAttributes.h>
+#include <vtkCompositePolyDataMapper2.h>
 #include <vtkDataSetAttributes.h>
 #include <vtkDataSetMapper.h>
 #include <vtkExtractGeometry.h>
@@ -52,11 +54,13 @@
 #include <vtkImplicitBoolean.h>
 #include <vtkLookupTable.h>
 #include <vtkMatrix4x4.h>
+#include <vtkMultiBlockDataSet.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkPlane.h>
 #include <vtkPointData.h>
 #include <vtkPointSet.h>
+#include <vtkPolyData.h>
 #include <vtkPolyDataMapper.h>
 #include <vtkProp3DCollection.h>
 #include <vtkProperty.h>
@@ -73,6 +77,9 @@
 #include <vtkRendererCollection.h>
 #include <vtkWorldPointPicker.h>
 
+// STD includes
+#include <sstream>
+
 //---------------------------------------------------------------------------
 vtkStandardNewMacro (vtkMRMLModelDisplayableManager );
 
@@ -96,6 +103,39 @@ public:
   /// Find first picked node from prop3Ds in cell picker and set PickedNodeID in Internal
   void FindFirstPickedDisplayNodeFromPickerProp3Ds();
 
+  /// Display properties that must be shared by all models rendered by the same batch actor
+  static std::string GetBatchGroupKey(vtkMRMLDisplayNode* displayNode, vtkMRMLDisplayableNode* displayableNode);
+  /// Add or update the model display node in a batch group.
+  /// Returns false if the display node cannot be batched.
+  bool UpdateBatchedDisplayNode(vtkMRMLModelDisplayNode* modelDisplayNode, vtkMRMLDisplayNode* propertiesDisplayNode,
+    vtkMRMLDisplayableNode* displayableNode, vtkAlgorithmOutput* meshConnection);
+  /// Update block attributes of a batched display node. Returns false if the display node is not batched.
+  bool UpdateBatchedDisplayProperty(vtkMRMLModelDisplayNode* modelDisplayNode, vtkMRMLDisplayNode* propertiesDisplayNode,
+    bool visible, double opacity);
+  /// Remove display node from its batch group. Returns false if the display node is not batched.
+  bool RemoveFromBatch(const std::string& displayNodeID);
+  /// Remove the actor or batch block of the display node from the renderer
+  void RemoveDisplayedProp(const std::string& displayNodeID);
+  void ClearBatches();
+  bool IsBatchActor(vtkProp3D* prop);
+
+  struct BatchGroup
+  {
+    vtkSmartPointer<vtkActor> Actor;
+    vtkSmartPointer<vtkCompositePolyDataMapper2> Mapper;
+    vtkSmartPointer<vtkMultiBlockDataSet> Blocks;
+    vtkSmartPointer<vtkCompositeDataDisplayAttributes> Attributes;
+    std::map<vtkDataObject*, std::string> DataOwners;
+    std::vector<unsigned int> FreeBlocks;
+  };
+  struct BatchedDisplayNode
+  {
+    std::string GroupKey;
+    unsigned int BlockIndex;
+    vtkPolyData* Data;
+    vtkMTimeType DataMTime;
+  };
+
 public:
   vtkMRMLModelDisplayableManager* External;
 
@@ -105,6 +145,8 @@ public:
   std::map<std::string, vtkMRMLDisplayableNode*>   DisplayableNodes;
   std::map<std::string, int>                       RegisteredModelHierarchies;
   std::map<std::string, vtkTransformFilter*>       DisplayNodeTransformFilters;
+  std::map<std::string, BatchGroup>                BatchGroups;
+  std::map<std::string, BatchedDisplayNode>        BatchedDisplayNodes;
 
   vtkMRMLSliceNode* RedSliceNode;
   vtkMRMLSliceNode* GreenSliceNode;
@@ -311,6 +353,16 @@ void vtkMRMLModelDisplayableManager::vtkInternal::FindFirstPickedDisplayNodeFrom
       {
       continue;
       }
+    if (this->IsBatchActor(pickedProp))
+      {
+      // batch actors are shared by many display nodes, find the node by the picked block
+      this->FindPickedDisplayNodeFromMesh(vtkPointSet::SafeDownCast(this->CellPicker->GetDataSet()), nullptr);
+      if (!this->PickedDisplayNodeID.empty())
+        {
+        return; // Display node found
+        }
+      continue;
+      }
     std::map<std::string, vtkProp3D*>::iterator propIt;
     for (propIt = this->DisplayedActors.begin(); propIt != this->DisplayedActors.end(); propIt++)
       {
@@ -323,6 +375,282 @@ void vtkMRMLModelDisplayableManager::vtkInternal::FindFirstPickedDisplayNodeFrom
     }
 }
 
+//---------------------------------------------------------------------------
+std::string vtkMRMLModelDisplayableManager::vtkInternal::GetBatchGroupKey(
+  vtkMRMLDisplayNode* displayNode, vtkMRMLDisplayableNode* displayableNode)
+{
+  // Color, opacity, and visibility are block attributes, therefore they are not part of the key.
+  std::ostringstream key;
+  key << displayNode->GetRepresentation()
+    << "|" << displayNode->GetPointSize()
+    << "|" << displayNode->GetLineWidth()
+    << "|" << displayNode->GetLighting()
+    << "|" << displayNode->GetInterpolation()
+    << "|" << displayNode->GetShading()
+    << "|" << displayNode->GetFrontfaceCulling()
+    << "|" << displayNode->GetBackfaceCulling()
+    << "|" << (displayNode->GetSelected() ? displayNode->GetSelectedAmbient() : displayNode->GetAmbient())
+    << "|" << (displayNode->GetSelected() ? displayNode->GetSelectedSpecular() : displayNode->GetSpecular())
+    << "|" << displayNode->GetDiffuse()
+    << "|" << displayNode->GetPower()
+    << "|" << displayNode->GetMetallic()
+    << "|" << displayNode->GetRoughness()
+    << "|" << displayNode->GetEdgeVisibility();
+  double* edgeColor = displayNode->GetEdgeColor();
+  key << "|" << edgeColor[0] << "," << edgeColor[1] << "," << edgeColor[2]
+    << "|" << displayableNode->GetSelectable()
+    << "|" << (displayableNode->GetTransformNodeID() ? displayableNode->GetTransformNodeID() : "");
+  return key.str();
+}
+
+//---------------------------------------------------------------------------
+bool vtkMRMLModelDisplayableManager::vtkInternal::UpdateBatchedDisplayNode(
+  vtkMRMLModelDisplayNode* modelDisplayNode, vtkMRMLDisplayNode* propertiesDisplayNode,
+  vtkMRMLDisplayableNode* displayableNode, vtkAlgorithmOutput* meshConnection)
+{
+  if (propertiesDisplayNode->GetScalarVisibility()
+    || propertiesDisplayNode->GetTextureImageDataConnection() != nullptr)
+    {
+    return false;
+    }
+  // Blocks are not connected to the pipeline, so the mesh is brought up-to-date here
+  vtkAlgorithm* producer = meshConnection->GetProducer();
+  producer->UpdatePort(meshConnection->GetIndex());
+  vtkPolyData* polyData = vtkPolyData::SafeDownCast(producer->GetOutputDataObject(meshConnection->GetIndex()));
+  if (!polyData)
+    {
+    return false;
+    }
+
+  std::string displayNodeID = modelDisplayNode->GetID();
+  std::string groupKey = GetBatchGroupKey(propertiesDisplayNode, displayableNode);
+
+  std::map<std::string, BatchedDisplayNode>::iterator batchedIt = this->BatchedDisplayNodes.find(displayNodeID);
+  if (batchedIt != this->BatchedDisplayNodes.end()
+    && (batchedIt->second.GroupKey != groupKey || batchedIt->second.Data != polyData))
+    {
+    this->RemoveFromBatch(displayNodeID);
+    batchedIt = this->BatchedDisplayNodes.end();
+    }
+
+  if (batchedIt != this->BatchedDisplayNodes.end())
+    {
+    // Already in the right group, only notify the mapper if the mesh content changed
+    BatchGroup& group = this->BatchGroups[groupKey];
+    if (polyData->GetMTime() > batchedIt->second.DataMTime)
+      {
+      batchedIt->second.DataMTime = polyData->GetMTime();
+      group.Blocks->Modified();
+      }
+    this->DisplayedActors[displayNodeID] = group.Actor;
+    return true;
+    }
+
+  std::map<std::string, BatchGroup>::iterator groupIt = this->BatchGroups.find(groupKey);
+  if (groupIt != this->BatchGroups.end()
+    && groupIt->second.DataOwners.find(polyData) != groupIt->second.DataOwners.end())
+    {
+    // Block attributes are associated with the data object, so a mesh can only appear once in a group
+    return false;
+    }
+
+  // Remove the individual actor that may have been used for this display node
+  std::map<std::string, vtkProp3D*>::iterator actorIt = this->DisplayedActors.find(displayNodeID);
+  if (actorIt != this->DisplayedActors.end())
+    {
+    this->External->GetRenderer()->RemoveViewProp(actorIt->second);
+    this->External->RemoveDisplayedID(displayNodeID);
+    }
+
+  if (groupIt == this->BatchGroups.end())
+    {
+    BatchGroup newGroup;
+    newGroup.Blocks = vtkSmartPointer<vtkMultiBlockDataSet>::New();
+    newGroup.Attributes = vtkSmartPointer<vtkCompositeDataDisplayAttributes>::New();
+    newGroup.Mapper = vtkSmartPointer<vtkCompositePolyDataMapper2>::New();
+    newGroup.Mapper->SetInputDataObject(newGroup.Blocks);
+    newGroup.Mapper->SetCompositeDataDisplayAttributes(newGroup.Attributes);
+    newGroup.Mapper->ScalarVisibilityOff();
+    newGroup.Actor = vtkSmartPointer<vtkActor>::New();
+    newGroup.Actor->SetMapper(newGroup.Mapper);
+
+    // Properties that are shared by all blocks (see GetBatchGroupKey)
+    vtkProperty* actorProperties = newGroup.Actor->GetProperty();
+    actorProperties->SetRepresentation(propertiesDisplayNode->GetRepresentation());
+    actorProperties->SetPointSize(propertiesDisplayNode->GetPointSize());
+    actorProperties->SetLineWidth(propertiesDisplayNode->GetLineWidth());
+    actorProperties->SetLighting(propertiesDisplayNode->GetLighting());
+    actorProperties->SetInterpolation(propertiesDisplayNode->GetInterpolation());
+    actorProperties->SetShading(propertiesDisplayNode->GetShading());
+    actorProperties->SetFrontfaceCulling(propertiesDisplayNode->GetFrontfaceCulling());
+    actorProperties->SetBackfaceCulling(propertiesDisplayNode->GetBackfaceCulling());
+    if (propertiesDisplayNode->GetSelected())
+      {
+      actorProperties->SetAmbient(propertiesDisplayNode->GetSelectedAmbient());
+      actorProperties->SetSpecular(propertiesDisplayNode->GetSelectedSpecular());
+      }
+    else
+      {
+      actorProperties->SetAmbient(propertiesDisplayNode->GetAmbient());
+      actorProperties->SetSpecular(propertiesDisplayNode->GetSpecular());
+      }
+    actorProperties->SetDiffuse(propertiesDisplayNode->GetDiffuse());
+    actorProperties->SetSpecularPower(propertiesDisplayNode->GetPower());
+    actorProperties->SetMetallic(propertiesDisplayNode->GetMetallic());
+    actorProperties->SetRoughness(propertiesDisplayNode->GetRoughness());
+    actorProperties->SetEdgeVisibility(propertiesDisplayNode->GetEdgeVisibility());
+    actorProperties->SetEdgeColor(propertiesDisplayNode->GetEdgeColor());
+    newGroup.Actor->SetPickable(displayableNode->GetSelectable());
+
+    this->External->GetRenderer()->AddViewProp(newGroup.Actor);
+    groupIt = this->BatchGroups.insert(std::make_pair(groupKey, newGroup)).first;
+    }
+  BatchGroup& group = groupIt->second;
+
+  BatchedDisplayNode batchedDisplayNode;
+  batchedDisplayNode.GroupKey = groupKey;
+  batchedDisplayNode.Data = polyData;
+  batchedDisplayNode.DataMTime = polyData->GetMTime();
+  if (!group.FreeBlocks.empty())
+    {
+    batchedDisplayNode.BlockIndex = group.FreeBlocks.back();
+    group.FreeBlocks.pop_back();
+    }
+  else
+    {
+    batchedDisplayNode.BlockIndex = group.Blocks->GetNumberOfBlocks();
+    }
+  group.Blocks->SetBlock(batchedDisplayNode.BlockIndex, polyData);
+  group.DataOwners[polyData] = displayNodeID;
+  // Hidden until display properties are set
+  group.Attributes->SetBlockVisibility(polyData, false);
+  group.Attributes->Modified();
+  this->BatchedDisplayNodes[displayNodeID] = batchedDisplayNode;
+
+  this->DisplayedActors[displayNodeID] = group.Actor;
+  this->DisplayedNodes[displayNodeID] = modelDisplayNode;
+  this->DisplayedClipState[displayNodeID] = 0;
+  return true;
+}
+
+//---------------------------------------------------------------------------
+bool vtkMRMLModelDisplayableManager::vtkInternal::UpdateBatchedDisplayProperty(
+  vtkMRMLModelDisplayNode* modelDisplayNode, vtkMRMLDisplayNode* propertiesDisplayNode,
+  bool visible, double opacity)
+{
+  std::map<std::string, BatchedDisplayNode>::iterator batchedIt =
+    this->BatchedDisplayNodes.find(modelDisplayNode->GetID());
+  if (batchedIt == this->BatchedDisplayNodes.end())
+    {
+    return false;
+    }
+  BatchGroup& group = this->BatchGroups[batchedIt->second.GroupKey];
+  vtkPolyData* data = batchedIt->second.Data;
+
+  double* color = propertiesDisplayNode->GetSelected() ?
+    propertiesDisplayNode->GetSelectedColor() : propertiesDisplayNode->GetColor();
+  double currentColor[3] = { -1.0, -1.0, -1.0 };
+  if (group.Attributes->HasBlockColor(data))
+    {
+    group.Attributes->GetBlockColor(data, currentColor);
+    }
+  bool modified = false;
+  if (!group.Attributes->HasBlockVisibility(data) || group.Attributes->GetBlockVisibility(data) != visible)
+    {
+    group.Attributes->SetBlockVisibility(data, visible);
+    modified = true;
+    }
+  if (currentColor[0] != color[0] || currentColor[1] != color[1] || currentColor[2] != color[2])
+    {
+    group.Attributes->SetBlockColor(data, color);
+    modified = true;
+    }
+  if (!group.Attributes->HasBlockOpacity(data) || group.Attributes->GetBlockOpacity(data) != opacity)
+    {
+    group.Attributes->SetBlockOpacity(data, opacity);
+    modified = true;
+    }
+  if (modified)
+    {
+    // Only the block attributes are updated, geometry of the group is not uploaded again
+    group.Attributes->Modified();
+    }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+bool vtkMRMLModelDisplayableManager::vtkInternal::RemoveFromBatch(const std::string& displayNodeID)
+{
+  std::map<std::string, BatchedDisplayNode>::iterator batchedIt = this->BatchedDisplayNodes.find(displayNodeID);
+  if (batchedIt == this->BatchedDisplayNodes.end())
+    {
+    return false;
+    }
+  std::map<std::string, BatchGroup>::iterator groupIt = this->BatchGroups.find(batchedIt->second.GroupKey);
+  if (groupIt != this->BatchGroups.end())
+    {
+    BatchGroup& group = groupIt->second;
+    vtkPolyData* data = batchedIt->second.Data;
+    group.Attributes->RemoveBlockVisibility(data);
+    group.Attributes->RemoveBlockColor(data);
+    group.Attributes->RemoveBlockOpacity(data);
+    group.Attributes->Modified();
+    group.DataOwners.erase(data);
+    group.Blocks->SetBlock(batchedIt->second.BlockIndex, nullptr);
+    group.FreeBlocks.push_back(batchedIt->second.BlockIndex);
+    if (group.DataOwners.empty())
+      {
+      if (this->External->GetRenderer())
+        {
+        this->External->GetRenderer()->RemoveViewProp(group.Actor);
+        }
+      this->BatchGroups.erase(groupIt);
+      }
+    }
+  this->BatchedDisplayNodes.erase(batchedIt);
+  return true;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLModelDisplayableManager::vtkInternal::RemoveDisplayedProp(const std::string& displayNodeID)
+{
+  if (this->RemoveFromBatch(displayNodeID))
+    {
+    return;
+    }
+  std::map<std::string, vtkProp3D*>::iterator actorIt = this->DisplayedActors.find(displayNodeID);
+  if (actorIt != this->DisplayedActors.end() && this->External->GetRenderer())
+    {
+    this->External->GetRenderer()->RemoveViewProp(actorIt->second);
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLModelDisplayableManager::vtkInternal::ClearBatches()
+{
+  if (this->External->GetRenderer())
+    {
+    for (std::pair<const std::string, BatchGroup>& group : this->BatchGroups)
+      {
+      this->External->GetRenderer()->RemoveViewProp(group.second.Actor);
+      }
+    }
+  this->BatchGroups.clear();
+  this->BatchedDisplayNodes.clear();
+}
+
+//---------------------------------------------------------------------------
+bool vtkMRMLModelDisplayableManager::vtkInternal::IsBatchActor(vtkProp3D* prop)
+{
+  for (std::pair<const std::string, BatchGroup>& group : this->BatchGroups)
+    {
+    if (group.second.Actor == prop)
+      {
+      return true;
+      }
+    }
+  return false;
+}
 
 //---------------------------------------------------------------------------
 // vtkMRMLModelDisplayableManager methods
@@ -333,6 +661,8 @@ vtkMRMLModelDisplayableManager::vtkMRMLModelDisplayableManager()
   this->Internal = new vtkInternal(this);
 
   this->Internal->CreateClipSlices();
+
+  this->BatchRendering = false;
 }
 
 //---------------------------------------------------------------------------
@@ -375,6 +705,8 @@ void vtkMRMLModelDisplayableManager::PrintSelf ( ostream& os, vtkIndent indent )
   os << indent << "GreenSliceClipState = " << this->Internal->GreenSliceClipState << "\n";
   os << indent << "ClippingMethod = " << this->Internal->ClippingMethod << "\n";
   os << indent << "ClippingOn = " << (this->Internal->ClippingOn ? "true" : "false") << "\n";
+  os << indent << "BatchRendering = " << (this->BatchRendering ? "true" : "false") << "\n";
+  os << indent << "NumberOfBatchGroups = " << this->Internal->BatchGroups.size() << "\n";
 
   os << indent << "PickedDisplayNodeID = " << this->Internal->PickedDisplayNodeID.c_str() << "\n";
   os << indent << "PickedRAS = (" << this->Internal->PickedRAS[0] << ", "
@@ -390,6 +722,26 @@ int vtkMRMLModelDisplayableManager::ActiveInteractionModes()
   return 0;
 }
 
+//---------------------------------------------------------------------------
+void vtkMRMLModelDisplayableManager::SetBatchRendering(bool enable)
+{
+  if (this->BatchRendering == enable)
+    {
+    return;
+    }
+  this->BatchRendering = enable;
+  this->Modified();
+  // Displayed models are moved between individual and batch actors in the next update
+  this->SetUpdateFromMRMLRequested(true);
+  this->RequestRender();
+}
+
+//---------------------------------------------------------------------------
+int vtkMRMLModelDisplayableManager::GetNumberOfBatchGroups()
+{
+  return static_cast<int>(this->Internal->BatchGroups.size());
+}
+
 //---------------------------------------------------------------------------
 vtkMRMLClipModelsNode* vtkMRMLModelDisplayableManager::GetClipModelsNode()
 {
@@ -939,7 +1291,7 @@ void vtkMRMLModelDisplayableManager::UpdateModelsFromMRML()
     {
     for (std::pair< const std::string, vtkProp3D* > iter : this->Internal->DisplayedActors)
       {
-      this->GetRenderer()->RemoveViewProp(iter.second);
+      this->Internal->RemoveDisplayedProp(iter.first);
       }
     this->RemoveModelObservers(1);
     this->Internal->DisplayedActors.clear();
@@ -1052,6 +1404,26 @@ void vtkMRMLModelDisplayableManager::UpdateModelMesh(vtkMRMLDisplayableNode *dis
       continue;
       }
 
+    // Render polydata models that do not need an individual pipeline as blocks of a shared actor
+    if (this->BatchRendering && modelDisplayNode && !hasNonLinearTransform
+      && !(this->Internal->ClippingOn && clipping)
+      && !vtkMRMLSliceLogic::IsSliceModelNode(displayableNode)
+      && (!modelNode || modelNode->GetMeshType() == vtkMRMLModelNode::PolyDataMeshType))
+      {
+      vtkMRMLDisplayNode* propertiesDisplayNode =
+        (hdnode && displayNode->GetFolderDisplayOverrideAllowed()) ? hdnode : displayNode;
+      if (this->Internal->UpdateBatchedDisplayNode(modelDisplayNode, propertiesDisplayNode, displayableNode, meshConnection))
+        {
+        continue;
+        }
+      }
+    std::string displayNodeID = displayNode->GetID();
+    if (this->Internal->RemoveFromBatch(displayNodeID))
+      {
+      // the display node is rendered by an individual actor from now on
+      this->RemoveDisplayedID(displayNodeID);
+      }
+
     // create TransformFilter for non-linear transform
     vtkTransformFilter* transformFilter = nullptr;
     if (hasNonLinearTransform)
@@ -1252,7 +1624,7 @@ void vtkMRMLModelDisplayableManager::RemoveModelProps()
       this->GetMRMLScene() ? this->GetMRMLScene()->GetNodeByID(iter->first) : nullptr);
     if (modelDisplayNode == nullptr)
       {
-      this->GetRenderer()->RemoveViewProp(iter->second);
+      this->Internal->RemoveDisplayedProp(iter->first);
       removedIDs.push_back(iter->first);
       }
     else
@@ -1272,7 +1644,7 @@ void vtkMRMLModelDisplayableManager::RemoveModelProps()
 
         if (clipIter->second  || (this->Internal->ClippingOn && clipIter->second != clipModel))
           {
-          this->GetRenderer()->RemoveViewProp(iter->second);
+          this->Internal->RemoveDisplayedProp(iter->first);
           removedIDs.push_back(iter->first);
           }
         }
@@ -1304,7 +1676,7 @@ void vtkMRMLModelDisplayableManager::RemoveDisplayable(vtkMRMLDisplayableNode* m
       this->Internal->DisplayedActors.find(displayNodeIDToRemove);
     if (iter != this->Internal->DisplayedActors.end())
       {
-      this->GetRenderer()->RemoveViewProp(iter->second);
+      this->Internal->RemoveDisplayedProp(iter->first);
       removedIDs.push_back(iter->first);
       }
     }
@@ -1345,6 +1717,15 @@ int vtkMRMLModelDisplayableManager::GetDisplayedModelsVisibility(vtkMRMLDisplayN
     return 0;
     }
 
+  std::map<std::string, vtkInternal::BatchedDisplayNode>::iterator batchedIt =
+    this->Internal->BatchedDisplayNodes.find(displayNode->GetID());
+  if (batchedIt != this->Internal->BatchedDisplayNodes.end())
+    {
+    vtkCompositeDataDisplayAttributes* attributes =
+      this->Internal->BatchGroups[batchedIt->second.GroupKey].Attributes;
+    return attributes->GetBlockVisibility(batchedIt->second.Data) ? 1 : 0;
+    }
+
   vtkProp3D* actor = it->second;
   return actor->GetVisibility();
 }
@@ -1370,6 +1751,7 @@ void vtkMRMLModelDisplayableManager::RemoveModelObservers(int clearCache)
     }
   if (clearCache)
     {
+    this->Internal->ClearBatches();
     this->Internal->DisplayableNodes.clear();
     this->Internal->DisplayedActors.clear();
     this->Internal->DisplayedNodes.clear();
@@ -1458,6 +1840,14 @@ void vtkMRMLModelDisplayableManager::SetModelDisplayProperty(vtkMRMLDisplayableN
     bool visible = hierarchyVisibility
       && modelDisplayNode->GetVisibility() && modelDisplayNode->GetVisibility3D()
       && modelDisplayNode->IsDisplayableInView(this->GetMRMLViewNode()->GetID());
+
+    // Batched models share the actor, only their block attributes are updated
+    if (this->Internal->UpdateBatchedDisplayProperty(modelDisplayNode, displayNode,
+      visible, hierarchyOpacity * modelDisplayNode->GetOpacity()))
+      {
+      continue;
+      }
+
     prop->SetVisibility(visible);
 
     vtkMapper* mapper = actor ? actor->GetMapper() : nullptr;
@@ -118,6 +118,23 @@ public:
   ///   False otherwise.
   static bool IsCellScalarsActive(vtkMRMLDisplayNode* displayNode, vtkMRMLModelNode* model = nullptr);
 
+  /// Render compatible models using a single actor per group.
+  /// If enabled, model display nodes that share the same display properties (representation,
+  /// shading, lighting, culling, edges, parent transform) are rendered as blocks of a composite
+  /// dataset, by one vtkCompositePolyDataMapper2. Color, opacity, and visibility are set as
+  /// block attributes, therefore changing them does not update the rendering pipeline.
+  /// Models that show scalars, have texture, are clipped, are non-linearly transformed, or
+  /// are not polydata are rendered with their own actor.
+  /// GetActorByID() returns the shared actor for batched display nodes.
+  /// Backface color offset (vtkMRMLModelDisplayNode::BackfaceColorHSVOffset) is not applied
+  /// on batched models. Disabled by default.
+  void SetBatchRendering(bool enable);
+  vtkGetMacro(BatchRendering, bool);
+  vtkBooleanMacro(BatchRendering, bool);
+
+  /// Number of shared actors used for rendering batched models
+  int GetNumberOfBatchGroups();
+
 protected:
   int ActiveInteractionModes() override;
 
@@ -170,6 +187,8 @@ protected:
 
   friend class vtkMRMLThreeDViewInteractorStyle; // Access to RequestRender();
 
+  bool BatchRendering;
+
 private:
   vtkMRMLModelDisplayableManager(const vtkMRMLModelDisplayableManager&) = delete;
   void operator=(const vtkMRMLModelDisplayableManager&) = delete;
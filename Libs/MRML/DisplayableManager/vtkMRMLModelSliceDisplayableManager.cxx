@@ -20,6 +20,7 @@
 #include "vtkMRMLModelDisplayableManager.h"
 
 // MRML includes
+#include <vtkIndexedPolyDataPlaneCutter.h>
 #include <vtkMRMLApplicationLogic.h>
 #include <vtkMRMLColorNode.h>
 #include <vtkMRMLDisplayNode.h>
@@ -48,6 +49,7 @@
 #include <vtkObjectFactory.h>
 #include <vtkPlane.h>
 #include <vtkPointLocator.h>
+#include <vtkPolyData.h>
 #include <vtkPolyDataMapper2D.h>
 #include <vtkProperty2D.h>
 #include <vtkRenderer.h>
@@ -85,6 +87,7 @@ public:
     vtkSmartPointer<vtkPlane> Plane;
     vtkSmartPointer<vtkPlaneCutter> Cutter;
     vtkSmartPointer<vtkCompositeDataGeometryFilter> GeometryFilter; // appends multiple cut pieces into a single polydata
+    vtkSmartPointer<vtkIndexedPolyDataPlaneCutter> IndexedCutter; // faster cutter for surface meshes, index is reused while scrolling
     vtkSmartPointer<vtkSampleImplicitFunctionFilter> SliceDistance;
     vtkSmartPointer<vtkProp> Actor;
     };
@@ -312,6 +315,7 @@ void vtkMRMLModelSliceDisplayableManager::vtkInternal
   pipeline->Actor = actor.GetPointer();
   pipeline->Cutter = vtkSmartPointer<vtkPlaneCutter>::New();
   pipeline->GeometryFilter = vtkSmartPointer<vtkCompositeDataGeometryFilter>::New();
+  pipeline->IndexedCutter = vtkSmartPointer<vtkIndexedPolyDataPlaneCutter>::New();
   pipeline->SliceDistance = vtkSmartPointer<vtkSampleImplicitFunctionFilter>::New();
   pipeline->TransformToSlice = vtkSmartPointer<vtkTransform>::New();
   pipeline->NodeToWorld = vtkSmartPointer<vtkGeneralTransform>::New();
@@ -327,6 +331,8 @@ void vtkMRMLModelSliceDisplayableManager::vtkInternal
   pipeline->Cutter->BuildTreeOff(); // the cutter crashes for complex geometries if build tree is enabled
   pipeline->Cutter->SetInputConnection(pipeline->ModelWarper->GetOutputPort());
   pipeline->GeometryFilter->SetInputConnection(pipeline->Cutter->GetOutputPort());
+  pipeline->IndexedCutter->SetPlane(pipeline->Plane);
+  pipeline->IndexedCutter->SetInputConnection(pipeline->ModelWarper->GetOutputPort());
   // Projection is created from outer surface of volumetric meshes (for polydata surface
   // extraction is just shallow-copy)
   pipeline->SurfaceExtractor->SetInputConnection(pipeline->ModelWarper->GetOutputPort());
@@ -473,14 +479,27 @@ void vtkMRMLModelSliceDisplayableManager::vtkInternal
     {
     // show intersection in the slice view
     // include clipper in the pipeline
-    pipeline->Transformer->SetInputConnection(pipeline->GeometryFilter->GetOutputPort());
-    pipeline->Cutter->SetInputConnection(pipeline->ModelWarper->GetOutputPort());
+    // Surface meshes are cut using a spatial index that is kept while only the slice offset changes,
+    // volumetric meshes and meshes containing vertices or lines are cut by the generic plane cutter.
+    vtkPolyData* polyData = vtkPolyData::SafeDownCast(pointSet);
+    vtkPolyDataAlgorithm* cutter = nullptr;
+    if (polyData && polyData->GetNumberOfVerts() == 0 && polyData->GetNumberOfLines() == 0)
+      {
+      cutter = pipeline->IndexedCutter;
+      }
+    else
+      {
+      cutter = pipeline->GeometryFilter;
+      pipeline->Cutter->SetInputConnection(pipeline->ModelWarper->GetOutputPort());
+      }
+    pipeline->Transformer->SetInputConnection(cutter->GetOutputPort());
 
     // If there is no input or if the input has no points, the vtkTransformPolyDataFilter will display an error message
     // on every update: "No input data".
     // To prevent the error, if the input is empty then the actor should not be visible since there is nothing to display.
-    pipeline->GeometryFilter->Update();
-    if (!pipeline->GeometryFilter->GetOutput() || pipeline->GeometryFilter->GetOutput()->GetNumberOfPoints() < 1)
+    cutter->Update();
+    vtkPolyData* cutterOutput = vtkPolyData::SafeDownCast(cutter->GetOutputDataObject(0));
+    if (!cutterOutput || cutterOutput->GetNumberOfPoints() < 1)
       {
       pipeline->Actor->SetVisibility(false);
       return;
@@ -0,0 +1,120 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRMLLogic includes
+#include "vtkImageLabelMapToRGBA.h"
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkLookupTable.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+
+// STD includes
+#include <cstdlib>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+bool CheckPixel(vtkImageData* image, int x, int y, int r, int g, int b, int a)
+{
+  unsigned char* pixel = static_cast<unsigned char*>(image->GetScalarPointer(x, y, 0));
+  int expected[4] = { r, g, b, a };
+  for (int c = 0; c < 4; ++c)
+    {
+    if (abs(pixel[c] - expected[c]) > 1)
+      {
+      std::cerr << "Pixel (" << x << ", " << y << ") mismatch: got ("
+        << int(pixel[0]) << ", " << int(pixel[1]) << ", " << int(pixel[2]) << ", " << int(pixel[3])
+        << "), expected (" << r << ", " << g << ", " << b << ", " << a << ")" << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkImageLabelMapToRGBATest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  // 5x5 labelmap: label 1 in the central 3x3 block, label 2 in the corner
+  vtkNew<vtkImageData> labelmap;
+  labelmap->SetDimensions(5, 5, 1);
+  labelmap->AllocateScalars(VTK_SHORT, 1);
+  labelmap->GetPointData()->GetScalars()->Fill(0);
+  for (int y = 1; y <= 3; ++y)
+    {
+    for (int x = 1; x <= 3; ++x)
+      {
+      *static_cast<short*>(labelmap->GetScalarPointer(x, y, 0)) = 1;
+      }
+    }
+  *static_cast<short*>(labelmap->GetScalarPointer(0, 0, 0)) = 2;
+
+  vtkNew<vtkLookupTable> fillLut;
+  fillLut->SetNumberOfTableValues(3);
+  fillLut->SetRange(0, 2);
+  fillLut->Build();
+  fillLut->SetTableValue(0, 0.0, 0.0, 0.0, 0.0);
+  fillLut->SetTableValue(1, 1.0, 0.0, 0.0, 128.0 / 255.0);
+  fillLut->SetTableValue(2, 0.0, 1.0, 0.0, 1.0);
+
+  vtkNew<vtkLookupTable> outlineLut;
+  outlineLut->SetNumberOfTableValues(3);
+  outlineLut->SetRange(0, 2);
+  outlineLut->Build();
+  outlineLut->SetTableValue(0, 0.0, 0.0, 0.0, 0.0);
+  outlineLut->SetTableValue(1, 0.0, 0.0, 1.0, 1.0);
+  outlineLut->SetTableValue(2, 0.0, 1.0, 0.0, 0.0); // outline hidden
+
+  vtkNew<vtkImageLabelMapToRGBA> filter;
+  filter->SetInputData(labelmap);
+  filter->SetFillLookupTable(fillLut);
+  filter->SetOutlineLookupTable(outlineLut);
+  filter->SetOutline(1);
+  filter->Update();
+
+  vtkImageData* output = filter->GetOutput();
+  CHECK_INT(output->GetNumberOfScalarComponents(), 4);
+  CHECK_INT(output->GetScalarType(), VTK_UNSIGNED_CHAR);
+
+  // Background is transparent
+  CHECK_BOOL(CheckPixel(output, 4, 4, 0, 0, 0, 0), true);
+  // Inside of label 1: fill only
+  CHECK_BOOL(CheckPixel(output, 2, 2, 255, 0, 0, 128), true);
+  // Border of label 1: fill composed over outline
+  CHECK_BOOL(CheckPixel(output, 1, 1, 128, 0, 127, 255), true);
+  // Label 2 has hidden outline: fill only
+  CHECK_BOOL(CheckPixel(output, 0, 0, 0, 255, 0, 255), true);
+
+  // Outline disabled: border of label 1 shows fill only
+  filter->SetOutline(0);
+  filter->Update();
+  CHECK_BOOL(CheckPixel(filter->GetOutput(), 1, 1, 255, 0, 0, 128), true);
+
+  // Lookup table change is detected (segment hidden)
+  fillLut->SetTableValue(1, 1.0, 0.0, 0.0, 0.0);
+  filter->Update();
+  CHECK_BOOL(CheckPixel(filter->GetOutput(), 2, 2, 255, 0, 0, 0), true);
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
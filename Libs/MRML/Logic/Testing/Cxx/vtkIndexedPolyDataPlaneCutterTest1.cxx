@@ -0,0 +1,152 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRMLLogic includes
+#include "vtkIndexedPolyDataPlaneCutter.h"
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+
+// VTK includes
+#include <vtkCutter.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkPlane.h>
+#include <vtkPlaneSource.h>
+#include <vtkPolyData.h>
+#include <vtkSphereSource.h>
+
+// STD includes
+#include <cmath>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+bool CheckCut(vtkIndexedPolyDataPlaneCutter* indexedCutter, vtkCutter* referenceCutter, vtkPlane* plane, double radius)
+{
+  indexedCutter->Update();
+  referenceCutter->Update();
+  vtkPolyData* output = indexedCutter->GetOutput();
+  vtkPolyData* reference = referenceCutter->GetOutput();
+  if (output->GetNumberOfLines() != reference->GetNumberOfLines()
+    || output->GetNumberOfPoints() != reference->GetNumberOfPoints())
+    {
+    std::cerr << "Cut mismatch: got " << output->GetNumberOfLines() << " lines and " << output->GetNumberOfPoints()
+      << " points, expected " << reference->GetNumberOfLines() << " lines and " << reference->GetNumberOfPoints()
+      << " points" << std::endl;
+    return false;
+    }
+  for (vtkIdType pointId = 0; pointId < output->GetNumberOfPoints(); ++pointId)
+    {
+    double point[3] = { 0.0, 0.0, 0.0 };
+    output->GetPoint(pointId, point);
+    if (fabs(plane->EvaluateFunction(point)) > 1e-6 || vtkMath::Norm(point) > radius + 1e-6)
+      {
+      std::cerr << "Invalid intersection point: " << point[0] << ", " << point[1] << ", " << point[2] << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkIndexedPolyDataPlaneCutterTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  const double radius = 10.0;
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetRadius(radius);
+  sphere->SetThetaResolution(64);
+  sphere->SetPhiResolution(64);
+  sphere->Update();
+
+  vtkNew<vtkPlane> plane;
+  plane->SetNormal(0.0, 0.0, 1.0);
+  plane->SetOrigin(0.0, 0.0, 0.123);
+
+  vtkNew<vtkIndexedPolyDataPlaneCutter> indexedCutter;
+  indexedCutter->SetInputConnection(sphere->GetOutputPort());
+  indexedCutter->SetPlane(plane);
+
+  vtkNew<vtkCutter> referenceCutter;
+  referenceCutter->SetInputConnection(sphere->GetOutputPort());
+  referenceCutter->SetCutFunction(plane);
+
+  CHECK_BOOL(CheckCut(indexedCutter, referenceCutter, plane, radius), true);
+  CHECK_BOOL(indexedCutter->GetOutput()->GetNumberOfLines() > 0, true);
+  CHECK_INT(indexedCutter->GetNumberOfIndexBuilds(), 1);
+  // Only a fraction of the triangles are visited
+  CHECK_BOOL(indexedCutter->GetNumberOfTestedTriangles() < sphere->GetOutput()->GetNumberOfPolys() / 4, true);
+
+  // Moving the plane along the normal reuses the index
+  plane->SetOrigin(0.0, 0.0, -7.31);
+  CHECK_BOOL(CheckCut(indexedCutter, referenceCutter, plane, radius), true);
+  plane->SetOrigin(0.0, 0.0, 4.56);
+  CHECK_BOOL(CheckCut(indexedCutter, referenceCutter, plane, radius), true);
+  CHECK_INT(indexedCutter->GetNumberOfIndexBuilds(), 1);
+
+  // Flipped normal reuses the index
+  plane->SetNormal(0.0, 0.0, -1.0);
+  CHECK_BOOL(CheckCut(indexedCutter, referenceCutter, plane, radius), true);
+  CHECK_INT(indexedCutter->GetNumberOfIndexBuilds(), 1);
+
+  // Plane outside of the mesh
+  plane->SetOrigin(0.0, 0.0, 2.0 * radius);
+  indexedCutter->Update();
+  CHECK_INT(indexedCutter->GetOutput()->GetNumberOfPoints(), 0);
+  CHECK_INT(indexedCutter->GetNumberOfIndexBuilds(), 1);
+
+  // Oblique normal rebuilds the index
+  plane->SetNormal(0.3, -0.5, 0.8);
+  plane->SetOrigin(1.1, 0.7, 0.3);
+  CHECK_BOOL(CheckCut(indexedCutter, referenceCutter, plane, radius), true);
+  CHECK_INT(indexedCutter->GetNumberOfIndexBuilds(), 2);
+
+  // Input modification rebuilds the index
+  sphere->SetRadius(radius / 2.0);
+  CHECK_BOOL(CheckCut(indexedCutter, referenceCutter, plane, radius / 2.0), true);
+  CHECK_INT(indexedCutter->GetNumberOfIndexBuilds(), 3);
+
+  // Plane through a row of vertices: intersection points are the vertices, without zero-length segments
+  vtkNew<vtkPlaneSource> grid;
+  grid->SetOrigin(0.0, 0.0, 0.0);
+  grid->SetPoint1(4.0, 0.0, 0.0);
+  grid->SetPoint2(0.0, 0.0, 4.0);
+  grid->SetResolution(4, 4);
+  indexedCutter->SetInputConnection(grid->GetOutputPort());
+  plane->SetNormal(0.0, 0.0, 1.0);
+  plane->SetOrigin(0.0, 0.0, 1.0);
+  indexedCutter->Update();
+  vtkPolyData* gridCut = indexedCutter->GetOutput();
+  CHECK_INT(gridCut->GetNumberOfPoints(), 5);
+  CHECK_INT(gridCut->GetNumberOfLines(), 4);
+  double totalLength = 0.0;
+  for (vtkIdType lineId = 0; lineId < gridCut->GetNumberOfLines(); ++lineId)
+    {
+    vtkIdType npts = 0;
+    const vtkIdType* pts = nullptr;
+    gridCut->GetLines()->GetCellAtId(lineId, npts, pts);
+    CHECK_INT(npts, 2);
+    double lineLength = sqrt(vtkMath::Distance2BetweenPoints(gridCut->GetPoint(pts[0]), gridCut->GetPoint(pts[1])));
+    CHECK_BOOL(lineLength > 0.0, true);
+    totalLength += lineLength;
+    }
+  CHECK_DOUBLE_TOLERANCE(totalLength, 4.0, 1e-9);
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
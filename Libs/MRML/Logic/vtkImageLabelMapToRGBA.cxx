@@ -0,0 +1,330 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#include "vtkImageLabelMapToRGBA.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkLookupTable.h>
+#include <vtkObjectFactory.h>
+#include <vtkStreamingDemandDrivenPipeline.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+// Maximum number of entries in the color tables. Labelmaps with larger label value
+// range are not expected (label values are assigned consecutively to segments).
+const int MAXIMUM_COLOR_TABLE_SIZE = 1 << 20;
+}
+
+//------------------------------------------------------------------------------
+vtkStandardNewMacro(vtkImageLabelMapToRGBA);
+
+//----------------------------------------------------------------------------
+vtkImageLabelMapToRGBA::vtkImageLabelMapToRGBA()
+{
+  this->FillLookupTable = nullptr;
+  this->OutlineLookupTable = nullptr;
+  this->Outline = 1;
+  this->Background = 0.0;
+  this->TableFirstLabelValue = 0;
+}
+
+//----------------------------------------------------------------------------
+vtkImageLabelMapToRGBA::~vtkImageLabelMapToRGBA()
+{
+  this->SetFillLookupTable(nullptr);
+  this->SetOutlineLookupTable(nullptr);
+}
+
+//----------------------------------------------------------------------------
+void vtkImageLabelMapToRGBA::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Outline: " << this->Outline << "\n";
+  os << indent << "Background: " << this->Background << "\n";
+  os << indent << "FillLookupTable: " << this->FillLookupTable << "\n";
+  os << indent << "OutlineLookupTable: " << this->OutlineLookupTable << "\n";
+}
+
+//----------------------------------------------------------------------------
+vtkCxxSetObjectMacro(vtkImageLabelMapToRGBA, FillLookupTable, vtkLookupTable);
+vtkCxxSetObjectMacro(vtkImageLabelMapToRGBA, OutlineLookupTable, vtkLookupTable);
+
+//----------------------------------------------------------------------------
+vtkMTimeType vtkImageLabelMapToRGBA::GetMTime()
+{
+  vtkMTimeType mTime = this->Superclass::GetMTime();
+  if (this->FillLookupTable)
+    {
+    mTime = std::max(mTime, this->FillLookupTable->GetMTime());
+    }
+  if (this->OutlineLookupTable)
+    {
+    mTime = std::max(mTime, this->OutlineLookupTable->GetMTime());
+    }
+  return mTime;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageLabelMapToRGBA::RequestInformation(vtkInformation* vtkNotUsed(request),
+  vtkInformationVector** vtkNotUsed(inputVector), vtkInformationVector* outputVector)
+{
+  vtkInformation* outInfo = outputVector->GetInformationObject(0);
+  vtkDataObject::SetPointDataActiveScalarInfo(outInfo, VTK_UNSIGNED_CHAR, 4);
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageLabelMapToRGBA::RequestUpdateExtent(vtkInformation* vtkNotUsed(request),
+  vtkInformationVector** inputVector, vtkInformationVector* outputVector)
+{
+  vtkInformation* inInfo = inputVector[0]->GetInformationObject(0);
+  vtkInformation* outInfo = outputVector->GetInformationObject(0);
+
+  // Outline detection needs the neighbors of the output pixels
+  int wholeExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  inInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), wholeExtent);
+  int inExt[6] = { 0, -1, 0, -1, 0, -1 };
+  outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), inExt);
+  for (int axis = 0; axis < 2; ++axis)
+    {
+    inExt[axis * 2] = std::max(inExt[axis * 2] - this->Outline, wholeExtent[axis * 2]);
+    inExt[axis * 2 + 1] = std::min(inExt[axis * 2 + 1] + this->Outline, wholeExtent[axis * 2 + 1]);
+    }
+  inInfo->Set(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), inExt, 6);
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageLabelMapToRGBA::UpdateColorTables()
+{
+  this->FillColorTable.clear();
+  this->OutlineColorTable.clear();
+  this->TableFirstLabelValue = 0;
+
+  vtkLookupTable* luts[2] = { this->FillLookupTable, this->OutlineLookupTable };
+  bool rangeValid = false;
+  double labelRange[2] = { 0.0, -1.0 };
+  for (vtkLookupTable* lut : luts)
+    {
+    if (!lut)
+      {
+      continue;
+      }
+    double* tableRange = lut->GetTableRange();
+    if (!rangeValid)
+      {
+      labelRange[0] = tableRange[0];
+      labelRange[1] = tableRange[1];
+      rangeValid = true;
+      }
+    else
+      {
+      labelRange[0] = std::min(labelRange[0], tableRange[0]);
+      labelRange[1] = std::max(labelRange[1], tableRange[1]);
+      }
+    }
+  if (!rangeValid)
+    {
+    return;
+    }
+
+  int firstLabelValue = static_cast<int>(std::ceil(labelRange[0]));
+  int lastLabelValue = static_cast<int>(std::floor(labelRange[1]));
+  if (lastLabelValue < firstLabelValue)
+    {
+    return;
+    }
+  if (lastLabelValue - firstLabelValue + 1 > MAXIMUM_COLOR_TABLE_SIZE)
+    {
+    vtkWarningMacro("UpdateColorTables: label value range is too large, only the first "
+      << MAXIMUM_COLOR_TABLE_SIZE << " values are displayed");
+    lastLabelValue = firstLabelValue + MAXIMUM_COLOR_TABLE_SIZE - 1;
+    }
+  int numberOfLabels = lastLabelValue - firstLabelValue + 1;
+  this->TableFirstLabelValue = firstLabelValue;
+
+  std::vector<unsigned char>* colorTables[2] = { &this->FillColorTable, &this->OutlineColorTable };
+  for (int tableIndex = 0; tableIndex < 2; ++tableIndex)
+    {
+    std::vector<unsigned char>& colorTable = *colorTables[tableIndex];
+    colorTable.assign(numberOfLabels * 4, 0);
+    vtkLookupTable* lut = luts[tableIndex];
+    if (!lut)
+      {
+      continue;
+      }
+    double* tableRange = lut->GetTableRange();
+    for (int labelIndex = 0; labelIndex < numberOfLabels; ++labelIndex)
+      {
+      double labelValue = firstLabelValue + labelIndex;
+      if (labelValue == this->Background || labelValue < tableRange[0] || labelValue > tableRange[1])
+        {
+        continue;
+        }
+      double rgba[4] = { 0.0, 0.0, 0.0, 0.0 };
+      lut->GetTableValue(lut->GetIndex(labelValue), rgba);
+      for (int c = 0; c < 4; ++c)
+        {
+        colorTable[labelIndex * 4 + c] = static_cast<unsigned char>(std::min(255.0, std::max(0.0, rgba[c] * 255.0 + 0.5)));
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkImageLabelMapToRGBA::RequestData(vtkInformation* request,
+  vtkInformationVector** inputVector, vtkInformationVector* outputVector)
+{
+  // Color tables are shared by all threads, compute them once
+  this->UpdateColorTables();
+  return this->Superclass::RequestData(request, inputVector, outputVector);
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+void vtkImageLabelMapToRGBAExecute(vtkImageLabelMapToRGBA* self, vtkImageData* inData,
+  vtkImageData* outData, int outExt[6], int firstLabelValue, int numberOfLabels,
+  const unsigned char* fillTable, const unsigned char* outlineTable)
+{
+  int inExt[6] = { 0, -1, 0, -1, 0, -1 };
+  inData->GetExtent(inExt);
+  vtkIdType inInc[3] = { 0, 0, 0 };
+  inData->GetIncrements(inInc);
+  const T backgroundValue = static_cast<T>(self->GetBackground());
+  const int outline = self->GetOutline();
+
+  for (int z = outExt[4]; z <= outExt[5]; ++z)
+    {
+    for (int y = outExt[2]; !self->AbortExecute && y <= outExt[3]; ++y)
+      {
+      const T* inPtr = static_cast<T*>(inData->GetScalarPointer(outExt[0], y, z));
+      unsigned char* outPtr = static_cast<unsigned char*>(outData->GetScalarPointer(outExt[0], y, z));
+      for (int x = outExt[0]; x <= outExt[1]; ++x, ++inPtr, outPtr += 4)
+        {
+        const T labelValue = *inPtr;
+        int labelIndex = static_cast<int>(labelValue) - firstLabelValue;
+        if (labelValue == backgroundValue || labelIndex < 0 || labelIndex >= numberOfLabels)
+          {
+          outPtr[0] = outPtr[1] = outPtr[2] = outPtr[3] = 0;
+          continue;
+          }
+        const unsigned char* fillColor = fillTable + labelIndex * 4;
+        const unsigned char* outlineColor = outlineTable + labelIndex * 4;
+
+        // Outline pixel: any neighbor within the outline distance has a different
+        // value or is outside of the image (same rule as vtkImageLabelOutline).
+        bool outlinePixel = false;
+        if (outline > 0 && outlineColor[3] > 0)
+          {
+          for (int dy = -outline; dy <= outline && !outlinePixel; ++dy)
+            {
+            int ny = y + dy;
+            if (ny < inExt[2] || ny > inExt[3])
+              {
+              outlinePixel = true;
+              break;
+              }
+            const T* neighborRowPtr = inPtr + dy * inInc[1];
+            for (int dx = -outline; dx <= outline; ++dx)
+              {
+              int nx = x + dx;
+              if (nx < inExt[0] || nx > inExt[1] || neighborRowPtr[dx * inInc[0]] != labelValue)
+                {
+                outlinePixel = true;
+                break;
+                }
+              }
+            }
+          }
+
+        if (!outlinePixel)
+          {
+          outPtr[0] = fillColor[0];
+          outPtr[1] = fillColor[1];
+          outPtr[2] = fillColor[2];
+          outPtr[3] = fillColor[3];
+          continue;
+          }
+
+        // Fill is rendered over the outline: compose them into a single RGBA value
+        // that gives the same result when rendered over the background.
+        double fillAlpha = fillColor[3] / 255.0;
+        double outlineAlpha = outlineColor[3] / 255.0;
+        double alpha = fillAlpha + outlineAlpha * (1.0 - fillAlpha);
+        if (alpha <= 0.0)
+          {
+          outPtr[0] = outPtr[1] = outPtr[2] = outPtr[3] = 0;
+          continue;
+          }
+        for (int c = 0; c < 3; ++c)
+          {
+          double color = (fillAlpha * fillColor[c] + (1.0 - fillAlpha) * outlineAlpha * outlineColor[c]) / alpha;
+          outPtr[c] = static_cast<unsigned char>(std::min(255.0, color + 0.5));
+          }
+        outPtr[3] = static_cast<unsigned char>(std::min(255.0, alpha * 255.0 + 0.5));
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageLabelMapToRGBA::ThreadedRequestData(vtkInformation* vtkNotUsed(request),
+  vtkInformationVector** vtkNotUsed(inputVector), vtkInformationVector* vtkNotUsed(outputVector),
+  vtkImageData*** inData, vtkImageData** outData, int outExt[6], int vtkNotUsed(threadId))
+{
+  vtkImageData* input = inData[0][0];
+  vtkImageData* output = outData[0];
+  if (!input || !output)
+    {
+    return;
+    }
+  if (input->GetNumberOfScalarComponents() != 1)
+    {
+    vtkErrorMacro("ThreadedRequestData: Input has " << input->GetNumberOfScalarComponents()
+      << " instead of 1 scalar component.");
+    return;
+    }
+
+  int numberOfLabels = static_cast<int>(this->FillColorTable.size() / 4);
+  if (numberOfLabels == 0)
+    {
+    // No colors are defined, all pixels are transparent
+    for (int z = outExt[4]; z <= outExt[5]; ++z)
+      {
+      for (int y = outExt[2]; y <= outExt[3]; ++y)
+        {
+        unsigned char* outPtr = static_cast<unsigned char*>(output->GetScalarPointer(outExt[0], y, z));
+        std::fill(outPtr, outPtr + (outExt[1] - outExt[0] + 1) * 4, 0);
+        }
+      }
+    return;
+    }
+
+  switch (input->GetScalarType())
+    {
+    vtkTemplateMacro(vtkImageLabelMapToRGBAExecute<VTK_TT>(this, input, output, outExt,
+      this->TableFirstLabelValue, numberOfLabels, this->FillColorTable.data(), this->OutlineColorTable.data()));
+    default:
+      vtkErrorMacro("ThreadedRequestData: Unknown input scalar type");
+      return;
+    }
+}
@@ -0,0 +1,102 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkImageLabelMapToRGBA_h
+#define __vtkImageLabelMapToRGBA_h
+
+// VTK includes
+#include <vtkThreadedImageAlgorithm.h>
+
+#include "vtkMRMLLogicExport.h"
+
+// STD includes
+#include <vector>
+
+class vtkLookupTable;
+
+/// \brief Colorize a labelmap slice with filled and outlined labels in a single pass.
+///
+/// Produces the same RGBA image as blending the output of vtkImageMapToRGBA
+/// (using FillLookupTable) over the output of vtkImageLabelOutline followed by
+/// vtkImageMapToRGBA (using OutlineLookupTable), but it reads the input only once
+/// and requires a single image actor for display.
+///
+/// Lookup tables are indexed by label value (IndexedLookupOff, table range set to
+/// the label value range), so they can store color, opacity and visibility
+/// (opacity = 0) of each label. Label values outside the table range and the
+/// background value are transparent.
+///
+/// The outline is computed in the XY plane, as in vtkImageLabelOutline.
+class VTK_MRML_LOGIC_EXPORT vtkImageLabelMapToRGBA : public vtkThreadedImageAlgorithm
+{
+public:
+  static vtkImageLabelMapToRGBA *New();
+  vtkTypeMacro(vtkImageLabelMapToRGBA, vtkThreadedImageAlgorithm);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  /// Lookup table defining the fill color and opacity of each label
+  void SetFillLookupTable(vtkLookupTable* lut);
+  vtkGetObjectMacro(FillLookupTable, vtkLookupTable);
+
+  /// Lookup table defining the outline color and opacity of each label.
+  /// If not set then outline is not displayed.
+  void SetOutlineLookupTable(vtkLookupTable* lut);
+  vtkGetObjectMacro(OutlineLookupTable, vtkLookupTable);
+
+  /// Thickness of the outline in pixels. 0 disables the outline.
+  vtkSetClampMacro(Outline, int, 0, 100);
+  vtkGetMacro(Outline, int);
+
+  /// Background pixel value in the image (usually 0). Always transparent.
+  vtkSetMacro(Background, double);
+  vtkGetMacro(Background, double);
+
+  /// Include lookup table modifications in the modified time
+  vtkMTimeType GetMTime() override;
+
+protected:
+  vtkImageLabelMapToRGBA();
+  ~vtkImageLabelMapToRGBA() override;
+
+  int RequestInformation(vtkInformation* request, vtkInformationVector** inputVector,
+    vtkInformationVector* outputVector) override;
+  int RequestUpdateExtent(vtkInformation* request, vtkInformationVector** inputVector,
+    vtkInformationVector* outputVector) override;
+  int RequestData(vtkInformation* request, vtkInformationVector** inputVector,
+    vtkInformationVector* outputVector) override;
+  void ThreadedRequestData(vtkInformation* request, vtkInformationVector** inputVector,
+    vtkInformationVector* outputVector, vtkImageData*** inData, vtkImageData** outData,
+    int outExt[6], int threadId) override;
+
+  /// Fill color tables from the lookup tables. Called before threaded execution.
+  void UpdateColorTables();
+
+  vtkLookupTable* FillLookupTable;
+  vtkLookupTable* OutlineLookupTable;
+  int Outline;
+  double Background;
+
+  /// First label value in the color tables
+  int TableFirstLabelValue;
+  /// RGBA colors (4 values per label) for fill and outline, starting at TableFirstLabelValue
+  std::vector<unsigned char> FillColorTable;
+  std::vector<unsigned char> OutlineColorTable;
+
+private:
+  vtkImageLabelMapToRGBA(const vtkImageLabelMapToRGBA&) = delete;
+  void operator=(const vtkImageLabelMapToRGBA&) = delete;
+};
+
+#endif
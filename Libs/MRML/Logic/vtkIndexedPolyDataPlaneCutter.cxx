@@ -0,0 +1,413 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#include "vtkIndexedPolyDataPlaneCutter.h"
+
+// VTK includes
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkPlane.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkTriangleFilter.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+namespace
+{
+// Normals that differ less than this (1 - cos(angle)) are considered the same
+const double NORMAL_TOLERANCE = 1e-12;
+// Upper limit for the number of slabs
+const vtkIdType MAXIMUM_NUMBER_OF_SLABS = 1 << 20;
+}
+
+//------------------------------------------------------------------------------
+vtkStandardNewMacro(vtkIndexedPolyDataPlaneCutter);
+
+//----------------------------------------------------------------------------
+vtkCxxSetObjectMacro(vtkIndexedPolyDataPlaneCutter, Plane, vtkPlane);
+
+//----------------------------------------------------------------------------
+vtkIndexedPolyDataPlaneCutter::vtkIndexedPolyDataPlaneCutter()
+{
+  this->Plane = nullptr;
+  this->IndexInputMTime = 0;
+  this->IndexNormal[0] = 0.0;
+  this->IndexNormal[1] = 0.0;
+  this->IndexNormal[2] = 0.0;
+  this->SlabOrigin = 0.0;
+  this->SlabWidth = 1.0;
+  this->NumberOfIndexBuilds = 0;
+  this->NumberOfTestedTriangles = 0;
+}
+
+//----------------------------------------------------------------------------
+vtkIndexedPolyDataPlaneCutter::~vtkIndexedPolyDataPlaneCutter()
+{
+  this->SetPlane(nullptr);
+}
+
+//----------------------------------------------------------------------------
+void vtkIndexedPolyDataPlaneCutter::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Plane: " << this->Plane << "\n";
+  os << indent << "NumberOfIndexBuilds: " << this->NumberOfIndexBuilds << "\n";
+  os << indent << "NumberOfTestedTriangles: " << this->NumberOfTestedTriangles << "\n";
+  os << indent << "NumberOfSlabs: " << (this->SlabOffsets.empty() ? 0 : this->SlabOffsets.size() - 1) << "\n";
+}
+
+//----------------------------------------------------------------------------
+vtkMTimeType vtkIndexedPolyDataPlaneCutter::GetMTime()
+{
+  vtkMTimeType mTime = this->Superclass::GetMTime();
+  if (this->Plane)
+    {
+    mTime = std::max(mTime, this->Plane->GetMTime());
+    }
+  return mTime;
+}
+
+//----------------------------------------------------------------------------
+void vtkIndexedPolyDataPlaneCutter::ResetIndex()
+{
+  this->Triangles = nullptr;
+  this->IndexInputMTime = 0;
+  this->PointPositions.clear();
+  this->TriangleMinimum.clear();
+  this->TriangleMaximum.clear();
+  this->SlabOffsets.clear();
+  this->SlabTriangleIds.clear();
+}
+
+//----------------------------------------------------------------------------
+bool vtkIndexedPolyDataPlaneCutter::IsIndexValid(vtkPolyData* input, const double normal[3])
+{
+  if (!this->Triangles || input->GetMTime() != this->IndexInputMTime)
+    {
+    return false;
+    }
+  return (1.0 - vtkMath::Dot(normal, this->IndexNormal)) < NORMAL_TOLERANCE;
+}
+
+//----------------------------------------------------------------------------
+void vtkIndexedPolyDataPlaneCutter::BuildIndex(vtkPolyData* input, const double normal[3])
+{
+  this->ResetIndex();
+  this->NumberOfIndexBuilds++;
+
+  // Triangulate polygons and strips (shallow copy so that the input is not connected to the internal filter)
+  vtkNew<vtkPolyData> inputCopy;
+  inputCopy->ShallowCopy(input);
+  vtkNew<vtkTriangleFilter> triangleFilter;
+  triangleFilter->SetInputData(inputCopy);
+  triangleFilter->PassVertsOff();
+  triangleFilter->PassLinesOff();
+  triangleFilter->Update();
+  this->Triangles = triangleFilter->GetOutput();
+  this->IndexInputMTime = input->GetMTime();
+  this->IndexNormal[0] = normal[0];
+  this->IndexNormal[1] = normal[1];
+  this->IndexNormal[2] = normal[2];
+
+  // Position of points along the normal
+  vtkPoints* points = this->Triangles->GetPoints();
+  vtkIdType numberOfPoints = (points ? points->GetNumberOfPoints() : 0);
+  this->PointPositions.resize(numberOfPoints);
+  for (vtkIdType pointId = 0; pointId < numberOfPoints; ++pointId)
+    {
+    double point[3] = { 0.0, 0.0, 0.0 };
+    points->GetPoint(pointId, point);
+    this->PointPositions[pointId] = vtkMath::Dot(point, normal);
+    }
+
+  // Range of triangles along the normal
+  vtkCellArray* polys = this->Triangles->GetPolys();
+  vtkIdType numberOfTriangles = this->Triangles->GetNumberOfPolys();
+  if (numberOfTriangles == 0)
+    {
+    return;
+    }
+  this->TriangleMinimum.resize(numberOfTriangles);
+  this->TriangleMaximum.resize(numberOfTriangles);
+  double overallMinimum = VTK_DOUBLE_MAX;
+  double overallMaximum = VTK_DOUBLE_MIN;
+  double sumOfTriangleSizes = 0.0;
+  vtkIdType npts = 0;
+  const vtkIdType* pts = nullptr;
+  polys->InitTraversal();
+  for (vtkIdType triangleId = 0; polys->GetNextCell(npts, pts); ++triangleId)
+    {
+    double minimum = this->PointPositions[pts[0]];
+    double maximum = minimum;
+    for (vtkIdType i = 1; i < npts; ++i)
+      {
+      minimum = std::min(minimum, this->PointPositions[pts[i]]);
+      maximum = std::max(maximum, this->PointPositions[pts[i]]);
+      }
+    this->TriangleMinimum[triangleId] = minimum;
+    this->TriangleMaximum[triangleId] = maximum;
+    overallMinimum = std::min(overallMinimum, minimum);
+    overallMaximum = std::max(overallMaximum, maximum);
+    sumOfTriangleSizes += maximum - minimum;
+    }
+
+  // Choose slab width to be about the average triangle size along the normal,
+  // so that most triangles are stored in one or two slabs.
+  double range = overallMaximum - overallMinimum;
+  double averageTriangleSize = sumOfTriangleSizes / numberOfTriangles;
+  vtkIdType numberOfSlabs = 1;
+  if (range > 0.0 && averageTriangleSize > 0.0)
+    {
+    numberOfSlabs = static_cast<vtkIdType>(std::min(range / averageTriangleSize,
+      static_cast<double>(std::min(numberOfTriangles, MAXIMUM_NUMBER_OF_SLABS))));
+    numberOfSlabs = std::max(numberOfSlabs, vtkIdType(1));
+    }
+  else if (range > 0.0)
+    {
+    // All triangles are perpendicular to the normal
+    numberOfSlabs = std::min(numberOfTriangles, MAXIMUM_NUMBER_OF_SLABS);
+    }
+  this->SlabOrigin = overallMinimum;
+  this->SlabWidth = (range > 0.0 ? range / numberOfSlabs : 1.0);
+
+  // Fill slabs (compressed row storage: count, prefix sum, fill)
+  auto slabIndex = [this, numberOfSlabs](double position)
+    {
+    vtkIdType index = static_cast<vtkIdType>(std::floor((position - this->SlabOrigin) / this->SlabWidth));
+    return std::min(std::max(index, vtkIdType(0)), numberOfSlabs - 1);
+    };
+  this->SlabOffsets.assign(numberOfSlabs + 1, 0);
+  for (vtkIdType triangleId = 0; triangleId < numberOfTriangles; ++triangleId)
+    {
+    vtkIdType lastSlab = slabIndex(this->TriangleMaximum[triangleId]);
+    for (vtkIdType slab = slabIndex(this->TriangleMinimum[triangleId]); slab <= lastSlab; ++slab)
+      {
+      this->SlabOffsets[slab + 1]++;
+      }
+    }
+  for (vtkIdType slab = 0; slab < numberOfSlabs; ++slab)
+    {
+    this->SlabOffsets[slab + 1] += this->SlabOffsets[slab];
+    }
+  this->SlabTriangleIds.resize(this->SlabOffsets[numberOfSlabs]);
+  std::vector<vtkIdType> fillPosition(this->SlabOffsets.begin(), this->SlabOffsets.end() - 1);
+  for (vtkIdType triangleId = 0; triangleId < numberOfTriangles; ++triangleId)
+    {
+    vtkIdType lastSlab = slabIndex(this->TriangleMaximum[triangleId]);
+    for (vtkIdType slab = slabIndex(this->TriangleMinimum[triangleId]); slab <= lastSlab; ++slab)
+      {
+      this->SlabTriangleIds[fillPosition[slab]++] = triangleId;
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkIndexedPolyDataPlaneCutter::RequestData(vtkInformation* vtkNotUsed(request),
+  vtkInformationVector** inputVector, vtkInformationVector* outputVector)
+{
+  vtkPolyData* input = vtkPolyData::GetData(inputVector[0]);
+  vtkPolyData* output = vtkPolyData::GetData(outputVector);
+  this->NumberOfTestedTriangles = 0;
+  if (!input || !output)
+    {
+    return 1;
+    }
+  if (!this->Plane)
+    {
+    vtkErrorMacro("RequestData: Plane is not set");
+    return 0;
+    }
+
+  // Normalize the plane normal and make its largest component positive
+  // so that flipped normals can share the index.
+  double normal[3] = { 0.0, 0.0, 0.0 };
+  this->Plane->GetNormal(normal);
+  if (vtkMath::Normalize(normal) == 0.0)
+    {
+    vtkErrorMacro("RequestData: Invalid plane normal");
+    return 0;
+    }
+  int largestComponent = 0;
+  for (int i = 1; i < 3; ++i)
+    {
+    if (fabs(normal[i]) > fabs(normal[largestComponent]))
+      {
+      largestComponent = i;
+      }
+    }
+  if (normal[largestComponent] < 0)
+    {
+    normal[0] = -normal[0];
+    normal[1] = -normal[1];
+    normal[2] = -normal[2];
+    }
+  double origin[3] = { 0.0, 0.0, 0.0 };
+  this->Plane->GetOrigin(origin);
+  double planePosition = vtkMath::Dot(origin, normal);
+
+  if (!this->IsIndexValid(input, normal))
+    {
+    this->BuildIndex(input, normal);
+    }
+
+  if (this->SlabOffsets.empty()
+    || planePosition < this->SlabOrigin
+    || planePosition > this->SlabOrigin + this->SlabWidth * (this->SlabOffsets.size() - 1))
+    {
+    // Plane does not intersect the mesh
+    return 1;
+    }
+
+  vtkIdType numberOfSlabs = static_cast<vtkIdType>(this->SlabOffsets.size()) - 1;
+  vtkIdType slab = static_cast<vtkIdType>(std::floor((planePosition - this->SlabOrigin) / this->SlabWidth));
+  slab = std::min(std::max(slab, vtkIdType(0)), numberOfSlabs - 1);
+  vtkIdType firstCandidate = this->SlabOffsets[slab];
+  vtkIdType lastCandidate = this->SlabOffsets[slab + 1];
+  this->NumberOfTestedTriangles = lastCandidate - firstCandidate;
+
+  vtkPoints* inPoints = this->Triangles->GetPoints();
+  vtkPointData* inPD = this->Triangles->GetPointData();
+  vtkCellData* inCD = this->Triangles->GetCellData();
+  vtkCellArray* polys = this->Triangles->GetPolys();
+
+  vtkNew<vtkPoints> outPoints;
+  outPoints->SetDataType(inPoints->GetDataType());
+  vtkNew<vtkCellArray> outLines;
+  vtkPointData* outPD = output->GetPointData();
+  vtkCellData* outCD = output->GetCellData();
+  vtkIdType estimatedSize = std::max(vtkIdType(1024), this->NumberOfTestedTriangles);
+  outPoints->Allocate(estimatedSize);
+  outLines->AllocateEstimate(estimatedSize, 2);
+  outPD->InterpolateAllocate(inPD, estimatedSize);
+  outCD->CopyAllocate(inCD, estimatedSize);
+
+  // Intersection points are stored per mesh edge so that neighbor triangles share them.
+  // A vertex that lies on the plane is stored with the key of the degenerate edge (pointId, pointId),
+  // so that all edges ending in that vertex share the same output point.
+  vtkIdType numberOfInputPoints = inPoints->GetNumberOfPoints();
+  std::unordered_map<vtkIdType, vtkIdType> edgePointIds;
+  auto getVertexPoint = [&](vtkIdType pointId)
+    {
+    vtkIdType vertexKey = pointId * numberOfInputPoints + pointId;
+    auto vertexPointIt = edgePointIds.find(vertexKey);
+    if (vertexPointIt != edgePointIds.end())
+      {
+      return vertexPointIt->second;
+      }
+    vtkIdType newPointId = outPoints->InsertNextPoint(inPoints->GetPoint(pointId));
+    outPD->CopyData(inPD, pointId, newPointId);
+    edgePointIds[vertexKey] = newPointId;
+    return newPointId;
+    };
+  auto getEdgePoint = [&](vtkIdType pointId1, vtkIdType pointId2)
+    {
+    if (pointId1 > pointId2)
+      {
+      std::swap(pointId1, pointId2);
+      }
+    double distance1 = this->PointPositions[pointId1] - planePosition;
+    double distance2 = this->PointPositions[pointId2] - planePosition;
+    if (distance1 == 0.0)
+      {
+      return getVertexPoint(pointId1);
+      }
+    if (distance2 == 0.0)
+      {
+      return getVertexPoint(pointId2);
+      }
+    vtkIdType edgeKey = pointId1 * numberOfInputPoints + pointId2;
+    auto edgePointIt = edgePointIds.find(edgeKey);
+    if (edgePointIt != edgePointIds.end())
+      {
+      return edgePointIt->second;
+      }
+    double t = distance1 / (distance1 - distance2);
+    double point1[3] = { 0.0, 0.0, 0.0 };
+    double point2[3] = { 0.0, 0.0, 0.0 };
+    inPoints->GetPoint(pointId1, point1);
+    inPoints->GetPoint(pointId2, point2);
+    double intersection[3] =
+      {
+      point1[0] + t * (point2[0] - point1[0]),
+      point1[1] + t * (point2[1] - point1[1]),
+      point1[2] + t * (point2[2] - point1[2])
+      };
+    vtkIdType newPointId = outPoints->InsertNextPoint(intersection);
+    outPD->InterpolateEdge(inPD, newPointId, pointId1, pointId2, t);
+    edgePointIds[edgeKey] = newPointId;
+    return newPointId;
+    };
+
+  for (vtkIdType candidate = firstCandidate; candidate < lastCandidate; ++candidate)
+    {
+    vtkIdType triangleId = this->SlabTriangleIds[candidate];
+    if (this->TriangleMinimum[triangleId] > planePosition || this->TriangleMaximum[triangleId] < planePosition)
+      {
+      continue;
+      }
+    vtkIdType npts = 0;
+    const vtkIdType* pts = nullptr;
+    polys->GetCellAtId(triangleId, npts, pts);
+    if (npts != 3)
+      {
+      continue;
+      }
+    // A vertex is above the plane if its distance is positive. Using the same classification
+    // for all triangles guarantees that each crossed edge is crossed in both neighbor triangles.
+    bool above[3] = { false, false, false };
+    int numberOfPointsAbove = 0;
+    for (int i = 0; i < 3; ++i)
+      {
+      above[i] = (this->PointPositions[pts[i]] > planePosition);
+      numberOfPointsAbove += (above[i] ? 1 : 0);
+      }
+    if (numberOfPointsAbove == 0 || numberOfPointsAbove == 3)
+      {
+      continue;
+      }
+    vtkIdType linePointIds[2] = { 0, 0 };
+    int numberOfLinePoints = 0;
+    for (int i = 0; i < 3 && numberOfLinePoints < 2; ++i)
+      {
+      int j = (i + 1) % 3;
+      if (above[i] != above[j])
+        {
+        linePointIds[numberOfLinePoints++] = getEdgePoint(pts[i], pts[j]);
+        }
+      }
+    // Both crossed edges end in the same vertex on the plane if the triangle only touches the plane,
+    // the zero-length segment is skipped
+    if (numberOfLinePoints == 2 && linePointIds[0] != linePointIds[1])
+      {
+      vtkIdType lineId = outLines->InsertNextCell(2, linePointIds);
+      outCD->CopyData(inCD, triangleId, lineId);
+      }
+    }
+
+  output->SetPoints(outPoints);
+  output->SetLines(outLines);
+  output->Squeeze();
+  return 1;
+}
@@ -0,0 +1,107 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkIndexedPolyDataPlaneCutter_h
+#define __vtkIndexedPolyDataPlaneCutter_h
+
+// VTK includes
+#include <vtkPolyDataAlgorithm.h>
+#include <vtkSmartPointer.h>
+
+#include "vtkMRMLLogicExport.h"
+
+// STD includes
+#include <vector>
+
+class vtkPlane;
+
+/// \brief Cut a surface mesh with a plane, using a cached spatial index.
+///
+/// Intended for showing intersections of surface meshes in slice views, where the
+/// same mesh is cut by many parallel planes (slice scrolling).
+///
+/// When the input or the plane normal changes, polygons and triangle strips of the input
+/// are triangulated and the triangles are sorted into slabs along the plane normal.
+/// While the input mesh (modified time) and plane normal remain the same, each cut only
+/// visits the triangles of the slab that contains the plane, instead of all cells.
+/// The plane origin can be changed without rebuilding the index.
+///
+/// Output is a polydata containing line segments. Intersection points are shared between
+/// neighbor triangles (contours are connected) and point data is interpolated, cell data is
+/// copied from the cut cells (as in vtkPlaneCutter).
+///
+/// Only polygons and triangle strips are cut, vertices and lines of the input are ignored.
+class VTK_MRML_LOGIC_EXPORT vtkIndexedPolyDataPlaneCutter : public vtkPolyDataAlgorithm
+{
+public:
+  static vtkIndexedPolyDataPlaneCutter *New();
+  vtkTypeMacro(vtkIndexedPolyDataPlaneCutter, vtkPolyDataAlgorithm);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  /// Cutting plane
+  void SetPlane(vtkPlane* plane);
+  vtkGetObjectMacro(Plane, vtkPlane);
+
+  /// Include plane modifications in the modified time
+  vtkMTimeType GetMTime() override;
+
+  /// Number of times the spatial index has been built (for testing and performance monitoring)
+  vtkGetMacro(NumberOfIndexBuilds, int);
+
+  /// Number of triangles that were tested in the last cut (for testing and performance monitoring)
+  vtkGetMacro(NumberOfTestedTriangles, vtkIdType);
+
+  /// Remove cached spatial index. It is rebuilt at the next update.
+  void ResetIndex();
+
+protected:
+  vtkIndexedPolyDataPlaneCutter();
+  ~vtkIndexedPolyDataPlaneCutter() override;
+
+  int RequestData(vtkInformation* request, vtkInformationVector** inputVector,
+    vtkInformationVector* outputVector) override;
+
+  /// Returns true if the index is up-to-date for the input and normal
+  bool IsIndexValid(vtkPolyData* input, const double normal[3]);
+
+  /// Triangulate input and sort the triangles into slabs along the normal
+  void BuildIndex(vtkPolyData* input, const double normal[3]);
+
+  vtkPlane* Plane;
+
+  // Cached spatial index
+  vtkSmartPointer<vtkPolyData> Triangles;
+  vtkMTimeType IndexInputMTime;
+  double IndexNormal[3];
+  /// Position of each point along the normal
+  std::vector<double> PointPositions;
+  /// Range of each triangle along the normal
+  std::vector<double> TriangleMinimum;
+  std::vector<double> TriangleMaximum;
+  /// Slab index: triangle IDs of slab i are SlabTriangleIds[SlabOffsets[i]] ... SlabTriangleIds[SlabOffsets[i+1]-1]
+  std::vector<vtkIdType> SlabOffsets;
+  std::vector<vtkIdType> SlabTriangleIds;
+  double SlabOrigin;
+  double SlabWidth;
+
+  int NumberOfIndexBuilds;
+  vtkIdType NumberOfTestedTriangles;
+
+private:
+  vtkIndexedPolyDataPlaneCutter(const vtkIndexedPolyDataPlaneCutter&) = delete;
+  void operator=(const vtkIndexedPolyDataPlaneCutter&) = delete;
+};
+
+#endif
@@ -0,0 +1,124 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Qt includes
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QMouseEvent>
+
+// qMRML includes
+#include "qMRMLRenderScheduler.h"
+#include "qMRMLThreeDView.h"
+#include "qMRMLWidget.h"
+
+// MRML includes
+#include <vtkMRMLCoreTestingMacros.h>
+#include <vtkMRMLScene.h>
+
+// VTK includes
+#include <vtkNew.h>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+void processEventsUntilRendered(qMRMLRenderScheduler* scheduler, ctkVTKAbstractView* view)
+{
+  QElapsedTimer timer;
+  timer.start();
+  while (scheduler->renderedFrameCount(view) == 0 && timer.elapsed() < 5000)
+    {
+    QApplication::processEvents(QEventLoop::AllEvents, 10);
+    }
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+int qMRMLRenderSchedulerTest1(int argc, char * argv [] )
+{
+  qMRMLWidget::preInitializeApplication();
+  QApplication app(argc, argv);
+  qMRMLWidget::postInitializeApplication();
+
+  vtkNew<vtkMRMLScene> scene;
+
+  qMRMLRenderScheduler scheduler;
+  CHECK_BOOL(scheduler.isEnabled(), true);
+
+  qMRMLThreeDView view1;
+  view1.setMRMLScene(scene);
+  view1.show();
+  qMRMLThreeDView view2;
+  view2.setMRMLScene(scene);
+  view2.show();
+
+  view1.setRenderScheduler(&scheduler);
+  view2.setRenderScheduler(&scheduler);
+  CHECK_POINTER(view1.renderScheduler(), &scheduler);
+  CHECK_INT(scheduler.views().size(), 2);
+
+  // Let initial render requests complete
+  QApplication::processEvents();
+  scheduler.flush();
+  scheduler.resetStatistics();
+
+  // Multiple requests are coalesced into a single render
+  for (int i = 0; i < 5; ++i)
+    {
+    view1.requestRender();
+    }
+  processEventsUntilRendered(&scheduler, &view1);
+  CHECK_BOOL(scheduler.requestedFrameCount(&view1) >= 5, true);
+  CHECK_BOOL(scheduler.renderedFrameCount(&view1) >= 1, true);
+  CHECK_BOOL(scheduler.skippedFrameCount(&view1) >= 4, true);
+  CHECK_INT(scheduler.renderedFrameCount(&view1) + scheduler.skippedFrameCount(&view1),
+    scheduler.requestedFrameCount(&view1));
+  CHECK_INT(scheduler.renderedFrameCount(&view2), 0);
+
+  // Interaction in view1 makes view2 a background view
+  scheduler.setInteractionTimeout(60000);
+  scheduler.setBackgroundUpdateRate(0.001); // effectively never render background views
+  QMouseEvent mouseMoveEvent(QEvent::MouseMove, QPointF(10, 10), Qt::NoButton, Qt::NoButton, Qt::NoModifier);
+  QApplication::sendEvent(view1.VTKWidget(), &mouseMoveEvent);
+  CHECK_POINTER(scheduler.interactionView(), &view1);
+
+  // view2 has been rendered before, so it is rendered at the background update rate
+  view2.requestRender();
+  scheduler.flush();
+  scheduler.resetStatistics();
+  view1.requestRender();
+  view2.requestRender();
+  processEventsUntilRendered(&scheduler, &view1);
+  QApplication::processEvents();
+  CHECK_BOOL(scheduler.renderedFrameCount(&view1) >= 1, true);
+  CHECK_INT(scheduler.renderedFrameCount(&view2), 0);
+  CHECK_BOOL(scheduler.deferredFrameCount(&view2) >= 1, true);
+
+  // Deferred request is not lost
+  scheduler.flush();
+  CHECK_INT(scheduler.renderedFrameCount(&view2), 1);
+
+  // Disabled scheduler passes requests to the view
+  scheduler.resetStatistics();
+  scheduler.setEnabled(false);
+  view1.requestRender();
+  CHECK_INT(scheduler.requestedFrameCount(&view1), 0);
+
+  view2.setRenderScheduler(nullptr);
+  CHECK_INT(scheduler.views().size(), 1);
+
+  return EXIT_SUCCESS;
+}
@@ -32,6 +32,7 @@
 #include <qMRMLTableWidget.h>
 #include <qMRMLPlotView.h>
 #include <qMRMLPlotWidget.h>
+#include <qMRMLRenderScheduler.h>
 #include <qMRMLThreeDView.h>
 #include <qMRMLThreeDWidget.h>
 
@@ -100,6 +101,7 @@ QWidget* qMRMLLayoutThreeDViewFactory::createViewFromNode(vtkMRMLAbstractViewNod
   threeDWidget->setObjectName(QString("ThreeDWidget%1").arg(viewNode->GetLayoutName()));
   threeDWidget->setMRMLScene(this->mrmlScene());
   threeDWidget->setMRMLViewNode(vtkMRMLViewNode::SafeDownCast(viewNode));
+  threeDWidget->threeDView()->setRenderScheduler(this->layoutManager()->renderScheduler());
 
   this->viewLogics()->AddItem(threeDWidget->viewLogic());
 
@@ -255,6 +257,7 @@ QWidget* qMRMLLayoutSliceViewFactory::createViewFromNode(vtkMRMLAbstractViewNode
   sliceWidget->setMRMLSliceNode(vtkMRMLSliceNode::SafeDownCast(viewNode));
   sliceWidget->setMRMLScene(this->mrmlScene());
   sliceWidget->setSliceLogics(this->sliceLogics());
+  sliceWidget->sliceView()->setRenderScheduler(this->layoutManager()->renderScheduler());
   this->sliceLogics()->AddItem(sliceWidget->sliceLogic());
 
   return sliceWidget;
@@ -286,6 +289,7 @@ qMRMLLayoutManagerPrivate::qMRMLLayoutManagerPrivate(qMRMLLayoutManager& object)
   this->ActiveMRMLThreeDViewNode = nullptr;
   this->ActiveMRMLTableViewNode = nullptr;
   this->ActiveMRMLPlotViewNode = nullptr;
+  this->RenderScheduler = nullptr;
   //this->SavedCurrentViewArrangement = vtkMRMLLayoutNode::SlicerLayoutNone;
 }
 
@@ -303,6 +307,8 @@ void qMRMLLayoutManagerPrivate::init()
 
   q->setSpacing(1);
 
+  this->RenderScheduler = new qMRMLRenderScheduler(q);
+
   qMRMLLayoutThreeDViewFactory* threeDViewFactory =
     new qMRMLLayoutThreeDViewFactory;
   q->registerViewFactory(threeDViewFactory);
@@ -976,6 +982,13 @@ vtkMRMLLayoutLogic* qMRMLLayoutManager::layoutLogic()const
   return d->MRMLLayoutLogic;
 }
 
+//------------------------------------------------------------------------------
+qMRMLRenderScheduler* qMRMLLayoutManager::renderScheduler()const
+{
+  Q_D(const qMRMLLayoutManager);
+  return d->RenderScheduler;
+}
+
 //------------------------------------------------------------------------------
 void qMRMLLayoutManager::setMRMLScene(vtkMRMLScene* scene)
 {
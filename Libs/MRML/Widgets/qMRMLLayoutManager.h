@@ -32,6 +32,7 @@ class QWidget;
 #include "qMRMLWidgetsExport.h"
 
 class qMRMLPlotWidget;
+class qMRMLRenderScheduler;
 class qMRMLTableWidget;
 class qMRMLThreeDWidget;
 class qMRMLSliceWidget;
@@ -173,6 +174,10 @@ public:
   /// \sa setLayout(), layout()
   Q_INVOKABLE vtkMRMLLayoutLogic* layoutLogic()const;
 
+  /// Return the render scheduler that coalesces render requests of the slice and 3D views
+  /// created by the layout manager.
+  Q_INVOKABLE qMRMLRenderScheduler* renderScheduler()const;
+
   /// Return the view node of the active 3D view.
   /// \todo For now the active view is the first 3D view.
   /// \sa activeThreeDRenderer(), activeMRMLPlotViewNode(),
@@ -59,6 +59,7 @@ class qMRMLTableView;
 class qMRMLTableWidget;
 class qMRMLPlotView;
 class qMRMLPlotWidget;
+class qMRMLRenderScheduler;
 class qMRMLThreeDView;
 class qMRMLThreeDWidget;
 class vtkCollection;
@@ -144,6 +145,7 @@ public:
   vtkMRMLViewNode*        ActiveMRMLThreeDViewNode;
   vtkMRMLTableViewNode*   ActiveMRMLTableViewNode;
   vtkMRMLPlotViewNode*    ActiveMRMLPlotViewNode;
+  qMRMLRenderScheduler*   RenderScheduler;
 protected:
   void showWidget(QWidget* widget);
 };
@@ -0,0 +1,502 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Qt includes
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QHash>
+#include <QPointer>
+#include <QTimer>
+
+// CTK includes
+#include <ctkVTKAbstractView.h>
+
+// qMRML includes
+#include "qMRMLRenderScheduler.h"
+
+// STD includes
+#include <algorithm>
+
+//-----------------------------------------------------------------------------
+class qMRMLRenderSchedulerPrivate
+{
+  Q_DECLARE_PUBLIC(qMRMLRenderScheduler);
+protected:
+  qMRMLRenderScheduler* const q_ptr;
+public:
+  qMRMLRenderSchedulerPrivate(qMRMLRenderScheduler& object);
+
+  struct ViewInfo
+    {
+    QPointer<ctkVTKAbstractView> View;
+    QObject* InputWidget{nullptr};
+    bool RenderPending{false};
+    qint64 LastRenderTime{-1};
+    int RequestedFrameCount{0};
+    int RenderedFrameCount{0};
+    int SkippedFrameCount{0};
+    int DeferredFrameCount{0};
+    double TotalRenderTime{0.0};
+    };
+
+  void init();
+  ViewInfo* viewInfo(QObject* view);
+  const ViewInfo* viewInfo(QObject* view)const;
+  /// Time between frames in milliseconds
+  int frameInterval()const;
+  bool isInteracting()const;
+  void scheduleFrame();
+  void render(ViewInfo& info);
+
+  bool Enabled;
+  double MaximumUpdateRate;
+  double BackgroundUpdateRate;
+  double FrameBudget;
+  int InteractionTimeout;
+
+  QHash<QObject*, ViewInfo> Views;
+  QTimer FrameTimer;
+  QElapsedTimer Clock;
+  qint64 LastFrameTime;
+
+  QPointer<ctkVTKAbstractView> InteractionView;
+  qint64 LastInteractionTime;
+};
+
+//-----------------------------------------------------------------------------
+qMRMLRenderSchedulerPrivate::qMRMLRenderSchedulerPrivate(qMRMLRenderScheduler& object)
+  : q_ptr(&object)
+  , Enabled(true)
+  , MaximumUpdateRate(60.0)
+  , BackgroundUpdateRate(10.0)
+  , FrameBudget(16.0)
+  , InteractionTimeout(500)
+  , LastFrameTime(-1)
+  , LastInteractionTime(-1)
+{
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLRenderSchedulerPrivate::init()
+{
+  Q_Q(qMRMLRenderScheduler);
+  this->FrameTimer.setSingleShot(true);
+  QObject::connect(&this->FrameTimer, SIGNAL(timeout()), q, SLOT(renderFrame()));
+  this->Clock.start();
+}
+
+//-----------------------------------------------------------------------------
+qMRMLRenderSchedulerPrivate::ViewInfo* qMRMLRenderSchedulerPrivate::viewInfo(QObject* view)
+{
+  QHash<QObject*, ViewInfo>::iterator it = this->Views.find(view);
+  return (it != this->Views.end() ? &it.value() : nullptr);
+}
+
+//-----------------------------------------------------------------------------
+const qMRMLRenderSchedulerPrivate::ViewInfo* qMRMLRenderSchedulerPrivate::viewInfo(QObject* view)const
+{
+  QHash<QObject*, ViewInfo>::const_iterator it = this->Views.constFind(view);
+  return (it != this->Views.constEnd() ? &it.value() : nullptr);
+}
+
+//-----------------------------------------------------------------------------
+int qMRMLRenderSchedulerPrivate::frameInterval()const
+{
+  return this->MaximumUpdateRate > 0.0 ? static_cast<int>(1000.0 / this->MaximumUpdateRate) : 0;
+}
+
+//-----------------------------------------------------------------------------
+bool qMRMLRenderSchedulerPrivate::isInteracting()const
+{
+  return !this->InteractionView.isNull() && this->LastInteractionTime >= 0
+    && this->Clock.elapsed() - this->LastInteractionTime < this->InteractionTimeout;
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLRenderSchedulerPrivate::scheduleFrame()
+{
+  if (this->FrameTimer.isActive())
+    {
+    return;
+    }
+  int delay = 0;
+  if (this->LastFrameTime >= 0)
+    {
+    delay = std::max(0, this->frameInterval() - static_cast<int>(this->Clock.elapsed() - this->LastFrameTime));
+    }
+  this->FrameTimer.start(delay);
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLRenderSchedulerPrivate::render(ViewInfo& info)
+{
+  info.RenderPending = false;
+  if (!info.View->renderEnabled() || !info.View->isVisible())
+    {
+    // Let the view handle the request when it can be rendered again
+    info.View->scheduleRender();
+    return;
+    }
+  qint64 startTime = this->Clock.nsecsElapsed();
+  info.View->forceRender();
+  info.TotalRenderTime += (this->Clock.nsecsElapsed() - startTime) * 1e-6;
+  info.RenderedFrameCount++;
+  info.LastRenderTime = this->Clock.elapsed();
+}
+
+//-----------------------------------------------------------------------------
+// qMRMLRenderScheduler methods
+
+//-----------------------------------------------------------------------------
+qMRMLRenderScheduler::qMRMLRenderScheduler(QObject* parentObject)
+  : Superclass(parentObject)
+  , d_ptr(new qMRMLRenderSchedulerPrivate(*this))
+{
+  Q_D(qMRMLRenderScheduler);
+  d->init();
+}
+
+//-----------------------------------------------------------------------------
+qMRMLRenderScheduler::~qMRMLRenderScheduler()
+{
+  Q_D(qMRMLRenderScheduler);
+  foreach(const qMRMLRenderSchedulerPrivate::ViewInfo& info, d->Views)
+    {
+    if (info.View && info.InputWidget)
+      {
+      info.InputWidget->removeEventFilter(this);
+      }
+    }
+}
+
+//-----------------------------------------------------------------------------
+bool qMRMLRenderScheduler::isEnabled()const
+{
+  Q_D(const qMRMLRenderScheduler);
+  return d->Enabled;
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLRenderScheduler::setEnabled(bool enabled)
+{
+  Q_D(qMRMLRenderScheduler);
+  if (d->Enabled == enabled)
+    {
+    return;
+    }
+  if (!enabled)
+    {
+    // Render pending requests before letting the views handle their own requests
+    this->flush();
+    }
+  d->Enabled = enabled;
+}
+
+//-----------------------------------------------------------------------------
+double qMRMLRenderScheduler::maximumUpdateRate()const
+{
+  Q_D(const qMRMLRenderScheduler);
+  return d->MaximumUpdateRate;
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLRenderScheduler::setMaximumUpdateRate(double fps)
+{
+  Q_D(qMRMLRenderScheduler);
+  d->MaximumUpdateRate = fps;
+}
+
+//-----------------------------------------------------------------------------
+double qMRMLRenderScheduler::backgroundUpdateRate()const
+{
+  Q_D(const qMRMLRenderScheduler);
+  return d->BackgroundUpdateRate;
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLRenderScheduler::setBackgroundUpdateRate(double fps)
+{
+  Q_D(qMRMLRenderScheduler);
+  d->BackgroundUpdateRate = fps;
+}
+
+//-----------------------------------------------------------------------------
+double qMRMLRenderScheduler::frameBudget()const
+{
+  Q_D(const qMRMLRenderScheduler);
+  return d->FrameBudget;
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLRenderScheduler::setFrameBudget(double milliseconds)
+{
+  Q_D(qMRMLRenderScheduler);
+  d->FrameBudget = milliseconds;
+}
+
+//-----------------------------------------------------------------------------
+int qMRMLRenderScheduler::interactionTimeout()const
+{
+  Q_D(const qMRMLRenderScheduler);
+  return d->InteractionTimeout;
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLRenderScheduler::setInteractionTimeout(int milliseconds)
+{
+  Q_D(qMRMLRenderScheduler);
+  d->InteractionTimeout = milliseconds;
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLRenderScheduler::addView(ctkVTKAbstractView* view)
+{
+  Q_D(qMRMLRenderScheduler);
+  if (!view || d->Views.contains(view))
+    {
+    return;
+    }
+  qMRMLRenderSchedulerPrivate::ViewInfo info;
+  info.View = view;
+  // User input is received by the render window widget, not the view itself
+  info.InputWidget = view->VTKWidget() ? static_cast<QObject*>(view->VTKWidget()) : static_cast<QObject*>(view);
+  info.InputWidget->installEventFilter(this);
+  d->Views[view] = info;
+  QObject::connect(view, SIGNAL(destroyed(QObject*)), this, SLOT(onViewDestroyed(QObject*)));
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLRenderScheduler::removeView(ctkVTKAbstractView* view)
+{
+  Q_D(qMRMLRenderScheduler);
+  qMRMLRenderSchedulerPrivate::ViewInfo* info = d->viewInfo(view);
+  if (!info)
+    {
+    return;
+    }
+  if (info->InputWidget)
+    {
+    info->InputWidget->removeEventFilter(this);
+    }
+  if (info->RenderPending && info->View)
+    {
+    info->View->scheduleRender();
+    }
+  QObject::disconnect(view, SIGNAL(destroyed(QObject*)), this, SLOT(onViewDestroyed(QObject*)));
+  d->Views.remove(view);
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLRenderScheduler::onViewDestroyed(QObject* view)
+{
+  Q_D(qMRMLRenderScheduler);
+  d->Views.remove(view);
+}
+
+//-----------------------------------------------------------------------------
+QList<ctkVTKAbstractView*> qMRMLRenderScheduler::views()const
+{
+  Q_D(const qMRMLRenderScheduler);
+  QList<ctkVTKAbstractView*> viewList;
+  foreach(const qMRMLRenderSchedulerPrivate::ViewInfo& info, d->Views)
+    {
+    if (info.View)
+      {
+      viewList << info.View;
+      }
+    }
+  return viewList;
+}
+
+//-----------------------------------------------------------------------------
+ctkVTKAbstractView* qMRMLRenderScheduler::interactionView()const
+{
+  Q_D(const qMRMLRenderScheduler);
+  return d->isInteracting() ? d->InteractionView.data() : nullptr;
+}
+
+//-----------------------------------------------------------------------------
+int qMRMLRenderScheduler::requestedFrameCount(ctkVTKAbstractView* view)const
+{
+  Q_D(const qMRMLRenderScheduler);
+  const qMRMLRenderSchedulerPrivate::ViewInfo* info = d->viewInfo(view);
+  return info ? info->RequestedFrameCount : 0;
+}
+
+//-----------------------------------------------------------------------------
+int qMRMLRenderScheduler::renderedFrameCount(ctkVTKAbstractView* view)const
+{
+  Q_D(const qMRMLRenderScheduler);
+  const qMRMLRenderSchedulerPrivate::ViewInfo* info = d->viewInfo(view);
+  return info ? info->RenderedFrameCount : 0;
+}
+
+//-----------------------------------------------------------------------------
+int qMRMLRenderScheduler::skippedFrameCount(ctkVTKAbstractView* view)const
+{
+  Q_D(const qMRMLRenderScheduler);
+  const qMRMLRenderSchedulerPrivate::ViewInfo* info = d->viewInfo(view);
+  return info ? info->SkippedFrameCount : 0;
+}
+
+//-----------------------------------------------------------------------------
+int qMRMLRenderScheduler::deferredFrameCount(ctkVTKAbstractView* view)const
+{
+  Q_D(const qMRMLRenderScheduler);
+  const qMRMLRenderSchedulerPrivate::ViewInfo* info = d->viewInfo(view);
+  return info ? info->DeferredFrameCount : 0;
+}
+
+//-----------------------------------------------------------------------------
+double qMRMLRenderScheduler::averageRenderTime(ctkVTKAbstractView* view)const
+{
+  Q_D(const qMRMLRenderScheduler);
+  const qMRMLRenderSchedulerPrivate::ViewInfo* info = d->viewInfo(view);
+  if (!info || info->RenderedFrameCount == 0)
+    {
+    return 0.0;
+    }
+  return info->TotalRenderTime / info->RenderedFrameCount;
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLRenderScheduler::resetStatistics()
+{
+  Q_D(qMRMLRenderScheduler);
+  for (QHash<QObject*, qMRMLRenderSchedulerPrivate::ViewInfo>::iterator it = d->Views.begin(); it != d->Views.end(); ++it)
+    {
+    it->RequestedFrameCount = 0;
+    it->RenderedFrameCount = 0;
+    it->SkippedFrameCount = 0;
+    it->DeferredFrameCount = 0;
+    it->TotalRenderTime = 0.0;
+    }
+}
+
+//-----------------------------------------------------------------------------
+bool qMRMLRenderScheduler::eventFilter(QObject* object, QEvent* event)
+{
+  Q_D(qMRMLRenderScheduler);
+  switch (event->type())
+    {
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseButtonRelease:
+    case QEvent::MouseButtonDblClick:
+    case QEvent::MouseMove:
+    case QEvent::Wheel:
+    case QEvent::KeyPress:
+    case QEvent::KeyRelease:
+    case QEvent::TouchBegin:
+    case QEvent::TouchUpdate:
+    case QEvent::Gesture:
+      foreach(const qMRMLRenderSchedulerPrivate::ViewInfo& info, d->Views)
+        {
+        if (info.InputWidget == object)
+          {
+          d->InteractionView = info.View;
+          d->LastInteractionTime = d->Clock.elapsed();
+          break;
+          }
+        }
+      break;
+    default:
+      break;
+    }
+  return this->Superclass::eventFilter(object, event);
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLRenderScheduler::requestRender(ctkVTKAbstractView* view)
+{
+  Q_D(qMRMLRenderScheduler);
+  qMRMLRenderSchedulerPrivate::ViewInfo* info = d->viewInfo(view);
+  if (!d->Enabled || !info)
+    {
+    if (view)
+      {
+      view->scheduleRender();
+      }
+    return;
+    }
+  info->RequestedFrameCount++;
+  if (info->RenderPending)
+    {
+    info->SkippedFrameCount++;
+    return;
+    }
+  info->RenderPending = true;
+  d->scheduleFrame();
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLRenderScheduler::flush()
+{
+  Q_D(qMRMLRenderScheduler);
+  d->FrameTimer.stop();
+  for (QHash<QObject*, qMRMLRenderSchedulerPrivate::ViewInfo>::iterator it = d->Views.begin(); it != d->Views.end(); ++it)
+    {
+    if (it->RenderPending && it->View)
+      {
+      d->render(it.value());
+      }
+    }
+  d->LastFrameTime = d->Clock.elapsed();
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLRenderScheduler::renderFrame()
+{
+  Q_D(qMRMLRenderScheduler);
+  qint64 frameStartTime = d->Clock.elapsed();
+  d->LastFrameTime = frameStartTime;
+
+  bool interacting = d->isInteracting();
+  qMRMLRenderSchedulerPrivate::ViewInfo* interactionViewInfo = interacting ? d->viewInfo(d->InteractionView.data()) : nullptr;
+
+  // View under interaction is rendered first and is not limited by the frame budget
+  if (interactionViewInfo && interactionViewInfo->RenderPending && interactionViewInfo->View)
+    {
+    d->render(*interactionViewInfo);
+    }
+
+  int backgroundInterval = d->BackgroundUpdateRate > 0.0 ? static_cast<int>(1000.0 / d->BackgroundUpdateRate) : 0;
+  bool renderPending = false;
+  for (QHash<QObject*, qMRMLRenderSchedulerPrivate::ViewInfo>::iterator it = d->Views.begin(); it != d->Views.end(); ++it)
+    {
+    qMRMLRenderSchedulerPrivate::ViewInfo& info = it.value();
+    if (!info.RenderPending || !info.View)
+      {
+      continue;
+      }
+    if (interacting)
+      {
+      qint64 now = d->Clock.elapsed();
+      bool tooEarly = (info.LastRenderTime >= 0 && now - info.LastRenderTime < backgroundInterval);
+      bool overBudget = (now - frameStartTime >= d->FrameBudget);
+      if (tooEarly || overBudget)
+        {
+        info.DeferredFrameCount++;
+        renderPending = true;
+        continue;
+        }
+      }
+    d->render(info);
+    }
+
+  if (renderPending)
+    {
+    d->scheduleFrame();
+    }
+}
@@ -0,0 +1,125 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __qMRMLRenderScheduler_h
+#define __qMRMLRenderScheduler_h
+
+// Qt includes
+#include <QObject>
+#include <QList>
+
+// MRML includes
+#include "qMRMLWidgetsExport.h"
+
+class ctkVTKAbstractView;
+class qMRMLRenderSchedulerPrivate;
+
+/// \brief Coalesce render requests of all views into at most one render per view per frame.
+///
+/// Views that are added to the scheduler (see qMRMLSliceView::setRenderScheduler and
+/// qMRMLThreeDView::setRenderScheduler) forward the render requests of their displayable
+/// managers to requestRender(). Requests are collected and rendered in frames, at most
+/// maximumUpdateRate times per second:
+/// - each view is rendered at most once per frame, regardless of the number of requests,
+/// - the view under interaction (the view that most recently received mouse, wheel or
+///   keyboard input) is rendered first,
+/// - while a view is under interaction, other views are rendered at most
+///   backgroundUpdateRate times per second and only if the time spent rendering in the current
+///   frame is below frameBudget. Deferred requests are kept and rendered in a later frame.
+///
+/// Statistics of requested, rendered, skipped (coalesced) and deferred frames are collected
+/// for each view.
+class QMRML_WIDGETS_EXPORT qMRMLRenderScheduler : public QObject
+{
+  Q_OBJECT
+  /// If disabled then render requests are passed directly to the view's scheduleRender().
+  /// Enabled by default.
+  Q_PROPERTY(bool enabled READ isEnabled WRITE setEnabled)
+  /// Maximum number of frames per second. Default is 60.
+  Q_PROPERTY(double maximumUpdateRate READ maximumUpdateRate WRITE setMaximumUpdateRate)
+  /// Maximum number of frames per second of views that are not under interaction,
+  /// while a view is under interaction. Default is 10.
+  Q_PROPERTY(double backgroundUpdateRate READ backgroundUpdateRate WRITE setBackgroundUpdateRate)
+  /// Time in milliseconds that can be spent rendering in a frame.
+  /// When exceeded, rendering of background views is postponed to the next frame.
+  /// The view under interaction is always rendered. Default is 16.
+  Q_PROPERTY(double frameBudget READ frameBudget WRITE setFrameBudget)
+  /// Time in milliseconds after the last input event while the view is considered under interaction.
+  /// Default is 500.
+  Q_PROPERTY(int interactionTimeout READ interactionTimeout WRITE setInteractionTimeout)
+public:
+  typedef QObject Superclass;
+  explicit qMRMLRenderScheduler(QObject* parent = nullptr);
+  ~qMRMLRenderScheduler() override;
+
+  bool isEnabled()const;
+  void setEnabled(bool enabled);
+
+  double maximumUpdateRate()const;
+  void setMaximumUpdateRate(double fps);
+
+  double backgroundUpdateRate()const;
+  void setBackgroundUpdateRate(double fps);
+
+  double frameBudget()const;
+  void setFrameBudget(double milliseconds);
+
+  int interactionTimeout()const;
+  void setInteractionTimeout(int milliseconds);
+
+  /// Add view to the scheduler. Views are removed automatically when they are destroyed.
+  Q_INVOKABLE void addView(ctkVTKAbstractView* view);
+  Q_INVOKABLE void removeView(ctkVTKAbstractView* view);
+  Q_INVOKABLE QList<ctkVTKAbstractView*> views()const;
+
+  /// View that received user input most recently, if within interactionTimeout.
+  Q_INVOKABLE ctkVTKAbstractView* interactionView()const;
+
+  /// Number of render requests received for the view
+  Q_INVOKABLE int requestedFrameCount(ctkVTKAbstractView* view)const;
+  /// Number of times the view was rendered by the scheduler
+  Q_INVOKABLE int renderedFrameCount(ctkVTKAbstractView* view)const;
+  /// Number of render requests that were merged into an already pending request
+  Q_INVOKABLE int skippedFrameCount(ctkVTKAbstractView* view)const;
+  /// Number of times rendering of the view was postponed to a later frame
+  /// (background update rate or frame budget)
+  Q_INVOKABLE int deferredFrameCount(ctkVTKAbstractView* view)const;
+  /// Average render time of the view in milliseconds
+  Q_INVOKABLE double averageRenderTime(ctkVTKAbstractView* view)const;
+  /// Reset all statistics counters
+  Q_INVOKABLE void resetStatistics();
+
+  bool eventFilter(QObject* object, QEvent* event) override;
+
+public slots:
+  /// Request rendering of the view in the next frame.
+  void requestRender(ctkVTKAbstractView* view);
+
+  /// Render all views that have pending requests, without waiting for the next frame.
+  void flush();
+
+protected slots:
+  void renderFrame();
+  void onViewDestroyed(QObject* view);
+
+protected:
+  QScopedPointer<qMRMLRenderSchedulerPrivate> d_ptr;
+
+private:
+  Q_DECLARE_PRIVATE(qMRMLRenderScheduler);
+  Q_DISABLE_COPY(qMRMLRenderScheduler);
+};
+
+#endif
@@ -205,7 +205,7 @@ void qMRMLSliceViewPrivate::initDisplayableManagers()
       q->lightBoxRendererManager()->GetRenderer(0));
   // Observe displayable manager group to catch RequestRender events
   q->qvtkConnect(this->DisplayableManagerGroup, vtkCommand::UpdateEvent,
-                 q, SLOT(scheduleRender()));
+                 q, SLOT(requestRender()));
 
   // pass the lightbox manager proxy onto the display managers
   this->DisplayableManagerGroup->SetLightBoxRendererManagerProxy(this->LightBoxRendererManagerProxy);
@@ -470,6 +470,46 @@ void qMRMLSliceView::setDefaultViewCursor(const QCursor &cursor)
     }
 }
 
+//---------------------------------------------------------------------------
+void qMRMLSliceView::setRenderScheduler(qMRMLRenderScheduler* scheduler)
+{
+  Q_D(qMRMLSliceView);
+  if (d->RenderScheduler == scheduler)
+    {
+    return;
+    }
+  if (d->RenderScheduler)
+    {
+    d->RenderScheduler->removeView(this);
+    }
+  d->RenderScheduler = scheduler;
+  if (d->RenderScheduler)
+    {
+    d->RenderScheduler->addView(this);
+    }
+}
+
+//---------------------------------------------------------------------------
+qMRMLRenderScheduler* qMRMLSliceView::renderScheduler()const
+{
+  Q_D(const qMRMLSliceView);
+  return d->RenderScheduler;
+}
+
+//---------------------------------------------------------------------------
+void qMRMLSliceView::requestRender()
+{
+  Q_D(qMRMLSliceView);
+  if (d->RenderScheduler)
+    {
+    d->RenderScheduler->requestRender(this);
+    }
+  else
+    {
+    this->scheduleRender();
+    }
+}
+
 //---------------------------------------------------------------------------
 void qMRMLSliceView::dragEnterEvent(QDragEnterEvent* event)
 {
@@ -28,6 +28,7 @@
 #include "qMRMLWidgetsExport.h"
 
 class QDropEvent;
+class qMRMLRenderScheduler;
 class qMRMLSliceViewPrivate;
 class vtkCollection;
 class vtkMRMLAbstractDisplayableManager;
@@ -99,6 +100,12 @@ public:
   /// Set default cursor in the view area
   Q_INVOKABLE void setDefaultViewCursor(const QCursor &cursor);
 
+  /// Scheduler that coalesces the render requests of multiple views.
+  /// If not set then render requests are handled by scheduleRender().
+  /// \sa requestRender()
+  Q_INVOKABLE void setRenderScheduler(qMRMLRenderScheduler* scheduler);
+  Q_INVOKABLE qMRMLRenderScheduler* renderScheduler()const;
+
   void dragEnterEvent(QDragEnterEvent* event) override;
   void dropEvent(QDropEvent* event) override;
 
@@ -112,6 +119,11 @@ public slots:
   /// Set the current \a viewNode to observe
   void setMRMLSliceNode(vtkMRMLSliceNode* newSliceNode);
 
+  /// Request rendering of the view using the render scheduler, if set.
+  /// Render requests of displayable managers are handled by this method.
+  /// \sa setRenderScheduler(), scheduleRender()
+  void requestRender();
+
 protected:
   QScopedPointer<qMRMLSliceViewPrivate> d_ptr;
 
@@ -32,10 +32,14 @@
 // We mean it.
 //
 
+// Qt includes
+#include <QPointer>
+
 // CTK includes
 #include <ctkVTKObject.h>
 
 // qMRML includes
+#include "qMRMLRenderScheduler.h"
 #include "qMRMLSliceView.h"
 
 // MRML includes
@@ -81,6 +85,7 @@ protected:
   vtkMRMLScene*                      MRMLScene;
   vtkMRMLSliceNode*                  MRMLSliceNode;
   QColor                             InactiveBoxColor;
+  QPointer<qMRMLRenderScheduler>     RenderScheduler;
 
   class vtkInternalLightBoxRendererManagerProxy;
   vtkSmartPointer<vtkInternalLightBoxRendererManagerProxy> LightBoxRendererManagerProxy;
@@ -68,7 +68,7 @@ void qMRMLSliceWidgetPrivate::init()
   connect(this->SliceController, SIGNAL(imageDataConnectionChanged(vtkAlgorithmOutput*)),
           this, SLOT(setImageDataConnection(vtkAlgorithmOutput*)));
   connect(this->SliceController, SIGNAL(renderRequested()),
-          this->SliceView, SLOT(scheduleRender()), Qt::QueuedConnection);
+          this->SliceView, SLOT(requestRender()), Qt::QueuedConnection);
 }
 
 // --------------------------------------------------------------------------
@@ -135,7 +135,7 @@ void qMRMLThreeDViewPrivate::initDisplayableManagers()
     = factory->InstantiateDisplayableManagers(q->renderer());
   // Observe displayable manager group to catch RequestRender events
   this->qvtkConnect(this->DisplayableManagerGroup, vtkCommand::UpdateEvent,
-                    q, SLOT(scheduleRender()));
+                    q, SLOT(requestRender()));
 }
 
 //---------------------------------------------------------------------------
@@ -554,6 +554,46 @@ void qMRMLThreeDView::setDefaultViewCursor(const QCursor &cursor)
     }
 }
 
+//---------------------------------------------------------------------------
+void qMRMLThreeDView::setRenderScheduler(qMRMLRenderScheduler* scheduler)
+{
+  Q_D(qMRMLThreeDView);
+  if (d->RenderScheduler == scheduler)
+    {
+    return;
+    }
+  if (d->RenderScheduler)
+    {
+    d->RenderScheduler->removeView(this);
+    }
+  d->RenderScheduler = scheduler;
+  if (d->RenderScheduler)
+    {
+    d->RenderScheduler->addView(this);
+    }
+}
+
+//---------------------------------------------------------------------------
+qMRMLRenderScheduler* qMRMLThreeDView::renderScheduler()const
+{
+  Q_D(const qMRMLThreeDView);
+  return d->RenderScheduler;
+}
+
+//---------------------------------------------------------------------------
+void qMRMLThreeDView::requestRender()
+{
+  Q_D(qMRMLThreeDView);
+  if (d->RenderScheduler)
+    {
+    d->RenderScheduler->requestRender(this);
+    }
+  else
+    {
+    this->scheduleRender();
+    }
+}
+
 //---------------------------------------------------------------------------
 void qMRMLThreeDView::dragEnterEvent(QDragEnterEvent* event)
 {
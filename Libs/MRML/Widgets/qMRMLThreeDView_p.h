@@ -32,11 +32,15 @@
 // We mean it.
 //
 
+// Qt includes
+#include <QPointer>
+
 // CTK includes
 #include <ctkPimpl.h>
 #include <ctkVTKObject.h>
 
 // qMRML includes
+#include "qMRMLRenderScheduler.h"
 #include "qMRMLThreeDView.h"
 
 class vtkMRMLDisplayableManagerGroup;
@@ -73,6 +77,7 @@ protected:
   vtkMRMLDisplayableManagerGroup*    DisplayableManagerGroup;
   vtkMRMLScene*                      MRMLScene;
   vtkMRMLViewNode*                   MRMLViewNode;
+  QPointer<qMRMLRenderScheduler>     RenderScheduler;
 };
 
 #endif
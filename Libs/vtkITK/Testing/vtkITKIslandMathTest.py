@@ -0,0 +1,95 @@
+# Testing against VTK connectivity filter
+import unittest
+
+import numpy
+import vtk
+import vtkITK
+from vtk.util import numpy_support as ns
+
+
+class vtkITKIslandMathAgainstConnectivityFilter(unittest.TestCase):
+    def setUp(self):
+        # Random foreground voxels surrounded by empty margin, so that many small islands are created
+        self.shape = (40, 50, 60)
+        randomState = numpy.random.RandomState(42)
+        array = (randomState.randint(0, 100, self.shape) < 30).astype(numpy.int16) * randomState.randint(1, 4, self.shape)
+        array[:3, :, :] = 0
+        array[:, -4:, :] = 0
+        self.inputArray = array.astype(numpy.int16)
+
+        self.inputImage = vtk.vtkImageData()
+        self.inputImage.SetExtent(5, 5 + self.shape[2] - 1, -2, -2 + self.shape[1] - 1, 0, self.shape[0] - 1)
+        self.inputImage.AllocateScalars(vtk.VTK_SHORT, 1)
+        ns.vtk_to_numpy(self.inputImage.GetPointData().GetScalars())[:] = self.inputArray.ravel()
+
+    def computeIslands(self, fullyConnected, minimumSize=0):
+        islandMath = vtkITK.vtkITKIslandMath()
+        islandMath.SetInputData(self.inputImage)
+        islandMath.SetFullyConnected(fullyConnected)
+        islandMath.SetMinimumSize(minimumSize)
+        islandMath.Update()
+        islandArray = ns.vtk_to_numpy(islandMath.GetOutput().GetPointData().GetScalars()).reshape(self.shape)
+        return islandMath, islandArray
+
+    def test_faceConnected(self):
+        islandMath, islandArray = self.computeIslands(False)
+
+        # All non-zero voxels are foreground, same as connectivity filter of binary image
+        threshold = vtk.vtkImageThreshold()
+        threshold.SetInputData(self.inputImage)
+        threshold.ThresholdByUpper(1)
+        threshold.SetInValue(1)
+        threshold.SetOutValue(0)
+        connectivity = vtk.vtkImageConnectivityFilter()
+        connectivity.SetInputConnection(threshold.GetOutputPort())
+        connectivity.SetScalarRange(1, 1)
+        connectivity.SetExtractionModeToAllRegions()
+        connectivity.SetLabelModeToSizeRank()
+        connectivity.Update()
+        referenceArray = ns.vtk_to_numpy(connectivity.GetOutput().GetPointData().GetScalars()).reshape(self.shape)
+
+        numberOfIslands = islandMath.GetNumberOfIslands()
+        self.assertGreater(numberOfIslands, 100)
+        self.assertEqual(numberOfIslands, connectivity.GetNumberOfExtractedRegions())
+        self.assertEqual(numberOfIslands, islandMath.GetOriginalNumberOfIslands())
+
+        # Same partition of voxels (label values of islands of equal size may differ)
+        labelPairs = numpy.unique(numpy.stack([islandArray.ravel(), referenceArray.ravel()]), axis=1)
+        self.assertEqual(labelPairs.shape[1], numberOfIslands + 1)
+
+        # Islands are ordered by decreasing size and statistics match the labeled voxels
+        islandSizes = numpy.bincount(islandArray.ravel())[1:]
+        self.assertTrue(numpy.all(numpy.diff(islandSizes) <= 0))
+        for islandIndex in [0, numberOfIslands // 2, numberOfIslands - 1]:
+            self.assertEqual(islandMath.GetIslandSize(islandIndex), islandSizes[islandIndex])
+            k, j, i = numpy.nonzero(islandArray == islandIndex + 1)
+            inputExtent = self.inputImage.GetExtent()
+            i, j, k = i + inputExtent[0], j + inputExtent[2], k + inputExtent[4]
+            extent = [0] * 6
+            self.assertTrue(islandMath.GetIslandExtent(islandIndex, extent))
+            self.assertEqual(extent, [i.min(), i.max(), j.min(), j.max(), k.min(), k.max()])
+            centroid = [0.0] * 3
+            self.assertTrue(islandMath.GetIslandCentroid(islandIndex, centroid))
+            self.assertTrue(numpy.allclose(centroid, [i.mean(), j.mean(), k.mean()]))
+        self.assertFalse(islandMath.GetIslandExtent(numberOfIslands, [0] * 6))
+
+    def test_fullyConnectedMinimumSize(self):
+        faceConnectedIslandMath, faceConnectedArray = self.computeIslands(False)
+        islandMath, islandArray = self.computeIslands(True, minimumSize=5)
+
+        # Fully connected islands are unions of face connected islands
+        self.assertLess(islandMath.GetOriginalNumberOfIslands(), faceConnectedIslandMath.GetOriginalNumberOfIslands())
+        foreground = faceConnectedArray > 0
+        labelPairs = numpy.unique(numpy.stack([faceConnectedArray[foreground], islandArray[foreground]]), axis=1)
+        self.assertEqual(len(numpy.unique(labelPairs[0])), labelPairs.shape[1])
+
+        # Islands smaller than minimum size are removed
+        islandSizes = numpy.bincount(islandArray.ravel())[1:]
+        self.assertEqual(len(islandSizes), islandMath.GetNumberOfIslands())
+        self.assertTrue(numpy.all(islandSizes >= 5))
+
+    def runTest(self):
+        self.setUp()
+        self.test_faceConnected()
+        self.setUp()
+        self.test_fullyConnectedMinimumSize()
@@ -14,11 +14,16 @@
 #include "vtkPointData.h"
 #include "vtkImageData.h"
 #include "vtkAlgorithm.h"
+#include <vtkSMPThreadLocal.h>
+#include <vtkSMPTools.h>
 #include <vtkVersion.h>
 
-#include "itkConnectedComponentImageFilter.h"
-#include "itkRelabelComponentImageFilter.h"
-#include "itkCommand.h"
+// STD includes
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
 
 vtkStandardNewMacro(vtkITKIslandMath);
 
@@ -47,76 +52,474 @@ void vtkITKIslandMath::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "OriginalNumberOfIslands: " << OriginalNumberOfIslands << std::endl;
 }
 
-// Note: local function not method - conforms to signature in itkCommand.h
-void vtkITKIslandMathHandleProgressEvent (itk::Object *caller,
-                                          const itk::EventObject& vtkNotUsed(eventObject),
-                                          void *clientdata)
+vtkIdType vtkITKIslandMath::GetIslandSize(unsigned long islandIndex)
 {
-  itk::ProcessObject *itkFilter = dynamic_cast<itk::ProcessObject*>(caller);
-  vtkAlgorithm *vtkFilter = reinterpret_cast<vtkAlgorithm*>(clientdata);
-  if ( itkFilter && vtkFilter )
+  if (islandIndex >= this->IslandSizes.size())
     {
-    vtkFilter->UpdateProgress ( itkFilter->GetProgress() );
+    return 0;
     }
+  return this->IslandSizes[islandIndex];
+}
+
+bool vtkITKIslandMath::GetIslandExtent(unsigned long islandIndex, int extent[6])
+{
+  if (islandIndex >= this->IslandSizes.size())
+    {
+    return false;
+    }
+  std::copy_n(this->IslandExtents.begin() + 6 * islandIndex, 6, extent);
+  return true;
+}
+
+bool vtkITKIslandMath::GetIslandCentroid(unsigned long islandIndex, double centroidIjk[3])
+{
+  if (islandIndex >= this->IslandSizes.size())
+    {
+    return false;
+    }
+  std::copy_n(this->IslandCentroids.begin() + 3 * islandIndex, 3, centroidIjk);
+  return true;
+}
+
+namespace
+{
+
+// Voxel statistics of a connected component, accumulated in the labeling pass
+struct ComponentInfo
+{
+  vtkIdType Size{ 0 };
+  int Extent[6]{ VTK_INT_MAX, VTK_INT_MIN, VTK_INT_MAX, VTK_INT_MIN, VTK_INT_MAX, VTK_INT_MIN };
+  double CoordinateSum[3]{ 0.0, 0.0, 0.0 };
+
+  void AddRun(int x0, int x1, int y, int z)
+  {
+    vtkIdType runLength = x1 - x0 + 1;
+    this->Size += runLength;
+    this->Extent[0] = std::min(this->Extent[0], x0);
+    this->Extent[1] = std::max(this->Extent[1], x1);
+    this->Extent[2] = std::min(this->Extent[2], y);
+    this->Extent[3] = std::max(this->Extent[3], y);
+    this->Extent[4] = std::min(this->Extent[4], z);
+    this->Extent[5] = std::max(this->Extent[5], z);
+    this->CoordinateSum[0] += 0.5 * (x0 + x1) * runLength;
+    this->CoordinateSum[1] += static_cast<double>(y) * runLength;
+    this->CoordinateSum[2] += static_cast<double>(z) * runLength;
+  }
+
+  void Merge(const ComponentInfo& other)
+  {
+    this->Size += other.Size;
+    for (int axis = 0; axis < 3; ++axis)
+      {
+      this->Extent[axis * 2] = std::min(this->Extent[axis * 2], other.Extent[axis * 2]);
+      this->Extent[axis * 2 + 1] = std::max(this->Extent[axis * 2 + 1], other.Extent[axis * 2 + 1]);
+      this->CoordinateSum[axis] += other.CoordinateSum[axis];
+      }
+  }
+};
+
+/// Connected component labeling by union-find on voxel indices within the foreground extent.
+/// The volume is split into slabs along the Z axis that are labeled in parallel, then components
+/// that touch at slab boundaries are merged. Each tree is linked towards the smaller voxel index,
+/// therefore the root of each component is its first voxel in memory order.
+template <class T, class IndexType>
+class ConnectedComponentLabeling
+{
+public:
+  ConnectedComponentLabeling(const T* inPtr, const int inDims[3], const int foregroundExtent[6], bool fullyConnected)
+    : InPtr(inPtr)
+  {
+    for (int axis = 0; axis < 3; ++axis)
+      {
+      this->InDims[axis] = inDims[axis];
+      this->Dims[axis] = foregroundExtent[axis * 2 + 1] - foregroundExtent[axis * 2] + 1;
+      this->Offset[axis] = foregroundExtent[axis * 2];
+      }
+    // Neighbors that precede the current voxel in memory order
+    for (int dz = -1; dz <= 0; ++dz)
+      {
+      for (int dy = -1; dy <= 1; ++dy)
+        {
+        for (int dx = -1; dx <= 1; ++dx)
+          {
+          bool preceding = (dz < 0) || (dz == 0 && dy < 0) || (dz == 0 && dy == 0 && dx < 0);
+          int numberOfNonZeroOffsets = (dx != 0) + (dy != 0) + (dz != 0);
+          if (!preceding || (!fullyConnected && numberOfNonZeroOffsets > 1))
+            {
+            continue;
+            }
+          this->NeighborOffsets.push_back({ { dx, dy, dz } });
+          }
+        }
+      }
+  }
+
+  IndexType GetIndex(int x, int y, int z) const
+  {
+    return static_cast<IndexType>(x) + static_cast<IndexType>(this->Dims[0])
+      * (static_cast<IndexType>(y) + static_cast<IndexType>(this->Dims[1]) * static_cast<IndexType>(z));
+  }
+
+  const T* GetInputRow(int y, int z) const
+  {
+    return this->InPtr + ((static_cast<vtkIdType>(z) + this->Offset[2]) * this->InDims[1] + y + this->Offset[1])
+      * this->InDims[0] + this->Offset[0];
+  }
+
+  IndexType FindRoot(IndexType index)
+  {
+    // path halving
+    while (this->Parents[index] != index)
+      {
+      this->Parents[index] = this->Parents[this->Parents[index]];
+      index = this->Parents[index];
+      }
+    return index;
+  }
+
+  IndexType FindRootReadOnly(IndexType index) const
+  {
+    while (this->Parents[index] != index)
+      {
+      index = this->Parents[index];
+      }
+    return index;
+  }
+
+  void Union(IndexType index1, IndexType index2)
+  {
+    IndexType root1 = this->FindRoot(index1);
+    IndexType root2 = this->FindRoot(index2);
+    if (root1 < root2)
+      {
+      this->Parents[root2] = root1;
+      }
+    else if (root2 < root1)
+      {
+      this->Parents[root1] = root2;
+      }
+  }
+
+  /// Link voxel to its foreground neighbors that precede it in memory order.
+  /// Neighbors in slices before firstZ are ignored.
+  void LinkNeighbors(int x, int y, int z, int firstZ)
+  {
+    IndexType index = this->GetIndex(x, y, z);
+    for (const std::array<int, 3>& neighborOffset : this->NeighborOffsets)
+      {
+      int nx = x + neighborOffset[0];
+      int ny = y + neighborOffset[1];
+      int nz = z + neighborOffset[2];
+      if (nx < 0 || nx >= this->Dims[0] || ny < 0 || ny >= this->Dims[1] || nz < firstZ)
+        {
+        continue;
+        }
+      IndexType neighborIndex = this->GetIndex(nx, ny, nz);
+      if (this->Parents[neighborIndex] != Background)
+        {
+        this->Union(index, neighborIndex);
+        }
+      }
+  }
+
+  /// Compute components. Returns root and statistics of each component.
+  void Execute(std::unordered_map<IndexType, ComponentInfo>& components)
+  {
+    this->Parents.resize(static_cast<size_t>(this->Dims[0]) * this->Dims[1] * this->Dims[2]);
+
+    // First pass: label slabs independently
+    int numberOfSlabs = std::min(this->Dims[2], 4 * vtkSMPTools::GetEstimatedNumberOfThreads());
+    int slabThickness = (this->Dims[2] + numberOfSlabs - 1) / numberOfSlabs;
+    numberOfSlabs = (this->Dims[2] + slabThickness - 1) / slabThickness;
+    auto labelSlabs = [&](vtkIdType beginSlab, vtkIdType endSlab)
+      {
+      for (vtkIdType slab = beginSlab; slab < endSlab; ++slab)
+        {
+        int firstZ = static_cast<int>(slab) * slabThickness;
+        int lastZ = std::min(firstZ + slabThickness, this->Dims[2]) - 1;
+        for (int z = firstZ; z <= lastZ; ++z)
+          {
+          for (int y = 0; y < this->Dims[1]; ++y)
+            {
+            const T* inRowPtr = this->GetInputRow(y, z);
+            IndexType index = this->GetIndex(0, y, z);
+            for (int x = 0; x < this->Dims[0]; ++x, ++index)
+              {
+              if (inRowPtr[x] == 0)
+                {
+                this->Parents[index] = Background;
+                continue;
+                }
+              this->Parents[index] = index;
+              this->LinkNeighbors(x, y, z, firstZ);
+              }
+            }
+          }
+        }
+      };
+    vtkSMPTools::For(0, numberOfSlabs, 1, labelSlabs);
+
+    // Merge components at slab boundaries
+    for (int slab = 1; slab < numberOfSlabs; ++slab)
+      {
+      int z = slab * slabThickness;
+      for (int y = 0; y < this->Dims[1]; ++y)
+        {
+        IndexType index = this->GetIndex(0, y, z);
+        for (int x = 0; x < this->Dims[0]; ++x, ++index)
+          {
+          if (this->Parents[index] != Background)
+            {
+            this->LinkNeighbors(x, y, z, z - 1);
+            }
+          }
+        }
+      }
+
+    // Second pass: compute component statistics (the parent array is not modified anymore)
+    vtkSMPThreadLocal<std::unordered_map<IndexType, ComponentInfo> > localComponents;
+    auto computeComponentInfo = [&](vtkIdType beginZ, vtkIdType endZ)
+      {
+      std::unordered_map<IndexType, ComponentInfo>& threadComponents = localComponents.Local();
+      for (int z = static_cast<int>(beginZ); z < static_cast<int>(endZ); ++z)
+        {
+        for (int y = 0; y < this->Dims[1]; ++y)
+          {
+          IndexType index = this->GetIndex(0, y, z);
+          int x = 0;
+          while (x < this->Dims[0])
+            {
+            if (this->Parents[index] == Background)
+              {
+              ++x;
+              ++index;
+              continue;
+              }
+            // Collect run of voxels of the same component
+            IndexType root = this->FindRootReadOnly(index);
+            int runStart = x;
+            for (++x, ++index; x < this->Dims[0]; ++x, ++index)
+              {
+              IndexType parent = this->Parents[index];
+              if (parent == Background || (parent != root && this->FindRootReadOnly(index) != root))
+                {
+                break;
+                }
+              }
+            threadComponents[root].AddRun(runStart + this->Offset[0], x - 1 + this->Offset[0],
+              y + this->Offset[1], z + this->Offset[2]);
+            }
+          }
+        }
+      };
+    vtkSMPTools::For(0, this->Dims[2], computeComponentInfo);
+
+    components.clear();
+    for (auto threadComponentsIt = localComponents.begin(); threadComponentsIt != localComponents.end(); ++threadComponentsIt)
+      {
+      for (const auto& component : *threadComponentsIt)
+        {
+        components[component.first].Merge(component.second);
+        }
+      }
+  }
+
+  /// Write label value of each voxel in the foreground extent. Labels of components are specified
+  /// by root, components that are not found in the map are set to 0.
+  template <class LabelType>
+  void WriteLabels(LabelType* outPtr, const std::unordered_map<IndexType, LabelType>& labels) const
+  {
+    auto writeLabels = [&](vtkIdType beginZ, vtkIdType endZ)
+      {
+      for (int z = static_cast<int>(beginZ); z < static_cast<int>(endZ); ++z)
+        {
+        for (int y = 0; y < this->Dims[1]; ++y)
+          {
+          LabelType* outRowPtr = outPtr + (this->GetInputRow(y, z) - this->InPtr);
+          IndexType index = this->GetIndex(0, y, z);
+          IndexType lastRoot = Background;
+          LabelType lastLabel = 0;
+          for (int x = 0; x < this->Dims[0]; ++x, ++index)
+            {
+            if (this->Parents[index] == Background)
+              {
+              outRowPtr[x] = 0;
+              continue;
+              }
+            IndexType root = this->FindRootReadOnly(index);
+            if (root != lastRoot)
+              {
+              auto labelIt = labels.find(root);
+              lastLabel = (labelIt != labels.end() ? labelIt->second : 0);
+              lastRoot = root;
+              }
+            outRowPtr[x] = lastLabel;
+            }
+          }
+        }
+      };
+    vtkSMPTools::For(0, this->Dims[2], writeLabels);
+  }
+
+  static constexpr IndexType Background = std::numeric_limits<IndexType>::max();
+
+private:
+  const T* InPtr;
+  vtkIdType InDims[3];
+  int Dims[3];
+  int Offset[3];
+  std::vector<std::array<int, 3> > NeighborOffsets;
+  std::vector<IndexType> Parents;
 };
 
+/// Compute extent of non-zero voxels. Returns false if there are no non-zero voxels.
+template <class T>
+bool GetForegroundExtent(const T* inPtr, const int dims[3], int foregroundExtent[6])
+{
+  vtkSMPThreadLocal<std::array<int, 6> > localExtents(
+    std::array<int, 6>{ { VTK_INT_MAX, VTK_INT_MIN, VTK_INT_MAX, VTK_INT_MIN, VTK_INT_MAX, VTK_INT_MIN } });
+  auto computeExtent = [&](vtkIdType beginZ, vtkIdType endZ)
+    {
+    std::array<int, 6>& extent = localExtents.Local();
+    for (int z = static_cast<int>(beginZ); z < static_cast<int>(endZ); ++z)
+      {
+      for (int y = 0; y < dims[1]; ++y)
+        {
+        const T* rowPtr = inPtr + (static_cast<vtkIdType>(z) * dims[1] + y) * dims[0];
+        int x = 0;
+        while (x < dims[0] && rowPtr[x] == 0)
+          {
+          ++x;
+          }
+        if (x == dims[0])
+          {
+          continue;
+          }
+        int lastX = dims[0] - 1;
+        while (rowPtr[lastX] == 0)
+          {
+          --lastX;
+          }
+        extent[0] = std::min(extent[0], x);
+        extent[1] = std::max(extent[1], lastX);
+        extent[2] = std::min(extent[2], y);
+        extent[3] = std::max(extent[3], y);
+        extent[4] = std::min(extent[4], z);
+        extent[5] = std::max(extent[5], z);
+        }
+      }
+    };
+  vtkSMPTools::For(0, dims[2], computeExtent);
+
+  std::array<int, 6> mergedExtent{ { VTK_INT_MAX, VTK_INT_MIN, VTK_INT_MAX, VTK_INT_MIN, VTK_INT_MAX, VTK_INT_MIN } };
+  for (auto extentIt = localExtents.begin(); extentIt != localExtents.end(); ++extentIt)
+    {
+    for (int axis = 0; axis < 3; ++axis)
+      {
+      mergedExtent[axis * 2] = std::min(mergedExtent[axis * 2], (*extentIt)[axis * 2]);
+      mergedExtent[axis * 2 + 1] = std::max(mergedExtent[axis * 2 + 1], (*extentIt)[axis * 2 + 1]);
+      }
+    }
+  std::copy(mergedExtent.begin(), mergedExtent.end(), foregroundExtent);
+  return foregroundExtent[0] <= foregroundExtent[1];
+}
+
+} // end of anonymous namespace
+
+template <class T, class IndexType>
+void vtkITKIslandMathExecuteLabeling(const T* inPtr, T* outPtr, const int dims[3], const int foregroundExtent[6],
+  bool fullyConnected, vtkIdType minimumSize, vtkIdType maximumSize, unsigned long& originalNumberOfIslands,
+  std::vector<vtkIdType>& islandSizes, std::vector<int>& islandExtents, std::vector<double>& islandCentroids)
+{
+  ConnectedComponentLabeling<T, IndexType> labeling(inPtr, dims, foregroundExtent, fullyConnected);
+  std::unordered_map<IndexType, ComponentInfo> components;
+  labeling.Execute(components);
+  originalNumberOfIslands = static_cast<unsigned long>(components.size());
+
+  // Sort islands by decreasing size, islands of equal size by the position of their first voxel
+  std::vector<std::pair<IndexType, const ComponentInfo*> > islands;
+  for (const auto& component : components)
+    {
+    if (component.second.Size >= minimumSize && component.second.Size <= maximumSize)
+      {
+      islands.emplace_back(component.first, &component.second);
+      }
+    }
+  std::sort(islands.begin(), islands.end(),
+    [](const std::pair<IndexType, const ComponentInfo*>& a, const std::pair<IndexType, const ComponentInfo*>& b)
+    {
+    if (a.second->Size != b.second->Size)
+      {
+      return a.second->Size > b.second->Size;
+      }
+    return a.first < b.first;
+    });
+
+  std::unordered_map<IndexType, T> labels;
+  for (size_t islandIndex = 0; islandIndex < islands.size(); ++islandIndex)
+    {
+    const ComponentInfo* island = islands[islandIndex].second;
+    labels[islands[islandIndex].first] = static_cast<T>(islandIndex + 1);
+    islandSizes.push_back(island->Size);
+    islandExtents.insert(islandExtents.end(), island->Extent, island->Extent + 6);
+    for (int axis = 0; axis < 3; ++axis)
+      {
+      islandCentroids.push_back(island->CoordinateSum[axis] / island->Size);
+      }
+    }
+
+  labeling.WriteLabels(outPtr, labels);
+}
+
 template <class T>
 void vtkITKIslandMathExecute(vtkITKIslandMath *self, vtkImageData* input,
                 vtkImageData* vtkNotUsed(output),
-                T* inPtr, T* outPtr)
+                T* inPtr, T* outPtr, std::vector<vtkIdType>& islandSizes, std::vector<int>& islandExtents,
+                std::vector<double>& islandCentroids)
 {
-
   int dims[3];
   input->GetDimensions(dims);
-  double spacing[3];
-  input->GetSpacing(spacing);
-
-  // Wrap scalars into an ITK image
-  // - mostly rely on defaults for spacing, origin etc for this filter
-  typedef itk::Image<T, 3> ImageType;
-  typename ImageType::Pointer inImage = ImageType::New();
-  typename ImageType::RegionType region;
-  typename ImageType::IndexType index;
-  typename ImageType::SizeType size;
-
-  inImage->GetPixelContainer()->SetImportPointer(inPtr, dims[0]*dims[1]*dims[2], false);
-  index[0] = index[1] = index[2] = 0;
-  region.SetIndex(index);
-  size[0] = dims[0]; size[1] = dims[1]; size[2] = dims[2];
-  region.SetSize(size);
-  inImage->SetLargestPossibleRegion(region);
-  inImage->SetBufferedRegion(region);
-  inImage->SetSpacing(spacing);
-
-  // set up the progress callback
-  itk::CStyleCommand::Pointer progressCommand = itk::CStyleCommand::New();
-  progressCommand->SetClientData( static_cast<void *>(self) );
-  progressCommand->SetCallback( vtkITKIslandMathHandleProgressEvent );
-
-
-  // Calculate the island operation
-  // ccfilter - identifies the islands
-  // relabel - sorts them by size
-  typedef itk::ConnectedComponentImageFilter<ImageType, ImageType> ConnectedComponentType;
-  typename ConnectedComponentType::Pointer ccfilter = ConnectedComponentType::New();
-  typedef itk::RelabelComponentImageFilter<ImageType, ImageType> RelabelComponentType;
-  typename RelabelComponentType::Pointer relabel = RelabelComponentType::New();
-
-  ccfilter->AddObserver(itk::ProgressEvent(), progressCommand);
-  relabel->AddObserver(itk::ProgressEvent(), progressCommand);
-
-  ccfilter->SetFullyConnected(self->GetFullyConnected());
-  ccfilter->SetInput( inImage );
-  relabel->SetInput( ccfilter->GetOutput() );
-  relabel->SetMinimumObjectSize( self->GetMinimumSize() );
-  relabel->Update();
-  self->SetNumberOfIslands(relabel->GetNumberOfObjects());
-  self->SetOriginalNumberOfIslands(relabel->GetOriginalNumberOfObjects());
-
-  // Copy to the output
-  memcpy(outPtr, relabel->GetOutput()->GetBufferPointer(),
-         relabel->GetOutput()->GetBufferedRegion().GetNumberOfPixels() * sizeof(T));
+  memset(outPtr, 0, static_cast<size_t>(dims[0]) * dims[1] * dims[2] * sizeof(T));
 
+  // Only the extent of the foreground voxels is processed
+  int foregroundExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  if (!GetForegroundExtent(inPtr, dims, foregroundExtent))
+    {
+    self->SetNumberOfIslands(0);
+    self->SetOriginalNumberOfIslands(0);
+    return;
+    }
+
+  // Voxel indices within the foreground extent are stored in 32 bits if possible to reduce memory usage
+  vtkIdType numberOfVoxels = static_cast<vtkIdType>(foregroundExtent[1] - foregroundExtent[0] + 1)
+    * (foregroundExtent[3] - foregroundExtent[2] + 1) * (foregroundExtent[5] - foregroundExtent[4] + 1);
+  unsigned long originalNumberOfIslands = 0;
+  if (numberOfVoxels < static_cast<vtkIdType>(std::numeric_limits<vtkTypeUInt32>::max()))
+    {
+    vtkITKIslandMathExecuteLabeling<T, vtkTypeUInt32>(inPtr, outPtr, dims, foregroundExtent,
+      self->GetFullyConnected() != 0, self->GetMinimumSize(), self->GetMaximumSize(), originalNumberOfIslands,
+      islandSizes, islandExtents, islandCentroids);
+    }
+  else
+    {
+    vtkITKIslandMathExecuteLabeling<T, vtkTypeUInt64>(inPtr, outPtr, dims, foregroundExtent,
+      self->GetFullyConnected() != 0, self->GetMinimumSize(), self->GetMaximumSize(), originalNumberOfIslands,
+      islandSizes, islandExtents, islandCentroids);
+    }
+  self->SetNumberOfIslands(static_cast<unsigned long>(islandSizes.size()));
+  self->SetOriginalNumberOfIslands(originalNumberOfIslands);
+
+  // Island extents are returned in the extent of the input image
+  int* inputExtent = input->GetExtent();
+  for (size_t islandIndex = 0; islandIndex < islandSizes.size(); ++islandIndex)
+    {
+    for (int axis = 0; axis < 3; ++axis)
+      {
+      islandExtents[islandIndex * 6 + axis * 2] += inputExtent[axis * 2];
+      islandExtents[islandIndex * 6 + axis * 2 + 1] += inputExtent[axis * 2];
+      islandCentroids[islandIndex * 3 + axis] += inputExtent[axis * 2];
+      }
+    }
 }
 
 
@@ -128,6 +531,10 @@ void vtkITKIslandMath::SimpleExecute(vtkImageData *input, vtkImageData *output)
 {
   vtkDebugMacro(<< "Executing Island Math");
 
+  this->IslandSizes.clear();
+  this->IslandExtents.clear();
+  this->IslandCentroids.clear();
+
   //
   // Initialize and check input
   //
@@ -147,30 +554,16 @@ void vtkITKIslandMath::SimpleExecute(vtkImageData *input, vtkImageData *output)
 
   if (inScalars->GetNumberOfComponents() == 1 )
     {
-
-////////// These types are not defined in itk ////////////
-#undef VTK_TYPE_USE_LONG_LONG
-#undef VTK_TYPE_USE___INT64
-
-#define CALL  vtkITKIslandMathExecute(this, input, output, static_cast<VTK_TT *>(inPtr), static_cast<VTK_TT *>(outPtr));
-
     void* inPtr = input->GetScalarPointer();
     void* outPtr = output->GetScalarPointer();
 
     switch (inScalars->GetDataType())
       {
-      vtkTemplateMacroCase(VTK_LONG, long, CALL);                               \
-      vtkTemplateMacroCase(VTK_UNSIGNED_LONG, unsigned long, CALL);             \
-      vtkTemplateMacroCase(VTK_INT, int, CALL);                                 \
-      vtkTemplateMacroCase(VTK_UNSIGNED_INT, unsigned int, CALL);               \
-      vtkTemplateMacroCase(VTK_SHORT, short, CALL);                             \
-      vtkTemplateMacroCase(VTK_UNSIGNED_SHORT, unsigned short, CALL);           \
-      vtkTemplateMacroCase(VTK_CHAR, char, CALL);                               \
-      vtkTemplateMacroCase(VTK_SIGNED_CHAR, signed char, CALL);                 \
-      vtkTemplateMacroCase(VTK_UNSIGNED_CHAR, unsigned char, CALL);             \
+      vtkTemplateMacro(vtkITKIslandMathExecute(this, input, output, static_cast<VTK_TT *>(inPtr), static_cast<VTK_TT *>(outPtr),
+        this->IslandSizes, this->IslandExtents, this->IslandCentroids));
       default:
         {
-        vtkErrorMacro(<< "Incompatible data type for this version of ITK.");
+        vtkErrorMacro(<< "Unsupported scalar type.");
         }
       } //switch
     }
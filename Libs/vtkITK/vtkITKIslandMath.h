@@ -13,9 +13,18 @@
 #include "vtkITK.h"
 #include "vtkSimpleImageToImageFilter.h"
 
-/// \brief ITK-based utilities for manipulating connected regions in label maps.
-/// Limitation: The filter does not work correctly with input volume that has
-/// unsigned long scalar type on Linux and macOS.
+// STD includes
+#include <vector>
+
+/// \brief Utilities for manipulating connected regions in label maps.
+///
+/// All non-zero voxels are considered foreground. Islands (connected components of foreground voxels)
+/// are labeled in the output by decreasing size: the largest island has label value 1.
+/// Islands of the same size are ordered by the position of their first voxel (in memory order).
+///
+/// Islands are computed by multithreaded two-pass union-find labeling restricted to the
+/// extent of the foreground voxels. Size, extent and centroid of each island are computed
+/// in the same pass.
 ///
 class VTK_ITK_EXPORT vtkITKIslandMath : public vtkSimpleImageToImageFilter
 {
@@ -58,6 +67,20 @@ class VTK_ITK_EXPORT vtkITKIslandMath : public vtkSimpleImageToImageFilter
   vtkGetMacro(OriginalNumberOfIslands, unsigned long);
   vtkSetMacro(OriginalNumberOfIslands, unsigned long);
 
+  ///
+  /// Number of voxels in an island.
+  /// Islands are indexed from 0 to NumberOfIslands-1, island index i has label value i+1 in the output.
+  /// Returns 0 if the island index is invalid.
+  vtkIdType GetIslandSize(unsigned long islandIndex);
+
+  ///
+  /// IJK extent of the voxels of an island. Returns false if the island index is invalid.
+  bool GetIslandExtent(unsigned long islandIndex, int extent[6]);
+
+  ///
+  /// Centroid of the voxels of an island in IJK coordinates. Returns false if the island index is invalid.
+  bool GetIslandCentroid(unsigned long islandIndex, double centroidIjk[3]);
+
 
 protected:
   vtkITKIslandMath();
@@ -73,6 +96,11 @@ protected:
   unsigned long NumberOfIslands;
   unsigned long OriginalNumberOfIslands;
 
+  /// Size (one value per island), extent (6 values per island), and centroid (3 values per island)
+  std::vector<vtkIdType> IslandSizes;
+  std::vector<int> IslandExtents;
+  std::vector<double> IslandCentroids;
+
 private:
   vtkITKIslandMath(const vtkITKIslandMath&) = delete;
   void operator=(const vtkITKIslandMath&) = delete;
@@ -0,0 +1,308 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// SegmentationCore includes
+#include "vtkClosedSurfaceToBinaryLabelmapConversionRule.h"
+#include "vtkOrientedImageData.h"
+#include "vtkSegment.h"
+#include "vtkSegmentation.h"
+#include "vtkSegmentationConverter.h"
+#include "vtkSegmentationConverterFactory.h"
+
+// VTK includes
+#include <vtkImageStencil.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataNormals.h>
+#include <vtkPolyDataToImageStencil.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
+#include <vtkSphereSource.h>
+#include <vtkStripper.h>
+#include <vtkTimerLog.h>
+#include <vtkTransform.h>
+#include <vtkTransformPolyDataFilter.h>
+#include <vtkTriangleFilter.h>
+
+// STD includes
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Closed surface to binary labelmap conversion is compared to rasterizing the surface
+// with a single image stencil, and timed with different number of threads.
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+void CreateSphere(vtkPolyData* polyData, double center[3], double radius, int resolution)
+{
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetCenter(center);
+  sphere->SetRadius(radius);
+  sphere->SetThetaResolution(resolution);
+  sphere->SetPhiResolution(resolution);
+  sphere->Update();
+  polyData->DeepCopy(sphere->GetOutput());
+}
+
+//----------------------------------------------------------------------------
+std::string GetImageGeometry(double spacing, int size)
+{
+  std::stringstream ss;
+  ss << spacing << "; 0; 0; -60;"
+     << "0; " << spacing << "; 0; -60;"
+     << "0; 0; " << spacing << "; -60;"
+     << "0; 0; 0; 1;"
+     << "0; " << size - 1 << "; 0; " << size - 1 << "; 0; " << size - 1 << ";";
+  return ss.str();
+}
+
+//----------------------------------------------------------------------------
+// Rasterize the surface into the geometry of the labelmap with a single stencil for the whole volume
+void ReferenceRasterize(vtkPolyData* surface, vtkOrientedImageData* geometry, vtkImageData* referenceLabelmap)
+{
+  vtkNew<vtkMatrix4x4> imageToWorldMatrix;
+  geometry->GetImageToWorldMatrix(imageToWorldMatrix);
+  vtkNew<vtkTransform> worldToImageTransform;
+  worldToImageTransform->SetMatrix(imageToWorldMatrix);
+  worldToImageTransform->Inverse();
+
+  vtkNew<vtkTransformPolyDataFilter> transformPolyDataFilter;
+  transformPolyDataFilter->SetInputData(surface);
+  transformPolyDataFilter->SetTransform(worldToImageTransform);
+  vtkNew<vtkPolyDataNormals> normalFilter;
+  normalFilter->SetInputConnection(transformPolyDataFilter->GetOutputPort());
+  normalFilter->ConsistencyOn();
+  vtkNew<vtkTriangleFilter> triangle;
+  triangle->SetInputConnection(normalFilter->GetOutputPort());
+  vtkNew<vtkStripper> stripper;
+  stripper->SetInputConnection(triangle->GetOutputPort());
+
+  vtkNew<vtkImageData> emptyImage;
+  emptyImage->SetExtent(geometry->GetExtent());
+  emptyImage->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  emptyImage->GetPointData()->GetScalars()->Fill(0);
+
+  vtkNew<vtkPolyDataToImageStencil> polyDataToImageStencil;
+  polyDataToImageStencil->SetInputConnection(stripper->GetOutputPort());
+  polyDataToImageStencil->SetOutputSpacing(emptyImage->GetSpacing());
+  polyDataToImageStencil->SetOutputOrigin(emptyImage->GetOrigin());
+  polyDataToImageStencil->SetOutputWholeExtent(emptyImage->GetExtent());
+
+  vtkNew<vtkImageStencil> stencil;
+  stencil->SetInputData(emptyImage);
+  stencil->SetStencilConnection(polyDataToImageStencil->GetOutputPort());
+  stencil->ReverseStencilOn();
+  stencil->SetBackgroundValue(1);
+  stencil->Update();
+  referenceLabelmap->DeepCopy(stencil->GetOutput());
+}
+
+//----------------------------------------------------------------------------
+bool CompareLabelmaps(vtkImageData* labelmap, vtkImageData* referenceLabelmap, vtkIdType& numberOfForegroundVoxels)
+{
+  int* extent = labelmap->GetExtent();
+  int* referenceExtent = referenceLabelmap->GetExtent();
+  for (int i = 0; i < 6; ++i)
+    {
+    if (extent[i] != referenceExtent[i])
+      {
+      std::cerr << "Extent mismatch: " << extent[0] << " " << extent[1] << " " << extent[2] << " " << extent[3]
+        << " " << extent[4] << " " << extent[5] << " (expected " << referenceExtent[0] << " " << referenceExtent[1] << " "
+        << referenceExtent[2] << " " << referenceExtent[3] << " " << referenceExtent[4] << " " << referenceExtent[5] << ")" << std::endl;
+      return false;
+      }
+    }
+  if (labelmap->GetScalarType() != VTK_UNSIGNED_CHAR)
+    {
+    std::cerr << "Unexpected labelmap scalar type: " << labelmap->GetScalarTypeAsString() << std::endl;
+    return false;
+    }
+  vtkIdType numberOfVoxels = labelmap->GetNumberOfPoints();
+  const unsigned char* voxels = static_cast<const unsigned char*>(labelmap->GetScalarPointer());
+  const unsigned char* referenceVoxels = static_cast<const unsigned char*>(referenceLabelmap->GetScalarPointer());
+  if (memcmp(voxels, referenceVoxels, numberOfVoxels) != 0)
+    {
+    std::cerr << "Labelmap voxels differ from the reference" << std::endl;
+    return false;
+    }
+  numberOfForegroundVoxels = 0;
+  for (vtkIdType i = 0; i < numberOfVoxels; ++i)
+    {
+    numberOfForegroundVoxels += (voxels[i] != 0);
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool ConvertSegment(vtkPolyData* surface, const std::string& geometry, vtkOrientedImageData* labelmap)
+{
+  vtkNew<vtkSegment> segment;
+  segment->AddRepresentation(vtkSegmentationConverter::GetSegmentationClosedSurfaceRepresentationName(), surface);
+  vtkNew<vtkClosedSurfaceToBinaryLabelmapConversionRule> rule;
+  rule->SetConversionParameter(vtkSegmentationConverter::GetReferenceImageGeometryParameterName(), geometry);
+  if (!rule->Convert(segment))
+    {
+    return false;
+    }
+  vtkOrientedImageData* convertedLabelmap = vtkOrientedImageData::SafeDownCast(
+    segment->GetRepresentation(vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName()));
+  if (!convertedLabelmap)
+    {
+    return false;
+    }
+  labelmap->DeepCopy(convertedLabelmap);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+int TestSingleSegment(int volumeSize)
+{
+  // Sphere center is off the voxel grid, so that cells cross slab boundaries at arbitrary positions
+  vtkNew<vtkPolyData> sphere;
+  double center[3] = { 3.3, -1.7, 2.1 };
+  CreateSphere(sphere, center, 45.0, 128);
+  std::string geometry = GetImageGeometry(120.0 / volumeSize, volumeSize);
+
+  int threadCounts[] = { 1, 2, 4, 8, 16, 32 };
+  double singleThreadTime = 0.0;
+  for (int numberOfThreads : threadCounts)
+    {
+    vtkSMPTools::Initialize(numberOfThreads);
+    vtkNew<vtkOrientedImageData> labelmap;
+    double startTime = vtkTimerLog::GetUniversalTime();
+    if (!ConvertSegment(sphere, geometry, labelmap))
+      {
+      std::cerr << __LINE__ << ": Conversion failed with " << numberOfThreads << " threads" << std::endl;
+      return EXIT_FAILURE;
+      }
+    double conversionTime = vtkTimerLog::GetUniversalTime() - startTime;
+    if (numberOfThreads == 1)
+      {
+      singleThreadTime = conversionTime;
+      }
+
+    vtkNew<vtkImageData> referenceLabelmap;
+    ReferenceRasterize(sphere, labelmap, referenceLabelmap);
+    vtkIdType numberOfForegroundVoxels = 0;
+    if (!CompareLabelmaps(labelmap, referenceLabelmap, numberOfForegroundVoxels))
+      {
+      std::cerr << __LINE__ << ": Rasterized sphere with " << numberOfThreads << " threads does not match the reference" << std::endl;
+      return EXIT_FAILURE;
+      }
+    if (numberOfForegroundVoxels == 0)
+      {
+      std::cerr << __LINE__ << ": Rasterized sphere is empty" << std::endl;
+      return EXIT_FAILURE;
+      }
+    std::cout << "Rasterize " << volumeSize << "^3 sphere, " << numberOfThreads << " threads ("
+      << vtkSMPTools::GetEstimatedNumberOfThreads() << " used): " << conversionTime * 1000.0 << " ms"
+      << " (speedup " << (conversionTime > 0.0 ? singleThreadTime / conversionTime : 0.0) << "x), "
+      << numberOfForegroundVoxels << " voxels" << std::endl;
+    }
+  vtkSMPTools::Initialize();
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int TestMultipleSegments(int volumeSize)
+{
+  vtkSegmentationConverterFactory::GetInstance()->RegisterConverterRule(
+    vtkSmartPointer<vtkClosedSurfaceToBinaryLabelmapConversionRule>::New());
+
+  std::string geometry = GetImageGeometry(120.0 / volumeSize, volumeSize);
+  const int numberOfSegments = 8;
+
+  vtkNew<vtkSegmentation> segmentation;
+  segmentation->SetMasterRepresentationName(vtkSegmentationConverter::GetSegmentationClosedSurfaceRepresentationName());
+  segmentation->SetConversionParameter(vtkSegmentationConverter::GetReferenceImageGeometryParameterName(), geometry);
+  segmentation->SetConversionParameter(vtkClosedSurfaceToBinaryLabelmapConversionRule::GetCollapseLabelmapsParameterName(), "0");
+  for (int i = 0; i < numberOfSegments; ++i)
+    {
+    vtkNew<vtkPolyData> sphere;
+    double center[3] = { -35.0 + 10.0 * i, 20.0 - 5.5 * i, 1.5 * i };
+    CreateSphere(sphere, center, 8.0 + 2.0 * i, 64);
+    vtkNew<vtkSegment> segment;
+    segment->AddRepresentation(vtkSegmentationConverter::GetSegmentationClosedSurfaceRepresentationName(), sphere);
+    segmentation->AddSegment(segment);
+    }
+
+  double startTime = vtkTimerLog::GetUniversalTime();
+  if (!segmentation->CreateRepresentation(vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName()))
+    {
+    std::cerr << __LINE__ << ": Failed to convert segmentation to binary labelmap" << std::endl;
+    return EXIT_FAILURE;
+    }
+  double conversionTime = vtkTimerLog::GetUniversalTime() - startTime;
+
+  std::vector<std::string> segmentIds;
+  segmentation->GetSegmentIDs(segmentIds);
+  for (const std::string& segmentId : segmentIds)
+    {
+    vtkSegment* segment = segmentation->GetSegment(segmentId);
+    vtkPolyData* surface = vtkPolyData::SafeDownCast(
+      segment->GetRepresentation(vtkSegmentationConverter::GetSegmentationClosedSurfaceRepresentationName()));
+    vtkOrientedImageData* labelmap = vtkOrientedImageData::SafeDownCast(
+      segment->GetRepresentation(vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName()));
+    if (!surface || !labelmap)
+      {
+      std::cerr << __LINE__ << ": Missing representation in segment " << segmentId << std::endl;
+      return EXIT_FAILURE;
+      }
+    vtkNew<vtkImageData> referenceLabelmap;
+    ReferenceRasterize(surface, labelmap, referenceLabelmap);
+    vtkIdType numberOfForegroundVoxels = 0;
+    if (!CompareLabelmaps(labelmap, referenceLabelmap, numberOfForegroundVoxels) || numberOfForegroundVoxels == 0)
+      {
+      std::cerr << __LINE__ << ": Labelmap of segment " << segmentId << " does not match the reference" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  std::cout << "Rasterize " << numberOfSegments << " segments in " << volumeSize << "^3 volume: "
+    << conversionTime * 1000.0 << " ms" << std::endl;
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkClosedSurfaceToBinaryLabelmapConversionTest1(int argc, char* argv[])
+{
+  int volumeSize = 128;
+  if (argc > 1)
+    {
+    volumeSize = std::max(16, atoi(argv[1]));
+    }
+
+  if (TestSingleSegment(volumeSize) != EXIT_SUCCESS)
+    {
+    return EXIT_FAILURE;
+    }
+  if (TestMultipleSegments(volumeSize) != EXIT_SUCCESS)
+    {
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Closed surface to binary labelmap conversion test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -22,6 +22,7 @@
 #include <vtkImageAccumulate.h>
 #include <vtkNew.h>
 #include <vtkPolyData.h>
+#include <vtkSMPTools.h>
 #include <vtkSphereSource.h>
 
 // vtkSegmentationCore includes
@@ -33,6 +34,9 @@
 #include <vtkSegmentationConverter.h>
 #include <vtkSegmentationConverterFactory.h>
 
+// STD includes
+#include <cstring>
+
 void CreateSpherePolyData(vtkPolyData* polyData);
 
 //----------------------------------------------------------------------------
@@ -132,6 +136,52 @@ int vtkClosedSurfaceToFractionalLabelMapConversionTest1(int vtkNotUsed(argc), ch
     return EXIT_FAILURE;
   }
 
+  // Slabs are sampled independently, the result must not depend on the number of threads
+  vtkSmartPointer<vtkMatrix4x4> imageToWorldMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+  fractionalLabelmap->GetImageToWorldMatrix(imageToWorldMatrix);
+  vtkNew<vtkOrientedImageData> singleThreadLabelmap;
+  vtkSMPTools::Initialize(1);
+    {
+    vtkNew<vtkPolyDataToFractionalLabelmapFilter> polyDataToLabelmapFilter;
+    polyDataToLabelmapFilter->SetInputData(spherePolyData);
+    polyDataToLabelmapFilter->SetOutputImageToWorldMatrix(imageToWorldMatrix);
+    polyDataToLabelmapFilter->SetOutputWholeExtent(fractionalLabelmap->GetExtent());
+    polyDataToLabelmapFilter->Update();
+    singleThreadLabelmap->DeepCopy(polyDataToLabelmapFilter->GetOutput());
+    }
+  vtkSMPTools::Initialize();
+  vtkIdType numberOfVoxels = fractionalLabelmap->GetNumberOfPoints();
+  if (singleThreadLabelmap->GetNumberOfPoints() != numberOfVoxels
+    || memcmp(singleThreadLabelmap->GetScalarPointer(), fractionalLabelmap->GetScalarPointer(),
+      numberOfVoxels * fractionalLabelmap->GetScalarSize()) != 0)
+  {
+    std::cerr << __LINE__ << ": Fractional labelmap computed on a single thread differs from the multi-threaded result!" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // More samples than fractional steps are quantized to the same value range
+  vtkNew<vtkPolyDataToFractionalLabelmapFilter> finerSamplingFilter;
+  finerSamplingFilter->SetInputData(spherePolyData);
+  finerSamplingFilter->SetOutputImageToWorldMatrix(imageToWorldMatrix);
+  finerSamplingFilter->SetOutputWholeExtent(fractionalLabelmap->GetExtent());
+  finerSamplingFilter->SetNumberOfOffsets(7);
+  finerSamplingFilter->Update();
+  imageAccumulate->SetInputData(finerSamplingFilter->GetOutput());
+  imageAccumulate->Update();
+  if (imageAccumulate->GetMin()[0] != FRACTIONAL_MIN || imageAccumulate->GetMax()[0] != FRACTIONAL_MAX)
+  {
+    std::cerr << __LINE__ << ": Fractional range with 7 offsets: " << imageAccumulate->GetMin()[0] << " - "
+      << imageAccumulate->GetMax()[0] << " does not match expected range!" << std::endl;
+    return EXIT_FAILURE;
+  }
+  double finerMeanValue = imageAccumulate->GetMean()[0];
+  if (std::abs(finerMeanValue - expectedMeanValue) > 1.0)
+  {
+    std::cerr << __LINE__ << ": Fractional mean with 7 offsets: " << std::fixed << finerMeanValue <<
+      " is too far from the expected value: " << std::fixed << expectedMeanValue <<  "!" << std::endl;
+    return EXIT_FAILURE;
+  }
+
   std::cout << "Closed surface to fractional labelmap conversion test passed." << std::endl;
   return EXIT_SUCCESS;
 }
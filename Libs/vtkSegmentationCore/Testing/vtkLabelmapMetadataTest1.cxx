@@ -0,0 +1,315 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+
+// SegmentationCore includes
+#include "vtkLabelmapMetadata.h"
+#include "vtkOrientedImageData.h"
+#include "vtkOrientedImageDataResample.h"
+#include "vtkSegment.h"
+#include "vtkSegmentation.h"
+#include "vtkSegmentationConverter.h"
+#include "vtkSegmentationModifier.h"
+
+// STD includes
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+void FillBox(vtkImageData* image, const int box[6], double value)
+{
+  for (int k = box[4]; k <= box[5]; ++k)
+    {
+    for (int j = box[2]; j <= box[3]; ++j)
+      {
+      for (int i = box[0]; i <= box[1]; ++i)
+        {
+        image->SetScalarComponentFromDouble(i, j, k, 0, value);
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void CreateImage(vtkOrientedImageData* image, const int extent[6], int scalarType)
+{
+  image->SetExtent(const_cast<int*>(extent));
+  image->SetSpacing(0.5, 1.0, 2.0);
+  image->SetOrigin(10.0, -20.0, 5.0);
+  image->AllocateScalars(scalarType, 1);
+  image->GetPointData()->GetScalars()->Fill(0);
+}
+
+//----------------------------------------------------------------------------
+/// Labelmap with boxes of three labels
+void CreateLabelmap(vtkOrientedImageData* image)
+{
+  int extent[6] = { -5, 34, 0, 24, 2, 21 };
+  CreateImage(image, extent, VTK_SHORT);
+  int box1[6] = { -5, 10, 3, 9, 2, 8 };
+  FillBox(image, box1, 1);
+  int box2[6] = { 8, 20, 5, 15, 6, 14 };
+  FillBox(image, box2, 2);
+  int box3[6] = { 25, 34, 20, 24, 18, 21 };
+  FillBox(image, box3, 300);
+}
+
+//----------------------------------------------------------------------------
+/// Compare incrementally updated metadata to metadata computed by scanning the whole labelmap
+bool VerifyMetadata(vtkOrientedImageData* labelmap, const char* description)
+{
+  vtkLabelmapMetadata* metadata = labelmap->GetCachedLabelmapMetadata();
+  if (!metadata)
+    {
+    std::cerr << description << ": labelmap metadata is expected to be kept up-to-date" << std::endl;
+    return false;
+    }
+  metadata->UpdateLabelExtents(labelmap);
+
+  vtkNew<vtkLabelmapMetadata> expectedMetadata;
+  if (!expectedMetadata->Compute(labelmap))
+    {
+    std::cerr << description << ": failed to compute labelmap metadata" << std::endl;
+    return false;
+    }
+  if (metadata->GetLabels().size() != expectedMetadata->GetLabels().size())
+    {
+    std::cerr << description << ": number of labels mismatch. Expected " << expectedMetadata->GetLabels().size()
+      << ", actual " << metadata->GetLabels().size() << std::endl;
+    return false;
+    }
+  for (const auto& expectedLabel : expectedMetadata->GetLabels())
+    {
+    auto labelIt = metadata->GetLabels().find(expectedLabel.first);
+    if (labelIt == metadata->GetLabels().end()
+      || labelIt->second.NumberOfVoxels != expectedLabel.second.NumberOfVoxels
+      || !std::equal(expectedLabel.second.Extent, expectedLabel.second.Extent + 6, labelIt->second.Extent))
+      {
+      std::cerr << description << ": label " << expectedLabel.first << " mismatch" << std::endl;
+      metadata->Print(std::cerr);
+      expectedMetadata->Print(std::cerr);
+      return false;
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool TestComputeMetadata()
+{
+  vtkNew<vtkOrientedImageData> labelmap;
+  CreateLabelmap(labelmap);
+
+  if (labelmap->GetCachedLabelmapMetadata())
+    {
+    std::cerr << "Labelmap metadata is not expected to be available before it is requested" << std::endl;
+    return false;
+    }
+  vtkLabelmapMetadata* metadata = labelmap->GetLabelmapMetadata();
+  if (!metadata || metadata->GetNumberOfLabels() != 3)
+    {
+    std::cerr << "Labelmap metadata with 3 labels is expected" << std::endl;
+    return false;
+    }
+
+  int expectedLabel2Extent[6] = { 8, 20, 5, 15, 6, 14 };
+  int label2Extent[6] = { 0, -1, 0, -1, 0, -1 };
+  // Box of label 2 overwrites the corner of box of label 1
+  vtkIdType expectedLabel1Voxels = 16 * 7 * 7 - 3 * 5 * 3;
+  if (!metadata->GetLabelExtent(2, label2Extent) || !std::equal(label2Extent, label2Extent + 6, expectedLabel2Extent)
+    || metadata->GetNumberOfVoxels(1) != expectedLabel1Voxels || metadata->GetNumberOfVoxels(300) != 10 * 5 * 4
+    || metadata->IsLabelPresent(3) || metadata->GetMaximumLabelValue() != 300)
+    {
+    std::cerr << "Labelmap metadata mismatch" << std::endl;
+    metadata->Print(std::cerr);
+    return false;
+    }
+
+  int effectiveExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  int expectedEffectiveExtent[6] = { -5, 34, 3, 24, 2, 21 };
+  if (!vtkOrientedImageDataResample::CalculateEffectiveExtent(labelmap, effectiveExtent)
+    || !std::equal(effectiveExtent, effectiveExtent + 6, expectedEffectiveExtent))
+    {
+    std::cerr << "Effective extent mismatch" << std::endl;
+    return false;
+    }
+  int expectedThresholdedEffectiveExtent[6] = { 8, 34, 5, 24, 6, 21 };
+  if (!vtkOrientedImageDataResample::CalculateEffectiveExtent(labelmap, effectiveExtent, 1.0)
+    || !std::equal(effectiveExtent, effectiveExtent + 6, expectedThresholdedEffectiveExtent))
+    {
+    std::cerr << "Effective extent mismatch with threshold" << std::endl;
+    return false;
+    }
+
+  // Intensity images are not labelmaps
+  vtkNew<vtkOrientedImageData> floatImage;
+  int floatExtent[6] = { 0, 9, 0, 9, 0, 9 };
+  CreateImage(floatImage, floatExtent, VTK_FLOAT);
+  if (floatImage->GetLabelmapMetadata())
+    {
+    std::cerr << "Floating-point image is not expected to have labelmap metadata" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool TestIncrementalUpdate()
+{
+  vtkNew<vtkOrientedImageData> labelmap;
+  CreateLabelmap(labelmap);
+  labelmap->GetLabelmapMetadata();
+
+  vtkNew<vtkOrientedImageData> modifier;
+  int modifierExtent[6] = { 0, 15, 0, 12, 0, 10 };
+  CreateImage(modifier, modifierExtent, VTK_UNSIGNED_CHAR);
+  int brushBox[6] = { 2, 12, 4, 10, 4, 9 };
+  FillBox(modifier, brushBox, 1);
+
+  // Paint
+  vtkOrientedImageDataResample::ModifyImage(labelmap, modifier, vtkOrientedImageDataResample::OPERATION_MAXIMUM, nullptr, 0, 0);
+  vtkOrientedImageDataResample::ModifyImage(labelmap, modifier, vtkOrientedImageDataResample::OPERATION_MASKING, nullptr, 0, 5);
+  if (!VerifyMetadata(labelmap, "Paint"))
+    {
+    return false;
+    }
+
+  // Erase, which shrinks the extent of labels
+  int eraseExtent[6] = { -5, 34, 0, 24, 2, 14 };
+  vtkNew<vtkOrientedImageData> eraser;
+  CreateImage(eraser, eraseExtent, VTK_UNSIGNED_CHAR);
+  FillBox(eraser, eraseExtent, 1);
+  vtkOrientedImageDataResample::ModifyImage(labelmap, eraser, vtkOrientedImageDataResample::OPERATION_MASKING, nullptr, 0, 0);
+  if (!VerifyMetadata(labelmap, "Erase"))
+    {
+    return false;
+    }
+  if (labelmap->GetCachedLabelmapMetadata()->GetNumberOfLabels() != 1)
+    {
+    std::cerr << "Only label 300 is expected to remain after erasing" << std::endl;
+    return false;
+    }
+
+  // Merge into a padded output
+  vtkNew<vtkOrientedImageData> outsideModifier;
+  int outsideExtent[6] = { 40, 45, 0, 5, 2, 5 };
+  CreateImage(outsideModifier, outsideExtent, VTK_UNSIGNED_CHAR);
+  FillBox(outsideModifier, outsideExtent, 7);
+  vtkOrientedImageDataResample::MergeImage(labelmap, outsideModifier, labelmap, vtkOrientedImageDataResample::OPERATION_MAXIMUM);
+  if (!VerifyMetadata(labelmap, "Merge"))
+    {
+    return false;
+    }
+
+  // Modification by other means is detected
+  int externalBox[6] = { 0, 1, 0, 1, 2, 3 };
+  FillBox(labelmap, externalBox, 9);
+  labelmap->Modified();
+  if (labelmap->GetCachedLabelmapMetadata())
+    {
+    std::cerr << "Labelmap metadata is expected to be invalidated by external modification" << std::endl;
+    return false;
+    }
+  vtkLabelmapMetadata* metadata = labelmap->GetLabelmapMetadata();
+  if (!metadata || !metadata->IsLabelPresent(9) || metadata->GetNumberOfVoxels(9) != 8)
+    {
+    std::cerr << "Labelmap metadata is expected to be recomputed after external modification" << std::endl;
+    return false;
+    }
+
+  // Copies keep the metadata
+  vtkNew<vtkOrientedImageData> labelmapCopy;
+  labelmapCopy->DeepCopy(labelmap);
+  if (!VerifyMetadata(labelmapCopy, "DeepCopy"))
+    {
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool TestSegmentationQueries()
+{
+  vtkNew<vtkSegmentation> segmentation;
+  segmentation->SetMasterRepresentationName(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName());
+  vtkNew<vtkOrientedImageData> labelmap;
+  CreateLabelmap(labelmap);
+  vtkNew<vtkSegment> segment;
+  segment->AddRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName(), labelmap);
+  segment->SetLabelValue(1);
+  segmentation->AddSegment(segment, "Segment_1");
+
+  if (segmentation->GetUniqueLabelValueForSharedLabelmap(labelmap) != 301)
+    {
+    std::cerr << "Unexpected unique label value" << std::endl;
+    return false;
+    }
+
+  // Segment modification keeps the metadata up-to-date, including cropping to the effective extent
+  vtkNew<vtkOrientedImageData> modifier;
+  int modifierExtent[6] = { 0, 15, 0, 12, 0, 10 };
+  CreateImage(modifier, modifierExtent, VTK_UNSIGNED_CHAR);
+  int brushBox[6] = { 2, 12, 4, 10, 4, 9 };
+  FillBox(modifier, brushBox, 1);
+  vtkSegmentationModifier::ModifyBinaryLabelmap(modifier, segmentation, "Segment_1", vtkSegmentationModifier::MODE_MERGE_MAX);
+  vtkOrientedImageData* segmentLabelmap = vtkOrientedImageData::SafeDownCast(
+    segment->GetRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+  if (!VerifyMetadata(segmentLabelmap, "Segment modification"))
+    {
+    return false;
+    }
+
+  std::vector<int> labelValues;
+  vtkOrientedImageDataResample::GetLabelValuesInMask(labelValues, segmentLabelmap, modifier);
+  if (labelValues.size() != 2 || labelValues[0] != 1 || labelValues[1] != 2)
+    {
+    std::cerr << "Labels 1 and 2 are expected in the mask" << std::endl;
+    return false;
+    }
+
+  vtkNew<vtkOrientedImageData> emptyRegionMask;
+  int emptyRegionExtent[6] = { 25, 34, 0, 4, 2, 5 };
+  CreateImage(emptyRegionMask, emptyRegionExtent, VTK_UNSIGNED_CHAR);
+  FillBox(emptyRegionMask, emptyRegionExtent, 1);
+  if (vtkOrientedImageDataResample::IsLabelInMask(segmentLabelmap, emptyRegionMask))
+    {
+    std::cerr << "No labels are expected in the mask" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkLabelmapMetadataTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  if (!TestComputeMetadata() || !TestIncrementalUpdate() || !TestSegmentationQueries())
+    {
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Labelmap metadata test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,409 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkFeatureEdges.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+
+// SegmentationCore includes
+#include "vtkBinaryLabelmapToClosedSurfaceConversionRule.h"
+#include "vtkMultiLabelSurfaceNets.h"
+#include "vtkOrientedImageData.h"
+#include "vtkSegmentation.h"
+#include "vtkSegmentationModifier.h"
+
+// STD includes
+#include <iostream>
+#include <map>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+void FillBox(vtkImageData* image, int box[6], unsigned char labelValue)
+{
+  for (int k = box[4]; k <= box[5]; ++k)
+    {
+    for (int j = box[2]; j <= box[3]; ++j)
+      {
+      for (int i = box[0]; i <= box[1]; ++i)
+        {
+        *static_cast<unsigned char*>(image->GetScalarPointer(i, j, k)) = labelValue;
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+/// Labelmap with three 3x3x3 boxes. Label 1 and 2 are touching, label 3 is separate
+/// and is placed at the border of the image.
+void CreateLabelmap(vtkImageData* image)
+{
+  image->SetExtent(0, 11, 0, 9, 0, 9);
+  image->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  image->GetPointData()->GetScalars()->Fill(0);
+  int box1[6] = { 2, 4, 2, 4, 2, 4 };
+  FillBox(image, box1, 1);
+  int box2[6] = { 5, 7, 2, 4, 2, 4 };
+  FillBox(image, box2, 2);
+  int box3[6] = { 9, 11, 6, 8, 7, 9 };
+  FillBox(image, box3, 3);
+}
+
+//----------------------------------------------------------------------------
+bool IsClosedManifold(vtkPolyData* surface)
+{
+  vtkNew<vtkFeatureEdges> featureEdges;
+  featureEdges->SetInputData(surface);
+  featureEdges->BoundaryEdgesOn();
+  featureEdges->NonManifoldEdgesOn();
+  featureEdges->FeatureEdgesOff();
+  featureEdges->ManifoldEdgesOff();
+  featureEdges->Update();
+  return featureEdges->GetOutput()->GetNumberOfCells() == 0;
+}
+
+//----------------------------------------------------------------------------
+bool CheckBox(vtkPolyData* surface, int labelValue, const double expectedBounds[6], double tolerance)
+{
+  if (!surface)
+    {
+    std::cerr << "Missing surface for label " << labelValue << std::endl;
+    return false;
+    }
+  // Each of the 6 sides of a 3x3x3 box consists of 9 quads, split into 2 triangles each
+  if (surface->GetNumberOfPolys() != 108)
+    {
+    std::cerr << "Unexpected number of triangles for label " << labelValue << ": " << surface->GetNumberOfPolys() << std::endl;
+    return false;
+    }
+  // Vertices are placed in 2x2x2 neighborhoods that are on the boundary of the box
+  if (surface->GetNumberOfPoints() != 4 * 4 * 4 - 2 * 2 * 2)
+    {
+    std::cerr << "Unexpected number of points for label " << labelValue << ": " << surface->GetNumberOfPoints() << std::endl;
+    return false;
+    }
+  if (!IsClosedManifold(surface))
+    {
+    std::cerr << "Surface of label " << labelValue << " is not closed" << std::endl;
+    return false;
+    }
+  double bounds[6] = { 0.0, -1.0, 0.0, -1.0, 0.0, -1.0 };
+  surface->GetBounds(bounds);
+  for (int i = 0; i < 6; ++i)
+    {
+    if (fabs(bounds[i] - expectedBounds[i]) > tolerance)
+      {
+      std::cerr << "Unexpected bounds for label " << labelValue << ": "
+        << bounds[0] << ", " << bounds[1] << ", " << bounds[2] << ", "
+        << bounds[3] << ", " << bounds[4] << ", " << bounds[5] << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+/// Check that the two surface extractors have exactly the same output
+bool CompareOutputs(vtkMultiLabelSurfaceNets* surfaceNets1, vtkMultiLabelSurfaceNets* surfaceNets2)
+{
+  if (surfaceNets1->GetOutputLabelValues() != surfaceNets2->GetOutputLabelValues())
+    {
+    std::cerr << "Output labels mismatch" << std::endl;
+    return false;
+    }
+  for (int labelValue : surfaceNets1->GetOutputLabelValues())
+    {
+    vtkPolyData* surface1 = surfaceNets1->GetOutput(labelValue);
+    vtkPolyData* surface2 = surfaceNets2->GetOutput(labelValue);
+    if (surface1->GetNumberOfPoints() != surface2->GetNumberOfPoints()
+      || surface1->GetNumberOfPolys() != surface2->GetNumberOfPolys())
+      {
+      std::cerr << "Surface size mismatch for label " << labelValue << ": "
+        << surface1->GetNumberOfPoints() << " points, " << surface1->GetNumberOfPolys() << " polys != "
+        << surface2->GetNumberOfPoints() << " points, " << surface2->GetNumberOfPolys() << " polys" << std::endl;
+      return false;
+      }
+    for (vtkIdType pointId = 0; pointId < surface1->GetNumberOfPoints(); ++pointId)
+      {
+      double* point1 = surface1->GetPoint(pointId);
+      double point2[3] = { 0.0, 0.0, 0.0 };
+      surface2->GetPoint(pointId, point2);
+      if (point1[0] != point2[0] || point1[1] != point2[1] || point1[2] != point2[2])
+        {
+        std::cerr << "Point " << pointId << " mismatch for label " << labelValue << std::endl;
+        return false;
+        }
+      }
+    if (!IsClosedManifold(surface1))
+      {
+      std::cerr << "Surface of label " << labelValue << " is not closed" << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+/// Update surfaces after modifications of the labelmap and compare the result with complete extraction
+bool TestIncrementalUpdate()
+{
+  vtkNew<vtkImageData> labelmap;
+  labelmap->SetExtent(-5, 34, 0, 24, 0, 19);
+  labelmap->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  labelmap->GetPointData()->GetScalars()->Fill(0);
+  int box1[6] = { -2, 12, 3, 15, 2, 12 };
+  FillBox(labelmap, box1, 1);
+  int box2[6] = { 13, 25, 5, 20, 4, 15 };
+  FillBox(labelmap, box2, 2);
+
+  vtkNew<vtkMultiLabelSurfaceNets> incrementalSurfaceNets;
+  incrementalSurfaceNets->SetInputLabelmap(labelmap);
+  incrementalSurfaceNets->SetNumberOfSmoothingIterations(3);
+  incrementalSurfaceNets->SetBrickSize(4);
+  if (!incrementalSurfaceNets->Update())
+    {
+    std::cerr << "Surface extraction failed" << std::endl;
+    return false;
+    }
+  vtkPolyData* unmodifiedSurface = incrementalSurfaceNets->GetOutput(1);
+
+  // Paint a new label, extend label 2 and erase part of it
+  int modifications[3][6] = { { 28, 32, 10, 14, 8, 12 }, { 26, 28, 10, 12, 6, 8 }, { 22, 24, 14, 20, 10, 15 } };
+  unsigned char modificationLabels[3] = { 3, 2, 0 };
+  for (int modificationIndex = 0; modificationIndex < 3; ++modificationIndex)
+    {
+    FillBox(labelmap, modifications[modificationIndex], modificationLabels[modificationIndex]);
+    if (!incrementalSurfaceNets->UpdateModifiedExtent(modifications[modificationIndex]))
+      {
+      std::cerr << "Incremental update failed" << std::endl;
+      return false;
+      }
+
+    vtkNew<vtkMultiLabelSurfaceNets> surfaceNets;
+    surfaceNets->SetInputLabelmap(labelmap);
+    surfaceNets->SetNumberOfSmoothingIterations(3);
+    surfaceNets->SetBrickSize(4);
+    if (!surfaceNets->Update() || !CompareOutputs(incrementalSurfaceNets, surfaceNets))
+      {
+      std::cerr << "Incremental update result differs after modification " << modificationIndex << std::endl;
+      return false;
+      }
+    }
+
+  // Surface of label 1 is far from the modifications, it must not be replaced
+  if (incrementalSurfaceNets->GetOutput(1) != unmodifiedSurface)
+    {
+    std::cerr << "Surface of unmodified label was updated" << std::endl;
+    return false;
+    }
+
+  // Changing settings requires complete update
+  incrementalSurfaceNets->SetNumberOfSmoothingIterations(4);
+  if (incrementalSurfaceNets->UpdateModifiedExtent(modifications[0]))
+    {
+    std::cerr << "Incremental update succeeded with modified settings" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+/// Check that the segmentation modifier records the modified extent of the segment labelmap
+bool TestModifiedLabelmapExtent()
+{
+  vtkNew<vtkSegmentation> segmentation;
+  segmentation->SetMasterRepresentationName(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName());
+  vtkNew<vtkSegment> segment;
+  vtkNew<vtkOrientedImageData> segmentLabelmap;
+  CreateLabelmap(segmentLabelmap);
+  segment->AddRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName(), segmentLabelmap);
+  segmentation->AddSegment(segment, "Segment_1");
+  vtkOrientedImageData* labelmap = vtkOrientedImageData::SafeDownCast(
+    segmentation->GetSegment("Segment_1")->GetRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+  vtkMTimeType initialMTime = labelmap->GetMTime();
+
+  vtkNew<vtkOrientedImageData> modifierLabelmap;
+  modifierLabelmap->SetExtent(0, 11, 0, 9, 0, 9);
+  modifierLabelmap->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  modifierLabelmap->GetPointData()->GetScalars()->Fill(0);
+  int paintExtent[6] = { 1, 2, 6, 7, 1, 3 };
+  FillBox(modifierLabelmap, paintExtent, 1);
+  if (!vtkSegmentationModifier::ModifyBinaryLabelmap(modifierLabelmap, segmentation, "Segment_1",
+    vtkSegmentationModifier::MODE_MERGE_MAX, paintExtent))
+    {
+    std::cerr << "Failed to modify segment" << std::endl;
+    return false;
+    }
+
+  int modifiedExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  if (!segmentation->GetModifiedLabelmapExtent(labelmap, initialMTime, modifiedExtent))
+    {
+    std::cerr << "Modified extent of the labelmap is not recorded" << std::endl;
+    return false;
+    }
+  for (int i = 0; i < 6; ++i)
+    {
+    if (modifiedExtent[i] != paintExtent[i])
+      {
+      std::cerr << "Unexpected modified extent: " << modifiedExtent[0] << ", " << modifiedExtent[1] << ", "
+        << modifiedExtent[2] << ", " << modifiedExtent[3] << ", " << modifiedExtent[4] << ", " << modifiedExtent[5] << std::endl;
+      return false;
+      }
+    }
+
+  // Modification that is not recorded makes the modified region unknown
+  labelmap->Modified();
+  if (segmentation->GetModifiedLabelmapExtent(labelmap, initialMTime, modifiedExtent))
+    {
+    std::cerr << "Modified extent is reported after unrecorded modification" << std::endl;
+    return false;
+    }
+
+  // Records are removed when the labelmap is no longer a master representation
+  vtkMTimeType mtimeBeforeModification = labelmap->GetMTime();
+  labelmap->Modified();
+  segmentation->AddModifiedLabelmapExtent(labelmap, paintExtent, mtimeBeforeModification);
+  if (!segmentation->GetModifiedLabelmapExtent(labelmap, mtimeBeforeModification, modifiedExtent))
+    {
+    std::cerr << "Modified extent of the labelmap is not recorded" << std::endl;
+    return false;
+    }
+  segmentation->RemoveSegment("Segment_1");
+  if (segmentation->GetModifiedLabelmapExtent(labelmap, mtimeBeforeModification, modifiedExtent))
+    {
+    std::cerr << "Modified extent is reported for a labelmap that is not in the segmentation" << std::endl;
+    return false;
+    }
+
+  // Recording modification of a labelmap must not access a deleted labelmap that had records
+  vtkMTimeType deletedLabelmapMTime = 0;
+  {
+  vtkNew<vtkSegment> segment2;
+  vtkSmartPointer<vtkOrientedImageData> segment2Labelmap = vtkSmartPointer<vtkOrientedImageData>::New();
+  CreateLabelmap(segment2Labelmap);
+  segment2->AddRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName(), segment2Labelmap);
+  segmentation->AddSegment(segment2, "Segment_2");
+  deletedLabelmapMTime = segment2Labelmap->GetMTime();
+  segment2Labelmap->Modified();
+  segmentation->AddModifiedLabelmapExtent(segment2Labelmap, paintExtent, deletedLabelmapMTime);
+  }
+  segmentation->RemoveSegment("Segment_2");
+  vtkNew<vtkSegment> segment3;
+  vtkNew<vtkOrientedImageData> segment3Labelmap;
+  CreateLabelmap(segment3Labelmap);
+  segment3->AddRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName(), segment3Labelmap);
+  segmentation->AddSegment(segment3, "Segment_3");
+  mtimeBeforeModification = segment3Labelmap->GetMTime();
+  segment3Labelmap->Modified();
+  segmentation->AddModifiedLabelmapExtent(segment3Labelmap, paintExtent, mtimeBeforeModification);
+  if (!segmentation->GetModifiedLabelmapExtent(segment3Labelmap, mtimeBeforeModification, modifiedExtent))
+    {
+    std::cerr << "Modified extent of the labelmap is not recorded" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkMultiLabelSurfaceNetsTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  vtkNew<vtkImageData> labelmap;
+  CreateLabelmap(labelmap);
+
+  const double expectedBounds1[6] = { 1.5, 4.5, 1.5, 4.5, 1.5, 4.5 };
+  const double expectedBounds2[6] = { 4.5, 7.5, 1.5, 4.5, 1.5, 4.5 };
+  const double expectedBounds3[6] = { 8.5, 11.5, 5.5, 8.5, 6.5, 9.5 };
+
+  // Extract all labels without smoothing
+  vtkNew<vtkMultiLabelSurfaceNets> surfaceNets;
+  surfaceNets->SetInputLabelmap(labelmap);
+  surfaceNets->SetNumberOfSmoothingIterations(0);
+  if (!surfaceNets->Update())
+    {
+    std::cerr << "Surface extraction failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (surfaceNets->GetOutputLabelValues() != std::vector<int>({ 1, 2, 3 }))
+    {
+    std::cerr << "Unexpected output labels" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (!CheckBox(surfaceNets->GetOutput(1), 1, expectedBounds1, 1e-6)
+    || !CheckBox(surfaceNets->GetOutput(2), 2, expectedBounds2, 1e-6)
+    || !CheckBox(surfaceNets->GetOutput(3), 3, expectedBounds3, 1e-6))
+    {
+    return EXIT_FAILURE;
+    }
+  if (surfaceNets->GetOutput(4) != nullptr)
+    {
+    std::cerr << "Unexpected surface for non-existing label" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Smoothing keeps vertices within the constraint distance
+  surfaceNets->SetNumberOfSmoothingIterations(20);
+  if (!surfaceNets->Update()
+    || !CheckBox(surfaceNets->GetOutput(1), 1, expectedBounds1, surfaceNets->GetConstraintDistance() + 1e-6)
+    || !CheckBox(surfaceNets->GetOutput(2), 2, expectedBounds2, surfaceNets->GetConstraintDistance() + 1e-6))
+    {
+    std::cerr << "Smoothed surface extraction failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Other labels are treated as background
+  surfaceNets->SetLabelValues(std::vector<int>({ 2 }));
+  if (!surfaceNets->Update() || surfaceNets->GetOutputLabelValues() != std::vector<int>({ 2 })
+    || !CheckBox(surfaceNets->GetOutput(2), 2, expectedBounds2, surfaceNets->GetConstraintDistance() + 1e-6))
+    {
+    std::cerr << "Selected label surface extraction failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Conversion rule creates surfaces of all labels in world coordinate system
+  vtkNew<vtkOrientedImageData> orientedLabelmap;
+  orientedLabelmap->ShallowCopy(labelmap);
+  orientedLabelmap->SetSpacing(2.0, 2.0, 2.0);
+  orientedLabelmap->SetOrigin(10.0, 0.0, 0.0);
+  vtkNew<vtkBinaryLabelmapToClosedSurfaceConversionRule> rule;
+  rule->SetConversionParameter(vtkBinaryLabelmapToClosedSurfaceConversionRule::GetSmoothingFactorParameterName(), "0");
+  std::map<int, vtkSmartPointer<vtkPolyData> > surfaces;
+  if (!rule->CreateMultiLabelClosedSurfaces(orientedLabelmap, surfaces) || surfaces.size() != 3)
+    {
+    std::cerr << "Multi-label closed surface creation failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const double expectedWorldBounds1[6] = { 13.0, 19.0, 3.0, 9.0, 3.0, 9.0 };
+  if (!CheckBox(surfaces[1], 1, expectedWorldBounds1, 1e-6))
+    {
+    return EXIT_FAILURE;
+    }
+
+  if (!TestIncrementalUpdate() || !TestModifiedLabelmapExtent())
+    {
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Multi-label surface nets test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
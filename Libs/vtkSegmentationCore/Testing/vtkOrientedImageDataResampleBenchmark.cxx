@@ -0,0 +1,291 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// SegmentationCore includes
+#include "vtkOrientedImageData.h"
+#include "vtkOrientedImageDataResample.h"
+#include "vtkSegment.h"
+#include "vtkSegmentation.h"
+#include "vtkSegmentationConverter.h"
+#include "vtkSegmentationModifier.h"
+
+// VTK includes
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Benchmark of labelmap operations that segment editor effects perform at the end of each edit.
+// Results of the vtkOrientedImageDataResample kernels are compared to a straightforward voxel loop.
+//
+// Usage: vtkOrientedImageDataResampleBenchmark [volumeSize]
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+void CreateLabelmap(vtkOrientedImageData* labelmap, int scalarType, const int extent[6], const int boxExtent[6], double value)
+{
+  labelmap->SetExtent(const_cast<int*>(extent));
+  labelmap->SetSpacing(0.5, 0.5, 1.0);
+  labelmap->SetOrigin(10.0, -20.0, 5.0);
+  labelmap->AllocateScalars(scalarType, 1);
+  labelmap->GetPointData()->GetScalars()->Fill(0);
+  if (boxExtent)
+    {
+    vtkOrientedImageDataResample::FillImage(labelmap, value, boxExtent);
+    }
+}
+
+//----------------------------------------------------------------------------
+// Reference implementation: voxel by voxel, without any restriction of the processed region
+template <class T>
+void ReferenceModifyImage(vtkOrientedImageData* image, vtkOrientedImageData* modifier, int operation, double fillValue)
+{
+  int* extent = image->GetExtent();
+  int* modifierExtent = modifier->GetExtent();
+  for (int k = extent[4]; k <= extent[5]; ++k)
+    {
+    for (int j = extent[2]; j <= extent[3]; ++j)
+      {
+      for (int i = extent[0]; i <= extent[1]; ++i)
+        {
+        if (i < modifierExtent[0] || i > modifierExtent[1] || j < modifierExtent[2] || j > modifierExtent[3]
+          || k < modifierExtent[4] || k > modifierExtent[5])
+          {
+          continue;
+          }
+        T* value = static_cast<T*>(image->GetScalarPointer(i, j, k));
+        T modifierValue = static_cast<T>(modifier->GetScalarComponentAsDouble(i, j, k, 0));
+        if (operation == vtkOrientedImageDataResample::OPERATION_MAXIMUM)
+          {
+          *value = std::max(*value, modifierValue);
+          }
+        else if (operation == vtkOrientedImageDataResample::OPERATION_MINIMUM)
+          {
+          *value = std::min(*value, modifierValue);
+          }
+        else if (modifierValue > 0)
+          {
+          *value = static_cast<T>(fillValue);
+          }
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+bool IsEqualImage(vtkOrientedImageData* image1, vtkOrientedImageData* image2)
+{
+  int* extent1 = image1->GetExtent();
+  int* extent2 = image2->GetExtent();
+  if (!std::equal(extent1, extent1 + 6, extent2) || image1->GetScalarType() != image2->GetScalarType())
+    {
+    std::cerr << "Image extent or scalar type mismatch" << std::endl;
+    return false;
+    }
+  size_t size = static_cast<size_t>(image1->GetNumberOfPoints()) * image1->GetScalarSize();
+  if (memcmp(image1->GetScalarPointer(), image2->GetScalarPointer(), size) != 0)
+    {
+    std::cerr << "Image content mismatch" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+/// Apply the modifiers on a copy of the base image, both with ModifyImage and the reference implementation.
+bool BenchmarkModifyImage(const std::string& name, vtkOrientedImageData* baseImage,
+  const std::vector<vtkSmartPointer<vtkOrientedImageData> >& modifiers, int operation, double fillValue)
+{
+  vtkNew<vtkOrientedImageData> image;
+  image->DeepCopy(baseImage);
+  double startTime = vtkTimerLog::GetUniversalTime();
+  for (vtkOrientedImageData* modifier : modifiers)
+    {
+    vtkOrientedImageDataResample::ModifyImage(image, modifier, operation, nullptr, 0.0, fillValue);
+    }
+  double modifyTime = vtkTimerLog::GetUniversalTime() - startTime;
+
+  vtkNew<vtkOrientedImageData> referenceImage;
+  referenceImage->DeepCopy(baseImage);
+  startTime = vtkTimerLog::GetUniversalTime();
+  for (vtkOrientedImageData* modifier : modifiers)
+    {
+    switch (referenceImage->GetScalarType())
+      {
+      vtkTemplateMacro(ReferenceModifyImage<VTK_TT>(referenceImage, modifier, operation, fillValue));
+      }
+    }
+  double referenceTime = vtkTimerLog::GetUniversalTime() - startTime;
+
+  std::cout << "  " << name << " (" << baseImage->GetScalarTypeAsString() << "): "
+    << modifyTime * 1000.0 << "ms, reference: " << referenceTime * 1000.0 << "ms, speedup: "
+    << (modifyTime > 0.0 ? referenceTime / modifyTime : 0.0) << "x" << std::endl;
+  return IsEqualImage(image, referenceImage);
+}
+
+//----------------------------------------------------------------------------
+bool RunModifyImageBenchmarks(int volumeSize, int scalarType)
+{
+  int extent[6] = { 0, volumeSize - 1, 0, volumeSize - 1, 0, volumeSize - 1 };
+  int boxExtent[6] = { volumeSize / 4, volumeSize / 2, volumeSize / 4, volumeSize / 2, volumeSize / 4, volumeSize / 2 };
+  vtkNew<vtkOrientedImageData> baseImage;
+  CreateLabelmap(baseImage, scalarType, extent, boxExtent, 1);
+
+  // Paint and erase strokes: a sequence of small brush-sized boxes along a line
+  std::vector<vtkSmartPointer<vtkOrientedImageData> > brushModifiers;
+  int brushRadius = std::max(2, volumeSize / 32);
+  for (int position = brushRadius; position < volumeSize - brushRadius; position += brushRadius)
+    {
+    int brushExtent[6] = { position - brushRadius, position + brushRadius, volumeSize / 3 - brushRadius, volumeSize / 3 + brushRadius,
+      volumeSize / 2 - brushRadius, volumeSize / 2 + brushRadius };
+    vtkSmartPointer<vtkOrientedImageData> modifier = vtkSmartPointer<vtkOrientedImageData>::New();
+    CreateLabelmap(modifier, VTK_UNSIGNED_CHAR, brushExtent, brushExtent, 1);
+    brushModifiers.push_back(modifier);
+    }
+
+  // Threshold, islands, and logical operations: modifier covering the whole volume
+  std::vector<vtkSmartPointer<vtkOrientedImageData> > volumeModifiers;
+  vtkSmartPointer<vtkOrientedImageData> volumeModifier = vtkSmartPointer<vtkOrientedImageData>::New();
+  int thresholdExtent[6] = { 0, volumeSize - 1, volumeSize / 3, 2 * volumeSize / 3, 0, volumeSize / 2 };
+  CreateLabelmap(volumeModifier, VTK_UNSIGNED_CHAR, extent, thresholdExtent, 1);
+  volumeModifiers.push_back(volumeModifier);
+
+  return BenchmarkModifyImage("Paint stroke (maximum)", baseImage, brushModifiers, vtkOrientedImageDataResample::OPERATION_MAXIMUM, 1)
+    && BenchmarkModifyImage("Erase stroke (masking)", baseImage, brushModifiers, vtkOrientedImageDataResample::OPERATION_MASKING, 0)
+    && BenchmarkModifyImage("Threshold (maximum)", baseImage, volumeModifiers, vtkOrientedImageDataResample::OPERATION_MAXIMUM, 1)
+    && BenchmarkModifyImage("Intersect (minimum)", baseImage, volumeModifiers, vtkOrientedImageDataResample::OPERATION_MINIMUM, 1)
+    && BenchmarkModifyImage("Fill (masking)", baseImage, volumeModifiers, vtkOrientedImageDataResample::OPERATION_MASKING, 3);
+}
+
+//----------------------------------------------------------------------------
+/// Add a small region to a segment from a modifier that has the extent of the whole volume,
+/// which is typical for effects that compute their result on the whole source volume.
+bool RunSetSegmentBenchmark(int volumeSize)
+{
+  int extent[6] = { 0, volumeSize - 1, 0, volumeSize - 1, 0, volumeSize - 1 };
+  int segmentExtent[6] = { 10, 20, 10, 20, 10, 20 };
+  int modifierBoxExtent[6] = { volumeSize / 2, volumeSize / 2 + 10, volumeSize / 2, volumeSize / 2 + 10, 5, 15 };
+
+  vtkNew<vtkOrientedImageData> segmentLabelmap;
+  CreateLabelmap(segmentLabelmap, VTK_UNSIGNED_CHAR, segmentExtent, segmentExtent, 1);
+  vtkNew<vtkSegment> segment;
+  segment->AddRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName(), segmentLabelmap);
+  vtkNew<vtkSegmentation> segmentation;
+  segmentation->SetMasterRepresentationName(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName());
+  segmentation->AddSegment(segment, "Segment_1");
+
+  vtkNew<vtkOrientedImageData> modifier;
+  CreateLabelmap(modifier, VTK_UNSIGNED_CHAR, extent, modifierBoxExtent, 1);
+
+  double startTime = vtkTimerLog::GetUniversalTime();
+  if (!vtkSegmentationModifier::ModifyBinaryLabelmap(modifier, segmentation, "Segment_1", vtkSegmentationModifier::MODE_MERGE_MAX))
+    {
+    std::cerr << "Failed to modify segment" << std::endl;
+    return false;
+    }
+  double elapsedTime = vtkTimerLog::GetUniversalTime() - startTime;
+  std::cout << "  Add region to segment from whole-volume modifier: " << elapsedTime * 1000.0 << "ms" << std::endl;
+
+  // Result contains the original segment and the modifier region
+  int expectedExtent[6] = { 10, modifierBoxExtent[1], 10, modifierBoxExtent[3], 5, 20 };
+  vtkOrientedImageData* resultLabelmap = vtkOrientedImageData::SafeDownCast(
+    segment->GetRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+  int* resultExtent = resultLabelmap->GetExtent();
+  if (!std::equal(expectedExtent, expectedExtent + 6, resultExtent))
+    {
+    std::cerr << "Unexpected segment extent: " << resultExtent[0] << ", " << resultExtent[1] << ", " << resultExtent[2] << ", "
+      << resultExtent[3] << ", " << resultExtent[4] << ", " << resultExtent[5] << std::endl;
+    return false;
+    }
+  if (resultLabelmap->GetScalarComponentAsDouble(15, 15, 15, 0) != 1.0
+    || resultLabelmap->GetScalarComponentAsDouble(modifierBoxExtent[0], modifierBoxExtent[2], 10, 0) != 1.0
+    || resultLabelmap->GetScalarComponentAsDouble(modifierBoxExtent[0] - 1, modifierBoxExtent[2], 10, 0) != 0.0)
+    {
+    std::cerr << "Unexpected segment content" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool RunDoGeometriesMatchBenchmark()
+{
+  vtkNew<vtkOrientedImageData> image1;
+  vtkNew<vtkOrientedImageData> image2;
+  int extent[6] = { 0, 9, 0, 9, 0, 9 };
+  CreateLabelmap(image1, VTK_UNSIGNED_CHAR, extent, nullptr, 0);
+  CreateLabelmap(image2, VTK_UNSIGNED_CHAR, extent, nullptr, 0);
+
+  const int numberOfComparisons = 100000;
+  int numberOfMatches = 0;
+  double startTime = vtkTimerLog::GetUniversalTime();
+  for (int comparisonIndex = 0; comparisonIndex < numberOfComparisons; ++comparisonIndex)
+    {
+    if (vtkOrientedImageDataResample::DoGeometriesMatch(image1, image2))
+      {
+      ++numberOfMatches;
+      }
+    }
+  double elapsedTime = vtkTimerLog::GetUniversalTime() - startTime;
+  std::cout << "  " << numberOfComparisons << " geometry comparisons: " << elapsedTime * 1000.0 << "ms" << std::endl;
+  if (numberOfMatches != numberOfComparisons)
+    {
+    std::cerr << "Geometries are expected to match" << std::endl;
+    return false;
+    }
+  image2->SetSpacing(0.5, 0.5, 1.1);
+  if (vtkOrientedImageDataResample::DoGeometriesMatch(image1, image2))
+    {
+    std::cerr << "Geometries are not expected to match" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkOrientedImageDataResampleBenchmark(int argc, char* argv[])
+{
+  int volumeSize = (argc > 1 ? atoi(argv[1]) : 128);
+  std::cout << "Volume size: " << volumeSize << ", threads: " << vtkSMPTools::GetEstimatedNumberOfThreads() << std::endl;
+
+  const int scalarTypes[3] = { VTK_UNSIGNED_CHAR, VTK_SHORT, VTK_INT };
+  for (int scalarType : scalarTypes)
+    {
+    if (!RunModifyImageBenchmarks(volumeSize, scalarType))
+      {
+      return EXIT_FAILURE;
+      }
+    }
+  if (!RunSetSegmentBenchmark(volumeSize) || !RunDoGeometriesMatchBenchmark())
+    {
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Benchmark completed" << std::endl;
+  return EXIT_SUCCESS;
+}
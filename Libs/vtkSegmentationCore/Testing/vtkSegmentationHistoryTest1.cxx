@@ -28,6 +28,11 @@
 #include <vtkSphereSource.h>
 #include <vtkVersion.h>
 
+// STD includes
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
 // Get CHECK_INT from vtkAddonTestingMacros.h to avoid dependency on vtkAddon
 namespace
 {
@@ -86,6 +91,252 @@ int GetVoxelCount(vtkImageData* labelmap, int labelValue)
   return accumulate->GetVoxelCount();
 }
 
+//----------------------------------------------------------------------------
+void PaintBox(vtkOrientedImageData* labelmap, int extent[6], unsigned char value)
+{
+  for (int k = extent[4]; k <= extent[5]; ++k)
+    {
+    for (int j = extent[2]; j <= extent[3]; ++j)
+      {
+      unsigned char* voxel = static_cast<unsigned char*>(labelmap->GetScalarPointer(extent[0], j, k));
+      memset(voxel, value, extent[1] - extent[0] + 1);
+      }
+    }
+  labelmap->Modified();
+}
+
+//----------------------------------------------------------------------------
+bool IsEqualLabelmap(vtkOrientedImageData* labelmap, const std::vector<unsigned char>& expectedVoxels)
+{
+  if (!labelmap || static_cast<size_t>(labelmap->GetNumberOfPoints()) != expectedVoxels.size())
+    {
+    return false;
+    }
+  return memcmp(labelmap->GetScalarPointer(), expectedVoxels.data(), expectedVoxels.size()) == 0;
+}
+
+//----------------------------------------------------------------------------
+int TestCompressedStates()
+{
+  vtkNew<vtkOrientedImageData> labelmap;
+  labelmap->SetExtent(0, 255, 0, 255, 0, 127);
+  labelmap->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  labelmap->GetPointData()->GetScalars()->Fill(0);
+  int initialExtent[6] = { 20, 200, 20, 200, 10, 100 };
+  PaintBox(labelmap, initialExtent, 1);
+
+  vtkNew<vtkSegment> segment;
+  segment->SetLabelValue(1);
+  segment->AddRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName(), labelmap);
+  vtkNew<vtkSegmentation> segmentation;
+  segmentation->SetMasterRepresentationName(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName());
+  segmentation->AddSegment(segment, "Segment_1");
+
+  vtkNew<vtkSegmentationHistory> history;
+  history->SetMaximumNumberOfStates(20);
+  history->SetSegmentation(segmentation);
+
+  // Save a state after each small stroke
+  const int numberOfStrokes = 8;
+  size_t labelmapSize = static_cast<size_t>(labelmap->GetNumberOfPoints());
+  std::vector<std::vector<unsigned char> > expectedVoxels;
+  for (int stroke = 0; stroke <= numberOfStrokes; ++stroke)
+    {
+    if (stroke > 0)
+      {
+      int strokeExtent[6] = { 10 * stroke, 10 * stroke + 5, 30, 40, 5 * stroke, 5 * stroke + 3 };
+      PaintBox(labelmap, strokeExtent, static_cast<unsigned char>(stroke + 1));
+      }
+    history->SaveState();
+    unsigned char* voxels = static_cast<unsigned char*>(labelmap->GetScalarPointer());
+    expectedVoxels.emplace_back(voxels, voxels + labelmapSize);
+    }
+  CHECK_INT(history->GetNumberOfStates(), numberOfStrokes + 1);
+
+  // Only the most recent state is stored in full
+  vtkTypeInt64 memorySize = history->GetMemorySize();
+  if (memorySize > static_cast<vtkTypeInt64>(2 * labelmapSize))
+    {
+    std::cerr << __LINE__ << ": Memory size of " << numberOfStrokes + 1 << " states is " << memorySize
+      << " bytes, expected less than twice the labelmap size (" << labelmapSize << " bytes)" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Undo all strokes
+  for (int stroke = numberOfStrokes - 1; stroke >= 0; --stroke)
+    {
+    history->RestorePreviousState();
+    vtkOrientedImageData* restoredLabelmap = vtkOrientedImageData::SafeDownCast(
+      segmentation->GetSegment("Segment_1")->GetRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+    if (!IsEqualLabelmap(restoredLabelmap, expectedVoxels[stroke]))
+      {
+      std::cerr << __LINE__ << ": Undo of stroke " << stroke + 1 << " restored incorrect labelmap" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // Redo all strokes
+  for (int stroke = 1; stroke <= numberOfStrokes; ++stroke)
+    {
+    history->RestoreNextState();
+    vtkOrientedImageData* restoredLabelmap = vtkOrientedImageData::SafeDownCast(
+      segmentation->GetSegment("Segment_1")->GetRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+    if (!IsEqualLabelmap(restoredLabelmap, expectedVoxels[stroke]))
+      {
+      std::cerr << __LINE__ << ": Redo of stroke " << stroke << " restored incorrect labelmap" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // Undo a few strokes, then modify the segmentation: the last restored state becomes the most recent one
+  history->RestorePreviousState();
+  history->RestorePreviousState();
+  vtkOrientedImageData* currentLabelmap = vtkOrientedImageData::SafeDownCast(
+    segmentation->GetSegment("Segment_1")->GetRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+  int modifierExtent[6] = { 100, 150, 100, 150, 50, 60 };
+  PaintBox(currentLabelmap, modifierExtent, 1);
+  CHECK_INT(history->GetNumberOfStates(), numberOfStrokes - 1);
+  history->RestorePreviousState();
+  currentLabelmap = vtkOrientedImageData::SafeDownCast(
+    segmentation->GetSegment("Segment_1")->GetRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+  if (!IsEqualLabelmap(currentLabelmap, expectedVoxels[numberOfStrokes - 2]))
+    {
+    std::cerr << __LINE__ << ": Undo after modification restored incorrect labelmap" << std::endl;
+    return EXIT_FAILURE;
+    }
+  history->RestorePreviousState();
+  currentLabelmap = vtkOrientedImageData::SafeDownCast(
+    segmentation->GetSegment("Segment_1")->GetRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+  if (!IsEqualLabelmap(currentLabelmap, expectedVoxels[numberOfStrokes - 3]))
+    {
+    std::cerr << __LINE__ << ": Undo after modification restored incorrect labelmap" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Memory limit removes the oldest states, but keeps the last restored state
+  int numberOfStatesBeforeLimit = history->GetNumberOfStates();
+  history->SetMaximumMemorySize(1);
+  if (history->GetNumberOfStates() >= numberOfStatesBeforeLimit || history->GetNumberOfStates() < 1)
+    {
+    std::cerr << __LINE__ << ": Memory limit did not remove old states (number of states: "
+      << history->GetNumberOfStates() << ")" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (!history->IsRestoreNextStateAvailable())
+    {
+    std::cerr << __LINE__ << ": Memory limit removed states that are more recent than the last restored state" << std::endl;
+    return EXIT_FAILURE;
+    }
+  history->RestoreNextState();
+  currentLabelmap = vtkOrientedImageData::SafeDownCast(
+    segmentation->GetSegment("Segment_1")->GetRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+  if (!IsEqualLabelmap(currentLabelmap, expectedVoxels[numberOfStrokes - 2]))
+    {
+    std::cerr << __LINE__ << ": Redo after applying memory limit restored incorrect labelmap" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Strokes that change the extent of the labelmap. The initial content is noise that does not compress,
+  // so the history only stays small if the states are stored as difference to the next state.
+  vtkNew<vtkOrientedImageData> growingLabelmap;
+  growingLabelmap->SetExtent(0, 63, 0, 63, 0, 63);
+  growingLabelmap->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  unsigned char* noiseVoxels = static_cast<unsigned char*>(growingLabelmap->GetScalarPointer());
+  unsigned int noise = 12345;
+  for (vtkIdType i = 0; i < growingLabelmap->GetNumberOfPoints(); ++i)
+    {
+    noise = noise * 1103515245 + 12345;
+    noiseVoxels[i] = static_cast<unsigned char>(noise >> 16);
+    }
+  size_t noiseSize = static_cast<size_t>(growingLabelmap->GetNumberOfPoints());
+
+  vtkNew<vtkSegment> growingSegment;
+  growingSegment->AddRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName(), growingLabelmap);
+  vtkNew<vtkSegmentation> growingSegmentation;
+  growingSegmentation->SetMasterRepresentationName(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName());
+  growingSegmentation->AddSegment(growingSegment, "Segment_1");
+  vtkNew<vtkSegmentationHistory> growingHistory;
+  growingHistory->SetMaximumNumberOfStates(20);
+  growingHistory->SetSegmentation(growingSegmentation);
+
+  // Each stroke extends the labelmap along the first axis and paints in the new region,
+  // the last stroke crops the labelmap (removes the region painted by the previous stroke).
+  const int numberOfGrowingStrokes = 7;
+  std::vector<std::vector<unsigned char> > expectedGrowingVoxels;
+  std::vector<std::vector<int> > expectedGrowingExtents;
+  for (int stroke = 0; stroke <= numberOfGrowingStrokes; ++stroke)
+    {
+    if (stroke > 0)
+      {
+      int* oldExtent = growingLabelmap->GetExtent();
+      int newExtent[6] = { oldExtent[0], oldExtent[1] + (stroke < numberOfGrowingStrokes ? 32 : -32),
+        oldExtent[2], oldExtent[3], oldExtent[4], oldExtent[5] };
+      int commonExtent[6] = { newExtent[0], std::min(oldExtent[1], newExtent[1]),
+        newExtent[2], newExtent[3], newExtent[4], newExtent[5] };
+      vtkNew<vtkOrientedImageData> newLabelmap;
+      newLabelmap->SetExtent(newExtent);
+      newLabelmap->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+      newLabelmap->GetPointData()->GetScalars()->Fill(0);
+      for (int k = commonExtent[4]; k <= commonExtent[5]; ++k)
+        {
+        for (int j = commonExtent[2]; j <= commonExtent[3]; ++j)
+          {
+          memcpy(newLabelmap->GetScalarPointer(commonExtent[0], j, k), growingLabelmap->GetScalarPointer(commonExtent[0], j, k),
+            commonExtent[1] - commonExtent[0] + 1);
+          }
+        }
+      if (stroke < numberOfGrowingStrokes)
+        {
+        int strokeExtent[6] = { newExtent[1] - 40, newExtent[1] - 10, 20, 30, 20, 30 };
+        PaintBox(newLabelmap, strokeExtent, static_cast<unsigned char>(stroke));
+        }
+      growingLabelmap->DeepCopy(newLabelmap);
+      }
+    growingHistory->SaveState();
+    unsigned char* voxels = static_cast<unsigned char*>(growingLabelmap->GetScalarPointer());
+    expectedGrowingVoxels.emplace_back(voxels, voxels + growingLabelmap->GetNumberOfPoints());
+    expectedGrowingExtents.emplace_back(growingLabelmap->GetExtent(), growingLabelmap->GetExtent() + 6);
+    }
+  CHECK_INT(growingHistory->GetNumberOfStates(), numberOfGrowingStrokes + 1);
+
+  // Only the most recent state is stored in full, the others add little more than the size of the strokes
+  vtkTypeInt64 growingMemorySize = growingHistory->GetMemorySize();
+  size_t growingLabelmapSize = static_cast<size_t>(growingLabelmap->GetNumberOfPoints());
+  if (growingMemorySize > static_cast<vtkTypeInt64>(growingLabelmapSize + noiseSize / 2))
+    {
+    std::cerr << __LINE__ << ": Memory size of " << numberOfGrowingStrokes + 1 << " states with changing extent is "
+      << growingMemorySize << " bytes, expected less than " << growingLabelmapSize + noiseSize / 2 << " bytes" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  for (int stroke = numberOfGrowingStrokes - 1; stroke >= 0; --stroke)
+    {
+    growingHistory->RestorePreviousState();
+    vtkOrientedImageData* restoredLabelmap = vtkOrientedImageData::SafeDownCast(
+      growingSegmentation->GetSegment("Segment_1")->GetRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+    if (!IsEqualLabelmap(restoredLabelmap, expectedGrowingVoxels[stroke])
+      || !std::equal(expectedGrowingExtents[stroke].begin(), expectedGrowingExtents[stroke].end(), restoredLabelmap->GetExtent()))
+      {
+      std::cerr << __LINE__ << ": Undo of stroke " << stroke + 1 << " with changing extent restored incorrect labelmap" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  for (int stroke = 1; stroke <= numberOfGrowingStrokes; ++stroke)
+    {
+    growingHistory->RestoreNextState();
+    vtkOrientedImageData* restoredLabelmap = vtkOrientedImageData::SafeDownCast(
+      growingSegmentation->GetSegment("Segment_1")->GetRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+    if (!IsEqualLabelmap(restoredLabelmap, expectedGrowingVoxels[stroke])
+      || !std::equal(expectedGrowingExtents[stroke].begin(), expectedGrowingExtents[stroke].end(), restoredLabelmap->GetExtent()))
+      {
+      std::cerr << __LINE__ << ": Redo of stroke " << stroke << " with changing extent restored incorrect labelmap" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
+
 //----------------------------------------------------------------------------
 int vtkSegmentationHistoryTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
 {
@@ -243,6 +494,11 @@ int vtkSegmentationHistoryTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
   // restoring previous state saves the current modified state
   CHECK_INT(history->GetNumberOfStates(), 3);
 
+  if (TestCompressedStates() != EXIT_SUCCESS)
+    {
+    return EXIT_FAILURE;
+    }
+
   std::cout << "Segmentation history test 1 passed." << std::endl;
   return EXIT_SUCCESS;
 }
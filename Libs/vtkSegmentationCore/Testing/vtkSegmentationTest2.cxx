@@ -26,6 +26,7 @@
 #include <vtkSphereSource.h>
 #include <vtkMatrix4x4.h>
 #include <vtkImageAccumulate.h>
+#include <vtkIntArray.h>
 
 // SegmentationCore includes
 #include "vtkSegmentation.h"
@@ -314,6 +315,90 @@ bool TestSharedLabelmapCasting()
   return true;
 }
 
+//----------------------------------------------------------------------------
+bool TestMergedLabelmap()
+{
+  vtkNew<vtkOrientedImageData> cubeImage1;
+  int extent1[6] = { 0, 2, 0, 2, 0, 2 };
+  CreateCubeLabelmap(cubeImage1, extent1);
+
+  vtkNew<vtkOrientedImageData> cubeImage2;
+  int extent2[6] = { -2, 1, -2, 1, -2, 1 };
+  CreateCubeLabelmap(cubeImage2, extent2);
+
+  vtkNew<vtkOrientedImageData> cubeImage3;
+  int extent3[6] = { 3, 5, 3, 5, 3, 5 };
+  CreateCubeLabelmap(cubeImage3, extent3);
+
+  vtkNew<vtkSegmentation> segmentation;
+  segmentation->SetMasterRepresentationName(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName());
+  std::vector<vtkOrientedImageData*> cubeImages = { cubeImage1, cubeImage2, cubeImage3 };
+  std::vector<std::string> segmentIDs;
+  for (vtkOrientedImageData* cubeImage : cubeImages)
+    {
+    vtkNew<vtkSegment> segment;
+    segment->SetName("cube");
+    segment->AddRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName(), cubeImage);
+    segmentation->AddSegment(segment);
+    segmentIDs.push_back(segmentation->GetSegmentIdBySegment(segment));
+    }
+
+  // Overlapping cubes are stored in separate layers
+  segmentation->CollapseBinaryLabelmaps(false);
+  if (segmentation->GetNumberOfLayers() != 2)
+    {
+    std::cerr << "Invalid number of layers " << segmentation->GetNumberOfLayers() << " should be 2" << std::endl;
+    return false;
+    }
+
+  // Segments that are later in the list overwrite earlier ones
+  struct ExpectedVoxel
+    {
+    int Position[3];
+    int LabelValue;
+    };
+  std::vector<std::string> reverseSegmentIDs(segmentIDs.rbegin(), segmentIDs.rend());
+  vtkNew<vtkIntArray> labelValues;
+  labelValues->InsertNextValue(10);
+  labelValues->InsertNextValue(20);
+  labelValues->InsertNextValue(30);
+  std::vector<std::pair<std::vector<std::string>, vtkIntArray*> > mergeInputs =
+    {
+    { segmentIDs, nullptr },
+    { reverseSegmentIDs, nullptr },
+    { segmentIDs, labelValues },
+    };
+  std::vector<std::vector<ExpectedVoxel> > expectedVoxelsForInputs =
+    {
+    { { { 1, 1, 1 }, 2 }, { { 2, 2, 2 }, 1 }, { { -2, -2, -2 }, 2 }, { { 4, 4, 4 }, 3 }, { { 2, 2, 4 }, 0 } },
+    { { { 1, 1, 1 }, 3 }, { { 2, 2, 2 }, 3 }, { { -2, -2, -2 }, 2 }, { { 4, 4, 4 }, 1 }, { { 2, 2, 4 }, 0 } },
+    { { { 1, 1, 1 }, 20 }, { { 2, 2, 2 }, 10 }, { { -2, -2, -2 }, 20 }, { { 4, 4, 4 }, 30 }, { { 2, 2, 4 }, 0 } },
+    };
+  for (size_t inputIndex = 0; inputIndex < mergeInputs.size(); ++inputIndex)
+    {
+    vtkNew<vtkOrientedImageData> mergedImage;
+    if (!segmentation->GenerateMergedLabelmap(mergedImage, vtkSegmentation::EXTENT_UNION_OF_SEGMENTS, nullptr,
+      mergeInputs[inputIndex].first, mergeInputs[inputIndex].second))
+      {
+      std::cerr << "Failed to generate merged labelmap" << std::endl;
+      return false;
+      }
+    for (const ExpectedVoxel& expectedVoxel : expectedVoxelsForInputs[inputIndex])
+      {
+      const int* position = expectedVoxel.Position;
+      int labelValue = static_cast<int>(mergedImage->GetScalarComponentAsDouble(position[0], position[1], position[2], 0));
+      if (labelValue != expectedVoxel.LabelValue)
+        {
+        std::cerr << "Merged labelmap " << inputIndex << ": invalid label value " << labelValue << " at ("
+          << position[0] << ", " << position[1] << ", " << position[2] << "), should be " << expectedVoxel.LabelValue << std::endl;
+        return false;
+        }
+      }
+    }
+
+  return true;
+}
+
 //----------------------------------------------------------------------------
 int vtkSegmentationTest2(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
 {
@@ -338,6 +423,11 @@ int vtkSegmentationTest2(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
     return EXIT_FAILURE;
     }
 
+  if (!TestMergedLabelmap())
+    {
+    return EXIT_FAILURE;
+    }
+
   std::cout << "Segmentation test 2 passed." << std::endl;
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,339 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+
+// SegmentationCore includes
+#include "vtkBinaryLabelmapToSparseLabelmapConversionRule.h"
+#include "vtkClosedSurfaceToBinaryLabelmapConversionRule.h"
+#include "vtkOrientedImageData.h"
+#include "vtkOrientedImageDataResample.h"
+#include "vtkSegmentation.h"
+#include "vtkSegmentationConverterFactory.h"
+#include "vtkSparseLabelmap.h"
+#include "vtkSparseLabelmapToBinaryLabelmapConversionRule.h"
+#include "vtkSparseLabelmapToClosedSurfaceConversionRule.h"
+
+// STD includes
+#include <algorithm>
+#include <iostream>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+void FillBox(vtkImageData* image, const int box[6], double value)
+{
+  for (int k = box[4]; k <= box[5]; ++k)
+    {
+    for (int j = box[2]; j <= box[3]; ++j)
+      {
+      for (int i = box[0]; i <= box[1]; ++i)
+        {
+        image->SetScalarComponentFromDouble(i, j, k, 0, value);
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+/// Labelmap with boxes of three labels, one of them does not fit in unsigned char
+void CreateLabelmap(vtkOrientedImageData* image)
+{
+  image->SetExtent(-5, 34, 0, 24, 2, 21);
+  image->SetSpacing(0.5, 1.0, 2.0);
+  image->SetOrigin(10.0, -20.0, 5.0);
+  image->AllocateScalars(VTK_SHORT, 1);
+  image->GetPointData()->GetScalars()->Fill(0);
+  int box1[6] = { -5, 10, 3, 9, 2, 8 };
+  FillBox(image, box1, 1);
+  int box2[6] = { 8, 20, 5, 15, 6, 14 };
+  FillBox(image, box2, 2);
+  int box3[6] = { 25, 34, 20, 24, 18, 21 };
+  FillBox(image, box3, 300);
+}
+
+//----------------------------------------------------------------------------
+/// Modifier image with a spherical mask
+void CreateModifier(vtkOrientedImageData* labelmap, const int extent[6], vtkOrientedImageData* modifier)
+{
+  modifier->SetExtent(const_cast<int*>(extent));
+  modifier->SetSpacing(labelmap->GetSpacing());
+  modifier->SetOrigin(labelmap->GetOrigin());
+  modifier->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  double center[3] = { (extent[0] + extent[1]) / 2.0, (extent[2] + extent[3]) / 2.0, (extent[4] + extent[5]) / 2.0 };
+  double radius = (extent[1] - extent[0]) / 2.0;
+  for (int k = extent[4]; k <= extent[5]; ++k)
+    {
+    for (int j = extent[2]; j <= extent[3]; ++j)
+      {
+      for (int i = extent[0]; i <= extent[1]; ++i)
+        {
+        double distance2 = (i - center[0]) * (i - center[0]) + (j - center[1]) * (j - center[1]) + (k - center[2]) * (k - center[2]);
+        *static_cast<unsigned char*>(modifier->GetScalarPointer(i, j, k)) = (distance2 <= radius * radius ? 1 : 0);
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+bool CompareLabelmaps(vtkOrientedImageData* image, vtkSparseLabelmap* sparseLabelmap)
+{
+  int* extent = image->GetExtent();
+  for (int k = extent[4]; k <= extent[5]; ++k)
+    {
+    for (int j = extent[2]; j <= extent[3]; ++j)
+      {
+      for (int i = extent[0]; i <= extent[1]; ++i)
+        {
+        int imageValue = static_cast<int>(image->GetScalarComponentAsDouble(i, j, k, 0));
+        if (sparseLabelmap->GetValue(i, j, k) != imageValue)
+          {
+          std::cerr << "Voxel mismatch at (" << i << ", " << j << ", " << k << "): "
+            << sparseLabelmap->GetValue(i, j, k) << " != " << imageValue << std::endl;
+          return false;
+          }
+        }
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool TestEncodeDecode()
+{
+  vtkNew<vtkOrientedImageData> labelmap;
+  CreateLabelmap(labelmap);
+
+  vtkNew<vtkSparseLabelmap> sparseLabelmap;
+  if (!sparseLabelmap->EncodeImage(labelmap) || !CompareLabelmaps(labelmap, sparseLabelmap))
+    {
+    std::cerr << "Encoding failed" << std::endl;
+    return false;
+    }
+
+  vtkNew<vtkOrientedImageData> decodedLabelmap;
+  if (!sparseLabelmap->DecodeImage(decodedLabelmap) || !CompareLabelmaps(decodedLabelmap, sparseLabelmap)
+    || !vtkOrientedImageDataResample::DoGeometriesMatch(labelmap, decodedLabelmap)
+    || !vtkOrientedImageDataResample::DoExtentsMatch(labelmap, decodedLabelmap))
+    {
+    std::cerr << "Decoding failed" << std::endl;
+    return false;
+    }
+
+  int sparseEffectiveExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  int effectiveExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  vtkOrientedImageDataResample::CalculateEffectiveExtent(sparseLabelmap, sparseEffectiveExtent, 1.0);
+  vtkOrientedImageDataResample::CalculateEffectiveExtent(labelmap, effectiveExtent, 1.0);
+  for (int i = 0; i < 6; ++i)
+    {
+    if (sparseEffectiveExtent[i] != effectiveExtent[i])
+      {
+      std::cerr << "Effective extent mismatch" << std::endl;
+      return false;
+      }
+    }
+
+  // Only the selected label is kept
+  vtkNew<vtkSparseLabelmap> sparseLabel;
+  sparseLabel->EncodeImage(labelmap, 2);
+  if (sparseLabel->GetValue(9, 6, 7) != 2 || sparseLabel->GetValue(0, 4, 3) != 0 || sparseLabel->GetValue(30, 22, 20) != 0)
+    {
+    std::cerr << "Encoding of a single label failed" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool TestMergeImage()
+{
+  const int operations[3] = { vtkOrientedImageDataResample::OPERATION_MAXIMUM,
+    vtkOrientedImageDataResample::OPERATION_MINIMUM, vtkOrientedImageDataResample::OPERATION_MASKING };
+  for (int operation : operations)
+    {
+    vtkNew<vtkOrientedImageData> labelmap;
+    CreateLabelmap(labelmap);
+    vtkNew<vtkSparseLabelmap> sparseLabelmap;
+    sparseLabelmap->EncodeImage(labelmap);
+
+    // Modifier partially outside the labelmap, restricted to a smaller extent
+    int modifierExtent[6] = { 20, 44, 0, 24, 0, 24 };
+    vtkNew<vtkOrientedImageData> modifier;
+    CreateModifier(labelmap, modifierExtent, modifier);
+    int extent[6] = { 22, 40, 2, 22, 1, 23 };
+
+    vtkNew<vtkOrientedImageData> mergedLabelmap;
+    vtkNew<vtkSparseLabelmap> mergedSparseLabelmap;
+    bool modified = false;
+    bool sparseModified = false;
+    if (!vtkOrientedImageDataResample::MergeImage(labelmap, modifier, mergedLabelmap, operation, extent, 0, 5, &modified)
+      || !vtkOrientedImageDataResample::MergeImage(sparseLabelmap, modifier, mergedSparseLabelmap, operation, extent, 0, 5, &sparseModified))
+      {
+      std::cerr << "Merge failed for operation " << operation << std::endl;
+      return false;
+      }
+    int* mergedExtent = mergedLabelmap->GetExtent();
+    int* mergedSparseExtent = mergedSparseLabelmap->GetExtent();
+    for (int i = 0; i < 6; ++i)
+      {
+      if (mergedExtent[i] != mergedSparseExtent[i])
+        {
+        std::cerr << "Merged extent mismatch for operation " << operation << std::endl;
+        return false;
+        }
+      }
+    if (!CompareLabelmaps(mergedLabelmap, mergedSparseLabelmap) || modified != sparseModified)
+      {
+      std::cerr << "Merge result mismatch for operation " << operation << std::endl;
+      return false;
+      }
+
+    // In-place modification
+    vtkOrientedImageDataResample::ModifyImage(labelmap, modifier, operation, extent, 0, 7);
+    vtkOrientedImageDataResample::ModifyImage(sparseLabelmap, modifier, operation, extent, 0, 7);
+    if (!CompareLabelmaps(labelmap, sparseLabelmap))
+      {
+      std::cerr << "Modify result mismatch for operation " << operation << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool TestMemoryUsage()
+{
+  // 100 small segments in a large grid
+  vtkNew<vtkSparseLabelmap> sparseLabelmap;
+  sparseLabelmap->SetExtent(0, 511, 0, 511, 0, 399);
+  for (int segmentIndex = 0; segmentIndex < 100; ++segmentIndex)
+    {
+    int i = 20 + (segmentIndex % 10) * 48;
+    int j = 2 + (segmentIndex % 50) * 10;
+    int k = 10 + (segmentIndex / 50) * 200;
+    int box[6] = { i, i + 9, j, j + 9, k, k + 9 };
+    vtkNew<vtkOrientedImageData> modifier;
+    modifier->SetExtent(box);
+    modifier->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+    modifier->GetPointData()->GetScalars()->Fill(segmentIndex + 1);
+    vtkOrientedImageDataResample::ModifyImage(sparseLabelmap, modifier, vtkOrientedImageDataResample::OPERATION_MAXIMUM);
+    }
+
+  if (sparseLabelmap->GetNumberOfRows() != 100 * 10 * 10 || sparseLabelmap->GetNumberOfRuns() != 100 * 10 * 10)
+    {
+    std::cerr << "Unexpected number of rows or runs: " << sparseLabelmap->GetNumberOfRows()
+      << ", " << sparseLabelmap->GetNumberOfRuns() << std::endl;
+    return false;
+    }
+  unsigned long gridSizeKiB = 512 * 512 * 400 / 1024;
+  if (sparseLabelmap->GetActualMemorySize() * 100 > gridSizeKiB)
+    {
+    std::cerr << "Memory usage is not proportional to occupied volume: " << sparseLabelmap->GetActualMemorySize() << " KiB" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool TestConversion()
+{
+  vtkSegmentationConverterFactory* converterFactory = vtkSegmentationConverterFactory::GetInstance();
+  converterFactory->RegisterConverterRule(vtkSmartPointer<vtkBinaryLabelmapToSparseLabelmapConversionRule>::New());
+  converterFactory->RegisterConverterRule(vtkSmartPointer<vtkSparseLabelmapToBinaryLabelmapConversionRule>::New());
+  converterFactory->RegisterConverterRule(vtkSmartPointer<vtkSparseLabelmapToClosedSurfaceConversionRule>::New());
+
+  vtkNew<vtkOrientedImageData> labelmap;
+  CreateLabelmap(labelmap);
+
+  // Segments of a shared labelmap get separate sparse labelmaps
+  vtkNew<vtkSegmentation> segmentation;
+  segmentation->SetMasterRepresentationName(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName());
+  const int labelValues[3] = { 1, 2, 300 };
+  for (int labelValue : labelValues)
+    {
+    vtkNew<vtkSegment> segment;
+    segment->SetLabelValue(labelValue);
+    segment->AddRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName(), labelmap);
+    segmentation->AddSegment(segment);
+    }
+  if (!segmentation->CreateRepresentation(vtkSegmentationConverter::GetSparseLabelmapRepresentationName()))
+    {
+    std::cerr << "Conversion to sparse labelmap failed" << std::endl;
+    return false;
+    }
+  vtkSparseLabelmap* sparseLabelmap = vtkSparseLabelmap::SafeDownCast(segmentation->GetNthSegment(2)->GetRepresentation(
+    vtkSegmentationConverter::GetSparseLabelmapRepresentationName()));
+  if (!sparseLabelmap || sparseLabelmap->GetValue(30, 22, 20) != 300 || sparseLabelmap->GetValue(9, 6, 7) != 0)
+    {
+    std::cerr << "Invalid sparse labelmap" << std::endl;
+    return false;
+    }
+
+  // Sparse labelmap as master representation
+  vtkNew<vtkSegmentation> sparseSegmentation;
+  sparseSegmentation->SetMasterRepresentationName(vtkSegmentationConverter::GetSparseLabelmapRepresentationName());
+  vtkNew<vtkSegment> sparseSegment;
+  sparseSegment->SetLabelValue(300);
+  sparseSegment->AddRepresentation(vtkSegmentationConverter::GetSparseLabelmapRepresentationName(), sparseLabelmap);
+  sparseSegmentation->AddSegment(sparseSegment);
+  if (!sparseSegmentation->CreateRepresentation(vtkSegmentationConverter::GetClosedSurfaceRepresentationName()))
+    {
+    std::cerr << "Conversion to closed surface failed" << std::endl;
+    return false;
+    }
+  vtkPolyData* closedSurface = vtkPolyData::SafeDownCast(sparseSegment->GetRepresentation(
+    vtkSegmentationConverter::GetClosedSurfaceRepresentationName()));
+  if (!closedSurface || closedSurface->GetNumberOfPoints() == 0)
+    {
+    std::cerr << "Invalid closed surface" << std::endl;
+    return false;
+    }
+  if (!sparseSegmentation->CreateRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()))
+    {
+    std::cerr << "Conversion to binary labelmap failed" << std::endl;
+    return false;
+    }
+  vtkOrientedImageData* binaryLabelmap = vtkOrientedImageData::SafeDownCast(sparseSegment->GetRepresentation(
+    vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+  int expectedExtent[6] = { 25, 34, 20, 24, 18, 21 };
+  int* binaryLabelmapExtent = binaryLabelmap ? binaryLabelmap->GetExtent() : nullptr;
+  if (!binaryLabelmapExtent || !std::equal(expectedExtent, expectedExtent + 6, binaryLabelmapExtent)
+    || !CompareLabelmaps(binaryLabelmap, sparseLabelmap))
+    {
+    std::cerr << "Invalid binary labelmap" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkSparseLabelmapTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  if (!TestEncodeDecode() || !TestMergeImage() || !TestMemoryUsage() || !TestConversion())
+    {
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Sparse labelmap test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
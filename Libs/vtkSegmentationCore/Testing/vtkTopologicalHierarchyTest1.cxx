@@ -0,0 +1,188 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// SegmentationCore includes
+#include "vtkTopologicalHierarchy.h"
+
+// VTK includes
+#include <vtkCubeSource.h>
+#include <vtkIntArray.h>
+#include <vtkMinimalStandardRandomSequence.h>
+#include <vtkNew.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataCollection.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+bool ReferenceContains(const double extentOut[6], const double extentIn[6], double factor)
+{
+  return extentOut[0] < extentIn[0] - factor * (extentOut[1]-extentOut[0])
+    && extentOut[1] > extentIn[1] + factor * (extentOut[1]-extentOut[0])
+    && extentOut[2] < extentIn[2] - factor * (extentOut[3]-extentOut[2])
+    && extentOut[3] > extentIn[3] + factor * (extentOut[3]-extentOut[2])
+    && extentOut[4] < extentIn[4] - factor * (extentOut[5]-extentOut[4])
+    && extentOut[5] > extentIn[5] + factor * (extentOut[5]-extentOut[4]);
+}
+
+//----------------------------------------------------------------------------
+// Levels computed by testing containment between all pairs, as a reference
+void ReferenceLevels(const std::vector<vtkSmartPointer<vtkPolyData> >& polyDataList, double factor,
+  unsigned int maximumLevel, std::vector<int>& levels)
+{
+  size_t numberOfPolyData = polyDataList.size();
+  std::vector<std::vector<size_t> > containedPolyData(numberOfPolyData);
+  levels.assign(numberOfPolyData, -1);
+  for (size_t outIndex = 0; outIndex < numberOfPolyData; ++outIndex)
+    {
+    double extentOut[6] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+    polyDataList[outIndex]->GetBounds(extentOut);
+    for (size_t inIndex = 0; inIndex < numberOfPolyData; ++inIndex)
+      {
+      double extentIn[6] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+      polyDataList[inIndex]->GetBounds(extentIn);
+      if (outIndex != inIndex && ReferenceContains(extentOut, extentIn, factor))
+        {
+        containedPolyData[outIndex].push_back(inIndex);
+        }
+      }
+    if (containedPolyData[outIndex].empty())
+      {
+      levels[outIndex] = 0;
+      }
+    }
+
+  for (unsigned int currentLevel = 1; currentLevel < maximumLevel; ++currentLevel)
+    {
+    std::vector<int> snapshot = levels;
+    for (size_t outIndex = 0; outIndex < numberOfPolyData; ++outIndex)
+      {
+      if (levels[outIndex] > -1)
+        {
+        continue;
+        }
+      bool allAssigned = true;
+      for (size_t inIndex : containedPolyData[outIndex])
+        {
+        if (snapshot[inIndex] == -1)
+          {
+          allAssigned = false;
+          break;
+          }
+        }
+      if (allAssigned)
+        {
+        levels[outIndex] = currentLevel;
+        }
+      }
+    }
+  for (int& level : levels)
+    {
+    if (level == -1)
+      {
+      level = maximumLevel;
+      }
+    }
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkTopologicalHierarchyTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  // Nested and overlapping boxes of various sizes, and an empty poly data
+  const int numberOfBoxes = 400;
+  vtkNew<vtkMinimalStandardRandomSequence> random;
+  random->SetSeed(42);
+  std::vector<vtkSmartPointer<vtkPolyData> > polyDataList;
+  vtkNew<vtkPolyDataCollection> collection;
+  for (int i = 0; i < numberOfBoxes; ++i)
+    {
+    double center[3] = { 0.0, 0.0, 0.0 };
+    for (int axis = 0; axis < 3; ++axis)
+      {
+      center[axis] = random->GetRangeValue(-100.0, 100.0);
+      random->Next();
+      }
+    double size = random->GetRangeValue(1.0, 150.0);
+    random->Next();
+    vtkNew<vtkCubeSource> cube;
+    cube->SetBounds(center[0] - size, center[0] + size, center[1] - size * 0.8, center[1] + size * 0.8,
+      center[2] - size * 1.2, center[2] + size * 1.2);
+    cube->Update();
+    vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+    polyData->DeepCopy(cube->GetOutput());
+    polyDataList.push_back(polyData);
+    collection->AddItem(polyData);
+    if (i == numberOfBoxes / 2)
+      {
+      vtkSmartPointer<vtkPolyData> emptyPolyData = vtkSmartPointer<vtkPolyData>::New();
+      polyDataList.push_back(emptyPolyData);
+      collection->AddItem(emptyPolyData);
+      }
+    }
+
+  const double factors[] = { 0.0, 0.05, -0.05 };
+  for (double factor : factors)
+    {
+    vtkNew<vtkTopologicalHierarchy> hierarchy;
+    hierarchy->SetInputPolyDataCollection(collection);
+    hierarchy->SetContainConstraintFactor(factor);
+    double startTime = vtkTimerLog::GetUniversalTime();
+    hierarchy->Update();
+    double updateTime = vtkTimerLog::GetUniversalTime() - startTime;
+
+    std::vector<int> expectedLevels;
+    ReferenceLevels(polyDataList, factor, 7, expectedLevels);
+
+    vtkIntArray* levels = hierarchy->GetOutputLevels();
+    if (levels->GetNumberOfTuples() != static_cast<vtkIdType>(expectedLevels.size()))
+      {
+      std::cerr << __LINE__ << ": Number of levels " << levels->GetNumberOfTuples()
+        << " does not match expected " << expectedLevels.size() << std::endl;
+      return EXIT_FAILURE;
+      }
+    int maximumLevelFound = 0;
+    for (size_t i = 0; i < expectedLevels.size(); ++i)
+      {
+      if (levels->GetValue(i) != expectedLevels[i])
+        {
+        std::cerr << __LINE__ << ": Level of poly data " << i << " with constraint factor " << factor << " is "
+          << levels->GetValue(i) << ", expected " << expectedLevels[i] << std::endl;
+        return EXIT_FAILURE;
+        }
+      maximumLevelFound = std::max(maximumLevelFound, expectedLevels[i]);
+      }
+    if (factor == 0.0 && maximumLevelFound < 2)
+      {
+      std::cerr << __LINE__ << ": Test data is expected to contain nested poly data" << std::endl;
+      return EXIT_FAILURE;
+      }
+    std::cout << "Topological hierarchy of " << polyDataList.size() << " poly data (constraint factor " << factor
+      << "): " << updateTime * 1000.0 << " ms, highest level " << maximumLevelFound << std::endl;
+    }
+
+  std::cout << "Topological hierarchy test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -22,6 +22,7 @@
 #include "vtkBinaryLabelmapToClosedSurfaceConversionRule.h"
 #include "vtkSegmentation.h"
 
+#include "vtkMultiLabelSurfaceNets.h"
 #include "vtkOrientedImageData.h"
 
 // VTK includes
@@ -52,6 +53,7 @@
 #include <vtkWindowedSincPolyDataFilter.h>
 #include <vtkMatrix3x3.h>
 #include <vtkReverseSense.h>
+#include <vtkSMPTools.h>
 #include <vtkStringToNumeric.h>
 #include <vtkStringArray.h>
 
@@ -63,11 +65,63 @@
 #include <vtkExtractSelection.h>
 #include <vtkSelectionSource.h>
 
+// STD includes
+#include <algorithm>
+#include <set>
+#include <sstream>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> DecimateSurface(vtkPolyData* surface, double decimationFactor)
+{
+  vtkSmartPointer<vtkDecimatePro> decimator = vtkSmartPointer<vtkDecimatePro>::New();
+  decimator->SetInputData(surface);
+  decimator->SetFeatureAngle(60);
+  decimator->SplittingOff();
+  decimator->PreserveTopologyOn();
+  decimator->SetMaximumError(1);
+  decimator->SetTargetReduction(decimationFactor);
+  decimator->Update();
+  return decimator->GetOutput();
+}
+
+//----------------------------------------------------------------------------
+/// Transform the surface from labelmap IJK to world coordinate system and optionally compute normals
+vtkSmartPointer<vtkPolyData> TransformSurfaceToWorld(vtkPolyData* surface, vtkMatrix4x4* imageToWorldMatrix, bool computeSurfaceNormals)
+{
+  vtkSmartPointer<vtkTransform> labelmapGeometryTransform = vtkSmartPointer<vtkTransform>::New();
+  labelmapGeometryTransform->SetMatrix(imageToWorldMatrix);
+
+  vtkSmartPointer<vtkTransformPolyDataFilter> transformPolyDataFilter = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
+  transformPolyDataFilter->SetInputData(surface);
+  transformPolyDataFilter->SetTransform(labelmapGeometryTransform);
+
+  if (computeSurfaceNormals)
+    {
+    vtkSmartPointer<vtkPolyDataNormals> polyDataNormals = vtkSmartPointer<vtkPolyDataNormals>::New();
+    polyDataNormals->SetInputConnection(transformPolyDataFilter->GetOutputPort());
+    polyDataNormals->ConsistencyOn(); // discrete marching cubes may generate inconsistent surface
+    // We almost always perform smoothing, so splitting would not be able to preserve any sharp features
+    // (and sharp edges would look like artifacts in the smooth surface).
+    polyDataNormals->SplittingOff();
+    polyDataNormals->Update();
+    return polyDataNormals->GetOutput();
+    }
+  transformPolyDataFilter->Update();
+  return transformPolyDataFilter->GetOutput();
+}
+
+} // end of anonymous namespace
+
 //----------------------------------------------------------------------------
 vtkSegmentationConverterRuleNewMacro(vtkBinaryLabelmapToClosedSurfaceConversionRule);
 
 //----------------------------------------------------------------------------
 vtkBinaryLabelmapToClosedSurfaceConversionRule::vtkBinaryLabelmapToClosedSurfaceConversionRule()
+  : ConvertedSegmentation(nullptr)
+  , ConcurrentConvertPrepared(false)
 {
   this->ConversionParameters->SetParameter(GetDecimationFactorParameterName(), "0.0",
     "Desired reduction in the total number of polygons. Range: 0.0 (no decimation) to 1.0 (as much simplification as possible)."
@@ -79,6 +133,9 @@ vtkBinaryLabelmapToClosedSurfaceConversionRule::vtkBinaryLabelmapToClosedSurface
     "0 = surface normals are not computed (slightly faster but produces less smooth surface display).");
   this->ConversionParameters->SetParameter(GetJointSmoothingParameterName(), "0",
     "Perform joint smoothing.");
+  this->ConversionParameters->SetParameter(GetSurfaceNetsParameterName(), "0",
+    "Extract surfaces of all segments of a labelmap in a single pass using surface nets."
+    " 1 = surface nets with constrained smoothing, 0 (default) = flying edges.");
 }
 
 //----------------------------------------------------------------------------
@@ -152,45 +209,39 @@ bool vtkBinaryLabelmapToClosedSurfaceConversionRule::Convert(vtkSegment* segment
 
   double smoothingFactor = this->ConversionParameters->GetValueAsDouble(GetSmoothingFactorParameterName());
   int jointSmoothing = this->ConversionParameters->GetValueAsInt(GetJointSmoothingParameterName());
+  int surfaceNets = this->ConversionParameters->GetValueAsInt(GetSurfaceNetsParameterName());
 
-  if (jointSmoothing > 0 && smoothingFactor > 0)
+  // Segments converted concurrently have a copy of the labelmap, surfaces are cached for the labelmap in the segmentation
+  vtkOrientedImageData* sharedLabelmap = orientedBinaryLabelmap;
+  auto sharedLabelmapIt = this->ConcurrentConvertSharedLabelmaps.find(orientedBinaryLabelmap);
+  if (sharedLabelmapIt != this->ConcurrentConvertSharedLabelmaps.end())
     {
-    if (this->JointSmoothCache.find(orientedBinaryLabelmap) == this->JointSmoothCache.end())
-      {
-      double* scalarRange = orientedBinaryLabelmap->GetScalarRange();
-      int lowLabel = (int)(floor(scalarRange[0]));
-      int highLabel = (int)(ceil(scalarRange[1]));
-
-      vtkNew<vtkImageAccumulate> imageAccumulate;
-      imageAccumulate->SetInputData(orientedBinaryLabelmap);
-      imageAccumulate->IgnoreZeroOn();
-      imageAccumulate->SetComponentOrigin(0, 0, 0);
-      imageAccumulate->SetComponentSpacing(1, 1, 1);
-      imageAccumulate->SetComponentExtent(lowLabel, highLabel, 0, 0, 0, 0);
-      imageAccumulate->Update();
-
-      std::vector<int> labelValues;
-      for (int labelValue = lowLabel; labelValue <= highLabel; ++labelValue)
-        {
-        // Add a new threshold for every level in the labelmap
-        double numberOfVoxels = imageAccumulate->GetOutput()->GetPointData()->GetScalars()->GetTuple1((int)labelValue - lowLabel);
-        if (numberOfVoxels > 0.0)
-          {
-          labelValues.push_back(labelValue);
-          }
-        }
+    sharedLabelmap = sharedLabelmapIt->second;
+    }
 
-      vtkSmartPointer<vtkPolyData> jointSmoothedSurface = vtkSmartPointer<vtkPolyData>::New();
-      this->CreateClosedSurface(orientedBinaryLabelmap, jointSmoothedSurface, labelValues);
-      this->JointSmoothCache[orientedBinaryLabelmap] = jointSmoothedSurface;
+  if (surfaceNets > 0)
+    {
+    vtkSmartPointer<vtkPolyData> labelSurface = this->GetMultiLabelSurface(sharedLabelmap, segment->GetLabelValue());
+    if (labelSurface)
+      {
+      closedSurfacePolyData->ShallowCopy(labelSurface);
       }
-
-    vtkDataObject* sharedSurface = this->JointSmoothCache[orientedBinaryLabelmap];
-    if (!sharedSurface)
+    else
+      {
+      closedSurfacePolyData->Initialize();
+      }
+    }
+  else if (jointSmoothing > 0 && smoothingFactor > 0)
+    {
+    vtkSmartPointer<vtkPolyData> cachedSurface = this->GetJointSmoothedSurface(sharedLabelmap);
+    if (!cachedSurface)
       {
       vtkErrorMacro("Convert: Could not find cached surface");
       return false;
       }
+    // The cached surface may be used as filter input by other threads, therefore use a copy
+    vtkNew<vtkPolyData> sharedSurface;
+    sharedSurface->ShallowCopy(cachedSurface);
 
     vtkNew<vtkSelectionSource> selection;
     selection->SetContentType(vtkSelectionNode::THRESHOLDS);
@@ -322,15 +373,7 @@ bool vtkBinaryLabelmapToClosedSurfaceConversionRule::CreateClosedSurface(vtkOrie
   // Decimate
   if (decimationFactor > 0.0)
     {
-    vtkSmartPointer<vtkDecimatePro> decimator = vtkSmartPointer<vtkDecimatePro>::New();
-    decimator->SetInputData(processingResult);
-    decimator->SetFeatureAngle(60);
-    decimator->SplittingOff();
-    decimator->PreserveTopologyOn();
-    decimator->SetMaximumError(1);
-    decimator->SetTargetReduction(decimationFactor);
-    decimator->Update();
-    processingResult = decimator->GetOutput();
+    processingResult = DecimateSurface(processingResult, decimationFactor);
     }
 
   if (smoothingFactor > 0)
@@ -354,40 +397,292 @@ bool vtkBinaryLabelmapToClosedSurfaceConversionRule::CreateClosedSurface(vtkOrie
     }
 
   // Transform the result surface from labelmap IJK to world coordinate system
-  vtkSmartPointer<vtkTransform> labelmapGeometryTransform = vtkSmartPointer<vtkTransform>::New();
   vtkSmartPointer<vtkMatrix4x4> labelmapImageToWorldMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
   orientedBinaryLabelmap->GetImageToWorldMatrix(labelmapImageToWorldMatrix);
-  labelmapGeometryTransform->SetMatrix(labelmapImageToWorldMatrix);
+  convertedSegment->ShallowCopy(TransformSurfaceToWorld(processingResult, labelmapImageToWorldMatrix, computeSurfaceNormals > 0));
 
-  vtkSmartPointer<vtkTransformPolyDataFilter> transformPolyDataFilter = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
-  transformPolyDataFilter->SetInputData(processingResult);
-  transformPolyDataFilter->SetTransform(labelmapGeometryTransform);
+  closedSurfacePolyData->ShallowCopy(convertedSegment);
+  return true;
+}
 
-  if (computeSurfaceNormals > 0)
+//----------------------------------------------------------------------------
+bool vtkBinaryLabelmapToClosedSurfaceConversionRule::CreateMultiLabelClosedSurfaces(vtkOrientedImageData* orientedBinaryLabelmap,
+  std::map<int, vtkSmartPointer<vtkPolyData> >& surfaces)
+{
+  surfaces.clear();
+  MultiLabelSurfaceCacheEntry cacheEntry;
+  if (!this->UpdateMultiLabelClosedSurfaces(orientedBinaryLabelmap, cacheEntry, nullptr))
     {
-    vtkSmartPointer<vtkPolyDataNormals> polyDataNormals = vtkSmartPointer<vtkPolyDataNormals>::New();
-    polyDataNormals->SetInputConnection(transformPolyDataFilter->GetOutputPort());
-    polyDataNormals->ConsistencyOn(); // discrete marching cubes may generate inconsistent surface
-    // We almost always perform smoothing, so splitting would not be able to preserve any sharp features
-    // (and sharp edges would look like artifacts in the smooth surface).
-    polyDataNormals->SplittingOff();
-    polyDataNormals->Update();
-    convertedSegment->ShallowCopy(polyDataNormals->GetOutput());
+    return false;
     }
-  else
+  surfaces = cacheEntry.Surfaces;
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkBinaryLabelmapToClosedSurfaceConversionRule::UpdateMultiLabelClosedSurfaces(vtkOrientedImageData* orientedBinaryLabelmap,
+  MultiLabelSurfaceCacheEntry& cacheEntry, vtkSegmentation* segmentation)
+{
+  if (!orientedBinaryLabelmap)
     {
-    transformPolyDataFilter->Update();
-    convertedSegment->ShallowCopy(transformPolyDataFilter->GetOutput());
+    vtkErrorMacro("UpdateMultiLabelClosedSurfaces: Source representation is not oriented image data");
+    return false;
     }
 
-  closedSurfacePolyData->ShallowCopy(convertedSegment);
+  // Get conversion parameters
+  double decimationFactor = this->ConversionParameters->GetValueAsDouble(GetDecimationFactorParameterName());
+  double smoothingFactor = this->ConversionParameters->GetValueAsDouble(GetSmoothingFactorParameterName());
+  int computeSurfaceNormals = this->ConversionParameters->GetValueAsInt(GetComputeSurfaceNormalsParameterName());
+  std::string conversionParameters = this->GetMultiLabelSurfaceConversionParameters();
+  vtkMTimeType labelmapMTime = orientedBinaryLabelmap->GetMTime();
+
+  // Update only the region of the surfaces that is affected by the modification of the labelmap if possible
+  bool surfacesUpdated = false;
+  if (cacheEntry.SurfaceNets && segmentation && cacheEntry.ConversionParameters == conversionParameters
+    && cacheEntry.SurfaceNets->GetInputLabelmap() == orientedBinaryLabelmap)
+    {
+    int modifiedExtent[6] = { 0, -1, 0, -1, 0, -1 };
+    if (segmentation->GetModifiedLabelmapExtent(orientedBinaryLabelmap, cacheEntry.LabelmapMTime, modifiedExtent))
+      {
+      surfacesUpdated = cacheEntry.SurfaceNets->UpdateModifiedExtent(modifiedExtent);
+      }
+    }
+  if (!surfacesUpdated)
+    {
+    // Extract surfaces of all labels in IJK coordinate system.
+    // Voxels outside the extent are treated as background, so no padding is needed.
+    cacheEntry.SurfaceNets = vtkSmartPointer<vtkMultiLabelSurfaceNets>::New();
+    cacheEntry.LabelmapSurfaces.clear();
+    cacheEntry.Surfaces.clear();
+    vtkMultiLabelSurfaceNets* surfaceNets = cacheEntry.SurfaceNets;
+    surfaceNets->SetInputLabelmap(orientedBinaryLabelmap);
+    // This maps smoothing factor 0.5 (default) to 20 iterations, same as the number of
+    // iterations of the windowed sinc filter.
+    surfaceNets->SetNumberOfSmoothingIterations(static_cast<int>(std::max(0.0, smoothingFactor) * 40.0 + 0.5));
+    if (!surfaceNets->Update())
+      {
+      vtkErrorMacro("UpdateMultiLabelClosedSurfaces: Failed to extract surfaces");
+      cacheEntry.SurfaceNets = nullptr;
+      return false;
+      }
+    }
+  cacheEntry.LabelmapMTime = labelmapMTime;
+  cacheEntry.ConversionParameters = conversionParameters;
+
+  // Surface nets replaces the output surfaces of changed labels, other surfaces can be kept
+  vtkMultiLabelSurfaceNets* surfaceNets = cacheEntry.SurfaceNets;
+  std::vector<int> labelValues = surfaceNets->GetOutputLabelValues();
+  std::vector<int> modifiedLabelValues;
+  std::map<int, vtkSmartPointer<vtkPolyData> > labelmapSurfaces;
+  std::map<int, vtkSmartPointer<vtkPolyData> > surfaces;
+  for (int labelValue : labelValues)
+    {
+    vtkPolyData* labelmapSurface = surfaceNets->GetOutput(labelValue);
+    labelmapSurfaces[labelValue] = labelmapSurface;
+    auto surfaceIt = cacheEntry.Surfaces.find(labelValue);
+    if (cacheEntry.LabelmapSurfaces[labelValue] == labelmapSurface && surfaceIt != cacheEntry.Surfaces.end())
+      {
+      surfaces[labelValue] = surfaceIt->second;
+      }
+    else
+      {
+      modifiedLabelValues.push_back(labelValue);
+      }
+    }
+
+  vtkSmartPointer<vtkMatrix4x4> labelmapImageToWorldMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+  orientedBinaryLabelmap->GetImageToWorldMatrix(labelmapImageToWorldMatrix);
+
+  // Decimate and transform the surfaces in parallel
+  std::vector<vtkSmartPointer<vtkPolyData> > modifiedSurfaces(modifiedLabelValues.size());
+  auto processSurfaces = [&](vtkIdType beginLabelIndex, vtkIdType endLabelIndex)
+    {
+    for (vtkIdType labelIndex = beginLabelIndex; labelIndex < endLabelIndex; ++labelIndex)
+      {
+      vtkSmartPointer<vtkPolyData> processingResult = surfaceNets->GetOutput(modifiedLabelValues[labelIndex]);
+      if (decimationFactor > 0.0)
+        {
+        processingResult = DecimateSurface(processingResult, decimationFactor);
+        }
+      modifiedSurfaces[labelIndex] = TransformSurfaceToWorld(processingResult, labelmapImageToWorldMatrix, computeSurfaceNormals > 0);
+      }
+    };
+  vtkSMPTools::For(0, static_cast<vtkIdType>(modifiedLabelValues.size()), processSurfaces);
+
+  for (size_t labelIndex = 0; labelIndex < modifiedLabelValues.size(); ++labelIndex)
+    {
+    surfaces[modifiedLabelValues[labelIndex]] = modifiedSurfaces[labelIndex];
+    }
+  cacheEntry.LabelmapSurfaces = labelmapSurfaces;
+  cacheEntry.Surfaces = surfaces;
   return true;
 }
 
 //----------------------------------------------------------------------------
-bool vtkBinaryLabelmapToClosedSurfaceConversionRule::PostConvert(vtkSegmentation* vtkNotUsed(segmentation))
+vtkSmartPointer<vtkPolyData> vtkBinaryLabelmapToClosedSurfaceConversionRule::GetJointSmoothedSurface(
+  vtkOrientedImageData* orientedBinaryLabelmap)
+{
+  std::map<vtkOrientedImageData*, vtkSmartPointer<vtkPolyData> >::iterator cacheIt =
+    this->JointSmoothCache.find(orientedBinaryLabelmap);
+  if (cacheIt != this->JointSmoothCache.end())
+    {
+    return cacheIt->second;
+    }
+  if (this->ConcurrentConvertPrepared)
+    {
+    // The cache must not be modified while segments are converted concurrently
+    return nullptr;
+    }
+
+  double* scalarRange = orientedBinaryLabelmap->GetScalarRange();
+  int lowLabel = (int)(floor(scalarRange[0]));
+  int highLabel = (int)(ceil(scalarRange[1]));
+
+  vtkNew<vtkImageAccumulate> imageAccumulate;
+  imageAccumulate->SetInputData(orientedBinaryLabelmap);
+  imageAccumulate->IgnoreZeroOn();
+  imageAccumulate->SetComponentOrigin(0, 0, 0);
+  imageAccumulate->SetComponentSpacing(1, 1, 1);
+  imageAccumulate->SetComponentExtent(lowLabel, highLabel, 0, 0, 0, 0);
+  imageAccumulate->Update();
+
+  std::vector<int> labelValues;
+  for (int labelValue = lowLabel; labelValue <= highLabel; ++labelValue)
+    {
+    // Add a new threshold for every level in the labelmap
+    double numberOfVoxels = imageAccumulate->GetOutput()->GetPointData()->GetScalars()->GetTuple1((int)labelValue - lowLabel);
+    if (numberOfVoxels > 0.0)
+      {
+      labelValues.push_back(labelValue);
+      }
+    }
+
+  vtkSmartPointer<vtkPolyData> jointSmoothedSurface = vtkSmartPointer<vtkPolyData>::New();
+  this->CreateClosedSurface(orientedBinaryLabelmap, jointSmoothedSurface, labelValues);
+  // The surface may be read by multiple threads, compute cached scalar range in advance
+  jointSmoothedSurface->GetScalarRange();
+
+  this->JointSmoothCache[orientedBinaryLabelmap] = jointSmoothedSurface;
+  return jointSmoothedSurface;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> vtkBinaryLabelmapToClosedSurfaceConversionRule::GetMultiLabelSurface(
+  vtkOrientedImageData* orientedBinaryLabelmap, int labelValue)
+{
+  auto cacheIt = this->MultiLabelSurfaceCache.find(orientedBinaryLabelmap);
+  if (cacheIt == this->MultiLabelSurfaceCache.end() || !cacheIt->second.SurfaceNets
+    || cacheIt->second.LabelmapMTime != orientedBinaryLabelmap->GetMTime()
+    || cacheIt->second.ConversionParameters != this->GetMultiLabelSurfaceConversionParameters())
+    {
+    if (this->ConcurrentConvertPrepared)
+      {
+      // The cache must not be modified while segments are converted concurrently
+      return nullptr;
+      }
+    MultiLabelSurfaceCacheEntry& cacheEntry = this->MultiLabelSurfaceCache[orientedBinaryLabelmap];
+    this->UpdateMultiLabelClosedSurfaces(orientedBinaryLabelmap, cacheEntry, this->ConvertedSegmentation);
+    cacheIt = this->MultiLabelSurfaceCache.find(orientedBinaryLabelmap);
+    }
+  auto surfaceIt = cacheIt->second.Surfaces.find(labelValue);
+  if (surfaceIt == cacheIt->second.Surfaces.end())
+    {
+    return nullptr;
+    }
+  return surfaceIt->second;
+}
+
+//----------------------------------------------------------------------------
+std::string vtkBinaryLabelmapToClosedSurfaceConversionRule::GetMultiLabelSurfaceConversionParameters()
+{
+  std::stringstream conversionParameters;
+  conversionParameters << this->ConversionParameters->GetValue(GetDecimationFactorParameterName()) << ";"
+    << this->ConversionParameters->GetValue(GetSmoothingFactorParameterName()) << ";"
+    << this->ConversionParameters->GetValue(GetComputeSurfaceNormalsParameterName());
+  return conversionParameters.str();
+}
+
+//----------------------------------------------------------------------------
+bool vtkBinaryLabelmapToClosedSurfaceConversionRule::PreConvert(vtkSegmentation* segmentation)
+{
+  this->ConvertedSegmentation = segmentation;
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkBinaryLabelmapToClosedSurfaceConversionRule::PrepareConcurrentConvert(
+  const std::vector<vtkSegment*>& segments, const std::vector<vtkSegment*>& workSegments)
+{
+  if (segments.size() != workSegments.size())
+    {
+    vtkErrorMacro("PrepareConcurrentConvert: Number of segments and work segments do not match");
+    return false;
+    }
+
+  double smoothingFactor = this->ConversionParameters->GetValueAsDouble(GetSmoothingFactorParameterName());
+  int jointSmoothing = this->ConversionParameters->GetValueAsInt(GetJointSmoothingParameterName());
+  int surfaceNets = this->ConversionParameters->GetValueAsInt(GetSurfaceNetsParameterName());
+
+  this->ConcurrentConvertSharedLabelmaps.clear();
+  for (size_t index = 0; index < segments.size(); ++index)
+    {
+    vtkOrientedImageData* sharedLabelmap = vtkOrientedImageData::SafeDownCast(
+      segments[index]->GetRepresentation(this->GetSourceRepresentationName()));
+    vtkOrientedImageData* labelmapCopy = vtkOrientedImageData::SafeDownCast(
+      workSegments[index]->GetRepresentation(this->GetSourceRepresentationName()));
+    if (!sharedLabelmap || !labelmapCopy)
+      {
+      // Convert reports the error
+      continue;
+      }
+    this->ConcurrentConvertSharedLabelmaps[labelmapCopy] = sharedLabelmap;
+
+    // Surfaces of each labelmap are computed once. Filters of the conversion are multithreaded.
+    if (surfaceNets > 0)
+      {
+      this->GetMultiLabelSurface(sharedLabelmap, segments[index]->GetLabelValue());
+      }
+    else if (jointSmoothing > 0 && smoothingFactor > 0)
+      {
+      this->GetJointSmoothedSurface(sharedLabelmap);
+      }
+    }
+
+  this->ConcurrentConvertPrepared = true;
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkBinaryLabelmapToClosedSurfaceConversionRule::PostConvert(vtkSegmentation* segmentation)
 {
   this->JointSmoothCache.clear();
+  this->ConvertedSegmentation = nullptr;
+  this->ConcurrentConvertPrepared = false;
+  this->ConcurrentConvertSharedLabelmaps.clear();
+
+  // Surface nets cache is kept for incremental updates, but only for labelmaps that are still in use
+  std::set<vtkOrientedImageData*> labelmaps;
+  if (segmentation)
+    {
+    std::vector<std::string> segmentIDs;
+    segmentation->GetSegmentIDs(segmentIDs);
+    for (const std::string& segmentID : segmentIDs)
+      {
+      labelmaps.insert(vtkOrientedImageData::SafeDownCast(
+        segmentation->GetSegment(segmentID)->GetRepresentation(this->GetSourceRepresentationName())));
+      }
+    }
+  for (auto cacheIt = this->MultiLabelSurfaceCache.begin(); cacheIt != this->MultiLabelSurfaceCache.end();)
+    {
+    if (labelmaps.find(cacheIt->first) == labelmaps.end())
+      {
+      cacheIt = this->MultiLabelSurfaceCache.erase(cacheIt);
+      }
+    else
+      {
+      ++cacheIt;
+      }
+    }
   return true;
 }
 
@@ -26,10 +26,14 @@
 #include "vtkSegmentationConverter.h"
 
 #include "vtkSegmentationCoreConfigure.h"
+#include "vtkMultiLabelSurfaceNets.h"
 
 // VTK includes
 #include <vtkPolyData.h>
 
+// STD includes
+#include <map>
+
 /// \ingroup SegmentationCore
 /// \brief Convert binary labelmap representation (vtkOrientedImageData type) to
 ///   closed surface representation (vtkPolyData type). The conversion algorithm
@@ -49,6 +53,10 @@ public:
   /// If joint smoothing is enabled, surfaces will be created and smoothed as one vtkPolyData.
   /// Joint smoothing converts all segments in shared labelmap together, reducing smoothing artifacts.
   static const std::string GetJointSmoothingParameterName() { return "Joint smoothing"; };
+  /// Conversion parameter: surface nets
+  /// If enabled, surfaces of all segments in a shared labelmap are extracted in a single pass using the
+  /// surface nets algorithm and smoothed together with constrained smoothing (joint smoothing is implied).
+  static const std::string GetSurfaceNetsParameterName() { return "Surface nets"; };
 
 public:
   static vtkBinaryLabelmapToClosedSurfaceConversionRule* New();
@@ -68,13 +76,27 @@ public:
   /// Perform the actual binary labelmap to closed surface conversion
   bool CreateClosedSurface(vtkOrientedImageData* inputImage, vtkPolyData* outputPolydata, std::vector<int> values);
 
+  /// Create closed surfaces of all labels of the labelmap in a single pass, using surface nets.
+  /// \param surfaces Output surfaces, mapped by label value
+  bool CreateMultiLabelClosedSurfaces(vtkOrientedImageData* inputImage, std::map<int, vtkSmartPointer<vtkPolyData> >& surfaces);
+
   /// Update the target representation based on the source representation
   bool Convert(vtkSegment* segment) override;
 
+  /// Store the segmentation to look up modified regions of its labelmaps
+  bool PreConvert(vtkSegmentation* segmentation) override;
+
   /// Perform postprocessing steps on the output
-  /// Clears the joint smoothing cache
+  /// Clears the joint smoothing cache and removes surface nets cache of labelmaps that are no longer in the segmentation
   bool PostConvert(vtkSegmentation* segmentation) override;
 
+  /// Segments can be converted concurrently. Each segment is converted from its own copy of the labelmap,
+  /// surfaces shared between segments are computed before the concurrent conversion.
+  bool IsThreadSafe() override { return true; };
+
+  /// Compute joint smoothed or multi-label surfaces of the shared labelmaps of the segments, so that Convert only reads the caches
+  bool PrepareConcurrentConvert(const std::vector<vtkSegment*>& segments, const std::vector<vtkSegment*>& workSegments) override;
+
   /// Get the cost of the conversion.
   unsigned int GetConversionCost(vtkDataObject* sourceRepresentation=nullptr, vtkDataObject* targetRepresentation=nullptr) override;
 
@@ -92,6 +114,42 @@ protected:
   /// This function checks whether this is the case.
   bool IsLabelmapPaddingNecessary(vtkImageData* binaryLabelMap);
 
+  /// Get surface of all segments of the labelmap from the joint smoothing cache.
+  /// The surface is computed if it is not in the cache yet, except during concurrent conversion,
+  /// when nullptr is returned instead.
+  vtkSmartPointer<vtkPolyData> GetJointSmoothedSurface(vtkOrientedImageData* orientedBinaryLabelmap);
+
+  /// Get surface of a label from the multi-label surface cache.
+  /// Surfaces of all labels are computed in a single pass if the labelmap is not in the cache yet.
+  /// If the labelmap was only modified in a known region since the cached surfaces were created
+  /// then only the affected part of the surfaces is updated.
+  /// Surfaces are not computed or updated during concurrent conversion.
+  /// Returns nullptr if the label has no surface.
+  vtkSmartPointer<vtkPolyData> GetMultiLabelSurface(vtkOrientedImageData* orientedBinaryLabelmap, int labelValue);
+
+  /// Surface nets state and surfaces of a labelmap, kept between conversions for incremental updates
+  struct MultiLabelSurfaceCacheEntry
+  {
+    vtkSmartPointer<vtkMultiLabelSurfaceNets> SurfaceNets;
+    /// Modified time of the labelmap when the surfaces were created
+    vtkMTimeType LabelmapMTime{ 0 };
+    /// Conversion parameters that the surfaces were created with
+    std::string ConversionParameters;
+    /// Surface nets output surfaces (in IJK coordinate system) that the final surfaces were created from
+    std::map<int, vtkSmartPointer<vtkPolyData> > LabelmapSurfaces;
+    /// Final surfaces (in world coordinate system) of each label
+    std::map<int, vtkSmartPointer<vtkPolyData> > Surfaces;
+  };
+
+  /// Conversion parameters that affect the surfaces created by surface nets, as a single string
+  std::string GetMultiLabelSurfaceConversionParameters();
+
+  /// Create or update the surfaces of all labels of the labelmap using surface nets.
+  /// If segmentation is specified and it contains the region of the labelmap that was modified since the surfaces
+  /// in the cache entry were created, then only the affected region and labels are updated.
+  bool UpdateMultiLabelClosedSurfaces(vtkOrientedImageData* orientedBinaryLabelmap, MultiLabelSurfaceCacheEntry& cacheEntry,
+    vtkSegmentation* segmentation);
+
 protected:
   vtkBinaryLabelmapToClosedSurfaceConversionRule();
   ~vtkBinaryLabelmapToClosedSurfaceConversionRule() override;
@@ -100,6 +158,16 @@ protected:
   /// Cache for storing merged closed surfaces that have been joint smoothed
   /// The key used is the binary labelmap representation, which maps to the combined vtkPolyData containing surfaces for all segments in the segmentation
   std::map<vtkOrientedImageData*, vtkSmartPointer<vtkPolyData> > JointSmoothCache;
+  /// Cache for storing surfaces created by surface nets for each binary labelmap representation.
+  /// Unlike the joint smoothing cache, it is kept between conversions.
+  std::map<vtkOrientedImageData*, MultiLabelSurfaceCacheEntry> MultiLabelSurfaceCache;
+  /// Segmentation that is being converted (between PreConvert and PostConvert)
+  vtkSegmentation* ConvertedSegmentation;
+  /// Set by PrepareConcurrentConvert until PostConvert. Caches are not modified in this state.
+  bool ConcurrentConvertPrepared;
+  /// Labelmap in the segmentation of each labelmap copy that is converted concurrently.
+  /// Cached surfaces are stored for the labelmap in the segmentation.
+  std::map<vtkOrientedImageData*, vtkOrientedImageData*> ConcurrentConvertSharedLabelmaps;
 
 private:
   vtkBinaryLabelmapToClosedSurfaceConversionRule(const vtkBinaryLabelmapToClosedSurfaceConversionRule&) = delete;
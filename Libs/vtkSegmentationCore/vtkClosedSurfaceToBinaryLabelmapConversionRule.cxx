@@ -36,18 +36,179 @@
 #include <vtkPolyData.h>
 #include <vtkTransform.h>
 #include <vtkTransformPolyDataFilter.h>
-#include <vtkImageCast.h>
-#include <vtkImageStencil.h>
+#include <vtkCellArray.h>
+#include <vtkImageStencilData.h>
+#include <vtkPoints.h>
 #include <vtkPolyDataNormals.h>
+#include <vtkSMPTools.h>
 #include <vtkStripper.h>
 #include <vtkTriangleFilter.h>
 #include <vtkPolyDataToImageStencil.h>
 
 // STD includes
+#include <algorithm>
+#include <cmath>
 #include <sstream>
+#include <vector>
 
 int DEFAULT_LABEL_VALUE = 1;
 
+namespace
+{
+// Number of slabs per thread. More slabs than threads balance the load better
+// (slabs through the middle of a surface take longer to rasterize).
+const int SLABS_PER_THREAD = 2;
+// Slabs thinner than this are not worth the per-slab stencil overhead
+const int MINIMUM_NUMBER_OF_SLICES_PER_SLAB = 4;
+
+//----------------------------------------------------------------------------
+// Add cells of the input cell array to the cell array of each slab that the cell may intersect.
+// The order of the cells is preserved, so each slab contains the same cut contours as the full surface would.
+void AddCellsToSlabs(vtkCellArray* cells, vtkPoints* points, const std::vector<int>& slabStartSlices, int lastSlice,
+  std::vector<vtkSmartPointer<vtkCellArray> >& slabCells)
+{
+  if (!cells || cells->GetNumberOfCells() == 0)
+    {
+    return;
+    }
+  int numberOfSlabs = static_cast<int>(slabStartSlices.size());
+  slabCells.resize(numberOfSlabs);
+  for (int slabIndex = 0; slabIndex < numberOfSlabs; ++slabIndex)
+    {
+    slabCells[slabIndex] = vtkSmartPointer<vtkCellArray>::New();
+    }
+
+  vtkIdType numberOfCellPoints = 0;
+  const vtkIdType* cellPointIds = nullptr;
+  double point[3] = { 0.0, 0.0, 0.0 };
+  for (cells->InitTraversal(); cells->GetNextCell(numberOfCellPoints, cellPointIds);)
+    {
+    if (numberOfCellPoints == 0)
+      {
+      continue;
+      }
+    double zMin = VTK_DOUBLE_MAX;
+    double zMax = VTK_DOUBLE_MIN;
+    for (vtkIdType i = 0; i < numberOfCellPoints; ++i)
+      {
+      points->GetPoint(cellPointIds[i], point);
+      zMin = std::min(zMin, point[2]);
+      zMax = std::max(zMax, point[2]);
+      }
+    // Slices are at integer z positions in IJK space. Use half a slice margin so that
+    // cells touching a slice within the cutter tolerance are never left out.
+    int firstSlice = std::max(static_cast<int>(std::ceil(zMin - 0.5)), slabStartSlices.front());
+    int lastCellSlice = std::min(static_cast<int>(std::floor(zMax + 0.5)), lastSlice);
+    if (firstSlice > lastCellSlice)
+      {
+      continue;
+      }
+    int firstSlab = static_cast<int>(std::upper_bound(slabStartSlices.begin(), slabStartSlices.end(), firstSlice) - slabStartSlices.begin()) - 1;
+    int lastSlab = static_cast<int>(std::upper_bound(slabStartSlices.begin(), slabStartSlices.end(), lastCellSlice) - slabStartSlices.begin()) - 1;
+    for (int slabIndex = firstSlab; slabIndex <= lastSlab; ++slabIndex)
+      {
+      slabCells[slabIndex]->InsertNextCell(numberOfCellPoints, cellPointIds);
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Rasterize a closed surface into an unsigned char labelmap that has identity geometry.
+// The labelmap is split into slabs along the z axis. Each slab is rasterized independently
+// from only the cells that intersect it, and written directly into its own slices of the labelmap.
+// The result is identical to rasterizing the whole surface with a single stencil.
+void RasterizeClosedSurface(vtkPolyData* ijkSurface, vtkImageData* labelmap, unsigned char labelValue)
+{
+  vtkPoints* points = ijkSurface->GetPoints();
+  if (!points || points->GetNumberOfPoints() == 0)
+    {
+    return;
+    }
+  // Compute bounds now, because bounds are computed lazily and cached, which is not thread-safe
+  points->GetBounds();
+
+  int extent[6] = { 0, -1, 0, -1, 0, -1 };
+  labelmap->GetExtent(extent);
+  if (extent[0] > extent[1] || extent[2] > extent[3] || extent[4] > extent[5])
+    {
+    return;
+    }
+
+  int numberOfSlices = extent[5] - extent[4] + 1;
+  int numberOfSlabs = std::max(1, std::min(vtkSMPTools::GetEstimatedNumberOfThreads() * SLABS_PER_THREAD,
+    numberOfSlices / MINIMUM_NUMBER_OF_SLICES_PER_SLAB));
+  std::vector<int> slabStartSlices(numberOfSlabs);
+  for (int slabIndex = 0; slabIndex < numberOfSlabs; ++slabIndex)
+    {
+    slabStartSlices[slabIndex] = extent[4] + static_cast<int>(static_cast<vtkIdType>(slabIndex) * numberOfSlices / numberOfSlabs);
+    }
+
+  // Per-slab edge tables
+  std::vector<vtkSmartPointer<vtkCellArray> > slabPolys;
+  std::vector<vtkSmartPointer<vtkCellArray> > slabStrips;
+  AddCellsToSlabs(ijkSurface->GetPolys(), points, slabStartSlices, extent[5], slabPolys);
+  AddCellsToSlabs(ijkSurface->GetStrips(), points, slabStartSlices, extent[5], slabStrips);
+
+  double spacing[3] = { 1.0, 1.0, 1.0 };
+  double origin[3] = { 0.0, 0.0, 0.0 };
+  labelmap->GetSpacing(spacing);
+  labelmap->GetOrigin(origin);
+
+  auto rasterizeSlabs = [&](vtkIdType beginSlab, vtkIdType endSlab)
+    {
+    for (vtkIdType slabIndex = beginSlab; slabIndex < endSlab; ++slabIndex)
+      {
+      vtkCellArray* polys = slabPolys.empty() ? nullptr : slabPolys[slabIndex].GetPointer();
+      vtkCellArray* strips = slabStrips.empty() ? nullptr : slabStrips[slabIndex].GetPointer();
+      if ((!polys || polys->GetNumberOfCells() == 0) && (!strips || strips->GetNumberOfCells() == 0))
+        {
+        // No surface in this slab
+        continue;
+        }
+
+      vtkNew<vtkPolyData> slabSurface;
+      slabSurface->SetPoints(points);
+      if (polys)
+        {
+        slabSurface->SetPolys(polys);
+        }
+      if (strips)
+        {
+        slabSurface->SetStrips(strips);
+        }
+
+      int slabExtent[6] = { extent[0], extent[1], extent[2], extent[3], slabStartSlices[slabIndex],
+        slabIndex + 1 < numberOfSlabs ? slabStartSlices[slabIndex + 1] - 1 : extent[5] };
+
+      vtkNew<vtkPolyDataToImageStencil> polyDataToImageStencil;
+      polyDataToImageStencil->SetInputData(slabSurface);
+      polyDataToImageStencil->SetOutputSpacing(spacing);
+      polyDataToImageStencil->SetOutputOrigin(origin);
+      polyDataToImageStencil->SetOutputWholeExtent(slabExtent);
+      polyDataToImageStencil->Update();
+      vtkImageStencilData* stencilData = polyDataToImageStencil->GetOutput();
+
+      // Fill the inside of the stencil. Slabs do not overlap, so they can be written concurrently.
+      for (int z = slabExtent[4]; z <= slabExtent[5]; ++z)
+        {
+        for (int y = slabExtent[2]; y <= slabExtent[3]; ++y)
+          {
+          int iter = 0;
+          int r1 = 0;
+          int r2 = 0;
+          while (stencilData->GetNextExtent(r1, r2, slabExtent[0], slabExtent[1], y, z, iter))
+            {
+            unsigned char* rowPtr = static_cast<unsigned char*>(labelmap->GetScalarPointer(r1, y, z));
+            std::fill(rowPtr, rowPtr + (r2 - r1 + 1), labelValue);
+            }
+          }
+        }
+      }
+    };
+  vtkSMPTools::For(0, numberOfSlabs, 1, rasterizeSlabs);
+}
+}
+
 //----------------------------------------------------------------------------
 vtkSegmentationConverterRuleNewMacro(vtkClosedSurfaceToBinaryLabelmapConversionRule);
 
@@ -218,29 +379,13 @@ bool vtkClosedSurfaceToBinaryLabelmapConversionRule::Convert(vtkSegment* segment
   // Convert to triangle strip
   vtkSmartPointer<vtkStripper> stripper=vtkSmartPointer<vtkStripper>::New();
   stripper->SetInputConnection(triangle->GetOutputPort());
+  stripper->Update();
 
-  // Convert polydata to stencil
-  vtkNew<vtkPolyDataToImageStencil> polyDataToImageStencil;
-  polyDataToImageStencil->SetInputConnection(stripper->GetOutputPort());
-  polyDataToImageStencil->SetOutputSpacing(binaryLabelmap->GetSpacing());
-  polyDataToImageStencil->SetOutputOrigin(binaryLabelmap->GetOrigin());
-  polyDataToImageStencil->SetOutputWholeExtent(binaryLabelmap->GetExtent());
-
-  // Convert stencil to image
-  vtkNew<vtkImageStencil> stencil;
-  stencil->SetInputData(binaryLabelmap);
-  stencil->SetStencilConnection(polyDataToImageStencil->GetOutputPort());
-  stencil->ReverseStencilOn();
+  // Convert polydata to stencil and fill it in the labelmap, slab by slab in parallel.
   // If the output labelmap was to required to be unsigned char, we could use the segment label value.
   // To ensure that the label value is < 255, we set it to 1. Collapsing the labelmaps during post-conversion may assign new a value regardless.
-  stencil->SetBackgroundValue(DEFAULT_LABEL_VALUE); // General foreground value is 1 (background value because of reverse stencil)
-
-  // Save result to output
-  vtkNew<vtkImageCast> imageCast;
-  imageCast->SetInputConnection(stencil->GetOutputPort());
-  imageCast->SetOutputScalarTypeToUnsignedChar();
-  imageCast->Update();
-  binaryLabelmap->ShallowCopy(imageCast->GetOutput());
+  RasterizeClosedSurface(stripper->GetOutput(), binaryLabelmap, static_cast<unsigned char>(DEFAULT_LABEL_VALUE));
+  binaryLabelmap->Modified();
 
   // Restore geometry of the labelmap that we set to identity before conversion
   // (so that we can perform the stencil operations in IJK space)
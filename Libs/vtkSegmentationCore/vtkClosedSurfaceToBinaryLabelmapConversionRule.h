@@ -32,7 +32,8 @@ class vtkPolyData;
 /// \ingroup SegmentationCore
 /// \brief Convert closed surface representation (vtkPolyData type) to binary
 ///   labelmap representation (vtkOrientedImageData type). The conversion algorithm
-///   is based on image stencil.
+///   is based on image stencil. The output is split into slabs along the z axis that are
+///   rasterized in parallel.
 class vtkSegmentationCore_EXPORT vtkClosedSurfaceToBinaryLabelmapConversionRule
   : public vtkSegmentationConverterRule
 {
@@ -69,6 +70,10 @@ public:
   /// Collapses the segments to as few labelmaps as is possible
   bool PostConvert(vtkSegmentation* segmentation) override;
 
+  /// Segments can be rasterized concurrently, unless the output geometry is taken from the
+  /// target representation, which is not available in the detached segments used for parallel conversion.
+  bool IsThreadSafe() override { return !this->UseOutputImageDataGeometry; };
+
   /// Get the cost of the conversion.
   unsigned int GetConversionCost(vtkDataObject* sourceRepresentation=nullptr, vtkDataObject* targetRepresentation=nullptr) override;
 
@@ -64,6 +64,9 @@ public:
   /// Overridden to prevent vtkClosedSurfaceToBinaryLabelmapConversionRule::PostConvert
   bool PostConvert(vtkSegmentation* vtkNotUsed(segmentation)) override { return true; };
 
+  /// Segments can be converted concurrently, the output geometry is always computed from the conversion parameters
+  bool IsThreadSafe() override { return true; };
+
   /// Get the cost of the conversion.
   unsigned int GetConversionCost(vtkDataObject* sourceRepresentation=nullptr, vtkDataObject* targetRepresentation=nullptr) override;
 
@@ -0,0 +1,139 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// SegmentationCore includes
+#include "vtkClosedSurfaceToSparseLabelmapConversionRule.h"
+#include "vtkOrientedImageData.h"
+#include "vtkSegment.h"
+#include "vtkSparseLabelmap.h"
+
+// VTK includes
+#include <vtkObjectFactory.h>
+#include <vtkPolyData.h>
+
+//----------------------------------------------------------------------------
+vtkSegmentationConverterRuleNewMacro(vtkClosedSurfaceToSparseLabelmapConversionRule);
+
+//----------------------------------------------------------------------------
+vtkClosedSurfaceToSparseLabelmapConversionRule::vtkClosedSurfaceToSparseLabelmapConversionRule()
+{
+  // Same parameters as the binary labelmap conversion, except for collapsing the
+  // labelmaps, as sparse labelmaps are always stored separately for each segment.
+  this->ClosedSurfaceToBinaryLabelmapRule->GetRuleConversionParameters(this->ConversionParameters);
+  int collapseParameterIndex = this->ConversionParameters->GetIndexFromName(
+    vtkClosedSurfaceToBinaryLabelmapConversionRule::GetCollapseLabelmapsParameterName());
+  if (collapseParameterIndex >= 0)
+    {
+    this->ConversionParameters->RemoveParameter(collapseParameterIndex);
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkClosedSurfaceToSparseLabelmapConversionRule::~vtkClosedSurfaceToSparseLabelmapConversionRule() = default;
+
+//----------------------------------------------------------------------------
+unsigned int vtkClosedSurfaceToSparseLabelmapConversionRule::GetConversionCost(
+  vtkDataObject* vtkNotUsed(sourceRepresentation)/*=nullptr*/,
+  vtkDataObject* vtkNotUsed(targetRepresentation)/*=nullptr*/)
+{
+  // Rough input-independent guess (ms). Less than converting through binary labelmap,
+  // so that the full labelmap is not kept just for getting the sparse labelmap.
+  return 520;
+}
+
+//----------------------------------------------------------------------------
+vtkDataObject* vtkClosedSurfaceToSparseLabelmapConversionRule::ConstructRepresentationObjectByRepresentation(std::string representationName)
+{
+  if ( !representationName.compare(this->GetSourceRepresentationName()) )
+    {
+    return (vtkDataObject*)vtkPolyData::New();
+    }
+  else if ( !representationName.compare(this->GetTargetRepresentationName()) )
+    {
+    return (vtkDataObject*)vtkSparseLabelmap::New();
+    }
+  else
+    {
+    return nullptr;
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkDataObject* vtkClosedSurfaceToSparseLabelmapConversionRule::ConstructRepresentationObjectByClass(std::string className)
+{
+  if (!className.compare("vtkPolyData"))
+    {
+    return (vtkDataObject*)vtkPolyData::New();
+    }
+  else if (!className.compare("vtkSparseLabelmap"))
+    {
+    return (vtkDataObject*)vtkSparseLabelmap::New();
+    }
+  else
+    {
+    return nullptr;
+    }
+}
+
+//----------------------------------------------------------------------------
+bool vtkClosedSurfaceToSparseLabelmapConversionRule::PreConvert(vtkSegmentation* vtkNotUsed(segmentation))
+{
+  int numberOfParameters = this->ConversionParameters->GetNumberOfParameters();
+  for (int parameterIndex = 0; parameterIndex < numberOfParameters; ++parameterIndex)
+    {
+    this->ClosedSurfaceToBinaryLabelmapRule->SetConversionParameter(
+      this->ConversionParameters->GetName(parameterIndex), this->ConversionParameters->GetValue(parameterIndex));
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkClosedSurfaceToSparseLabelmapConversionRule::Convert(vtkSegment* segment)
+{
+  this->CreateTargetRepresentation(segment);
+
+  vtkPolyData* closedSurfacePolyData = vtkPolyData::SafeDownCast(segment->GetRepresentation(this->GetSourceRepresentationName()));
+  if (!closedSurfacePolyData)
+    {
+    vtkErrorMacro("Convert: Source representation is not a poly data!");
+    return false;
+    }
+  vtkSparseLabelmap* sparseLabelmap = vtkSparseLabelmap::SafeDownCast(
+    segment->GetRepresentation(this->GetTargetRepresentationName()));
+  if (!sparseLabelmap)
+    {
+    vtkErrorMacro("Convert: Target representation is not a sparse labelmap!");
+    return false;
+    }
+
+  // Rasterize the surface in a temporary segment, the dense labelmap is released after encoding
+  vtkNew<vtkSegment> rasterizedSegment;
+  rasterizedSegment->AddRepresentation(this->GetSourceRepresentationName(), closedSurfacePolyData);
+  if (!this->ClosedSurfaceToBinaryLabelmapRule->Convert(rasterizedSegment))
+    {
+    return false;
+    }
+  vtkOrientedImageData* binaryLabelmap = vtkOrientedImageData::SafeDownCast(rasterizedSegment->GetRepresentation(
+    this->ClosedSurfaceToBinaryLabelmapRule->GetTargetRepresentationName()));
+  if (!binaryLabelmap || !sparseLabelmap->EncodeImage(binaryLabelmap, rasterizedSegment->GetLabelValue()))
+    {
+    vtkErrorMacro("Convert: Failed to encode rasterized labelmap");
+    return false;
+    }
+  segment->SetLabelValue(rasterizedSegment->GetLabelValue());
+
+  return true;
+}
@@ -0,0 +1,81 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkClosedSurfaceToSparseLabelmapConversionRule_h
+#define __vtkClosedSurfaceToSparseLabelmapConversionRule_h
+
+// SegmentationCore includes
+#include "vtkClosedSurfaceToBinaryLabelmapConversionRule.h"
+#include "vtkSegmentationConverterRule.h"
+#include "vtkSegmentationConverter.h"
+
+#include "vtkSegmentationCoreConfigure.h"
+
+/// \ingroup SegmentationCore
+/// \brief Convert closed surface representation (vtkPolyData type) to sparse
+///   labelmap representation (vtkSparseLabelmap type). The surface is rasterized
+///   with the closed surface to binary labelmap algorithm and the same conversion parameters,
+///   then the resulting labelmap is encoded, so only one segment is stored densely at a time.
+class vtkSegmentationCore_EXPORT vtkClosedSurfaceToSparseLabelmapConversionRule
+  : public vtkSegmentationConverterRule
+{
+public:
+  static vtkClosedSurfaceToSparseLabelmapConversionRule* New();
+  vtkTypeMacro(vtkClosedSurfaceToSparseLabelmapConversionRule, vtkSegmentationConverterRule);
+  vtkSegmentationConverterRule* CreateRuleInstance() override;
+
+  /// Constructs representation object from representation name for the supported representation classes
+  /// (typically source and target representation VTK classes, subclasses of vtkDataObject)
+  /// Note: Need to take ownership of the created object! For example using vtkSmartPointer<vtkDataObject>::Take
+  vtkDataObject* ConstructRepresentationObjectByRepresentation(std::string representationName) override;
+
+  /// Constructs representation object from class name for the supported representation classes
+  /// (typically source and target representation VTK classes, subclasses of vtkDataObject)
+  /// Note: Need to take ownership of the created object! For example using vtkSmartPointer<vtkDataObject>::Take
+  vtkDataObject* ConstructRepresentationObjectByClass(std::string className) override;
+
+  /// Pass the conversion parameters to the binary labelmap conversion rule
+  bool PreConvert(vtkSegmentation* segmentation) override;
+
+  /// Update the target representation based on the source representation
+  bool Convert(vtkSegment* segment) override;
+
+  /// Get the cost of the conversion.
+  unsigned int GetConversionCost(vtkDataObject* sourceRepresentation=nullptr, vtkDataObject* targetRepresentation=nullptr) override;
+
+  /// Human-readable name of the converter rule
+  const char* GetName() override { return "Closed surface to sparse labelmap"; };
+
+  /// Human-readable name of the source representation
+  const char* GetSourceRepresentationName() override { return vtkSegmentationConverter::GetSegmentationClosedSurfaceRepresentationName(); };
+
+  /// Human-readable name of the target representation
+  const char* GetTargetRepresentationName() override { return vtkSegmentationConverter::GetSegmentationSparseLabelmapRepresentationName(); };
+
+protected:
+  /// Rule that rasterizes the surface
+  vtkNew<vtkClosedSurfaceToBinaryLabelmapConversionRule> ClosedSurfaceToBinaryLabelmapRule;
+
+protected:
+  vtkClosedSurfaceToSparseLabelmapConversionRule();
+  ~vtkClosedSurfaceToSparseLabelmapConversionRule() override;
+
+private:
+  vtkClosedSurfaceToSparseLabelmapConversionRule(const vtkClosedSurfaceToSparseLabelmapConversionRule&) = delete;
+  void operator=(const vtkClosedSurfaceToSparseLabelmapConversionRule&) = delete;
+};
+
+#endif // __vtkClosedSurfaceToSparseLabelmapConversionRule_h
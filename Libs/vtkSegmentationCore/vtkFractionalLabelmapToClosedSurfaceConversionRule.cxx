@@ -34,6 +34,7 @@
 #include <vtkFieldData.h>
 #include <vtkDoubleArray.h>
 #include <vtkPolyDataNormals.h>
+#include <vtkPointData.h>
 
 // SegmentationCore includes
 #include "vtkFractionalLabelmapToClosedSurfaceConversionRule.h"
@@ -135,11 +136,12 @@ bool vtkFractionalLabelmapToClosedSurfaceConversionRule::Convert(vtkSegment* seg
     maximumValue = scalarRange->GetValue(1);
     }
 
-  // Pad labelmap if it has non-background border voxels
-  bool paddingNecessary = this->IsLabelmapPaddingNecessary(fractionalLabelMap);
-  if (paddingNecessary)
+  // Pad labelmap if it has non-background border voxels.
+  // Background of the quantized fractional labelmap is the minimum of the scalar range, not zero.
+  vtkSmartPointer<vtkOrientedImageData> paddedLabelmap;
+  if (this->IsFractionalLabelmapPaddingNecessary(fractionalLabelMap, minimumValue))
     {
-    vtkOrientedImageData* paddedLabelmap = vtkOrientedImageData::New();
+    paddedLabelmap = vtkSmartPointer<vtkOrientedImageData>::New();
     paddedLabelmap->DeepCopy(fractionalLabelMap);
     this->PadLabelmap(paddedLabelmap, minimumValue);
     fractionalLabelMap = paddedLabelmap;
@@ -170,17 +172,24 @@ bool vtkFractionalLabelmapToClosedSurfaceConversionRule::Convert(vtkSegment* seg
   identityMatrix->Identity();
   fractionalLabelmapWithIdentityGeometry->SetGeometryFromImageToWorldMatrix(identityMatrix);
 
-  // Resize the image with interpolation, this helps the conversion for structures with small labelmaps
-  vtkSmartPointer<vtkImageResize> imageResize = vtkSmartPointer<vtkImageResize>::New();
-  imageResize->SetInputData(fractionalLabelmapWithIdentityGeometry);
-  imageResize->BorderOn();
-  imageResize->SetResizeMethodToMagnificationFactors();
-  imageResize->SetMagnificationFactors(fractionalOversamplingFactor, fractionalOversamplingFactor, fractionalOversamplingFactor);
-  imageResize->InterpolateOn();
-
   // Run marching cubes
   vtkSmartPointer<vtkFlyingEdges3D> marchingCubes = vtkSmartPointer<vtkFlyingEdges3D>::New();
-  marchingCubes->SetInputConnection(imageResize->GetOutputPort());
+  if (fractionalOversamplingFactor != 1.0)
+    {
+    // Resize the image with interpolation, this helps the conversion for structures with small labelmaps
+    vtkSmartPointer<vtkImageResize> imageResize = vtkSmartPointer<vtkImageResize>::New();
+    imageResize->SetInputData(fractionalLabelmapWithIdentityGeometry);
+    imageResize->BorderOn();
+    imageResize->SetResizeMethodToMagnificationFactors();
+    imageResize->SetMagnificationFactors(fractionalOversamplingFactor, fractionalOversamplingFactor, fractionalOversamplingFactor);
+    imageResize->InterpolateOn();
+    marchingCubes->SetInputConnection(imageResize->GetOutputPort());
+    }
+  else
+    {
+    // Contour the quantized values directly, the threshold is mapped to the scalar range
+    marchingCubes->SetInputData(fractionalLabelmapWithIdentityGeometry);
+    }
   marchingCubes->SetNumberOfContours(1);
   marchingCubes->SetValue(0, (fractionalThreshold * (maximumValue - minimumValue)) + minimumValue);
   marchingCubes->ComputeScalarsOff();
@@ -275,13 +284,69 @@ bool vtkFractionalLabelmapToClosedSurfaceConversionRule::Convert(vtkSegment* seg
   // Set output
   closedSurfacePolyData->ShallowCopy(convertedSegment);
 
-  // Delete temporary padded labelmap if it was created
-  if (paddingNecessary)
+  return true;
+}
+
+//----------------------------------------------------------------------------
+template <class ImageScalarType>
+bool IsFractionalLabelmapPaddingNecessaryGeneric(vtkImageData* fractionalLabelMap, double backgroundValue)
+{
+  int extent[6] = { 0, -1, 0, -1, 0, -1 };
+  fractionalLabelMap->GetExtent(extent);
+  vtkIdType increments[3] = { 0, 0, 0 };
+  fractionalLabelMap->GetIncrements(increments);
+  ImageScalarType* imagePtr = static_cast<ImageScalarType*>(fractionalLabelMap->GetScalarPointerForExtent(extent));
+  for (int k = extent[4]; k <= extent[5]; ++k)
+    {
+    bool borderSlice = (k == extent[4] || k == extent[5]);
+    for (int j = extent[2]; j <= extent[3]; ++j)
+      {
+      ImageScalarType* rowPtr = imagePtr + (k - extent[4]) * increments[2] + (j - extent[2]) * increments[1];
+      if (borderSlice || j == extent[2] || j == extent[3])
+        {
+        // Entire row is on the border
+        for (int i = extent[0]; i <= extent[1]; ++i)
+          {
+          if (rowPtr[i - extent[0]] > backgroundValue)
+            {
+            return true;
+            }
+          }
+        }
+      else if (rowPtr[0] > backgroundValue || rowPtr[extent[1] - extent[0]] > backgroundValue)
+        {
+        // Only the first and last voxels of the row are on the border
+        return true;
+        }
+      }
+    }
+  return false;
+}
+
+//----------------------------------------------------------------------------
+bool vtkFractionalLabelmapToClosedSurfaceConversionRule::IsFractionalLabelmapPaddingNecessary(
+  vtkImageData* fractionalLabelMap, double backgroundValue)
+{
+  if (!fractionalLabelMap || !fractionalLabelMap->GetPointData()->GetScalars())
     {
-    fractionalLabelMap->Delete();
+    return false;
+    }
+  int extent[6] = { 0, -1, 0, -1, 0, -1 };
+  fractionalLabelMap->GetExtent(extent);
+  if (extent[0] > extent[1] || extent[2] > extent[3] || extent[4] > extent[5])
+    {
+    return false;
     }
 
-  return true;
+  bool paddingNecessary = false;
+  switch (fractionalLabelMap->GetScalarType())
+    {
+    vtkTemplateMacro(paddingNecessary = IsFractionalLabelmapPaddingNecessaryGeneric<VTK_TT>(fractionalLabelMap, backgroundValue));
+    default:
+      vtkErrorMacro("IsFractionalLabelmapPaddingNecessary: Unknown image scalar type!");
+      return false;
+    }
+  return paddingNecessary;
 }
 
 //----------------------------------------------------------------------------
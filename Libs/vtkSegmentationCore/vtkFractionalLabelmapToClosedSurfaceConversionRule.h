@@ -76,6 +76,12 @@ protected:
   /// \param paddingConstant The value that is used to fill the new voxels
   void PadLabelmap(vtkOrientedImageData* fractionalLabelMap, double paddingConstant);
 
+  /// Determine if the labelmap has voxels above the background value on its border.
+  /// Only the border voxels are visited.
+  /// \param fractionalLabelMap The fractional labelmap in its stored (quantized) form
+  /// \param backgroundValue Minimum value of the scalar range of the fractional labelmap
+  bool IsFractionalLabelmapPaddingNecessary(vtkImageData* fractionalLabelMap, double backgroundValue);
+
 protected:
   vtkFractionalLabelmapToClosedSurfaceConversionRule();
   ~vtkFractionalLabelmapToClosedSurfaceConversionRule() override;
@@ -0,0 +1,444 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// SegmentationCore includes
+#include "vtkLabelmapMetadata.h"
+#include "vtkOrientedImageData.h"
+
+// VTK includes
+#include <vtkObjectFactory.h>
+#include <vtkSMPTools.h>
+
+// STD includes
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+
+vtkStandardNewMacro(vtkLabelmapMetadata);
+
+namespace
+{
+
+/// Images with more distinct values (such as intensity images) are not considered labelmaps
+const size_t MAXIMUM_NUMBER_OF_LABELS = 4096;
+
+/// Small regions (such as a paint brush stroke) are faster to scan without the overhead of starting threads
+const vtkIdType MINIMUM_NUMBER_OF_VOXELS_FOR_PARALLEL_SCAN = 64 * 1024;
+
+//----------------------------------------------------------------------------
+bool IsExtentValid(const int extent[6])
+{
+  return extent[0] <= extent[1] && extent[2] <= extent[3] && extent[4] <= extent[5];
+}
+
+//----------------------------------------------------------------------------
+bool IsExtentInside(const int innerExtent[6], const int outerExtent[6])
+{
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    if (innerExtent[2 * axis] < outerExtent[2 * axis] || innerExtent[2 * axis + 1] > outerExtent[2 * axis + 1])
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+/// Grow the extent of the label to contain the given extent
+void ExpandLabelExtent(vtkLabelmapMetadata::LabelInfo& info, const int extent[6])
+{
+  if (!IsExtentValid(info.Extent))
+    {
+    std::copy(extent, extent + 6, info.Extent);
+    return;
+    }
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    info.Extent[2 * axis] = std::min(info.Extent[2 * axis], extent[2 * axis]);
+    info.Extent[2 * axis + 1] = std::max(info.Extent[2 * axis + 1], extent[2 * axis + 1]);
+    }
+}
+
+//----------------------------------------------------------------------------
+template <class ImageScalarType>
+bool ComputeLabelInfoGeneric(vtkImageData* image, const int extent[6], vtkLabelmapMetadata::LabelInfoMap& labels)
+{
+  ImageScalarType* extentStartPtr = static_cast<ImageScalarType*>(image->GetScalarPointerForExtent(const_cast<int*>(extent)));
+  if (!extentStartPtr)
+    {
+    return false;
+    }
+  vtkIdType incX = 0;
+  vtkIdType incY = 0;
+  vtkIdType incZ = 0;
+  image->GetIncrements(incX, incY, incZ);
+  const int rowLength = extent[1] - extent[0] + 1;
+
+  // Ranges of slices are processed in parallel, their label information is combined at the end.
+  // Consecutive voxels of the same value in a row are processed together, as labelmaps typically consist of long runs.
+  std::mutex labelsMutex;
+  std::atomic<bool> tooManyLabels(false);
+  auto scanSlices = [&](vtkIdType beginSlice, vtkIdType endSlice)
+    {
+    vtkLabelmapMetadata::LabelInfoMap rangeLabels;
+    vtkLabelmapMetadata::LabelInfo* currentInfo = nullptr;
+    ImageScalarType currentValue = 0;
+    for (vtkIdType slice = beginSlice; slice < endSlice; ++slice)
+      {
+      if (tooManyLabels)
+        {
+        return;
+        }
+      int k = extent[4] + static_cast<int>(slice);
+      for (int j = extent[2]; j <= extent[3]; ++j)
+        {
+        const ImageScalarType* rowPtr = extentStartPtr + slice * incZ + (j - extent[2]) * incY;
+        int i = 0;
+        while (i < rowLength)
+          {
+          ImageScalarType value = rowPtr[i];
+          if (value == 0)
+            {
+            ++i;
+            continue;
+            }
+          int runStart = i;
+          while (i + 1 < rowLength && rowPtr[i + 1] == value)
+            {
+            ++i;
+            }
+          if (!currentInfo || value != currentValue)
+            {
+            currentInfo = &rangeLabels[static_cast<vtkTypeInt64>(value)];
+            currentValue = value;
+            if (rangeLabels.size() > MAXIMUM_NUMBER_OF_LABELS)
+              {
+              tooManyLabels = true;
+              return;
+              }
+            }
+          int runExtent[6] = { extent[0] + runStart, extent[0] + i, j, j, k, k };
+          ExpandLabelExtent(*currentInfo, runExtent);
+          currentInfo->NumberOfVoxels += i - runStart + 1;
+          ++i;
+          }
+        }
+      }
+    std::lock_guard<std::mutex> lock(labelsMutex);
+    for (const auto& rangeLabel : rangeLabels)
+      {
+      vtkLabelmapMetadata::LabelInfo& info = labels[rangeLabel.first];
+      ExpandLabelExtent(info, rangeLabel.second.Extent);
+      info.NumberOfVoxels += rangeLabel.second.NumberOfVoxels;
+      }
+    if (labels.size() > MAXIMUM_NUMBER_OF_LABELS)
+      {
+      tooManyLabels = true;
+      }
+    };
+
+  vtkIdType numberOfSlices = extent[5] - extent[4] + 1;
+  vtkIdType numberOfVoxels = numberOfSlices * (extent[3] - extent[2] + 1) * rowLength;
+  if (numberOfVoxels < MINIMUM_NUMBER_OF_VOXELS_FOR_PARALLEL_SCAN)
+    {
+    scanSlices(0, numberOfSlices);
+    }
+  else
+    {
+    vtkSMPTools::For(0, numberOfSlices, scanSlices);
+    }
+  return !tooManyLabels;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+vtkLabelmapMetadata::vtkLabelmapMetadata() = default;
+
+//----------------------------------------------------------------------------
+vtkLabelmapMetadata::~vtkLabelmapMetadata() = default;
+
+//----------------------------------------------------------------------------
+void vtkLabelmapMetadata::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Labelmap: " << (this->Labelmap ? "true" : "false") << "\n";
+  os << indent << "LabelmapMTime: " << this->LabelmapMTime << "\n";
+  os << indent << "NumberOfLabels: " << this->Labels.size() << "\n";
+  for (const auto& label : this->Labels)
+    {
+    const LabelInfo& info = label.second;
+    os << indent.GetNextIndent() << label.first << ": " << info.NumberOfVoxels << " voxels, extent: "
+      << info.Extent[0] << ", " << info.Extent[1] << ", " << info.Extent[2] << ", "
+      << info.Extent[3] << ", " << info.Extent[4] << ", " << info.Extent[5]
+      << (info.ExtentExact ? "" : " (not exact)") << "\n";
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkLabelmapMetadata::DeepCopy(vtkLabelmapMetadata* source)
+{
+  if (!source || source == this)
+    {
+    return;
+    }
+  this->Labels = source->Labels;
+  this->Labelmap = source->Labelmap;
+  this->LabelmapMTime = source->LabelmapMTime;
+  std::copy(source->LabelmapExtent, source->LabelmapExtent + 6, this->LabelmapExtent);
+  this->LabelmapScalarPointer = source->LabelmapScalarPointer;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+bool vtkLabelmapMetadata::ComputeLabelInfo(vtkImageData* image, const int extent[6], LabelInfoMap& labels)
+{
+  labels.clear();
+  if (!image || !extent || image->GetNumberOfScalarComponents() != 1 || !image->GetScalarPointer())
+    {
+    return false;
+    }
+
+  int* imageExtent = image->GetExtent();
+  int scanExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    scanExtent[2 * axis] = std::max(extent[2 * axis], imageExtent[2 * axis]);
+    scanExtent[2 * axis + 1] = std::min(extent[2 * axis + 1], imageExtent[2 * axis + 1]);
+    }
+  if (!IsExtentValid(scanExtent))
+    {
+    // no voxels to scan
+    return true;
+    }
+
+  switch (image->GetScalarType())
+    {
+    case VTK_CHAR: return ComputeLabelInfoGeneric<char>(image, scanExtent, labels);
+    case VTK_SIGNED_CHAR: return ComputeLabelInfoGeneric<signed char>(image, scanExtent, labels);
+    case VTK_UNSIGNED_CHAR: return ComputeLabelInfoGeneric<unsigned char>(image, scanExtent, labels);
+    case VTK_SHORT: return ComputeLabelInfoGeneric<short>(image, scanExtent, labels);
+    case VTK_UNSIGNED_SHORT: return ComputeLabelInfoGeneric<unsigned short>(image, scanExtent, labels);
+    case VTK_INT: return ComputeLabelInfoGeneric<int>(image, scanExtent, labels);
+    case VTK_UNSIGNED_INT: return ComputeLabelInfoGeneric<unsigned int>(image, scanExtent, labels);
+    default:
+      // floating-point and 64-bit images are not used as labelmaps
+      return false;
+    }
+}
+
+//----------------------------------------------------------------------------
+bool vtkLabelmapMetadata::Compute(vtkOrientedImageData* labelmap)
+{
+  this->Labels.clear();
+  this->Labelmap = false;
+  if (!labelmap)
+    {
+    return false;
+    }
+  this->Labelmap = vtkLabelmapMetadata::ComputeLabelInfo(labelmap, labelmap->GetExtent(), this->Labels);
+  if (!this->Labelmap)
+    {
+    this->Labels.clear();
+    }
+  this->SetUpToDate(labelmap);
+  return this->Labelmap;
+}
+
+//----------------------------------------------------------------------------
+bool vtkLabelmapMetadata::UpdateRegion(vtkOrientedImageData* labelmap, const int extent[6], const LabelInfoMap& labelsBefore)
+{
+  LabelInfoMap labelsAfter;
+  if (!labelmap || !this->Labelmap || !vtkLabelmapMetadata::ComputeLabelInfo(labelmap, extent, labelsAfter))
+    {
+    // The metadata does not describe the labelmap anymore, it will be recomputed when requested
+    this->Labels.clear();
+    this->Labelmap = false;
+    this->LabelmapMTime = 0;
+    return false;
+    }
+
+  for (const auto& labelBefore : labelsBefore)
+    {
+    LabelInfo& info = this->Labels[labelBefore.first];
+    info.NumberOfVoxels -= labelBefore.second.NumberOfVoxels;
+    // If the label remained present in the whole extent it occupied in the region then the overall extent
+    // of the label cannot shrink. Otherwise the extent is kept as an upper bound until it is needed.
+    auto labelAfterIt = labelsAfter.find(labelBefore.first);
+    if (labelAfterIt == labelsAfter.end() || !IsExtentInside(labelBefore.second.Extent, labelAfterIt->second.Extent))
+      {
+      info.ExtentExact = false;
+      }
+    }
+  for (const auto& labelAfter : labelsAfter)
+    {
+    LabelInfo& info = this->Labels[labelAfter.first];
+    info.NumberOfVoxels += labelAfter.second.NumberOfVoxels;
+    ExpandLabelExtent(info, labelAfter.second.Extent);
+    }
+  for (auto labelIt = this->Labels.begin(); labelIt != this->Labels.end();)
+    {
+    if (labelIt->second.NumberOfVoxels <= 0)
+      {
+      labelIt = this->Labels.erase(labelIt);
+      }
+    else
+      {
+      ++labelIt;
+      }
+    }
+  if (this->Labels.size() > MAXIMUM_NUMBER_OF_LABELS)
+    {
+    this->Labels.clear();
+    this->Labelmap = false;
+    }
+
+  this->SetUpToDate(labelmap);
+  return this->Labelmap;
+}
+
+//----------------------------------------------------------------------------
+void vtkLabelmapMetadata::UpdateLabelExtents(vtkOrientedImageData* labelmap)
+{
+  if (!labelmap)
+    {
+    return;
+    }
+  for (auto labelIt = this->Labels.begin(); labelIt != this->Labels.end();)
+    {
+    LabelInfo& info = labelIt->second;
+    if (info.ExtentExact)
+      {
+      ++labelIt;
+      continue;
+      }
+    // All voxels of the label are in its current extent, so its exact extent is found by scanning only that region
+    LabelInfoMap labelsInExtent;
+    vtkLabelmapMetadata::ComputeLabelInfo(labelmap, info.Extent, labelsInExtent);
+    auto labelInExtentIt = labelsInExtent.find(labelIt->first);
+    if (labelInExtentIt == labelsInExtent.end())
+      {
+      labelIt = this->Labels.erase(labelIt);
+      continue;
+      }
+    std::copy(labelInExtentIt->second.Extent, labelInExtentIt->second.Extent + 6, info.Extent);
+    info.ExtentExact = true;
+    ++labelIt;
+    }
+}
+
+//----------------------------------------------------------------------------
+bool vtkLabelmapMetadata::IsUpToDate(vtkOrientedImageData* labelmap)
+{
+  if (!labelmap || this->LabelmapMTime == 0)
+    {
+    return false;
+    }
+  int* extent = labelmap->GetExtent();
+  return this->LabelmapMTime == labelmap->GetMTime()
+    && std::equal(extent, extent + 6, this->LabelmapExtent)
+    && this->LabelmapScalarPointer == labelmap->GetScalarPointer();
+}
+
+//----------------------------------------------------------------------------
+void vtkLabelmapMetadata::SetUpToDate(vtkOrientedImageData* labelmap)
+{
+  if (!labelmap)
+    {
+    return;
+    }
+  this->LabelmapMTime = labelmap->GetMTime();
+  labelmap->GetExtent(this->LabelmapExtent);
+  this->LabelmapScalarPointer = labelmap->GetScalarPointer();
+}
+
+//----------------------------------------------------------------------------
+void vtkLabelmapMetadata::GetLabelValues(std::vector<int>& labelValues)
+{
+  labelValues.clear();
+  for (const auto& label : this->Labels)
+    {
+    labelValues.push_back(static_cast<int>(label.first));
+    }
+}
+
+//----------------------------------------------------------------------------
+bool vtkLabelmapMetadata::IsLabelPresent(int labelValue)
+{
+  return this->Labels.find(labelValue) != this->Labels.end();
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkLabelmapMetadata::GetNumberOfVoxels(int labelValue)
+{
+  auto labelIt = this->Labels.find(labelValue);
+  if (labelIt == this->Labels.end())
+    {
+    return 0;
+    }
+  return labelIt->second.NumberOfVoxels;
+}
+
+//----------------------------------------------------------------------------
+bool vtkLabelmapMetadata::GetLabelExtent(int labelValue, int extent[6])
+{
+  auto labelIt = this->Labels.find(labelValue);
+  if (labelIt == this->Labels.end())
+    {
+    return false;
+    }
+  std::copy(labelIt->second.Extent, labelIt->second.Extent + 6, extent);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+vtkTypeInt64 vtkLabelmapMetadata::GetMaximumLabelValue()
+{
+  if (this->Labels.empty())
+    {
+    return 0;
+    }
+  return this->Labels.rbegin()->first;
+}
+
+//----------------------------------------------------------------------------
+bool vtkLabelmapMetadata::GetEffectiveExtent(int effectiveExtent[6], double threshold/*=0.0*/)
+{
+  // Empty effective extent is returned the same way as by vtkOrientedImageDataResample::CalculateEffectiveExtent
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    effectiveExtent[2 * axis] = this->LabelmapExtent[2 * axis + 1] + 1;
+    effectiveExtent[2 * axis + 1] = this->LabelmapExtent[2 * axis] - 1;
+    }
+  if (threshold < 0.0)
+    {
+    return false;
+    }
+  bool effectiveExtentValid = false;
+  for (auto labelIt = this->Labels.upper_bound(static_cast<vtkTypeInt64>(std::floor(threshold))); labelIt != this->Labels.end(); ++labelIt)
+    {
+    const int* labelExtent = labelIt->second.Extent;
+    for (int axis = 0; axis < 3; ++axis)
+      {
+      effectiveExtent[2 * axis] = effectiveExtentValid ? std::min(effectiveExtent[2 * axis], labelExtent[2 * axis]) : labelExtent[2 * axis];
+      effectiveExtent[2 * axis + 1] = effectiveExtentValid ? std::max(effectiveExtent[2 * axis + 1], labelExtent[2 * axis + 1]) : labelExtent[2 * axis + 1];
+      }
+    effectiveExtentValid = true;
+    }
+  return effectiveExtentValid;
+}
@@ -0,0 +1,129 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkLabelmapMetadata_h
+#define __vtkLabelmapMetadata_h
+
+// Segmentation includes
+#include "vtkSegmentationCoreConfigure.h"
+
+// VTK includes
+#include <vtkObject.h>
+
+// STD includes
+#include <map>
+#include <vector>
+
+class vtkImageData;
+class vtkOrientedImageData;
+
+/// \ingroup SegmentationCore
+/// \brief Voxel count and extent of each label value in a labelmap
+///
+/// The metadata describes the content of a labelmap at a given modification time of the labelmap.
+/// It is stored in vtkOrientedImageData (see vtkOrientedImageData::GetLabelmapMetadata) and kept
+/// up-to-date by the merge and modify operations of vtkOrientedImageDataResample, which only rescan
+/// the modified region. If the labelmap is modified by any other means then the metadata is
+/// recomputed by scanning the whole labelmap the next time it is requested.
+///
+/// Only single-component integer images that contain a limited number of distinct values
+/// are considered labelmaps. Voxels with zero value are background and are not counted.
+class vtkSegmentationCore_EXPORT vtkLabelmapMetadata : public vtkObject
+{
+public:
+  /// Number of voxels and IJK extent of a label value
+  struct LabelInfo
+    {
+    vtkIdType NumberOfVoxels{ 0 };
+    int Extent[6]{ 0, -1, 0, -1, 0, -1 };
+    /// The extent may be larger than the actual extent of the label after voxels of the label were removed.
+    /// It is made exact by rescanning the extent of the label when it is needed, see UpdateLabelExtents.
+    bool ExtentExact{ true };
+    };
+  typedef std::map<vtkTypeInt64, LabelInfo> LabelInfoMap;
+
+public:
+  static vtkLabelmapMetadata* New();
+  vtkTypeMacro(vtkLabelmapMetadata, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  /// Copy the label information and the labelmap state it describes
+  void DeepCopy(vtkLabelmapMetadata* source);
+
+  /// Get the label information of the labelmap in the specified extent.
+  /// Large extents are scanned in parallel.
+  /// Returns false if the image is not a labelmap or it contains too many distinct values.
+  static bool ComputeLabelInfo(vtkImageData* image, const int extent[6], LabelInfoMap& labels);
+
+  /// Recompute the metadata by scanning the whole labelmap.
+  /// Returns false if the image is not a labelmap.
+  bool Compute(vtkOrientedImageData* labelmap);
+
+  /// Update the metadata after voxels of the labelmap were changed in the specified extent.
+  /// \param labelsBefore Label information of the extent before the change, see ComputeLabelInfo.
+  /// Returns false if the metadata could not be updated.
+  bool UpdateRegion(vtkOrientedImageData* labelmap, const int extent[6], const LabelInfoMap& labelsBefore);
+
+  /// Make extents of all labels exact by rescanning only the extents of labels that had voxels removed
+  void UpdateLabelExtents(vtkOrientedImageData* labelmap);
+
+  /// Returns true if the metadata describes the current content of the labelmap
+  bool IsUpToDate(vtkOrientedImageData* labelmap);
+  /// Mark the metadata as describing the current content of the labelmap
+  void SetUpToDate(vtkOrientedImageData* labelmap);
+  /// Returns true if the labelmap was found to be a labelmap when the metadata was last computed
+  bool IsLabelmap() { return this->Labelmap; };
+
+  /// Get all label information
+  const LabelInfoMap& GetLabels() { return this->Labels; };
+  /// Get the number of distinct non-zero label values
+  int GetNumberOfLabels() { return static_cast<int>(this->Labels.size()); };
+  /// Get the non-zero label values in ascending order
+  void GetLabelValues(std::vector<int>& labelValues);
+  /// Returns true if there is at least one voxel with the label value
+  bool IsLabelPresent(int labelValue);
+  /// Get the number of voxels with the label value
+  vtkIdType GetNumberOfVoxels(int labelValue);
+  /// Get the extent of the voxels with the label value. Returns false if the label is not present.
+  bool GetLabelExtent(int labelValue, int extent[6]);
+  /// Get the largest label value, 0 if there are no labels
+  vtkTypeInt64 GetMaximumLabelValue();
+
+  /// Get the extent of voxels that have a value above the threshold, same as
+  /// vtkOrientedImageDataResample::CalculateEffectiveExtent.
+  /// Returns false if the effective extent is empty or the threshold is negative (zero voxels are not tracked).
+  bool GetEffectiveExtent(int effectiveExtent[6], double threshold = 0.0);
+
+protected:
+  /// Number of voxels and extent of each non-zero label value
+  LabelInfoMap Labels;
+
+  /// State of the labelmap that the metadata describes
+  bool Labelmap{ false };
+  vtkMTimeType LabelmapMTime{ 0 };
+  int LabelmapExtent[6]{ 0, -1, 0, -1, 0, -1 };
+  void* LabelmapScalarPointer{ nullptr };
+
+protected:
+  vtkLabelmapMetadata();
+  ~vtkLabelmapMetadata() override;
+
+private:
+  vtkLabelmapMetadata(const vtkLabelmapMetadata&) = delete;
+  void operator=(const vtkLabelmapMetadata&) = delete;
+};
+
+#endif // __vtkLabelmapMetadata_h
@@ -0,0 +1,903 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// SegmentationCore includes
+#include "vtkMultiLabelSurfaceNets.h"
+
+// VTK includes
+#include <vtkCellArray.h>
+#include <vtkFloatArray.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSMPTools.h>
+
+// STD includes
+#include <algorithm>
+#include <array>
+#include <tuple>
+#include <unordered_map>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+/// Maps voxel values to label values. Values that are not selected are mapped to background (0).
+class LabelSelector
+{
+public:
+  LabelSelector(const std::vector<int>& labelValues)
+  {
+    if (labelValues.empty())
+      {
+      return;
+      }
+    this->AllLabels = false;
+    this->Minimum = *std::min_element(labelValues.begin(), labelValues.end());
+    int maximum = *std::max_element(labelValues.begin(), labelValues.end());
+    this->Selected.resize(static_cast<size_t>(static_cast<long long>(maximum) - this->Minimum + 1), 0);
+    for (int labelValue : labelValues)
+      {
+      this->Selected[static_cast<size_t>(static_cast<long long>(labelValue) - this->Minimum)] = 1;
+      }
+  }
+
+  int operator()(int value) const
+  {
+    if (this->AllLabels)
+      {
+      return value;
+      }
+    long long index = static_cast<long long>(value) - this->Minimum;
+    if (index < 0 || index >= static_cast<long long>(this->Selected.size()))
+      {
+      return 0;
+      }
+    return this->Selected[static_cast<size_t>(index)] ? value : 0;
+  }
+
+protected:
+  bool AllLabels{ true };
+  int Minimum{ 0 };
+  std::vector<char> Selected;
+};
+
+//----------------------------------------------------------------------------
+/// Pack the IJK index of a dual grid cell into a single key. Each index must be in [-2^20, 2^20).
+long long GetCellKey(int i, int j, int k)
+{
+  const long long offset = 1 << 20;
+  return ((static_cast<long long>(k) + offset) << 42) | ((static_cast<long long>(j) + offset) << 21)
+    | (static_cast<long long>(i) + offset);
+}
+
+//----------------------------------------------------------------------------
+/// Integer division rounding towards negative infinity
+int FloorDivide(int value, int divisor)
+{
+  return (value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor));
+}
+
+//----------------------------------------------------------------------------
+/// Points and quads generated for one layer of the dual grid.
+/// Dual grid cell (ci, cj, ck) is the 2x2x2 voxel neighborhood of voxels (ci-1..ci, cj-1..cj, ck-1..ck).
+struct SurfaceNetsLayer
+{
+  std::vector<float> Points;
+  /// Key of the dual grid cell of each point in absolute IJK indices
+  std::vector<long long> PointKeys;
+  std::vector<unsigned char> PointLabelCounts;
+  /// 4 point IDs per quad. Non-negative values are indices of points of this layer,
+  /// negative values refer to points of the previous layer as -(index+1).
+  std::vector<vtkIdType> QuadPointIds;
+  /// Inside and outside label of each quad. Quad normal points from inside to outside.
+  std::vector<int> QuadLabels;
+  /// Absolute IJK index of the voxel that owns the quad (the voxel on the positive side of the face).
+  std::vector<int> QuadOwners;
+};
+
+//----------------------------------------------------------------------------
+template<class ScalarType>
+class SurfaceNetsExtractor
+{
+public:
+  /// Extract quads from the voxels of the image within the region extent. Voxels outside the region are
+  /// considered background.
+  SurfaceNetsExtractor(vtkImageData* image, const int regionExtent[6],
+    const LabelSelector& labelSelector, std::vector<SurfaceNetsLayer>& layers)
+    : Selector(labelSelector)
+    , Layers(layers)
+  {
+    int* imageExtent = image->GetExtent();
+    this->Scalars = static_cast<const ScalarType*>(image->GetScalarPointerForExtent(imageExtent));
+    this->ImageIncrements[0] = 1;
+    this->ImageIncrements[1] = static_cast<vtkIdType>(imageExtent[1] - imageExtent[0] + 1);
+    this->ImageIncrements[2] = this->ImageIncrements[1] * (imageExtent[3] - imageExtent[2] + 1);
+    this->ImageOrigin[0] = imageExtent[0];
+    this->ImageOrigin[1] = imageExtent[2];
+    this->ImageOrigin[2] = imageExtent[4];
+    std::copy(regionExtent, regionExtent + 6, this->Extent);
+    for (int axis = 0; axis < 3; ++axis)
+      {
+      this->Dimensions[axis] = regionExtent[2 * axis + 1] - regionExtent[2 * axis] + 1;
+      }
+    this->SliceWidth = this->Dimensions[0] + 2;
+    this->SliceSize = static_cast<vtkIdType>(this->Dimensions[0] + 2) * (this->Dimensions[1] + 2);
+    this->IdMapWidth = this->Dimensions[0] + 1;
+    this->IdMapSize = static_cast<vtkIdType>(this->Dimensions[0] + 1) * (this->Dimensions[1] + 1);
+  }
+
+  /// Process dual grid layers [beginLayer, endLayer)
+  void operator()(vtkIdType beginLayer, vtkIdType endLayer)
+  {
+    std::vector<int> lowerSlice(this->SliceSize);
+    std::vector<int> upperSlice(this->SliceSize);
+    std::vector<vtkIdType> previousIds(this->IdMapSize, -1);
+    std::vector<vtkIdType> currentIds(this->IdMapSize, -1);
+
+    // Point indices of the layer before the range are needed for the quads
+    this->LoadSlice(static_cast<int>(beginLayer) - 1, lowerSlice);
+    if (beginLayer > 0)
+      {
+      this->LoadSlice(static_cast<int>(beginLayer) - 2, upperSlice);
+      this->ClassifyCells(upperSlice, lowerSlice, previousIds, nullptr, 0);
+      }
+
+    for (vtkIdType layer = beginLayer; layer < endLayer; ++layer)
+      {
+      SurfaceNetsLayer& output = this->Layers[layer];
+      this->LoadSlice(static_cast<int>(layer), upperSlice);
+      this->ClassifyCells(lowerSlice, upperSlice, currentIds, &output, static_cast<int>(layer));
+      this->CreateQuads(lowerSlice, upperSlice, previousIds, currentIds, output, static_cast<int>(layer));
+      std::swap(lowerSlice, upperSlice);
+      std::swap(previousIds, currentIds);
+      }
+  }
+
+protected:
+  /// Copy a layer of voxels of the region into a slice that has a 1-voxel background border.
+  /// Voxels of layers outside the region are all background.
+  void LoadSlice(int k, std::vector<int>& slice)
+  {
+    std::fill(slice.begin(), slice.end(), 0);
+    if (k < 0 || k >= this->Dimensions[2])
+      {
+      return;
+      }
+    for (int j = 0; j < this->Dimensions[1]; ++j)
+      {
+      const ScalarType* voxelPtr = this->Scalars
+        + (this->Extent[4] + k - this->ImageOrigin[2]) * this->ImageIncrements[2]
+        + (this->Extent[2] + j - this->ImageOrigin[1]) * this->ImageIncrements[1]
+        + (this->Extent[0] - this->ImageOrigin[0]);
+      int* slicePtr = &slice[static_cast<vtkIdType>(j + 1) * this->SliceWidth + 1];
+      for (int i = 0; i < this->Dimensions[0]; ++i)
+        {
+        slicePtr[i] = this->Selector(static_cast<int>(*(voxelPtr++)));
+        }
+      }
+  }
+
+  /// Assign point indices to dual grid cells of a layer that contain more than one label.
+  /// If output is specified then the points are added to it.
+  void ClassifyCells(const std::vector<int>& lowerSlice, const std::vector<int>& upperSlice,
+    std::vector<vtkIdType>& ids, SurfaceNetsLayer* output, int ck)
+  {
+    vtkIdType numberOfPoints = 0;
+    for (int cj = 0; cj <= this->Dimensions[1]; ++cj)
+      {
+      for (int ci = 0; ci <= this->Dimensions[0]; ++ci)
+        {
+        const int* lower = &lowerSlice[static_cast<vtkIdType>(cj) * this->SliceWidth + ci];
+        const int* upper = &upperSlice[static_cast<vtkIdType>(cj) * this->SliceWidth + ci];
+        int labels[8] = { lower[0], lower[1], lower[this->SliceWidth], lower[this->SliceWidth + 1],
+          upper[0], upper[1], upper[this->SliceWidth], upper[this->SliceWidth + 1] };
+        vtkIdType& id = ids[static_cast<vtkIdType>(cj) * this->IdMapWidth + ci];
+        if (labels[1] == labels[0] && labels[2] == labels[0] && labels[3] == labels[0]
+          && labels[4] == labels[0] && labels[5] == labels[0] && labels[6] == labels[0] && labels[7] == labels[0])
+          {
+          id = -1;
+          continue;
+          }
+        id = numberOfPoints++;
+        if (!output)
+          {
+          continue;
+          }
+        unsigned char labelCount = 1;
+        for (int a = 1; a < 8; ++a)
+          {
+          bool found = false;
+          for (int b = 0; b < a && !found; ++b)
+            {
+            found = (labels[b] == labels[a]);
+            }
+          if (!found)
+            {
+            ++labelCount;
+            }
+          }
+        output->Points.push_back(static_cast<float>(this->Extent[0] + ci - 0.5));
+        output->Points.push_back(static_cast<float>(this->Extent[2] + cj - 0.5));
+        output->Points.push_back(static_cast<float>(this->Extent[4] + ck - 0.5));
+        output->PointKeys.push_back(GetCellKey(this->Extent[0] + ci, this->Extent[2] + cj, this->Extent[4] + ck));
+        output->PointLabelCounts.push_back(labelCount);
+        }
+      }
+  }
+
+  /// Add a quad. Owner voxel is specified by region-relative IJK index.
+  void AddQuad(SurfaceNetsLayer& output, vtkIdType p0, vtkIdType p1, vtkIdType p2, vtkIdType p3, int insideLabel, int outsideLabel,
+    int ownerI, int ownerJ, int ownerK)
+  {
+    output.QuadPointIds.push_back(p0);
+    output.QuadPointIds.push_back(p1);
+    output.QuadPointIds.push_back(p2);
+    output.QuadPointIds.push_back(p3);
+    output.QuadLabels.push_back(insideLabel);
+    output.QuadLabels.push_back(outsideLabel);
+    output.QuadOwners.push_back(this->Extent[0] + ownerI);
+    output.QuadOwners.push_back(this->Extent[2] + ownerJ);
+    output.QuadOwners.push_back(this->Extent[4] + ownerK);
+  }
+
+  /// Create quads for faces between voxels of different labels.
+  /// Layer ck contains the x and y faces of voxel layer ck-1 and the z faces between voxel layers ck-1 and ck.
+  void CreateQuads(const std::vector<int>& lowerSlice, const std::vector<int>& upperSlice,
+    const std::vector<vtkIdType>& previousIds, const std::vector<vtkIdType>& currentIds, SurfaceNetsLayer& output, int ck)
+  {
+    const int nx = this->Dimensions[0];
+    const int ny = this->Dimensions[1];
+    const int w = this->IdMapWidth;
+    auto previous = [&previousIds, w](int ci, int cj) { return -(previousIds[static_cast<vtkIdType>(cj) * w + ci] + 1); };
+    auto current = [&currentIds, w](int ci, int cj) { return currentIds[static_cast<vtkIdType>(cj) * w + ci]; };
+
+    if (ck >= 1 && ck <= this->Dimensions[2])
+      {
+      // Faces between voxels (i,j) and (i+1,j), normal is +x
+      for (int j = 0; j < ny; ++j)
+        {
+        const int* row = &lowerSlice[static_cast<vtkIdType>(j + 1) * this->SliceWidth];
+        for (int i = -1; i < nx; ++i)
+          {
+          int a = row[i + 1];
+          int b = row[i + 2];
+          if (a != b)
+            {
+            this->AddQuad(output, previous(i + 1, j), previous(i + 1, j + 1), current(i + 1, j + 1), current(i + 1, j), a, b,
+              i + 1, j, ck - 1);
+            }
+          }
+        }
+      // Faces between voxels (i,j) and (i,j+1), normal is +y
+      for (int j = -1; j < ny; ++j)
+        {
+        const int* row = &lowerSlice[static_cast<vtkIdType>(j + 1) * this->SliceWidth];
+        const int* nextRow = row + this->SliceWidth;
+        for (int i = 0; i < nx; ++i)
+          {
+          int a = row[i + 1];
+          int b = nextRow[i + 1];
+          if (a != b)
+            {
+            this->AddQuad(output, previous(i, j + 1), current(i, j + 1), current(i + 1, j + 1), previous(i + 1, j + 1), a, b,
+              i, j + 1, ck - 1);
+            }
+          }
+        }
+      }
+
+    // Faces between voxel layers ck-1 and ck, normal is +z
+    for (int j = 0; j < ny; ++j)
+      {
+      const int* lowerRow = &lowerSlice[static_cast<vtkIdType>(j + 1) * this->SliceWidth];
+      const int* upperRow = &upperSlice[static_cast<vtkIdType>(j + 1) * this->SliceWidth];
+      for (int i = 0; i < nx; ++i)
+        {
+        int a = lowerRow[i + 1];
+        int b = upperRow[i + 1];
+        if (a != b)
+          {
+          this->AddQuad(output, current(i, j), current(i + 1, j), current(i + 1, j + 1), current(i, j + 1), a, b,
+            i, j, ck);
+          }
+        }
+      }
+  }
+
+protected:
+  const ScalarType* Scalars;
+  vtkIdType ImageIncrements[3];
+  int ImageOrigin[3];
+  const LabelSelector& Selector;
+  std::vector<SurfaceNetsLayer>& Layers;
+  int Dimensions[3];
+  int Extent[6];
+  int SliceWidth;
+  vtkIdType SliceSize;
+  int IdMapWidth;
+  vtkIdType IdMapSize;
+};
+
+//----------------------------------------------------------------------------
+template<class ScalarType>
+void ExtractSurfaceNetsLayers(vtkImageData* image, const int regionExtent[6],
+  const LabelSelector& labelSelector, std::vector<SurfaceNetsLayer>& layers)
+{
+  int numberOfLayers = regionExtent[5] - regionExtent[4] + 2;
+  layers.resize(numberOfLayers);
+  SurfaceNetsExtractor<ScalarType> extractor(image, regionExtent, labelSelector, layers);
+  vtkSMPTools::For(0, numberOfLayers, extractor);
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkMultiLabelSurfaceNets);
+
+//----------------------------------------------------------------------------
+class vtkMultiLabelSurfaceNets::vtkInternal
+{
+public:
+  /// Surface of a label within a brick. Faces are assigned to the brick of the voxel that owns them,
+  /// points on the brick boundary are shared with neighbor bricks and identified by their cell key.
+  struct SurfacePiece
+  {
+    std::vector<float> Points;
+    std::vector<long long> PointKeys;
+    /// Point indices of the triangles, oriented so that their normals point outward
+    std::vector<vtkIdType> Triangles;
+  };
+  typedef std::array<int, 3> BrickIndex;
+
+  /// Surface pieces of each label in each brick
+  std::map<BrickIndex, std::map<int, SurfacePiece> > Bricks;
+
+  /// Input and settings that the bricks were computed with.
+  /// Bricks can only be updated incrementally if these have not changed.
+  bool Valid{ false };
+  vtkImageData* InputLabelmap{ nullptr };
+  std::vector<int> LabelValues;
+  int NumberOfSmoothingIterations{ 0 };
+  double RelaxationFactor{ 0.0 };
+  double ConstraintDistance{ 0.0 };
+  int BrickSize{ 0 };
+};
+
+//----------------------------------------------------------------------------
+vtkMultiLabelSurfaceNets::vtkMultiLabelSurfaceNets()
+{
+  this->InputLabelmap = nullptr;
+  this->NumberOfSmoothingIterations = 20;
+  this->RelaxationFactor = 0.5;
+  this->ConstraintDistance = 0.5;
+  this->BrickSize = 32;
+  this->Internal = new vtkInternal();
+}
+
+//----------------------------------------------------------------------------
+vtkMultiLabelSurfaceNets::~vtkMultiLabelSurfaceNets()
+{
+  this->SetInputLabelmap(nullptr);
+  delete this->Internal;
+}
+
+//----------------------------------------------------------------------------
+void vtkMultiLabelSurfaceNets::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "InputLabelmap: " << this->InputLabelmap << "\n";
+  os << indent << "LabelValues:";
+  for (int labelValue : this->LabelValues)
+    {
+    os << " " << labelValue;
+    }
+  os << "\n";
+  os << indent << "NumberOfSmoothingIterations: " << this->NumberOfSmoothingIterations << "\n";
+  os << indent << "RelaxationFactor: " << this->RelaxationFactor << "\n";
+  os << indent << "ConstraintDistance: " << this->ConstraintDistance << "\n";
+  os << indent << "BrickSize: " << this->BrickSize << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkMultiLabelSurfaceNets::SetLabelValues(const std::vector<int>& labelValues)
+{
+  if (this->LabelValues == labelValues)
+    {
+    return;
+    }
+  this->LabelValues = labelValues;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+std::vector<int> vtkMultiLabelSurfaceNets::GetOutputLabelValues()
+{
+  std::vector<int> labelValues;
+  for (const auto& labelSurface : this->OutputSurfaces)
+    {
+    labelValues.push_back(labelSurface.first);
+    }
+  return labelValues;
+}
+
+//----------------------------------------------------------------------------
+vtkPolyData* vtkMultiLabelSurfaceNets::GetOutput(int labelValue)
+{
+  auto surfaceIt = this->OutputSurfaces.find(labelValue);
+  if (surfaceIt == this->OutputSurfaces.end())
+    {
+    return nullptr;
+    }
+  return surfaceIt->second;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMultiLabelSurfaceNets::Update()
+{
+  this->OutputSurfaces.clear();
+  this->Internal->Bricks.clear();
+  this->Internal->Valid = false;
+  if (!this->InputLabelmap)
+    {
+    vtkErrorMacro("Update: Invalid input labelmap");
+    return false;
+    }
+
+  // Faces on the upper boundary of the image are owned by the voxels outside the image
+  int* extent = this->InputLabelmap->GetExtent();
+  int outputExtent[6] = { extent[0], extent[1] + 1, extent[2], extent[3] + 1, extent[4], extent[5] + 1 };
+  std::set<int> labelValues;
+  if (!this->ExtractBricks(extent, outputExtent, labelValues))
+    {
+    return false;
+    }
+  this->UpdateOutputSurfaces(labelValues);
+
+  this->Internal->InputLabelmap = this->InputLabelmap;
+  this->Internal->LabelValues = this->LabelValues;
+  this->Internal->NumberOfSmoothingIterations = this->NumberOfSmoothingIterations;
+  this->Internal->RelaxationFactor = this->RelaxationFactor;
+  this->Internal->ConstraintDistance = this->ConstraintDistance;
+  this->Internal->BrickSize = this->BrickSize;
+  this->Internal->Valid = true;
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMultiLabelSurfaceNets::UpdateModifiedExtent(const int modifiedExtent[6])
+{
+  vtkInternal* internal = this->Internal;
+  if (!this->InputLabelmap || !internal->Valid
+    || internal->InputLabelmap != this->InputLabelmap
+    || internal->LabelValues != this->LabelValues
+    || internal->NumberOfSmoothingIterations != this->NumberOfSmoothingIterations
+    || internal->RelaxationFactor != this->RelaxationFactor
+    || internal->ConstraintDistance != this->ConstraintDistance
+    || internal->BrickSize != this->BrickSize)
+    {
+    return false;
+    }
+  if (modifiedExtent[0] > modifiedExtent[1] || modifiedExtent[2] > modifiedExtent[3] || modifiedExtent[4] > modifiedExtent[5])
+    {
+    // Nothing is modified
+    return true;
+    }
+
+  // After N smoothing iterations a vertex is only influenced by vertices of dual grid cells at most N cells away,
+  // and their neighborhood depends on voxels at most 2 voxels farther. Faces owned by voxels farther than this
+  // influence distance from the modified voxels remain the same.
+  int smoothingIterations = (this->RelaxationFactor > 0.0 ? this->NumberOfSmoothingIterations : 0);
+  int influenceDistance = smoothingIterations + 2;
+  int* inputExtent = this->InputLabelmap->GetExtent();
+  int firstBrick[3] = { 0, 0, 0 };
+  int lastBrick[3] = { 0, 0, 0 };
+  int outputExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  int regionExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    firstBrick[axis] = FloorDivide(modifiedExtent[2 * axis] - influenceDistance, this->BrickSize);
+    lastBrick[axis] = FloorDivide(modifiedExtent[2 * axis + 1] + influenceDistance, this->BrickSize);
+    outputExtent[2 * axis] = firstBrick[axis] * this->BrickSize;
+    outputExtent[2 * axis + 1] = (lastBrick[axis] + 1) * this->BrickSize - 1;
+    // Voxels farther than the influence distance from the output extent do not affect its faces
+    regionExtent[2 * axis] = std::max(outputExtent[2 * axis] - influenceDistance - 1, inputExtent[2 * axis]);
+    regionExtent[2 * axis + 1] = std::min(outputExtent[2 * axis + 1] + influenceDistance + 1, inputExtent[2 * axis + 1]);
+    }
+
+  // Remove pieces of the bricks that are extracted again
+  std::set<int> labelValues;
+  for (auto brickIt = internal->Bricks.begin(); brickIt != internal->Bricks.end();)
+    {
+    const vtkInternal::BrickIndex& brickIndex = brickIt->first;
+    if (brickIndex[0] < firstBrick[0] || brickIndex[0] > lastBrick[0]
+      || brickIndex[1] < firstBrick[1] || brickIndex[1] > lastBrick[1]
+      || brickIndex[2] < firstBrick[2] || brickIndex[2] > lastBrick[2])
+      {
+      ++brickIt;
+      continue;
+      }
+    for (const auto& labelPiece : brickIt->second)
+      {
+      labelValues.insert(labelPiece.first);
+      }
+    brickIt = internal->Bricks.erase(brickIt);
+    }
+
+  if (!this->ExtractBricks(regionExtent, outputExtent, labelValues))
+    {
+    internal->Valid = false;
+    return false;
+    }
+  this->UpdateOutputSurfaces(labelValues);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMultiLabelSurfaceNets::ExtractBricks(const int regionExtent[6], const int outputExtent[6], std::set<int>& labelValues)
+{
+  if (regionExtent[0] > regionExtent[1] || regionExtent[2] > regionExtent[3] || regionExtent[4] > regionExtent[5]
+    || !this->InputLabelmap->GetPointData()->GetScalars())
+    {
+    // Empty region, no surfaces
+    return true;
+    }
+  const int maximumIndex = (1 << 20) - 2;
+  for (int i = 0; i < 6; ++i)
+    {
+    if (regionExtent[i] < -maximumIndex || regionExtent[i] > maximumIndex)
+      {
+      vtkErrorMacro("ExtractBricks: Labelmap extent is out of the supported range");
+      return false;
+      }
+    }
+
+  // Extract points and quads of each layer of the dual grid in parallel
+  LabelSelector labelSelector(this->LabelValues);
+  std::vector<SurfaceNetsLayer> layers;
+  switch (this->InputLabelmap->GetScalarType())
+    {
+    vtkTemplateMacro(ExtractSurfaceNetsLayers<VTK_TT>(this->InputLabelmap, regionExtent, labelSelector, layers));
+    default:
+      vtkErrorMacro("ExtractBricks: Unknown image scalar type");
+      return false;
+    }
+
+  // Merge layers
+  vtkIdType numberOfLayers = static_cast<vtkIdType>(layers.size());
+  std::vector<vtkIdType> pointOffsets(numberOfLayers + 1, 0);
+  std::vector<vtkIdType> quadOffsets(numberOfLayers + 1, 0);
+  for (vtkIdType layer = 0; layer < numberOfLayers; ++layer)
+    {
+    pointOffsets[layer + 1] = pointOffsets[layer] + static_cast<vtkIdType>(layers[layer].PointLabelCounts.size());
+    quadOffsets[layer + 1] = quadOffsets[layer] + static_cast<vtkIdType>(layers[layer].QuadLabels.size() / 2);
+    }
+  const vtkIdType numberOfPoints = pointOffsets[numberOfLayers];
+  const vtkIdType numberOfQuads = quadOffsets[numberOfLayers];
+  if (numberOfQuads == 0)
+    {
+    return true;
+    }
+
+  std::vector<float> points(3 * numberOfPoints);
+  std::vector<long long> pointKeys(numberOfPoints);
+  std::vector<unsigned char> pointLabelCounts(numberOfPoints);
+  std::vector<vtkIdType> quadPointIds(4 * numberOfQuads);
+  std::vector<int> quadLabels(2 * numberOfQuads);
+  std::vector<int> quadOwners(3 * numberOfQuads);
+  auto mergeLayers = [&](vtkIdType beginLayer, vtkIdType endLayer)
+    {
+    for (vtkIdType layer = beginLayer; layer < endLayer; ++layer)
+      {
+      SurfaceNetsLayer& layerOutput = layers[layer];
+      std::copy(layerOutput.Points.begin(), layerOutput.Points.end(), points.begin() + 3 * pointOffsets[layer]);
+      std::copy(layerOutput.PointKeys.begin(), layerOutput.PointKeys.end(), pointKeys.begin() + pointOffsets[layer]);
+      std::copy(layerOutput.PointLabelCounts.begin(), layerOutput.PointLabelCounts.end(), pointLabelCounts.begin() + pointOffsets[layer]);
+      std::copy(layerOutput.QuadLabels.begin(), layerOutput.QuadLabels.end(), quadLabels.begin() + 2 * quadOffsets[layer]);
+      std::copy(layerOutput.QuadOwners.begin(), layerOutput.QuadOwners.end(), quadOwners.begin() + 3 * quadOffsets[layer]);
+      vtkIdType* quadPointIdPtr = &quadPointIds[4 * quadOffsets[layer]];
+      for (vtkIdType pointId : layerOutput.QuadPointIds)
+        {
+        *(quadPointIdPtr++) = (pointId >= 0 ? pointOffsets[layer] + pointId : pointOffsets[layer - 1] - pointId - 1);
+        }
+      layerOutput = SurfaceNetsLayer();
+      }
+    };
+  vtkSMPTools::For(0, numberOfLayers, mergeLayers);
+  layers.clear();
+
+  // Constrained smoothing
+  if (this->NumberOfSmoothingIterations > 0 && this->RelaxationFactor > 0.0)
+    {
+    // Neighbors of each point along quad edges. Points at junctions of more labels are only
+    // smoothed towards neighbors at junctions of at least as many labels, which keeps junctions in place.
+    std::vector<vtkIdType> neighborOffsets(numberOfPoints + 1, 0);
+    for (vtkIdType pointIndex = 0; pointIndex < 4 * numberOfQuads; ++pointIndex)
+      {
+      neighborOffsets[quadPointIds[pointIndex] + 1] += 2;
+      }
+    for (vtkIdType pointId = 0; pointId < numberOfPoints; ++pointId)
+      {
+      neighborOffsets[pointId + 1] += neighborOffsets[pointId];
+      }
+    std::vector<vtkIdType> neighbors(neighborOffsets[numberOfPoints]);
+    std::vector<vtkIdType> insertPositions(neighborOffsets.begin(), neighborOffsets.end() - 1);
+    for (vtkIdType quadId = 0; quadId < numberOfQuads; ++quadId)
+      {
+      const vtkIdType* quad = &quadPointIds[4 * quadId];
+      for (int vertex = 0; vertex < 4; ++vertex)
+        {
+        vtkIdType pointId = quad[vertex];
+        neighbors[insertPositions[pointId]++] = quad[(vertex + 1) % 4];
+        neighbors[insertPositions[pointId]++] = quad[(vertex + 3) % 4];
+        }
+      }
+    std::vector<vtkIdType> numberOfNeighbors(numberOfPoints, 0);
+    auto findNeighbors = [&](vtkIdType beginPointId, vtkIdType endPointId)
+      {
+      for (vtkIdType pointId = beginPointId; pointId < endPointId; ++pointId)
+        {
+        vtkIdType* first = &neighbors[neighborOffsets[pointId]];
+        vtkIdType* last = first + (neighborOffsets[pointId + 1] - neighborOffsets[pointId]);
+        std::sort(first, last);
+        last = std::unique(first, last);
+        unsigned char labelCount = pointLabelCounts[pointId];
+        last = std::remove_if(first, last,
+          [&pointLabelCounts, labelCount](vtkIdType neighborId) { return pointLabelCounts[neighborId] < labelCount; });
+        numberOfNeighbors[pointId] = last - first;
+        }
+      };
+    vtkSMPTools::For(0, numberOfPoints, findNeighbors);
+
+    const std::vector<float> initialPoints(points);
+    std::vector<float> smoothedPoints(points.size());
+    const float relaxationFactor = static_cast<float>(this->RelaxationFactor);
+    const float constraintDistance = static_cast<float>(this->ConstraintDistance);
+    for (int iteration = 0; iteration < this->NumberOfSmoothingIterations; ++iteration)
+      {
+      auto smooth = [&](vtkIdType beginPointId, vtkIdType endPointId)
+        {
+        for (vtkIdType pointId = beginPointId; pointId < endPointId; ++pointId)
+          {
+          const float* point = &points[3 * pointId];
+          float* smoothedPoint = &smoothedPoints[3 * pointId];
+          vtkIdType neighborCount = numberOfNeighbors[pointId];
+          if (neighborCount == 0)
+            {
+            std::copy(point, point + 3, smoothedPoint);
+            continue;
+            }
+          float average[3] = { 0.0f, 0.0f, 0.0f };
+          const vtkIdType* neighborIds = &neighbors[neighborOffsets[pointId]];
+          for (vtkIdType neighborIndex = 0; neighborIndex < neighborCount; ++neighborIndex)
+            {
+            const float* neighborPoint = &points[3 * neighborIds[neighborIndex]];
+            average[0] += neighborPoint[0];
+            average[1] += neighborPoint[1];
+            average[2] += neighborPoint[2];
+            }
+          const float* initialPoint = &initialPoints[3 * pointId];
+          for (int axis = 0; axis < 3; ++axis)
+            {
+            float position = point[axis] + relaxationFactor * (average[axis] / neighborCount - point[axis]);
+            smoothedPoint[axis] = std::min(std::max(position, initialPoint[axis] - constraintDistance),
+              initialPoint[axis] + constraintDistance);
+            }
+          }
+        };
+      vtkSMPTools::For(0, numberOfPoints, smooth);
+      std::swap(points, smoothedPoints);
+      }
+    }
+
+  // Split quads into pieces by brick and label. Each quad is part of the surface of the label on both sides.
+  // All quads of the region are needed for smoothing, but only those owned by voxels in the output extent are stored.
+  struct PieceQuad
+  {
+    vtkInternal::BrickIndex Brick;
+    int Label;
+    vtkIdType QuadId;
+    bool operator<(const PieceQuad& other) const
+    {
+      return std::tie(this->Brick, this->Label, this->QuadId) < std::tie(other.Brick, other.Label, other.QuadId);
+    }
+  };
+  std::vector<PieceQuad> pieceQuads;
+  pieceQuads.reserve(2 * numberOfQuads);
+  for (vtkIdType quadId = 0; quadId < numberOfQuads; ++quadId)
+    {
+    const int* owner = &quadOwners[3 * quadId];
+    if (owner[0] < outputExtent[0] || owner[0] > outputExtent[1]
+      || owner[1] < outputExtent[2] || owner[1] > outputExtent[3]
+      || owner[2] < outputExtent[4] || owner[2] > outputExtent[5])
+      {
+      continue;
+      }
+    vtkInternal::BrickIndex brickIndex = { { FloorDivide(owner[0], this->BrickSize),
+      FloorDivide(owner[1], this->BrickSize), FloorDivide(owner[2], this->BrickSize) } };
+    for (int side = 0; side < 2; ++side)
+      {
+      int labelValue = quadLabels[2 * quadId + side];
+      if (labelValue != 0)
+        {
+        pieceQuads.push_back({ brickIndex, labelValue, quadId });
+        }
+      }
+    }
+  std::sort(pieceQuads.begin(), pieceQuads.end());
+  std::vector<size_t> pieceStarts;
+  for (size_t index = 0; index < pieceQuads.size(); ++index)
+    {
+    if (index == 0 || pieceQuads[index].Brick != pieceQuads[index - 1].Brick || pieceQuads[index].Label != pieceQuads[index - 1].Label)
+      {
+      pieceStarts.push_back(index);
+      }
+    }
+  pieceStarts.push_back(pieceQuads.size());
+
+  // Create surface pieces
+  const vtkIdType numberOfPieces = static_cast<vtkIdType>(pieceStarts.size()) - 1;
+  std::vector<vtkInternal::SurfacePiece> pieces(numberOfPieces);
+  auto createPieces = [&](vtkIdType beginPieceIndex, vtkIdType endPieceIndex)
+    {
+    std::vector<vtkIdType> usedPointIds;
+    for (vtkIdType pieceIndex = beginPieceIndex; pieceIndex < endPieceIndex; ++pieceIndex)
+      {
+      const PieceQuad* firstQuad = &pieceQuads[pieceStarts[pieceIndex]];
+      const PieceQuad* lastQuad = &pieceQuads[0] + pieceStarts[pieceIndex + 1];
+      int labelValue = firstQuad->Label;
+
+      usedPointIds.clear();
+      for (const PieceQuad* pieceQuad = firstQuad; pieceQuad != lastQuad; ++pieceQuad)
+        {
+        usedPointIds.insert(usedPointIds.end(), &quadPointIds[4 * pieceQuad->QuadId], &quadPointIds[4 * pieceQuad->QuadId] + 4);
+        }
+      std::sort(usedPointIds.begin(), usedPointIds.end());
+      usedPointIds.erase(std::unique(usedPointIds.begin(), usedPointIds.end()), usedPointIds.end());
+
+      vtkInternal::SurfacePiece& piece = pieces[pieceIndex];
+      piece.Points.reserve(3 * usedPointIds.size());
+      piece.PointKeys.reserve(usedPointIds.size());
+      for (vtkIdType pointId : usedPointIds)
+        {
+        piece.Points.insert(piece.Points.end(), &points[3 * pointId], &points[3 * pointId] + 3);
+        piece.PointKeys.push_back(pointKeys[pointId]);
+        }
+
+      piece.Triangles.reserve(6 * (lastQuad - firstQuad));
+      for (const PieceQuad* pieceQuad = firstQuad; pieceQuad != lastQuad; ++pieceQuad)
+        {
+        vtkIdType quadId = pieceQuad->QuadId;
+        vtkIdType ids[4] = { 0, 0, 0, 0 };
+        for (int vertex = 0; vertex < 4; ++vertex)
+          {
+          ids[vertex] = std::lower_bound(usedPointIds.begin(), usedPointIds.end(), quadPointIds[4 * quadId + vertex])
+            - usedPointIds.begin();
+          }
+        if (quadLabels[2 * quadId] == labelValue)
+          {
+          // Label is inside, keep orientation
+          vtkIdType triangles[6] = { ids[0], ids[1], ids[2], ids[0], ids[2], ids[3] };
+          piece.Triangles.insert(piece.Triangles.end(), triangles, triangles + 6);
+          }
+        else
+          {
+          // Label is outside, flip orientation
+          vtkIdType triangles[6] = { ids[0], ids[2], ids[1], ids[0], ids[3], ids[2] };
+          piece.Triangles.insert(piece.Triangles.end(), triangles, triangles + 6);
+          }
+        }
+      }
+    };
+  vtkSMPTools::For(0, numberOfPieces, createPieces);
+
+  for (vtkIdType pieceIndex = 0; pieceIndex < numberOfPieces; ++pieceIndex)
+    {
+    const PieceQuad& firstQuad = pieceQuads[pieceStarts[pieceIndex]];
+    this->Internal->Bricks[firstQuad.Brick][firstQuad.Label] = std::move(pieces[pieceIndex]);
+    labelValues.insert(firstQuad.Label);
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> vtkMultiLabelSurfaceNets::StitchLabelSurface(int labelValue)
+{
+  std::vector<const vtkInternal::SurfacePiece*> pieces;
+  vtkIdType numberOfPoints = 0;
+  vtkIdType numberOfTriangles = 0;
+  for (const auto& brick : this->Internal->Bricks)
+    {
+    auto pieceIt = brick.second.find(labelValue);
+    if (pieceIt == brick.second.end())
+      {
+      continue;
+      }
+    pieces.push_back(&pieceIt->second);
+    numberOfPoints += static_cast<vtkIdType>(pieceIt->second.PointKeys.size());
+    numberOfTriangles += static_cast<vtkIdType>(pieceIt->second.Triangles.size() / 3);
+    }
+  if (numberOfTriangles == 0)
+    {
+    return vtkSmartPointer<vtkPolyData>();
+    }
+
+  // Points on brick boundaries are shared by pieces, merge them by their cell key
+  std::unordered_map<long long, vtkIdType> pointIdsByKey;
+  pointIdsByKey.reserve(numberOfPoints);
+  vtkNew<vtkFloatArray> pointCoordinates;
+  pointCoordinates->SetNumberOfComponents(3);
+  pointCoordinates->Allocate(3 * numberOfPoints);
+  vtkNew<vtkCellArray> triangles;
+  triangles->AllocateExact(numberOfTriangles, 3 * numberOfTriangles);
+  std::vector<vtkIdType> piecePointIds;
+  for (const vtkInternal::SurfacePiece* piece : pieces)
+    {
+    piecePointIds.resize(piece->PointKeys.size());
+    for (size_t pointIndex = 0; pointIndex < piece->PointKeys.size(); ++pointIndex)
+      {
+      auto inserted = pointIdsByKey.emplace(piece->PointKeys[pointIndex], pointCoordinates->GetNumberOfTuples());
+      if (inserted.second)
+        {
+        pointCoordinates->InsertNextTypedTuple(&piece->Points[3 * pointIndex]);
+        }
+      piecePointIds[pointIndex] = inserted.first->second;
+      }
+    for (size_t index = 0; index < piece->Triangles.size(); index += 3)
+      {
+      vtkIdType triangle[3] = { piecePointIds[piece->Triangles[index]],
+        piecePointIds[piece->Triangles[index + 1]], piecePointIds[piece->Triangles[index + 2]] };
+      triangles->InsertNextCell(3, triangle);
+      }
+    }
+
+  vtkNew<vtkPoints> surfacePoints;
+  surfacePoints->SetData(pointCoordinates);
+  vtkSmartPointer<vtkPolyData> surface = vtkSmartPointer<vtkPolyData>::New();
+  surface->SetPoints(surfacePoints);
+  surface->SetPolys(triangles);
+  return surface;
+}
+
+//----------------------------------------------------------------------------
+void vtkMultiLabelSurfaceNets::UpdateOutputSurfaces(const std::set<int>& labelValues)
+{
+  std::vector<int> outputLabelValues(labelValues.begin(), labelValues.end());
+  std::vector<vtkSmartPointer<vtkPolyData> > outputSurfaces(outputLabelValues.size());
+  auto stitchSurfaces = [&](vtkIdType beginLabelIndex, vtkIdType endLabelIndex)
+    {
+    for (vtkIdType labelIndex = beginLabelIndex; labelIndex < endLabelIndex; ++labelIndex)
+      {
+      outputSurfaces[labelIndex] = this->StitchLabelSurface(outputLabelValues[labelIndex]);
+      }
+    };
+  vtkSMPTools::For(0, static_cast<vtkIdType>(outputLabelValues.size()), stitchSurfaces);
+
+  for (size_t labelIndex = 0; labelIndex < outputLabelValues.size(); ++labelIndex)
+    {
+    if (outputSurfaces[labelIndex])
+      {
+      this->OutputSurfaces[outputLabelValues[labelIndex]] = outputSurfaces[labelIndex];
+      }
+    else
+      {
+      this->OutputSurfaces.erase(outputLabelValues[labelIndex]);
+      }
+    }
+}
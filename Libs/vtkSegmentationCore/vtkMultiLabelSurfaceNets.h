@@ -0,0 +1,145 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// .NAME vtkMultiLabelSurfaceNets - Extract surfaces of all labels of a labelmap in a single pass
+// .SECTION Description
+
+#ifndef __vtkMultiLabelSurfaceNets_h
+#define __vtkMultiLabelSurfaceNets_h
+
+// VTK includes
+#include <vtkObject.h>
+#include <vtkSmartPointer.h>
+
+// STD includes
+#include <map>
+#include <set>
+#include <vector>
+
+#include "vtkSegmentationCoreConfigure.h"
+
+class vtkImageData;
+class vtkPolyData;
+
+/// \ingroup SegmentationCore
+/// \brief Extract boundary surfaces of multiple labels of a labelmap in a single pass
+///
+/// Implements the surface nets algorithm: a vertex is placed in each 2x2x2 voxel neighborhood
+/// that contains more than one label, and a quad is created for each face between voxels
+/// of different labels. The quad is tagged by the labels on both sides, therefore surfaces
+/// of all labels are generated at once and can be split without thresholding.
+///
+/// Neighboring labels share the vertices of their common boundary. Smoothing moves each vertex
+/// towards the average of its neighbors but keeps it within a box around its initial position,
+/// so the labels are smoothed together without creating gaps or overlaps between them.
+/// Vertices at junctions of three or more labels are only smoothed along the junction.
+///
+/// Voxels outside the image extent are considered background, therefore the output surfaces are closed.
+/// Output points are in the IJK coordinate system of the input image (origin and spacing are ignored).
+/// Layers of the image are processed in parallel.
+///
+/// The surfaces are cached in bricks of the IJK grid. Since smoothing only moves a vertex by the influence
+/// of vertices within NumberOfSmoothingIterations voxels, after a modification of the labelmap only the bricks
+/// near the modified region need to be extracted again (see UpdateModifiedExtent). The result is the same as
+/// extracting the whole labelmap.
+class vtkSegmentationCore_EXPORT vtkMultiLabelSurfaceNets : public vtkObject
+{
+public:
+  static vtkMultiLabelSurfaceNets* New();
+  vtkTypeMacro(vtkMultiLabelSurfaceNets, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  /// Input labelmap. Voxel values are label values, 0 is background.
+  vtkGetObjectMacro(InputLabelmap, vtkImageData);
+  vtkSetObjectMacro(InputLabelmap, vtkImageData);
+
+  /// Label values to extract surfaces for. Voxels of other labels are considered background.
+  /// If empty (default) then surfaces of all non-zero labels are extracted.
+  void SetLabelValues(const std::vector<int>& labelValues);
+  const std::vector<int>& GetLabelValues() { return this->LabelValues; };
+
+  /// Number of smoothing iterations. 0 disables smoothing.
+  vtkSetClampMacro(NumberOfSmoothingIterations, int, 0, VTK_INT_MAX);
+  vtkGetMacro(NumberOfSmoothingIterations, int);
+
+  /// Fraction of the distance a vertex moves towards the average of its neighbors in each iteration.
+  vtkSetClampMacro(RelaxationFactor, double, 0.0, 1.0);
+  vtkGetMacro(RelaxationFactor, double);
+
+  /// Maximum displacement of vertices along each axis during smoothing, in voxels.
+  /// Default is 0.5, which keeps each vertex within its 2x2x2 voxel neighborhood.
+  vtkSetClampMacro(ConstraintDistance, double, 0.0, VTK_DOUBLE_MAX);
+  vtkGetMacro(ConstraintDistance, double);
+
+  /// Size of the bricks (in voxels) that the surfaces are cached in.
+  /// Smaller bricks make incremental updates faster but increase the cost of assembling the output surfaces.
+  vtkSetClampMacro(BrickSize, int, 4, VTK_INT_MAX);
+  vtkGetMacro(BrickSize, int);
+
+  /// Extract and smooth the surfaces of the whole labelmap.
+  /// \return Success flag
+  bool Update();
+
+  /// Update the surfaces after voxels of the input labelmap were modified within the specified IJK extent.
+  /// Only the bricks that may be affected by the modification are extracted again and only the output
+  /// surfaces of labels in these bricks are replaced. The input labelmap must not have been modified outside
+  /// of the extent since the last update.
+  /// \return False if there is no previous update with the same input and settings (Update must be called then).
+  bool UpdateModifiedExtent(const int modifiedExtent[6]);
+
+  /// Label values that have a surface in the output
+  std::vector<int> GetOutputLabelValues();
+
+  /// Get surface of a label. Triangles are oriented so that their normals point outward.
+  /// Returns nullptr if there is no surface for the label.
+  /// Surfaces that are changed by an update are replaced by new objects, so the returned object is never modified.
+  vtkPolyData* GetOutput(int labelValue);
+
+protected:
+  /// Extract surfaces from a region of the input and store the faces owned by voxels within outputExtent in bricks.
+  /// Labels of the created pieces are added to labelValues.
+  bool ExtractBricks(const int regionExtent[6], const int outputExtent[6], std::set<int>& labelValues);
+
+  /// Assemble the output surface of a label from the pieces stored in the bricks
+  vtkSmartPointer<vtkPolyData> StitchLabelSurface(int labelValue);
+
+  /// Replace the output surfaces of the specified labels by assembling them from the bricks
+  void UpdateOutputSurfaces(const std::set<int>& labelValues);
+
+protected:
+  vtkImageData* InputLabelmap;
+  std::vector<int> LabelValues;
+  int NumberOfSmoothingIterations;
+  double RelaxationFactor;
+  double ConstraintDistance;
+  int BrickSize;
+
+  /// Surfaces extracted by the last Update
+  std::map<int, vtkSmartPointer<vtkPolyData> > OutputSurfaces;
+
+  class vtkInternal;
+  vtkInternal* Internal;
+
+protected:
+  vtkMultiLabelSurfaceNets();
+  ~vtkMultiLabelSurfaceNets() override;
+
+private:
+  vtkMultiLabelSurfaceNets(const vtkMultiLabelSurfaceNets&) = delete;
+  void operator=(const vtkMultiLabelSurfaceNets&) = delete;
+};
+
+#endif
@@ -19,6 +19,7 @@
 ==============================================================================*/
 
 #include "vtkOrientedImageData.h"
+#include "vtkLabelmapMetadata.h"
 
 // VTK includes
 #include <vtkBoundingBox.h>
@@ -82,6 +83,14 @@ void vtkOrientedImageData::DeepCopy(vtkDataObject *dataObject)
 
   // Do superclass (image, origin, spacing)
   this->vtkImageData::DeepCopy(dataObject);
+
+  // Copy labelmap metadata if available, to avoid scanning the copy when it is requested
+  vtkOrientedImageData* orientedImageData = vtkOrientedImageData::SafeDownCast(dataObject);
+  vtkLabelmapMetadata* metadata = orientedImageData ? orientedImageData->GetCachedLabelmapMetadata() : nullptr;
+  if (metadata)
+    {
+    this->SetLabelmapMetadata(metadata);
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -370,3 +379,48 @@ bool vtkOrientedImageData::IsEmpty()
     }
   return false;
 }
+
+//---------------------------------------------------------------------------
+vtkLabelmapMetadata* vtkOrientedImageData::GetLabelmapMetadata()
+{
+  if (!this->LabelmapMetadata)
+    {
+    this->LabelmapMetadata = vtkSmartPointer<vtkLabelmapMetadata>::New();
+    }
+  if (!this->LabelmapMetadata->IsUpToDate(this))
+    {
+    this->LabelmapMetadata->Compute(this);
+    }
+  if (!this->LabelmapMetadata->IsLabelmap())
+    {
+    return nullptr;
+    }
+  this->LabelmapMetadata->UpdateLabelExtents(this);
+  return this->LabelmapMetadata;
+}
+
+//---------------------------------------------------------------------------
+vtkLabelmapMetadata* vtkOrientedImageData::GetCachedLabelmapMetadata()
+{
+  if (!this->LabelmapMetadata || !this->LabelmapMetadata->IsLabelmap() || !this->LabelmapMetadata->IsUpToDate(this))
+    {
+    return nullptr;
+    }
+  return this->LabelmapMetadata;
+}
+
+//---------------------------------------------------------------------------
+void vtkOrientedImageData::SetLabelmapMetadata(vtkLabelmapMetadata* metadata)
+{
+  if (!metadata)
+    {
+    this->LabelmapMetadata = nullptr;
+    return;
+    }
+  if (!this->LabelmapMetadata)
+    {
+    this->LabelmapMetadata = vtkSmartPointer<vtkLabelmapMetadata>::New();
+    }
+  this->LabelmapMetadata->DeepCopy(metadata);
+  this->LabelmapMetadata->SetUpToDate(this);
+}
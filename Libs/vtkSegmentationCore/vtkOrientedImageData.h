@@ -25,7 +25,9 @@
 #include "vtkSegmentationCoreConfigure.h"
 
 #include "vtkImageData.h"
+#include "vtkSmartPointer.h"
 
+class vtkLabelmapMetadata;
 class vtkMatrix4x4;
 
 /// \ingroup SegmentationCore
@@ -87,6 +89,18 @@ public:
   /// Determines whether the image data is empty (if the extent has 0 voxels then it is)
   bool IsEmpty();
 
+  /// Get voxel count and extent of each label value in the image.
+  /// The metadata is kept up-to-date by the merge and modify operations of vtkOrientedImageDataResample.
+  /// If the image was modified by other means then the whole image is scanned to recompute it.
+  /// Returns nullptr if the image is not a labelmap (see vtkLabelmapMetadata).
+  vtkLabelmapMetadata* GetLabelmapMetadata();
+  /// Get the labelmap metadata only if it is up-to-date, without scanning the image.
+  /// Extents of labels that had voxels removed may not be exact, see vtkLabelmapMetadata::UpdateLabelExtents.
+  /// Returns nullptr if the metadata is not available.
+  vtkLabelmapMetadata* GetCachedLabelmapMetadata();
+  /// Set labelmap metadata that describes the current content of the image (metadata is copied)
+  void SetLabelmapMetadata(vtkLabelmapMetadata* metadata);
+
 protected:
   vtkOrientedImageData();
   ~vtkOrientedImageData() override;
@@ -96,6 +110,9 @@ protected:
   /// These are unit length direction cosines
   double Directions[3][3];
 
+  /// Label information of the image, created when first requested
+  vtkSmartPointer<vtkLabelmapMetadata> LabelmapMetadata;
+
 private:
   vtkOrientedImageData(const vtkOrientedImageData&) = delete;
   void operator=(const vtkOrientedImageData&) = delete;
@@ -20,8 +20,10 @@
 
 // SegmentationCore includes
 #include "vtkOrientedImageDataResample.h"
+#include "vtkLabelmapMetadata.h"
 #include "vtkSegmentationConverter.h"
 #include "vtkOrientedImageData.h"
+#include "vtkSparseLabelmap.h"
 
 // VTK includes
 #include <vtkAppendPolyData.h>
@@ -36,6 +38,7 @@
 #include <vtkObjectFactory.h>
 #include <vtkPlaneSource.h>
 #include <vtkPointData.h>
+#include <vtkSMPTools.h>
 #include <vtkSmartPointer.h>
 #include <vtkTransform.h>
 #include <vtkTransformPolyDataFilter.h>
@@ -44,10 +47,56 @@
 
 // STD includes
 #include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
 #include <vector>
 
 vtkStandardNewMacro(vtkOrientedImageDataResample);
 
+//----------------------------------------------------------------------------
+// Apply a row operation on all rows of the update extent, in parallel if there are enough voxels.
+// Returns true if any of the rows are modified.
+template <class BaseImageScalarType, class ModifierImageScalarType, class RowOperationType>
+bool MergeImageRows(
+    BaseImageScalarType* baseImagePtr, vtkIdType baseIncY, vtkIdType baseIncZ,
+    ModifierImageScalarType* modifierImagePtr, vtkIdType modifierIncY, vtkIdType modifierIncZ,
+    vtkIdType rowLength, vtkIdType numberOfRowsY, vtkIdType numberOfRowsZ,
+    RowOperationType& rowOperation)
+{
+  std::atomic<bool> modified(false);
+  auto mergeRows = [&](vtkIdType beginRow, vtkIdType endRow)
+    {
+    bool rowsModified = false;
+    for (vtkIdType row = beginRow; row < endRow; ++row)
+      {
+      vtkIdType y = row % numberOfRowsY;
+      vtkIdType z = row / numberOfRowsY;
+      if (rowOperation(baseImagePtr + z * baseIncZ + y * baseIncY, modifierImagePtr + z * modifierIncZ + y * modifierIncY, rowLength))
+        {
+        rowsModified = true;
+        }
+      }
+    if (rowsModified)
+      {
+      modified = true;
+      }
+    };
+
+  // Small updates (such as a paint brush stroke) are faster without the overhead of starting threads
+  const vtkIdType minimumNumberOfValuesForParallelMerge = 64 * 1024;
+  vtkIdType numberOfRows = numberOfRowsY * numberOfRowsZ;
+  if (numberOfRows * rowLength < minimumNumberOfValuesForParallelMerge)
+    {
+    mergeRows(0, numberOfRows);
+    }
+  else
+    {
+    vtkSMPTools::For(0, numberOfRows, mergeRows);
+    }
+  return modified;
+}
+
 //----------------------------------------------------------------------------
 // This templated function executes the filter for any type of data.
 template <class BaseImageScalarType, class ModifierImageScalarType>
@@ -88,18 +137,18 @@ void MergeImageGeneric2(
     return;
     }
 
-  // Get increments to march through data
+  // Get increments to march through data. Rows are contiguous in memory, in both images.
   vtkIdType baseIncX = 0;
   vtkIdType baseIncY = 0;
   vtkIdType baseIncZ = 0;
   vtkIdType modifierIncX = 0;
   vtkIdType modifierIncY = 0;
   vtkIdType modifierIncZ = 0;
-  baseImage->GetContinuousIncrements(updateExt, baseIncX, baseIncY, baseIncZ);
-  modifierImage->GetContinuousIncrements(updateExt, modifierIncX, modifierIncY, modifierIncZ);
-  int maxX = (updateExt[1] - updateExt[0]) * baseImage->GetNumberOfScalarComponents();
-  int maxY = updateExt[3] - updateExt[2];
-  int maxZ = updateExt[5] - updateExt[4];
+  baseImage->GetIncrements(baseIncX, baseIncY, baseIncZ);
+  modifierImage->GetIncrements(modifierIncX, modifierIncY, modifierIncZ);
+  vtkIdType rowLength = static_cast<vtkIdType>(updateExt[1] - updateExt[0] + 1) * baseImage->GetNumberOfScalarComponents();
+  vtkIdType numberOfRowsY = updateExt[3] - updateExt[2] + 1;
+  vtkIdType numberOfRowsZ = updateExt[5] - updateExt[4] + 1;
   BaseImageScalarType* baseImagePtr = static_cast<BaseImageScalarType*>(baseImage->GetScalarPointerForExtent(updateExt));
   ModifierImageScalarType* modifierImagePtr = static_cast<ModifierImageScalarType*>(modifierImage->GetScalarPointerForExtent(updateExt));
 
@@ -116,57 +165,54 @@ void MergeImageGeneric2(
 
   bool baseImageModified = false;
 
-  // Loop through output pixels
-  // There is difference in only one line between min/max computation but the comparison
-  // is performed for each pixel, so it is faster to make the conditional expression in the outer loop.
-  // Looping is performed in two step: first we just check if any of the pixels have to be changed,
-  // if we find any, then we set baseImageModified flag and to the second loop without need to set
-  // baseImageModified flag again (setting a flag in a hot loop may impact speed).
+  // Each row is processed in two steps: first we just check if any of the voxels have to be changed,
+  // and only if we find any, the row is written (typically most rows are not changed).
+  // The row loops have no data-dependent branches, which allows the compiler to vectorize them.
   if (operation == vtkOrientedImageDataResample::OPERATION_MAXIMUM)
     {
-    for (vtkIdType idxZ = 0; idxZ <= maxZ; idxZ++)
+    auto maximumRow = [](BaseImageScalarType* base, const ModifierImageScalarType* modifier, vtkIdType numberOfValues)
       {
-      for (vtkIdType idxY = 0; idxY <= maxY; idxY++)
+      int changed = 0;
+      for (vtkIdType i = 0; i < numberOfValues; ++i)
         {
-        for (vtkIdType idxX = 0; idxX <= maxX; idxX++)
-          {
-          if (static_cast<BaseImageScalarType>(*modifierImagePtr) > *baseImagePtr)
-            {
-            *baseImagePtr = *modifierImagePtr;
-            baseImageModified = true;
-            }
-          baseImagePtr++;
-          modifierImagePtr++;
-          }
-        baseImagePtr += baseIncY;
-        modifierImagePtr += modifierIncY;
+        changed |= (static_cast<BaseImageScalarType>(modifier[i]) > base[i]);
         }
-      baseImagePtr += baseIncZ;
-      modifierImagePtr += modifierIncZ;
-      }
+      if (!changed)
+        {
+        return false;
+        }
+      for (vtkIdType i = 0; i < numberOfValues; ++i)
+        {
+        BaseImageScalarType modifierValue = static_cast<BaseImageScalarType>(modifier[i]);
+        base[i] = (modifierValue > base[i] ? modifierValue : base[i]);
+        }
+      return true;
+      };
+    baseImageModified = MergeImageRows(baseImagePtr, baseIncY, baseIncZ, modifierImagePtr, modifierIncY, modifierIncZ,
+      rowLength, numberOfRowsY, numberOfRowsZ, maximumRow);
     }
   else if (operation == vtkOrientedImageDataResample::OPERATION_MINIMUM)
     {
-    for (vtkIdType idxZ = 0; idxZ <= maxZ; idxZ++)
+    auto minimumRow = [](BaseImageScalarType* base, const ModifierImageScalarType* modifier, vtkIdType numberOfValues)
       {
-      for (vtkIdType idxY = 0; idxY <= maxY; idxY++)
+      int changed = 0;
+      for (vtkIdType i = 0; i < numberOfValues; ++i)
         {
-        for (vtkIdType idxX = 0; idxX <= maxX; idxX++)
-          {
-          if (static_cast<BaseImageScalarType>(*modifierImagePtr) < *baseImagePtr)
-            {
-            *baseImagePtr = *modifierImagePtr;
-            baseImageModified = true;
-            }
-          baseImagePtr++;
-          modifierImagePtr++;
-          }
-        baseImagePtr += baseIncY;
-        modifierImagePtr += modifierIncY;
+        changed |= (static_cast<BaseImageScalarType>(modifier[i]) < base[i]);
         }
-      baseImagePtr += baseIncZ;
-      modifierImagePtr += modifierIncZ;
-      }
+      if (!changed)
+        {
+        return false;
+        }
+      for (vtkIdType i = 0; i < numberOfValues; ++i)
+        {
+        BaseImageScalarType modifierValue = static_cast<BaseImageScalarType>(modifier[i]);
+        base[i] = (modifierValue < base[i] ? modifierValue : base[i]);
+        }
+      return true;
+      };
+    baseImageModified = MergeImageRows(baseImagePtr, baseIncY, baseIncZ, modifierImagePtr, modifierIncY, modifierIncZ,
+      rowLength, numberOfRowsY, numberOfRowsZ, minimumRow);
     }
   else if (operation == vtkOrientedImageDataResample::OPERATION_MASKING)
     {
@@ -201,29 +247,32 @@ void MergeImageGeneric2(
       maskThresholdModifierType = static_cast<ModifierImageScalarType>(maskThreshold);
       }
 
-    for (vtkIdType idxZ = 0; idxZ <= maxZ; idxZ++)
+    auto maskingRow = [fillValueBaseImageType, maskThresholdModifierType](
+      BaseImageScalarType* base, const ModifierImageScalarType* modifier, vtkIdType numberOfValues)
       {
-      for (vtkIdType idxY = 0; idxY <= maxY; idxY++)
+      // Only voxels that get a different value count as change
+      int changed = 0;
+      for (vtkIdType i = 0; i < numberOfValues; ++i)
         {
-        for (vtkIdType idxX = 0; idxX <= maxX; idxX++)
-          {
-          if ((*modifierImagePtr) > maskThresholdModifierType)
-            {
-            *baseImagePtr = fillValueBaseImageType;
-            baseImageModified = true;
-            }
-          baseImagePtr++;
-          modifierImagePtr++;
+        changed |= ((modifier[i] > maskThresholdModifierType) & (base[i] != fillValueBaseImageType));
         }
-        baseImagePtr += baseIncY;
-        modifierImagePtr += modifierIncY;
+      if (!changed)
+        {
+        return false;
         }
-      baseImagePtr += baseIncZ;
-      modifierImagePtr += modifierIncZ;
-      }
+      for (vtkIdType i = 0; i < numberOfValues; ++i)
+        {
+        base[i] = (modifier[i] > maskThresholdModifierType ? fillValueBaseImageType : base[i]);
+        }
+      return true;
+      };
+    baseImageModified = MergeImageRows(baseImagePtr, baseIncY, baseIncZ, modifierImagePtr, modifierIncY, modifierIncZ,
+      rowLength, numberOfRowsY, numberOfRowsZ, maskingRow);
     }
   if (baseImageModified)
     {
+    // The scalars may be shared with other images, mark them modified so that their labelmap metadata is invalidated
+    baseImage->GetPointData()->GetScalars()->Modified();
     baseImage->Modified();
     }
 }
@@ -252,6 +301,223 @@ void MergeImageGeneric(
     }
 }
 
+//----------------------------------------------------------------------------
+// Merge the modifier image into the base image. If the base image has up-to-date labelmap metadata
+// then only the update extent is rescanned to keep the metadata up-to-date.
+bool MergeImageAndUpdateMetadata(
+    vtkOrientedImageData* baseImage,
+    vtkOrientedImageData* modifierImage,
+    int operation,
+    const int extent[6],
+    double maskThreshold,
+    double fillValue)
+{
+  int updateExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  baseImage->GetExtent(updateExtent);
+  int* modifierExtent = modifierImage->GetExtent();
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    updateExtent[2 * axis] = std::max(updateExtent[2 * axis], modifierExtent[2 * axis]);
+    updateExtent[2 * axis + 1] = std::min(updateExtent[2 * axis + 1], modifierExtent[2 * axis + 1]);
+    if (extent)
+      {
+      updateExtent[2 * axis] = std::max(updateExtent[2 * axis], extent[2 * axis]);
+      updateExtent[2 * axis + 1] = std::min(updateExtent[2 * axis + 1], extent[2 * axis + 1]);
+      }
+    }
+  bool updateExtentValid = (updateExtent[0] <= updateExtent[1] && updateExtent[2] <= updateExtent[3] && updateExtent[4] <= updateExtent[5]);
+
+  vtkLabelmapMetadata* metadata = (updateExtentValid ? baseImage->GetCachedLabelmapMetadata() : nullptr);
+  vtkLabelmapMetadata::LabelInfoMap labelsBefore;
+  if (metadata && !vtkLabelmapMetadata::ComputeLabelInfo(baseImage, updateExtent, labelsBefore))
+    {
+    metadata = nullptr;
+    }
+
+  switch (baseImage->GetScalarType())
+    {
+    vtkTemplateMacro(MergeImageGeneric<VTK_TT>(
+                       baseImage,
+                       modifierImage,
+                       operation,
+                       extent,
+                       maskThreshold,
+                       fillValue));
+  default:
+    vtkGenericWarningMacro("vtkOrientedImageDataResample::MergeImage: Unknown ScalarType");
+    return false;
+    }
+
+  if (metadata)
+    {
+    metadata->UpdateRegion(baseImage, updateExtent, labelsBefore);
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// Sparse labelmap version of MergeImageGeneric2. Each row of the update extent is decoded into a buffer,
+// combined with the modifier, and re-encoded only if any of its voxels changed.
+template <class ModifierImageScalarType>
+void MergeSparseLabelmapGeneric(
+    vtkSparseLabelmap *baseLabelmap,
+    vtkImageData *modifierImage,
+    int operation,
+    const int extent[6]/*=nullptr*/,
+    double maskThreshold,
+    double fillValue)
+{
+  // Compute update extent as intersection of base and modifier image extents (extent can be further reduced by specifying a smaller extent)
+  int updateExt[6] = { 0, -1, 0, -1, 0, -1 };
+  baseLabelmap->GetExtent(updateExt);
+  int* modifierExt = modifierImage->GetExtent();
+  for (int idx = 0; idx < 3; ++idx)
+    {
+    updateExt[idx * 2] = std::max(updateExt[idx * 2], modifierExt[idx * 2]);
+    updateExt[idx * 2 + 1] = std::min(updateExt[idx * 2 + 1], modifierExt[idx * 2 + 1]);
+    if (extent)
+      {
+      updateExt[idx * 2] = std::max(updateExt[idx * 2], extent[idx * 2]);
+      updateExt[idx * 2 + 1] = std::min(updateExt[idx * 2 + 1], extent[idx * 2 + 1]);
+      }
+    }
+  if (updateExt[0] > updateExt[1] || updateExt[2] > updateExt[3] || updateExt[4] > updateExt[5])
+    {
+    // base and modifier images don't intersect, nothing need to be done
+    return;
+    }
+
+  ModifierImageScalarType* modifierImagePtr = static_cast<ModifierImageScalarType*>(modifierImage->GetScalarPointerForExtent(updateExt));
+  if (modifierImagePtr == nullptr)
+    {
+    vtkGenericWarningMacro("vtkOrientedImageDataResample::MergeSparseLabelmapGeneric: Modifier image pointer is invalid");
+    return;
+    }
+  vtkIdType modifierIncX = 0;
+  vtkIdType modifierIncY = 0;
+  vtkIdType modifierIncZ = 0;
+  modifierImage->GetIncrements(modifierIncX, modifierIncY, modifierIncZ);
+
+  // Make sure the fill value is valid for the labelmap value range (sparse labelmap values are int)
+  int fillValueBaseType = static_cast<int>(std::max(double(VTK_INT_MIN), std::min(double(VTK_INT_MAX), fillValue)));
+
+  // Make sure the threshold is valid for the modifier scalar range
+  ModifierImageScalarType maskThresholdModifierType = 0;
+  if (maskThreshold < modifierImage->GetScalarTypeMin())
+    {
+    maskThresholdModifierType = static_cast<ModifierImageScalarType>(modifierImage->GetScalarTypeMin());
+    }
+  else if (maskThreshold > modifierImage->GetScalarTypeMax())
+    {
+    maskThresholdModifierType = static_cast<ModifierImageScalarType>(modifierImage->GetScalarTypeMax());
+    }
+  else
+    {
+    maskThresholdModifierType = static_cast<ModifierImageScalarType>(maskThreshold);
+    }
+
+  int rowLength = updateExt[1] - updateExt[0] + 1;
+  std::vector<int> rowValues(rowLength);
+  std::map<vtkSparseLabelmap::RowKey, std::vector<vtkSparseLabelmap::Run> > modifiedRows;
+  for (int k = updateExt[4]; k <= updateExt[5]; ++k)
+    {
+    for (int j = updateExt[2]; j <= updateExt[3]; ++j)
+      {
+      ModifierImageScalarType* modifierRowPtr = modifierImagePtr
+        + (k - updateExt[4]) * modifierIncZ + (j - updateExt[2]) * modifierIncY;
+
+      // Decode the base row within the update extent
+      vtkIdType numberOfRuns = 0;
+      const vtkSparseLabelmap::Run* runs = baseLabelmap->GetRowRuns(j, k, numberOfRuns);
+      std::fill(rowValues.begin(), rowValues.end(), 0);
+      for (vtkIdType runIndex = 0; runIndex < numberOfRuns; ++runIndex)
+        {
+        int start = std::max(runs[runIndex].Start, updateExt[0]);
+        int end = std::min(runs[runIndex].End, updateExt[1]);
+        for (int i = start; i <= end; ++i)
+          {
+          rowValues[i - updateExt[0]] = runs[runIndex].Value;
+          }
+        }
+
+      bool rowModified = false;
+      if (operation == vtkOrientedImageDataResample::OPERATION_MAXIMUM)
+        {
+        for (int x = 0; x < rowLength; ++x)
+          {
+          int modifierValue = static_cast<int>(modifierRowPtr[x * modifierIncX]);
+          if (modifierValue > rowValues[x])
+            {
+            rowValues[x] = modifierValue;
+            rowModified = true;
+            }
+          }
+        }
+      else if (operation == vtkOrientedImageDataResample::OPERATION_MINIMUM)
+        {
+        for (int x = 0; x < rowLength; ++x)
+          {
+          int modifierValue = static_cast<int>(modifierRowPtr[x * modifierIncX]);
+          if (modifierValue < rowValues[x])
+            {
+            rowValues[x] = modifierValue;
+            rowModified = true;
+            }
+          }
+        }
+      else if (operation == vtkOrientedImageDataResample::OPERATION_MASKING)
+        {
+        for (int x = 0; x < rowLength; ++x)
+          {
+          if (modifierRowPtr[x * modifierIncX] > maskThresholdModifierType && rowValues[x] != fillValueBaseType)
+            {
+            rowValues[x] = fillValueBaseType;
+            rowModified = true;
+            }
+          }
+        }
+      if (!rowModified)
+        {
+        continue;
+        }
+
+      // Encode the row: runs before the update extent, the updated voxels, then runs after the update extent
+      std::vector<vtkSparseLabelmap::Run>& newRuns = modifiedRows[vtkSparseLabelmap::RowKey(k, j)];
+      auto appendRun = [&newRuns](int start, int end, int value)
+        {
+        if (!newRuns.empty() && newRuns.back().End == start - 1 && newRuns.back().Value == value)
+          {
+          newRuns.back().End = end;
+          }
+        else
+          {
+          newRuns.push_back({ start, end, value });
+          }
+        };
+      for (vtkIdType runIndex = 0; runIndex < numberOfRuns && runs[runIndex].Start < updateExt[0]; ++runIndex)
+        {
+        appendRun(runs[runIndex].Start, std::min(runs[runIndex].End, updateExt[0] - 1), runs[runIndex].Value);
+        }
+      for (int x = 0; x < rowLength; ++x)
+        {
+        if (rowValues[x] != 0)
+          {
+          appendRun(updateExt[0] + x, updateExt[0] + x, rowValues[x]);
+          }
+        }
+      for (vtkIdType runIndex = 0; runIndex < numberOfRuns; ++runIndex)
+        {
+        if (runs[runIndex].End > updateExt[1])
+          {
+          appendRun(std::max(runs[runIndex].Start, updateExt[1] + 1), runs[runIndex].End, runs[runIndex].Value);
+          }
+        }
+      }
+    }
+
+  baseLabelmap->ReplaceRows(modifiedRows);
+}
+
 //----------------------------------------------------------------------------
 vtkOrientedImageDataResample::vtkOrientedImageDataResample() = default;
 
@@ -597,59 +863,84 @@ template <typename T> void CalculateEffectiveExtentGeneric(vtkOrientedImageData*
   effectiveExtent[4] = wholeExt[5]+1;
   effectiveExtent[5] = wholeExt[4]-1;
 
-  if (image->GetScalarPointer() == nullptr)
+  T* imageStartPtr = static_cast<T*>(image->GetScalarPointer());
+  if (imageStartPtr == nullptr)
     {
     // no image data is allocated, return with empty extent
     return;
     }
+  vtkIdType incX = 0;
+  vtkIdType incY = 0;
+  vtkIdType incZ = 0;
+  image->GetIncrements(incX, incY, incZ);
 
-  // Loop through output pixels
-  for (int k = wholeExt[4]; k <= wholeExt[5]; k++)
+  // Ranges of slices are processed in parallel, their effective extents are combined at the end
+  std::mutex effectiveExtentMutex;
+  auto calculateRangeExtent = [&](vtkIdType beginK, vtkIdType endK)
     {
-    for (int j = wholeExt[2]; j <= wholeExt[3]; j++)
+    int rangeExtent[6] = { wholeExt[1] + 1, wholeExt[0] - 1, wholeExt[3] + 1, wholeExt[2] - 1, wholeExt[5] + 1, wholeExt[4] - 1 };
+    for (int k = static_cast<int>(beginK); k < static_cast<int>(endK); k++)
       {
-      bool currentLineInEffectiveExtent = (k >= effectiveExtent[4] && k <= effectiveExtent[5] && j >= effectiveExtent[2] && j <= effectiveExtent[3]);
-      int i = wholeExt[0];
-      T* imagePtr = static_cast<T*>(image->GetScalarPointer(i,j,k));
-      int firstSegmentEnd = currentLineInEffectiveExtent ? effectiveExtent[0] : wholeExt[1];
-      for (; i <= firstSegmentEnd; i++)
+      for (int j = wholeExt[2]; j <= wholeExt[3]; j++)
         {
-        if (*(imagePtr++) > threshold)
+        bool currentLineInEffectiveExtent = (k >= rangeExtent[4] && k <= rangeExtent[5] && j >= rangeExtent[2] && j <= rangeExtent[3]);
+        T* linePtr = imageStartPtr + (k - wholeExt[4]) * incZ + (j - wholeExt[2]) * incY;
+        int i = wholeExt[0];
+        T* imagePtr = linePtr;
+        int firstSegmentEnd = currentLineInEffectiveExtent ? rangeExtent[0] : wholeExt[1];
+        for (; i <= firstSegmentEnd; i++)
           {
-          if (i < effectiveExtent[0]) { effectiveExtent[0] = i; }
-          if (i > effectiveExtent[1]) { effectiveExtent[1] = i; }
-          if (j < effectiveExtent[2]) { effectiveExtent[2] = j; }
-          if (j > effectiveExtent[3]) { effectiveExtent[3] = j; }
-          if (k < effectiveExtent[4]) { effectiveExtent[4] = k; }
-          if (k > effectiveExtent[5]) { effectiveExtent[5] = k; }
-          currentLineInEffectiveExtent = true;
-          break;
+          if (*imagePtr > threshold)
+            {
+            if (i < rangeExtent[0]) { rangeExtent[0] = i; }
+            if (i > rangeExtent[1]) { rangeExtent[1] = i; }
+            if (j < rangeExtent[2]) { rangeExtent[2] = j; }
+            if (j > rangeExtent[3]) { rangeExtent[3] = j; }
+            if (k < rangeExtent[4]) { rangeExtent[4] = k; }
+            if (k > rangeExtent[5]) { rangeExtent[5] = k; }
+            currentLineInEffectiveExtent = true;
+            break;
+            }
+          imagePtr += incX;
           }
-        }
-      if (!currentLineInEffectiveExtent)
-        {
-        // We haven't found any non-empty voxel in this line
-        continue;
-        }
-      // Now we need to find the other end of the extent: the last non-empty voxel in the line.
-      // The fastest way to find it is to start backward search from the end of the line.
-      i = wholeExt[1];
-      imagePtr = static_cast<T*>(image->GetScalarPointer(i,j,k));
-      for (; i > effectiveExtent[1]; i--)
-        {
-        if (*(imagePtr--)>threshold)
+        if (!currentLineInEffectiveExtent)
+          {
+          // We haven't found any non-empty voxel in this line
+          continue;
+          }
+        // Now we need to find the other end of the extent: the last non-empty voxel in the line.
+        // The fastest way to find it is to start backward search from the end of the line.
+        i = wholeExt[1];
+        imagePtr = linePtr + (wholeExt[1] - wholeExt[0]) * incX;
+        for (; i > rangeExtent[1]; i--)
           {
-          if (i < effectiveExtent[0]) { effectiveExtent[0] = i; }
-          if (i > effectiveExtent[1]) { effectiveExtent[1] = i; }
-          if (j < effectiveExtent[2]) { effectiveExtent[2] = j; }
-          if (j > effectiveExtent[3]) { effectiveExtent[3] = j; }
-          if (k < effectiveExtent[4]) { effectiveExtent[4] = k; }
-          if (k > effectiveExtent[5]) { effectiveExtent[5] = k; }
-          break;
+          if (*imagePtr > threshold)
+            {
+            if (i < rangeExtent[0]) { rangeExtent[0] = i; }
+            if (i > rangeExtent[1]) { rangeExtent[1] = i; }
+            if (j < rangeExtent[2]) { rangeExtent[2] = j; }
+            if (j > rangeExtent[3]) { rangeExtent[3] = j; }
+            if (k < rangeExtent[4]) { rangeExtent[4] = k; }
+            if (k > rangeExtent[5]) { rangeExtent[5] = k; }
+            break;
+            }
+          imagePtr -= incX;
           }
         }
       }
-    }
+    if (rangeExtent[0] > rangeExtent[1])
+      {
+      // no non-empty voxel in this range
+      return;
+      }
+    std::lock_guard<std::mutex> lock(effectiveExtentMutex);
+    for (int axis = 0; axis < 3; ++axis)
+      {
+      effectiveExtent[axis * 2] = std::min(effectiveExtent[axis * 2], rangeExtent[axis * 2]);
+      effectiveExtent[axis * 2 + 1] = std::max(effectiveExtent[axis * 2 + 1], rangeExtent[axis * 2 + 1]);
+      }
+    };
+  vtkSMPTools::For(wholeExt[4], wholeExt[5] + 1, calculateRangeExtent);
 }
 
 //----------------------------------------------------------------------------
@@ -660,6 +951,14 @@ bool vtkOrientedImageDataResample::CalculateEffectiveExtent(vtkOrientedImageData
     return false;
     }
 
+  // Use the label extents if they are already available, as it does not require scanning the whole image
+  vtkLabelmapMetadata* metadata = image->GetCachedLabelmapMetadata();
+  if (metadata && threshold >= 0.0)
+    {
+    metadata->UpdateLabelExtents(image);
+    return metadata->GetEffectiveExtent(effectiveExtent, threshold);
+    }
+
   switch (image->GetScalarType())
     {
     vtkTemplateMacro(CalculateEffectiveExtentGeneric<VTK_TT>(image, effectiveExtent, threshold));
@@ -677,6 +976,16 @@ bool vtkOrientedImageDataResample::CalculateEffectiveExtent(vtkOrientedImageData
   return true;
 }
 
+//----------------------------------------------------------------------------
+bool vtkOrientedImageDataResample::CalculateEffectiveExtent(vtkSparseLabelmap* labelmap, int effectiveExtent[6], double threshold /*=0.0*/)
+{
+  if (!labelmap)
+    {
+    return false;
+    }
+  return labelmap->GetEffectiveExtent(effectiveExtent, threshold);
+}
+
 //----------------------------------------------------------------------------
 bool vtkOrientedImageDataResample::DoGeometriesMatch(vtkOrientedImageData* image1, vtkOrientedImageData* image2)
 {
@@ -684,14 +993,36 @@ bool vtkOrientedImageDataResample::DoGeometriesMatch(vtkOrientedImageData* image
     {
     return false;
     }
+  if (image1 == image2)
+    {
+    return true;
+    }
 
-  vtkSmartPointer<vtkMatrix4x4> image1ToWorldMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
-  image1->GetImageToWorldMatrix(image1ToWorldMatrix);
-
-  vtkSmartPointer<vtkMatrix4x4> image2ToWorldMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
-  image2->GetImageToWorldMatrix(image2ToWorldMatrix);
-
-  return vtkOrientedImageDataResample::IsEqual(image1ToWorldMatrix, image2ToWorldMatrix);
+  // Compare the elements of the image to world matrices without constructing the matrices,
+  // as this check is performed before each labelmap modification.
+  double* origin1 = image1->GetOrigin();
+  double* origin2 = image2->GetOrigin();
+  double* spacing1 = image1->GetSpacing();
+  double* spacing2 = image2->GetSpacing();
+  double directions1[3][3] = { { 1.0, 0.0, 0.0 }, { 0.0, 1.0, 0.0 }, { 0.0, 0.0, 1.0 } };
+  double directions2[3][3] = { { 1.0, 0.0, 0.0 }, { 0.0, 1.0, 0.0 }, { 0.0, 0.0, 1.0 } };
+  image1->GetDirections(directions1);
+  image2->GetDirections(directions2);
+  for (int row = 0; row < 3; ++row)
+    {
+    for (int column = 0; column < 3; ++column)
+      {
+      if (!AreEqualWithTolerance(spacing1[column] * directions1[row][column], spacing2[column] * directions2[row][column]))
+        {
+        return false;
+        }
+      }
+    if (!AreEqualWithTolerance(origin1[row], origin2[row]))
+      {
+      return false;
+      }
+    }
+  return true;
 }
 
 //----------------------------------------------------------------------------
@@ -1126,16 +1457,107 @@ bool vtkOrientedImageDataResample::MergeImage(
     vtkGenericWarningMacro("vtkOrientedImageDataResample::MergeImage failed: geometry mismatch between inputImage and imageToAppend");
     return false;
     }
+  vtkSmartPointer<vtkLabelmapMetadata> inputMetadata = inputImage->GetCachedLabelmapMetadata();
   if (!vtkOrientedImageDataResample::PadImageToContainImage(inputImage, imageToAppend, outputImage, extent))
     {
     vtkGenericWarningMacro("vtkOrientedImageDataResample::MergeImage: Failed to pad segment labelmap");
     return false;
     }
+  if (inputMetadata)
+    {
+    // Padding only adds background voxels, so the label information of the input is valid for the output
+    outputImage->SetLabelmapMetadata(inputMetadata);
+    }
   vtkMTimeType outputImageMTimeBefore = outputImage->GetMTime();
-  switch (inputImage->GetScalarType())
+  if (!MergeImageAndUpdateMetadata(outputImage, imageToAppend, operation, extent, maskThreshold, fillValue))
     {
-    vtkTemplateMacro(MergeImageGeneric<VTK_TT>(
-                       outputImage,
+    return false;
+    }
+  vtkMTimeType outputImageMTimeAfter = outputImage->GetMTime();
+  if (outputModified != nullptr)
+    {
+    (*outputModified) = (outputImageMTimeBefore<outputImageMTimeAfter);
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkOrientedImageDataResample::ModifyImage(
+    vtkOrientedImageData* inputImage,
+    vtkOrientedImageData* modifierImage,
+    int operation,
+    const int extent[6]/*=0*/,
+    double maskThreshold /*=0*/,
+    double fillValue /*=1*/)
+{
+  if (!inputImage || !modifierImage)
+    {
+    return false;
+    }
+  if (!vtkOrientedImageDataResample::DoGeometriesMatch(inputImage, modifierImage))
+    {
+    vtkGenericWarningMacro("vtkOrientedImageDataResample::ModifyImage failed: geometry mismatch between inputImage and modifierImage");
+    return false;
+    }
+  return MergeImageAndUpdateMetadata(inputImage, modifierImage, operation, extent, maskThreshold, fillValue);
+}
+
+//----------------------------------------------------------------------------
+bool vtkOrientedImageDataResample::MergeImage(
+    vtkSparseLabelmap* inputLabelmap,
+    vtkOrientedImageData* imageToAppend,
+    vtkSparseLabelmap* outputLabelmap,
+    int operation,
+    const int extent[6]/*=nullptr*/,
+    double maskThreshold /*=0*/,
+    double fillValue /*=1*/,
+    bool *outputModified /*=nullptr*/)
+{
+  if (outputModified != nullptr)
+    {
+    (*outputModified) = false;
+    }
+  if (!inputLabelmap || !imageToAppend || !outputLabelmap)
+    {
+    return false;
+    }
+
+  vtkNew<vtkMatrix4x4> inputLabelmapToWorldMatrix;
+  inputLabelmap->GetImageToWorldMatrix(inputLabelmapToWorldMatrix);
+  vtkNew<vtkMatrix4x4> imageToAppendToWorldMatrix;
+  imageToAppend->GetImageToWorldMatrix(imageToAppendToWorldMatrix);
+  if (!vtkOrientedImageDataResample::IsEqual(inputLabelmapToWorldMatrix, imageToAppendToWorldMatrix))
+    {
+    vtkGenericWarningMacro("vtkOrientedImageDataResample::MergeImage failed: geometry mismatch between inputLabelmap and imageToAppend");
+    return false;
+    }
+
+  // Grow the output extent to contain the appended region. Only the extent changes, no voxels need to be allocated.
+  const int* containedExtent = extent ? extent : imageToAppend->GetExtent();
+  if (containedExtent[0] > containedExtent[1] || containedExtent[2] > containedExtent[3] || containedExtent[4] > containedExtent[5])
+    {
+    vtkGenericWarningMacro("vtkOrientedImageDataResample::MergeImage: Failed to pad segment labelmap");
+    return false;
+    }
+  if (outputLabelmap != inputLabelmap)
+    {
+    outputLabelmap->DeepCopy(inputLabelmap);
+    }
+  int outputExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  outputLabelmap->GetExtent(outputExtent);
+  bool outputExtentEmpty = (outputExtent[0] > outputExtent[1] || outputExtent[2] > outputExtent[3] || outputExtent[4] > outputExtent[5]);
+  for (int i = 0; i < 3; ++i)
+    {
+    outputExtent[2 * i] = (outputExtentEmpty ? containedExtent[2 * i] : std::min(outputExtent[2 * i], containedExtent[2 * i]));
+    outputExtent[2 * i + 1] = (outputExtentEmpty ? containedExtent[2 * i + 1] : std::max(outputExtent[2 * i + 1], containedExtent[2 * i + 1]));
+    }
+  outputLabelmap->SetExtent(outputExtent);
+
+  vtkMTimeType outputLabelmapMTimeBefore = outputLabelmap->GetMTime();
+  switch (imageToAppend->GetScalarType())
+    {
+    vtkTemplateMacro(MergeSparseLabelmapGeneric<VTK_TT>(
+                       outputLabelmap,
                        imageToAppend,
                        operation,
                        extent,
@@ -1145,36 +1567,40 @@ bool vtkOrientedImageDataResample::MergeImage(
     vtkGenericWarningMacro("vtkOrientedImageDataResample::MergeImage: Unknown ScalarType");
     return false;
     }
-  vtkMTimeType outputImageMTimeAfter = outputImage->GetMTime();
+  vtkMTimeType outputLabelmapMTimeAfter = outputLabelmap->GetMTime();
   if (outputModified != nullptr)
     {
-    (*outputModified) = (outputImageMTimeBefore<outputImageMTimeAfter);
+    (*outputModified) = (outputLabelmapMTimeBefore < outputLabelmapMTimeAfter);
     }
   return true;
 }
 
 //----------------------------------------------------------------------------
 bool vtkOrientedImageDataResample::ModifyImage(
-    vtkOrientedImageData* inputImage,
+    vtkSparseLabelmap* inputLabelmap,
     vtkOrientedImageData* modifierImage,
     int operation,
     const int extent[6]/*=0*/,
     double maskThreshold /*=0*/,
     double fillValue /*=1*/)
 {
-  if (!inputImage || !modifierImage)
+  if (!inputLabelmap || !modifierImage)
     {
     return false;
     }
-  if (!vtkOrientedImageDataResample::DoGeometriesMatch(inputImage, modifierImage))
+  vtkNew<vtkMatrix4x4> inputLabelmapToWorldMatrix;
+  inputLabelmap->GetImageToWorldMatrix(inputLabelmapToWorldMatrix);
+  vtkNew<vtkMatrix4x4> modifierImageToWorldMatrix;
+  modifierImage->GetImageToWorldMatrix(modifierImageToWorldMatrix);
+  if (!vtkOrientedImageDataResample::IsEqual(inputLabelmapToWorldMatrix, modifierImageToWorldMatrix))
     {
-    vtkGenericWarningMacro("vtkOrientedImageDataResample::ModifyImage failed: geometry mismatch between inputImage and modifierImage");
+    vtkGenericWarningMacro("vtkOrientedImageDataResample::ModifyImage failed: geometry mismatch between inputLabelmap and modifierImage");
     return false;
     }
-  switch (inputImage->GetScalarType())
+  switch (modifierImage->GetScalarType())
     {
-    vtkTemplateMacro(MergeImageGeneric<VTK_TT>(
-                       inputImage,
+    vtkTemplateMacro(MergeSparseLabelmapGeneric<VTK_TT>(
+                       inputLabelmap,
                        modifierImage,
                        operation,
                        extent,
@@ -1461,6 +1887,33 @@ bool vtkOrientedImageDataResample::ApplyImageMask(vtkOrientedImageData* input, v
   return true;
 }
 
+//----------------------------------------------------------------------------
+// Get the extent that contains all non-zero labels of the labelmap, if the labelmap metadata is up-to-date.
+// Returns false if the extent is not known without scanning the labelmap.
+bool GetCachedLabelsExtent(vtkOrientedImageData* labelmap, int labelsExtent[6])
+{
+  vtkLabelmapMetadata* metadata = labelmap->GetCachedLabelmapMetadata();
+  if (!metadata)
+    {
+    return false;
+    }
+  metadata->UpdateLabelExtents(labelmap);
+  int emptyExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  std::copy(emptyExtent, emptyExtent + 6, labelsExtent);
+  bool labelsExtentValid = false;
+  for (const auto& label : metadata->GetLabels())
+    {
+    const int* labelExtent = label.second.Extent;
+    for (int axis = 0; axis < 3; ++axis)
+      {
+      labelsExtent[2 * axis] = labelsExtentValid ? std::min(labelsExtent[2 * axis], labelExtent[2 * axis]) : labelExtent[2 * axis];
+      labelsExtent[2 * axis + 1] = labelsExtentValid ? std::max(labelsExtent[2 * axis + 1], labelExtent[2 * axis + 1]) : labelExtent[2 * axis + 1];
+      }
+    labelsExtentValid = true;
+    }
+  return true;
+}
+
 //----------------------------------------------------------------------------
 template <class ImageScalarType, class MaskScalarType>
 void GetLabelValuesInMaskGeneric2(
@@ -1635,6 +2088,12 @@ void vtkOrientedImageDataResample::GetLabelValuesInMask(std::vector<int>& labelV
   int maskExtent[6] = { 0 };
   mask->GetExtent(maskExtent);
 
+  // Only the region that contains labels needs to be scanned
+  if (vtkOrientedImageDataResample::DoGeometriesMatch(binaryLabelmap, mask))
+    {
+    GetCachedLabelsExtent(binaryLabelmap, binaryExtent);
+    }
+
   int effectiveExtent[6] = { 0 };
   for (int i = 0; i < 3; ++i)
     {
@@ -1793,6 +2252,12 @@ bool vtkOrientedImageDataResample::IsLabelInMask(
 
   int binaryExtent[6] = { 0 };
   binaryLabelmap->GetExtent(binaryExtent);
+  // Only the region that contains labels needs to be scanned
+  GetCachedLabelsExtent(binaryLabelmap, binaryExtent);
+  if (binaryExtent[0] > binaryExtent[1] || binaryExtent[2] > binaryExtent[3] || binaryExtent[4] > binaryExtent[5])
+    {
+    return false;
+    }
   vtkOrientedImageDataResample::TransformExtent(binaryExtent, binaryToMaskTransform, binaryExtent);
 
   int maskExtent[6] = { 0 };
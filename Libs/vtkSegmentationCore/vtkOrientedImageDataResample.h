@@ -34,6 +34,7 @@
 class vtkImageData;
 class vtkMatrix4x4;
 class vtkOrientedImageData;
+class vtkSparseLabelmap;
 class vtkTransform;
 class vtkAbstractTransform;
 
@@ -95,6 +96,15 @@ public:
   static bool ModifyImage(vtkOrientedImageData* inputImage, vtkOrientedImageData* modifierImage, int operation,
     const int extent[6] = nullptr, double maskThreshold = 0, double fillValue = 1);
 
+  /// Combines the inputLabelmap and imageToAppend into outputLabelmap, same as MergeImage for oriented image data.
+  /// Only the rows of the sparse labelmap that intersect the modified region are re-encoded.
+  static bool MergeImage(vtkSparseLabelmap* inputLabelmap, vtkOrientedImageData* imageToAppend, vtkSparseLabelmap* outputLabelmap, int operation,
+    const int extent[6]=nullptr, double maskThreshold = 0, double fillValue = 1, bool *outputModified=nullptr);
+
+  /// Modifies inputLabelmap in-place by combining with modifierImage, same as ModifyImage for oriented image data.
+  static bool ModifyImage(vtkSparseLabelmap* inputLabelmap, vtkOrientedImageData* modifierImage, int operation,
+    const int extent[6] = nullptr, double maskThreshold = 0, double fillValue = 1);
+
   /// Copy image with clipping to the specified extent
   static bool CopyImage(vtkOrientedImageData* imageToCopy, vtkOrientedImageData* outputImage, const int extent[6]=nullptr);
 
@@ -106,8 +116,11 @@ public:
   static void FillImage(vtkImageData* image, double fillValue, const int extent[6]=nullptr);
 
 public:
-  /// Calculate effective extent of an image: the IJK extent where non-zero voxels are located
+  /// Calculate effective extent of an image: the IJK extent where non-zero voxels are located.
+  /// If up-to-date labelmap metadata is available for the image then the image is not scanned.
   static bool CalculateEffectiveExtent(vtkOrientedImageData* image, int effectiveExtent[6], double threshold = 0.0);
+  /// Calculate effective extent of a sparse labelmap. Only the stored runs are visited.
+  static bool CalculateEffectiveExtent(vtkSparseLabelmap* labelmap, int effectiveExtent[6], double threshold = 0.0);
 
   /// Determine if geometries of two oriented image data objects match.
   /// Origin, spacing and direction are considered, extent is not.
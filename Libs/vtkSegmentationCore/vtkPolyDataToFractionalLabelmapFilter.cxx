@@ -38,11 +38,13 @@
 #include <vtkPolyDataNormals.h>
 #include <vtkTriangleFilter.h>
 #include <vtkStripper.h>
-#include <vtkImageStencil.h>
-#include <vtkImageCast.h>
+#include <vtkSMPTools.h>
 
 // std includes
+#include <algorithm>
+#include <cmath>
 #include <map>
+#include <vector>
 
 vtkStandardNewMacro(vtkPolyDataToFractionalLabelmapFilter);
 
@@ -51,14 +53,6 @@ vtkPolyDataToFractionalLabelmapFilter::vtkPolyDataToFractionalLabelmapFilter()
 {
   this->NumberOfOffsets = 6;
 
-  this->LinesCache = std::map<double, vtkSmartPointer<vtkCellArray> >();
-  this->SliceCache = std::map<double, vtkSmartPointer<vtkPolyData> >();
-  this->PointIdsCache = std::map<double, vtkIdType*>();
-  this->NptsCache = std::map<double, vtkIdType>();
-  this->PointNeighborCountsCache = std::map<double,  vtkSmartPointer<vtkIdTypeArray> >();
-
-  this->CellLocator = vtkCellLocator::New();
-
   this->OutputImageTransformData = vtkOrientedImageData::New();
 
   vtkOrientedImageData* output = vtkOrientedImageData::New();
@@ -73,7 +67,6 @@ vtkPolyDataToFractionalLabelmapFilter::vtkPolyDataToFractionalLabelmapFilter()
 vtkPolyDataToFractionalLabelmapFilter::~vtkPolyDataToFractionalLabelmapFilter()
 {
   this->OutputImageTransformData->Delete();
-  this->CellLocator->Delete();
 }
 
 //----------------------------------------------------------------------------
@@ -272,8 +265,78 @@ bool EdgeLocator::InterpolateEdge(
   return true;
 }
 
+//----------------------------------------------------------------------------
+// Triangles and triangle strips of the closed surface in IJK space, and the cells that
+// may intersect each slice. Built once before the slabs are processed, and read concurrently.
+struct SurfaceCells
+{
+  /// Point ids of all cells, one after the other
+  std::vector<vtkIdType> Connectivity;
+  /// Start of each cell in Connectivity, with an additional entry for the end of the last cell
+  std::vector<vtkIdType> Offsets;
+  /// Non-zero for triangle strips
+  std::vector<char> IsStrip;
+  /// Ids of the cells that may intersect the cutting planes of each slice (for any sampling offset)
+  std::vector<std::vector<vtkIdType> > SliceCellIds;
+  int FirstSlice{0};
+
+  void AddCells(vtkCellArray* cells, bool isStrip, vtkPoints* points, const int extent[6]);
+};
+
+//----------------------------------------------------------------------------
+void SurfaceCells::AddCells(vtkCellArray* cells, bool isStrip, vtkPoints* points, const int extent[6])
+{
+  if (!cells)
+    {
+    return;
+    }
+  vtkIdType npts = 0;
+  const vtkIdType* pts = nullptr;
+  double point[3] = { 0.0, 0.0, 0.0 };
+  for (cells->InitTraversal(); cells->GetNextCell(npts, pts);)
+    {
+    // Only triangles and triangle strips are cut, same as in vtkPolyDataToImageStencil
+    if ((isStrip && npts < 3) || (!isStrip && npts != 3))
+      {
+      continue;
+      }
+    vtkIdType cellId = static_cast<vtkIdType>(this->IsStrip.size());
+    double zMin = VTK_DOUBLE_MAX;
+    double zMax = VTK_DOUBLE_MIN;
+    for (vtkIdType i = 0; i < npts; ++i)
+      {
+      this->Connectivity.push_back(pts[i]);
+      points->GetPoint(pts[i], point);
+      zMin = std::min(zMin, point[2]);
+      zMax = std::max(zMax, point[2]);
+      }
+    this->Offsets.push_back(static_cast<vtkIdType>(this->Connectivity.size()));
+    this->IsStrip.push_back(isStrip ? 1 : 0);
+
+    // Sampling offsets are less than half voxel, so the cutting planes of slice k are between k-0.5 and k+0.5
+    int firstSlice = std::max(static_cast<int>(std::ceil(zMin - 0.5)), extent[4]);
+    int lastSlice = std::min(static_cast<int>(std::floor(zMax + 0.5)), extent[5]);
+    for (int slice = firstSlice; slice <= lastSlice; ++slice)
+      {
+      this->SliceCellIds[slice - this->FirstSlice].push_back(cellId);
+      }
+    }
+}
+
 } // end anonymous namespace
 
+//----------------------------------------------------------------------------
+struct vtkPolyDataToFractionalLabelmapFilter::SliceCache
+{
+  const SurfaceCells* Cells{nullptr};
+  /// Cells that may intersect the plane that is currently being cut
+  const std::vector<vtkIdType>* CurrentSliceCellIds{nullptr};
+
+  std::map<double, vtkSmartPointer<vtkPolyData> > Slices;
+  std::map<double, vtkSmartPointer<vtkCellArray> > Lines;
+  std::map<double, vtkSmartPointer<vtkIdTypeArray> > PointNeighborCounts;
+};
+
 //----------------------------------------------------------------------------
 void vtkPolyDataToFractionalLabelmapFilter::SetOutputImageToWorldMatrix(vtkMatrix4x4* imageToWorldMatrix)
 {
@@ -419,120 +482,131 @@ int vtkPolyDataToFractionalLabelmapFilter::RequestData(
   // PolyData of the closed surface in IJK space
   vtkSmartPointer<vtkPolyData> transformedClosedSurface = stripper->GetOutput();
 
-  this->CellLocator->SetDataSet(transformedClosedSurface);
-  this->CellLocator->BuildLocator();
-
   int extent[6];
   outputData->GetExtent(extent);
+  if (extent[0] > extent[1] || extent[2] > extent[3] || extent[4] > extent[5]
+    || !transformedClosedSurface->GetPoints() || transformedClosedSurface->GetNumberOfPoints() == 0)
+    {
+    return 1;
+    }
 
-  vtkSmartPointer<vtkImageData> emptyImageData = vtkSmartPointer<vtkImageData>::New();
-  emptyImageData->SetExtent(extent);
-  emptyImageData->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
-
-  void* emptyImageDataPointer = emptyImageData->GetScalarPointerForExtent(emptyImageData->GetExtent());
-  if (!emptyImageDataPointer)
-  {
-    vtkErrorMacro("Convert: Failed to allocate memory for output labelmap image!");
-    return false;
-  }
-  else
-  {
-    memset(emptyImageDataPointer, 0, ((extent[1]-extent[0]+1)*(extent[3]-extent[2]+1)*(extent[5]-extent[4]+1) * emptyImageData->GetScalarSize() * emptyImageData->GetNumberOfScalarComponents()));
-  }
+  // Collect the cells that may intersect each slice, so that cutting a plane only visits nearby cells
+  SurfaceCells surfaceCells;
+  surfaceCells.FirstSlice = extent[4];
+  surfaceCells.SliceCellIds.resize(extent[5] - extent[4] + 1);
+  surfaceCells.Offsets.push_back(0);
+  surfaceCells.AddCells(transformedClosedSurface->GetPolys(), false, transformedClosedSurface->GetPoints(), extent);
+  surfaceCells.AddCells(transformedClosedSurface->GetStrips(), true, transformedClosedSurface->GetPoints(), extent);
+
+  // The output is partitioned into slabs along the z axis. Each slab is sampled at all offsets
+  // independently from the others, using its own cut contours and sample counts.
+  // More slabs than threads balance the load better, as slabs through the middle of the surface take longer.
+  int numberOfSlices = extent[5] - extent[4] + 1;
+  int numberOfSlabs = std::max(1, std::min(numberOfSlices, vtkSMPTools::GetEstimatedNumberOfThreads() * 2));
+  if (transformedClosedSurface->GetNumberOfPolys() == 0 && transformedClosedSurface->GetNumberOfStrips() == 0)
+    {
+    // Polylines are selected by traversing the shared line cell array, which cannot be done concurrently
+    numberOfSlabs = 1;
+    }
 
+  int numberOfSamples = this->NumberOfOffsets * this->NumberOfOffsets * this->NumberOfOffsets;
+  if (numberOfSamples > VTK_UNSIGNED_SHORT_MAX)
+    {
+    vtkErrorMacro("RequestData: Number of offsets is too large: " << this->NumberOfOffsets);
+    return 0;
+    }
 
   // The magnitude of the offset step size ( n-1 / 2n )
   double offsetStepSize = (double)(this->NumberOfOffsets-1.0)/(2 * this->NumberOfOffsets);
 
-  vtkSmartPointer<vtkImageStencilData> imageStencilData = vtkSmartPointer<vtkImageStencilData>::New();
-  imageStencilData->SetExtent(extent);
-  imageStencilData->SetSpacing(1.0, 1.0, 1.0);
-
-  vtkNew<vtkImageStencil> imageStencil;
-  imageStencil->SetInputData(emptyImageData);
-  imageStencil->SetStencilData(imageStencilData);
-  imageStencil->ReverseStencilOn();
-  imageStencil->SetBackgroundValue(1); // General foreground value is 1 (background value because of reverse stencil)
-
-  vtkNew<vtkImageCast> imageCast;
-  imageCast->SetInputConnection(imageStencil->GetOutputPort());
-  imageCast->SetOutputScalarTypeToUnsignedChar();
-
-  // Iterate through "NumberOfOffsets" in each of the dimensions and create a binary labelmap at each offset
-  for (int k = 0; k < this->NumberOfOffsets; ++k)
-  {
-    double kOffset = ( (double) k / this->NumberOfOffsets - offsetStepSize );
-
-    for (int j = 0; j < this->NumberOfOffsets; ++j)
+  auto sampleSlabs = [&](vtkIdType beginSlab, vtkIdType endSlab)
     {
-      double jOffset = ( (double) j / this->NumberOfOffsets - offsetStepSize );
-
-      for (int i = 0; i < this->NumberOfOffsets; ++i)
+    for (vtkIdType slabIndex = beginSlab; slabIndex < endSlab; ++slabIndex)
       {
-        double iOffset = ( (double) i / this->NumberOfOffsets - offsetStepSize );
+      int slabExtent[6] = { extent[0], extent[1], extent[2], extent[3],
+        extent[4] + static_cast<int>(slabIndex * numberOfSlices / numberOfSlabs),
+        extent[4] + static_cast<int>((slabIndex + 1) * numberOfSlices / numberOfSlabs) - 1 };
 
-        // Create stencil for the current binary labelmap offset
-        imageStencilData->AllocateExtents();
-        imageStencilData->SetOrigin(iOffset, jOffset, kOffset);
-        this->FillImageStencilData(imageStencilData, transformedClosedSurface, extent);
+      SliceCache cache;
+      cache.Cells = &surfaceCells;
 
-        // Save result to output
-        imageCast->Update();
-        this->AddBinaryLabelMapToFractionalLabelMap(imageCast->GetOutput(), outputData);
+      vtkIdType numberOfSlabVoxels = static_cast<vtkIdType>(slabExtent[1] - slabExtent[0] + 1)
+        * (slabExtent[3] - slabExtent[2] + 1) * (slabExtent[5] - slabExtent[4] + 1);
+      std::vector<unsigned short> sampleCounts(numberOfSlabVoxels, 0);
 
-        this->UpdateProgress(((i+1)*(j+1)*(k+1))/(this->NumberOfOffsets*this->NumberOfOffsets*this->NumberOfOffsets));
+      vtkNew<vtkImageStencilData> imageStencilData;
+      imageStencilData->SetExtent(slabExtent);
+      imageStencilData->SetSpacing(1.0, 1.0, 1.0);
 
-      } // i
-    } // j
-  } // k
+      // Iterate through "NumberOfOffsets" in each of the dimensions and count the samples inside the surface at each offset
+      for (int k = 0; k < this->NumberOfOffsets; ++k)
+        {
+        double kOffset = ( (double) k / this->NumberOfOffsets - offsetStepSize );
+
+        for (int j = 0; j < this->NumberOfOffsets; ++j)
+          {
+          double jOffset = ( (double) j / this->NumberOfOffsets - offsetStepSize );
 
+          for (int i = 0; i < this->NumberOfOffsets; ++i)
+            {
+            double iOffset = ( (double) i / this->NumberOfOffsets - offsetStepSize );
+
+            // Create stencil for the current offset
+            imageStencilData->AllocateExtents();
+            imageStencilData->SetOrigin(iOffset, jOffset, kOffset);
+            this->FillImageStencilData(imageStencilData, transformedClosedSurface, slabExtent, cache);
+            this->AddStencilToSampleCounts(imageStencilData, slabExtent, sampleCounts.data());
+            } // i
+          } // j
+        } // k
+
+      // Quantize the fraction of samples inside the surface to the fractional labelmap range
+      FRACTIONAL_DATA_TYPE* fractionalPointer = static_cast<FRACTIONAL_DATA_TYPE*>(outputData->GetScalarPointerForExtent(slabExtent));
+      for (vtkIdType voxelIndex = 0; voxelIndex < numberOfSlabVoxels; ++voxelIndex)
+        {
+#if VTK_FRACTIONAL_DATA_TYPE == VTK_FLOAT
+        fractionalPointer[voxelIndex] = static_cast<FRACTIONAL_DATA_TYPE>(
+          FRACTIONAL_MIN + (FRACTIONAL_MAX - FRACTIONAL_MIN) * static_cast<double>(sampleCounts[voxelIndex]) / numberOfSamples);
+#else
+        fractionalPointer[voxelIndex] = static_cast<FRACTIONAL_DATA_TYPE>(FRACTIONAL_MIN +
+          (sampleCounts[voxelIndex] * (FRACTIONAL_MAX - FRACTIONAL_MIN) + numberOfSamples / 2) / numberOfSamples);
+#endif
+        }
+      }
+    };
+  vtkSMPTools::For(0, numberOfSlabs, 1, sampleSlabs);
+
+  this->UpdateProgress(1.0);
   return 1;
 }
 
 //----------------------------------------------------------------------------
-void vtkPolyDataToFractionalLabelmapFilter::AddBinaryLabelMapToFractionalLabelMap(vtkImageData* binaryLabelMap, vtkImageData* fractionalLabelMap)
+void vtkPolyDataToFractionalLabelmapFilter::AddStencilToSampleCounts(vtkImageStencilData* stencilData, int extent[6], unsigned short* sampleCounts)
 {
-
-  if (!binaryLabelMap)
-  {
-    vtkErrorMacro("AddBinaryLabelMapToFractionalLabelMap: Invalid vtkImageData!");
-    return;
-  }
-
-  if (!fractionalLabelMap)
-  {
-    vtkErrorMacro("AddBinaryLabelMapToFractionalLabelMap: Invalid vtkImageData!");
-    return;
-  }
-
-  int binaryExtent[6] = {0,-1,0,-1,0,-1};
-  binaryLabelMap->GetExtent(binaryExtent);
-
-  int fractionalExtent[6] = {0,-1,0,-1,0,-1};
-  fractionalLabelMap->GetExtent(fractionalExtent);
-
-  // Get points to the extent in both the binary and fractional labelmaps
-  char* binaryLabelMapPointer = (char*)binaryLabelMap->GetScalarPointerForExtent(binaryExtent);
-  FRACTIONAL_DATA_TYPE* fractionalLabelMapPointer = (FRACTIONAL_DATA_TYPE*)fractionalLabelMap->GetScalarPointerForExtent(fractionalExtent);
-
-  int dimensions[6] = {0,0,0};
-  fractionalLabelMap->GetDimensions(dimensions);
-
-  int numberOfVoxels = dimensions[0]*dimensions[1]*dimensions[2];
-
-  for (int i = 0; i < numberOfVoxels; ++i)
-  {
-    (*fractionalLabelMapPointer) += (*binaryLabelMapPointer) * FRACTIONAL_STEP_SIZE;
-    ++binaryLabelMapPointer;
-    ++fractionalLabelMapPointer;
-  }
-
+  vtkIdType rowSize = extent[1] - extent[0] + 1;
+  unsigned short* rowCounts = sampleCounts;
+  for (int z = extent[4]; z <= extent[5]; ++z)
+    {
+    for (int y = extent[2]; y <= extent[3]; ++y, rowCounts += rowSize)
+      {
+      int iter = 0;
+      int r1 = 0;
+      int r2 = 0;
+      while (stencilData->GetNextExtent(r1, r2, extent[0], extent[1], y, z, iter))
+        {
+        for (int x = r1; x <= r2; ++x)
+          {
+          ++rowCounts[x - extent[0]];
+          }
+        }
+      }
+    }
 }
 
 //----------------------------------------------------------------------------
 void vtkPolyDataToFractionalLabelmapFilter::FillImageStencilData(
   vtkImageStencilData *data, vtkPolyData* closedSurface,
-  int extent[6])
+  int extent[6], SliceCache& cache)
 {
   // Description of algorithm:
   // 1) cut the polydata at each z slice to create polylines
@@ -548,7 +622,7 @@ void vtkPolyDataToFractionalLabelmapFilter::FillImageStencilData(
   double *origin = data->GetOrigin();
 
   // if we have no data then return
-  if (!this->GetInput()->GetNumberOfPoints())
+  if (!closedSurface->GetNumberOfPoints())
     {
     return;
     }
@@ -584,7 +658,8 @@ void vtkPolyDataToFractionalLabelmapFilter::FillImageStencilData(
 
     raster.PrepareForNewData();
 
-    if ( this->SliceCache.count(z) == 0 )
+    std::map<double, vtkSmartPointer<vtkPolyData> >::iterator sliceIt = cache.Slices.find(z);
+    if (sliceIt == cache.Slices.end())
       {
 
       slice = vtkSmartPointer<vtkPolyData>::New();
@@ -592,8 +667,8 @@ void vtkPolyDataToFractionalLabelmapFilter::FillImageStencilData(
       // Step 1: Cut the data into slices
       if (input->GetNumberOfPolys() > 0 || input->GetNumberOfStrips() > 0)
         {
-
-        this->PolyDataCutter(input, slice, z);
+        cache.CurrentSliceCellIds = &cache.Cells->SliceCellIds[idxZ - cache.Cells->FirstSlice];
+        this->PolyDataCutter(input, slice, z, cache);
         }
       else
         {
@@ -601,16 +676,15 @@ void vtkPolyDataToFractionalLabelmapFilter::FillImageStencilData(
         this->PolyDataSelector(input, slice, z, spacing[2]);
         }
 
-      if (!slice->GetNumberOfLines())
-        {
-        continue;
-        }
-
-      this->SliceCache.insert(std::pair<double, vtkPolyData*>(z, slice));
-
+      // Empty slices are cached as well, so that they are not cut again for the other in-plane offsets
+      sliceIt = cache.Slices.insert(std::pair<double, vtkSmartPointer<vtkPolyData> >(z, slice)).first;
       }
 
-    slice = this->SliceCache[z];
+    slice = sliceIt->second;
+    if (!slice->GetNumberOfLines())
+      {
+      continue;
+      }
 
     // convert to structured coords via origin and spacing
     vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
@@ -627,7 +701,7 @@ void vtkPolyDataToFractionalLabelmapFilter::FillImageStencilData(
       points->SetPoint(j, tempPoint);
       }
 
-    if (this->LinesCache.count(z) == 0)
+    if (cache.Lines.count(z) == 0)
     {
 
       // Step 2: Find and connect all the loose ends
@@ -815,22 +889,16 @@ void vtkPolyDataToFractionalLabelmapFilter::FillImageStencilData(
           }
         }
 
-        this->LinesCache.insert(std::pair<double, vtkCellArray*>(z, lines));
-        this->NptsCache.insert(std::pair<double, vtkIdType>(z, npts));
-        this->PointNeighborCountsCache.insert(std::pair<double, vtkSmartPointer<vtkIdTypeArray> >(z, pointNeighborCountsArray));
+        cache.Lines.insert(std::pair<double, vtkSmartPointer<vtkCellArray> >(z, lines));
+        cache.PointNeighborCounts.insert(std::pair<double, vtkSmartPointer<vtkIdTypeArray> >(z, pointNeighborCountsArray));
 
       }
 
-   if (this->LinesCache.count(z) == 0)
-    {
-     continue;
-    }
-
-    vtkCellArray* lines = this->LinesCache[z];
+    vtkCellArray* lines = cache.Lines[z];
     vtkIdType count = lines->GetNumberOfConnectivityEntries();
-    const vtkIdType* pointIds = this->PointIdsCache[z];
-    vtkIdType npts = this->NptsCache[z];
-    vtkIdTypeArray* pointNeighborCountsArray = this->PointNeighborCountsCache[z];
+    const vtkIdType* pointIds = nullptr;
+    vtkIdType npts = 0;
+    vtkIdTypeArray* pointNeighborCountsArray = cache.PointNeighborCounts[z];
     vtkIdType* pointNeighborCounts = pointNeighborCountsArray->GetPointer(0);
 
     // Step 3: Go through all the line segments for this slice,
@@ -877,7 +945,7 @@ void vtkPolyDataToFractionalLabelmapFilter::FillImageStencilData(
 
 //----------------------------------------------------------------------------
 void vtkPolyDataToFractionalLabelmapFilter::PolyDataCutter(
-  vtkPolyData *input, vtkPolyData *output, double z)
+  vtkPolyData *input, vtkPolyData *output, double z, SliceCache& cache)
 {
   vtkPoints *points = input->GetPoints();
   vtkPoints *newPoints = vtkPoints::New();
@@ -889,40 +957,16 @@ void vtkPolyDataToFractionalLabelmapFilter::PolyDataCutter(
   // An edge locator to avoid point duplication while clipping
   EdgeLocator edgeLocator;
 
-  vtkSmartPointer<vtkIdList> cells = vtkSmartPointer<vtkIdList>::New();
-  cells->Initialize();
-
-  double bounds[6] = {0,0,0,0,0,0};
-  input->GetBounds(bounds);
-  bounds[4] = z;
-  bounds[5] = z;
-
-  // Find cells that intersect with the current slice.
-  this->CellLocator->FindCellsWithinBounds(bounds, cells);
-
-  // Go through all cells and clip them.
-  vtkIdType numCells = cells->GetNumberOfIds();
-
-
-  vtkIdType loc = 0;
-  for (vtkIdType cellId = 0; cellId < numCells; cellId++)
+  // Go through all cells that may intersect with the current slice and clip them.
+  const SurfaceCells* surfaceCells = cache.Cells;
+  for (vtkIdType id : *cache.CurrentSliceCellIds)
     {
-
-    vtkIdType id = cells->GetId(cellId);
-
-    if (input->GetCellType(id) != VTK_TRIANGLE &&
-        input->GetCellType(id) != VTK_TRIANGLE_STRIP)
-      {
-        continue;
-      }
-
-    const vtkIdType *ptIds = nullptr;
-    vtkIdType npts;
-    input->GetCellPoints(id, npts, ptIds);
-    loc += npts + 1;
+    const vtkIdType* ptIds = surfaceCells->Connectivity.data() + surfaceCells->Offsets[id];
+    vtkIdType npts = surfaceCells->Offsets[id + 1] - surfaceCells->Offsets[id];
+    bool isStrip = (surfaceCells->IsStrip[id] != 0);
 
     vtkIdType numSubCells = 1;
-    if (input->GetCellType(id) == VTK_TRIANGLE_STRIP)
+    if (isStrip)
       {
       numSubCells = npts - 2;
       npts = 3;
@@ -983,15 +1027,3 @@ void vtkPolyDataToFractionalLabelmapFilter::PolyDataCutter(
   newPoints->Delete();
   newLines->Delete();
 }
-
-//----------------------------------------------------------------------------
-void vtkPolyDataToFractionalLabelmapFilter::DeleteCache()
-{
-
-  this->SliceCache.clear();
-  this->LinesCache.clear();
-  this->NptsCache.clear();
-  this->PointIdsCache.clear();
-  this->PointNeighborCountsCache.clear();
-
-}
@@ -64,14 +64,6 @@ class vtkSegmentationCore_EXPORT vtkPolyDataToFractionalLabelmapFilter :
   public vtkPolyDataToImageStencil
 {
 private:
-  std::map<double, vtkSmartPointer<vtkCellArray> > LinesCache;
-  std::map<double, vtkSmartPointer<vtkPolyData> > SliceCache;
-  std::map<double, vtkIdType*> PointIdsCache;
-  std::map<double, vtkIdType> NptsCache;
-  std::map<double,  vtkSmartPointer<vtkIdTypeArray> > PointNeighborCountsCache;
-
-  vtkCellLocator* CellLocator;
-
   vtkOrientedImageData* OutputImageTransformData;
   int NumberOfOffsets;
 
@@ -102,12 +94,20 @@ public:
   void SetOutputSpacing(double x, double y, double z) override;
 
 
-  /// This method deletes the currently stored cache variables
-  void DeleteCache();
+  /// Cut contours are cached only while the filter is executing, so there is nothing to delete.
+  /// Kept for backward compatibility.
+  void DeleteCache() {};
 
+  /// Number of sampling offsets along each axis. Each output voxel is sampled NumberOfOffsets^3 times
+  /// and the fraction of samples inside the surface is quantized to the FRACTIONAL_MIN..FRACTIONAL_MAX range.
   vtkSetMacro(NumberOfOffsets, int);
   vtkGetMacro(NumberOfOffsets, int);
 
+protected:
+  /// Cut contours of the closed surface and the cells that may intersect each slice.
+  /// The output is partitioned into slabs along the z axis and each slab has its own cache.
+  struct SliceCache;
+
 protected:
   vtkPolyDataToFractionalLabelmapFilter();
   ~vtkPolyDataToFractionalLabelmapFilter() override;
@@ -122,20 +122,23 @@ protected:
   /// \param output Output stencil data
   /// \param closedSurface The input surface to be converted
   /// \param extent The extent region that is being converted
-  void FillImageStencilData(vtkImageStencilData *output, vtkPolyData* closedSurface, int extent[6]);
+  /// \param cache Cut contours of the slab that contains the extent
+  void FillImageStencilData(vtkImageStencilData *output, vtkPolyData* closedSurface, int extent[6], SliceCache& cache);
 
-  /// Add the values of the binary labelmap to the fractional labelmap.
-  /// \param binaryLabelMap Binary labelmap that will be added to the fractional labelmap
-  /// \param fractionalLabelMap The fractional labelmap that the binary labelmap is added to
-  void AddBinaryLabelMapToFractionalLabelMap(vtkImageData* binaryLabelMap, vtkImageData* fractionalLabelMap);
+  /// Add the number of stencil samples inside the surface to the per-voxel sample counts of the extent
+  /// \param stencilData Stencil of one sampling offset
+  /// \param extent The extent region that is being converted
+  /// \param sampleCounts Number of samples inside the surface for each voxel of the extent
+  void AddStencilToSampleCounts(vtkImageStencilData* stencilData, int extent[6], unsigned short* sampleCounts);
 
   /// Clip the polydata at the specified z coordinate to create a planar contour.
   /// This method is a modified version of vtkPolyDataToImageStencil::PolyDataCutter to decrease execution time
   /// \param input The closed surface that is being cut
   /// \param output Polydata containing the contour lines
   /// \param z The z coordinate for the cutting plane
+  /// \param cache Cache containing the cells that may intersect the plane
   void PolyDataCutter(vtkPolyData *input, vtkPolyData *output,
-                             double z);
+                             double z, SliceCache& cache);
 
 private:
   vtkPolyDataToFractionalLabelmapFilter(const vtkPolyDataToFractionalLabelmapFilter&) = delete;
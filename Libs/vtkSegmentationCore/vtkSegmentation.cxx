@@ -24,9 +24,11 @@
 #include "vtkSegmentationConverterFactory.h"
 #include "vtkSegmentationHistory.h"
 
+#include "vtkLabelmapMetadata.h"
 #include "vtkOrientedImageData.h"
 #include "vtkOrientedImageDataResample.h"
 #include "vtkCalculateOversamplingFactor.h"
+#include "vtkSparseLabelmap.h"
 
 // VTK includes
 #include <vtkAbstractTransform.h>
@@ -40,6 +42,7 @@
 #include <vtkObjectFactory.h>
 #include <vtkPointData.h>
 #include <vtkPolyData.h>
+#include <vtkSMPTools.h>
 #include <vtkStringArray.h>
 #include <vtkTransform.h>
 #include <vtkTransformPolyDataFilter.h>
@@ -48,7 +51,10 @@
 // STD includes
 #include <algorithm>
 #include <functional>
+#include <map>
+#include <set>
 #include <sstream>
+#include <unordered_map>
 
 const int DEFAULT_LABEL_VALUE = 1;
 
@@ -70,6 +76,7 @@ vtkSegmentation::vtkSegmentation()
 
   this->MasterRepresentationModifiedEnabled = true;
   this->SegmentModifiedEnabled = true;
+  this->ParallelConversion = true;
 
   this->SegmentIdAutogeneratorIndex = 0;
 
@@ -166,6 +173,7 @@ void vtkSegmentation::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Modified Time: " << this->GetMTime() << "\n";
 
   os << indent << "MasterRepresentationName:  " << this->MasterRepresentationName << "\n";
+  os << indent << "ParallelConversion:  " << (this->ParallelConversion ? "true" : "false") << "\n";
   os << indent << "Number of segments: " << this->Segments.size() << "\n";
   os << indent << "Segments:\n";
   for (std::deque< std::string >::iterator segmentIdIt = this->SegmentIds.begin();
@@ -668,6 +676,23 @@ void vtkSegmentation::UpdateMasterRepresentationObservers()
       }
     }
   this->MasterRepresentationCache = newMasterRepresentations;
+
+  // Forget modifications of labelmaps that are no longer master representations.
+  // These labelmaps may already be deleted, therefore only their addresses are compared.
+  for (auto labelmapIt = this->ModifiedLabelmapExtents.begin(); labelmapIt != this->ModifiedLabelmapExtents.end();)
+    {
+    vtkDataObject* labelmap = labelmapIt->first;
+    if (std::find_if(newMasterRepresentations.begin(), newMasterRepresentations.end(),
+      [labelmap](const vtkSmartPointer<vtkDataObject>& masterRepresentation) { return masterRepresentation.GetPointer() == labelmap; })
+      == newMasterRepresentations.end())
+      {
+      labelmapIt = this->ModifiedLabelmapExtents.erase(labelmapIt);
+      }
+    else
+      {
+      ++labelmapIt;
+      }
+    }
 }
 
 //---------------------------------------------------------------------------
@@ -953,6 +978,16 @@ void vtkSegmentation::ApplyLinearTransform(vtkAbstractTransform* transform)
       {
       vtkOrientedImageDataResample::TransformOrientedImage(currentMasterRepresentationOrientedImageData, linearTransform);
       }
+    // Sparse labelmap, only the geometry changes
+    else if (vtkSparseLabelmap::SafeDownCast(currentMasterRepresentation))
+      {
+      vtkSparseLabelmap* sparseLabelmap = vtkSparseLabelmap::SafeDownCast(currentMasterRepresentation);
+      vtkNew<vtkMatrix4x4> imageToWorldMatrix;
+      sparseLabelmap->GetImageToWorldMatrix(imageToWorldMatrix);
+      vtkNew<vtkMatrix4x4> transformedImageToWorldMatrix;
+      vtkMatrix4x4::Multiply4x4(linearTransform->GetMatrix(), imageToWorldMatrix, transformedImageToWorldMatrix);
+      sparseLabelmap->SetImageToWorldMatrix(transformedImageToWorldMatrix);
+      }
     else
       {
       vtkErrorMacro("ApplyLinearTransform: Representation data type '" << currentMasterRepresentation->GetClassName() << "' not supported!");
@@ -1034,6 +1069,7 @@ bool vtkSegmentation::ConvertSegmentsUsingPath(std::vector<std::string> segmentI
 
     // Perform conversion step
     currentConversionRule->PreConvert(this);
+    std::vector<vtkSegment*> segmentsToConvert;
     for (auto segmentID : segmentIDs)
       {
       vtkSegment* segment = this->GetSegment(segmentID);
@@ -1056,7 +1092,19 @@ bool vtkSegmentation::ConvertSegmentsUsingPath(std::vector<std::string> segmentI
         {
         continue;
         }
-      currentConversionRule->Convert(segment);
+      segmentsToConvert.push_back(segment);
+      }
+
+    if (this->ParallelConversion && segmentsToConvert.size() > 1 && currentConversionRule->IsThreadSafe())
+      {
+      this->ConvertSegmentsInParallel(segmentsToConvert, currentConversionRule);
+      }
+    else
+      {
+      for (vtkSegment* segment : segmentsToConvert)
+        {
+        currentConversionRule->Convert(segment);
+        }
       }
     currentConversionRule->PostConvert(this);
 
@@ -1065,6 +1113,85 @@ bool vtkSegmentation::ConvertSegmentsUsingPath(std::vector<std::string> segmentI
   return true;
 }
 
+//-----------------------------------------------------------------------------
+void vtkSegmentation::ConvertSegmentsInParallel(const std::vector<vtkSegment*>& segments, vtkSegmentationConverterRule* rule)
+{
+  std::string sourceRepresentationName = rule->GetSourceRepresentationName();
+  std::string targetRepresentationName = rule->GetTargetRepresentationName();
+
+  // Segments in the segmentation are observed, therefore conversion is performed on temporary segments
+  // that only contain the source representation. Source representations may be shared between segments
+  // (shared labelmaps), therefore each temporary segment gets its own shallow copy of the source, so that
+  // the rule can use it as filter input without modifying an object that is used by other threads.
+  std::vector<vtkSmartPointer<vtkSegment> > workSegments;
+  std::vector<vtkSegment*> workSegmentPointers;
+  std::set<vtkDataObject*> sourceRepresentations;
+  for (vtkSegment* segment : segments)
+    {
+    vtkDataObject* sourceRepresentation = segment->GetRepresentation(sourceRepresentationName);
+    if (sourceRepresentations.insert(sourceRepresentation).second)
+      {
+      // Scalar range is computed on first request and cached in the data array, which is shared
+      // by the copies. Compute it now to prevent concurrent modification from the worker threads.
+      vtkDataSet* sourceDataSet = vtkDataSet::SafeDownCast(sourceRepresentation);
+      if (sourceDataSet)
+        {
+        sourceDataSet->GetScalarRange();
+        }
+      }
+    vtkSmartPointer<vtkDataObject> sourceRepresentationCopy = vtkSmartPointer<vtkDataObject>::Take(sourceRepresentation->NewInstance());
+    sourceRepresentationCopy->ShallowCopy(sourceRepresentation);
+    vtkSmartPointer<vtkSegment> workSegment = vtkSmartPointer<vtkSegment>::New();
+    workSegment->DeepCopyMetadata(segment);
+    workSegment->AddRepresentation(sourceRepresentationName, sourceRepresentationCopy);
+    workSegments.push_back(workSegment);
+    workSegmentPointers.push_back(workSegment);
+    }
+
+  // Results shared between segments are computed before the concurrent conversion
+  if (!rule->PrepareConcurrentConvert(segments, workSegmentPointers))
+    {
+    vtkWarningMacro("ConvertSegmentsInParallel: Failed to prepare concurrent conversion with rule "
+      << rule->GetName() << ", segments are converted sequentially");
+    for (vtkSegment* segment : segments)
+      {
+      rule->Convert(segment);
+      }
+    return;
+    }
+
+  // Each segment is a separate work item, as conversion of a single segment is typically expensive
+  auto convertSegments = [&rule, &workSegments](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType index = begin; index < end; ++index)
+      {
+      rule->Convert(workSegments[index]);
+      }
+    };
+  vtkSMPTools::For(0, static_cast<vtkIdType>(workSegments.size()), 1, convertSegments);
+
+  // Commit results in deterministic order
+  for (size_t index = 0; index < segments.size(); ++index)
+    {
+    vtkDataObject* convertedRepresentation = workSegments[index]->GetRepresentation(targetRepresentationName);
+    if (!convertedRepresentation)
+      {
+      continue;
+      }
+    vtkDataObject* targetRepresentation = segments[index]->GetRepresentation(targetRepresentationName);
+    if (targetRepresentation && !rule->GetReplaceTargetRepresentation()
+      && targetRepresentation->IsA(convertedRepresentation->GetClassName()))
+      {
+      // Update existing representation object, as sequential conversion would do
+      targetRepresentation->ShallowCopy(convertedRepresentation);
+      }
+    else
+      {
+      segments[index]->AddRepresentation(targetRepresentationName, convertedRepresentation);
+      }
+    }
+}
+
 //-----------------------------------------------------------------------------
 bool vtkSegmentation::ConvertSegmentUsingPath(vtkSegment* segment, vtkSegmentationConversionPath* path, bool overwriteExisting/*=false*/)
 {
@@ -1295,6 +1422,95 @@ void vtkSegmentation::InvalidateNonMasterRepresentations()
   this->InvokeEvent(vtkSegmentation::ContainedRepresentationNamesModified);
 }
 
+//---------------------------------------------------------------------------
+void vtkSegmentation::AddModifiedLabelmapExtent(vtkDataObject* labelmap, const int modifiedExtent[6], vtkMTimeType mtimeBefore)
+{
+  if (!labelmap)
+    {
+    return;
+    }
+
+  LabelmapModifications& labelmapModifications = this->ModifiedLabelmapExtents[labelmap];
+  std::deque<ModifiedLabelmapExtent>& modifications = labelmapModifications.Modifications;
+  if (labelmapModifications.Labelmap.GetPointer() != labelmap)
+    {
+    // New labelmap, or records of a deleted labelmap that had the same address
+    labelmapModifications.Labelmap = labelmap;
+    modifications.clear();
+    }
+  if (!modifications.empty() && modifications.back().MTimeAfter != mtimeBefore)
+    {
+    // The labelmap was changed by an unrecorded modification, previous records cannot be used anymore
+    modifications.clear();
+    }
+  ModifiedLabelmapExtent modification;
+  std::copy(modifiedExtent, modifiedExtent + 6, modification.Extent);
+  modification.MTimeBefore = mtimeBefore;
+  modification.MTimeAfter = labelmap->GetMTime();
+  modifications.push_back(modification);
+
+  // Derived representations are normally updated after each modification, so only a few records are needed
+  const size_t maximumNumberOfModifications = 16;
+  while (modifications.size() > maximumNumberOfModifications)
+    {
+    modifications.pop_front();
+    }
+}
+
+//---------------------------------------------------------------------------
+bool vtkSegmentation::GetModifiedLabelmapExtent(vtkDataObject* labelmap, vtkMTimeType sinceMTime, int modifiedExtent[6])
+{
+  int emptyExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  std::copy(emptyExtent, emptyExtent + 6, modifiedExtent);
+  if (!labelmap)
+    {
+    return false;
+    }
+  vtkMTimeType mtime = labelmap->GetMTime();
+  if (mtime == sinceMTime)
+    {
+    return true;
+    }
+  auto labelmapIt = this->ModifiedLabelmapExtents.find(labelmap);
+  if (labelmapIt == this->ModifiedLabelmapExtents.end()
+    || labelmapIt->second.Labelmap.GetPointer() != labelmap)
+    {
+    return false;
+    }
+
+  // Go back in the chain of modifications until the requested time is reached
+  const std::deque<ModifiedLabelmapExtent>& modifications = labelmapIt->second.Modifications;
+  for (auto modificationIt = modifications.rbegin(); modificationIt != modifications.rend(); ++modificationIt)
+    {
+    if (modificationIt->MTimeAfter != mtime)
+      {
+      return false;
+      }
+    const int* extent = modificationIt->Extent;
+    if (extent[0] <= extent[1] && extent[2] <= extent[3] && extent[4] <= extent[5])
+      {
+      if (modifiedExtent[0] > modifiedExtent[1] || modifiedExtent[2] > modifiedExtent[3] || modifiedExtent[4] > modifiedExtent[5])
+        {
+        std::copy(extent, extent + 6, modifiedExtent);
+        }
+      else
+        {
+        for (int i = 0; i < 3; ++i)
+          {
+          modifiedExtent[2 * i] = std::min(modifiedExtent[2 * i], extent[2 * i]);
+          modifiedExtent[2 * i + 1] = std::max(modifiedExtent[2 * i + 1], extent[2 * i + 1]);
+          }
+        }
+      }
+    mtime = modificationIt->MTimeBefore;
+    if (mtime == sinceMTime)
+      {
+      return true;
+      }
+    }
+  return false;
+}
+
 //---------------------------------------------------------------------------
 bool vtkSegmentation::IsSharedBinaryLabelmap(std::string segmentId)
 {
@@ -1363,6 +1579,147 @@ void vtkSegmentation::MergeSegmentLabelmaps(std::vector<std::string> mergeSegmen
 }
 
 //---------------------------------------------------------------------------
+namespace
+{
+
+//---------------------------------------------------------------------------
+// Binary labelmap layer that contains segments to be merged, in the geometry of the merged labelmap.
+// Voxels of one layer belong to at most one segment, therefore each layer voxel is mapped
+// to the index of the segment (in the merge order) that contains it.
+struct MergedLabelmapLayer
+{
+  vtkSmartPointer<vtkOrientedImageData> Labelmap;
+  int Extent[6]{ 0, -1, 0, -1, 0, -1 };
+  int ScalarType{ VTK_VOID };
+  void* Scalars{ nullptr };
+  int MinimumLabelValue{ VTK_INT_MAX };
+  int MaximumLabelValue{ VTK_INT_MIN };
+  /// Segment index for each label value between minimum and maximum label value (-1 if not merged)
+  std::vector<int> SegmentIndexLookupTable;
+  /// Used instead of the lookup table if the range of label values is very large
+  std::unordered_map<int, int> SegmentIndexMap;
+
+  void AddSegment(int labelValue, int segmentIndex)
+    {
+    this->SegmentIndexMap[labelValue] = segmentIndex;
+    this->MinimumLabelValue = std::min(this->MinimumLabelValue, labelValue);
+    this->MaximumLabelValue = std::max(this->MaximumLabelValue, labelValue);
+    }
+
+  /// Store labelmap properties and build the lookup table so that the layer can be accessed from multiple threads
+  void Prepare()
+    {
+    this->Labelmap->GetExtent(this->Extent);
+    this->ScalarType = this->Labelmap->GetScalarType();
+    this->Scalars = this->Labelmap->GetScalarPointer();
+
+    const vtkTypeInt64 maximumLookupTableSize = 1 << 20;
+    vtkTypeInt64 lookupTableSize = static_cast<vtkTypeInt64>(this->MaximumLabelValue) - this->MinimumLabelValue + 1;
+    if (lookupTableSize > maximumLookupTableSize)
+      {
+      return;
+      }
+    this->SegmentIndexLookupTable.assign(lookupTableSize, -1);
+    for (const auto& labelSegment : this->SegmentIndexMap)
+      {
+      this->SegmentIndexLookupTable[labelSegment.first - this->MinimumLabelValue] = labelSegment.second;
+      }
+    }
+
+  int GetSegmentIndex(int labelValue) const
+    {
+    if (!this->SegmentIndexLookupTable.empty())
+      {
+      return this->SegmentIndexLookupTable[labelValue - this->MinimumLabelValue];
+      }
+    auto segmentIt = this->SegmentIndexMap.find(labelValue);
+    return (segmentIt != this->SegmentIndexMap.end() ? segmentIt->second : -1);
+    }
+};
+
+//---------------------------------------------------------------------------
+// Set the index of the segment that contains each voxel of a row of the merged labelmap.
+// Segments that come later in the merge order overwrite earlier ones, same as masking them
+// into the merged labelmap one by one.
+template <class T>
+void UpdateRowSegmentIndices(const MergedLabelmapLayer& layer, const T* layerRow, int numberOfVoxels, int* rowSegmentIndices)
+{
+  const double minimumLabelValue = layer.MinimumLabelValue;
+  const double maximumLabelValue = layer.MaximumLabelValue;
+  for (int i = 0; i < numberOfVoxels; ++i)
+    {
+    const double value = static_cast<double>(layerRow[i]);
+    if (value < minimumLabelValue || value > maximumLabelValue)
+      {
+      continue;
+      }
+    const int labelValue = static_cast<int>(value);
+    if (labelValue != value)
+      {
+      continue;
+      }
+    const int segmentIndex = layer.GetSegmentIndex(labelValue);
+    if (segmentIndex > rowSegmentIndices[i])
+      {
+      rowSegmentIndices[i] = segmentIndex;
+      }
+    }
+}
+
+//---------------------------------------------------------------------------
+// Merge all layers into a range of slices of the merged labelmap
+void MergeLayersIntoSlices(const std::vector<MergedLabelmapLayer>& layers, const std::vector<short>& segmentLabelValues,
+  short* mergedScalars, const int mergedExtent[6], int firstSlice, int lastSlice)
+{
+  const vtkIdType mergedRowSize = mergedExtent[1] - mergedExtent[0] + 1;
+  const vtkIdType mergedSliceSize = mergedRowSize * (mergedExtent[3] - mergedExtent[2] + 1);
+  short* mergedSlicePtr = mergedScalars + (firstSlice - mergedExtent[4]) * mergedSliceSize;
+
+  std::vector<int> sliceSegmentIndices(mergedSliceSize);
+  for (int k = firstSlice; k <= lastSlice; ++k, mergedSlicePtr += mergedSliceSize)
+    {
+    std::fill(sliceSegmentIndices.begin(), sliceSegmentIndices.end(), -1);
+    for (const MergedLabelmapLayer& layer : layers)
+      {
+      const int* layerExtent = layer.Extent;
+      if (k < layerExtent[4] || k > layerExtent[5])
+        {
+        continue;
+        }
+      const int firstColumn = std::max(mergedExtent[0], layerExtent[0]);
+      const int lastColumn = std::min(mergedExtent[1], layerExtent[1]);
+      const int firstRow = std::max(mergedExtent[2], layerExtent[2]);
+      const int lastRow = std::min(mergedExtent[3], layerExtent[3]);
+      if (firstColumn > lastColumn || firstRow > lastRow)
+        {
+        continue;
+        }
+      const vtkIdType layerRowSize = layerExtent[1] - layerExtent[0] + 1;
+      const vtkIdType layerSliceSize = layerRowSize * (layerExtent[3] - layerExtent[2] + 1);
+      for (int j = firstRow; j <= lastRow; ++j)
+        {
+        const vtkIdType layerOffset = (k - layerExtent[4]) * layerSliceSize + (j - layerExtent[2]) * layerRowSize + (firstColumn - layerExtent[0]);
+        int* rowSegmentIndices = sliceSegmentIndices.data() + (j - mergedExtent[2]) * mergedRowSize + (firstColumn - mergedExtent[0]);
+        switch (layer.ScalarType)
+          {
+          vtkTemplateMacro(UpdateRowSegmentIndices<VTK_TT>(layer,
+            static_cast<VTK_TT*>(layer.Scalars) + layerOffset, lastColumn - firstColumn + 1, rowSegmentIndices));
+          }
+        }
+      }
+    for (vtkIdType voxelIndex = 0; voxelIndex < mergedSliceSize; ++voxelIndex)
+      {
+      const int segmentIndex = sliceSegmentIndices[voxelIndex];
+      if (segmentIndex >= 0)
+        {
+        mergedSlicePtr[voxelIndex] = segmentLabelValues[segmentIndex];
+        }
+      }
+    }
+}
+
+} // end of anonymous namespace
+
 bool vtkSegmentation::GenerateMergedLabelmap(
   vtkOrientedImageData* sharedImageData,
   int extentComputationMode,
@@ -1459,12 +1816,15 @@ bool vtkSegmentation::GenerateMergedLabelmap(
     return true;
     }
 
-  // Create shared labelmap
+  // Collect the layers that contain the merged segments. Each layer is resampled (if needed) only once,
+  // and all of them are merged in a single pass over the merged labelmap.
   bool success = true;
-  short segmentIndex = 0;
-  for (std::vector<std::string>::iterator segmentIdIt = sharedSegmentIDs.begin(); segmentIdIt != sharedSegmentIDs.end(); ++segmentIdIt, ++segmentIndex)
+  std::vector<MergedLabelmapLayer> layers;
+  std::map<vtkDataObject*, size_t> layerIndices;
+  std::vector<short> segmentLabelValues(sharedSegmentIDs.size(), backgroundColorIndex);
+  for (int segmentIndex = 0; segmentIndex < static_cast<int>(sharedSegmentIDs.size()); ++segmentIndex)
     {
-    std::string currentSegmentId = *segmentIdIt;
+    std::string currentSegmentId = sharedSegmentIDs[segmentIndex];
     vtkSegment* currentSegment = this->GetSegment(currentSegmentId);
     if (!currentSegment)
       {
@@ -1477,60 +1837,67 @@ bool vtkSegmentation::GenerateMergedLabelmap(
     vtkOrientedImageData* representationBinaryLabelmap = vtkOrientedImageData::SafeDownCast(
       currentSegment->GetRepresentation(vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName()));
     // If binary labelmap is empty then skip
-    if (representationBinaryLabelmap->IsEmpty())
+    if (!representationBinaryLabelmap || representationBinaryLabelmap->IsEmpty())
       {
       continue;
       }
 
-    // Set oriented image data used for merging to the representation (may change later if resampling is needed)
-    vtkOrientedImageData* binaryLabelmap = representationBinaryLabelmap;
-
-    // If labelmap geometries (origin, spacing, and directions) do not match reference then resample temporarily
-    vtkSmartPointer<vtkOrientedImageData> resampledBinaryLabelmap;
-    if (!vtkOrientedImageDataResample::DoGeometriesMatch(commonGeometryImage, representationBinaryLabelmap))
+    auto layerIt = layerIndices.find(representationBinaryLabelmap);
+    if (layerIt == layerIndices.end())
       {
-      resampledBinaryLabelmap = vtkSmartPointer<vtkOrientedImageData>::New();
+      MergedLabelmapLayer layer;
+      layer.Labelmap = representationBinaryLabelmap;
 
-      // Resample segment labelmap for merging
-      if (!vtkOrientedImageDataResample::ResampleOrientedImageToReferenceGeometry(
-        representationBinaryLabelmap, sharedImageToWorldMatrix, resampledBinaryLabelmap))
+      // If labelmap geometries (origin, spacing, and directions) do not match reference then resample temporarily
+      if (!vtkOrientedImageDataResample::DoGeometriesMatch(commonGeometryImage, representationBinaryLabelmap))
+        {
+        layer.Labelmap = vtkSmartPointer<vtkOrientedImageData>::New();
+
+        // Resample segment labelmap for merging
+        if (!vtkOrientedImageDataResample::ResampleOrientedImageToReferenceGeometry(
+          representationBinaryLabelmap, sharedImageToWorldMatrix, layer.Labelmap))
+          {
+          vtkErrorMacro("GenerateSharedLabelmap: ResampleOrientedImageToReferenceGeometry failed for segment " << currentSegmentId);
+          success = false;
+          continue;
+          }
+        }
+      if (layer.Labelmap->GetNumberOfScalarComponents() != 1 || !layer.Labelmap->GetScalarPointer())
         {
-        vtkErrorMacro("GenerateSharedLabelmap: ResampleOrientedImageToReferenceGeometry failed for segment " << currentSegmentId);
-        success = false;
         continue;
         }
-
-      // Use resampled labelmap for merging
-      binaryLabelmap = resampledBinaryLabelmap;
+      layerIt = layerIndices.insert(std::make_pair(representationBinaryLabelmap, layers.size())).first;
+      layers.push_back(layer);
       }
-
-    vtkNew<vtkOrientedImageData> thresholdedLabelmap;
-    vtkNew<vtkImageThreshold> threshold;
-    threshold->SetInputData(binaryLabelmap);
-    threshold->ThresholdBetween(currentSegment->GetLabelValue(), currentSegment->GetLabelValue());
-    threshold->SetInValue(1);
-    threshold->SetOutValue(0);
-    threshold->Update();
-    thresholdedLabelmap->ShallowCopy(threshold->GetOutput());
-    thresholdedLabelmap->CopyDirections(binaryLabelmap);
-    binaryLabelmap = thresholdedLabelmap;
+    layers[layerIt->second].AddSegment(currentSegment->GetLabelValue(), segmentIndex);
 
     int labelValue = backgroundColorIndex + 1 + segmentIndex;
     if (labelValues)
       {
       labelValue = labelValues->GetValue(segmentIndex);
       }
-
-    // Copy image data voxels into shared labelmap with the proper color index
-    vtkOrientedImageDataResample::ModifyImage(
-      sharedImageData,
-      binaryLabelmap,
-      vtkOrientedImageDataResample::OPERATION_MASKING,
-      nullptr,
-      0,
-      labelValue);
+    segmentLabelValues[segmentIndex] = static_cast<short>(std::max<int>(VTK_SHORT_MIN, std::min<int>(VTK_SHORT_MAX, labelValue)));
+    }
+  if (layers.empty())
+    {
+    return success;
+    }
+  for (MergedLabelmapLayer& layer : layers)
+    {
+    layer.Prepare();
     }
 
+  // Copy voxels of all segments into the merged labelmap with the proper color index.
+  // The merged labelmap is partitioned into slabs of slices that are processed in parallel.
+  short* mergedScalars = static_cast<short*>(sharedImageData->GetScalarPointer());
+  auto mergeLayersIntoSlab = [&layers, &segmentLabelValues, mergedScalars, &referenceExtent](vtkIdType firstSlice, vtkIdType endSlice)
+    {
+    MergeLayersIntoSlices(layers, segmentLabelValues, mergedScalars, referenceExtent, static_cast<int>(firstSlice), static_cast<int>(endSlice - 1));
+    };
+  vtkSMPTools::For(referenceExtent[4], referenceExtent[5] + 1, mergeLayersIntoSlab);
+  // Voxels were written directly through the scalar pointer
+  sharedImageData->Modified();
+
   return success;
 }
 
@@ -1656,6 +2023,14 @@ int vtkSegmentation::GetUniqueLabelValueForSharedLabelmap(vtkOrientedImageData*
     return DEFAULT_LABEL_VALUE;
     }
 
+  // Label metadata is kept up-to-date while the labelmap is edited, so the labelmap does not need to be scanned
+  vtkLabelmapMetadata* metadata = labelmap->GetLabelmapMetadata();
+  if (metadata)
+    {
+    int highLabel = static_cast<int>(std::max<vtkTypeInt64>(metadata->GetMaximumLabelValue(), 0));
+    return highLabel + 1;
+    }
+
   double* scalarRange = labelmap->GetScalarRange();
   int highLabel = (int)scalarRange[1];
   return highLabel + 1;
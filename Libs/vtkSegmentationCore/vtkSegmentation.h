@@ -24,6 +24,7 @@
 // VTK includes
 #include <vtkObject.h>
 #include <vtkSmartPointer.h>
+#include <vtkWeakPointer.h>
 
 // STD includes
 #include <map>
@@ -311,11 +312,25 @@ public:
   /// Invalidate (remove) non-master representations in all the segments if this segmentation node
   void InvalidateNonMasterRepresentations();
 
+  /// Record that voxels of a master representation labelmap were only modified within the specified IJK extent.
+  /// Conversion rules can use this information to update only the affected region of derived representations.
+  /// \param labelmap Modified master representation
+  /// \param modifiedExtent IJK extent of the labelmap that contains all modified voxels
+  /// \param mtimeBefore Modified time of the labelmap before the modification
+  void AddModifiedLabelmapExtent(vtkDataObject* labelmap, const int modifiedExtent[6], vtkMTimeType mtimeBefore);
+
+  /// Get the IJK extent that contains all voxels of a master representation labelmap that were modified
+  /// since the labelmap had the specified modified time.
+  /// \return False if not all modifications since that time are recorded. In this case the whole
+  ///   labelmap has to be considered modified.
+  bool GetModifiedLabelmapExtent(vtkDataObject* labelmap, vtkMTimeType sinceMTime, int modifiedExtent[6]);
+
   /// Merged labelmap functions
 
 #ifndef __VTK_WRAP__
   /// Create a merged labelmap from the segment IDs
   /// If no segment IDs are specified, then all segments will be merged
+  /// Segments of all labelmap layers are merged in a single pass, processing slabs of the merged labelmap in parallel.
   /// \param mergedImageData Output image data for the merged labelmap image data. Voxels of background volume will be
   /// of signed short type. Label value of n-th segment in segmentIDs list will be (n + 1), or will be specified in labelValues.
   /// Label value of background = 0.
@@ -478,6 +493,13 @@ public:
   /// the segmentation! Use \sa CreateRepresentation for that.
   virtual void SetMasterRepresentationName(const std::string& representationName);
 
+  /// Convert segments concurrently if the conversion rule supports it (see vtkSegmentationConverterRule::IsThreadSafe).
+  /// Results are committed to the segments in segment order, therefore they are the same as with sequential conversion.
+  /// Enabled by default.
+  vtkGetMacro(ParallelConversion, bool);
+  vtkSetMacro(ParallelConversion, bool);
+  vtkBooleanMacro(ParallelConversion, bool);
+
   /// Deep copies source segment to destination segment. If the same representation is found in baseline
   /// with up-to-date timestamp then the representation is reused from baseline.
   static void CopySegment(vtkSegment* destination, vtkSegment* source, vtkSegment* baseline,
@@ -494,6 +516,13 @@ protected:
   /// \return Success flag
   bool ConvertSegmentUsingPath(vtkSegment* segment, vtkSegmentationConversionPath* path, bool overwriteExisting = false);
 
+  /// Convert segments with a thread-safe conversion rule using the VTK SMP thread pool.
+  /// Conversion is performed on temporary segments so that no events are invoked from worker threads.
+  /// Each temporary segment contains a shallow copy of the source representation. Results that are shared
+  /// between segments are computed by vtkSegmentationConverterRule::PrepareConcurrentConvert before the
+  /// concurrent conversion, then the target representations are set in the segments in the order of the input list.
+  void ConvertSegmentsInParallel(const std::vector<vtkSegment*>& segments, vtkSegmentationConverterRule* rule);
+
   /// Converts a single segment to a representation.
   bool ConvertSingleSegment(std::string segmentId, std::string targetRepresentationName);
 
@@ -555,6 +584,9 @@ protected:
   /// Modified events of segments are observed
   bool SegmentModifiedEnabled;
 
+  /// Segments are converted concurrently by thread-safe conversion rules
+  bool ParallelConversion;
+
   /// This number is incremented and used for generating the next
   /// segment ID.
   int SegmentIdAutogeneratorIndex;
@@ -566,6 +598,26 @@ protected:
 
   std::set<vtkSmartPointer<vtkDataObject> > MasterRepresentationCache;
 
+  /// Voxel modification of a master labelmap, see AddModifiedLabelmapExtent
+  struct ModifiedLabelmapExtent
+  {
+    int Extent[6];
+    vtkMTimeType MTimeBefore;
+    vtkMTimeType MTimeAfter;
+  };
+  /// Recorded voxel modifications of a master labelmap
+  struct LabelmapModifications
+  {
+    /// Detects if the labelmap was deleted and a new labelmap was created at the same address
+    vtkWeakPointer<vtkDataObject> Labelmap;
+    /// Recent modifications in chronological order
+    std::deque<ModifiedLabelmapExtent> Modifications;
+  };
+  /// Recent modifications of master labelmaps.
+  /// The labelmaps may already be deleted, therefore keys must only be compared, never dereferenced.
+  /// Entries of labelmaps that are no longer master representations are removed in UpdateMasterRepresentationObservers.
+  std::map<vtkDataObject*, LabelmapModifications> ModifiedLabelmapExtents;
+
   friend class vtkMRMLSegmentationNode;
   friend class vtkSlicerSegmentationsModuleLogic;
   friend class vtkSegmentationModifier;
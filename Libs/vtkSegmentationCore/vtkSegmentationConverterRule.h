@@ -27,6 +27,9 @@
 #include <vtkNew.h>
 #include <vtkObject.h>
 
+// STD includes
+#include <vector>
+
 class vtkDataObject;
 class vtkSegmentation;
 class vtkSegment;
@@ -94,6 +97,22 @@ public:
   /// This step should be unnecessary if only converting a single segment
   virtual bool PostConvert(vtkSegmentation* vtkNotUsed(segmentation)) { return true; };
 
+  /// Return true if Convert can be called concurrently for different segments between PreConvert
+  /// and PostConvert. Thread-safe rules must only modify the segment passed to Convert and must
+  /// not modify any state that is shared between segments (such as caches) in Convert.
+  /// Rules are not thread-safe by default.
+  virtual bool IsThreadSafe() { return false; };
+
+  /// Perform steps before Convert is called concurrently for the specified segments.
+  /// Called from the main thread after PreConvert. Convert must not wait for other threads, therefore
+  /// results that are shared between segments (for example surfaces computed from a shared labelmap)
+  /// need to be computed here, so that Convert only has to read them.
+  /// \param segments Segments of the segmentation that are converted
+  /// \param workSegments Segments that Convert will be called with. Each contains a shallow copy of
+  ///   the source representation of the segment with the same index in segments.
+  virtual bool PrepareConcurrentConvert(const std::vector<vtkSegment*>& vtkNotUsed(segments),
+    const std::vector<vtkSegment*>& vtkNotUsed(workSegments)) { return true; };
+
   /// Get the cost of the conversion.
   /// \return Expected duration of the conversion in milliseconds. If the arguments are omitted, then a rough average can be
   ///   given just to indicate the relative computational cost of the algorithm. If the objects are given, then a more educated
@@ -131,6 +150,10 @@ public:
   /// Determine if the rule has a parameter with a certain name
   bool HasConversionParameter(const std::string& name);
 
+  /// If true then Convert replaces the target representation object of the segment,
+  /// otherwise the existing target representation object is updated.
+  vtkGetMacro(ReplaceTargetRepresentation, bool);
+
 protected:
   /// Update the target representation based on the source representation
   virtual bool CreateTargetRepresentation(vtkSegment* segment);
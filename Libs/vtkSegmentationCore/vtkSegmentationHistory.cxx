@@ -21,15 +21,276 @@
 // SegmentationCore includes
 #include "vtkSegmentationHistory.h"
 #include "vtkSegmentationConverterFactory.h"
+#include "vtkOrientedImageData.h"
+#include "vtkOrientedImageDataResample.h"
 #include "vtkSegmentation.h"
 
 // VTK includes
+#include <vtkCallbackCommand.h>
+#include <vtkLZ4DataCompressor.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
-#include <vtkCallbackCommand.h>
+#include <vtkPointData.h>
+#include <vtkSMPTools.h>
 
 // std includes
 #include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <set>
+
+namespace
+{
+// Size of independently compressed blocks of voxel data. Unchanged bricks are not stored at all,
+// therefore smaller bricks make the stored difference more proportional to the changed region.
+const size_t HISTORY_BRICK_SIZE = 256 * 1024;
+
+//----------------------------------------------------------------------------
+size_t GetScalarBufferSize(vtkImageData* image)
+{
+  if (!image || !image->GetPointData()->GetScalars())
+    {
+    return 0;
+    }
+  return static_cast<size_t>(image->GetNumberOfPoints()) * image->GetNumberOfScalarComponents() * image->GetScalarSize();
+}
+
+//----------------------------------------------------------------------------
+/// Voxels of two images can only be compared if they are on the same grid and have the same scalar layout.
+/// The compared region is the intersection of the two extents, returns false if they do not overlap.
+bool GetComparableExtent(vtkOrientedImageData* image1, vtkOrientedImageData* image2, int comparableExtent[6])
+{
+  if (GetScalarBufferSize(image1) == 0 || GetScalarBufferSize(image2) == 0
+    || image1->GetScalarType() != image2->GetScalarType()
+    || image1->GetNumberOfScalarComponents() != image2->GetNumberOfScalarComponents()
+    || !vtkOrientedImageDataResample::DoGeometriesMatch(image1, image2))
+    {
+    return false;
+    }
+  int* extent1 = image1->GetExtent();
+  int* extent2 = image2->GetExtent();
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    comparableExtent[axis * 2] = std::max(extent1[axis * 2], extent2[axis * 2]);
+    comparableExtent[axis * 2 + 1] = std::min(extent1[axis * 2 + 1], extent2[axis * 2 + 1]);
+    if (comparableExtent[axis * 2] > comparableExtent[axis * 2 + 1])
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+/// Call rowFunction(offset, rowSize) for each row of voxels of the extent in an image buffer of dataExtent.
+template <class RowFunction>
+void ForEachExtentRow(const int dataExtent[6], size_t voxelSize, const int extent[6], RowFunction rowFunction)
+{
+  size_t rowSize = static_cast<size_t>(extent[1] - extent[0] + 1) * voxelSize;
+  size_t dataRowSize = static_cast<size_t>(dataExtent[1] - dataExtent[0] + 1) * voxelSize;
+  size_t dataSliceSize = static_cast<size_t>(dataExtent[3] - dataExtent[2] + 1) * dataRowSize;
+  for (int k = extent[4]; k <= extent[5]; ++k)
+    {
+    for (int j = extent[2]; j <= extent[3]; ++j)
+      {
+      rowFunction((k - dataExtent[4]) * dataSliceSize + (j - dataExtent[2]) * dataRowSize
+        + (extent[0] - dataExtent[0]) * voxelSize, rowSize);
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+/// Copy voxels of the extent from the image into a contiguous buffer (or back to the image if toImage is true).
+void CopyExtentVoxels(vtkImageData* image, const int extent[6], unsigned char* buffer, bool toImage)
+{
+  unsigned char* imageData = static_cast<unsigned char*>(image->GetScalarPointer());
+  size_t voxelSize = static_cast<size_t>(image->GetNumberOfScalarComponents()) * image->GetScalarSize();
+  ForEachExtentRow(image->GetExtent(), voxelSize, extent, [imageData, &buffer, toImage](size_t offset, size_t rowSize)
+    {
+    if (toImage)
+      {
+      memcpy(imageData + offset, buffer, rowSize);
+      }
+    else
+      {
+      memcpy(buffer, imageData + offset, rowSize);
+      }
+    buffer += rowSize;
+    });
+}
+
+//----------------------------------------------------------------------------
+size_t GetExtentBufferSize(vtkImageData* image, const int extent[6])
+{
+  return static_cast<size_t>(extent[1] - extent[0] + 1) * (extent[3] - extent[2] + 1) * (extent[5] - extent[4] + 1)
+    * image->GetNumberOfScalarComponents() * image->GetScalarSize();
+}
+
+//----------------------------------------------------------------------------
+/// Compress the bitwise difference of data and reference (or data itself if reference is nullptr).
+/// Bricks without difference are left empty. Bricks that cannot be compressed are stored as is.
+void CompressBricks(const unsigned char* data, const unsigned char* reference, size_t size,
+  std::vector<std::vector<unsigned char> >& bricks)
+{
+  vtkIdType numberOfBricks = static_cast<vtkIdType>((size + HISTORY_BRICK_SIZE - 1) / HISTORY_BRICK_SIZE);
+  bricks.clear();
+  bricks.resize(numberOfBricks);
+  auto compressBricks = [data, reference, size, &bricks](vtkIdType begin, vtkIdType end)
+    {
+    vtkNew<vtkLZ4DataCompressor> compressor;
+    std::vector<unsigned char> difference;
+    std::vector<unsigned char> compressed;
+    for (vtkIdType brickIndex = begin; brickIndex < end; ++brickIndex)
+      {
+      size_t offset = brickIndex * HISTORY_BRICK_SIZE;
+      size_t brickSize = std::min(HISTORY_BRICK_SIZE, size - offset);
+      difference.resize(brickSize);
+      unsigned char changed = 0;
+      for (size_t i = 0; i < brickSize; ++i)
+        {
+        difference[i] = reference ? (data[offset + i] ^ reference[offset + i]) : data[offset + i];
+        changed |= difference[i];
+        }
+      if (!changed)
+        {
+        continue;
+        }
+      compressed.resize(compressor->GetMaximumCompressionSpace(brickSize));
+      size_t compressedSize = compressor->Compress(difference.data(), brickSize, compressed.data(), compressed.size());
+      if (compressedSize == 0 || compressedSize >= brickSize)
+        {
+        // a brick with the uncompressed size is stored uncompressed
+        bricks[brickIndex] = difference;
+        }
+      else
+        {
+        bricks[brickIndex].assign(compressed.begin(), compressed.begin() + compressedSize);
+        }
+      }
+    };
+  vtkSMPTools::For(0, numberOfBricks, compressBricks);
+}
+
+//----------------------------------------------------------------------------
+/// Inverse of CompressBricks: reconstruct data from the bricks and the reference.
+bool DecompressBricks(const std::vector<std::vector<unsigned char> >& bricks, const unsigned char* reference,
+  unsigned char* data, size_t size)
+{
+  std::atomic<bool> success(true);
+  auto decompressBricks = [&bricks, reference, data, size, &success](vtkIdType begin, vtkIdType end)
+    {
+    vtkNew<vtkLZ4DataCompressor> compressor;
+    for (vtkIdType brickIndex = begin; brickIndex < end; ++brickIndex)
+      {
+      size_t offset = brickIndex * HISTORY_BRICK_SIZE;
+      size_t brickSize = std::min(HISTORY_BRICK_SIZE, size - offset);
+      const std::vector<unsigned char>& brick = bricks[brickIndex];
+      unsigned char* brickData = data + offset;
+      if (brick.empty())
+        {
+        if (reference)
+          {
+          memcpy(brickData, reference + offset, brickSize);
+          }
+        else
+          {
+          memset(brickData, 0, brickSize);
+          }
+        continue;
+        }
+      if (brick.size() == brickSize)
+        {
+        memcpy(brickData, brick.data(), brickSize);
+        }
+      else if (compressor->Uncompress(brick.data(), brick.size(), brickData, brickSize) != brickSize)
+        {
+        success = false;
+        continue;
+        }
+      if (reference)
+        {
+        for (size_t i = 0; i < brickSize; ++i)
+          {
+          brickData[i] ^= reference[offset + i];
+          }
+        }
+      }
+    };
+  vtkSMPTools::For(0, static_cast<vtkIdType>(bricks.size()), decompressBricks);
+  return success;
+}
+
+//----------------------------------------------------------------------------
+/// Compress the difference of image to reference within differenceExtent (intersection of their extents).
+/// Voxels of image outside differenceExtent have nothing to be compared to, they are compressed into outsideBricks.
+void CompressDifference(vtkImageData* image, vtkImageData* reference, const int differenceExtent[6],
+  std::vector<std::vector<unsigned char> >& differenceBricks, std::vector<std::vector<unsigned char> >& outsideBricks)
+{
+  unsigned char* imageData = static_cast<unsigned char*>(image->GetScalarPointer());
+  size_t imageSize = GetScalarBufferSize(image);
+  int* imageExtent = image->GetExtent();
+  int* referenceExtent = reference->GetExtent();
+  outsideBricks.clear();
+  if (std::equal(imageExtent, imageExtent + 6, referenceExtent))
+    {
+    // Most common case: the extent has not changed, buffers can be compared directly
+    CompressBricks(imageData, static_cast<unsigned char*>(reference->GetScalarPointer()), imageSize, differenceBricks);
+    return;
+    }
+
+  size_t differenceSize = GetExtentBufferSize(image, differenceExtent);
+  std::vector<unsigned char> imageVoxels(differenceSize);
+  std::vector<unsigned char> referenceVoxels(differenceSize);
+  CopyExtentVoxels(image, differenceExtent, imageVoxels.data(), false);
+  CopyExtentVoxels(reference, differenceExtent, referenceVoxels.data(), false);
+  CompressBricks(imageVoxels.data(), referenceVoxels.data(), differenceSize, differenceBricks);
+  if (differenceSize == imageSize)
+    {
+    // image is fully contained in the reference
+    return;
+    }
+
+  // Voxels in differenceExtent are cleared so that bricks that are fully inside it are not stored
+  std::vector<unsigned char> outsideVoxels(imageData, imageData + imageSize);
+  size_t voxelSize = static_cast<size_t>(image->GetNumberOfScalarComponents()) * image->GetScalarSize();
+  ForEachExtentRow(imageExtent, voxelSize, differenceExtent, [&outsideVoxels](size_t offset, size_t rowSize)
+    {
+    memset(outsideVoxels.data() + offset, 0, rowSize);
+    });
+  CompressBricks(outsideVoxels.data(), nullptr, imageSize, outsideBricks);
+}
+
+//----------------------------------------------------------------------------
+/// Inverse of CompressDifference: reconstruct voxels of image (allocated with the original geometry) from the reference.
+bool DecompressDifference(const std::vector<std::vector<unsigned char> >& differenceBricks,
+  const std::vector<std::vector<unsigned char> >& outsideBricks, vtkImageData* reference,
+  const int differenceExtent[6], vtkImageData* image)
+{
+  unsigned char* imageData = static_cast<unsigned char*>(image->GetScalarPointer());
+  size_t imageSize = GetScalarBufferSize(image);
+  int* imageExtent = image->GetExtent();
+  int* referenceExtent = reference->GetExtent();
+  if (std::equal(imageExtent, imageExtent + 6, referenceExtent))
+    {
+    return DecompressBricks(differenceBricks, static_cast<unsigned char*>(reference->GetScalarPointer()), imageData, imageSize);
+    }
+
+  size_t differenceSize = GetExtentBufferSize(image, differenceExtent);
+  if (differenceSize != imageSize && !DecompressBricks(outsideBricks, nullptr, imageData, imageSize))
+    {
+    return false;
+    }
+  std::vector<unsigned char> imageVoxels(differenceSize);
+  std::vector<unsigned char> referenceVoxels(differenceSize);
+  CopyExtentVoxels(reference, differenceExtent, referenceVoxels.data(), false);
+  if (!DecompressBricks(differenceBricks, referenceVoxels.data(), imageVoxels.data(), differenceSize))
+    {
+    return false;
+    }
+  CopyExtentVoxels(image, differenceExtent, imageVoxels.data(), true);
+  return true;
+}
+}
 
 //----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkSegmentationHistory);
@@ -40,6 +301,7 @@ vtkSegmentationHistory::vtkSegmentationHistory()
   this->Segmentation = nullptr;
 
   this->MaximumNumberOfStates = 5;
+  this->MaximumMemorySize = 0;
 
   this->LastRestoredState = 0;
   this->RestoreStateInProgress = false;
@@ -98,6 +360,7 @@ void vtkSegmentationHistory::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Modified Time: " << this->GetMTime() << "\n";
 
   os << indent << "Number of saved states:  " << this->SegmentationStates.size() << "\n";
+  os << indent << "Maximum memory size:  " << this->MaximumMemorySize << "\n";
 }
 
 //---------------------------------------------------------------------------
@@ -141,7 +404,7 @@ bool vtkSegmentationHistory::SaveState()
     // Previous saved state of the segment
     // (if the new state has exactly the same representation then only a shallow copy will be made)
     vtkSegment* baselineSegment = nullptr;
-    if (this->SegmentationStates.size() > 0)
+    if (this->SegmentationStates.size() > 0 && this->SegmentationStates.back().ReusableAsBaseline)
       {
       SegmentsMap::iterator baselineSegmentIt = this->SegmentationStates.back().Segments.find(*segmentIDIt);
       if (baselineSegmentIt != this->SegmentationStates.back().Segments.end())
@@ -156,6 +419,12 @@ bool vtkSegmentationHistory::SaveState()
     }
   this->SegmentationStates.push_back(newSegmentationState);
 
+  // Only the most recent state is kept in full, the previous one is stored relative to it
+  if (this->SegmentationStates.size() > 1)
+    {
+    this->CompressState((unsigned int)this->SegmentationStates.size() - 2);
+    }
+
   // Set the current state as last restored state.
   // Setting it to SegmentationStates.size() would mean that the state has been modified since
   // the state was saved.
@@ -218,9 +487,43 @@ bool vtkSegmentationHistory::RestoreNextState()
 //---------------------------------------------------------------------------
 bool vtkSegmentationHistory::RestoreState(unsigned int stateIndex)
 {
-  this->RestoreStateInProgress = true;
+  // Compressed data of the state is not needed for restoring, only copy the segments
+  SegmentationState restoredState;
+  restoredState.Segments = this->SegmentationStates[stateIndex].Segments;
+  restoredState.SegmentIds = this->SegmentationStates[stateIndex].SegmentIds;
+  if (this->SegmentationStates[stateIndex].Compressed)
+    {
+    // Restore from temporary segments that contain the reconstructed images
+    std::map<vtkDataObject*, vtkSmartPointer<vtkOrientedImageData> > images;
+    if (!this->GetStateImages(stateIndex, images))
+      {
+      vtkErrorMacro("vtkSegmentation::RestoreState failed: Failed to reconstruct labelmaps of state " << stateIndex);
+      return false;
+      }
+    for (SegmentsMap::iterator segmentIt = restoredState.Segments.begin(); segmentIt != restoredState.Segments.end(); ++segmentIt)
+      {
+      vtkSmartPointer<vtkSegment> segment = vtkSmartPointer<vtkSegment>::New();
+      segment->DeepCopyMetadata(segmentIt->second);
+      std::vector<std::string> representationNames;
+      segmentIt->second->GetContainedRepresentationNames(representationNames);
+      for (const std::string& representationName : representationNames)
+        {
+        vtkDataObject* representation = segmentIt->second->GetRepresentation(representationName);
+        std::map<vtkDataObject*, vtkSmartPointer<vtkOrientedImageData> >::iterator imageIt = images.find(representation);
+        if (imageIt != images.end())
+          {
+          segment->AddRepresentation(representationName, imageIt->second);
+          }
+        else
+          {
+          segment->AddRepresentation(representationName, representation);
+          }
+        }
+      segmentIt->second = segment;
+      }
+    }
 
-  SegmentationState restoredState = this->SegmentationStates[stateIndex];
+  this->RestoreStateInProgress = true;
 
   std::set<std::string> segmentIDsToKeep;
   std::map<vtkDataObject*, vtkDataObject*> restoredRepresentations;
@@ -296,6 +599,11 @@ bool vtkSegmentationHistory::IsRestoreNextStateAvailable()
 //---------------------------------------------------------------------------
 void vtkSegmentationHistory::RemoveAllNextStates()
 {
+  if (this->SegmentationStates.size() > this->LastRestoredState + 1)
+    {
+    // The last restored state becomes the most recent one, which is stored in full
+    this->DecompressState(this->LastRestoredState);
+    }
   bool modified = false;
   while ((this->SegmentationStates.size() > this->LastRestoredState + 1) && (!this->SegmentationStates.empty()))
     {
@@ -318,12 +626,288 @@ void vtkSegmentationHistory::RemoveAllObsoleteStates()
     this->LastRestoredState--;
     modified = true;
    }
+  // Older states only depend on newer states, so removing the oldest state does not affect the others
+  while (this->MaximumMemorySize > 0 && this->SegmentationStates.size() > 1 && this->LastRestoredState > 0
+    && this->GetMemorySize() > this->MaximumMemorySize)
+    {
+    this->SegmentationStates.pop_front();
+    this->LastRestoredState--;
+    modified = true;
+    }
   if (modified)
     {
     this->Modified();
     }
 }
 
+//---------------------------------------------------------------------------
+void vtkSegmentationHistory::SetMaximumMemorySize(vtkTypeInt64 maximumMemorySize)
+{
+  if (maximumMemorySize == this->MaximumMemorySize)
+    {
+    return;
+    }
+  this->MaximumMemorySize = maximumMemorySize;
+  this->RemoveAllObsoleteStates();
+  this->Modified();
+}
+
+//---------------------------------------------------------------------------
+vtkTypeInt64 vtkSegmentationHistory::GetMemorySize()
+{
+  vtkTypeInt64 memorySize = 0;
+  // Representations may be shared between segments and between states, count them only once
+  std::set<vtkDataObject*> countedRepresentations;
+  for (const SegmentationState& state : this->SegmentationStates)
+    {
+    for (const CompressedImage& compressedImage : state.CompressedImages)
+      {
+      countedRepresentations.insert(compressedImage.Geometry);
+      for (const std::vector<unsigned char>& brick : compressedImage.Bricks)
+        {
+        memorySize += brick.size();
+        }
+      for (const std::vector<unsigned char>& brick : compressedImage.OutsideBricks)
+        {
+        memorySize += brick.size();
+        }
+      }
+    for (SegmentsMap::const_iterator segmentIt = state.Segments.begin(); segmentIt != state.Segments.end(); ++segmentIt)
+      {
+      std::vector<std::string> representationNames;
+      segmentIt->second->GetContainedRepresentationNames(representationNames);
+      for (const std::string& representationName : representationNames)
+        {
+        vtkDataObject* representation = segmentIt->second->GetRepresentation(representationName);
+        if (representation && countedRepresentations.insert(representation).second)
+          {
+          memorySize += static_cast<vtkTypeInt64>(representation->GetActualMemorySize()) * 1024;
+          }
+        }
+      }
+    }
+  return memorySize;
+}
+
+//---------------------------------------------------------------------------
+void vtkSegmentationHistory::CompressState(unsigned int stateIndex)
+{
+  if (stateIndex + 1 >= this->SegmentationStates.size())
+    {
+    vtkErrorMacro("CompressState: The most recent state cannot be compressed");
+    return;
+    }
+  SegmentationState& state = this->SegmentationStates[stateIndex];
+  if (state.Compressed)
+    {
+    return;
+    }
+  std::map<vtkDataObject*, vtkSmartPointer<vtkOrientedImageData> > nextImages;
+  if (!this->GetStateImages(stateIndex + 1, nextImages))
+    {
+    vtkErrorMacro("CompressState: Failed to reconstruct labelmaps of state " << stateIndex + 1);
+    return;
+    }
+  SegmentationState& nextState = this->SegmentationStates[stateIndex + 1];
+
+  // Full image -> image without scalars that replaces it in the segments (shared labelmaps are compressed once)
+  std::map<vtkDataObject*, vtkOrientedImageData*> compressedImages;
+  for (SegmentsMap::iterator segmentIt = state.Segments.begin(); segmentIt != state.Segments.end(); ++segmentIt)
+    {
+    vtkSegment* segment = segmentIt->second;
+    std::vector<std::string> representationNames;
+    segment->GetContainedRepresentationNames(representationNames);
+    for (const std::string& representationName : representationNames)
+      {
+      vtkOrientedImageData* image = vtkOrientedImageData::SafeDownCast(segment->GetRepresentation(representationName));
+      if (!image || !image->GetPointData()->GetScalars())
+        {
+        continue;
+        }
+      std::map<vtkDataObject*, vtkOrientedImageData*>::iterator compressedImageIt = compressedImages.find(image);
+      if (compressedImageIt != compressedImages.end())
+        {
+        segment->AddRepresentation(representationName, compressedImageIt->second);
+        continue;
+        }
+
+      CompressedImage compressedImage;
+      compressedImage.RepresentationName = representationName;
+      compressedImage.ScalarType = image->GetScalarType();
+      compressedImage.NumberOfScalarComponents = image->GetNumberOfScalarComponents();
+      compressedImage.Geometry = vtkSmartPointer<vtkOrientedImageData>::New();
+      compressedImage.Geometry->SetExtent(image->GetExtent());
+      compressedImage.Geometry->SetOrigin(image->GetOrigin());
+      compressedImage.Geometry->SetSpacing(image->GetSpacing());
+      compressedImage.Geometry->CopyDirections(image);
+
+      // The same representation of the same segment in the next state is the most similar image
+      vtkOrientedImageData* referenceImage = nullptr;
+      SegmentsMap::iterator nextSegmentIt = nextState.Segments.find(segmentIt->first);
+      if (nextSegmentIt != nextState.Segments.end())
+        {
+        std::map<vtkDataObject*, vtkSmartPointer<vtkOrientedImageData> >::iterator nextImageIt =
+          nextImages.find(nextSegmentIt->second->GetRepresentation(representationName));
+        if (nextImageIt != nextImages.end()
+          && GetComparableExtent(image, nextImageIt->second, compressedImage.DifferenceExtent))
+          {
+          referenceImage = nextImageIt->second;
+          compressedImage.ReferenceSegmentId = segmentIt->first;
+          }
+        }
+
+      if (referenceImage == image)
+        {
+        // Unchanged since the state was saved, nothing to store
+        compressedImage.Identical = true;
+        }
+      else if (referenceImage)
+        {
+        CompressDifference(image, referenceImage, compressedImage.DifferenceExtent,
+          compressedImage.Bricks, compressedImage.OutsideBricks);
+        }
+      else
+        {
+        CompressBricks(static_cast<unsigned char*>(image->GetScalarPointer()), nullptr,
+          GetScalarBufferSize(image), compressedImage.Bricks);
+        }
+
+      compressedImages[image] = compressedImage.Geometry;
+      segment->AddRepresentation(representationName, compressedImage.Geometry);
+      state.CompressedImages.push_back(compressedImage);
+      }
+    }
+  state.Compressed = true;
+}
+
+//---------------------------------------------------------------------------
+bool vtkSegmentationHistory::DecompressState(unsigned int stateIndex)
+{
+  if (stateIndex >= this->SegmentationStates.size())
+    {
+    return false;
+    }
+  SegmentationState& state = this->SegmentationStates[stateIndex];
+  if (!state.Compressed)
+    {
+    return true;
+    }
+  std::map<vtkDataObject*, vtkSmartPointer<vtkOrientedImageData> > images;
+  if (!this->GetStateImages(stateIndex, images))
+    {
+    vtkErrorMacro("DecompressState: Failed to reconstruct labelmaps of state " << stateIndex);
+    return false;
+    }
+  for (SegmentsMap::iterator segmentIt = state.Segments.begin(); segmentIt != state.Segments.end(); ++segmentIt)
+    {
+    std::vector<std::string> representationNames;
+    segmentIt->second->GetContainedRepresentationNames(representationNames);
+    for (const std::string& representationName : representationNames)
+      {
+      std::map<vtkDataObject*, vtkSmartPointer<vtkOrientedImageData> >::iterator imageIt =
+        images.find(segmentIt->second->GetRepresentation(representationName));
+      if (imageIt != images.end())
+        {
+        segmentIt->second->AddRepresentation(representationName, imageIt->second);
+        }
+      }
+    }
+  state.CompressedImages.clear();
+  state.Compressed = false;
+  // Modification time of the reconstructed images is more recent than the time of the changes
+  // in the segmentation, therefore it cannot be used for detecting if they are up-to-date.
+  state.ReusableAsBaseline = false;
+  return true;
+}
+
+//---------------------------------------------------------------------------
+bool vtkSegmentationHistory::GetStateImages(unsigned int stateIndex,
+  std::map<vtkDataObject*, vtkSmartPointer<vtkOrientedImageData> >& images)
+{
+  images.clear();
+  if (stateIndex >= this->SegmentationStates.size())
+    {
+    return false;
+    }
+
+  // Start from the first fully stored state and apply the differences backwards
+  unsigned int fullStateIndex = stateIndex;
+  while (this->SegmentationStates[fullStateIndex].Compressed)
+    {
+    ++fullStateIndex;
+    if (fullStateIndex >= this->SegmentationStates.size())
+      {
+      return false;
+      }
+    }
+  const SegmentationState& fullState = this->SegmentationStates[fullStateIndex];
+  for (SegmentsMap::const_iterator segmentIt = fullState.Segments.begin(); segmentIt != fullState.Segments.end(); ++segmentIt)
+    {
+    std::vector<std::string> representationNames;
+    segmentIt->second->GetContainedRepresentationNames(representationNames);
+    for (const std::string& representationName : representationNames)
+      {
+      vtkOrientedImageData* image = vtkOrientedImageData::SafeDownCast(segmentIt->second->GetRepresentation(representationName));
+      if (image)
+        {
+        images[image] = image;
+        }
+      }
+    }
+
+  for (unsigned int currentStateIndex = fullStateIndex; currentStateIndex > stateIndex; --currentStateIndex)
+    {
+    const SegmentationState& state = this->SegmentationStates[currentStateIndex - 1];
+    const SegmentationState& nextState = this->SegmentationStates[currentStateIndex];
+    std::map<vtkDataObject*, vtkSmartPointer<vtkOrientedImageData> > stateImages;
+    for (const CompressedImage& compressedImage : state.CompressedImages)
+      {
+      vtkOrientedImageData* referenceImage = nullptr;
+      if (!compressedImage.ReferenceSegmentId.empty())
+        {
+        SegmentsMap::const_iterator nextSegmentIt = nextState.Segments.find(compressedImage.ReferenceSegmentId);
+        if (nextSegmentIt != nextState.Segments.end())
+          {
+          std::map<vtkDataObject*, vtkSmartPointer<vtkOrientedImageData> >::iterator nextImageIt =
+            images.find(nextSegmentIt->second->GetRepresentation(compressedImage.RepresentationName));
+          if (nextImageIt != images.end())
+            {
+            referenceImage = nextImageIt->second;
+            }
+          }
+        if (!referenceImage)
+          {
+          return false;
+          }
+        }
+      if (compressedImage.Identical)
+        {
+        stateImages[compressedImage.Geometry] = referenceImage;
+        continue;
+        }
+
+      vtkSmartPointer<vtkOrientedImageData> image = vtkSmartPointer<vtkOrientedImageData>::New();
+      image->SetExtent(compressedImage.Geometry->GetExtent());
+      image->SetOrigin(compressedImage.Geometry->GetOrigin());
+      image->SetSpacing(compressedImage.Geometry->GetSpacing());
+      image->CopyDirections(compressedImage.Geometry);
+      image->AllocateScalars(compressedImage.ScalarType, compressedImage.NumberOfScalarComponents);
+      bool decompressed = referenceImage
+        ? DecompressDifference(compressedImage.Bricks, compressedImage.OutsideBricks, referenceImage,
+            compressedImage.DifferenceExtent, image)
+        : DecompressBricks(compressedImage.Bricks, nullptr,
+            static_cast<unsigned char*>(image->GetScalarPointer()), GetScalarBufferSize(image));
+      if (!decompressed)
+        {
+        return false;
+        }
+      stateImages[compressedImage.Geometry] = image;
+      }
+    images.swap(stateImages);
+    }
+  return true;
+}
+
 //---------------------------------------------------------------------------
 void vtkSegmentationHistory::SetMaximumNumberOfStates(unsigned int maximumNumberOfStates)
 {
@@ -28,16 +28,23 @@
 // STD includes
 #include <deque>
 #include <map>
+#include <string>
 #include <vector>
 
 #include "vtkSegmentationCoreConfigure.h"
 
 class vtkCallbackCommand;
 class vtkDataObject;
+class vtkOrientedImageData;
 class vtkSegment;
 class vtkSegmentation;
 
 /// \ingroup SegmentationCore
+/// \brief Stores states of a segmentation for undo/redo.
+///
+/// Only the most recent state is stored in full. Image representations (such as binary labelmaps)
+/// of older states are stored as compressed bitwise difference to the next state, so each undo step
+/// costs memory proportional to the changed region of the labelmaps.
 class vtkSegmentationCore_EXPORT vtkSegmentationHistory : public vtkObject
 {
 public:
@@ -86,6 +93,17 @@ public:
   /// Get the current number of states.
   int GetNumberOfStates();
 
+  /// Limits how much memory the stored states may use, in bytes. 0 means no limit.
+  /// If the memory usage exceeds the limit then the oldest states are removed,
+  /// but the state that was restored last is always kept.
+  void SetMaximumMemorySize(vtkTypeInt64 maximumMemorySize);
+
+  /// Get the limit of memory used by the stored states, in bytes.
+  vtkGetMacro(MaximumMemorySize, vtkTypeInt64);
+
+  /// Get the memory used by the stored states, in bytes.
+  vtkTypeInt64 GetMemorySize();
+
 protected:
   /// Callback function called when the segmentation has been modified.
   /// It clears all states that are more recent than the last restored state.
@@ -95,27 +113,61 @@ protected:
   void RemoveAllNextStates();
 
   /// Delete all old states so that we keep only up to MaximumNumberOfStates states
+  /// and the memory usage does not exceed MaximumMemorySize
   void RemoveAllObsoleteStates();
 
   /// Restores a state defined by stateIndex.
   bool RestoreState(unsigned int stateIndex);
 
+  /// Replace image representations of a state by their compressed difference to the next state.
+  void CompressState(unsigned int stateIndex);
+
+  /// Replace compressed image representations of a state by the full images.
+  /// All states more recent than this state must be still available.
+  bool DecompressState(unsigned int stateIndex);
+
+  /// Reconstruct the image representations of a state by applying the differences
+  /// stored in the state and the more recent states.
+  /// \param images Map from the image object stored in the segments of the state to the full image
+  bool GetStateImages(unsigned int stateIndex, std::map<vtkDataObject*, vtkSmartPointer<vtkOrientedImageData> >& images);
+
 protected:
   vtkSegmentationHistory();
   ~vtkSegmentationHistory() override;
 
   typedef std::map<std::string, vtkSmartPointer<vtkSegment> > SegmentsMap;
 
+  /// Voxels of an image representation, stored as compressed bricks of the
+  /// bitwise difference (XOR) to the same representation in the next state.
+  /// If the extent has changed then the difference is computed in the intersection
+  /// of the two extents and the remaining voxels are stored in OutsideBricks.
+  struct CompressedImage
+    {
+    vtkSmartPointer<vtkOrientedImageData> Geometry; // image without scalars, stored in the segments of the state
+    std::string RepresentationName;
+    std::string ReferenceSegmentId; // segment in the next state that the difference is computed to, empty if none
+    bool Identical{false}; // the next state contains the very same image object
+    int ScalarType{0};
+    int NumberOfScalarComponents{1};
+    int DifferenceExtent[6]{0, -1, 0, -1, 0, -1}; // region of Bricks if there is a reference image
+    std::vector<std::vector<unsigned char> > Bricks; // empty brick means no difference
+    std::vector<std::vector<unsigned char> > OutsideBricks; // voxels outside DifferenceExtent, empty brick means zeros
+    };
+
   struct SegmentationState
     {
     SegmentsMap Segments;
     std::vector<std::string> SegmentIds; // order of segments
+    std::vector<CompressedImage> CompressedImages;
+    bool Compressed{false}; // image representations are stored in CompressedImages
+    bool ReusableAsBaseline{true}; // up-to-date representations can be shared with the next saved state
     };
 
   vtkSegmentation* Segmentation;
   vtkCallbackCommand* SegmentationModifiedCallbackCommand;
   std::deque<SegmentationState> SegmentationStates;
   unsigned int MaximumNumberOfStates;
+  vtkTypeInt64 MaximumMemorySize;
 
   // Index of the state in SegmentationStates that was restored last.
   // If LastRestoredState == size of states then it means that the segmentation has changed
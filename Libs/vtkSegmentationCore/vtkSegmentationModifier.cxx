@@ -19,6 +19,7 @@
 ==============================================================================*/
 
 // SegmentationCore includes
+#include "vtkLabelmapMetadata.h"
 #include "vtkOrientedImageData.h"
 #include "vtkOrientedImageDataResample.h"
 #include "vtkSegmentation.h"
@@ -87,6 +88,31 @@ bool vtkSegmentationModifier::ModifyBinaryLabelmap(
     return false;
     }
 
+  // Voxels of the segment labelmap can only change within the modifier extent, which is recorded in the segmentation
+  // to allow incremental update of derived representations. If the geometry of the modifier is different then
+  // the segment labelmap is resampled, therefore the modified region is not known.
+  vtkMTimeType segmentLabelmapMTime = segmentLabelmap->GetMTime();
+  bool modifiedExtentKnown = vtkOrientedImageDataResample::DoGeometriesMatch(segmentLabelmap, labelmap);
+  int modifiedExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  vtkSegmentationModifier::GetExtentIntersection(labelmap->GetExtent(), extent, modifiedExtent);
+  int* segmentLabelmapExtent = segmentLabelmap->GetExtent();
+  if (mergeMode == MODE_REPLACE && vtkSegmentationModifier::IsExtentValid(segmentLabelmapExtent))
+    {
+    // Previous content of the segment is removed
+    if (vtkSegmentationModifier::IsExtentValid(modifiedExtent))
+      {
+      for (int i = 0; i < 3; ++i)
+        {
+        modifiedExtent[2 * i] = std::min(modifiedExtent[2 * i], segmentLabelmapExtent[2 * i]);
+        modifiedExtent[2 * i + 1] = std::max(modifiedExtent[2 * i + 1], segmentLabelmapExtent[2 * i + 1]);
+        }
+      }
+    else
+      {
+      std::copy(segmentLabelmapExtent, segmentLabelmapExtent + 6, modifiedExtent);
+      }
+    }
+
   bool wasMasterRepresentationModifiedEnabled = segmentation->SetMasterRepresentationModifiedEnabled(masterRepresentationModifiedEnabled);
 
   bool segmentLabelmapModified = true;
@@ -100,6 +126,11 @@ bool vtkSegmentationModifier::ModifyBinaryLabelmap(
   // Shrink the image data extent to only contain the effective data (extent of non-zero voxels)
   vtkSegmentationModifier::ShrinkSegmentToEffectiveExtent(segmentLabelmap);
 
+  if (modifiedExtentKnown && segmentLabelmap->GetMTime() != segmentLabelmapMTime)
+    {
+    segmentation->AddModifiedLabelmapExtent(segmentLabelmap, modifiedExtent, segmentLabelmapMTime);
+    }
+
   // Re-enable master representation modified event
   segmentation->SetMasterRepresentationModifiedEnabled(wasMasterRepresentationModifiedEnabled);
   if (segmentLabelmapModified)
@@ -278,6 +309,7 @@ bool vtkSegmentationModifier::AppendLabelmapToSegment(vtkOrientedImageData* labe
     return false;
     }
 
+  vtkMTimeType segmentLabelmapMTime = segmentLabelmap->GetMTime();
   int* segmentLabelmapExtent = segmentLabelmap->GetExtent();
   bool segmentLabelmapEmpty = (segmentLabelmapExtent[0] > segmentLabelmapExtent[1] ||
     segmentLabelmapExtent[2] > segmentLabelmapExtent[3] ||
@@ -432,8 +464,35 @@ bool vtkSegmentationModifier::AppendLabelmapToSegment(vtkOrientedImageData* labe
         }
       }
 
+    // In masking mode, and in maximum mode with non-negative values, only voxels within the effective extent
+    // of the modifier can change. Restricting the merge to that region avoids padding the segment labelmap
+    // to the full extent of a mostly empty modifier.
+    const int* mergeExtent = extent;
+    int effectiveMergeExtent[6] = { 0, -1, 0, -1, 0, -1 };
+    if (operation == vtkOrientedImageDataResample::OPERATION_MASKING
+      || (operation == vtkOrientedImageDataResample::OPERATION_MAXIMUM
+        && modifierLabelmap->GetScalarTypeMin() >= 0 && resampledSegmentLabelmap->GetScalarTypeMin() >= 0))
+      {
+      int modifierEffectiveExtent[6] = { 0, -1, 0, -1, 0, -1 };
+      vtkOrientedImageDataResample::CalculateEffectiveExtent(modifierLabelmap, modifierEffectiveExtent);
+      vtkSegmentationModifier::GetExtentIntersection(modifierEffectiveExtent, extent, effectiveMergeExtent);
+      if (!vtkSegmentationModifier::IsExtentValid(modifierEffectiveExtent) || !vtkSegmentationModifier::IsExtentValid(effectiveMergeExtent))
+        {
+        if (resampledSegmentLabelmap == segmentLabelmap)
+          {
+          // Empty modifier, nothing to merge
+          segmentLabelmapModified = (segmentLabelmap->GetMTime() > segmentLabelmapMTime);
+          return true;
+          }
+        }
+      else
+        {
+        mergeExtent = effectiveMergeExtent;
+        }
+      }
+
     if (!vtkOrientedImageDataResample::MergeImage(
-      resampledSegmentLabelmap, modifierLabelmap, segmentLabelmap, operation, extent, 0, labelValue, &segmentLabelmapModified))
+      resampledSegmentLabelmap, modifierLabelmap, segmentLabelmap, operation, mergeExtent, 0, labelValue, &segmentLabelmapModified))
       {
       vtkErrorWithObjectMacro(segmentation, "vtkSegmentationModifier::SetBinaryLabelmapToSegment: Failed to merge labelmap (max)");
       return false;
@@ -445,8 +504,11 @@ bool vtkSegmentationModifier::AppendLabelmapToSegment(vtkOrientedImageData* labe
 //-----------------------------------------------------------------------------
 void vtkSegmentationModifier::ShrinkSegmentToEffectiveExtent(vtkOrientedImageData* segmentLabelmap)
 {
+  // Label metadata is kept up-to-date by subsequent modifications of the segment, therefore the labelmap
+  // is only scanned again if it is modified by other means.
+  vtkSmartPointer<vtkLabelmapMetadata> metadata = segmentLabelmap->GetLabelmapMetadata();
   int effectiveExtent[6] = {0,-1,0,-1,0,-1};
-  vtkOrientedImageDataResample::CalculateEffectiveExtent(segmentLabelmap, effectiveExtent); // TODO: use the update extent? maybe crop when changing segment?
+  vtkOrientedImageDataResample::CalculateEffectiveExtent(segmentLabelmap, effectiveExtent);
   if (effectiveExtent[0] > effectiveExtent[1] || effectiveExtent[2] > effectiveExtent[3] || effectiveExtent[4] > effectiveExtent[5])
     {
     vtkDebugWithObjectMacro(segmentLabelmap,
@@ -472,6 +534,11 @@ void vtkSegmentationModifier::ShrinkSegmentToEffectiveExtent(vtkOrientedImageDat
       padder->SetOutputWholeExtent(effectiveExtent);
       padder->Update();
       segmentLabelmap->ShallowCopy(padder->GetOutput());
+      if (metadata)
+        {
+        // Cropping to the effective extent does not remove any labels
+        segmentLabelmap->SetLabelmapMetadata(metadata);
+        }
       }
     }
 }
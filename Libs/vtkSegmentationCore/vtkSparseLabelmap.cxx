@@ -0,0 +1,513 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// SegmentationCore includes
+#include "vtkSparseLabelmap.h"
+#include "vtkOrientedImageData.h"
+#include "vtkOrientedImageDataResample.h"
+
+// VTK includes
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+
+// STD includes
+#include <algorithm>
+
+vtkStandardNewMacro(vtkSparseLabelmap);
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+/// Append the runs of non-zero voxels of each row of the image to rows and runs.
+/// If labelValue is non-zero then only voxels with that value are stored.
+template <class ImageScalarType>
+void EncodeImageGeneric(vtkImageData* image, int labelValue,
+  std::vector<vtkSparseLabelmap::Row>& rows, std::vector<vtkSparseLabelmap::Run>& runs)
+{
+  int extent[6] = { 0, -1, 0, -1, 0, -1 };
+  image->GetExtent(extent);
+  vtkIdType incX = 0;
+  vtkIdType incY = 0;
+  vtkIdType incZ = 0;
+  image->GetIncrements(incX, incY, incZ);
+  ImageScalarType* imagePtr = static_cast<ImageScalarType*>(image->GetScalarPointer());
+  if (!imagePtr)
+    {
+    return;
+    }
+
+  for (int k = extent[4]; k <= extent[5]; ++k)
+    {
+    for (int j = extent[2]; j <= extent[3]; ++j)
+      {
+      ImageScalarType* rowPtr = imagePtr + (k - extent[4]) * incZ + (j - extent[2]) * incY;
+      vtkIdType firstRun = static_cast<vtkIdType>(runs.size());
+      for (int i = extent[0]; i <= extent[1]; ++i, rowPtr += incX)
+        {
+        int value = static_cast<int>(*rowPtr);
+        if (value == 0 || (labelValue != 0 && value != labelValue))
+          {
+          continue;
+          }
+        if (static_cast<vtkIdType>(runs.size()) > firstRun && runs.back().End == i - 1 && runs.back().Value == value)
+          {
+          runs.back().End = i;
+          }
+        else
+          {
+          runs.push_back({ i, i, value });
+          }
+        }
+      if (static_cast<vtkIdType>(runs.size()) > firstRun)
+        {
+        rows.push_back({ k, j, firstRun });
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+template <class ImageScalarType>
+void DecodeImageGeneric(vtkSparseLabelmap* labelmap, vtkImageData* image)
+{
+  int extent[6] = { 0, -1, 0, -1, 0, -1 };
+  image->GetExtent(extent);
+  vtkIdType incX = 0;
+  vtkIdType incY = 0;
+  vtkIdType incZ = 0;
+  image->GetIncrements(incX, incY, incZ);
+  ImageScalarType* imagePtr = static_cast<ImageScalarType*>(image->GetScalarPointer());
+  if (!imagePtr)
+    {
+    return;
+    }
+
+  for (int k = extent[4]; k <= extent[5]; ++k)
+    {
+    for (int j = extent[2]; j <= extent[3]; ++j)
+      {
+      vtkIdType numberOfRuns = 0;
+      const vtkSparseLabelmap::Run* runs = labelmap->GetRowRuns(j, k, numberOfRuns);
+      if (!runs)
+        {
+        continue;
+        }
+      ImageScalarType* rowPtr = imagePtr + (k - extent[4]) * incZ + (j - extent[2]) * incY;
+      for (vtkIdType runIndex = 0; runIndex < numberOfRuns; ++runIndex)
+        {
+        int start = std::max(runs[runIndex].Start, extent[0]);
+        int end = std::min(runs[runIndex].End, extent[1]);
+        ImageScalarType value = static_cast<ImageScalarType>(runs[runIndex].Value);
+        for (int i = start; i <= end; ++i)
+          {
+          rowPtr[(i - extent[0]) * incX] = value;
+          }
+        }
+      }
+    }
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+vtkSparseLabelmap::vtkSparseLabelmap()
+{
+  this->Extent[0] = 0;
+  this->Extent[1] = -1;
+  this->Extent[2] = 0;
+  this->Extent[3] = -1;
+  this->Extent[4] = 0;
+  this->Extent[5] = -1;
+}
+
+//----------------------------------------------------------------------------
+vtkSparseLabelmap::~vtkSparseLabelmap() = default;
+
+//----------------------------------------------------------------------------
+void vtkSparseLabelmap::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+
+  os << indent << "Extent: (" << this->Extent[0] << ", " << this->Extent[1] << ", " << this->Extent[2]
+    << ", " << this->Extent[3] << ", " << this->Extent[4] << ", " << this->Extent[5] << ")\n";
+  os << indent << "ImageToWorldMatrix:\n";
+  this->ImageToWorldMatrix->PrintSelf(os, indent.GetNextIndent());
+  os << indent << "NumberOfRows: " << this->GetNumberOfRows() << "\n";
+  os << indent << "NumberOfRuns: " << this->GetNumberOfRuns() << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkSparseLabelmap::Initialize()
+{
+  this->Superclass::Initialize();
+  this->Extent[0] = 0;
+  this->Extent[1] = -1;
+  this->Extent[2] = 0;
+  this->Extent[3] = -1;
+  this->Extent[4] = 0;
+  this->Extent[5] = -1;
+  this->ImageToWorldMatrix->Identity();
+  this->Rows.clear();
+  this->Runs.clear();
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkSparseLabelmap::ShallowCopy(vtkDataObject* src)
+{
+  this->DeepCopy(src);
+}
+
+//----------------------------------------------------------------------------
+void vtkSparseLabelmap::DeepCopy(vtkDataObject* src)
+{
+  vtkSparseLabelmap* sparseSource = vtkSparseLabelmap::SafeDownCast(src);
+  if (sparseSource == this)
+    {
+    return;
+    }
+  this->Superclass::DeepCopy(src);
+  if (!sparseSource)
+    {
+    return;
+    }
+  std::copy(sparseSource->Extent, sparseSource->Extent + 6, this->Extent);
+  this->ImageToWorldMatrix->DeepCopy(sparseSource->ImageToWorldMatrix);
+  this->Rows = sparseSource->Rows;
+  this->Runs = sparseSource->Runs;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+unsigned long vtkSparseLabelmap::GetActualMemorySize()
+{
+  size_t size = this->Rows.capacity() * sizeof(Row) + this->Runs.capacity() * sizeof(Run);
+  return this->Superclass::GetActualMemorySize() + static_cast<unsigned long>(size / 1024);
+}
+
+//----------------------------------------------------------------------------
+void vtkSparseLabelmap::SetExtent(const int extent[6])
+{
+  if (std::equal(extent, extent + 6, this->Extent))
+    {
+    return;
+    }
+  std::copy(extent, extent + 6, this->Extent);
+  this->ClipToExtent();
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkSparseLabelmap::SetExtent(int x1, int x2, int y1, int y2, int z1, int z2)
+{
+  int extent[6] = { x1, x2, y1, y2, z1, z2 };
+  this->SetExtent(extent);
+}
+
+//----------------------------------------------------------------------------
+void vtkSparseLabelmap::GetImageToWorldMatrix(vtkMatrix4x4* mat)
+{
+  if (!mat)
+    {
+    return;
+    }
+  mat->DeepCopy(this->ImageToWorldMatrix);
+}
+
+//----------------------------------------------------------------------------
+void vtkSparseLabelmap::SetImageToWorldMatrix(vtkMatrix4x4* mat)
+{
+  if (!mat || vtkOrientedImageDataResample::IsEqual(mat, this->ImageToWorldMatrix))
+    {
+    return;
+    }
+  this->ImageToWorldMatrix->DeepCopy(mat);
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkSparseLabelmap::CopyGeometry(vtkOrientedImageData* image)
+{
+  if (!image)
+    {
+    return;
+    }
+  vtkNew<vtkMatrix4x4> imageToWorldMatrix;
+  image->GetImageToWorldMatrix(imageToWorldMatrix);
+  this->SetImageToWorldMatrix(imageToWorldMatrix);
+  this->SetExtent(image->GetExtent());
+}
+
+//----------------------------------------------------------------------------
+bool vtkSparseLabelmap::EncodeImage(vtkOrientedImageData* image, int labelValue/*=0*/)
+{
+  if (!image)
+    {
+    vtkErrorMacro("EncodeImage: Invalid input image");
+    return false;
+    }
+
+  this->Rows.clear();
+  this->Runs.clear();
+  vtkNew<vtkMatrix4x4> imageToWorldMatrix;
+  image->GetImageToWorldMatrix(imageToWorldMatrix);
+  this->ImageToWorldMatrix->DeepCopy(imageToWorldMatrix);
+  image->GetExtent(this->Extent);
+
+  if (!image->IsEmpty() && image->GetPointData() && image->GetPointData()->GetScalars())
+    {
+    switch (image->GetScalarType())
+      {
+      vtkTemplateMacro(EncodeImageGeneric<VTK_TT>(image, labelValue, this->Rows, this->Runs));
+    default:
+      vtkErrorMacro("EncodeImage: Unknown ScalarType");
+      this->Modified();
+      return false;
+      }
+    }
+
+  this->Rows.shrink_to_fit();
+  this->Runs.shrink_to_fit();
+  this->Modified();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSparseLabelmap::DecodeImage(vtkOrientedImageData* image, const int extent[6]/*=nullptr*/)
+{
+  if (!image)
+    {
+    vtkErrorMacro("DecodeImage: Invalid output image");
+    return false;
+    }
+
+  int minimumValue = 0;
+  int maximumValue = 0;
+  for (const Run& run : this->Runs)
+    {
+    minimumValue = std::min(minimumValue, run.Value);
+    maximumValue = std::max(maximumValue, run.Value);
+    }
+  int scalarType = VTK_INT;
+  if (minimumValue >= 0 && maximumValue <= VTK_UNSIGNED_CHAR_MAX)
+    {
+    scalarType = VTK_UNSIGNED_CHAR;
+    }
+  else if (minimumValue >= VTK_SHORT_MIN && maximumValue <= VTK_SHORT_MAX)
+    {
+    scalarType = VTK_SHORT;
+    }
+
+  image->SetExtent(const_cast<int*>(extent ? extent : this->Extent));
+  image->SetImageToWorldMatrix(this->ImageToWorldMatrix);
+  image->AllocateScalars(scalarType, 1);
+  if (image->IsEmpty())
+    {
+    return true;
+    }
+  vtkOrientedImageDataResample::FillImage(image, 0);
+
+  switch (scalarType)
+    {
+    vtkTemplateMacro(DecodeImageGeneric<VTK_TT>(this, image));
+  default:
+    break;
+    }
+  image->Modified();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+int vtkSparseLabelmap::GetValue(int i, int j, int k)
+{
+  vtkIdType numberOfRuns = 0;
+  const Run* runs = this->GetRowRuns(j, k, numberOfRuns);
+  if (!runs)
+    {
+    return 0;
+    }
+  const Run* runsEnd = runs + numberOfRuns;
+  const Run* run = std::lower_bound(runs, runsEnd, i,
+    [](const Run& run, int i) { return run.End < i; });
+  if (run == runsEnd || run->Start > i)
+    {
+    return 0;
+    }
+  return run->Value;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkSparseLabelmap::FindRow(int j, int k)
+{
+  std::vector<Row>::iterator rowIt = std::lower_bound(this->Rows.begin(), this->Rows.end(), RowKey(k, j),
+    [](const Row& row, const RowKey& key) { return RowKey(row.K, row.J) < key; });
+  if (rowIt == this->Rows.end() || rowIt->K != k || rowIt->J != j)
+    {
+    return -1;
+    }
+  return static_cast<vtkIdType>(rowIt - this->Rows.begin());
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkSparseLabelmap::GetNumberOfRowRuns(vtkIdType rowIndex)
+{
+  vtkIdType nextRun = (rowIndex + 1 < this->GetNumberOfRows() ? this->Rows[rowIndex + 1].FirstRun : this->GetNumberOfRuns());
+  return nextRun - this->Rows[rowIndex].FirstRun;
+}
+
+//----------------------------------------------------------------------------
+const vtkSparseLabelmap::Run* vtkSparseLabelmap::GetRowRuns(int j, int k, vtkIdType& numberOfRuns)
+{
+  numberOfRuns = 0;
+  vtkIdType rowIndex = this->FindRow(j, k);
+  if (rowIndex < 0)
+    {
+    return nullptr;
+    }
+  numberOfRuns = this->GetNumberOfRowRuns(rowIndex);
+  return &this->Runs[this->Rows[rowIndex].FirstRun];
+}
+
+//----------------------------------------------------------------------------
+void vtkSparseLabelmap::ReplaceRows(const std::map<RowKey, std::vector<Run> >& rows)
+{
+  if (rows.empty())
+    {
+    return;
+    }
+
+  // Merge the sorted list of existing and replaced rows
+  std::vector<Row> newRows;
+  std::vector<Run> newRuns;
+  newRows.reserve(this->Rows.size() + rows.size());
+  newRuns.reserve(this->Runs.size());
+  std::map<RowKey, std::vector<Run> >::const_iterator replacedRowIt = rows.begin();
+  vtkIdType numberOfRows = this->GetNumberOfRows();
+  for (vtkIdType rowIndex = 0; rowIndex <= numberOfRows; ++rowIndex)
+    {
+    bool hasExistingRow = (rowIndex < numberOfRows);
+    RowKey key = (hasExistingRow ? RowKey(this->Rows[rowIndex].K, this->Rows[rowIndex].J) : RowKey());
+    bool existingRowReplaced = false;
+    for (; replacedRowIt != rows.end() && (!hasExistingRow || replacedRowIt->first <= key); ++replacedRowIt)
+      {
+      if (!replacedRowIt->second.empty())
+        {
+        newRows.push_back({ replacedRowIt->first.first, replacedRowIt->first.second, static_cast<vtkIdType>(newRuns.size()) });
+        newRuns.insert(newRuns.end(), replacedRowIt->second.begin(), replacedRowIt->second.end());
+        }
+      if (hasExistingRow && replacedRowIt->first == key)
+        {
+        existingRowReplaced = true;
+        }
+      }
+    if (!hasExistingRow || existingRowReplaced)
+      {
+      continue;
+      }
+    const Run* runs = &this->Runs[this->Rows[rowIndex].FirstRun];
+    newRows.push_back({ key.first, key.second, static_cast<vtkIdType>(newRuns.size()) });
+    newRuns.insert(newRuns.end(), runs, runs + this->GetNumberOfRowRuns(rowIndex));
+    }
+
+  this->Rows.swap(newRows);
+  this->Runs.swap(newRuns);
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkSparseLabelmap::ClipToExtent()
+{
+  std::vector<Row> newRows;
+  std::vector<Run> newRuns;
+  vtkIdType numberOfRows = this->GetNumberOfRows();
+  for (vtkIdType rowIndex = 0; rowIndex < numberOfRows; ++rowIndex)
+    {
+    const Row& row = this->Rows[rowIndex];
+    if (row.J < this->Extent[2] || row.J > this->Extent[3] || row.K < this->Extent[4] || row.K > this->Extent[5])
+      {
+      continue;
+      }
+    vtkIdType firstRun = static_cast<vtkIdType>(newRuns.size());
+    vtkIdType numberOfRuns = this->GetNumberOfRowRuns(rowIndex);
+    for (vtkIdType runIndex = row.FirstRun; runIndex < row.FirstRun + numberOfRuns; ++runIndex)
+      {
+      Run run = this->Runs[runIndex];
+      run.Start = std::max(run.Start, this->Extent[0]);
+      run.End = std::min(run.End, this->Extent[1]);
+      if (run.Start <= run.End)
+        {
+        newRuns.push_back(run);
+        }
+      }
+    if (static_cast<vtkIdType>(newRuns.size()) > firstRun)
+      {
+      newRows.push_back({ row.K, row.J, firstRun });
+      }
+    }
+  this->Rows.swap(newRows);
+  this->Runs.swap(newRuns);
+}
+
+//----------------------------------------------------------------------------
+bool vtkSparseLabelmap::GetEffectiveExtent(int effectiveExtent[6], double threshold/*=0.0*/)
+{
+  effectiveExtent[0] = VTK_INT_MAX;
+  effectiveExtent[1] = VTK_INT_MIN;
+  effectiveExtent[2] = VTK_INT_MAX;
+  effectiveExtent[3] = VTK_INT_MIN;
+  effectiveExtent[4] = VTK_INT_MAX;
+  effectiveExtent[5] = VTK_INT_MIN;
+
+  vtkIdType numberOfRows = this->GetNumberOfRows();
+  for (vtkIdType rowIndex = 0; rowIndex < numberOfRows; ++rowIndex)
+    {
+    const Row& row = this->Rows[rowIndex];
+    vtkIdType numberOfRuns = this->GetNumberOfRowRuns(rowIndex);
+    bool rowAboveThreshold = false;
+    for (vtkIdType runIndex = row.FirstRun; runIndex < row.FirstRun + numberOfRuns; ++runIndex)
+      {
+      const Run& run = this->Runs[runIndex];
+      if (run.Value <= threshold)
+        {
+        continue;
+        }
+      rowAboveThreshold = true;
+      effectiveExtent[0] = std::min(effectiveExtent[0], run.Start);
+      effectiveExtent[1] = std::max(effectiveExtent[1], run.End);
+      }
+    if (rowAboveThreshold)
+      {
+      effectiveExtent[2] = std::min(effectiveExtent[2], row.J);
+      effectiveExtent[3] = std::max(effectiveExtent[3], row.J);
+      effectiveExtent[4] = std::min(effectiveExtent[4], row.K);
+      effectiveExtent[5] = std::max(effectiveExtent[5], row.K);
+      }
+    }
+
+  if (effectiveExtent[0] > effectiveExtent[1])
+    {
+    // no voxels above threshold
+    effectiveExtent[0] = 0;
+    effectiveExtent[1] = -1;
+    effectiveExtent[2] = 0;
+    effectiveExtent[3] = -1;
+    effectiveExtent[4] = 0;
+    effectiveExtent[5] = -1;
+    return false;
+    }
+  return true;
+}
@@ -0,0 +1,157 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkSparseLabelmap_h
+#define __vtkSparseLabelmap_h
+
+// Segmentation includes
+#include "vtkSegmentationCoreConfigure.h"
+
+// VTK includes
+#include <vtkDataObject.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+
+// STD includes
+#include <map>
+#include <utility>
+#include <vector>
+
+class vtkOrientedImageData;
+
+/// \ingroup SegmentationCore
+/// \brief Run-length encoded labelmap with orientation information
+///
+/// Stores a labelmap on the same oriented grid as vtkOrientedImageData, but only the non-zero voxels are kept:
+/// each row of voxels (along the I axis) that contains a non-zero voxel is stored as a sorted list of runs
+/// of voxels that have the same value. Rows that contain only zero voxels take no memory, therefore the memory
+/// usage is proportional to the number of rows and runs that intersect the segments, not to the size of the grid.
+///
+/// Voxels outside the extent are considered to be zero.
+class vtkSegmentationCore_EXPORT vtkSparseLabelmap : public vtkDataObject
+{
+public:
+  /// Voxels from Start to End (inclusive) of a row have the same Value
+  struct Run
+    {
+    int Start;
+    int End;
+    int Value;
+    };
+
+  /// Row of voxels, runs of the row are stored from FirstRun to the FirstRun of the next row
+  struct Row
+    {
+    int K;
+    int J;
+    vtkIdType FirstRun;
+    };
+
+  /// Identifies a row of voxels by its (K, J) index, rows are ordered by K first
+  typedef std::pair<int, int> RowKey;
+
+public:
+  static vtkSparseLabelmap* New();
+  vtkTypeMacro(vtkSparseLabelmap, vtkDataObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  /// Remove all runs and reset the geometry
+  void Initialize() override;
+  /// Shallow copy. Runs are not reference counted, therefore they are copied.
+  void ShallowCopy(vtkDataObject* src) override;
+  /// Deep copy
+  void DeepCopy(vtkDataObject* src) override;
+
+  /// Return the memory used by the labelmap in kibibytes
+  unsigned long GetActualMemorySize() override;
+
+  /// IJK extent of the grid. Voxels outside the extent are zero.
+  /// Runs outside of the new extent are removed.
+  void SetExtent(const int extent[6]);
+  void SetExtent(int x1, int x2, int y1, int y2, int z1, int z2);
+  vtkGetVector6Macro(Extent, int);
+
+  /// Get the geometry matrix that includes the spacing, directions and origin information
+  void GetImageToWorldMatrix(vtkMatrix4x4* mat);
+  /// Set the directions, spacing, and origin from a matrix
+  void SetImageToWorldMatrix(vtkMatrix4x4* mat);
+
+  /// Copy geometry (image to world matrix and extent) of an image. Runs outside of the extent are removed.
+  void CopyGeometry(vtkOrientedImageData* image);
+
+  /// Replace contents by the non-zero voxels of an image.
+  /// Geometry is copied from the image.
+  /// \param labelValue If non-zero then only voxels that have this value are stored.
+  /// \return Success flag
+  bool EncodeImage(vtkOrientedImageData* image, int labelValue = 0);
+
+  /// Fill an image with the contents of the labelmap.
+  /// Scalar type of the image is the smallest integer type that can store all values.
+  /// \param extent Extent of the output image. If not specified then the extent of the labelmap is used.
+  /// \return Success flag
+  bool DecodeImage(vtkOrientedImageData* image, const int extent[6] = nullptr);
+
+  /// Value of a voxel
+  int GetValue(int i, int j, int k);
+
+  /// Get runs of a row. Returns nullptr if the row has no non-zero voxels.
+  const Run* GetRowRuns(int j, int k, vtkIdType& numberOfRuns);
+
+  /// Replace the runs of the specified rows. Runs must be sorted and must not overlap.
+  /// Rows that have an empty list of runs are removed.
+  void ReplaceRows(const std::map<RowKey, std::vector<Run> >& rows);
+
+  /// Get the IJK extent of the voxels that have larger value than the threshold.
+  /// \return False if there are no such voxels.
+  bool GetEffectiveExtent(int effectiveExtent[6], double threshold = 0.0);
+
+  /// Number of rows that contain non-zero voxels
+  vtkIdType GetNumberOfRows() { return static_cast<vtkIdType>(this->Rows.size()); };
+  /// Total number of runs in all rows
+  vtkIdType GetNumberOfRuns() { return static_cast<vtkIdType>(this->Runs.size()); };
+
+  /// Determines whether the labelmap is empty (contains no non-zero voxels)
+  bool IsEmpty() { return this->Runs.empty(); };
+
+protected:
+  /// Index of the row, -1 if the row has no runs
+  vtkIdType FindRow(int j, int k);
+
+  /// Number of runs in a row
+  vtkIdType GetNumberOfRowRuns(vtkIdType rowIndex);
+
+  /// Remove runs that are outside the extent
+  void ClipToExtent();
+
+protected:
+  int Extent[6];
+  vtkNew<vtkMatrix4x4> ImageToWorldMatrix;
+
+  /// Rows that contain non-zero voxels, sorted by (K, J)
+  std::vector<Row> Rows;
+  /// Runs of all rows
+  std::vector<Run> Runs;
+
+protected:
+  vtkSparseLabelmap();
+  ~vtkSparseLabelmap() override;
+
+private:
+  vtkSparseLabelmap(const vtkSparseLabelmap&) = delete;
+  void operator=(const vtkSparseLabelmap&) = delete;
+};
+
+#endif
@@ -0,0 +1,121 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// SegmentationCore includes
+#include "vtkSparseLabelmapToBinaryLabelmapConversionRule.h"
+#include "vtkOrientedImageData.h"
+#include "vtkSegmentation.h"
+#include "vtkSparseLabelmap.h"
+
+// VTK includes
+#include <vtkObjectFactory.h>
+
+//----------------------------------------------------------------------------
+vtkSegmentationConverterRuleNewMacro(vtkSparseLabelmapToBinaryLabelmapConversionRule);
+
+//----------------------------------------------------------------------------
+vtkSparseLabelmapToBinaryLabelmapConversionRule::vtkSparseLabelmapToBinaryLabelmapConversionRule()
+{
+  this->ReplaceTargetRepresentation = true;
+
+  // Collapse labelmaps parameter
+  this->ConversionParameters->SetParameter(GetCollapseLabelmapsParameterName(), "1",
+    "Merge the labelmaps into as few shared labelmaps as possible"
+    " 1 = created labelmaps will be shared if possible without overwriting each other.");
+}
+
+//----------------------------------------------------------------------------
+vtkSparseLabelmapToBinaryLabelmapConversionRule::~vtkSparseLabelmapToBinaryLabelmapConversionRule() = default;
+
+//----------------------------------------------------------------------------
+unsigned int vtkSparseLabelmapToBinaryLabelmapConversionRule::GetConversionCost(
+  vtkDataObject* vtkNotUsed(sourceRepresentation)/*=nullptr*/,
+  vtkDataObject* vtkNotUsed(targetRepresentation)/*=nullptr*/)
+{
+  // Rough input-independent guess (ms)
+  return 100;
+}
+
+//----------------------------------------------------------------------------
+vtkDataObject* vtkSparseLabelmapToBinaryLabelmapConversionRule::ConstructRepresentationObjectByRepresentation(std::string representationName)
+{
+  if ( !representationName.compare(this->GetSourceRepresentationName()) )
+    {
+    return (vtkDataObject*)vtkSparseLabelmap::New();
+    }
+  else if ( !representationName.compare(this->GetTargetRepresentationName()) )
+    {
+    return (vtkDataObject*)vtkOrientedImageData::New();
+    }
+  else
+    {
+    return nullptr;
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkDataObject* vtkSparseLabelmapToBinaryLabelmapConversionRule::ConstructRepresentationObjectByClass(std::string className)
+{
+  if (!className.compare("vtkSparseLabelmap"))
+    {
+    return (vtkDataObject*)vtkSparseLabelmap::New();
+    }
+  else if (!className.compare("vtkOrientedImageData"))
+    {
+    return (vtkDataObject*)vtkOrientedImageData::New();
+    }
+  else
+    {
+    return nullptr;
+    }
+}
+
+//----------------------------------------------------------------------------
+bool vtkSparseLabelmapToBinaryLabelmapConversionRule::Convert(vtkSegment* segment)
+{
+  this->CreateTargetRepresentation(segment);
+
+  vtkSparseLabelmap* sparseLabelmap = vtkSparseLabelmap::SafeDownCast(
+    segment->GetRepresentation(this->GetSourceRepresentationName()));
+  if (!sparseLabelmap)
+    {
+    vtkErrorMacro("Convert: Source representation is not a sparse labelmap");
+    return false;
+    }
+  vtkOrientedImageData* binaryLabelmap = vtkOrientedImageData::SafeDownCast(
+    segment->GetRepresentation(this->GetTargetRepresentationName()));
+  if (!binaryLabelmap)
+    {
+    vtkErrorMacro("Convert: Target representation is not oriented image data");
+    return false;
+    }
+
+  // Only allocate voxels for the region that the segment occupies
+  int effectiveExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  sparseLabelmap->GetEffectiveExtent(effectiveExtent);
+  return sparseLabelmap->DecodeImage(binaryLabelmap, effectiveExtent);
+}
+
+//----------------------------------------------------------------------------
+bool vtkSparseLabelmapToBinaryLabelmapConversionRule::PostConvert(vtkSegmentation* segmentation)
+{
+  int collapseLabelmaps = this->ConversionParameters->GetValueAsInt(GetCollapseLabelmapsParameterName());
+  if (collapseLabelmaps > 0)
+    {
+    segmentation->CollapseBinaryLabelmaps(false);
+    }
+  return true;
+}
@@ -0,0 +1,84 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkSparseLabelmapToBinaryLabelmapConversionRule_h
+#define __vtkSparseLabelmapToBinaryLabelmapConversionRule_h
+
+// SegmentationCore includes
+#include "vtkSegmentationConverterRule.h"
+#include "vtkSegmentationConverter.h"
+
+#include "vtkSegmentationCoreConfigure.h"
+
+/// \ingroup SegmentationCore
+/// \brief Convert sparse labelmap representation (vtkSparseLabelmap type) to
+///   binary labelmap representation (vtkOrientedImageData type). The labelmap is
+///   decoded into the effective extent of the segment.
+class vtkSegmentationCore_EXPORT vtkSparseLabelmapToBinaryLabelmapConversionRule
+  : public vtkSegmentationConverterRule
+{
+public:
+  /// Determines if the output binary labelmaps should be reduced to as few shared labelmaps as possible after conversion.
+  /// A value of 1 means that the labelmaps will be collapsed, while a value of 0 means that they will not be collapsed.
+  static const std::string GetCollapseLabelmapsParameterName() { return "Collapse labelmaps"; };
+
+public:
+  static vtkSparseLabelmapToBinaryLabelmapConversionRule* New();
+  vtkTypeMacro(vtkSparseLabelmapToBinaryLabelmapConversionRule, vtkSegmentationConverterRule);
+  vtkSegmentationConverterRule* CreateRuleInstance() override;
+
+  /// Constructs representation object from representation name for the supported representation classes
+  /// (typically source and target representation VTK classes, subclasses of vtkDataObject)
+  /// Note: Need to take ownership of the created object! For example using vtkSmartPointer<vtkDataObject>::Take
+  vtkDataObject* ConstructRepresentationObjectByRepresentation(std::string representationName) override;
+
+  /// Constructs representation object from class name for the supported representation classes
+  /// (typically source and target representation VTK classes, subclasses of vtkDataObject)
+  /// Note: Need to take ownership of the created object! For example using vtkSmartPointer<vtkDataObject>::Take
+  vtkDataObject* ConstructRepresentationObjectByClass(std::string className) override;
+
+  /// Update the target representation based on the source representation
+  bool Convert(vtkSegment* segment) override;
+
+  /// Perform postprocessing steps on the output
+  /// Collapses the segments to as few labelmaps as is possible
+  bool PostConvert(vtkSegmentation* segmentation) override;
+
+  /// Each segment gets a new target labelmap, so segments can be converted concurrently
+  bool IsThreadSafe() override { return true; };
+
+  /// Get the cost of the conversion.
+  unsigned int GetConversionCost(vtkDataObject* sourceRepresentation=nullptr, vtkDataObject* targetRepresentation=nullptr) override;
+
+  /// Human-readable name of the converter rule
+  const char* GetName() override { return "Sparse labelmap to binary labelmap"; };
+
+  /// Human-readable name of the source representation
+  const char* GetSourceRepresentationName() override { return vtkSegmentationConverter::GetSegmentationSparseLabelmapRepresentationName(); };
+
+  /// Human-readable name of the target representation
+  const char* GetTargetRepresentationName() override { return vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName(); };
+
+protected:
+  vtkSparseLabelmapToBinaryLabelmapConversionRule();
+  ~vtkSparseLabelmapToBinaryLabelmapConversionRule() override;
+
+private:
+  vtkSparseLabelmapToBinaryLabelmapConversionRule(const vtkSparseLabelmapToBinaryLabelmapConversionRule&) = delete;
+  void operator=(const vtkSparseLabelmapToBinaryLabelmapConversionRule&) = delete;
+};
+
+#endif // __vtkSparseLabelmapToBinaryLabelmapConversionRule_h
@@ -0,0 +1,159 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// SegmentationCore includes
+#include "vtkSparseLabelmapToClosedSurfaceConversionRule.h"
+#include "vtkOrientedImageData.h"
+#include "vtkSegment.h"
+#include "vtkSparseLabelmap.h"
+
+// VTK includes
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+
+//----------------------------------------------------------------------------
+vtkSegmentationConverterRuleNewMacro(vtkSparseLabelmapToClosedSurfaceConversionRule);
+
+//----------------------------------------------------------------------------
+vtkSparseLabelmapToClosedSurfaceConversionRule::vtkSparseLabelmapToClosedSurfaceConversionRule()
+{
+  // Same parameters as the binary labelmap conversion. Joint smoothing and surface nets process all
+  // segments of a shared labelmap together, which does not apply to separately stored sparse labelmaps.
+  this->BinaryLabelmapToClosedSurfaceRule->GetRuleConversionParameters(this->ConversionParameters);
+  const std::string sharedLabelmapParameterNames[2] =
+    {
+    vtkBinaryLabelmapToClosedSurfaceConversionRule::GetJointSmoothingParameterName(),
+    vtkBinaryLabelmapToClosedSurfaceConversionRule::GetSurfaceNetsParameterName()
+    };
+  for (const std::string& parameterName : sharedLabelmapParameterNames)
+    {
+    int parameterIndex = this->ConversionParameters->GetIndexFromName(parameterName);
+    if (parameterIndex >= 0)
+      {
+      this->ConversionParameters->RemoveParameter(parameterIndex);
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkSparseLabelmapToClosedSurfaceConversionRule::~vtkSparseLabelmapToClosedSurfaceConversionRule() = default;
+
+//----------------------------------------------------------------------------
+unsigned int vtkSparseLabelmapToClosedSurfaceConversionRule::GetConversionCost(
+  vtkDataObject* vtkNotUsed(sourceRepresentation)/*=nullptr*/,
+  vtkDataObject* vtkNotUsed(targetRepresentation)/*=nullptr*/)
+{
+  // Rough input-independent guess (ms). Less than converting through binary labelmap,
+  // so that the full labelmap is not created just for getting the surface.
+  return 520;
+}
+
+//----------------------------------------------------------------------------
+vtkDataObject* vtkSparseLabelmapToClosedSurfaceConversionRule::ConstructRepresentationObjectByRepresentation(std::string representationName)
+{
+  if ( !representationName.compare(this->GetSourceRepresentationName()) )
+    {
+    return (vtkDataObject*)vtkSparseLabelmap::New();
+    }
+  else if ( !representationName.compare(this->GetTargetRepresentationName()) )
+    {
+    return (vtkDataObject*)vtkPolyData::New();
+    }
+  else
+    {
+    return nullptr;
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkDataObject* vtkSparseLabelmapToClosedSurfaceConversionRule::ConstructRepresentationObjectByClass(std::string className)
+{
+  if (!className.compare("vtkSparseLabelmap"))
+    {
+    return (vtkDataObject*)vtkSparseLabelmap::New();
+    }
+  else if (!className.compare("vtkPolyData"))
+    {
+    return (vtkDataObject*)vtkPolyData::New();
+    }
+  else
+    {
+    return nullptr;
+    }
+}
+
+//----------------------------------------------------------------------------
+bool vtkSparseLabelmapToClosedSurfaceConversionRule::PreConvert(vtkSegmentation* vtkNotUsed(segmentation))
+{
+  int numberOfParameters = this->ConversionParameters->GetNumberOfParameters();
+  for (int parameterIndex = 0; parameterIndex < numberOfParameters; ++parameterIndex)
+    {
+    this->BinaryLabelmapToClosedSurfaceRule->SetConversionParameter(
+      this->ConversionParameters->GetName(parameterIndex), this->ConversionParameters->GetValue(parameterIndex));
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSparseLabelmapToClosedSurfaceConversionRule::Convert(vtkSegment* segment)
+{
+  this->CreateTargetRepresentation(segment);
+
+  vtkSparseLabelmap* sparseLabelmap = vtkSparseLabelmap::SafeDownCast(
+    segment->GetRepresentation(this->GetSourceRepresentationName()));
+  if (!sparseLabelmap)
+    {
+    vtkErrorMacro("Convert: Source representation is not a sparse labelmap");
+    return false;
+    }
+  vtkPolyData* closedSurfacePolyData = vtkPolyData::SafeDownCast(
+    segment->GetRepresentation(this->GetTargetRepresentationName()));
+  if (!closedSurfacePolyData)
+    {
+    vtkErrorMacro("Convert: Target representation is not poly data");
+    return false;
+    }
+
+  int effectiveExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  if (!sparseLabelmap->GetEffectiveExtent(effectiveExtent))
+    {
+    closedSurfacePolyData->Initialize();
+    return true;
+    }
+
+  vtkNew<vtkOrientedImageData> binaryLabelmap;
+  if (!sparseLabelmap->DecodeImage(binaryLabelmap, effectiveExtent))
+    {
+    vtkErrorMacro("Convert: Failed to decode sparse labelmap");
+    return false;
+    }
+  std::vector<int> labelValue = { segment->GetLabelValue() };
+  if (!this->BinaryLabelmapToClosedSurfaceRule->CreateClosedSurface(binaryLabelmap, closedSurfacePolyData, labelValue))
+    {
+    return false;
+    }
+
+  // Remove "ImageScalars" array because having a scalar in a model would get that
+  // scalar array displayed automatically (instead of model node color) when the mesh is loaded.
+  vtkPointData* pointData = closedSurfacePolyData->GetPointData();
+  if (pointData!=nullptr)
+    {
+    pointData->RemoveArray("ImageScalars");
+    }
+
+  return true;
+}
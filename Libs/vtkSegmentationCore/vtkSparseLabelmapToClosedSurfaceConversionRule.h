@@ -0,0 +1,84 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkSparseLabelmapToClosedSurfaceConversionRule_h
+#define __vtkSparseLabelmapToClosedSurfaceConversionRule_h
+
+// SegmentationCore includes
+#include "vtkBinaryLabelmapToClosedSurfaceConversionRule.h"
+#include "vtkSegmentationConverterRule.h"
+#include "vtkSegmentationConverter.h"
+
+#include "vtkSegmentationCoreConfigure.h"
+
+/// \ingroup SegmentationCore
+/// \brief Convert sparse labelmap representation (vtkSparseLabelmap type) to
+///   closed surface representation (vtkPolyData type). Only the effective extent of the
+///   segment is decoded into a temporary image, which is then converted using the
+///   binary labelmap to closed surface algorithm with the same conversion parameters.
+class vtkSegmentationCore_EXPORT vtkSparseLabelmapToClosedSurfaceConversionRule
+  : public vtkSegmentationConverterRule
+{
+public:
+  static vtkSparseLabelmapToClosedSurfaceConversionRule* New();
+  vtkTypeMacro(vtkSparseLabelmapToClosedSurfaceConversionRule, vtkSegmentationConverterRule);
+  vtkSegmentationConverterRule* CreateRuleInstance() override;
+
+  /// Constructs representation object from representation name for the supported representation classes
+  /// (typically source and target representation VTK classes, subclasses of vtkDataObject)
+  /// Note: Need to take ownership of the created object! For example using vtkSmartPointer<vtkDataObject>::Take
+  vtkDataObject* ConstructRepresentationObjectByRepresentation(std::string representationName) override;
+
+  /// Constructs representation object from class name for the supported representation classes
+  /// (typically source and target representation VTK classes, subclasses of vtkDataObject)
+  /// Note: Need to take ownership of the created object! For example using vtkSmartPointer<vtkDataObject>::Take
+  vtkDataObject* ConstructRepresentationObjectByClass(std::string className) override;
+
+  /// Pass the conversion parameters to the binary labelmap conversion rule
+  bool PreConvert(vtkSegmentation* segmentation) override;
+
+  /// Update the target representation based on the source representation
+  bool Convert(vtkSegment* segment) override;
+
+  /// Conversion parameters are only changed in PreConvert, so segments can be converted concurrently
+  bool IsThreadSafe() override { return true; };
+
+  /// Get the cost of the conversion.
+  unsigned int GetConversionCost(vtkDataObject* sourceRepresentation=nullptr, vtkDataObject* targetRepresentation=nullptr) override;
+
+  /// Human-readable name of the converter rule
+  const char* GetName() override { return "Sparse labelmap to closed surface"; };
+
+  /// Human-readable name of the source representation
+  const char* GetSourceRepresentationName() override { return vtkSegmentationConverter::GetSegmentationSparseLabelmapRepresentationName(); };
+
+  /// Human-readable name of the target representation
+  const char* GetTargetRepresentationName() override { return vtkSegmentationConverter::GetSegmentationClosedSurfaceRepresentationName(); };
+
+protected:
+  /// Rule that creates the surface from the decoded labelmap
+  vtkNew<vtkBinaryLabelmapToClosedSurfaceConversionRule> BinaryLabelmapToClosedSurfaceRule;
+
+protected:
+  vtkSparseLabelmapToClosedSurfaceConversionRule();
+  ~vtkSparseLabelmapToClosedSurfaceConversionRule() override;
+
+private:
+  vtkSparseLabelmapToClosedSurfaceConversionRule(const vtkSparseLabelmapToClosedSurfaceConversionRule&) = delete;
+  void operator=(const vtkSparseLabelmapToClosedSurfaceConversionRule&) = delete;
+};
+
+#endif // __vtkSparseLabelmapToClosedSurfaceConversionRule_h
@@ -26,6 +26,22 @@
 #include <vtkNew.h>
 #include <vtkPolyDataCollection.h>
 #include <vtkIntArray.h>
+#include <vtkSMPTools.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+//----------------------------------------------------------------------------
+// Bounding box of a poly data is valid if it is not empty (empty poly data has uninitialized bounds)
+bool IsBoundingBoxValid(const double bounds[6])
+{
+  return bounds[0] <= bounds[1] && bounds[2] <= bounds[3] && bounds[4] <= bounds[5];
+}
+}
 
 //----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkTopologicalHierarchy);
@@ -80,6 +96,12 @@ bool vtkTopologicalHierarchy::Contains(vtkPolyData* polyOut, vtkPolyData* polyIn
   double extentIn[6] = {0.0,0.0,0.0,0.0,0.0,0.0};
   polyIn->GetBounds(extentIn);
 
+  return this->ContainsBounds(extentOut, extentIn);
+}
+
+//----------------------------------------------------------------------------
+bool vtkTopologicalHierarchy::ContainsBounds(const double extentOut[6], const double extentIn[6])
+{
   if ( extentOut[0] < extentIn[0] - this->ContainConstraintFactor * (extentOut[1]-extentOut[0])
     && extentOut[1] > extentIn[1] + this->ContainConstraintFactor * (extentOut[1]-extentOut[0])
     && extentOut[2] < extentIn[2] - this->ContainConstraintFactor * (extentOut[3]-extentOut[2])
@@ -106,14 +128,18 @@ void vtkTopologicalHierarchy::Update()
   unsigned int numberOfPolyData = this->InputPolyDataCollection->GetNumberOfItems();
 
   // Check input polydata collection
+  std::vector<vtkPolyData*> polyDataList(numberOfPolyData, nullptr);
+  vtkCollectionSimpleIterator it;
+  this->InputPolyDataCollection->InitTraversal(it);
   for (unsigned int polyOutIndex=0; polyOutIndex<numberOfPolyData; ++polyOutIndex)
     {
-    vtkPolyData* polyOut = vtkPolyData::SafeDownCast(this->InputPolyDataCollection->GetItemAsObject(polyOutIndex));
+    vtkPolyData* polyOut = vtkPolyData::SafeDownCast(this->InputPolyDataCollection->GetNextItemAsObject(it));
     if (!polyOut)
       {
       vtkErrorMacro("Update: Input collection contains invalid object at item " << polyOutIndex);
       return;
       }
+    polyDataList[polyOutIndex] = polyOut;
     }
 
   std::vector<std::vector<unsigned int> > containedPolyData(numberOfPolyData);
@@ -121,27 +147,91 @@ void vtkTopologicalHierarchy::Update()
   this->OutputLevels->SetNumberOfTuples(numberOfPolyData);
   this->OutputLevels->FillComponent(0, -1);
 
-  // Step 1: Set level of polydata containing no other polydata to 0
-  this->InputPolyDataCollection->InitTraversal();
-  for (unsigned int polyOutIndex=0; polyOutIndex<numberOfPolyData; ++polyOutIndex)
+  // Get the bounds of each poly data once. Bounds are computed on demand and cached in the
+  // poly data, so they are all computed here before they are accessed from multiple threads.
+  std::vector<double> bounds(6 * static_cast<size_t>(numberOfPolyData), 0.0);
+  std::vector<unsigned int> sortedIndices;
+  std::vector<unsigned int> invalidBoundsIndices;
+  for (unsigned int polyIndex=0; polyIndex<numberOfPolyData; ++polyIndex)
     {
-    vtkPolyData* polyOut = vtkPolyData::SafeDownCast(this->InputPolyDataCollection->GetItemAsObject(polyOutIndex));
+    polyDataList[polyIndex]->GetBounds(&bounds[6 * polyIndex]);
+    if (IsBoundingBoxValid(&bounds[6 * polyIndex]))
+      {
+      sortedIndices.push_back(polyIndex);
+      }
+    else
+      {
+      invalidBoundsIndices.push_back(polyIndex);
+      }
+    }
+
+  // Sort poly data by the lower x bound, so that for each outer poly data only those inner ones need to be
+  // checked whose lower x bound falls within the x range of the outer poly data (sweep and prune)
+  std::sort(sortedIndices.begin(), sortedIndices.end(), [&bounds](unsigned int a, unsigned int b)
+    {
+    return bounds[6 * a] < bounds[6 * b];
+    });
+  std::vector<double> sortedLowerX(sortedIndices.size());
+  for (size_t i = 0; i < sortedIndices.size(); ++i)
+    {
+    sortedLowerX[i] = bounds[6 * sortedIndices[i]];
+    }
 
-    for (unsigned int polyInIndex=0; polyInIndex<numberOfPolyData; ++polyInIndex)
+  // Step 1: Find the poly data contained by each poly data.
+  // The range of candidates is widened by a small tolerance to account for rounding,
+  // and all candidates are checked with the exact same condition as in Contains.
+  auto findContainedPolyData = [&](vtkIdType beginOut, vtkIdType endOut)
+    {
+    for (vtkIdType outIndex = beginOut; outIndex < endOut; ++outIndex)
       {
-      if (polyOutIndex==polyInIndex)
+      unsigned int polyOutIndex = static_cast<unsigned int>(outIndex);
+      const double* extentOut = &bounds[6 * polyOutIndex];
+      std::vector<unsigned int>& contained = containedPolyData[polyOutIndex];
+
+      if (IsBoundingBoxValid(extentOut))
         {
-        continue;
+        // extentOut[0] < extentIn[0] - gap and extentOut[1] > extentIn[1] + gap, where extentIn[0] <= extentIn[1]
+        double gap = this->ContainConstraintFactor * (extentOut[1] - extentOut[0]);
+        double tolerance = 1e-9 * (std::abs(extentOut[0]) + std::abs(extentOut[1]) + std::abs(gap) + 1.0);
+        std::vector<double>::const_iterator first = std::lower_bound(
+          sortedLowerX.begin(), sortedLowerX.end(), extentOut[0] + gap - tolerance);
+        std::vector<double>::const_iterator last = std::upper_bound(
+          sortedLowerX.begin(), sortedLowerX.end(), extentOut[1] - gap + tolerance);
+        for (std::vector<double>::const_iterator candidate = first; candidate < last; ++candidate)
+          {
+          unsigned int polyInIndex = sortedIndices[candidate - sortedLowerX.begin()];
+          if (polyInIndex != polyOutIndex && this->ContainsBounds(extentOut, &bounds[6 * polyInIndex]))
+            {
+            contained.push_back(polyInIndex);
+            }
+          }
+        for (unsigned int polyInIndex : invalidBoundsIndices)
+          {
+          if (this->ContainsBounds(extentOut, &bounds[6 * polyInIndex]))
+            {
+            contained.push_back(polyInIndex);
+            }
+          }
         }
-
-      vtkPolyData* polyIn = vtkPolyData::SafeDownCast(this->InputPolyDataCollection->GetItemAsObject(polyInIndex));
-
-      if (this->Contains(polyOut, polyIn))
+      else
         {
-        containedPolyData[polyOutIndex].push_back(polyInIndex);
+        // Pruning is not possible, check all
+        for (unsigned int polyInIndex=0; polyInIndex<numberOfPolyData; ++polyInIndex)
+          {
+          if (polyInIndex != polyOutIndex && this->ContainsBounds(extentOut, &bounds[6 * polyInIndex]))
+            {
+            contained.push_back(polyInIndex);
+            }
+          }
         }
+      std::sort(contained.begin(), contained.end());
       }
+    };
+  vtkSMPTools::For(0, static_cast<vtkIdType>(numberOfPolyData), findContainedPolyData);
 
+  // Set level of polydata containing no other polydata to 0
+  for (unsigned int polyOutIndex=0; polyOutIndex<numberOfPolyData; ++polyOutIndex)
+    {
     if (containedPolyData[polyOutIndex].size() == 0)
       {
       this->OutputLevels->SetValue(polyOutIndex, 0);
@@ -169,30 +259,8 @@ void vtkTopologicalHierarchy::Update()
       //   The level that is to be set cannot be lower than the current level value, because then we would
       //   already have assigned it in the previous iterations.
       bool allContainedPolydataHasLevelValueAssigned = true;
-      for (unsigned int polyInIndex = 0;
-           polyInIndex < numberOfPolyData;
-           ++polyInIndex)
+      for (unsigned int polyInIndex : containedPolyData[polyOutIndex])
         {
-        if (polyOutIndex==polyInIndex)
-          {
-          continue;
-          }
-        bool isContained = false;
-        for (std::vector<unsigned int>::iterator it = containedPolyData[polyOutIndex].begin();
-             it != containedPolyData[polyOutIndex].end();
-             ++it)
-          {
-          if ((*it) == polyInIndex)
-            {
-            isContained = true;
-            break;
-            }
-          }
-        if (!isContained)
-          {
-          continue;
-          }
-
         if (outputLevelsSnapshot->GetValue(polyInIndex) == -1)
           {
           allContainedPolydataHasLevelValueAssigned = false;
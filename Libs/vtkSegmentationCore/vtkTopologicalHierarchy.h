@@ -52,7 +52,8 @@ public:
   virtual vtkIntArray* GetOutputLevels();
 
   /// Compute topological hierarchy levels for input poly data models using
-  /// their bounding boxes.
+  /// their bounding boxes. Bounding boxes are sorted along the x axis so that only
+  /// overlapping candidates are tested for containment, and the tests run in parallel.
   /// This function has to be explicitly called!
   /// Output can be get using GetOutputLevels()
   virtual void Update();
@@ -74,6 +75,9 @@ protected:
   /// /sa ContainConstraintFactor
   bool Contains(vtkPolyData* polyOut, vtkPolyData* polyIn);
 
+  /// Determines if bounding box extentOut contains bounding box extentIn considering the constraint factor
+  bool ContainsBounds(const double extentOut[6], const double extentIn[6]);
+
   /// Determines if there are empty entries in the output level array
   bool OutputContainsEmptyLevels();
 
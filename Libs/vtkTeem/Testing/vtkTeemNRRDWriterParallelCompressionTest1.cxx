@@ -0,0 +1,152 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// vtkTeem includes
+#include <vtkTeemNRRDReader.h>
+#include <vtkTeemNRRDWriter.h>
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkNew.h>
+
+// STD includes
+#include <cstring>
+#include <string>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+bool HasSameScalars(vtkImageData* image1, vtkImageData* image2)
+{
+  size_t dataSize = static_cast<size_t>(image1->GetNumberOfPoints())
+    * image1->GetNumberOfScalarComponents() * image1->GetScalarSize();
+  return image1->GetNumberOfPoints() == image2->GetNumberOfPoints()
+    && image1->GetScalarType() == image2->GetScalarType()
+    && image1->GetNumberOfScalarComponents() == image2->GetNumberOfScalarComponents()
+    && memcmp(image1->GetScalarPointer(), image2->GetScalarPointer(), dataSize) == 0;
+}
+
+//----------------------------------------------------------------------------
+int TestWriteRead(vtkImageData* image, const std::string& fileName, bool runLengthCompression)
+{
+  vtkNew<vtkTeemNRRDWriter> writer;
+  writer->SetInputData(image);
+  writer->SetFileName(fileName.c_str());
+  writer->SetUseCompression(true);
+  writer->SetParallelCompression(true);
+  // Make sure the data is split into several chunks
+  writer->SetCompressionChunkSize(65536);
+  writer->SetRunLengthCompression(runLengthCompression);
+  writer->Write();
+  if (writer->GetWriteError())
+    {
+    std::cerr << "Line " << __LINE__ << ": Failed to write " << fileName << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Parallel decompression
+  vtkNew<vtkImageData> chunksImage;
+  chunksImage->SetExtent(image->GetExtent());
+  chunksImage->AllocateScalars(image->GetScalarType(), image->GetNumberOfScalarComponents());
+  if (!vtkTeemNRRDReader::ReadCompressedChunks(fileName.c_str(), chunksImage))
+    {
+    std::cerr << "Line " << __LINE__ << ": Failed to read compressed chunks from " << fileName << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (!HasSameScalars(image, chunksImage))
+    {
+    std::cerr << "Line " << __LINE__ << ": Voxels read from compressed chunks do not match the written voxels" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The file must be readable as a regular gzip-compressed NRRD file
+  vtkNew<vtkTeemNRRDReader> reader;
+  reader->SetFileName(fileName.c_str());
+  reader->Update();
+  if (reader->GetReadStatus() != 0 || !HasSameScalars(image, reader->GetOutput()))
+    {
+    std::cerr << "Line " << __LINE__ << ": Voxels read by teem do not match the written voxels" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const char* strategy = reader->GetHeaderValue(vtkTeemNRRDWriter::GetCompressionStrategyKey());
+  if (runLengthCompression != (strategy != nullptr && std::string(strategy) == "rle"))
+    {
+    std::cerr << "Line " << __LINE__ << ": Compression strategy is not recorded correctly in " << fileName << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Corrupted chunk table must be detected
+  vtkNew<vtkImageData> smallerImage;
+  smallerImage->SetDimensions(10, 10, 10);
+  smallerImage->AllocateScalars(image->GetScalarType(), image->GetNumberOfScalarComponents());
+  if (vtkTeemNRRDReader::ReadCompressedChunks(fileName.c_str(), smallerImage))
+    {
+    std::cerr << "Line " << __LINE__ << ": Reading compressed chunks into an image of different size succeeded" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkTeemNRRDWriterParallelCompressionTest1(int argc, char* argv[])
+{
+  if (argc < 2)
+    {
+    std::cerr << "Usage: " << argv[0] << " /path/to/temp" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const std::string tempDir = argv[1];
+
+  // Labelmap-like image: a few boxes in an empty background
+  vtkNew<vtkImageData> image;
+  image->SetDimensions(120, 100, 30);
+  image->AllocateScalars(VTK_SHORT, 1);
+  short* voxels = static_cast<short*>(image->GetScalarPointer());
+  for (int z = 0; z < 30; ++z)
+    {
+    for (int y = 0; y < 100; ++y)
+      {
+      for (int x = 0; x < 120; ++x)
+        {
+        short value = 0;
+        if (x > 10 && x < 50 && y > 20 && y < 60)
+          {
+          value = 1;
+          }
+        else if (z > 5 && z < 20 && x > 70)
+          {
+          value = static_cast<short>(2 + (x + y) % 3);
+          }
+        *voxels++ = value;
+        }
+      }
+    }
+
+  if (TestWriteRead(image, tempDir + "/vtkTeemNRRDWriterParallelCompressionTest1.nrrd", false) != EXIT_SUCCESS)
+    {
+    return EXIT_FAILURE;
+    }
+  if (TestWriteRead(image, tempDir + "/vtkTeemNRRDWriterParallelCompressionTest1_rle.nrrd", true) != EXIT_SUCCESS)
+    {
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
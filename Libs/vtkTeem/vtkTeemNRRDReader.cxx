@@ -30,6 +30,7 @@
 
 // VTK includes
 #include "vtkBitArray.h"
+#include "vtkByteSwap.h"
 #include "vtkCharArray.h"
 #include "vtkDoubleArray.h"
 #include "vtkFloatArray.h"
@@ -42,16 +43,28 @@
 #include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkShortArray.h"
+#include <vtkSMPTools.h>
 #include <vtkStreamingDemandDrivenPipeline.h>
 #include "vtkUnsignedCharArray.h"
 #include "vtkUnsignedShortArray.h"
 #include "vtkUnsignedIntArray.h"
 #include "vtkUnsignedLongArray.h"
+#include <vtk_zlib.h>
+#include <vtksys/FStream.hxx>
 #include <vtksys/SystemTools.hxx>
 
+// vtkTeem includes
+#include "vtkTeemNRRDWriter.h"
+
 // Teem includes
 #include "teem/ten.h"
 
+// STD includes
+#include <algorithm>
+#include <atomic>
+#include <sstream>
+#include <vector>
+
 vtkStandardNewMacro(vtkTeemNRRDReader);
 
 //----------------------------------------------------------------------------
@@ -156,6 +169,193 @@ const char* vtkTeemNRRDReader::GetAxisUnit(unsigned int axis)
   return this->AxisUnits[axis].c_str();
 }
 
+//----------------------------------------------------------------------------
+bool vtkTeemNRRDReader::ReadCompressedChunks(const char* fileName, vtkImageData* image)
+{
+  if (!fileName || !image || !image->GetScalarPointer())
+    {
+    return false;
+    }
+  vtksys::ifstream file(fileName, std::ios::in | std::ios::binary);
+  if (!file.is_open())
+    {
+    return false;
+    }
+
+  // Get the fields that are needed for reading the data from the header
+  std::string line;
+  if (!std::getline(file, line) || line.compare(0, 4, "NRRD") != 0)
+    {
+    return false;
+    }
+  std::string encoding;
+  std::string endian;
+  std::string chunks;
+  const std::string chunksKey = std::string(vtkTeemNRRDWriter::GetCompressedChunksKey()) + ":=";
+  while (std::getline(file, line))
+    {
+    if (!line.empty() && line.back() == '\r')
+      {
+      line.pop_back();
+      }
+    if (line.empty())
+      {
+      // end of header
+      break;
+      }
+    if (line[0] == '#')
+      {
+      continue;
+      }
+    if (line.compare(0, chunksKey.size(), chunksKey) == 0)
+      {
+      chunks = line.substr(chunksKey.size());
+      continue;
+      }
+    if (line.find(":=") != std::string::npos)
+      {
+      // other key/value pair
+      continue;
+      }
+    size_t separatorPosition = line.find(": ");
+    if (separatorPosition == std::string::npos)
+      {
+      continue;
+      }
+    std::string field = line.substr(0, separatorPosition);
+    std::string value = line.substr(separatorPosition + 2);
+    if (field == "encoding")
+      {
+      encoding = value;
+      }
+    else if (field == "endian")
+      {
+      endian = value;
+      }
+    else if (field == "data file" || field == "datafile"
+      || ((field == "line skip" || field == "lineskip" || field == "byte skip" || field == "byteskip") && value != "0"))
+      {
+      // detached or offset data is not written by vtkTeemNRRDWriter chunked compression
+      return false;
+      }
+    }
+  if (!file.good() || chunks.empty() || (encoding != "gzip" && encoding != "gz"))
+    {
+    return false;
+    }
+
+  // Get chunk sizes
+  std::istringstream chunksStream(chunks);
+  size_t chunkSize = 0;
+  chunksStream >> chunkSize;
+  std::vector<size_t> compressedChunkOffsets;
+  size_t compressedChunkSize = 0;
+  size_t compressedDataSize = 0;
+  while (chunksStream >> compressedChunkSize)
+    {
+    compressedChunkOffsets.push_back(compressedDataSize);
+    compressedDataSize += compressedChunkSize;
+    }
+  compressedChunkOffsets.push_back(compressedDataSize);
+  const size_t numberOfChunks = compressedChunkOffsets.size() - 1;
+  const size_t dataSize = static_cast<size_t>(image->GetNumberOfPoints())
+    * image->GetNumberOfScalarComponents() * image->GetScalarSize();
+  if (chunkSize == 0 || numberOfChunks == 0 || !chunksStream.eof()
+    || numberOfChunks != std::max<size_t>(1, (dataSize + chunkSize - 1) / chunkSize))
+    {
+    return false;
+    }
+
+  // Read gzip header, compressed data, and gzip trailer
+  const size_t gzipHeaderSize = 10;
+  const size_t gzipTrailerSize = 8;
+  std::vector<unsigned char> compressedData(gzipHeaderSize + compressedDataSize + gzipTrailerSize);
+  if (!file.read(reinterpret_cast<char*>(compressedData.data()), compressedData.size()))
+    {
+    return false;
+    }
+  file.close();
+  if (compressedData[0] != 0x1f || compressedData[1] != 0x8b || compressedData[2] != 8 || compressedData[3] != 0)
+    {
+    // not a gzip header without optional fields
+    return false;
+    }
+  const unsigned char* compressedChunks = compressedData.data() + gzipHeaderSize;
+
+  // Decompress chunks
+  unsigned char* data = static_cast<unsigned char*>(image->GetScalarPointer());
+  std::vector<uLong> chunkChecksums(numberOfChunks, 0);
+  std::atomic<bool> decompressionFailed(false);
+  auto decompressChunks = [&](vtkIdType beginChunk, vtkIdType endChunk)
+    {
+    for (vtkIdType chunkIndex = beginChunk; chunkIndex < endChunk; ++chunkIndex)
+      {
+      const size_t offset = static_cast<size_t>(chunkIndex) * chunkSize;
+      const size_t size = std::min(chunkSize, dataSize - offset);
+      z_stream stream = {};
+      if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+        {
+        decompressionFailed = true;
+        continue;
+        }
+      stream.next_in = const_cast<Bytef*>(compressedChunks + compressedChunkOffsets[chunkIndex]);
+      stream.avail_in = static_cast<uInt>(compressedChunkOffsets[chunkIndex + 1] - compressedChunkOffsets[chunkIndex]);
+      stream.next_out = data + offset;
+      stream.avail_out = static_cast<uInt>(size);
+      int result = inflate(&stream, Z_SYNC_FLUSH);
+      const bool lastChunk = (static_cast<size_t>(chunkIndex) == numberOfChunks - 1);
+      if (stream.total_out != size || (lastChunk ? result != Z_STREAM_END : (result != Z_OK && result != Z_BUF_ERROR)))
+        {
+        decompressionFailed = true;
+        }
+      inflateEnd(&stream);
+      chunkChecksums[chunkIndex] = crc32(crc32(0L, Z_NULL, 0), data + offset, static_cast<uInt>(size));
+      }
+    };
+  vtkSMPTools::For(0, static_cast<vtkIdType>(numberOfChunks), 1, decompressChunks);
+  if (decompressionFailed)
+    {
+    return false;
+    }
+
+  // Verify checksum and size stored in the gzip trailer
+  uLong checksum = chunkChecksums[0];
+  for (size_t chunkIndex = 1; chunkIndex < numberOfChunks; ++chunkIndex)
+    {
+    const size_t size = std::min(chunkSize, dataSize - chunkIndex * chunkSize);
+    checksum = crc32_combine(checksum, chunkChecksums[chunkIndex], static_cast<z_off_t>(size));
+    }
+  const unsigned char* gzipTrailer = compressedChunks + compressedDataSize;
+  uLong storedChecksum = 0;
+  uLong storedSize = 0;
+  for (int byteIndex = 3; byteIndex >= 0; --byteIndex)
+    {
+    storedChecksum = (storedChecksum << 8) | gzipTrailer[byteIndex];
+    storedSize = (storedSize << 8) | gzipTrailer[4 + byteIndex];
+    }
+  if (storedChecksum != checksum || storedSize != static_cast<uLong>(dataSize & 0xffffffff))
+    {
+    return false;
+    }
+
+  // Data is written with the endianness of the writer
+  const int scalarSize = image->GetScalarSize();
+  if (scalarSize > 1)
+    {
+#ifdef VTK_WORDS_BIGENDIAN
+    const bool swapBytes = (endian == "little");
+#else
+    const bool swapBytes = (endian == "big");
+#endif
+    if (swapBytes)
+      {
+      vtkByteSwap::SwapVoidRange(data, dataSize / scalarSize, scalarSize);
+      }
+    }
+  image->Modified();
+  return true;
+}
+
 //----------------------------------------------------------------------------
 int vtkTeemNRRDReader::CanReadFile(const char* filename)
 {
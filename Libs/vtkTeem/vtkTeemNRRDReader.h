@@ -92,6 +92,12 @@ public:
   /// Get unit for specified axis
   const char* GetAxisUnit(unsigned int axis);
 
+  /// Read voxel data of a file that was written by vtkTeemNRRDWriter with ParallelCompression
+  /// enabled, decompressing the data chunks in parallel. The image must be already allocated with the
+  /// dimensions, scalar type, and number of components of the image in the file.
+  /// Returns false if the file does not contain compressed chunks or reading fails.
+  static bool ReadCompressedChunks(const char* fileName, vtkImageData* image);
+
   void PrintSelf(ostream& os, vtkIndent indent) override;
 
   ///  is the given file name a NRRD file?
@@ -7,13 +7,21 @@
 #include "vtkPointData.h"
 #include "vtkObjectFactory.h"
 #include "vtkInformation.h"
+#include <vtkSMPTools.h>
 #include <vtkVersion.h>
+#include <vtk_zlib.h>
+#include <vtksys/SystemTools.hxx>
 
 #include <itkMath.h>
 #include <vnl/vnl_double_3.h>
 
 #include "itkNumberToString.h"
 
+#include <algorithm>
+#include <atomic>
+#include <sstream>
+#include <vector>
+
 
 class AttributeMapType: public std::map<std::string, std::string> {};
 class AxisInfoMapType : public std::map<unsigned int, std::string> {};
@@ -40,6 +48,9 @@ vtkTeemNRRDWriter::vtkTeemNRRDWriter()
   this->VectorAxisKind = nrrdKindUnknown;
   this->Space = nrrdSpaceRightAnteriorSuperior;
   this->ForceRangeAxis = false;
+  this->ParallelCompression = false;
+  this->CompressionChunkSize = 4 * 1024 * 1024;
+  this->RunLengthCompression = false;
 }
 
 //----------------------------------------------------------------------------
@@ -412,6 +423,18 @@ void vtkTeemNRRDWriter::WriteData()
     return;
     }
 
+  if (this->GetUseCompression() && this->ParallelCompression && nrrdEncodingGzip->available()
+    && vtksys::SystemTools::LowerCase(vtksys::SystemTools::GetFilenameLastExtension(this->GetFileName())) != ".nhdr")
+    {
+    if (!this->WriteCompressedChunks(nrrd))
+      {
+      this->WriteErrorOn();
+      }
+    // Free the nrrd struct but don't touch nrrd->data
+    nrrd = nrrdNix(nrrd);
+    return;
+    }
+
   NrrdIoState *nio = nrrdIoStateNew();
 
   // set encoding for data: compressed (raw), (uncompressed) raw, or ascii
@@ -452,6 +475,147 @@ void vtkTeemNRRDWriter::WriteData()
   nio = nrrdIoStateNix(nio);
 }
 
+//----------------------------------------------------------------------------
+bool vtkTeemNRRDWriter::WriteCompressedChunks(Nrrd* nrrd)
+{
+  const unsigned char* data = static_cast<const unsigned char*>(nrrd->data);
+  const size_t dataSize = nrrdElementNumber(nrrd) * nrrdElementSize(nrrd);
+  const size_t chunkSize = static_cast<size_t>(this->CompressionChunkSize);
+  const size_t numberOfChunks = std::max<size_t>(1, (dataSize + chunkSize - 1) / chunkSize);
+
+  // Each chunk is compressed into a raw deflate stream by a separate compressor.
+  // All chunks but the last one end with a sync flush (an empty stored block that
+  // aligns the output to a byte boundary and is not marked as final), therefore the
+  // concatenated chunks form one valid deflate stream. No history is shared between
+  // chunks, so they can be decompressed independently, too.
+  std::vector<std::vector<unsigned char> > compressedChunks(numberOfChunks);
+  std::vector<uLong> chunkChecksums(numberOfChunks, 0);
+  std::atomic<bool> compressionFailed(false);
+  const int level = this->CompressionLevel;
+  const int strategy = this->RunLengthCompression ? Z_RLE : Z_DEFAULT_STRATEGY;
+  auto compressChunks = [&](vtkIdType beginChunk, vtkIdType endChunk)
+    {
+    for (vtkIdType chunkIndex = beginChunk; chunkIndex < endChunk; ++chunkIndex)
+      {
+      const size_t offset = static_cast<size_t>(chunkIndex) * chunkSize;
+      const size_t size = std::min(chunkSize, dataSize - offset);
+      const bool lastChunk = (static_cast<size_t>(chunkIndex) == numberOfChunks - 1);
+      z_stream stream = {};
+      if (deflateInit2(&stream, level, Z_DEFLATED, -MAX_WBITS, 8, strategy) != Z_OK)
+        {
+        compressionFailed = true;
+        continue;
+        }
+      std::vector<unsigned char>& compressedChunk = compressedChunks[chunkIndex];
+      // deflateBound does not include the sync flush marker
+      compressedChunk.resize(deflateBound(&stream, static_cast<uLong>(size)) + 16);
+      stream.next_in = const_cast<Bytef*>(data + offset);
+      stream.avail_in = static_cast<uInt>(size);
+      stream.next_out = compressedChunk.data();
+      stream.avail_out = static_cast<uInt>(compressedChunk.size());
+      int result = deflate(&stream, lastChunk ? Z_FINISH : Z_SYNC_FLUSH);
+      if ((lastChunk && result != Z_STREAM_END) || (!lastChunk && (result != Z_OK || stream.avail_in != 0)))
+        {
+        compressionFailed = true;
+        }
+      compressedChunk.resize(stream.total_out);
+      deflateEnd(&stream);
+      chunkChecksums[chunkIndex] = crc32(crc32(0L, Z_NULL, 0), data + offset, static_cast<uInt>(size));
+      }
+    };
+  vtkSMPTools::For(0, static_cast<vtkIdType>(numberOfChunks), 1, compressChunks);
+  if (compressionFailed)
+    {
+    vtkErrorMacro("Write: Error compressing data of " << this->GetFileName());
+    return false;
+    }
+
+  uLong checksum = chunkChecksums[0];
+  std::stringstream chunksStream;
+  chunksStream << chunkSize;
+  for (size_t chunkIndex = 0; chunkIndex < numberOfChunks; ++chunkIndex)
+    {
+    if (chunkIndex > 0)
+      {
+      const size_t size = std::min(chunkSize, dataSize - chunkIndex * chunkSize);
+      checksum = crc32_combine(checksum, chunkChecksums[chunkIndex], static_cast<z_off_t>(size));
+      }
+    chunksStream << " " << compressedChunks[chunkIndex].size();
+    }
+  nrrdKeyValueAdd(nrrd, vtkTeemNRRDWriter::GetCompressedChunksKey(), chunksStream.str().c_str());
+  if (this->RunLengthCompression)
+    {
+    nrrdKeyValueAdd(nrrd, vtkTeemNRRDWriter::GetCompressionStrategyKey(), "rle");
+    }
+
+  FILE* file = vtksys::SystemTools::Fopen(this->GetFileName(), "w+b");
+  if (!file)
+    {
+    vtkErrorMacro("Write: Error opening file " << this->GetFileName());
+    return false;
+    }
+
+  // Let teem write the header only
+  NrrdIoState* nio = nrrdIoStateNew();
+  nio->format = nrrdFormatNRRD;
+  nio->encoding = nrrdEncodingGzip;
+  nio->endian = airEndianUnknown;
+  nio->skipData = AIR_TRUE;
+  bool success = true;
+  if (nrrdWrite(file, nrrd, nio))
+    {
+    char *err = biffGetDone(NRRD); // would be nice to free(err)
+    vtkErrorMacro("Write: Error writing header of " << this->GetFileName() << ":\n" << err);
+    success = false;
+    }
+  nio = nrrdIoStateNix(nio);
+
+  // The header must be terminated by an empty line
+  if (success)
+    {
+    char headerEnd[2] = { 0, 0 };
+    if (fseek(file, -2, SEEK_END) != 0 || fread(headerEnd, 1, 2, file) != 2 || fseek(file, 0, SEEK_END) != 0)
+      {
+      success = false;
+      }
+    else if (headerEnd[0] != '\n' || headerEnd[1] != '\n')
+      {
+      success = (fputc('\n', file) != EOF);
+      }
+    }
+
+  // gzip member: header (no optional fields, unknown OS), deflate stream, CRC32 and size of uncompressed data
+  if (success)
+    {
+    const unsigned char gzipHeader[10] = { 0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 0xff };
+    success = (fwrite(gzipHeader, 1, sizeof(gzipHeader), file) == sizeof(gzipHeader));
+    for (size_t chunkIndex = 0; success && chunkIndex < numberOfChunks; ++chunkIndex)
+      {
+      const std::vector<unsigned char>& compressedChunk = compressedChunks[chunkIndex];
+      success = (fwrite(compressedChunk.data(), 1, compressedChunk.size(), file) == compressedChunk.size());
+      }
+    unsigned char gzipTrailer[8];
+    const uLong uncompressedSize = static_cast<uLong>(dataSize & 0xffffffff);
+    for (int byteIndex = 0; byteIndex < 4; ++byteIndex)
+      {
+      gzipTrailer[byteIndex] = static_cast<unsigned char>((checksum >> (8 * byteIndex)) & 0xff);
+      gzipTrailer[4 + byteIndex] = static_cast<unsigned char>((uncompressedSize >> (8 * byteIndex)) & 0xff);
+      }
+    success = success && (fwrite(gzipTrailer, 1, sizeof(gzipTrailer), file) == sizeof(gzipTrailer));
+    if (!success)
+      {
+      vtkErrorMacro("Write: Error writing data of " << this->GetFileName());
+      }
+    }
+  if (fclose(file) != 0)
+    {
+    vtkErrorMacro("Write: Error closing file " << this->GetFileName());
+    success = false;
+    }
+  return success;
+}
+
+//----------------------------------------------------------------------------
 void vtkTeemNRRDWriter::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os,indent);
@@ -460,6 +624,9 @@ void vtkTeemNRRDWriter::PrintSelf(ostream& os, vtkIndent indent)
      this->IJKToRASMatrix->PrintSelf(os,indent);
   os << indent << "Measurement frame: ";
      this->MeasurementFrameMatrix->PrintSelf(os,indent);
+  os << indent << "ParallelCompression: " << (this->ParallelCompression ? "true" : "false") << "\n";
+  os << indent << "CompressionChunkSize: " << this->CompressionChunkSize << "\n";
+  os << indent << "RunLengthCompression: " << (this->RunLengthCompression ? "true" : "false") << "\n";
 }
 
 void vtkTeemNRRDWriter::SetAttribute(const std::string& name, const std::string& value)
@@ -58,6 +58,33 @@ public:
   vtkSetClampMacro(CompressionLevel, int, 0, 9);
   vtkGetMacro(CompressionLevel, int);
 
+  /// Compress the voxel data in independent chunks, using multiple threads.
+  /// The result is still a single standard gzip stream that any NRRD reader can read.
+  /// Compressed sizes of the chunks are stored in the GetCompressedChunksKey() header field
+  /// so that vtkTeemNRRDReader::ReadCompressedChunks() can decompress the chunks in parallel.
+  /// Ignored if compression is disabled or the header is detached (.nhdr). Disabled by default.
+  vtkSetMacro(ParallelCompression, bool);
+  vtkGetMacro(ParallelCompression, bool);
+  vtkBooleanMacro(ParallelCompression, bool);
+
+  /// Number of uncompressed bytes in each chunk when ParallelCompression is enabled.
+  /// Default is 4MB.
+  vtkSetClampMacro(CompressionChunkSize, int, 65536, VTK_INT_MAX);
+  vtkGetMacro(CompressionChunkSize, int);
+
+  /// Use run-length encoding strategy of deflate when ParallelCompression is enabled.
+  /// It is several times faster than the default strategy and compresses labelmaps
+  /// almost as well. The output remains standard gzip. The strategy is recorded
+  /// in the GetCompressionStrategyKey() header field. Disabled by default.
+  vtkSetMacro(RunLengthCompression, bool);
+  vtkGetMacro(RunLengthCompression, bool);
+  vtkBooleanMacro(RunLengthCompression, bool);
+
+  /// Header field that stores the uncompressed chunk size followed by the compressed size of each chunk
+  static const char* GetCompressedChunksKey() { return "gzip_chunks"; };
+  /// Header field that stores the deflate strategy, if not the default
+  static const char* GetCompressionStrategyKey() { return "gzip_strategy"; };
+
   vtkSetClampMacro(FileType,int,VTK_ASCII,VTK_BINARY);
   vtkGetMacro(FileType,int);
   void SetFileTypeToASCII() {this->SetFileType(VTK_ASCII);};
@@ -115,6 +142,10 @@ protected:
   /// Write method. It is called by vtkWriter::Write();
   void WriteData() override;
 
+  /// Write header and voxel data compressed in chunks in parallel.
+  /// Returns false on failure.
+  bool WriteCompressedChunks(Nrrd* nrrd);
+
   ///
   /// Flag to set to on when a write error occurred
   int WriteError;
@@ -139,6 +170,10 @@ protected:
 
   bool ForceRangeAxis;
 
+  bool ParallelCompression;
+  int CompressionChunkSize;
+  bool RunLengthCompression;
+
 private:
   vtkTeemNRRDWriter(const vtkTeemNRRDWriter&) = delete;
   void operator=(const vtkTeemNRRDWriter&) = delete;
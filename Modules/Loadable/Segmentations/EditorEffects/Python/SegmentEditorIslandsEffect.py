@@ -153,11 +153,8 @@ about each operation, hover the mouse over the option and wait for the tooltip t
         islandMath.SetMinimumSize(minimumSize)
         islandMath.Update()
 
-        islandImage = slicer.vtkOrientedImageData()
-        islandImage.ShallowCopy(islandMath.GetOutput())
         selectedSegmentLabelmapImageToWorldMatrix = vtk.vtkMatrix4x4()
         selectedSegmentLabelmap.GetImageToWorldMatrix(selectedSegmentLabelmapImageToWorldMatrix)
-        islandImage.SetImageToWorldMatrix(selectedSegmentLabelmapImageToWorldMatrix)
 
         islandCount = islandMath.GetNumberOfIslands()
         islandOrigCount = islandMath.GetOriginalNumberOfIslands()
@@ -174,9 +171,6 @@ about each operation, hover the mouse over the option and wait for the tooltip t
             if selectedSegmentName is not None and selectedSegmentName != "":
                 baseSegmentName = selectedSegmentName
 
-            labelValues = vtk.vtkIntArray()
-            slicer.vtkSlicerSegmentationsModuleLogic.GetAllLabelValues(labelValues, islandImage)
-
             # Erase segment from in original labelmap.
             # Individual islands will be added back later.
             threshold = vtk.vtkImageThreshold()
@@ -191,13 +185,14 @@ about each operation, hover the mouse over the option and wait for the tooltip t
             self.scriptedEffect.modifySegmentByLabelmap(segmentationNode, selectedSegmentID, emptyLabelmap,
                                                         slicer.qSlicerSegmentEditorAbstractEffect.ModificationModeSet)
 
-            for i in range(labelValues.GetNumberOfTuples()):
+            # Islands are labeled from 1 to islandCount in order of decreasing size
+            for i in range(islandCount):
                 if (maxNumberOfSegments > 0 and i >= maxNumberOfSegments):
                     # We only care about the segments up to maxNumberOfSegments.
                     # If we do not want to split segments, we only care about the first.
                     break
 
-                labelValue = int(labelValues.GetTuple1(i))
+                labelValue = i + 1
                 segment = selectedSegment
                 segmentID = selectedSegmentID
                 if i != 0 and split:
@@ -211,14 +206,22 @@ about each operation, hover the mouse over the option and wait for the tooltip t
                     segment.SetLabelValue(segmentation.GetUniqueLabelValueForSharedLabelmap(selectedSegmentID))
 
                 threshold = vtk.vtkImageThreshold()
-                threshold.SetInputData(islandMath.GetOutput())
                 if not split and maxNumberOfSegments <= 0:
                     # no need to split segments and no limit on number of segments, so we can lump all islands into one segment
+                    threshold.SetInputData(islandMath.GetOutput())
                     threshold.ThresholdByLower(0)
                     threshold.SetInValue(0)
                     threshold.SetOutValue(1)
                 else:
-                    # copy only selected islands; or copy islands into different segments
+                    # copy only selected islands; or copy islands into different segments.
+                    # Only the extent of the island is processed, which makes splitting to many segments fast.
+                    islandExtent = [0, -1, 0, -1, 0, -1]
+                    islandMath.GetIslandExtent(i, islandExtent)
+                    clip = vtk.vtkImageClip()
+                    clip.SetInputData(islandMath.GetOutput())
+                    clip.SetOutputWholeExtent(islandExtent)
+                    clip.ClipDataOn()
+                    threshold.SetInputConnection(clip.GetOutputPort())
                     threshold.ThresholdBetween(labelValue, labelValue)
                     threshold.SetInValue(1)
                     threshold.SetOutValue(0)
@@ -231,8 +234,6 @@ about each operation, hover the mouse over the option and wait for the tooltip t
                 # Create oriented image data from output
                 modifierImage = slicer.vtkOrientedImageData()
                 modifierImage.DeepCopy(threshold.GetOutput())
-                selectedSegmentLabelmapImageToWorldMatrix = vtk.vtkMatrix4x4()
-                selectedSegmentLabelmap.GetImageToWorldMatrix(selectedSegmentLabelmapImageToWorldMatrix)
                 modifierImage.SetGeometryFromImageToWorldMatrix(selectedSegmentLabelmapImageToWorldMatrix)
                 # We could use a single slicer.vtkSlicerSegmentationsModuleLogic.ImportLabelmapToSegmentationNode
                 # method call to import all the resulting segments at once but that would put all the imported segments
@@ -43,7 +43,6 @@
 #include <vtkImageMask.h>
 #include <vtkImageThreshold.h>
 #include <vtkPolyData.h>
-#include <vtkImageMathematics.h>
 
 // Slicer includes
 #include "qMRMLSliceWidget.h"
@@ -156,18 +155,17 @@ void qSlicerSegmentEditorAbstractLabelEffect::appendImage(vtkOrientedImageData*
     return;
     }
 
-  // Make sure appended image has the same lattice as the input image
-  vtkSmartPointer<vtkOrientedImageData> resampledAppendedImage = vtkSmartPointer<vtkOrientedImageData>::New();
-  vtkOrientedImageDataResample::ResampleOrientedImageToReferenceOrientedImage(
-    appendedImage, inputImage, resampledAppendedImage);
-
-  // Add image created from poly data to input image
-  vtkSmartPointer<vtkImageMathematics> imageMath = vtkSmartPointer<vtkImageMathematics>::New();
-  imageMath->SetInput1Data(inputImage);
-  imageMath->SetInput2Data(resampledAppendedImage);
-  imageMath->SetOperationToMax();
-  imageMath->Update();
-  inputImage->DeepCopy(imageMath->GetOutput());
+  // Make sure appended image has the same lattice as the input image (resampling is not needed if it already has)
+  vtkSmartPointer<vtkOrientedImageData> resampledAppendedImage = appendedImage;
+  if (!vtkOrientedImageDataResample::DoGeometriesMatch(inputImage, appendedImage))
+    {
+    resampledAppendedImage = vtkSmartPointer<vtkOrientedImageData>::New();
+    vtkOrientedImageDataResample::ResampleOrientedImageToReferenceOrientedImage(
+      appendedImage, inputImage, resampledAppendedImage);
+    }
+
+  // Add image created from poly data to input image, in place within the extent of the input image
+  vtkOrientedImageDataResample::ModifyImage(inputImage, resampledAppendedImage, vtkOrientedImageDataResample::OPERATION_MAXIMUM);
 }
 
 //-----------------------------------------------------------------------------
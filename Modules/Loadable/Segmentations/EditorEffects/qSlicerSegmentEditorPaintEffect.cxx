@@ -26,6 +26,8 @@
 #include "vtkMRMLSegmentationsDisplayableManager2D.h"
 #include "vtkMRMLSegmentEditorNode.h"
 #include "vtkOrientedImageData.h"
+#include "vtkSegment.h"
+#include "vtkSlicerAnalyticBrushPainter.h"
 
 // Qt includes
 #include <QDebug>
@@ -48,15 +50,22 @@
 #include <vtkGlyph2D.h>
 #include <vtkGlyph3D.h>
 #include <vtkIdList.h>
+#include <vtkImageData.h>
 #include <vtkImageChangeInformation.h>
+#include <vtkImageConstantPad.h>
+#include <vtkImageMapper.h>
+#include <vtkImageMapToRGBA.h>
+#include <vtkImageReslice.h>
 #include <vtkImageStencil.h>
 #include <vtkImageStencilData.h>
 #include <vtkImageStencilToImage.h>
+#include <vtkLookupTable.h>
 #include <vtkMath.h>
 #include <vtkMatrix4x4.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkPlane.h>
+#include <vtkPointData.h>
 #include <vtkPoints.h>
 #include <vtkPolyData.h>
 #include <vtkPolyDataMapper.h>
@@ -96,6 +105,9 @@
 #include "vtkMRMLSliceLayerLogic.h"
 #include "vtkOrientedImageDataResample.h"
 
+// STD includes
+#include <algorithm>
+
 //-----------------------------------------------------------------------------
 /// Visualization objects and pipeline for each slice view for the paint brush
 class BrushPipeline
@@ -153,6 +165,35 @@ public:
     feedbackActorProperty->SetOpacity(0.5);
     this->FeedbackActor->SetMapper(this->FeedbackMapper);
     this->FeedbackActor->VisibilityOff();
+
+    // Labelmap of the paint stroke in progress
+    this->StrokeImage = vtkSmartPointer<vtkImageData>::New();
+    this->StrokeXYToImageTransform = vtkSmartPointer<vtkTransform>::New();
+    this->StrokeReslice = vtkSmartPointer<vtkImageReslice>::New();
+    this->StrokeReslice->SetBackgroundColor(0.0, 0.0, 0.0, 0.0);
+    this->StrokeReslice->AutoCropOutputOff();
+    this->StrokeReslice->SetOptimization(1);
+    this->StrokeReslice->SetOutputOrigin(0.0, 0.0, 0.0);
+    this->StrokeReslice->SetOutputSpacing(1.0, 1.0, 1.0);
+    this->StrokeReslice->SetOutputDimensionality(3);
+    this->StrokeReslice->SetInterpolationModeToNearestNeighbor();
+    this->StrokeReslice->SetResliceTransform(this->StrokeXYToImageTransform);
+    this->StrokeLookupTable = vtkSmartPointer<vtkLookupTable>::New();
+    this->StrokeLookupTable->SetNumberOfTableValues(2);
+    this->StrokeLookupTable->SetTableRange(0, 1);
+    this->StrokeLookupTable->SetTableValue(0, 0.0, 0.0, 0.0, 0.0);
+    this->StrokeLookupTable->SetTableValue(1, 0.7, 0.7, 0.0, 0.5);
+    vtkSmartPointer<vtkImageMapToRGBA> strokeColorMapper = vtkSmartPointer<vtkImageMapToRGBA>::New();
+    strokeColorMapper->SetInputConnection(this->StrokeReslice->GetOutputPort());
+    strokeColorMapper->SetOutputFormatToRGBA();
+    strokeColorMapper->SetLookupTable(this->StrokeLookupTable);
+    vtkSmartPointer<vtkImageMapper> strokeMapper = vtkSmartPointer<vtkImageMapper>::New();
+    strokeMapper->SetInputConnection(strokeColorMapper->GetOutputPort());
+    strokeMapper->SetColorWindow(255);
+    strokeMapper->SetColorLevel(127.5);
+    this->StrokeActor = vtkSmartPointer<vtkActor2D>::New();
+    this->StrokeActor->SetMapper(strokeMapper);
+    this->StrokeActor->VisibilityOff();
     };
   ~BrushPipeline2D() override = default;
 
@@ -177,6 +218,14 @@ public:
   vtkSmartPointer<vtkTransformPolyDataFilter> BrushWorldToSliceTransformer;
   vtkSmartPointer<vtkCutter> FeedbackCutter;
   vtkSmartPointer<vtkTransformPolyDataFilter> FeedbackWorldToSliceTransformer;
+  vtkSmartPointer<vtkActor2D> StrokeActor;
+  vtkSmartPointer<vtkImageData> StrokeImage;
+  vtkSmartPointer<vtkTransform> StrokeXYToImageTransform;
+  vtkSmartPointer<vtkImageReslice> StrokeReslice;
+  vtkSmartPointer<vtkLookupTable> StrokeLookupTable;
+  // Stroke labelmap state that StrokeImage was last updated from
+  vtkMTimeType StrokeLabelmapMTime{ 0 };
+  int StrokeModifiedExtent[6]{ 0, -1, 0, -1, 0, -1 };
 };
 
 class BrushPipeline3D : public BrushPipeline
@@ -231,6 +280,7 @@ qSlicerSegmentEditorPaintEffectPrivate::qSlicerSegmentEditorPaintEffectPrivate(q
   , LastBrushPositionValid(false)
   , DelayedPaint(true)
   , IsPainting(false)
+  , StrokeNumberOfPaintedPoints(0)
   , ActiveViewWidget(nullptr)
   , PaintOptionsFrame(nullptr)
   , BrushDiameterFrame(nullptr)
@@ -270,6 +320,7 @@ qSlicerSegmentEditorPaintEffectPrivate::qSlicerSegmentEditorPaintEffectPrivate(q
   this->BrushPolyDataToStencil = vtkSmartPointer<vtkPolyDataToImageStencil>::New();
   this->BrushPolyDataToStencil->SetOutputSpacing(1.0,1.0,1.0);
   this->BrushPolyDataToStencil->SetInputConnection(this->WorldOriginToModifierLabelmapIjkTransformer->GetOutputPort());
+  this->AnalyticBrushPainter = vtkSmartPointer<vtkSlicerAnalyticBrushPainter>::New();
 
   this->FeedbackGlyphFilter = vtkSmartPointer<vtkGlyph3D>::New();
   this->FeedbackGlyphFilter->SetInputData(this->FeedbackPointsPolyData);
@@ -283,6 +334,12 @@ qSlicerSegmentEditorPaintEffectPrivate::qSlicerSegmentEditorPaintEffectPrivate(q
   this->LastBrushPosition_World[0] = 0.0;
   this->LastBrushPosition_World[1] = 0.0;
   this->LastBrushPosition_World[2] = 0.0;
+
+  for (int i = 0; i < 6; ++i)
+    {
+    this->StrokeModifiedExtent[i] = (i % 2 == 0 ? 0 : -1);
+    this->StrokeReferenceExtent[i] = (i % 2 == 0 ? 0 : -1);
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -313,6 +370,7 @@ BrushPipeline* qSlicerSegmentEditorPaintEffectPrivate::brushForWidget(qMRMLWidge
 
     // add brush actor later to make it appear above the feedback actor (feedback actor
     // shows previous brush positions)
+    q->addActor2D(viewWidget, pipeline->StrokeActor);
     q->addActor2D(viewWidget, pipeline->FeedbackActor);
     q->addActor2D(viewWidget, pipeline->BrushActor);
 
@@ -362,13 +420,265 @@ void qSlicerSegmentEditorPaintEffectPrivate::paintAddPoint(qMRMLWidget* viewWidg
 
   if (q->integerParameter("BrushPixelMode") || !this->DelayedPaint)
     {
-    q->paintApply(viewWidget);
+    if (this->IsPainting)
+      {
+      // Paint into the stroke labelmap now, the segment is modified once, when the stroke is completed
+      this->paintStroke(viewWidget);
+      }
+    else
+      {
+      q->paintApply(viewWidget);
+      }
     qSlicerSegmentEditorAbstractEffect::forceRender(viewWidget); // TODO: repaint all?
     }
 }
 
 //-----------------------------------------------------------------------------
-void qSlicerSegmentEditorPaintEffectPrivate::updateBrushStencil(qMRMLWidget* viewWidget)
+void qSlicerSegmentEditorPaintEffectPrivate::paintStroke(qMRMLWidget* viewWidget)
+{
+  Q_Q(qSlicerSegmentEditorPaintEffect);
+
+  vtkMRMLSegmentationNode* segmentationNode = (q->parameterSetNode() ? q->parameterSetNode()->GetSegmentationNode() : nullptr);
+  if (!segmentationNode)
+    {
+    qCritical() << Q_FUNC_INFO << ": Invalid segmentationNode";
+    return;
+    }
+
+  if (!this->StrokeLabelmap)
+    {
+    // New stroke. The stroke labelmap has the geometry of the default modifier labelmap,
+    // but it is allocated only where the stroke paints (see growStrokeLabelmap).
+    vtkOrientedImageData* referenceGeometryImage = q->referenceGeometryImage();
+    if (!referenceGeometryImage)
+      {
+      qCritical() << Q_FUNC_INFO << ": Invalid reference geometry";
+      return;
+      }
+    this->StrokeLabelmap = vtkSmartPointer<vtkOrientedImageData>::New();
+    vtkNew<vtkMatrix4x4> referenceImageToWorldMatrix;
+    referenceGeometryImage->GetImageToWorldMatrix(referenceImageToWorldMatrix);
+    this->StrokeLabelmap->SetGeometryFromImageToWorldMatrix(referenceImageToWorldMatrix);
+    this->StrokeLabelmap->SetExtent(0, -1, 0, -1, 0, -1);
+    referenceGeometryImage->GetExtent(this->StrokeReferenceExtent);
+    this->StrokeNumberOfPaintedPoints = 0;
+    for (int i = 0; i < 6; ++i)
+      {
+      this->StrokeModifiedExtent[i] = (i % 2 == 0 ? 0 : -1);
+      }
+    }
+
+  vtkIdType numberOfPoints = this->PaintCoordinates_World->GetNumberOfPoints();
+  if (numberOfPoints <= this->StrokeNumberOfPaintedPoints)
+    {
+    return;
+    }
+
+  // Paint only the new points. The last painted point is included to connect the new points to the stroke.
+  vtkIdType firstPointIndex = std::max<vtkIdType>(0, this->StrokeNumberOfPaintedPoints - 1);
+  vtkNew<vtkPoints> newPoints_World;
+  for (vtkIdType pointIndex = firstPointIndex; pointIndex < numberOfPoints; ++pointIndex)
+    {
+    newPoints_World->InsertNextPoint(this->PaintCoordinates_World->GetPoint(pointIndex));
+    }
+
+  // Make sure the stroke labelmap contains the bounding box of the new brushes
+  double brushBounds_Ijk[6] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+  if (!q->integerParameter("BrushPixelMode"))
+    {
+    this->updateBrushStencil(viewWidget, this->StrokeLabelmap);
+    this->WorldOriginToModifierLabelmapIjkTransformer->GetOutput()->GetBounds(brushBounds_Ijk);
+    }
+  vtkNew<vtkPoints> newPoints_Ijk;
+  this->transformPointsFromWorldToIJK(this->StrokeLabelmap, segmentationNode, newPoints_World, newPoints_Ijk);
+  double pointBounds_Ijk[6] = { 0.0, -1.0, 0.0, -1.0, 0.0, -1.0 };
+  newPoints_Ijk->GetBounds(pointBounds_Ijk);
+  int brushesExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  for (int i = 0; i < 3; i++)
+    {
+    brushesExtent[2 * i] = std::max(this->StrokeReferenceExtent[2 * i],
+      static_cast<int>(floor(pointBounds_Ijk[2 * i] + brushBounds_Ijk[2 * i])) - 1);
+    brushesExtent[2 * i + 1] = std::min(this->StrokeReferenceExtent[2 * i + 1],
+      static_cast<int>(ceil(pointBounds_Ijk[2 * i + 1] + brushBounds_Ijk[2 * i + 1])) + 1);
+    }
+  if (brushesExtent[0] > brushesExtent[1] || brushesExtent[2] > brushesExtent[3] || brushesExtent[4] > brushesExtent[5])
+    {
+    // the new points are outside of the labelmap
+    this->StrokeNumberOfPaintedPoints = numberOfPoints;
+    return;
+    }
+  this->growStrokeLabelmap(brushesExtent);
+
+  int updateExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  if (q->integerParameter("BrushPixelMode"))
+    {
+    this->paintPixels(this->StrokeLabelmap, newPoints_World, updateExtent);
+    }
+  else
+    {
+    this->paintBrushes(this->StrokeLabelmap, viewWidget, newPoints_World, updateExtent);
+    }
+  this->StrokeNumberOfPaintedPoints = numberOfPoints;
+
+  int labelmapExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  this->StrokeLabelmap->GetExtent(labelmapExtent);
+  bool strokeExtentValid = (this->StrokeModifiedExtent[0] <= this->StrokeModifiedExtent[1]
+    && this->StrokeModifiedExtent[2] <= this->StrokeModifiedExtent[3]
+    && this->StrokeModifiedExtent[4] <= this->StrokeModifiedExtent[5]);
+  for (int i = 0; i < 3; i++)
+    {
+    updateExtent[2 * i] = std::max(updateExtent[2 * i], labelmapExtent[2 * i]);
+    updateExtent[2 * i + 1] = std::min(updateExtent[2 * i + 1], labelmapExtent[2 * i + 1]);
+    }
+  if (updateExtent[0] > updateExtent[1] || updateExtent[2] > updateExtent[3] || updateExtent[4] > updateExtent[5])
+    {
+    // nothing was painted
+    return;
+    }
+  for (int i = 0; i < 3; i++)
+    {
+    this->StrokeModifiedExtent[2 * i] = strokeExtentValid ?
+      std::min(this->StrokeModifiedExtent[2 * i], updateExtent[2 * i]) : updateExtent[2 * i];
+    this->StrokeModifiedExtent[2 * i + 1] = strokeExtentValid ?
+      std::max(this->StrokeModifiedExtent[2 * i + 1], updateExtent[2 * i + 1]) : updateExtent[2 * i + 1];
+    }
+
+  // Show the painted voxels in slice views
+  this->updateBrushes();
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerSegmentEditorPaintEffectPrivate::growStrokeLabelmap(const int extent[6])
+{
+  Q_Q(qSlicerSegmentEditorPaintEffect);
+  int strokeExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  this->StrokeLabelmap->GetExtent(strokeExtent);
+  bool strokeExtentValid = (strokeExtent[0] <= strokeExtent[1] && strokeExtent[2] <= strokeExtent[3] && strokeExtent[4] <= strokeExtent[5]);
+  if (strokeExtentValid
+    && extent[0] >= strokeExtent[0] && extent[1] <= strokeExtent[1]
+    && extent[2] >= strokeExtent[2] && extent[3] <= strokeExtent[3]
+    && extent[4] >= strokeExtent[4] && extent[5] <= strokeExtent[5])
+    {
+    // already contained
+    return;
+    }
+
+  // Grow by the size of the requested extent in the directions the stroke extends
+  int grownExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  for (int i = 0; i < 3; i++)
+    {
+    int margin = extent[2 * i + 1] - extent[2 * i] + 1;
+    grownExtent[2 * i] = extent[2 * i];
+    grownExtent[2 * i + 1] = extent[2 * i + 1];
+    if (strokeExtentValid)
+      {
+      grownExtent[2 * i] = (extent[2 * i] < strokeExtent[2 * i] ? extent[2 * i] - margin : strokeExtent[2 * i]);
+      grownExtent[2 * i + 1] = (extent[2 * i + 1] > strokeExtent[2 * i + 1] ? extent[2 * i + 1] + margin : strokeExtent[2 * i + 1]);
+      }
+    grownExtent[2 * i] = std::max(grownExtent[2 * i], this->StrokeReferenceExtent[2 * i]);
+    grownExtent[2 * i + 1] = std::min(grownExtent[2 * i + 1], this->StrokeReferenceExtent[2 * i + 1]);
+    }
+
+  if (!strokeExtentValid)
+    {
+    // Same scalar type as the default modifier labelmap
+    this->StrokeLabelmap->SetExtent(grownExtent);
+    this->StrokeLabelmap->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+    vtkOrientedImageDataResample::FillImage(this->StrokeLabelmap, q->m_EraseValue);
+    return;
+    }
+
+  vtkNew<vtkMatrix4x4> strokeImageToWorldMatrix;
+  this->StrokeLabelmap->GetImageToWorldMatrix(strokeImageToWorldMatrix);
+  vtkNew<vtkImageConstantPad> padder;
+  padder->SetInputData(this->StrokeLabelmap);
+  padder->SetOutputWholeExtent(grownExtent);
+  padder->SetConstant(q->m_EraseValue);
+  padder->Update();
+  this->StrokeLabelmap->ShallowCopy(padder->GetOutput());
+  this->StrokeLabelmap->SetGeometryFromImageToWorldMatrix(strokeImageToWorldMatrix);
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerSegmentEditorPaintEffectPrivate::updateStrokeFeedback(qMRMLWidget* viewWidget, BrushPipeline* pipeline)
+{
+  Q_Q(qSlicerSegmentEditorPaintEffect);
+  qMRMLSliceWidget* sliceWidget = qobject_cast<qMRMLSliceWidget*>(viewWidget);
+  BrushPipeline2D* pipeline2D = dynamic_cast<BrushPipeline2D*>(pipeline);
+  if (!sliceWidget || !pipeline2D)
+    {
+    return;
+    }
+  vtkMRMLSegmentationNode* segmentationNode = (q->parameterSetNode() ? q->parameterSetNode()->GetSegmentationNode() : nullptr);
+  if (!this->StrokeLabelmap || !segmentationNode)
+    {
+    pipeline2D->StrokeActor->SetVisibility(false);
+    return;
+    }
+
+  if (!this->StrokeLabelmap->GetPointData()->GetScalars())
+    {
+    // nothing has been painted yet
+    pipeline2D->StrokeActor->SetVisibility(false);
+    return;
+    }
+
+  // Show the stroke in the color of the segment that it is painted into
+  double strokeColor[4] = { 0.7, 0.7, 0.0, 0.5 };
+  const char* selectedSegmentID = q->parameterSetNode()->GetSelectedSegmentID();
+  vtkSegment* selectedSegment = nullptr;
+  if (selectedSegmentID && segmentationNode->GetSegmentation())
+    {
+    selectedSegment = segmentationNode->GetSegmentation()->GetSegment(selectedSegmentID);
+    }
+  if (selectedSegment)
+    {
+    selectedSegment->GetColor(strokeColor);
+    }
+  double currentStrokeColor[4] = { 0.0, 0.0, 0.0, 0.0 };
+  pipeline2D->StrokeLookupTable->GetTableValue(1, currentStrokeColor);
+  if (!std::equal(strokeColor, strokeColor + 4, currentStrokeColor))
+    {
+    pipeline2D->StrokeLookupTable->SetTableValue(1, strokeColor);
+    }
+
+  // Slice XY to stroke labelmap IJK transform.
+  // The reslice transform is only modified if it changed, so that the stroke is not resliced at each render.
+  vtkNew<vtkTransform> xyToImageTransform;
+  vtkNew<vtkMatrix4x4> segmentationToImageMatrix;
+  this->StrokeLabelmap->GetWorldToImageMatrix(segmentationToImageMatrix);
+  xyToImageTransform->Concatenate(segmentationToImageMatrix);
+  vtkNew<vtkMatrix4x4> worldToSegmentationTransformMatrix;
+  vtkMRMLTransformNode::GetMatrixTransformBetweenNodes(nullptr, segmentationNode->GetParentTransformNode(), worldToSegmentationTransformMatrix.GetPointer());
+  xyToImageTransform->Concatenate(worldToSegmentationTransformMatrix);
+  xyToImageTransform->Concatenate(sliceWidget->sliceLogic()->GetSliceNode()->GetXYToRAS());
+  if (!vtkOrientedImageDataResample::IsEqual(xyToImageTransform->GetMatrix(), pipeline2D->StrokeXYToImageTransform->GetMatrix()))
+    {
+    pipeline2D->StrokeXYToImageTransform->SetMatrix(xyToImageTransform->GetMatrix());
+    }
+
+  // Copy of the stroke labelmap with default origin and spacing (shares the voxel array).
+  // It is only updated when voxels have been painted since the last update, to make the reslice filter re-execute.
+  if (pipeline2D->StrokeLabelmapMTime != this->StrokeLabelmap->GetMTime()
+    || !std::equal(this->StrokeModifiedExtent, this->StrokeModifiedExtent + 6, pipeline2D->StrokeModifiedExtent))
+    {
+    pipeline2D->StrokeImage->ShallowCopy(this->StrokeLabelmap);
+    pipeline2D->StrokeImage->SetOrigin(0.0, 0.0, 0.0);
+    pipeline2D->StrokeImage->SetSpacing(1.0, 1.0, 1.0);
+    pipeline2D->StrokeReslice->SetInputData(pipeline2D->StrokeImage);
+    pipeline2D->StrokeLabelmapMTime = this->StrokeLabelmap->GetMTime();
+    std::copy(this->StrokeModifiedExtent, this->StrokeModifiedExtent + 6, pipeline2D->StrokeModifiedExtent);
+    }
+
+  int dimensions[3] = { 0, 0, 0 };
+  sliceWidget->sliceLogic()->GetSliceNode()->GetDimensions(dimensions);
+  int sliceOutputExtent[6] = { 0, dimensions[0] - 1, 0, dimensions[1] - 1, 0, dimensions[2] - 1 };
+  pipeline2D->StrokeReslice->SetOutputExtent(sliceOutputExtent);
+  pipeline2D->StrokeActor->SetVisibility(true);
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerSegmentEditorPaintEffectPrivate::updateBrushStencil(qMRMLWidget* viewWidget, vtkOrientedImageData* labelmap/*=nullptr*/)
 {
   Q_Q(qSlicerSegmentEditorPaintEffect);
   Q_UNUSED(viewWidget);
@@ -384,7 +694,7 @@ void qSlicerSegmentEditorPaintEffectPrivate::updateBrushStencil(qMRMLWidget* vie
     qCritical() << Q_FUNC_INFO << ": Invalid segmentationNode";
     return;
     }
-  vtkOrientedImageData* modifierLabelmap = q->modifierLabelmap();
+  vtkOrientedImageData* modifierLabelmap = (labelmap ? labelmap : q->modifierLabelmap());
   if (!modifierLabelmap)
     {
     qCritical() << Q_FUNC_INFO << ": Invalid modifierLabelmap";
@@ -483,8 +793,9 @@ void qSlicerSegmentEditorPaintEffectPrivate::paintPixels(
   modifierLabelmap->GetExtent(modifierExtent);
 
   vtkNew<vtkPoints> paintCoordinates_Ijk;
-  this->transformPointsFromWorldToIJK(modifierLabelmap, segmentationNode, this->PaintCoordinates_World, paintCoordinates_Ijk);
+  this->transformPointsFromWorldToIJK(modifierLabelmap, segmentationNode, pixelPositions_World, paintCoordinates_Ijk);
 
+  bool updateExtentValid = (updateExtent[0] <= updateExtent[1] && updateExtent[2] <= updateExtent[3] && updateExtent[4] <= updateExtent[5]);
   for (int pointIndex = 0; pointIndex < numberOfPoints; pointIndex++)
     {
     double ijkCoordinates[3] = { 0 };
@@ -507,14 +818,49 @@ void qSlicerSegmentEditorPaintEffectPrivate::paintPixels(
 
     for (int i = 0; i < 3; ++i)
       {
-      updateExtent[2 * i] = std::max(updateExtent[2 * i], ijk[i]);
-      updateExtent[2 * i + 1] = std::min(updateExtent[2 * i + 1], ijk[i]);
+      updateExtent[2 * i] = updateExtentValid ? std::min(updateExtent[2 * i], ijk[i]) : ijk[i];
+      updateExtent[2 * i + 1] = updateExtentValid ? std::max(updateExtent[2 * i + 1], ijk[i]) : ijk[i];
       }
+    updateExtentValid = true;
     modifierLabelmap->SetScalarComponentFromDouble(ijk[0], ijk[1], ijk[2], 0, valueToSet);
     }
   modifierLabelmap->Modified();
 }
 
+//-----------------------------------------------------------------------------
+bool qSlicerSegmentEditorPaintEffectPrivate::paintBrushesAnalytic(vtkOrientedImageData* modifierLabelmap,
+  vtkPoints* paintCoordinates_Ijk, int updateExtent[6])
+{
+  Q_Q(qSlicerSegmentEditorPaintEffect);
+
+  vtkAlgorithm* brushSource = this->BrushToWorldOriginTransformer->GetInputAlgorithm();
+  if (brushSource == this->BrushSphereSource.GetPointer())
+    {
+    this->AnalyticBrushPainter->SetBrushShapeToSphere();
+    this->AnalyticBrushPainter->SetRadius(this->BrushSphereSource->GetRadius());
+    this->AnalyticBrushPainter->SetCenter(this->BrushSphereSource->GetCenter());
+    }
+  else if (brushSource == this->BrushCylinderSource.GetPointer())
+    {
+    this->AnalyticBrushPainter->SetBrushShapeToCylinder();
+    this->AnalyticBrushPainter->SetRadius(this->BrushCylinderSource->GetRadius());
+    this->AnalyticBrushPainter->SetHeight(this->BrushCylinderSource->GetHeight());
+    this->AnalyticBrushPainter->SetCenter(this->BrushCylinderSource->GetCenter());
+    }
+  else
+    {
+    // custom brush shape
+    return false;
+    }
+
+  vtkNew<vtkMatrix4x4> brushToIjkMatrix;
+  vtkMatrix4x4::Multiply4x4(this->WorldOriginToModifierLabelmapIjkTransform->GetMatrix(),
+    this->BrushToWorldOriginTransform->GetMatrix(), brushToIjkMatrix.GetPointer());
+  this->AnalyticBrushPainter->SetBrushToIjkMatrix(brushToIjkMatrix);
+  this->AnalyticBrushPainter->SetFillValue(q->m_FillValue);
+  return this->AnalyticBrushPainter->Paint(modifierLabelmap, paintCoordinates_Ijk, updateExtent);
+}
+
 //-----------------------------------------------------------------------------
 void qSlicerSegmentEditorPaintEffectPrivate::paintBrushes(
   vtkOrientedImageData* modifierLabelmap,
@@ -522,10 +868,9 @@ void qSlicerSegmentEditorPaintEffectPrivate::paintBrushes(
   vtkPoints* pixelPositions_World,
   int updateExtent[6])
 {
-  Q_UNUSED(pixelPositions_World);
   Q_Q(qSlicerSegmentEditorPaintEffect);
 
-  this->updateBrushStencil(viewWidget);
+  this->updateBrushStencil(viewWidget, modifierLabelmap);
 
   if (!modifierLabelmap)
     {
@@ -539,14 +884,21 @@ void qSlicerSegmentEditorPaintEffectPrivate::paintBrushes(
     return;
     }
 
+  vtkNew<vtkPoints> paintCoordinates_Ijk;
+  this->transformPointsFromWorldToIJK(modifierLabelmap, segmentationNode, pixelPositions_World, paintCoordinates_Ijk);
+
+  // Sphere and cylinder brushes are written directly into the labelmap,
+  // other brush shapes are rasterized using the brush stencil.
+  if (this->paintBrushesAnalytic(modifierLabelmap, paintCoordinates_Ijk, updateExtent))
+    {
+    return;
+    }
+
   this->BrushPolyDataToStencil->Update();
   vtkImageStencilData* stencilData = this->BrushPolyDataToStencil->GetOutput();
   int stencilExtent[6]={0,-1,0,-1,0,-1};
   stencilData->GetExtent(stencilExtent);
 
-  vtkNew<vtkPoints> paintCoordinates_Ijk;
-  this->transformPointsFromWorldToIJK(modifierLabelmap, segmentationNode, this->PaintCoordinates_World, paintCoordinates_Ijk);
-
   vtkNew<vtkImageStencilToImage> stencilToImage;
   stencilToImage->SetInputConnection(this->BrushPolyDataToStencil->GetOutputPort());
   stencilToImage->SetInsideValue(q->m_FillValue);
@@ -558,7 +910,7 @@ void qSlicerSegmentEditorPaintEffectPrivate::paintBrushes(
   brushPositioner->SetOutputSpacing(modifierLabelmap->GetSpacing());
   brushPositioner->SetOutputOrigin(modifierLabelmap->GetOrigin());
 
-  vtkIdType numberOfPoints = this->PaintCoordinates_World->GetNumberOfPoints();
+  vtkIdType numberOfPoints = pixelPositions_World->GetNumberOfPoints();
   for (int pointIndex = 0; pointIndex < numberOfPoints; pointIndex++)
     {
     double* shiftDouble = paintCoordinates_Ijk->GetPoint(pointIndex);
@@ -786,6 +1138,7 @@ void qSlicerSegmentEditorPaintEffectPrivate::updateBrushModel(qMRMLWidget* viewW
 void qSlicerSegmentEditorPaintEffectPrivate::updateBrush(qMRMLWidget* viewWidget, BrushPipeline* pipeline)
 {
   Q_Q(qSlicerSegmentEditorPaintEffect);
+  this->updateStrokeFeedback(viewWidget, pipeline);
   if (this->BrushToWorldOriginTransformer->GetNumberOfInputConnections(0) == 0
       || q->integerParameter("BrushPixelMode"))
     {
@@ -889,6 +1242,7 @@ void qSlicerSegmentEditorPaintEffectPrivate::clearBrushPipelines()
         {
         q->removeActor2D(viewWidget, pipeline2D->BrushActor);
         q->removeActor2D(viewWidget, pipeline2D->FeedbackActor);
+        q->removeActor2D(viewWidget, pipeline2D->StrokeActor);
         }
       else if (pipeline3D)
         {
@@ -1011,6 +1365,7 @@ void qSlicerSegmentEditorPaintEffect::deactivate()
   Q_D(qSlicerSegmentEditorPaintEffect);
   Superclass::deactivate();
   d->IsPainting = false;
+  d->StrokeLabelmap = nullptr;
   d->clearBrushPipelines();
   d->PaintCoordinates_World->Reset();
   d->ActiveViewWidget = nullptr;
@@ -1703,7 +2058,14 @@ void qSlicerSegmentEditorPaintEffect::paintApply(qMRMLWidget* viewWidget)
 {
   Q_D(qSlicerSegmentEditorPaintEffect);
 
-  vtkOrientedImageData* modifierLabelmap = this->defaultModifierLabelmap();
+  // If a paint stroke is in progress then its points have been painted into the stroke labelmap already
+  bool strokePainted = (d->StrokeLabelmap != nullptr);
+  if (strokePainted)
+    {
+    d->paintStroke(viewWidget);
+    }
+  vtkSmartPointer<vtkOrientedImageData> modifierLabelmap = strokePainted ? d->StrokeLabelmap.GetPointer() : this->defaultModifierLabelmap();
+  d->StrokeLabelmap = nullptr;
   if (!modifierLabelmap)
     {
     qCritical() << Q_FUNC_INFO << ": Invalid modifier labelmap";
@@ -1721,18 +2083,32 @@ void qSlicerSegmentEditorPaintEffect::paintApply(qMRMLWidget* viewWidget)
     return;
     }
 
-  this->saveStateForUndo();
-
   QList<int> updateExtentList;
   int updateExtent[6] = { 0, -1, 0, -1, 0, -1 };
 
-  if (this->integerParameter("BrushPixelMode"))
+  if (strokePainted)
     {
-    d->paintPixels(modifierLabelmap, d->PaintCoordinates_World, updateExtent);
+    std::copy(d->StrokeModifiedExtent, d->StrokeModifiedExtent + 6, updateExtent);
+    if (updateExtent[0] > updateExtent[1] || updateExtent[2] > updateExtent[3] || updateExtent[4] > updateExtent[5])
+      {
+      // no voxels were painted by the stroke, there is nothing to commit
+      d->clearBrushPipelines();
+      d->PaintCoordinates_World->Reset();
+      return;
+      }
+    this->saveStateForUndo();
     }
   else
     {
-    d->paintBrushes(modifierLabelmap, viewWidget, d->PaintCoordinates_World, updateExtent);
+    this->saveStateForUndo();
+    if (this->integerParameter("BrushPixelMode"))
+      {
+      d->paintPixels(modifierLabelmap, d->PaintCoordinates_World, updateExtent);
+      }
+    else
+      {
+      d->paintBrushes(modifierLabelmap, viewWidget, d->PaintCoordinates_World, updateExtent);
+      }
     }
 
   int modifierExtent[6] = { 0,-1,0,-1,0,-1 };
@@ -1786,6 +2162,7 @@ QList<int> qSlicerSegmentEditorPaintEffect::paintBrushesIntoLabelmap(vtkOriented
 void qSlicerSegmentEditorPaintEffect::clearBrushes()
 {
   Q_D(qSlicerSegmentEditorPaintEffect);
+  d->StrokeLabelmap = nullptr;
   // Rendering the feedback actor with no points will result in an error message that will clutter the log.
   // "No input data"
   d->clearBrushPipelines();
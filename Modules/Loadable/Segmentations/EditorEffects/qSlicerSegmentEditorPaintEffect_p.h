@@ -65,6 +65,7 @@ class vtkGlyph3D;
 class vtkPoints;
 class vtkPolyDataNormals;
 class vtkPolyDataToImageStencil;
+class vtkSlicerAnalyticBrushPainter;
 
 /// \ingroup SlicerRt_QtModules_Segmentations
 /// \brief Private implementation of the segment editor paint effect
@@ -85,9 +86,20 @@ public:
   /// that connects the current and last brush position, to ensure a smooth and continuous brush stroke.
   void paintAddPoint(qMRMLWidget* viewWidget, double pixelPositionWorld[3], double* lastBrushPosition_World=nullptr);
 
+  /// Paint the points that were added since the last call into the stroke labelmap.
+  /// The segment is not modified, the stroke labelmap is applied to the segment when the stroke is completed.
+  void paintStroke(qMRMLWidget* viewWidget);
+
+  /// Extend the stroke labelmap to contain the extent. Voxels are only allocated in the region that
+  /// the stroke has reached, the labelmap is grown with some margin to avoid reallocation at each point.
+  void growStrokeLabelmap(const int extent[6]);
+
   /// Update paint circle glyph
   void updateBrush(qMRMLWidget* viewWidget, BrushPipeline* brush);
 
+  /// Show the stroke labelmap in slice views
+  void updateStrokeFeedback(qMRMLWidget* viewWidget, BrushPipeline* brush);
+
   /// Update brushes
   void updateBrushes();
 
@@ -95,8 +107,8 @@ public:
   void updateBrushModel(qMRMLWidget* viewWidget, double brushPosition_World[3]);
 
   /// Updates the brush stencil that can be used to quickly paint the brush shape into
-  /// modifierLabelmap at many different positions.
-  void updateBrushStencil(qMRMLWidget* viewWidget);
+  /// labelmap (modifierLabelmap if not specified) at many different positions.
+  void updateBrushStencil(qMRMLWidget* viewWidget, vtkOrientedImageData* labelmap=nullptr);
 
 protected:
   /// Get brush object for widget. Create if does not exist
@@ -108,6 +120,11 @@ protected:
   /// Paint brushes to the modifier labelmap
   void paintBrushes(vtkOrientedImageData* modifierLabelmap, qMRMLWidget* viewWidget, vtkPoints* pixelPositions_World, int extent[6]=nullptr);
 
+  /// Paint sphere or cylinder brushes to the modifier labelmap by evaluating the brush shape at each voxel
+  /// in the bounding box of the brushes. The brush is swept between successive positions of a stroke.
+  /// Returns false if the brush shape or labelmap is not supported, in this case nothing is painted.
+  bool paintBrushesAnalytic(vtkOrientedImageData* modifierLabelmap, vtkPoints* paintCoordinates_Ijk, int updateExtent[6]);
+
   /// Paint one pixel at coordinate
   void paintPixel(vtkOrientedImageData* modifierLabelmap, qMRMLWidget* viewWidget, double pixelPosition_World[3]);
 
@@ -146,6 +163,7 @@ public:
   vtkSmartPointer<vtkTransformPolyDataFilter> WorldOriginToModifierLabelmapIjkTransformer;
   vtkSmartPointer<vtkTransform> WorldOriginToModifierLabelmapIjkTransform; // transforms from polydata source to modifierLabelmap's IJK coordinate system (brush origin in IJK origin)
   vtkSmartPointer<vtkPolyDataToImageStencil> BrushPolyDataToStencil;
+  vtkSmartPointer<vtkSlicerAnalyticBrushPainter> AnalyticBrushPainter;
 
   vtkSmartPointer<vtkGlyph3D> FeedbackGlyphFilter;
 
@@ -171,6 +189,17 @@ public:
   bool DelayedPaint;
   bool IsPainting;
 
+  /// Modifier labelmap that the points of the paint stroke in progress are painted into
+  /// if paint is not delayed. Set to nullptr when there is no stroke in progress.
+  /// It has the geometry of the default modifier labelmap, cropped to the region of the stroke.
+  vtkSmartPointer<vtkOrientedImageData> StrokeLabelmap;
+  /// Extent of the default modifier labelmap, the stroke labelmap is not grown beyond it
+  int StrokeReferenceExtent[6];
+  /// Number of points of PaintCoordinates_World already painted into the stroke labelmap
+  vtkIdType StrokeNumberOfPaintedPoints;
+  /// Extent of the stroke labelmap that the stroke has painted into
+  int StrokeModifiedExtent[6];
+
   // Observed view node
   qMRMLWidget* ActiveViewWidget;
   int ActiveViewLastInteractionPosition[2];
@@ -1,7 +1,15 @@
 #include "vtkImageGrowCutSegment.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
 #include <iostream>
 #include <limits>
+#include <map>
+#include <memory>
+#include <new>
+#include <set>
 #include <vector>
 
 #include <vtkInformation.h>
@@ -9,6 +17,8 @@
 #include <vtkMath.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
+#include <vtkSMPThreadLocal.h>
+#include <vtkSMPTools.h>
 #include <vtkSmartPointer.h>
 #include <vtkStreamingDemandDrivenPipeline.h>
 #include <vtkTimerLog.h>
@@ -27,6 +37,58 @@ const int MaskPixelTypeID = VTK_UNSIGNED_CHAR;
 const NodeKeyValueType DIST_INF = std::numeric_limits<NodeKeyValueType>::max();
 const NodeKeyValueType DIST_EPSILON = 1e-3;
 
+//----------------------------------------------------------------------------
+// In the multithreaded computation the state of each voxel is stored in a single 64-bit key,
+// so that distance and label can be updated together by an atomic compare-and-swap:
+// - bits 32-63: distance (non-negative float values are ordered the same way as their bit patterns)
+// - bit 31: set if the voxel can be relabeled (cleared for seeds and masked voxels)
+// - bits 0-30: index of the label in the label value table (0 is reserved for unlabeled and masked voxels)
+// Smaller key means shorter distance. At equal distance the smaller label index wins, which makes
+// the result independent from the order of processing.
+typedef vtkTypeUInt64 NodeKeyType;
+const NodeKeyType NODE_KEY_RELABELABLE = 0x80000000u;
+const NodeKeyType NODE_KEY_LABEL_INDEX_MASK = 0x7FFFFFFFu;
+
+static_assert(sizeof(NodeKeyValueType) == sizeof(vtkTypeUInt32), "NodeKeyValueType must be a 32-bit float");
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+inline NodeKeyType PackNodeKey(NodeKeyValueType distance, bool relabelable, vtkTypeUInt32 labelIndex)
+{
+  vtkTypeUInt32 distanceBits = 0;
+  memcpy(&distanceBits, &distance, sizeof(distanceBits));
+  return (static_cast<NodeKeyType>(distanceBits) << 32) | (relabelable ? NODE_KEY_RELABELABLE : 0) | labelIndex;
+}
+
+//----------------------------------------------------------------------------
+inline NodeKeyValueType GetNodeKeyDistance(NodeKeyType key)
+{
+  vtkTypeUInt32 distanceBits = static_cast<vtkTypeUInt32>(key >> 32);
+  NodeKeyValueType distance = 0;
+  memcpy(&distance, &distanceBits, sizeof(distance));
+  return distance;
+}
+
+//----------------------------------------------------------------------------
+inline vtkTypeUInt32 GetNodeKeyLabelIndex(NodeKeyType key)
+{
+  return static_cast<vtkTypeUInt32>(key & NODE_KEY_LABEL_INDEX_MASK);
+}
+
+//----------------------------------------------------------------------------
+// Voxel waiting for its neighbors to be updated. Key is stored to detect if the voxel has been
+// updated since it was queued (then the entry is ignored, as the voxel is queued again).
+struct FrontierEntry
+{
+  NodeIndexType Index;
+  NodeKeyType Key;
+};
+typedef std::vector<FrontierEntry> FrontierType;
+
+} // end of anonymous namespace
+
 //----------------------------------------------------------------------------
 class vtkImageGrowCutSegment::vtkInternal
 {
@@ -36,18 +98,34 @@ public:
 
   void Reset();
 
+  void InitializeNeighborhood(double* spacing, double distancePenalty, bool memoryOrder);
+
   template<typename IntensityPixelType, typename LabelPixelType>
   bool InitializationAHP(vtkImageData *intensityVolume, vtkImageData *seedLabelVolume, vtkImageData *maskLabelVolume, double distancePenalty);
 
   template<typename IntensityPixelType, typename LabelPixelType>
   void DijkstraBasedClassificationAHP(vtkImageData *intensityVolume, vtkImageData *seedLabelVolume, vtkImageData *maskLabelVolume);
 
+  template<typename LabelPixelType>
+  bool InitializationParallel(vtkImageData *seedLabelVolume, vtkImageData *maskLabelVolume, double distancePenalty,
+    int updateRegionMargin, FrontierType& seeds, int updateRegion[6]);
+
+  template<typename IntensityPixelType>
+  NodeKeyValueType EstimateBucketWidth(vtkImageData *intensityVolume);
+
+  template<typename IntensityPixelType>
+  void ShortestPathClassificationParallel(vtkImageData *intensityVolume, FrontierType& seeds, const int updateRegion[6]);
+
+  template<typename LabelPixelType>
+  void UpdateResultLabelVolumeParallel(const int updateRegion[6]);
+
   template <class SourceVolType>
   bool ExecuteGrowCut(vtkImageData *intensityVolume, vtkImageData *seedLabelVolume, vtkImageData *maskLabelVolume,
-    vtkImageData *resultLabelVolume, double distancePenalty);
+    vtkImageData *resultLabelVolume, double distancePenalty, bool multithreaded, int updateRegionMargin);
 
   template< class SourceVolType, class SeedVolType>
-  bool ExecuteGrowCut2(vtkImageData *intensityVolume, vtkImageData *seedLabelVolume, vtkImageData *maskLabelVolume, double distancePenalty);
+  bool ExecuteGrowCut2(vtkImageData *intensityVolume, vtkImageData *seedLabelVolume, vtkImageData *maskLabelVolume,
+    double distancePenalty, int updateRegionMargin);
 
   // Stores the shortest distance from known labels to each point
   // If a point is set to DIST_INF then that point will modified, as a shorter distance path will be found.
@@ -65,11 +143,17 @@ public:
 
   std::vector<NodeIndexType> m_NeighborIndexOffsets;
   std::vector<double> m_NeighborDistancePenalties;
+  std::vector<std::array<int, 3> > m_NeighborIjkOffsets;
   std::vector<unsigned char> m_NumberOfNeighbors; // size of neighborhood (everywhere the same except at the image boundary)
 
   FibHeap *m_Heap;
   FibHeapNode *m_HeapNodes; // a node is stored for each voxel
   bool m_bSegInitialized;
+
+  // Multithreaded computation (used instead of m_DistanceVolume, m_Heap, and m_HeapNodes)
+  bool m_Multithreaded;
+  std::unique_ptr<std::atomic<NodeKeyType>[]> m_NodeKeys; // a key is stored for each voxel
+  std::vector<double> m_LabelValues; // label value of each label index
 };
 
 //-----------------------------------------------------------------------------
@@ -79,6 +163,7 @@ vtkImageGrowCutSegment::vtkInternal::vtkInternal()
   m_Heap = nullptr;
   m_HeapNodes = nullptr;
   m_bSegInitialized = false;
+  m_Multithreaded = false;
   m_DistanceVolume = vtkSmartPointer<vtkImageData>::New();
   m_ResultLabelVolume = vtkSmartPointer<vtkImageData>::New();
 };
@@ -105,6 +190,69 @@ void vtkImageGrowCutSegment::vtkInternal::Reset()
   m_bSegInitialized = false;
   m_DistanceVolume->Initialize();
   m_ResultLabelVolume->Initialize();
+  m_NodeKeys.reset();
+  m_LabelValues.clear();
+}
+
+//-----------------------------------------------------------------------------
+void vtkImageGrowCutSegment::vtkInternal::InitializeNeighborhood(double* spacing, double distancePenalty, bool memoryOrder)
+{
+  // Compute index offset
+  m_DistancePenalty = distancePenalty;
+  m_NeighborIndexOffsets.clear();
+  m_NeighborDistancePenalties.clear();
+  m_NeighborIjkOffsets.clear();
+  // In Dijkstra's algorithm neighbors are traversed in the order of m_NeighborIndexOffsets,
+  // therefore one would expect that the offsets should
+  // be as continuous as possible (e.g., x coordinate
+  // should change most quickly), but that resulted in
+  // about 5-6% longer computation time. Therefore,
+  // we put indices in order x1y1z1, x1y1z2, x1y1z3, etc.
+  // In the multithreaded computation many voxels are processed at once and memory access
+  // dominates, therefore the offsets are put in increasing memory order (memoryOrder=true).
+  for (long i = -1; i <= 1; i++)
+    {
+    for (long j = -1; j <= 1; j++)
+      {
+      for (long k = -1; k <= 1; k++)
+        {
+        long ix = memoryOrder ? k : i;
+        long iy = j;
+        long iz = memoryOrder ? i : k;
+        if (ix == 0 && iy == 0 && iz == 0)
+          {
+          continue;
+          }
+        m_NeighborIndexOffsets.push_back(ix + long(m_DimX)*(iy + long(m_DimY)*iz));
+        m_NeighborDistancePenalties.push_back(this->m_DistancePenalty * sqrt((spacing[0] * ix) * (spacing[0] * ix)
+          + (spacing[1] * iy) * (spacing[1] * iy) + (spacing[2] * iz) * (spacing[2] * iz)));
+        m_NeighborIjkOffsets.push_back({ { static_cast<int>(ix), static_cast<int>(iy), static_cast<int>(iz) } });
+        }
+      }
+    }
+
+  // Determine neighborhood size for computation at each voxel.
+  // The neighborhood size is everywhere the same (size of m_NeighborIndexOffsets)
+  // except at the edges of the volume, where the neighborhood size is 0.
+  NodeIndexType dimXYZ = m_DimX * m_DimY * m_DimZ;
+  m_NumberOfNeighbors.resize(dimXYZ);
+  const unsigned char numberOfNeighbors = static_cast<unsigned char>(m_NeighborIndexOffsets.size());
+  unsigned char* nbSizePtr = &(m_NumberOfNeighbors[0]);
+  for (NodeIndexType z = 0; z < m_DimZ; z++)
+    {
+    bool zEdge = (z == 0 || z == m_DimZ - 1);
+    for (NodeIndexType y = 0; y < m_DimY; y++)
+      {
+      bool yEdge = (y == 0 || y == m_DimY - 1);
+      *(nbSizePtr++) = 0; // x == 0 (there is always padding, so we don't need to check if m_DimX>0)
+      unsigned char nbSize = (zEdge || yEdge) ? 0 : numberOfNeighbors;
+      for (NodeIndexType x = m_DimX-2; x > 0; x--)
+        {
+        *(nbSizePtr++) = nbSize;
+        }
+      *(nbSizePtr++) = 0; // x == m_DimX-1 (there is always padding, so we don't need to check if m_DimX>1)
+      }
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -160,55 +308,7 @@ bool vtkImageGrowCutSegment::vtkInternal::InitializationAHP(
     LabelPixelType* resultLabelVolumePtr = static_cast<LabelPixelType*>(m_ResultLabelVolume->GetScalarPointer());
     NodeKeyValueType* distanceVolumePtr = static_cast<NodeKeyValueType*>(m_DistanceVolume->GetScalarPointer());
 
-    // Compute index offset
-    m_DistancePenalty = distancePenalty;
-    m_NeighborIndexOffsets.clear();
-    m_NeighborDistancePenalties.clear();
-    // Neighbors are traversed in the order of m_NeighborIndexOffsets,
-    // therefore one would expect that the offsets should
-    // be as continuous as possible (e.g., x coordinate
-    // should change most quickly), but that resulted in
-    // about 5-6% longer computation time. Therefore,
-    // we put indices in order x1y1z1, x1y1z2, x1y1z3, etc.
-    double* spacing = seedLabelVolume->GetSpacing();
-    for (long ix = -1; ix <= 1; ix++)
-    {
-      for (long iy = -1; iy <= 1; iy++)
-      {
-        for (long iz = -1; iz <= 1; iz++)
-        {
-          if (ix == 0 && iy == 0 && iz == 0)
-            {
-            continue;
-            }
-          m_NeighborIndexOffsets.push_back(ix + long(m_DimX)*(iy + long(m_DimY)*iz));
-          m_NeighborDistancePenalties.push_back(this->m_DistancePenalty * sqrt((spacing[0] * ix) * (spacing[0] * ix)
-            + (spacing[1] * iy) * (spacing[1] * iy) + (spacing[2] * iz) * (spacing[2] * iz)));
-          }
-        }
-      }
-
-    // Determine neighborhood size for computation at each voxel.
-    // The neighborhood size is everywhere the same (size of m_NeighborIndexOffsets)
-    // except at the edges of the volume, where the neighborhood size is 0.
-    m_NumberOfNeighbors.resize(dimXYZ);
-    const unsigned char numberOfNeighbors = static_cast<unsigned char>(m_NeighborIndexOffsets.size());
-    unsigned char* nbSizePtr = &(m_NumberOfNeighbors[0]);
-    for (NodeIndexType z = 0; z < m_DimZ; z++)
-      {
-      bool zEdge = (z == 0 || z == m_DimZ - 1);
-      for (NodeIndexType y = 0; y < m_DimY; y++)
-        {
-        bool yEdge = (y == 0 || y == m_DimY - 1);
-        *(nbSizePtr++) = 0; // x == 0 (there is always padding, so we don't need to check if m_DimX>0)
-        unsigned char nbSize = (zEdge || yEdge) ? 0 : numberOfNeighbors;
-        for (NodeIndexType x = m_DimX-2; x > 0; x--)
-          {
-          *(nbSizePtr++) = nbSize;
-          }
-        *(nbSizePtr++) = 0; // x == m_DimX-1 (there is always padding, so we don'neighborNewDistance need to check if m_DimX>1)
-        }
-      }
+    this->InitializeNeighborhood(seedLabelVolume->GetSpacing(), distancePenalty, false);
 
     if (!maskLabelVolumePtr)
       {
@@ -403,10 +503,349 @@ void vtkImageGrowCutSegment::vtkInternal::DijkstraBasedClassificationAHP(
   m_HeapNodes = nullptr;
 }
 
+//-----------------------------------------------------------------------------
+template<typename LabelPixelType>
+bool vtkImageGrowCutSegment::vtkInternal::InitializationParallel(
+    vtkImageData *seedLabelVolume,
+    vtkImageData *maskLabelVolume,
+    double distancePenalty,
+    int updateRegionMargin,
+    FrontierType& seeds,
+    int updateRegion[6])
+{
+  NodeIndexType dimXYZ = m_DimX * m_DimY * m_DimZ;
+  const LabelPixelType* seedLabelVolumePtr = static_cast<LabelPixelType*>(seedLabelVolume->GetScalarPointer());
+  const MaskPixelType* maskLabelVolumePtr = nullptr;
+  if (maskLabelVolume != nullptr)
+    {
+    maskLabelVolumePtr = static_cast<MaskPixelType*>(maskLabelVolume->GetScalarPointer());
+    }
+
+  const bool initialized = m_bSegInitialized;
+  if (!initialized)
+    {
+    m_ResultLabelVolume->SetOrigin(seedLabelVolume->GetOrigin());
+    m_ResultLabelVolume->SetSpacing(seedLabelVolume->GetSpacing());
+    m_ResultLabelVolume->SetExtent(seedLabelVolume->GetExtent());
+    m_ResultLabelVolume->AllocateScalars(seedLabelVolume->GetScalarType(), 1);
+    m_NodeKeys.reset(new (std::nothrow) std::atomic<NodeKeyType>[dimXYZ]);
+    if (!m_NodeKeys)
+      {
+      vtkGenericWarningMacro("Memory allocation failed. Dimensions: " << m_DimX << "x" << m_DimY << "x" << m_DimZ);
+      return false;
+      }
+    this->InitializeNeighborhood(seedLabelVolume->GetSpacing(), distancePenalty, true);
+    m_LabelValues.assign(1, 0.0);
+    }
+
+  // Assign label index to each seed label value. Indices of label values of previous computations are kept.
+  vtkSMPThreadLocal<std::set<LabelPixelType> > localLabelValues;
+  auto collectLabelValues = [&](vtkIdType begin, vtkIdType end)
+    {
+    std::set<LabelPixelType>& labelValues = localLabelValues.Local();
+    LabelPixelType lastLabelValue = 0;
+    for (vtkIdType index = begin; index < end; ++index)
+      {
+      LabelPixelType seedValue = seedLabelVolumePtr[index];
+      if (seedValue != 0 && seedValue != lastLabelValue)
+        {
+        labelValues.insert(seedValue);
+        lastLabelValue = seedValue;
+        }
+      }
+    };
+  vtkSMPTools::For(0, static_cast<vtkIdType>(dimXYZ), collectLabelValues);
+  std::map<LabelPixelType, vtkTypeUInt32> labelIndices;
+  for (size_t labelIndex = 1; labelIndex < m_LabelValues.size(); ++labelIndex)
+    {
+    labelIndices[static_cast<LabelPixelType>(m_LabelValues[labelIndex])] = static_cast<vtkTypeUInt32>(labelIndex);
+    }
+  for (auto labelValuesIt = localLabelValues.begin(); labelValuesIt != localLabelValues.end(); ++labelValuesIt)
+    {
+    for (LabelPixelType labelValue : *labelValuesIt)
+      {
+      if (labelIndices.find(labelValue) != labelIndices.end())
+        {
+        continue;
+        }
+      if (m_LabelValues.size() > NODE_KEY_LABEL_INDEX_MASK)
+        {
+        vtkGenericWarningMacro("vtkImageGrowCutSegment: too many different seed label values");
+        return false;
+        }
+      labelIndices[labelValue] = static_cast<vtkTypeUInt32>(m_LabelValues.size());
+      m_LabelValues.push_back(static_cast<double>(labelValue));
+      }
+    }
+
+  // Initialize keys and collect new/changed seeds, which labels will be propagated from
+  std::atomic<NodeKeyType>* nodeKeys = m_NodeKeys.get();
+  vtkSMPThreadLocal<FrontierType> localSeeds;
+  auto initializeNodeKeys = [&](vtkIdType begin, vtkIdType end)
+    {
+    FrontierType& newSeeds = localSeeds.Local();
+    LabelPixelType lastLabelValue = 0;
+    vtkTypeUInt32 lastLabelIndex = 0;
+    for (vtkIdType voxelIndex = begin; voxelIndex < end; ++voxelIndex)
+      {
+      NodeIndexType index = static_cast<NodeIndexType>(voxelIndex);
+      if (maskLabelVolumePtr && maskLabelVolumePtr[index] != 0)
+        {
+        // Masked region: small distance will prevent overwriting of masked voxels
+        // and they are not added to the frontier to exclude them from region growing.
+        if (!initialized)
+          {
+          nodeKeys[index].store(PackNodeKey(DIST_EPSILON, false, 0), std::memory_order_relaxed);
+          }
+        continue;
+        }
+      LabelPixelType seedValue = seedLabelVolumePtr[index];
+      if (seedValue == 0)
+        {
+        if (!initialized)
+          {
+          nodeKeys[index].store(PackNodeKey(DIST_INF, true, 0), std::memory_order_relaxed);
+          }
+        continue;
+        }
+      if (seedValue != lastLabelValue)
+        {
+        lastLabelValue = seedValue;
+        lastLabelIndex = labelIndices.find(seedValue)->second;
+        }
+      NodeKeyType seedKey = PackNodeKey(DIST_EPSILON, false, lastLabelIndex);
+      if (initialized && nodeKeys[index].load(std::memory_order_relaxed) == seedKey)
+        {
+        // Old seeds will be completely ignored in updates, as their labels have been already propagated
+        // and their value cannot changed (because their value is prescribed).
+        continue;
+        }
+      nodeKeys[index].store(seedKey, std::memory_order_relaxed);
+      newSeeds.push_back({ index, seedKey });
+      }
+    };
+  vtkSMPTools::For(0, static_cast<vtkIdType>(dimXYZ), initializeNodeKeys);
+
+  seeds.clear();
+  for (auto seedsIt = localSeeds.begin(); seedsIt != localSeeds.end(); ++seedsIt)
+    {
+    seeds.insert(seeds.end(), seedsIt->begin(), seedsIt->end());
+    }
+
+  updateRegion[0] = 0;
+  updateRegion[1] = static_cast<int>(m_DimX) - 1;
+  updateRegion[2] = 0;
+  updateRegion[3] = static_cast<int>(m_DimY) - 1;
+  updateRegion[4] = 0;
+  updateRegion[5] = static_cast<int>(m_DimZ) - 1;
+  if (initialized && updateRegionMargin >= 0)
+    {
+    // Only update the neighborhood of new/changed seeds
+    int seedsExtent[6] = { VTK_INT_MAX, VTK_INT_MIN, VTK_INT_MAX, VTK_INT_MIN, VTK_INT_MAX, VTK_INT_MIN };
+    for (const FrontierEntry& seed : seeds)
+      {
+      int ijk[3] =
+        {
+        static_cast<int>(seed.Index % m_DimX),
+        static_cast<int>((seed.Index / m_DimX) % m_DimY),
+        static_cast<int>(seed.Index / (m_DimX * m_DimY))
+        };
+      for (int axis = 0; axis < 3; ++axis)
+        {
+        seedsExtent[axis * 2] = std::min(seedsExtent[axis * 2], ijk[axis]);
+        seedsExtent[axis * 2 + 1] = std::max(seedsExtent[axis * 2 + 1], ijk[axis]);
+        }
+      }
+    for (int axis = 0; axis < 3; ++axis)
+      {
+      updateRegion[axis * 2] = std::max(updateRegion[axis * 2], seedsExtent[axis * 2] - updateRegionMargin);
+      updateRegion[axis * 2 + 1] = std::min(updateRegion[axis * 2 + 1], seedsExtent[axis * 2 + 1] + updateRegionMargin);
+      }
+    }
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+template<typename IntensityPixelType>
+NodeKeyValueType vtkImageGrowCutSegment::vtkInternal::EstimateBucketWidth(vtkImageData *intensityVolume)
+{
+  // Delta-stepping is efficient if the bucket width is about the average edge weight:
+  // with wider buckets voxels are more often updated multiple times,
+  // with narrower buckets less voxels can be processed in parallel.
+  const IntensityPixelType* imSrc = static_cast<IntensityPixelType*>(intensityVolume->GetScalarPointer());
+  NodeIndexType dimXYZ = m_DimX * m_DimY * m_DimZ;
+  const NodeIndexType numberOfSampledVoxels = 10000;
+  NodeIndexType sampleStep = std::max<NodeIndexType>(1, dimXYZ / numberOfSampledVoxels);
+  double sumWeights = 0.0;
+  vtkIdType numberOfWeights = 0;
+  for (NodeIndexType index = 0; index < dimXYZ; index += sampleStep)
+    {
+    NodeKeyValueType pixCenter = imSrc[index];
+    unsigned char nbSize = m_NumberOfNeighbors[index];
+    for (unsigned char i = 0; i < nbSize; i++)
+      {
+      sumWeights += fabs(pixCenter - imSrc[index + m_NeighborIndexOffsets[i]]) + m_NeighborDistancePenalties[i];
+      numberOfWeights++;
+      }
+    }
+  if (numberOfWeights == 0)
+    {
+    return DIST_EPSILON;
+    }
+  return std::max(static_cast<NodeKeyValueType>(sumWeights / numberOfWeights), DIST_EPSILON);
+}
+
+//-----------------------------------------------------------------------------
+template<typename IntensityPixelType>
+void vtkImageGrowCutSegment::vtkInternal::ShortestPathClassificationParallel(
+    vtkImageData *intensityVolume,
+    FrontierType& seeds,
+    const int updateRegion[6])
+{
+  const IntensityPixelType* imSrc = static_cast<IntensityPixelType*>(intensityVolume->GetScalarPointer());
+  std::atomic<NodeKeyType>* nodeKeys = m_NodeKeys.get();
+  const bool limitRegion = (updateRegion[0] > 0 || updateRegion[1] < static_cast<int>(m_DimX) - 1
+    || updateRegion[2] > 0 || updateRegion[3] < static_cast<int>(m_DimY) - 1
+    || updateRegion[4] > 0 || updateRegion[5] < static_cast<int>(m_DimZ) - 1);
+
+  // Delta-stepping: voxels are sorted into buckets by distance, voxels of the lowest bucket are processed in parallel.
+  // Voxels are not removed from buckets when their distance is decreased, instead they are added again,
+  // and the outdated entry is ignored (its key does not match the current key of the voxel).
+  const double bucketWidth = this->EstimateBucketWidth<IntensityPixelType>(intensityVolume);
+  auto getBucketIndex = [bucketWidth](NodeKeyType key)
+    {
+    return static_cast<vtkTypeUInt64>(std::min(GetNodeKeyDistance(key) / bucketWidth, 1e18));
+    };
+  std::map<vtkTypeUInt64, FrontierType> buckets;
+  for (const FrontierEntry& seed : seeds)
+    {
+    buckets[getBucketIndex(seed.Key)].push_back(seed);
+    }
+
+  vtkSMPThreadLocal<FrontierType> localUpdatedNodes;
+  FrontierType frontier;
+  while (!buckets.empty())
+    {
+    auto bucketIt = buckets.begin();
+    const vtkTypeUInt64 currentBucketIndex = bucketIt->first;
+    frontier.swap(bucketIt->second);
+    buckets.erase(bucketIt);
+
+    // Voxels may be added to the current bucket again while it is processed (edges shorter than the bucket width),
+    // therefore the bucket is processed until it becomes empty.
+    while (!frontier.empty())
+      {
+      auto relaxFrontier = [&](vtkIdType begin, vtkIdType end)
+        {
+        FrontierType& updatedNodes = localUpdatedNodes.Local();
+        for (vtkIdType frontierIndex = begin; frontierIndex < end; ++frontierIndex)
+          {
+          const NodeIndexType index = frontier[frontierIndex].Index;
+          const NodeKeyType key = frontier[frontierIndex].Key;
+          if (nodeKeys[index].load(std::memory_order_relaxed) != key)
+            {
+            // outdated entry, the voxel has been queued again with a shorter distance
+            continue;
+            }
+          NodeKeyValueType currentDistance = GetNodeKeyDistance(key);
+          vtkTypeUInt32 currentLabelIndex = GetNodeKeyLabelIndex(key);
+          int ijk[3] = { 0, 0, 0 };
+          if (limitRegion)
+            {
+            ijk[0] = static_cast<int>(index % m_DimX);
+            ijk[1] = static_cast<int>((index / m_DimX) % m_DimY);
+            ijk[2] = static_cast<int>(index / (m_DimX * m_DimY));
+            }
+
+          // Update neighbors
+          NodeKeyValueType pixCenter = imSrc[index];
+          unsigned char nbSize = m_NumberOfNeighbors[index];
+          for (unsigned char i = 0; i < nbSize; i++)
+            {
+            if (limitRegion)
+              {
+              const std::array<int, 3>& ijkOffset = m_NeighborIjkOffsets[i];
+              if (ijk[0] + ijkOffset[0] < updateRegion[0] || ijk[0] + ijkOffset[0] > updateRegion[1]
+                || ijk[1] + ijkOffset[1] < updateRegion[2] || ijk[1] + ijkOffset[1] > updateRegion[3]
+                || ijk[2] + ijkOffset[2] < updateRegion[4] || ijk[2] + ijkOffset[2] > updateRegion[5])
+                {
+                continue;
+                }
+              }
+            NodeIndexType indexNgbh = index + m_NeighborIndexOffsets[i];
+            NodeKeyValueType neighborNewDistance = fabs(pixCenter - imSrc[indexNgbh]) + currentDistance + m_NeighborDistancePenalties[i];
+            NodeKeyType neighborNewKey = PackNodeKey(neighborNewDistance, true, currentLabelIndex);
+            NodeKeyType neighborCurrentKey = nodeKeys[indexNgbh].load(std::memory_order_relaxed);
+            while (neighborNewKey < neighborCurrentKey)
+              {
+              if (nodeKeys[indexNgbh].compare_exchange_weak(neighborCurrentKey, neighborNewKey, std::memory_order_relaxed))
+                {
+                updatedNodes.push_back({ indexNgbh, neighborNewKey });
+                break;
+                }
+              }
+            }
+          }
+        };
+      vtkSMPTools::For(0, static_cast<vtkIdType>(frontier.size()), 256, relaxFrontier);
+
+      frontier.clear();
+      for (auto updatedNodesIt = localUpdatedNodes.begin(); updatedNodesIt != localUpdatedNodes.end(); ++updatedNodesIt)
+        {
+        for (const FrontierEntry& updatedNode : *updatedNodesIt)
+          {
+          vtkTypeUInt64 bucketIndex = getBucketIndex(updatedNode.Key);
+          if (bucketIndex <= currentBucketIndex)
+            {
+            frontier.push_back(updatedNode);
+            }
+          else
+            {
+            buckets[bucketIndex].push_back(updatedNode);
+            }
+          }
+        updatedNodesIt->clear();
+        }
+      }
+    }
+}
+
+//-----------------------------------------------------------------------------
+template<typename LabelPixelType>
+void vtkImageGrowCutSegment::vtkInternal::UpdateResultLabelVolumeParallel(const int updateRegion[6])
+{
+  if (updateRegion[0] > updateRegion[1] || updateRegion[2] > updateRegion[3] || updateRegion[4] > updateRegion[5])
+    {
+    return;
+    }
+  LabelPixelType* resultLabelVolumePtr = static_cast<LabelPixelType*>(m_ResultLabelVolume->GetScalarPointer());
+  const std::atomic<NodeKeyType>* nodeKeys = m_NodeKeys.get();
+  const double* labelValues = m_LabelValues.data();
+  auto updateResultLabels = [&](vtkIdType beginZ, vtkIdType endZ)
+    {
+    for (vtkIdType z = beginZ; z < endZ; ++z)
+      {
+      for (int y = updateRegion[2]; y <= updateRegion[3]; ++y)
+        {
+        NodeIndexType index = (static_cast<NodeIndexType>(z) * m_DimY + static_cast<NodeIndexType>(y)) * m_DimX
+          + static_cast<NodeIndexType>(updateRegion[0]);
+        for (int x = updateRegion[0]; x <= updateRegion[1]; ++x, ++index)
+          {
+          resultLabelVolumePtr[index] = static_cast<LabelPixelType>(
+            labelValues[GetNodeKeyLabelIndex(nodeKeys[index].load(std::memory_order_relaxed))]);
+          }
+        }
+      }
+    };
+  vtkSMPTools::For(updateRegion[4], updateRegion[5] + 1, updateResultLabels);
+  m_ResultLabelVolume->Modified();
+}
+
 //-----------------------------------------------------------------------------
 template< class IntensityPixelType, class LabelPixelType>
 bool vtkImageGrowCutSegment::vtkInternal::ExecuteGrowCut2(vtkImageData *intensityVolume, vtkImageData *seedLabelVolume,
-  vtkImageData *maskLabelVolume, double distancePenalty)
+  vtkImageData *maskLabelVolume, double distancePenalty, int updateRegionMargin)
 {
   int* imSize = intensityVolume->GetDimensions();
 
@@ -433,6 +872,21 @@ bool vtkImageGrowCutSegment::vtkInternal::ExecuteGrowCut2(vtkImageData *intensit
     return false;
     }
 
+  if (m_Multithreaded)
+    {
+    FrontierType seeds;
+    int updateRegion[6] = { 0, -1, 0, -1, 0, -1 };
+    if (!InitializationParallel<LabelPixelType>(seedLabelVolume, maskLabelVolume, distancePenalty, updateRegionMargin,
+      seeds, updateRegion))
+      {
+      return false;
+      }
+    ShortestPathClassificationParallel<IntensityPixelType>(intensityVolume, seeds, updateRegion);
+    UpdateResultLabelVolumeParallel<LabelPixelType>(updateRegion);
+    m_bSegInitialized = true;
+    return true;
+    }
+
   if (!InitializationAHP<IntensityPixelType, LabelPixelType>(intensityVolume, seedLabelVolume, maskLabelVolume, distancePenalty))
     {
     return false;
@@ -445,7 +899,8 @@ bool vtkImageGrowCutSegment::vtkInternal::ExecuteGrowCut2(vtkImageData *intensit
 //----------------------------------------------------------------------------
 template <class SourceVolType>
 bool vtkImageGrowCutSegment::vtkInternal::ExecuteGrowCut(vtkImageData *intensityVolume, vtkImageData *seedLabelVolume,
-  vtkImageData *maskLabelVolume, vtkImageData *resultLabelVolume, double distancePenalty)
+  vtkImageData *maskLabelVolume, vtkImageData *resultLabelVolume, double distancePenalty,
+  bool multithreaded, int updateRegionMargin)
 {
   int* extent = intensityVolume->GetExtent();
   double* spacing = intensityVolume->GetSpacing();
@@ -517,11 +972,18 @@ bool vtkImageGrowCutSegment::vtkInternal::ExecuteGrowCut(vtkImageData *intensity
     {
     this->Reset();
     }
+  else if (multithreaded != m_Multithreaded)
+    {
+    // cached buffers of the other computation method cannot be reused
+    this->Reset();
+    }
+  m_Multithreaded = multithreaded;
 
   bool success = false;
   switch (seedLabelVolume->GetScalarType())
   {
-    vtkTemplateMacro((success = ExecuteGrowCut2<SourceVolType, VTK_TT>(intensityVolume, seedLabelVolume, maskLabelVolume, distancePenalty)));
+    vtkTemplateMacro((success = ExecuteGrowCut2<SourceVolType, VTK_TT>(intensityVolume, seedLabelVolume, maskLabelVolume,
+      distancePenalty, updateRegionMargin)));
   default:
     vtkGenericWarningMacro("vtkOrientedImageDataResample::MergeImage: Unknown ScalarType");
   }
@@ -544,6 +1006,8 @@ vtkImageGrowCutSegment::vtkImageGrowCutSegment()
   this->SetNumberOfInputPorts(3);
   this->SetNumberOfOutputPorts(1);
   this->DistancePenalty = 0.0;
+  this->Multithreaded = true;
+  this->UpdateRegionMargin = -1;
 }
 
 //-----------------------------------------------------------------------------
@@ -577,7 +1041,8 @@ void vtkImageGrowCutSegment::ExecuteDataWithInformation(
 
   switch (intensityVolume->GetScalarType())
     {
-    vtkTemplateMacro(this->Internal->ExecuteGrowCut<VTK_TT>(intensityVolume, seedLabelVolume, maskLabelVolume, resultLabelVolume, this->DistancePenalty));
+    vtkTemplateMacro(this->Internal->ExecuteGrowCut<VTK_TT>(intensityVolume, seedLabelVolume, maskLabelVolume, resultLabelVolume,
+      this->DistancePenalty, this->Multithreaded, this->UpdateRegionMargin));
     break;
     }
   logger->StopTimer();
@@ -608,6 +1073,8 @@ void vtkImageGrowCutSegment::Reset()
 //-----------------------------------------------------------------------------
 void vtkImageGrowCutSegment::PrintSelf(ostream &os, vtkIndent indent)
 {
-  // XXX Implement this function
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "DistancePenalty: " << this->DistancePenalty << "\n";
+  os << indent << "Multithreaded: " << (this->Multithreaded ? "true" : "false") << "\n";
+  os << indent << "UpdateRegionMargin: " << this->UpdateRegionMargin << "\n";
 }
@@ -36,6 +36,24 @@ public:
   vtkGetMacro(DistancePenalty, double);
   vtkSetMacro(DistancePenalty, double);
 
+  /// Compute shortest paths using multiple threads (parallel delta-stepping with a bucket queue).
+  /// If disabled then single-threaded Dijkstra's algorithm with Fibonacci heap is used.
+  /// Both methods compute the same distances, only voxels that are at exactly the same distance
+  /// from seeds of different labels may be labeled differently.
+  /// Changing this option forces full recomputation of the result label volume.
+  /// By default = true.
+  vtkGetMacro(Multithreaded, bool);
+  vtkSetMacro(Multithreaded, bool);
+  vtkBooleanMacro(Multithreaded, bool);
+
+  /// Limit recomputation after seeds are added to the bounding box of the new or changed seeds,
+  /// dilated by this many voxels. Voxels outside this region keep their previous label.
+  /// This makes updates much faster for local seed edits, but the result may differ from full recomputation
+  /// if labels would propagate further than the margin.
+  /// Only used if Multithreaded is enabled. By default = -1, which means the region is not limited.
+  vtkGetMacro(UpdateRegionMargin, int);
+  vtkSetMacro(UpdateRegionMargin, int);
+
 protected:
   vtkImageGrowCutSegment();
   ~vtkImageGrowCutSegment() override;
@@ -52,6 +70,8 @@ private:
   class vtkInternal;
   vtkInternal * Internal;
   double DistancePenalty;
+  bool Multithreaded;
+  int UpdateRegionMargin;
 };
 
 #endif
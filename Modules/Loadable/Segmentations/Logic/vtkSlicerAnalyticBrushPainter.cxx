@@ -0,0 +1,370 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Segmentations includes
+#include "vtkSlicerAnalyticBrushPainter.h"
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkMath.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkSMPTools.h>
+
+// STD includes
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+/// Brush shape moved along one segment of a paint stroke.
+/// Positions are in brush coordinates (the coordinate system of the brush source,
+/// with the origin of the labelmap IJK coordinate system at the origin).
+struct SweptBrush
+{
+  double Start[3]; // brush source origin at the start of the segment
+  double Sweep[3]; // displacement of the brush from the start to the end of the segment
+  int Extent[6];   // IJK bounding box of the swept brush
+};
+
+//-----------------------------------------------------------------------------
+/// Sphere or cylinder brush that is rasterized by evaluating the shape equations at voxel centers.
+struct AnalyticBrush
+{
+  bool Cylinder{ false };
+  double Radius{ 0.0 };
+  double HalfHeight{ 0.0 };
+  double IjkToBrush[3][3];
+  std::vector<SweptBrush> Sweeps;
+
+  /// Returns true if the brush covers the point at any position along the segment
+  bool IsInside(const double point_Brush[3], const SweptBrush& sweptBrush) const
+    {
+    const double* sweep = sweptBrush.Sweep;
+    double p[3] = { point_Brush[0] - sweptBrush.Start[0], point_Brush[1] - sweptBrush.Start[1], point_Brush[2] - sweptBrush.Start[2] };
+    double radius2 = this->Radius * this->Radius;
+    if (!this->Cylinder)
+      {
+      // Capsule: distance from the segment of sphere centers
+      double sweepLength2 = vtkMath::Dot(sweep, sweep);
+      double t = (sweepLength2 > 0.0 ? std::min(1.0, std::max(0.0, vtkMath::Dot(p, sweep) / sweepLength2)) : 0.0);
+      double d[3] = { p[0] - t * sweep[0], p[1] - t * sweep[1], p[2] - t * sweep[2] };
+      return vtkMath::Dot(d, d) <= radius2;
+      }
+
+    // Swept cylinder: find the range of positions along the segment where the point is
+    // between the cylinder caps and the range where it is within the radius, and check if they overlap.
+    const double minimumSweep = 1e-9;
+    double tMin = 0.0;
+    double tMax = 1.0;
+    if (fabs(sweep[1]) > minimumSweep)
+      {
+      double t0 = (p[1] - this->HalfHeight) / sweep[1];
+      double t1 = (p[1] + this->HalfHeight) / sweep[1];
+      tMin = std::max(tMin, std::min(t0, t1));
+      tMax = std::min(tMax, std::max(t0, t1));
+      if (tMin > tMax)
+        {
+        return false;
+        }
+      }
+    else if (fabs(p[1]) > this->HalfHeight)
+      {
+      return false;
+      }
+    double a = sweep[0] * sweep[0] + sweep[2] * sweep[2];
+    double b = p[0] * sweep[0] + p[2] * sweep[2];
+    double c = p[0] * p[0] + p[2] * p[2] - radius2;
+    if (a > minimumSweep * minimumSweep)
+      {
+      double discriminant = b * b - a * c;
+      if (discriminant < 0.0)
+        {
+        return false;
+        }
+      double sqrtDiscriminant = sqrt(discriminant);
+      tMin = std::max(tMin, (b - sqrtDiscriminant) / a);
+      tMax = std::min(tMax, (b + sqrtDiscriminant) / a);
+      return tMin <= tMax;
+      }
+    return c <= 0.0;
+    }
+};
+
+//-----------------------------------------------------------------------------
+/// Set voxels covered by the brush to fillValue (or keep the current value if it is larger).
+/// Slices are processed in parallel.
+template <class T>
+void PaintAnalyticBrush(vtkImageData* labelmap, const AnalyticBrush& brush, const int paintExtent[6], T fillValue)
+{
+  auto paintSlices = [&](vtkIdType beginSlice, vtkIdType endSlice)
+    {
+    std::vector<const SweptBrush*> sliceBrushes;
+    std::vector<const SweptBrush*> rowBrushes;
+    for (int k = static_cast<int>(beginSlice); k < static_cast<int>(endSlice); ++k)
+      {
+      sliceBrushes.clear();
+      for (const SweptBrush& sweptBrush : brush.Sweeps)
+        {
+        if (k >= sweptBrush.Extent[4] && k <= sweptBrush.Extent[5])
+          {
+          sliceBrushes.push_back(&sweptBrush);
+          }
+        }
+      if (sliceBrushes.empty())
+        {
+        continue;
+        }
+      for (int j = paintExtent[2]; j <= paintExtent[3]; ++j)
+        {
+        rowBrushes.clear();
+        int rowExtent[2] = { paintExtent[1] + 1, paintExtent[0] - 1 };
+        for (const SweptBrush* sweptBrush : sliceBrushes)
+          {
+          if (j >= sweptBrush->Extent[2] && j <= sweptBrush->Extent[3])
+            {
+            rowBrushes.push_back(sweptBrush);
+            rowExtent[0] = std::min(rowExtent[0], sweptBrush->Extent[0]);
+            rowExtent[1] = std::max(rowExtent[1], sweptBrush->Extent[1]);
+            }
+          }
+        rowExtent[0] = std::max(rowExtent[0], paintExtent[0]);
+        rowExtent[1] = std::min(rowExtent[1], paintExtent[1]);
+        if (rowExtent[0] > rowExtent[1])
+          {
+          continue;
+          }
+        double point_Brush[3] = { 0.0, 0.0, 0.0 };
+        for (int axis = 0; axis < 3; ++axis)
+          {
+          point_Brush[axis] = brush.IjkToBrush[axis][0] * rowExtent[0]
+            + brush.IjkToBrush[axis][1] * j + brush.IjkToBrush[axis][2] * k;
+          }
+        T* voxel = static_cast<T*>(labelmap->GetScalarPointer(rowExtent[0], j, k));
+        for (int i = rowExtent[0]; i <= rowExtent[1]; ++i, ++voxel)
+          {
+          if (*voxel < fillValue)
+            {
+            for (const SweptBrush* sweptBrush : rowBrushes)
+              {
+              if (i >= sweptBrush->Extent[0] && i <= sweptBrush->Extent[1] && brush.IsInside(point_Brush, *sweptBrush))
+                {
+                *voxel = fillValue;
+                break;
+                }
+              }
+            }
+          point_Brush[0] += brush.IjkToBrush[0][0];
+          point_Brush[1] += brush.IjkToBrush[1][0];
+          point_Brush[2] += brush.IjkToBrush[2][0];
+          }
+        }
+      }
+    };
+  vtkSMPTools::For(paintExtent[4], paintExtent[5] + 1, paintSlices);
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkSlicerAnalyticBrushPainter);
+
+//----------------------------------------------------------------------------
+vtkSlicerAnalyticBrushPainter::vtkSlicerAnalyticBrushPainter() = default;
+
+//----------------------------------------------------------------------------
+vtkSlicerAnalyticBrushPainter::~vtkSlicerAnalyticBrushPainter() = default;
+
+//----------------------------------------------------------------------------
+void vtkSlicerAnalyticBrushPainter::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "BrushShape: " << (this->BrushShape == BrushShapeCylinder ? "Cylinder" : "Sphere") << "\n";
+  os << indent << "Radius: " << this->Radius << "\n";
+  os << indent << "Height: " << this->Height << "\n";
+  os << indent << "Center: " << this->Center[0] << ", " << this->Center[1] << ", " << this->Center[2] << "\n";
+  os << indent << "FillValue: " << this->FillValue << "\n";
+  os << indent << "BrushToIjkMatrix:\n";
+  this->BrushToIjkMatrix->PrintSelf(os, indent.GetNextIndent());
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerAnalyticBrushPainter::SetBrushToIjkMatrix(vtkMatrix4x4* brushToIjkMatrix)
+{
+  if (!brushToIjkMatrix)
+    {
+    this->BrushToIjkMatrix->Identity();
+    }
+  else
+    {
+    this->BrushToIjkMatrix->DeepCopy(brushToIjkMatrix);
+    }
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+vtkMatrix4x4* vtkSlicerAnalyticBrushPainter::GetBrushToIjkMatrix()
+{
+  return this->BrushToIjkMatrix;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerAnalyticBrushPainter::Paint(vtkImageData* labelmap, vtkPoints* positions_Ijk, int updateExtent[6])
+{
+  if (!labelmap || !positions_Ijk)
+    {
+    vtkErrorMacro("Paint: Invalid labelmap or positions");
+    return false;
+    }
+  vtkDataArray* scalars = labelmap->GetPointData()->GetScalars();
+  if (!scalars || scalars->GetNumberOfComponents() != 1)
+    {
+    return false;
+    }
+  AnalyticBrush brush;
+  brush.Cylinder = (this->BrushShape == BrushShapeCylinder);
+  brush.Radius = this->Radius;
+  brush.HalfHeight = this->Height / 2.0;
+
+  vtkMatrix4x4* brushToIjkMatrix = this->BrushToIjkMatrix;
+  vtkNew<vtkMatrix4x4> linearBrushToIjkMatrix;
+  for (int row = 0; row < 3; ++row)
+    {
+    for (int column = 0; column < 3; ++column)
+      {
+      linearBrushToIjkMatrix->SetElement(row, column, brushToIjkMatrix->GetElement(row, column));
+      }
+    }
+  if (fabs(linearBrushToIjkMatrix->Determinant()) < 1e-12)
+    {
+    return false;
+    }
+  vtkNew<vtkMatrix4x4> ijkToBrushMatrix;
+  vtkMatrix4x4::Invert(linearBrushToIjkMatrix, ijkToBrushMatrix);
+  for (int row = 0; row < 3; ++row)
+    {
+    for (int column = 0; column < 3; ++column)
+      {
+      brush.IjkToBrush[row][column] = ijkToBrushMatrix->GetElement(row, column);
+      }
+    }
+
+  // Half size of the brush bounding box along IJK axes
+  double brushHalfSize_Ijk[3] = { 0.0, 0.0, 0.0 };
+  double brushCenter_Ijk[3] = { 0.0, 0.0, 0.0 };
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    double m0 = linearBrushToIjkMatrix->GetElement(axis, 0);
+    double m1 = linearBrushToIjkMatrix->GetElement(axis, 1);
+    double m2 = linearBrushToIjkMatrix->GetElement(axis, 2);
+    if (brush.Cylinder)
+      {
+      brushHalfSize_Ijk[axis] = brush.Radius * sqrt(m0 * m0 + m2 * m2) + brush.HalfHeight * fabs(m1);
+      }
+    else
+      {
+      brushHalfSize_Ijk[axis] = brush.Radius * sqrt(m0 * m0 + m1 * m1 + m2 * m2);
+      }
+    brushCenter_Ijk[axis] = m0 * this->Center[0] + m1 * this->Center[1] + m2 * this->Center[2];
+    }
+
+  vtkIdType numberOfPoints = positions_Ijk->GetNumberOfPoints();
+  std::vector<std::array<double, 3> > snappedPositions_Ijk(numberOfPoints);
+  for (vtkIdType pointIndex = 0; pointIndex < numberOfPoints; ++pointIndex)
+    {
+    double* position_Ijk = positions_Ijk->GetPoint(pointIndex);
+    for (int axis = 0; axis < 3; ++axis)
+      {
+      snappedPositions_Ijk[pointIndex][axis] = vtkMath::Round(position_Ijk[axis]);
+      }
+    }
+  double maximumSweepLength2 = 4.0 * brush.Radius * brush.Radius;
+  brush.Sweeps.resize(numberOfPoints);
+  for (vtkIdType pointIndex = 0; pointIndex < numberOfPoints; ++pointIndex)
+    {
+    SweptBrush& sweptBrush = brush.Sweeps[pointIndex];
+    const double* start_Ijk = snappedPositions_Ijk[pointIndex].data();
+    vtkMath::Multiply3x3(brush.IjkToBrush, start_Ijk, sweptBrush.Start);
+    vtkMath::Add(sweptBrush.Start, this->Center, sweptBrush.Start);
+    const double* end_Ijk = start_Ijk;
+    sweptBrush.Sweep[0] = 0.0;
+    sweptBrush.Sweep[1] = 0.0;
+    sweptBrush.Sweep[2] = 0.0;
+    if (pointIndex + 1 < numberOfPoints)
+      {
+      const double* next_Ijk = snappedPositions_Ijk[pointIndex + 1].data();
+      double displacement_Ijk[3] = { next_Ijk[0] - start_Ijk[0], next_Ijk[1] - start_Ijk[1], next_Ijk[2] - start_Ijk[2] };
+      double sweep[3] = { 0.0, 0.0, 0.0 };
+      vtkMath::Multiply3x3(brush.IjkToBrush, displacement_Ijk, sweep);
+      if (vtkMath::Dot(sweep, sweep) <= maximumSweepLength2)
+        {
+        sweptBrush.Sweep[0] = sweep[0];
+        sweptBrush.Sweep[1] = sweep[1];
+        sweptBrush.Sweep[2] = sweep[2];
+        end_Ijk = next_Ijk;
+        }
+      }
+    for (int axis = 0; axis < 3; ++axis)
+      {
+      sweptBrush.Extent[axis * 2] = static_cast<int>(floor(
+        std::min(start_Ijk[axis], end_Ijk[axis]) + brushCenter_Ijk[axis] - brushHalfSize_Ijk[axis]));
+      sweptBrush.Extent[axis * 2 + 1] = static_cast<int>(ceil(
+        std::max(start_Ijk[axis], end_Ijk[axis]) + brushCenter_Ijk[axis] + brushHalfSize_Ijk[axis]));
+      if (pointIndex == 0)
+        {
+        updateExtent[axis * 2] = sweptBrush.Extent[axis * 2];
+        updateExtent[axis * 2 + 1] = sweptBrush.Extent[axis * 2 + 1];
+        }
+      else
+        {
+        updateExtent[axis * 2] = std::min(updateExtent[axis * 2], sweptBrush.Extent[axis * 2]);
+        updateExtent[axis * 2 + 1] = std::max(updateExtent[axis * 2 + 1], sweptBrush.Extent[axis * 2 + 1]);
+        }
+      }
+    }
+  if (numberOfPoints == 0)
+    {
+    return true;
+    }
+
+  // Only voxels in the bounding box of the brushes are visited
+  int paintExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  labelmap->GetExtent(paintExtent);
+  for (int i = 0; i < 3; i++)
+    {
+    paintExtent[2 * i] = std::max(paintExtent[2 * i], updateExtent[2 * i]);
+    paintExtent[2 * i + 1] = std::min(paintExtent[2 * i + 1], updateExtent[2 * i + 1]);
+    }
+  if (paintExtent[0] > paintExtent[1] || paintExtent[2] > paintExtent[3] || paintExtent[4] > paintExtent[5])
+    {
+    return true;
+    }
+
+  switch (labelmap->GetScalarType())
+    {
+    vtkTemplateMacro(PaintAnalyticBrush<VTK_TT>(labelmap, brush, paintExtent, static_cast<VTK_TT>(this->FillValue)));
+    default:
+      return false;
+    }
+  labelmap->Modified();
+  return true;
+}
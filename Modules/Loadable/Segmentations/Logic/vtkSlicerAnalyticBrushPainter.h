@@ -0,0 +1,113 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// .NAME vtkSlicerAnalyticBrushPainter
+// .SECTION Description
+// Paints sphere and cylinder brushes into a labelmap by evaluating the shape equations
+// at voxel centers, without rasterizing a polygonal brush model into a stencil.
+// Brush positions are snapped to voxel centers, the same way as brush stencils are positioned
+// by the segment editor paint effect. Successive positions are connected by sweeping the brush
+// between them, unless they are farther than the brush diameter (then they belong to separate strokes).
+
+#ifndef __vtkSlicerAnalyticBrushPainter_h
+#define __vtkSlicerAnalyticBrushPainter_h
+
+// Slicer includes
+#include "vtkSlicerSegmentationsModuleLogicExport.h"
+
+// VTK includes
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkObject.h>
+
+class vtkImageData;
+class vtkPoints;
+
+/// \ingroup Slicer_QtModules_Segmentations
+class VTK_SLICER_SEGMENTATIONS_LOGIC_EXPORT vtkSlicerAnalyticBrushPainter : public vtkObject
+{
+public:
+  static vtkSlicerAnalyticBrushPainter* New();
+  vtkTypeMacro(vtkSlicerAnalyticBrushPainter, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  enum
+    {
+    BrushShapeSphere,
+    BrushShapeCylinder
+    };
+
+  //@{
+  /// Shape of the brush. The cylinder axis is the Y axis of the brush coordinate system,
+  /// as generated by vtkCylinderSource. Sphere by default.
+  vtkGetMacro(BrushShape, int);
+  vtkSetClampMacro(BrushShape, int, BrushShapeSphere, BrushShapeCylinder);
+  void SetBrushShapeToSphere() { this->SetBrushShape(BrushShapeSphere); };
+  void SetBrushShapeToCylinder() { this->SetBrushShape(BrushShapeCylinder); };
+  //@}
+
+  //@{
+  /// Radius of the sphere or cylinder in brush coordinate system
+  vtkGetMacro(Radius, double);
+  vtkSetMacro(Radius, double);
+  //@}
+
+  //@{
+  /// Height of the cylinder in brush coordinate system. Not used for sphere brushes.
+  vtkGetMacro(Height, double);
+  vtkSetMacro(Height, double);
+  //@}
+
+  //@{
+  /// Center of the brush shape in brush coordinate system
+  vtkGetVector3Macro(Center, double);
+  vtkSetVector3Macro(Center, double);
+  //@}
+
+  //@{
+  /// Value that is written into voxels covered by the brush. Voxels that have a larger value are not changed.
+  vtkGetMacro(FillValue, double);
+  vtkSetMacro(FillValue, double);
+  //@}
+
+  /// Linear transform from brush coordinate system to labelmap IJK coordinate system.
+  /// Translation component is ignored, brushes are positioned by the painted points.
+  void SetBrushToIjkMatrix(vtkMatrix4x4* brushToIjkMatrix);
+  vtkMatrix4x4* GetBrushToIjkMatrix();
+
+  /// Paint brushes at the specified positions (in labelmap IJK coordinate system).
+  /// updateExtent is set to the bounding box of the brushes (may be larger than the labelmap extent).
+  /// \return False if the brushes cannot be painted analytically (the labelmap has multiple scalar components,
+  ///   unsupported scalar type, or the brush transform is singular). The labelmap is not modified then.
+  bool Paint(vtkImageData* labelmap, vtkPoints* positions_Ijk, int updateExtent[6]);
+
+protected:
+  vtkSlicerAnalyticBrushPainter();
+  ~vtkSlicerAnalyticBrushPainter() override;
+
+  int BrushShape{ BrushShapeSphere };
+  double Radius{ 1.0 };
+  double Height{ 1.0 };
+  double Center[3]{ 0.0, 0.0, 0.0 };
+  double FillValue{ 1.0 };
+  vtkNew<vtkMatrix4x4> BrushToIjkMatrix;
+
+private:
+  vtkSlicerAnalyticBrushPainter(const vtkSlicerAnalyticBrushPainter&) = delete;
+  void operator=(const vtkSlicerAnalyticBrushPainter&) = delete;
+};
+
+#endif
@@ -0,0 +1,896 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Segmentations includes
+#include "vtkSlicerSegmentStatisticsCalculator.h"
+
+// SegmentationCore includes
+#include "vtkLabelmapMetadata.h"
+#include "vtkOrientedImageData.h"
+#include "vtkOrientedImageDataResample.h"
+#include "vtkSegmentation.h"
+#include "vtkSegmentationConverter.h"
+
+// MRML includes
+#include "vtkMRMLTransformNode.h"
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkGeneralTransform.h>
+#include <vtkMath.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkSMPThreadLocal.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
+#include <vtkStringArray.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <map>
+
+namespace
+{
+
+const double CC_PER_CUBIC_MM = 0.001;
+
+/// Binning of scalar values for computing the median
+struct HistogramBinning
+{
+  double Origin{ 0.0 };
+  double Spacing{ 1.0 };
+  int NumberOfBins{ 0 };
+  bool IntegerValues{ false };
+
+  int GetBin(double value) const
+  {
+    int bin = static_cast<int>((value - this->Origin) / this->Spacing);
+    return std::min(std::max(bin, 0), this->NumberOfBins - 1);
+  }
+};
+
+/// Statistics of a segment accumulated during the sweep. Voxel positions are relative to the
+/// first voxel of the swept extent to keep the sums of products accurate.
+struct SegmentAccumulator
+{
+  vtkIdType VoxelCount{ 0 };
+  int Extent[6]{ VTK_INT_MAX, VTK_INT_MIN, VTK_INT_MAX, VTK_INT_MIN, VTK_INT_MAX, VTK_INT_MIN };
+  double PositionSum[3]{ 0.0, 0.0, 0.0 };
+  /// Sums of products of positions: ii, jj, kk, ij, ik, jk
+  double PositionProductSum[6]{ 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+  double ScalarSum{ 0.0 };
+  double ScalarSquareSum{ 0.0 };
+  double ScalarMinimum{ VTK_DOUBLE_MAX };
+  double ScalarMaximum{ VTK_DOUBLE_MIN };
+  std::vector<vtkIdType> Histogram;
+
+  void AddRun(int i0, int i1, int j, int k)
+  {
+    double runLength = i1 - i0 + 1;
+    this->VoxelCount += i1 - i0 + 1;
+    this->Extent[0] = std::min(this->Extent[0], i0);
+    this->Extent[1] = std::max(this->Extent[1], i1);
+    this->Extent[2] = std::min(this->Extent[2], j);
+    this->Extent[3] = std::max(this->Extent[3], j);
+    this->Extent[4] = std::min(this->Extent[4], k);
+    this->Extent[5] = std::max(this->Extent[5], k);
+    double iSum = 0.5 * (i0 + i1) * runLength;
+    // Sum of squares of [i0, i1], using sum of squares of [0, n] = n(n+1)(2n+1)/6
+    double iSquareSum = (static_cast<double>(i1) * (i1 + 1) * (2.0 * i1 + 1)
+      - static_cast<double>(i0 - 1) * i0 * (2.0 * i0 - 1)) / 6.0;
+    this->PositionSum[0] += iSum;
+    this->PositionSum[1] += j * runLength;
+    this->PositionSum[2] += k * runLength;
+    this->PositionProductSum[0] += iSquareSum;
+    this->PositionProductSum[1] += static_cast<double>(j) * j * runLength;
+    this->PositionProductSum[2] += static_cast<double>(k) * k * runLength;
+    this->PositionProductSum[3] += j * iSum;
+    this->PositionProductSum[4] += k * iSum;
+    this->PositionProductSum[5] += static_cast<double>(j) * k * runLength;
+  }
+
+  void AddScalar(double value, const HistogramBinning& binning)
+  {
+    this->ScalarSum += value;
+    this->ScalarSquareSum += value * value;
+    this->ScalarMinimum = std::min(this->ScalarMinimum, value);
+    this->ScalarMaximum = std::max(this->ScalarMaximum, value);
+    if (this->Histogram.empty())
+      {
+      this->Histogram.resize(binning.NumberOfBins, 0);
+      }
+    ++this->Histogram[binning.GetBin(value)];
+  }
+
+  void Merge(const SegmentAccumulator& other)
+  {
+    this->VoxelCount += other.VoxelCount;
+    for (int axis = 0; axis < 3; ++axis)
+      {
+      this->Extent[axis * 2] = std::min(this->Extent[axis * 2], other.Extent[axis * 2]);
+      this->Extent[axis * 2 + 1] = std::max(this->Extent[axis * 2 + 1], other.Extent[axis * 2 + 1]);
+      this->PositionSum[axis] += other.PositionSum[axis];
+      }
+    for (int productIndex = 0; productIndex < 6; ++productIndex)
+      {
+      this->PositionProductSum[productIndex] += other.PositionProductSum[productIndex];
+      }
+    this->ScalarSum += other.ScalarSum;
+    this->ScalarSquareSum += other.ScalarSquareSum;
+    this->ScalarMinimum = std::min(this->ScalarMinimum, other.ScalarMinimum);
+    this->ScalarMaximum = std::max(this->ScalarMaximum, other.ScalarMaximum);
+    if (!other.Histogram.empty())
+      {
+      if (this->Histogram.empty())
+        {
+        this->Histogram = other.Histogram;
+        }
+      else
+        {
+        std::transform(this->Histogram.begin(), this->Histogram.end(), other.Histogram.begin(),
+          this->Histogram.begin(), std::plus<vtkIdType>());
+        }
+      }
+  }
+};
+
+/// Maps label values of a labelmap layer to the index of the segment in the layer (-1 if none)
+struct LayerSegmentLookup
+{
+  int MinimumLabelValue{ 0 };
+  std::vector<int> SegmentIndexLookupTable;
+  std::map<int, int> SegmentIndexMap;
+
+  void Prepare(const std::vector<int>& labelValues)
+  {
+    if (labelValues.empty())
+      {
+      return;
+      }
+    int minimumLabelValue = *std::min_element(labelValues.begin(), labelValues.end());
+    int maximumLabelValue = *std::max_element(labelValues.begin(), labelValues.end());
+    bool useLookupTable = (static_cast<double>(maximumLabelValue) - minimumLabelValue < (1 << 20));
+    this->MinimumLabelValue = minimumLabelValue;
+    if (useLookupTable)
+      {
+      this->SegmentIndexLookupTable.assign(maximumLabelValue - minimumLabelValue + 1, -1);
+      }
+    for (int segmentIndex = 0; segmentIndex < static_cast<int>(labelValues.size()); ++segmentIndex)
+      {
+      if (useLookupTable)
+        {
+        this->SegmentIndexLookupTable[labelValues[segmentIndex] - minimumLabelValue] = segmentIndex;
+        }
+      else
+        {
+        this->SegmentIndexMap[labelValues[segmentIndex]] = segmentIndex;
+        }
+      }
+  }
+
+  int GetSegmentIndex(double labelValue) const
+  {
+    if (!this->SegmentIndexLookupTable.empty())
+      {
+      double index = labelValue - this->MinimumLabelValue;
+      if (index < 0 || index >= this->SegmentIndexLookupTable.size())
+        {
+        return -1;
+        }
+      return this->SegmentIndexLookupTable[static_cast<size_t>(index)];
+      }
+    auto segmentIt = this->SegmentIndexMap.find(static_cast<int>(labelValue));
+    return (segmentIt != this->SegmentIndexMap.end() && segmentIt->first == labelValue) ? segmentIt->second : -1;
+  }
+};
+
+//----------------------------------------------------------------------------
+template <class T>
+void GetRowSegmentIndices(const T* labelPtr, int rowLength, const LayerSegmentLookup& lookup, int* segmentIndices)
+{
+  // Voxels of the same label are usually next to each other, so the previous lookup is reused
+  T previousLabel = 0;
+  int previousSegmentIndex = lookup.GetSegmentIndex(0);
+  for (int i = 0; i < rowLength; ++i)
+    {
+    T label = labelPtr[i];
+    if (label != previousLabel)
+      {
+      previousLabel = label;
+      previousSegmentIndex = lookup.GetSegmentIndex(static_cast<double>(label));
+      }
+    segmentIndices[i] = previousSegmentIndex;
+    }
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+void GetRowScalars(const T* scalarPtr, int rowLength, int numberOfComponents, double* values)
+{
+  for (int i = 0; i < rowLength; ++i, scalarPtr += numberOfComponents)
+    {
+    values[i] = static_cast<double>(*scalarPtr);
+    }
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+class vtkSlicerSegmentStatisticsCalculator::vtkInternal
+{
+public:
+  struct SegmentStatistics
+  {
+    vtkIdType VoxelCount{ 0 };
+    double VolumeMm3{ 0.0 };
+    bool ScalarStatisticsValid{ false };
+    double Minimum{ 0.0 };
+    double Maximum{ 0.0 };
+    double Mean{ 0.0 };
+    double StandardDeviation{ 0.0 };
+    double Median{ 0.0 };
+    int Extent[6]{ 0, -1, 0, -1, 0, -1 };
+    double BoundsRAS[6]{ 1.0, -1.0, 1.0, -1.0, 1.0, -1.0 };
+    double CentroidRAS[3]{ 0.0, 0.0, 0.0 };
+    double PrincipalMoments[3]{ 0.0, 0.0, 0.0 };
+    double PrincipalAxes[3][3]{ { 1.0, 0.0, 0.0 }, { 0.0, 1.0, 0.0 }, { 0.0, 0.0, 1.0 } };
+    double Elongation{ 0.0 };
+    double Flatness{ 0.0 };
+  };
+
+  /// Get statistics of a segment, nullptr if not computed
+  SegmentStatistics* GetStatistics(const std::string& segmentID)
+  {
+    auto statisticsIt = this->Statistics.find(segmentID);
+    return statisticsIt != this->Statistics.end() ? &statisticsIt->second : nullptr;
+  }
+
+  /// Compute statistics of the segments of a layer in a single sweep over the labelmap.
+  /// The scalar image, if specified, must have the same voxel grid as the labelmap.
+  void ComputeLayerStatistics(vtkOrientedImageData* labelmap, const int sweepExtent[6],
+    const std::vector<int>& labelValues, vtkImageData* scalarImage, const HistogramBinning& binning,
+    std::vector<SegmentAccumulator>& accumulators);
+
+  /// Compute statistics of a segment from the accumulated values
+  void FinalizeStatistics(const SegmentAccumulator& accumulator, const int sweepExtent[6],
+    vtkMatrix4x4* imageToNodeMatrix, vtkAbstractTransform* nodeToWorldTransform, double voxelVolumeMm3,
+    const HistogramBinning& binning, SegmentStatistics& statistics);
+
+  std::map<std::string, SegmentStatistics> Statistics;
+};
+
+//----------------------------------------------------------------------------
+void vtkSlicerSegmentStatisticsCalculator::vtkInternal::ComputeLayerStatistics(
+  vtkOrientedImageData* labelmap, const int sweepExtent[6], const std::vector<int>& labelValues,
+  vtkImageData* scalarImage, const HistogramBinning& binning, std::vector<SegmentAccumulator>& accumulators)
+{
+  accumulators.assign(labelValues.size(), SegmentAccumulator());
+  if (sweepExtent[0] > sweepExtent[1] || sweepExtent[2] > sweepExtent[3] || sweepExtent[4] > sweepExtent[5])
+    {
+    return;
+    }
+
+  LayerSegmentLookup lookup;
+  lookup.Prepare(labelValues);
+
+  // Get pointers and increments before the parallel loop
+  const char* labelmapPtr = static_cast<const char*>(labelmap->GetScalarPointerForExtent(const_cast<int*>(sweepExtent)));
+  int labelScalarType = labelmap->GetScalarType();
+  int labelScalarSize = labelmap->GetScalarSize();
+  vtkIdType labelIncrements[3] = { 0, 0, 0 };
+  labelmap->GetIncrements(labelIncrements);
+
+  const char* scalarPtr = nullptr;
+  int scalarType = VTK_VOID;
+  int scalarSize = 0;
+  int numberOfComponents = 1;
+  vtkIdType scalarIncrements[3] = { 0, 0, 0 };
+  if (scalarImage)
+    {
+    scalarPtr = static_cast<const char*>(scalarImage->GetScalarPointerForExtent(const_cast<int*>(sweepExtent)));
+    scalarType = scalarImage->GetScalarType();
+    scalarSize = scalarImage->GetScalarSize();
+    numberOfComponents = scalarImage->GetNumberOfScalarComponents();
+    scalarImage->GetIncrements(scalarIncrements);
+    }
+  if (!labelmapPtr || (scalarImage && !scalarPtr))
+    {
+    return;
+    }
+
+  int rowLength = sweepExtent[1] - sweepExtent[0] + 1;
+  vtkSMPThreadLocal<std::vector<SegmentAccumulator> > localAccumulators(accumulators);
+  auto accumulateSlices = [&](vtkIdType beginSlice, vtkIdType endSlice)
+    {
+    std::vector<SegmentAccumulator>& threadAccumulators = localAccumulators.Local();
+    std::vector<int> segmentIndices(rowLength);
+    std::vector<double> scalars(scalarImage ? rowLength : 0);
+    for (vtkIdType sliceIndex = beginSlice; sliceIndex < endSlice; ++sliceIndex)
+      {
+      int k = sweepExtent[4] + static_cast<int>(sliceIndex);
+      for (int j = sweepExtent[2]; j <= sweepExtent[3]; ++j)
+        {
+        vtkIdType rowOffset = (j - sweepExtent[2]) * labelIncrements[1] + sliceIndex * labelIncrements[2];
+        const void* labelRowPtr = labelmapPtr + rowOffset * labelScalarSize;
+        switch (labelScalarType)
+          {
+          vtkTemplateMacro(GetRowSegmentIndices(static_cast<const VTK_TT*>(labelRowPtr), rowLength, lookup, segmentIndices.data()));
+          }
+        if (scalarImage)
+          {
+          vtkIdType scalarRowOffset = (j - sweepExtent[2]) * scalarIncrements[1] + sliceIndex * scalarIncrements[2];
+          const void* scalarRowPtr = scalarPtr + scalarRowOffset * scalarSize;
+          switch (scalarType)
+            {
+            vtkTemplateMacro(GetRowScalars(static_cast<const VTK_TT*>(scalarRowPtr), rowLength, numberOfComponents, scalars.data()));
+            }
+          }
+
+        // Accumulate runs of voxels that belong to the same segment
+        int i = 0;
+        while (i < rowLength)
+          {
+          int segmentIndex = segmentIndices[i];
+          int runStart = i;
+          for (++i; i < rowLength && segmentIndices[i] == segmentIndex; ++i)
+            {
+            }
+          if (segmentIndex < 0)
+            {
+            continue;
+            }
+          SegmentAccumulator& accumulator = threadAccumulators[segmentIndex];
+          accumulator.AddRun(runStart, i - 1, j - sweepExtent[2], k - sweepExtent[4]);
+          if (scalarImage)
+            {
+            for (int runIndex = runStart; runIndex < i; ++runIndex)
+              {
+              accumulator.AddScalar(scalars[runIndex], binning);
+              }
+            }
+          }
+        }
+      }
+    };
+  vtkSMPTools::For(0, sweepExtent[5] - sweepExtent[4] + 1, accumulateSlices);
+
+  for (auto threadAccumulatorsIt = localAccumulators.begin(); threadAccumulatorsIt != localAccumulators.end(); ++threadAccumulatorsIt)
+    {
+    for (size_t segmentIndex = 0; segmentIndex < accumulators.size(); ++segmentIndex)
+      {
+      accumulators[segmentIndex].Merge((*threadAccumulatorsIt)[segmentIndex]);
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerSegmentStatisticsCalculator::vtkInternal::FinalizeStatistics(const SegmentAccumulator& accumulator,
+  const int sweepExtent[6], vtkMatrix4x4* imageToNodeMatrix, vtkAbstractTransform* nodeToWorldTransform,
+  double voxelVolumeMm3, const HistogramBinning& binning, SegmentStatistics& statistics)
+{
+  statistics = SegmentStatistics();
+  statistics.VoxelCount = accumulator.VoxelCount;
+  statistics.VolumeMm3 = accumulator.VoxelCount * voxelVolumeMm3;
+  if (accumulator.VoxelCount == 0)
+    {
+    return;
+    }
+  double voxelCount = static_cast<double>(accumulator.VoxelCount);
+
+  // Scalar statistics
+  if (!accumulator.Histogram.empty())
+    {
+    statistics.ScalarStatisticsValid = true;
+    statistics.Minimum = accumulator.ScalarMinimum;
+    statistics.Maximum = accumulator.ScalarMaximum;
+    statistics.Mean = accumulator.ScalarSum / voxelCount;
+    if (accumulator.VoxelCount > 1)
+      {
+      double variance = (accumulator.ScalarSquareSum - statistics.Mean * accumulator.ScalarSum) / (voxelCount - 1.0);
+      statistics.StandardDeviation = (variance > 0.0 ? sqrt(variance) : 0.0);
+      }
+    // Lower median: the first bin where the cumulative count reaches half of the voxels
+    vtkIdType medianCount = (accumulator.VoxelCount + 1) / 2;
+    vtkIdType cumulativeCount = 0;
+    int medianBin = 0;
+    for (; medianBin < binning.NumberOfBins - 1; ++medianBin)
+      {
+      cumulativeCount += accumulator.Histogram[medianBin];
+      if (cumulativeCount >= medianCount)
+        {
+        break;
+        }
+      }
+    if (binning.IntegerValues)
+      {
+      statistics.Median = binning.Origin + medianBin;
+      }
+    else
+      {
+      statistics.Median = binning.Origin + (medianBin + 0.5) * binning.Spacing;
+      statistics.Median = std::min(std::max(statistics.Median, statistics.Minimum), statistics.Maximum);
+      }
+    }
+
+  // Extent in the voxel grid
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    statistics.Extent[axis * 2] = accumulator.Extent[axis * 2] + sweepExtent[axis * 2];
+    statistics.Extent[axis * 2 + 1] = accumulator.Extent[axis * 2 + 1] + sweepExtent[axis * 2];
+    }
+
+  // Bounding box of the voxel corners in world coordinate system
+  for (int corner = 0; corner < 8; ++corner)
+    {
+    double cornerIjk[4] =
+      {
+      statistics.Extent[(corner & 1) ? 1 : 0] + ((corner & 1) ? 0.5 : -0.5),
+      statistics.Extent[(corner & 2) ? 3 : 2] + ((corner & 2) ? 0.5 : -0.5),
+      statistics.Extent[(corner & 4) ? 5 : 4] + ((corner & 4) ? 0.5 : -0.5),
+      1.0
+      };
+    double cornerNode[4] = { 0.0, 0.0, 0.0, 1.0 };
+    imageToNodeMatrix->MultiplyPoint(cornerIjk, cornerNode);
+    double cornerWorld[3] = { 0.0, 0.0, 0.0 };
+    nodeToWorldTransform->TransformPoint(cornerNode, cornerWorld);
+    for (int axis = 0; axis < 3; ++axis)
+      {
+      if (corner == 0 || cornerWorld[axis] < statistics.BoundsRAS[axis * 2])
+        {
+        statistics.BoundsRAS[axis * 2] = cornerWorld[axis];
+        }
+      if (corner == 0 || cornerWorld[axis] > statistics.BoundsRAS[axis * 2 + 1])
+        {
+        statistics.BoundsRAS[axis * 2 + 1] = cornerWorld[axis];
+        }
+      }
+    }
+
+  // Centroid
+  double meanPosition[3] = { 0.0, 0.0, 0.0 };
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    meanPosition[axis] = accumulator.PositionSum[axis] / voxelCount;
+    }
+  double centroidIjk[4] =
+    {
+    meanPosition[0] + sweepExtent[0],
+    meanPosition[1] + sweepExtent[2],
+    meanPosition[2] + sweepExtent[4],
+    1.0
+    };
+  double centroidNode[4] = { 0.0, 0.0, 0.0, 1.0 };
+  imageToNodeMatrix->MultiplyPoint(centroidIjk, centroidNode);
+  nodeToWorldTransform->TransformPoint(centroidNode, statistics.CentroidRAS);
+
+  // Covariance of voxel positions in the voxel grid, then in physical space
+  const int productAxes[6][2] = { { 0, 0 }, { 1, 1 }, { 2, 2 }, { 0, 1 }, { 0, 2 }, { 1, 2 } };
+  double covarianceIjk[3][3] = { { 0.0 } };
+  for (int productIndex = 0; productIndex < 6; ++productIndex)
+    {
+    int axis1 = productAxes[productIndex][0];
+    int axis2 = productAxes[productIndex][1];
+    covarianceIjk[axis1][axis2] = accumulator.PositionProductSum[productIndex] / voxelCount
+      - meanPosition[axis1] * meanPosition[axis2];
+    covarianceIjk[axis2][axis1] = covarianceIjk[axis1][axis2];
+    }
+  double imageToNode3x3[3][3] = { { 0.0 } };
+  for (int row = 0; row < 3; ++row)
+    {
+    for (int column = 0; column < 3; ++column)
+      {
+      imageToNode3x3[row][column] = imageToNodeMatrix->GetElement(row, column);
+      }
+    }
+  double temp[3][3] = { { 0.0 } };
+  double covariance[3][3] = { { 0.0 } };
+  vtkMath::Multiply3x3(imageToNode3x3, covarianceIjk, temp);
+  double nodeToImage3x3Transposed[3][3] = { { 0.0 } };
+  vtkMath::Transpose3x3(imageToNode3x3, nodeToImage3x3Transposed);
+  vtkMath::Multiply3x3(temp, nodeToImage3x3Transposed, covariance);
+
+  // Principal moments and axes. Jacobi returns eigenvalues in descending order, eigenvectors in columns.
+  double* covarianceRows[3] = { covariance[0], covariance[1], covariance[2] };
+  double eigenvalues[3] = { 0.0, 0.0, 0.0 };
+  double eigenvectors[3][3] = { { 0.0 } };
+  double* eigenvectorRows[3] = { eigenvectors[0], eigenvectors[1], eigenvectors[2] };
+  vtkMath::Jacobi(covarianceRows, eigenvalues, eigenvectorRows);
+  for (int momentIndex = 0; momentIndex < 3; ++momentIndex)
+    {
+    int eigenIndex = 2 - momentIndex;
+    statistics.PrincipalMoments[momentIndex] = std::max(eigenvalues[eigenIndex], 0.0);
+    double axisNode[3] = { eigenvectors[0][eigenIndex], eigenvectors[1][eigenIndex], eigenvectors[2][eigenIndex] };
+    nodeToWorldTransform->TransformVectorAtPoint(centroidNode, axisNode, statistics.PrincipalAxes[momentIndex]);
+    vtkMath::Normalize(statistics.PrincipalAxes[momentIndex]);
+    }
+  if (statistics.PrincipalMoments[1] > 0.0)
+    {
+    statistics.Elongation = sqrt(statistics.PrincipalMoments[2] / statistics.PrincipalMoments[1]);
+    }
+  if (statistics.PrincipalMoments[0] > 0.0)
+    {
+    statistics.Flatness = sqrt(statistics.PrincipalMoments[1] / statistics.PrincipalMoments[0]);
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkSlicerSegmentStatisticsCalculator);
+
+//----------------------------------------------------------------------------
+vtkSlicerSegmentStatisticsCalculator::vtkSlicerSegmentStatisticsCalculator()
+{
+  this->Internal = new vtkInternal();
+}
+
+//----------------------------------------------------------------------------
+vtkSlicerSegmentStatisticsCalculator::~vtkSlicerSegmentStatisticsCalculator()
+{
+  this->SetSegmentationNode(nullptr);
+  this->SetScalarVolumeNode(nullptr);
+  delete this->Internal;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerSegmentStatisticsCalculator::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "SegmentationNode: " << (this->SegmentationNode ? this->SegmentationNode->GetID() : "(none)") << "\n";
+  os << indent << "ScalarVolumeNode: " << (this->ScalarVolumeNode ? this->ScalarVolumeNode->GetID() : "(none)") << "\n";
+  os << indent << "NumberOfSegmentIDs: " << this->SegmentIDs.size() << "\n";
+  os << indent << "MaximumNumberOfHistogramBins: " << this->MaximumNumberOfHistogramBins << "\n";
+  os << indent << "NumberOfComputedSegments: " << this->Internal->Statistics.size() << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerSegmentStatisticsCalculator::SetSegmentIDs(const std::vector<std::string>& segmentIDs)
+{
+  if (this->SegmentIDs == segmentIDs)
+    {
+    return;
+    }
+  this->SegmentIDs = segmentIDs;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerSegmentStatisticsCalculator::SetSegmentIDs(vtkStringArray* segmentIDs)
+{
+  std::vector<std::string> segmentIDsVector;
+  if (segmentIDs)
+    {
+    for (vtkIdType index = 0; index < segmentIDs->GetNumberOfValues(); ++index)
+      {
+      segmentIDsVector.push_back(segmentIDs->GetValue(index));
+      }
+    }
+  this->SetSegmentIDs(segmentIDsVector);
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerSegmentStatisticsCalculator::ClearResults()
+{
+  this->Internal->Statistics.clear();
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerSegmentStatisticsCalculator::Compute()
+{
+  this->ClearResults();
+
+  vtkSegmentation* segmentation = this->SegmentationNode ? this->SegmentationNode->GetSegmentation() : nullptr;
+  if (!segmentation)
+    {
+    vtkErrorMacro("Compute: Invalid segmentation node");
+    return false;
+    }
+  std::string labelmapRepresentationName = vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName();
+  if (!segmentation->ContainsRepresentation(labelmapRepresentationName))
+    {
+    vtkErrorMacro("Compute: Segmentation does not contain binary labelmap representation");
+    return false;
+    }
+
+  vtkImageData* scalarImage = nullptr;
+  vtkSmartPointer<vtkOrientedImageData> referenceGeometry;
+  vtkNew<vtkGeneralTransform> segmentationToVolumeTransform;
+  HistogramBinning binning;
+  if (this->ScalarVolumeNode)
+    {
+    scalarImage = this->ScalarVolumeNode->GetImageData();
+    vtkDataArray* scalars = (scalarImage && scalarImage->GetPointData()) ? scalarImage->GetPointData()->GetScalars() : nullptr;
+    if (!scalars)
+      {
+      vtkErrorMacro("Compute: Scalar volume node does not contain valid image data");
+      return false;
+      }
+
+    // Geometry of the scalar volume in the volume node coordinate system
+    referenceGeometry = vtkSmartPointer<vtkOrientedImageData>::New();
+    referenceGeometry->SetExtent(scalarImage->GetExtent());
+    vtkNew<vtkMatrix4x4> ijkToRasMatrix;
+    this->ScalarVolumeNode->GetIJKToRASMatrix(ijkToRasMatrix);
+    referenceGeometry->SetGeometryFromImageToWorldMatrix(ijkToRasMatrix);
+    vtkMRMLTransformNode::GetTransformBetweenNodes(this->SegmentationNode->GetParentTransformNode(),
+      this->ScalarVolumeNode->GetParentTransformNode(), segmentationToVolumeTransform);
+
+    // One bin per value for integer volumes if possible, otherwise divide the value range evenly
+    double scalarRange[2] = { 0.0, 0.0 };
+    scalars->GetRange(scalarRange, 0);
+    int dataType = scalars->GetDataType();
+    binning.Origin = scalarRange[0];
+    binning.IntegerValues = (dataType != VTK_FLOAT && dataType != VTK_DOUBLE
+      && scalarRange[1] - scalarRange[0] + 1 <= this->MaximumNumberOfHistogramBins);
+    if (binning.IntegerValues)
+      {
+      binning.NumberOfBins = static_cast<int>(scalarRange[1] - scalarRange[0]) + 1;
+      }
+    else
+      {
+      binning.NumberOfBins = this->MaximumNumberOfHistogramBins;
+      binning.Spacing = (scalarRange[1] > scalarRange[0] ? (scalarRange[1] - scalarRange[0]) / binning.NumberOfBins : 1.0);
+      }
+    }
+
+  std::vector<std::string> segmentIDs = this->SegmentIDs;
+  if (segmentIDs.empty())
+    {
+    segmentation->GetSegmentIDs(segmentIDs);
+    }
+
+  // Group the segments by labelmap layer
+  bool success = true;
+  std::vector<vtkOrientedImageData*> layerLabelmaps;
+  std::vector<std::vector<std::string> > layerSegmentIDs;
+  std::vector<std::vector<int> > layerLabelValues;
+  std::map<vtkOrientedImageData*, size_t> layerIndices;
+  for (const std::string& segmentID : segmentIDs)
+    {
+    vtkSegment* segment = segmentation->GetSegment(segmentID);
+    if (!segment)
+      {
+      vtkErrorMacro("Compute: Segment not found by ID: " << segmentID);
+      success = false;
+      continue;
+      }
+    // Empty segments have zero statistics
+    this->Internal->Statistics[segmentID] = vtkInternal::SegmentStatistics();
+    vtkOrientedImageData* labelmap = vtkOrientedImageData::SafeDownCast(segment->GetRepresentation(labelmapRepresentationName));
+    if (!labelmap || labelmap->IsEmpty() || labelmap->GetNumberOfScalarComponents() != 1)
+      {
+      continue;
+      }
+    auto layerIt = layerIndices.find(labelmap);
+    if (layerIt == layerIndices.end())
+      {
+      layerIt = layerIndices.insert(std::make_pair(labelmap, layerLabelmaps.size())).first;
+      layerLabelmaps.push_back(labelmap);
+      layerSegmentIDs.emplace_back();
+      layerLabelValues.emplace_back();
+      }
+    layerSegmentIDs[layerIt->second].push_back(segmentID);
+    layerLabelValues[layerIt->second].push_back(segment->GetLabelValue());
+    }
+
+  vtkNew<vtkGeneralTransform> nodeToWorldTransform;
+  vtkMRMLTransformNode::GetTransformBetweenNodes(this->ScalarVolumeNode
+    ? this->ScalarVolumeNode->GetParentTransformNode() : this->SegmentationNode->GetParentTransformNode(),
+    nullptr, nodeToWorldTransform);
+  nodeToWorldTransform->Update();
+
+  for (size_t layerIndex = 0; layerIndex < layerLabelmaps.size(); ++layerIndex)
+    {
+    vtkSmartPointer<vtkOrientedImageData> labelmap = layerLabelmaps[layerIndex];
+    int sweepExtent[6] = { 0, -1, 0, -1, 0, -1 };
+    if (scalarImage)
+      {
+      // Resample the whole layer to the scalar volume grid once
+      vtkSmartPointer<vtkOrientedImageData> resampledLabelmap = vtkSmartPointer<vtkOrientedImageData>::New();
+      if (!vtkOrientedImageDataResample::ResampleOrientedImageToReferenceOrientedImage(labelmap, referenceGeometry,
+        resampledLabelmap, false, false, segmentationToVolumeTransform))
+        {
+        vtkErrorMacro("Compute: Failed to resample labelmap of segment " << layerSegmentIDs[layerIndex][0]);
+        success = false;
+        continue;
+        }
+      labelmap = resampledLabelmap;
+      int labelmapExtent[6] = { 0, -1, 0, -1, 0, -1 };
+      labelmap->GetExtent(labelmapExtent);
+      int scalarExtent[6] = { 0, -1, 0, -1, 0, -1 };
+      scalarImage->GetExtent(scalarExtent);
+      for (int axis = 0; axis < 3; ++axis)
+        {
+        sweepExtent[axis * 2] = std::max(labelmapExtent[axis * 2], scalarExtent[axis * 2]);
+        sweepExtent[axis * 2 + 1] = std::min(labelmapExtent[axis * 2 + 1], scalarExtent[axis * 2 + 1]);
+        }
+      if (!labelmap->GetPointData() || !labelmap->GetPointData()->GetScalars())
+        {
+        continue;
+        }
+      }
+    else
+      {
+      // Voxels outside the effective extent are background, use it if it is already known
+      vtkLabelmapMetadata* metadata = labelmap->GetCachedLabelmapMetadata();
+      if (!metadata || !metadata->GetEffectiveExtent(sweepExtent))
+        {
+        labelmap->GetExtent(sweepExtent);
+        }
+      }
+
+    std::vector<SegmentAccumulator> accumulators;
+    this->Internal->ComputeLayerStatistics(labelmap, sweepExtent, layerLabelValues[layerIndex],
+      scalarImage, binning, accumulators);
+
+    vtkNew<vtkMatrix4x4> imageToNodeMatrix;
+    labelmap->GetImageToWorldMatrix(imageToNodeMatrix);
+    double spacing[3] = { 1.0, 1.0, 1.0 };
+    labelmap->GetSpacing(spacing);
+    double voxelVolumeMm3 = spacing[0] * spacing[1] * spacing[2];
+    for (size_t segmentIndex = 0; segmentIndex < accumulators.size(); ++segmentIndex)
+      {
+      this->Internal->FinalizeStatistics(accumulators[segmentIndex], sweepExtent, imageToNodeMatrix,
+        nodeToWorldTransform, voxelVolumeMm3, binning, this->Internal->Statistics[layerSegmentIDs[layerIndex][segmentIndex]]);
+      }
+    }
+
+  return success;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerSegmentStatisticsCalculator::HasStatistics(const std::string& segmentID)
+{
+  return this->Internal->GetStatistics(segmentID) != nullptr;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkSlicerSegmentStatisticsCalculator::GetVoxelCount(const std::string& segmentID)
+{
+  vtkInternal::SegmentStatistics* statistics = this->Internal->GetStatistics(segmentID);
+  return statistics ? statistics->VoxelCount : 0;
+}
+
+//----------------------------------------------------------------------------
+double vtkSlicerSegmentStatisticsCalculator::GetVolumeMm3(const std::string& segmentID)
+{
+  vtkInternal::SegmentStatistics* statistics = this->Internal->GetStatistics(segmentID);
+  return statistics ? statistics->VolumeMm3 : 0.0;
+}
+
+//----------------------------------------------------------------------------
+double vtkSlicerSegmentStatisticsCalculator::GetVolumeCm3(const std::string& segmentID)
+{
+  return this->GetVolumeMm3(segmentID) * CC_PER_CUBIC_MM;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerSegmentStatisticsCalculator::HasScalarStatistics(const std::string& segmentID)
+{
+  vtkInternal::SegmentStatistics* statistics = this->Internal->GetStatistics(segmentID);
+  return statistics && statistics->ScalarStatisticsValid;
+}
+
+//----------------------------------------------------------------------------
+double vtkSlicerSegmentStatisticsCalculator::GetMinimum(const std::string& segmentID)
+{
+  vtkInternal::SegmentStatistics* statistics = this->Internal->GetStatistics(segmentID);
+  return statistics ? statistics->Minimum : 0.0;
+}
+
+//----------------------------------------------------------------------------
+double vtkSlicerSegmentStatisticsCalculator::GetMaximum(const std::string& segmentID)
+{
+  vtkInternal::SegmentStatistics* statistics = this->Internal->GetStatistics(segmentID);
+  return statistics ? statistics->Maximum : 0.0;
+}
+
+//----------------------------------------------------------------------------
+double vtkSlicerSegmentStatisticsCalculator::GetMean(const std::string& segmentID)
+{
+  vtkInternal::SegmentStatistics* statistics = this->Internal->GetStatistics(segmentID);
+  return statistics ? statistics->Mean : 0.0;
+}
+
+//----------------------------------------------------------------------------
+double vtkSlicerSegmentStatisticsCalculator::GetStandardDeviation(const std::string& segmentID)
+{
+  vtkInternal::SegmentStatistics* statistics = this->Internal->GetStatistics(segmentID);
+  return statistics ? statistics->StandardDeviation : 0.0;
+}
+
+//----------------------------------------------------------------------------
+double vtkSlicerSegmentStatisticsCalculator::GetMedian(const std::string& segmentID)
+{
+  vtkInternal::SegmentStatistics* statistics = this->Internal->GetStatistics(segmentID);
+  return statistics ? statistics->Median : 0.0;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerSegmentStatisticsCalculator::GetExtent(const std::string& segmentID, int extent[6])
+{
+  vtkInternal::SegmentStatistics* statistics = this->Internal->GetStatistics(segmentID);
+  if (!statistics || statistics->VoxelCount == 0)
+    {
+    return false;
+    }
+  std::copy(statistics->Extent, statistics->Extent + 6, extent);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerSegmentStatisticsCalculator::GetBoundsRAS(const std::string& segmentID, double bounds[6])
+{
+  vtkInternal::SegmentStatistics* statistics = this->Internal->GetStatistics(segmentID);
+  if (!statistics || statistics->VoxelCount == 0)
+    {
+    return false;
+    }
+  std::copy(statistics->BoundsRAS, statistics->BoundsRAS + 6, bounds);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerSegmentStatisticsCalculator::GetCentroidRAS(const std::string& segmentID, double centroid[3])
+{
+  vtkInternal::SegmentStatistics* statistics = this->Internal->GetStatistics(segmentID);
+  if (!statistics || statistics->VoxelCount == 0)
+    {
+    return false;
+    }
+  std::copy(statistics->CentroidRAS, statistics->CentroidRAS + 3, centroid);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerSegmentStatisticsCalculator::GetPrincipalMoments(const std::string& segmentID, double moments[3])
+{
+  vtkInternal::SegmentStatistics* statistics = this->Internal->GetStatistics(segmentID);
+  if (!statistics || statistics->VoxelCount == 0)
+    {
+    return false;
+    }
+  std::copy(statistics->PrincipalMoments, statistics->PrincipalMoments + 3, moments);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerSegmentStatisticsCalculator::GetPrincipalAxis(const std::string& segmentID, int axisIndex, double axis[3])
+{
+  vtkInternal::SegmentStatistics* statistics = this->Internal->GetStatistics(segmentID);
+  if (!statistics || statistics->VoxelCount == 0 || axisIndex < 0 || axisIndex > 2)
+    {
+    return false;
+    }
+  std::copy(statistics->PrincipalAxes[axisIndex], statistics->PrincipalAxes[axisIndex] + 3, axis);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+double vtkSlicerSegmentStatisticsCalculator::GetElongation(const std::string& segmentID)
+{
+  vtkInternal::SegmentStatistics* statistics = this->Internal->GetStatistics(segmentID);
+  return statistics ? statistics->Elongation : 0.0;
+}
+
+//----------------------------------------------------------------------------
+double vtkSlicerSegmentStatisticsCalculator::GetFlatness(const std::string& segmentID)
+{
+  vtkInternal::SegmentStatistics* statistics = this->Internal->GetStatistics(segmentID);
+  return statistics ? statistics->Flatness : 0.0;
+}
@@ -0,0 +1,143 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// .NAME vtkSlicerSegmentStatisticsCalculator
+// .SECTION Description
+// Computes labelmap and scalar volume statistics of multiple segments at once.
+// Segments that are stored in the same binary labelmap layer are processed in a single
+// multithreaded sweep over the layer, instead of one pass per segment.
+
+#ifndef __vtkSlicerSegmentStatisticsCalculator_h
+#define __vtkSlicerSegmentStatisticsCalculator_h
+
+// Slicer includes
+#include "vtkSlicerSegmentationsModuleLogicExport.h"
+
+// Segmentations includes
+#include "vtkMRMLSegmentationNode.h"
+
+// MRML includes
+#include <vtkMRMLScalarVolumeNode.h>
+
+// STD includes
+#include <string>
+#include <vector>
+
+class vtkStringArray;
+
+/// \ingroup Slicer_QtModules_Segmentations
+class VTK_SLICER_SEGMENTATIONS_LOGIC_EXPORT vtkSlicerSegmentStatisticsCalculator : public vtkObject
+{
+public:
+  static vtkSlicerSegmentStatisticsCalculator* New();
+  vtkTypeMacro(vtkSlicerSegmentStatisticsCalculator, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  //@{
+  /// Segmentation node that contains the segments. Its binary labelmap representation is used.
+  vtkGetObjectMacro(SegmentationNode, vtkMRMLSegmentationNode);
+  vtkSetObjectMacro(SegmentationNode, vtkMRMLSegmentationNode);
+  //@}
+
+  //@{
+  /// Optional scalar volume node. If set, then the segments are resampled to the voxel grid of the volume
+  /// (each labelmap layer once) and all statistics are computed on that grid, including the statistics
+  /// of the scalar values. If not set, then the statistics are computed on the grid of the labelmap layers.
+  vtkGetObjectMacro(ScalarVolumeNode, vtkMRMLScalarVolumeNode);
+  vtkSetObjectMacro(ScalarVolumeNode, vtkMRMLScalarVolumeNode);
+  //@}
+
+  /// Set the segments to compute statistics for. All segments are used if the list is empty (default).
+  void SetSegmentIDs(const std::vector<std::string>& segmentIDs);
+  void SetSegmentIDs(vtkStringArray* segmentIDs);
+
+  //@{
+  /// Maximum number of histogram bins used for computing the median of scalar values.
+  /// Integer volumes with a smaller value range use one bin per value, therefore their median is exact.
+  /// 16384 by default.
+  vtkGetMacro(MaximumNumberOfHistogramBins, int);
+  vtkSetClampMacro(MaximumNumberOfHistogramBins, int, 1, VTK_INT_MAX);
+  //@}
+
+  /// Compute statistics of all the segments. Previous results are cleared.
+  /// \return False on error. Segments that could be processed have valid results even if false is returned.
+  bool Compute();
+
+  /// Clear all computed results
+  void ClearResults();
+
+  /// Returns true if statistics were computed for the segment
+  bool HasStatistics(const std::string& segmentID);
+
+  /// Number of voxels in the segment
+  vtkIdType GetVoxelCount(const std::string& segmentID);
+  /// Volume of the segment in mm3
+  double GetVolumeMm3(const std::string& segmentID);
+  /// Volume of the segment in cm3
+  double GetVolumeCm3(const std::string& segmentID);
+
+  /// Returns true if scalar value statistics are available for the segment.
+  /// It requires a scalar volume node and a non-empty segment.
+  bool HasScalarStatistics(const std::string& segmentID);
+  /// Minimum scalar value in the segment
+  double GetMinimum(const std::string& segmentID);
+  /// Maximum scalar value in the segment
+  double GetMaximum(const std::string& segmentID);
+  /// Mean scalar value in the segment
+  double GetMean(const std::string& segmentID);
+  /// Sample standard deviation of the scalar values in the segment
+  double GetStandardDeviation(const std::string& segmentID);
+  /// Median scalar value in the segment. Computed from a histogram, see MaximumNumberOfHistogramBins.
+  double GetMedian(const std::string& segmentID);
+
+  /// Voxel extent of the segment in the voxel grid that the statistics were computed on.
+  /// \return False if the segment is empty.
+  bool GetExtent(const std::string& segmentID, int extent[6]);
+  /// Axis-aligned bounding box of the segment voxels in world (RAS) coordinate system.
+  /// \return False if the segment is empty.
+  bool GetBoundsRAS(const std::string& segmentID, double bounds[6]);
+  /// Centroid of the segment in world (RAS) coordinate system.
+  /// \return False if the segment is empty.
+  bool GetCentroidRAS(const std::string& segmentID, double centroid[3]);
+  /// Principal moments (eigenvalues of the covariance matrix of voxel positions, in mm2) in ascending order.
+  /// \return False if the segment is empty.
+  bool GetPrincipalMoments(const std::string& segmentID, double moments[3]);
+  /// Principal axis (unit vector in world coordinate system) that belongs to the principal moment of the same index.
+  /// \return False if the segment is empty or the axis index is invalid.
+  bool GetPrincipalAxis(const std::string& segmentID, int axisIndex, double axis[3]);
+  /// Square root of the ratio of the largest and second largest principal moments
+  double GetElongation(const std::string& segmentID);
+  /// Square root of the ratio of the second smallest and smallest principal moments
+  double GetFlatness(const std::string& segmentID);
+
+protected:
+  vtkSlicerSegmentStatisticsCalculator();
+  ~vtkSlicerSegmentStatisticsCalculator() override;
+
+  vtkMRMLSegmentationNode* SegmentationNode{ nullptr };
+  vtkMRMLScalarVolumeNode* ScalarVolumeNode{ nullptr };
+  std::vector<std::string> SegmentIDs;
+  int MaximumNumberOfHistogramBins{ 16384 };
+
+  class vtkInternal;
+  vtkInternal* Internal;
+
+private:
+  vtkSlicerSegmentStatisticsCalculator(const vtkSlicerSegmentStatisticsCalculator&) = delete;
+  void operator=(const vtkSlicerSegmentStatisticsCalculator&) = delete;
+};
+
+#endif
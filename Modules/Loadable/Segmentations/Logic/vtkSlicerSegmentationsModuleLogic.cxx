@@ -26,6 +26,11 @@
 #include "vtkClosedSurfaceToBinaryLabelmapConversionRule.h"
 #include "vtkClosedSurfaceToFractionalLabelmapConversionRule.h"
 #include "vtkFractionalLabelmapToClosedSurfaceConversionRule.h"
+#include "vtkLabelmapMetadata.h"
+#include "vtkBinaryLabelmapToSparseLabelmapConversionRule.h"
+#include "vtkSparseLabelmapToBinaryLabelmapConversionRule.h"
+#include "vtkSparseLabelmapToClosedSurfaceConversionRule.h"
+#include "vtkClosedSurfaceToSparseLabelmapConversionRule.h"
 #include "vtkOrientedImageData.h"
 #include "vtkOrientedImageDataResample.h"
 #include "vtkSegmentationConverterFactory.h"
@@ -57,6 +62,7 @@
 #include <vtkProperty.h>
 #include <vtkRenderer.h>
 #include <vtkRenderWindow.h>
+#include <vtkSMPTools.h>
 #include <vtkSTLWriter.h>
 #include <vtkStringArray.h>
 #include <vtkTransform.h>
@@ -86,11 +92,189 @@
 #include <vtkEventBroker.h>
 
 // STD includes
+#include <algorithm>
 #include <sstream>
+#include <vector>
 
 //----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkSlicerSegmentationsModuleLogic);
 
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Get label values of a labelmap and a copy of the labelmap cropped to the extent of its labels.
+// The copy does not share voxels with the input labelmap.
+// Label values and extents of all labels are computed in a single pass (see vtkLabelmapMetadata),
+// so the cost does not depend on the number of labels.
+void GetLabelValuesAndCroppedLabelmap(vtkOrientedImageData* labelmap, std::vector<int>& labelValues,
+  vtkOrientedImageData* croppedLabelmap)
+{
+  labelValues.clear();
+  int effectiveExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  vtkLabelmapMetadata* metadata = labelmap->GetLabelmapMetadata();
+  if (metadata)
+    {
+    metadata->GetLabelValues(labelValues);
+    metadata->GetEffectiveExtent(effectiveExtent);
+    }
+  else
+    {
+    // Not an integer labelmap with a limited number of labels
+    vtkNew<vtkIntArray> labelValuesArray;
+    vtkSlicerSegmentationsModuleLogic::GetAllLabelValues(labelValuesArray, labelmap);
+    for (vtkIdType labelIndex = 0; labelIndex < labelValuesArray->GetNumberOfValues(); ++labelIndex)
+      {
+      labelValues.push_back(labelValuesArray->GetValue(labelIndex));
+      }
+    vtkOrientedImageDataResample::CalculateEffectiveExtent(labelmap, effectiveExtent);
+    }
+  if (labelValues.empty())
+    {
+    return;
+    }
+
+  int* extent = labelmap->GetExtent();
+  if (std::equal(extent, extent + 6, effectiveExtent))
+    {
+    croppedLabelmap->vtkImageData::DeepCopy(labelmap);
+    }
+  else
+    {
+    vtkNew<vtkImageConstantPad> padder;
+    padder->SetInputData(labelmap);
+    padder->SetOutputWholeExtent(effectiveExtent);
+    padder->Update();
+    croppedLabelmap->vtkImageData::ShallowCopy(padder->GetOutput());
+    }
+  vtkNew<vtkMatrix4x4> labelmapImageToWorldMatrix;
+  labelmap->GetImageToWorldMatrix(labelmapImageToWorldMatrix);
+  croppedLabelmap->SetGeometryFromImageToWorldMatrix(labelmapImageToWorldMatrix);
+  if (metadata)
+    {
+    // Cropping to the effective extent does not change number of voxels or extent of labels
+    croppedLabelmap->SetLabelmapMetadata(metadata);
+    }
+}
+
+//----------------------------------------------------------------------------
+// Process segments on a worker thread pool if parallel processing is enabled in the segmentation
+// (see vtkSegmentation::ParallelConversion), otherwise on the calling thread.
+// Each segment is a separate work item, as processing a segment is typically expensive.
+template <class Functor>
+void ForEachSegment(vtkSegmentation* segmentation, vtkIdType numberOfSegments, Functor& functor)
+{
+  if (segmentation->GetParallelConversion() && numberOfSegments > 1)
+    {
+    vtkSMPTools::For(0, numberOfSegments, 1, functor);
+    }
+  else
+    {
+    functor(0, numberOfSegments);
+    }
+}
+
+//----------------------------------------------------------------------------
+// Get closed surface representation of segments in the segmentation node's coordinate system.
+// If the segmentation contains closed surface representation then the surfaces are not copied,
+// therefore they must not be modified. Otherwise the segments are converted in a temporary segmentation,
+// all at once (so that they can be converted in parallel) and sharing the master representation
+// with the segmentation (so that shared labelmaps are not duplicated).
+// Surfaces that are not available are set to nullptr.
+void GetSegmentClosedSurfaces(vtkMRMLSegmentationNode* segmentationNode, const std::vector<std::string>& segmentIDs,
+  std::vector<vtkSmartPointer<vtkPolyData> >& segmentPolyDatas)
+{
+  segmentPolyDatas.clear();
+  segmentPolyDatas.resize(segmentIDs.size());
+  vtkSegmentation* segmentation = segmentationNode->GetSegmentation();
+  std::string closedSurfaceName = vtkSegmentationConverter::GetSegmentationClosedSurfaceRepresentationName();
+
+  vtkSmartPointer<vtkSegmentation> convertedSegmentation = segmentation;
+  if (!segmentation->ContainsRepresentation(closedSurfaceName))
+    {
+    std::string masterRepresentationName = segmentation->GetMasterRepresentationName();
+    convertedSegmentation = vtkSmartPointer<vtkSegmentation>::New();
+    convertedSegmentation->SetMasterRepresentationName(masterRepresentationName);
+    convertedSegmentation->CopyConversionParameters(segmentation);
+    convertedSegmentation->SetParallelConversion(segmentation->GetParallelConversion());
+    for (const std::string& segmentID : segmentIDs)
+      {
+      vtkSegment* segment = segmentation->GetSegment(segmentID);
+      if (!segment || !segment->GetRepresentation(masterRepresentationName) || convertedSegmentation->GetSegment(segmentID))
+        {
+        continue;
+        }
+      vtkNew<vtkSegment> segmentCopy;
+      segmentCopy->DeepCopyMetadata(segment);
+      segmentCopy->AddRepresentation(masterRepresentationName, segment->GetRepresentation(masterRepresentationName));
+      convertedSegmentation->AddSegment(segmentCopy, segmentID);
+      }
+    if (!convertedSegmentation->CreateRepresentation(closedSurfaceName, true))
+      {
+      vtkErrorWithObjectMacro(segmentationNode, "GetSegmentClosedSurfaces: Failed to convert segments to " << closedSurfaceName);
+      return;
+      }
+    }
+
+  for (size_t segmentIndex = 0; segmentIndex < segmentIDs.size(); ++segmentIndex)
+    {
+    vtkSegment* segment = convertedSegmentation->GetSegment(segmentIDs[segmentIndex]);
+    if (segment)
+      {
+      segmentPolyDatas[segmentIndex] = vtkPolyData::SafeDownCast(segment->GetRepresentation(closedSurfaceName));
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Get transform from the segmentation node to world coordinate system.
+// Returns nullptr if the segmentation node is not transformed.
+vtkSmartPointer<vtkGeneralTransform> GetSegmentationToWorldTransform(vtkMRMLSegmentationNode* segmentationNode)
+{
+  vtkMRMLTransformNode* parentTransformNode = segmentationNode->GetParentTransformNode();
+  if (!parentTransformNode)
+    {
+    return nullptr;
+    }
+  vtkSmartPointer<vtkGeneralTransform> segmentationToWorldTransform = vtkSmartPointer<vtkGeneralTransform>::New();
+  parentTransformNode->GetTransformToWorld(segmentationToWorldTransform);
+  // Make sure the transform is up-to-date before it is used from multiple threads
+  segmentationToWorldTransform->Update();
+  return segmentationToWorldTransform;
+}
+
+//----------------------------------------------------------------------------
+// Set closed surface of a segment to a model node, along with display properties and parent transform
+void SetSegmentSurfaceToModelNode(vtkMRMLSegmentationNode* segmentationNode, const std::string& segmentId,
+  vtkSegment* segment, vtkPolyData* polyData, vtkMRMLModelNode* modelNode)
+{
+  modelNode->SetAndObservePolyData(polyData);
+
+  // Set color of the exported model
+  vtkMRMLSegmentationDisplayNode* segmentationDisplayNode = vtkMRMLSegmentationDisplayNode::SafeDownCast(segmentationNode->GetDisplayNode());
+  vtkMRMLDisplayNode* modelDisplayNode = modelNode->GetDisplayNode();
+  if (!modelDisplayNode)
+    {
+    // Create display node
+    vtkSmartPointer<vtkMRMLModelDisplayNode> displayNode = vtkSmartPointer<vtkMRMLModelDisplayNode>::New();
+    displayNode = vtkMRMLModelDisplayNode::SafeDownCast(modelNode->GetScene()->AddNode(displayNode));
+    displayNode->VisibilityOn();
+    modelNode->SetAndObserveDisplayNodeID(displayNode->GetID());
+    modelDisplayNode = displayNode.GetPointer();
+    }
+  if (segmentationDisplayNode && modelDisplayNode)
+    {
+    modelDisplayNode->SetColor(segment->GetColor());
+    modelDisplayNode->SetOpacity(segmentationDisplayNode->GetSegmentOpacity3D(segmentId));
+    }
+
+  // Set segmentation's parent transform to exported node
+  vtkMRMLTransformNode* parentTransformNode = segmentationNode->GetParentTransformNode();
+  modelNode->SetAndObserveTransformNodeID(parentTransformNode ? parentTransformNode->GetID() : nullptr);
+}
+
+} // end of anonymous namespace
+
 //----------------------------------------------------------------------------
 vtkSlicerSegmentationsModuleLogic::vtkSlicerSegmentationsModuleLogic()
 {
@@ -155,6 +339,14 @@ void vtkSlicerSegmentationsModuleLogic::RegisterNodes()
     vtkSmartPointer<vtkClosedSurfaceToFractionalLabelmapConversionRule>::New() );
   vtkSegmentationConverterFactory::GetInstance()->RegisterConverterRule(
     vtkSmartPointer<vtkFractionalLabelmapToClosedSurfaceConversionRule>::New() );
+  vtkSegmentationConverterFactory::GetInstance()->RegisterConverterRule(
+    vtkSmartPointer<vtkBinaryLabelmapToSparseLabelmapConversionRule>::New() );
+  vtkSegmentationConverterFactory::GetInstance()->RegisterConverterRule(
+    vtkSmartPointer<vtkSparseLabelmapToBinaryLabelmapConversionRule>::New() );
+  vtkSegmentationConverterFactory::GetInstance()->RegisterConverterRule(
+    vtkSmartPointer<vtkSparseLabelmapToClosedSurfaceConversionRule>::New() );
+  vtkSegmentationConverterFactory::GetInstance()->RegisterConverterRule(
+    vtkSmartPointer<vtkClosedSurfaceToSparseLabelmapConversionRule>::New() );
 }
 
 //---------------------------------------------------------------------------
@@ -816,35 +1008,7 @@ bool vtkSlicerSegmentationsModuleLogic::ExportSegmentToRepresentationNode(vtkSeg
       segment->GetRepresentation(vtkSegmentationConverter::GetSegmentationClosedSurfaceRepresentationName()) );
     vtkSmartPointer<vtkPolyData> polyDataCopy = vtkSmartPointer<vtkPolyData>::New();
     polyDataCopy->DeepCopy(polyData); // Make copy of poly data so that the model node does not change if segment changes
-    modelNode->SetAndObservePolyData(polyDataCopy);
-
-    // Set color of the exported model
-    vtkMRMLSegmentationDisplayNode* segmentationDisplayNode = vtkMRMLSegmentationDisplayNode::SafeDownCast(segmentationNode->GetDisplayNode());
-    vtkMRMLDisplayNode* modelDisplayNode = modelNode->GetDisplayNode();
-    if (!modelDisplayNode)
-      {
-      // Create display node
-      vtkSmartPointer<vtkMRMLModelDisplayNode> displayNode = vtkSmartPointer<vtkMRMLModelDisplayNode>::New();
-      displayNode = vtkMRMLModelDisplayNode::SafeDownCast(modelNode->GetScene()->AddNode(displayNode));
-      displayNode->VisibilityOn();
-      modelNode->SetAndObserveDisplayNodeID(displayNode->GetID());
-      modelDisplayNode = displayNode.GetPointer();
-      }
-    if (segmentationDisplayNode && modelDisplayNode)
-      {
-      modelDisplayNode->SetColor(segment->GetColor());
-      modelDisplayNode->SetOpacity(segmentationDisplayNode->GetSegmentOpacity3D(segmentId));
-      }
-
-    // Set segmentation's parent transform to exported node
-    if (parentTransformNode)
-      {
-      modelNode->SetAndObserveTransformNodeID(parentTransformNode->GetID());
-      }
-      else
-      {
-      modelNode->SetAndObserveTransformNodeID(nullptr);
-      }
+    SetSegmentSurfaceToModelNode(segmentationNode, segmentId, segment, polyDataCopy, modelNode);
 
     return true;
     }
@@ -904,11 +1068,41 @@ bool vtkSlicerSegmentationsModuleLogic::ExportSegmentsToModels(vtkMRMLSegmentati
     exportedSegmentIDs = segmentIDs;
     }
 
+  vtkSegmentation* segmentation = segmentationNode->GetSegmentation();
+  std::vector<vtkSegment*> exportedSegments;
+  for (const std::string& segmentId : exportedSegmentIDs)
+    {
+    vtkSegment* segment = segmentation->GetSegment(segmentId);
+    if (!segment)
+      {
+      vtkErrorWithObjectMacro(segmentationNode, "ExportSegmentsToModels: Segment not found by ID: " << segmentId);
+      return false;
+      }
+    exportedSegments.push_back(segment);
+    }
+
+  // Copy surfaces so that the model nodes do not change if the segments change.
+  // Copying is done on worker threads, while MRML nodes are only created and modified on the main thread.
+  std::vector<vtkSmartPointer<vtkPolyData> > exportedPolyDatas(exportedSegments.size());
+  std::string closedSurfaceName = vtkSegmentationConverter::GetSegmentationClosedSurfaceRepresentationName();
+  auto copySegmentSurfaces = [&exportedSegments, &exportedPolyDatas, &closedSurfaceName](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType segmentIndex = begin; segmentIndex < end; ++segmentIndex)
+      {
+      exportedPolyDatas[segmentIndex] = vtkSmartPointer<vtkPolyData>::New();
+      vtkPolyData* polyData = vtkPolyData::SafeDownCast(exportedSegments[segmentIndex]->GetRepresentation(closedSurfaceName));
+      if (polyData)
+        {
+        exportedPolyDatas[segmentIndex]->DeepCopy(polyData);
+        }
+      }
+    };
+  ForEachSegment(segmentation, static_cast<vtkIdType>(exportedSegments.size()), copySegmentSurfaces);
+
   // Export each segment into a model
-  for (std::vector<std::string>::iterator segmentIdIt = exportedSegmentIDs.begin(); segmentIdIt != exportedSegmentIDs.end(); ++segmentIdIt)
+  for (size_t segmentIndex = 0; segmentIndex < exportedSegments.size(); ++segmentIndex)
     {
-    // Export segment into model node
-    vtkSegment* segment = segmentationNode->GetSegmentation()->GetSegment(*segmentIdIt);
+    vtkSegment* segment = exportedSegments[segmentIndex];
     vtkMRMLModelNode* modelNode = nullptr;
     if (existingModelNamesToModels.find(segment->GetName()) != existingModelNamesToModels.end())
       {
@@ -927,11 +1121,8 @@ bool vtkSlicerSegmentationsModuleLogic::ExportSegmentsToModels(vtkMRMLSegmentati
       }
 
     // Export segment into model node
-    if (!vtkSlicerSegmentationsModuleLogic::ExportSegmentToRepresentationNode(segment, modelNode))
-      {
-      vtkErrorWithObjectMacro(segmentationNode, "ExportSegmentsToModels: Failed to export segmentation into model hierarchy");
-      return false;
-      }
+    modelNode->SetName(segment->GetName());
+    SetSegmentSurfaceToModelNode(segmentationNode, exportedSegmentIDs[segmentIndex], segment, exportedPolyDatas[segmentIndex], modelNode);
     }
 
   // Move exported representation under same parent as segmentation
@@ -1377,27 +1568,27 @@ bool vtkSlicerSegmentationsModuleLogic::ImportLabelmapToSegmentationNode(vtkMRML
     segmentationNode->CreateDefaultDisplayNodes();
     }
 
-  // Split labelmap node into per-label image data
+  // Split labelmap node into segments that share the labelmap, cropped to the extent of all labels
 
-  vtkNew<vtkIntArray> labelValues;
-  vtkSlicerSegmentationsModuleLogic::GetAllLabelValues(labelValues.GetPointer(), labelmapNode->GetImageData());
-
-  vtkSmartPointer<vtkOrientedImageData> labelOrientedImageData = vtkSmartPointer<vtkOrientedImageData>::New();
-  labelOrientedImageData->vtkImageData::DeepCopy(labelmapNode->GetImageData());
-  labelOrientedImageData->SetGeometryFromImageToWorldMatrix(labelmapIjkToRasMatrix);
+  vtkSmartPointer<vtkOrientedImageData> labelmapImage = vtkSmartPointer<vtkOrientedImageData>::New();
+  labelmapImage->vtkImageData::ShallowCopy(labelmapNode->GetImageData());
+  labelmapImage->SetGeometryFromImageToWorldMatrix(labelmapIjkToRasMatrix);
 
   // Apply parent transforms if any
   if (labelmapNode->GetParentTransformNode() || segmentationNode->GetParentTransformNode())
     {
     vtkSmartPointer<vtkGeneralTransform> labelmapToSegmentationTransform = vtkSmartPointer<vtkGeneralTransform>::New();
     vtkSlicerSegmentationsModuleLogic::GetTransformBetweenRepresentationAndSegmentation(labelmapNode, segmentationNode, labelmapToSegmentationTransform);
-    vtkOrientedImageDataResample::TransformOrientedImage(labelOrientedImageData, labelmapToSegmentationTransform);
+    vtkOrientedImageDataResample::TransformOrientedImage(labelmapImage, labelmapToSegmentationTransform);
     }
 
+  std::vector<int> labelValues;
+  vtkSmartPointer<vtkOrientedImageData> labelOrientedImageData = vtkSmartPointer<vtkOrientedImageData>::New();
+  GetLabelValuesAndCroppedLabelmap(labelmapImage, labelValues, labelOrientedImageData);
+
   MRMLNodeModifyBlocker blocker(segmentationNode);
-  for (int labelIndex = 0; labelIndex < labelValues->GetNumberOfValues(); ++labelIndex)
+  for (int label : labelValues)
     {
-    int label = labelValues->GetValue(labelIndex);
     vtkSmartPointer<vtkSegment> segment = vtkSmartPointer<vtkSegment>::New();
     segment->SetLabelValue(label);
 
@@ -1415,7 +1606,7 @@ bool vtkSlicerSegmentationsModuleLogic::ImportLabelmapToSegmentationNode(vtkMRML
 
     // If the labelname could not be found in the color node, and if there is only one label,
     // then the (only) segment name will be the labelmap name
-    if (!labelName && labelValues->GetNumberOfValues() == 1)
+    if (!labelName && labelValues.size() == 1)
       {
       labelName = labelmapNode->GetName();
       }
@@ -1429,15 +1620,6 @@ bool vtkSlicerSegmentationsModuleLogic::ImportLabelmapToSegmentationNode(vtkMRML
       }
     segment->SetName(labelName);
 
-    // Clip to effective extent
-    int labelOrientedImageDataEffectiveExtent[6] = { 0, -1, 0, -1, 0, -1 };
-    vtkOrientedImageDataResample::CalculateEffectiveExtent(labelOrientedImageData, labelOrientedImageDataEffectiveExtent);
-    vtkSmartPointer<vtkImageConstantPad> padder = vtkSmartPointer<vtkImageConstantPad>::New();
-    padder->SetInputData(labelOrientedImageData);
-    padder->SetOutputWholeExtent(labelOrientedImageDataEffectiveExtent);
-    padder->Update();
-    labelOrientedImageData->ShallowCopy(padder->GetOutput());
-
     // Add oriented image data as binary labelmap representation
     segment->AddRepresentation(
       vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName(),
@@ -1475,32 +1657,17 @@ bool vtkSlicerSegmentationsModuleLogic::ImportLabelmapToSegmentationNode(vtkOrie
 
   // Note: Splitting code ported from EditorLib/HelperBox.py:split
 
-  // Split labelmap node into per-label image data
-
-  vtkNew<vtkIntArray> labelValues;
-  vtkSlicerSegmentationsModuleLogic::GetAllLabelValues(labelValues.GetPointer(), labelmapImage);
-
-  MRMLNodeModifyBlocker blocker(segmentationNode);
-
-  // Clip to effective extent
-  int labelOrientedImageDataEffectiveExtent[6] = { 0, -1, 0, -1, 0, -1 };
-  vtkOrientedImageDataResample::CalculateEffectiveExtent(labelmapImage, labelOrientedImageDataEffectiveExtent);
-
-  vtkSmartPointer<vtkImageConstantPad> padder = vtkSmartPointer<vtkImageConstantPad>::New();
-  padder->SetInputData(labelmapImage);
-  padder->SetOutputWholeExtent(labelOrientedImageDataEffectiveExtent);
-  padder->Update();
+  // Split labelmap into segments that share the labelmap, cropped to the extent of all labels
 
+  std::vector<int> labelValues;
   vtkNew<vtkOrientedImageData> labelOrientedImageData;
-  labelOrientedImageData->ShallowCopy(padder->GetOutput());
+  GetLabelValuesAndCroppedLabelmap(labelmapImage, labelValues, labelOrientedImageData);
 
-  vtkSmartPointer<vtkMatrix4x4> labelmapImageToWorldMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
-  labelmapImage->GetImageToWorldMatrix(labelmapImageToWorldMatrix);
-  labelOrientedImageData->SetGeometryFromImageToWorldMatrix(labelmapImageToWorldMatrix);
+  MRMLNodeModifyBlocker blocker(segmentationNode);
 
-  for (int labelIndex = 0; labelIndex < labelValues->GetNumberOfValues(); ++labelIndex)
+  for (int labelIndex = 0; labelIndex < static_cast<int>(labelValues.size()); ++labelIndex)
     {
-    int label = labelValues->GetValue(labelIndex);
+    int label = labelValues[labelIndex];
 
     vtkSmartPointer<vtkSegment> segment = vtkSmartPointer<vtkSegment>::New();
 
@@ -2094,10 +2261,6 @@ bool vtkSlicerSegmentationsModuleLogic::ExportSegmentsClosedSurfaceRepresentatio
   const std::string coordinateSystemValue = (lps ? "LPS" : "RAS");
   const std::string coordinateSytemSpecification = "SPACE=" + coordinateSystemValue;
 
-  vtkNew<vtkTriangleFilter> triangulator;
-  vtkNew<vtkSTLWriter> writer;
-  writer->SetFileType(VTK_BINARY);
-  writer->SetInputConnection(triangulator->GetOutputPort());
   std::string header = std::string("3D Slicer output. ") + coordinateSytemSpecification;
   if (sizeScale != 1.0)
     {
@@ -2105,46 +2268,81 @@ bool vtkSlicerSegmentationsModuleLogic::ExportSegmentsClosedSurfaceRepresentatio
     strs << sizeScale;
     header += ";SCALE=" + strs.str();
     }
-  writer->SetHeader(header.c_str());
 
-  if (merge)
+  vtkNew<vtkTransform> transformRasToLps;
+  if (sizeScale != 1.0)
     {
-    vtkNew<vtkAppendPolyData> appendPolyData;
+    transformRasToLps->Scale(sizeScale, sizeScale, sizeScale);
+    }
+  if (lps)
+    {
+    transformRasToLps->Scale(-1, -1, 1);
+    }
+  // Make sure the transform is up-to-date before it is used from multiple threads
+  transformRasToLps->Update();
+  vtkSmartPointer<vtkGeneralTransform> segmentationToWorldTransform = GetSegmentationToWorldTransform(segmentationNode);
 
-    for (std::vector<std::string>::const_iterator segmentIdIt = segmentIDs.begin(); segmentIdIt != segmentIDs.end(); ++segmentIdIt)
+  // Get surfaces of all segments (converted in parallel if needed)
+  std::vector<vtkSmartPointer<vtkPolyData> > segmentPolyDatas;
+  GetSegmentClosedSurfaces(segmentationNode, segmentIDs, segmentPolyDatas);
+  for (size_t segmentIndex = 0; segmentIndex < segmentIDs.size(); ++segmentIndex)
+    {
+    if (!segmentPolyDatas[segmentIndex])
       {
-      vtkNew<vtkPolyData> segmentPolyData;
-      bool polyDataAvailable = vtkSlicerSegmentationsModuleLogic::GetSegmentClosedSurfaceRepresentation(
-        segmentationNode, *segmentIdIt, segmentPolyData.GetPointer());
-      if (!polyDataAvailable || segmentPolyData.GetPointer() == nullptr)
-        {
-        vtkErrorWithObjectMacro(segmentationNode, "ExportSegmentsClosedSurfaceRepresentationToFiles: Unable to convert segment "
-          << (*segmentIdIt) << " to closed surface representation");
-        continue;
-        }
-      appendPolyData->AddInputData(segmentPolyData.GetPointer());
+      vtkErrorWithObjectMacro(segmentationNode, "ExportSegmentsClosedSurfaceRepresentationToFiles: Unable to convert segment "
+        << segmentIDs[segmentIndex] << " to closed surface representation");
       }
-    vtkNew<vtkTransform> transformRasToLps;
-    if (sizeScale != 1.0)
+    }
+
+  std::string safeFileName = vtkSlicerSegmentationsModuleLogic::GetSafeFileName(segmentationNode->GetName());
+
+  // Transform surface to output coordinate system, triangulate, and write to file
+  auto writeSurface = [&header, &transformRasToLps, &segmentationToWorldTransform](vtkPolyData* surface, const std::string& filePath)
+    {
+    vtkNew<vtkTransformPolyDataFilter> transformPolyDataToOutput;
+    transformPolyDataToOutput->SetTransform(transformRasToLps);
+    vtkNew<vtkTransformPolyDataFilter> transformPolyDataToWorld;
+    if (segmentationToWorldTransform)
       {
-      transformRasToLps->Scale(sizeScale, sizeScale, sizeScale);
+      transformPolyDataToWorld->SetTransform(segmentationToWorldTransform);
+      transformPolyDataToWorld->SetInputData(surface);
+      transformPolyDataToOutput->SetInputConnection(transformPolyDataToWorld->GetOutputPort());
       }
-    if (lps)
+    else
       {
-      transformRasToLps->Scale(-1, -1, 1);
+      transformPolyDataToOutput->SetInputData(surface);
       }
-    vtkNew<vtkTransformPolyDataFilter> transformPolyDataToOutput;
-    transformPolyDataToOutput->SetTransform(transformRasToLps.GetPointer());
-    transformPolyDataToOutput->SetInputConnection(appendPolyData->GetOutputPort());
-    std::string safeFileName = vtkSlicerSegmentationsModuleLogic::GetSafeFileName(segmentationNode->GetName());
-    std::string filePath = destinationFolder + "/" + safeFileName + ".stl";
+    vtkNew<vtkTriangleFilter> triangulator;
     triangulator->SetInputConnection(transformPolyDataToOutput->GetOutputPort());
+    vtkNew<vtkSTLWriter> writer;
+    writer->SetFileType(VTK_BINARY);
+    writer->SetInputConnection(triangulator->GetOutputPort());
+    writer->SetHeader(header.c_str());
     writer->SetFileName(filePath.c_str());
     try
       {
       writer->Write();
       }
     catch (...)
+      {
+      return false;
+      }
+    return true;
+    };
+
+  if (merge)
+    {
+    vtkNew<vtkAppendPolyData> appendPolyData;
+    for (vtkPolyData* segmentPolyData : segmentPolyDatas)
+      {
+      if (segmentPolyData)
+        {
+        appendPolyData->AddInputData(segmentPolyData);
+        }
+      }
+    appendPolyData->Update();
+    std::string filePath = destinationFolder + "/" + safeFileName + ".stl";
+    if (!writeSurface(appendPolyData->GetOutput(), filePath))
       {
       vtkErrorWithObjectMacro(segmentationNode, "ExportSegmentsClosedSurfaceRepresentationToFiles:"
         " Unable to write segmentation to " << filePath);
@@ -2153,42 +2351,34 @@ bool vtkSlicerSegmentationsModuleLogic::ExportSegmentsClosedSurfaceRepresentatio
     }
   else
     {
-    for (std::vector<std::string>::const_iterator segmentIdIt = segmentIDs.begin(); segmentIdIt != segmentIDs.end(); ++segmentIdIt)
+    // Segments are written to separate files on worker threads
+    std::vector<std::string> filePaths;
+    for (const std::string& segmentID : segmentIDs)
       {
-      vtkNew<vtkPolyData> segmentPolyData;
-      bool polyDataAvailable = vtkSlicerSegmentationsModuleLogic::GetSegmentClosedSurfaceRepresentation(
-        segmentationNode, *segmentIdIt, segmentPolyData.GetPointer());
-      if (!polyDataAvailable || segmentPolyData.GetPointer() == nullptr)
-        {
-        vtkErrorWithObjectMacro(segmentationNode, "ExportSegmentsClosedSurfaceRepresentationToFiles: Unable to convert segment "
-          << (*segmentIdIt) << " to closed surface representation");
-        continue;
-        }
-      vtkNew<vtkTransform> transformRasToLps;
-      if (sizeScale != 1.0)
-        {
-        transformRasToLps->Scale(sizeScale, sizeScale, sizeScale);
-        }
-      if (lps)
-        {
-        transformRasToLps->Scale(-1, -1, 1);
-        }
-      vtkNew<vtkTransformPolyDataFilter> transformPolyDataToOutput;
-      transformPolyDataToOutput->SetTransform(transformRasToLps.GetPointer());
-      transformPolyDataToOutput->SetInputData(segmentPolyData.GetPointer());
-      std::string segmentName = segmentationNode->GetSegmentation()->GetSegment(*segmentIdIt)->GetName();
-      std::string safeFileName = vtkSlicerSegmentationsModuleLogic::GetSafeFileName(segmentationNode->GetName());
-      std::string filePath = destinationFolder + "/" + safeFileName + "_" + segmentName + ".stl";
-      triangulator->SetInputConnection(transformPolyDataToOutput->GetOutputPort());
-      writer->SetFileName(filePath.c_str());
-      try
+      vtkSegment* segment = segmentationNode->GetSegmentation()->GetSegment(segmentID);
+      std::string segmentName = (segment && segment->GetName()) ? segment->GetName() : segmentID;
+      filePaths.push_back(destinationFolder + "/" + safeFileName + "_" + segmentName + ".stl");
+      }
+    std::vector<char> segmentWritten(segmentIDs.size(), 1);
+    auto writeSegmentSurfaces = [&segmentPolyDatas, &filePaths, &segmentWritten, &writeSurface](vtkIdType begin, vtkIdType end)
+      {
+      for (vtkIdType segmentIndex = begin; segmentIndex < end; ++segmentIndex)
         {
-        writer->Write();
+        if (!segmentPolyDatas[segmentIndex])
+          {
+          continue;
+          }
+        segmentWritten[segmentIndex] = writeSurface(segmentPolyDatas[segmentIndex], filePaths[segmentIndex]);
         }
-      catch (...)
+      };
+    ForEachSegment(segmentationNode->GetSegmentation(), static_cast<vtkIdType>(segmentIDs.size()), writeSegmentSurfaces);
+
+    for (size_t segmentIndex = 0; segmentIndex < segmentIDs.size(); ++segmentIndex)
+      {
+      if (!segmentWritten[segmentIndex])
         {
         vtkErrorWithObjectMacro(segmentationNode, "ExportSegmentsClosedSurfaceRepresentationToFiles:"
-          " Unable to write segmentation to " << filePath);
+          " Unable to write segmentation to " << filePaths[segmentIndex]);
         return false;
         }
       }
@@ -2212,17 +2402,29 @@ bool vtkSlicerSegmentationsModuleLogic::ExportSegmentsClosedSurfaceRepresentatio
   vtkNew<vtkRenderWindow> renderWindow;
   renderWindow->AddRenderer(renderer.GetPointer());
 
-  for (std::vector<std::string>::const_iterator segmentIdIt = segmentIDs.begin(); segmentIdIt != segmentIDs.end(); ++segmentIdIt)
+  // Get surfaces of all segments (converted in parallel if needed)
+  std::vector<vtkSmartPointer<vtkPolyData> > segmentPolyDatas;
+  GetSegmentClosedSurfaces(segmentationNode, segmentIDs, segmentPolyDatas);
+  vtkSmartPointer<vtkGeneralTransform> segmentationToWorldTransform = GetSegmentationToWorldTransform(segmentationNode);
+
+  for (size_t segmentIndex = 0; segmentIndex < segmentIDs.size(); ++segmentIndex)
     {
-    vtkNew<vtkPolyData> segmentPolyData;
-    bool polyDataAvailable = vtkSlicerSegmentationsModuleLogic::GetSegmentClosedSurfaceRepresentation(
-      segmentationNode, *segmentIdIt, segmentPolyData.GetPointer());
-    if (!polyDataAvailable || segmentPolyData.GetPointer() == nullptr)
+    const std::string& segmentId = segmentIDs[segmentIndex];
+    vtkSmartPointer<vtkPolyData> segmentPolyData = segmentPolyDatas[segmentIndex];
+    if (!segmentPolyData)
       {
       vtkErrorWithObjectMacro(segmentationNode, "ExportSegmentsClosedSurfaceRepresentationToObjFile: Unable to convert segment "
-        << (*segmentIdIt) << " to closed surface representation");
+        << segmentId << " to closed surface representation");
       continue;
       }
+    if (segmentationToWorldTransform)
+      {
+      vtkNew<vtkTransformPolyDataFilter> transformPolyDataToWorld;
+      transformPolyDataToWorld->SetTransform(segmentationToWorldTransform);
+      transformPolyDataToWorld->SetInputData(segmentPolyData);
+      transformPolyDataToWorld->Update();
+      segmentPolyData = transformPolyDataToWorld->GetOutput();
+      }
     vtkNew<vtkTransform> transformRasToLps;
     if (sizeScale != 1.0)
       {
@@ -2234,7 +2436,7 @@ bool vtkSlicerSegmentationsModuleLogic::ExportSegmentsClosedSurfaceRepresentatio
       }
     vtkNew<vtkTransformPolyDataFilter> transformPolyDataToOutput;
     transformPolyDataToOutput->SetTransform(transformRasToLps.GetPointer());
-    transformPolyDataToOutput->SetInputData(segmentPolyData.GetPointer());
+    transformPolyDataToOutput->SetInputData(segmentPolyData);
     vtkNew<vtkPolyDataMapper> mapper;
     mapper->SetInputConnection(transformPolyDataToOutput->GetOutputPort());
     vtkNew<vtkActor> actor;
@@ -2243,13 +2445,13 @@ bool vtkSlicerSegmentationsModuleLogic::ExportSegmentsClosedSurfaceRepresentatio
     if (displayNode)
       {
       double color[3] = { 0.5, 0.5, 0.5 };
-      displayNode->GetSegmentColor(*segmentIdIt, color);
+      displayNode->GetSegmentColor(segmentId, color);
       // OBJ exporter sets the same color for ambient, diffuse, specular
       // so we scale it by 1/3 to avoid having too bright material.
       double colorScale = 1.0 / 3.0;
       actor->GetProperty()->SetColor(color[0] * colorScale, color[1] * colorScale, color[2] * colorScale);
       actor->GetProperty()->SetSpecularPower(3.0);
-      actor->GetProperty()->SetOpacity(displayNode->GetSegmentOpacity3D(*segmentIdIt));
+      actor->GetProperty()->SetOpacity(displayNode->GetSegmentOpacity3D(segmentId));
       }
     renderer->AddActor(actor.GetPointer());
     }
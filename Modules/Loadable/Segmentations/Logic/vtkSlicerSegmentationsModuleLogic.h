@@ -145,6 +145,8 @@ public:
   static bool ExportSegmentToRepresentationNode(vtkSegment* segment, vtkMRMLNode* representationNode);
 
   /// Export multiple segments into a folder, a model node from each segment
+  /// Surfaces are generated and copied on multiple threads if parallel conversion is enabled
+  /// in the segmentation (see vtkSegmentation::ParallelConversion). Nodes are created on the calling thread.
   /// \param segmentationNode Segmentation node from which the the segments are exported
   /// \param segmentIds List of segment IDs to export
   /// \param folderItemId Subject hierarchy folder item ID to export the segments to
@@ -252,6 +254,8 @@ public:
     vtkIdType folderItemId, vtkMRMLSegmentationNode* segmentationNode, std::string insertBeforeSegmentId = "" );
 
   /// Export closed surface representation of multiple segments to files. Typically used for writing 3D printable model files.
+  /// Surfaces are generated and separate files are written on multiple threads if parallel conversion is enabled
+  /// in the segmentation (see vtkSegmentation::ParallelConversion).
   /// \param segmentationNode Segmentation node from which the the segments are exported
   /// \param destinationFolder Folder name where segments will be exported to
   /// \param fileFormat Output file format (STL or OBJ).
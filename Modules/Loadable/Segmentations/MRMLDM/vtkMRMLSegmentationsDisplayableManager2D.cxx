@@ -30,7 +30,9 @@
 #include <vtkMRMLTransformNode.h>
 
 // MRML logic includes
+#include "vtkImageLabelMapToRGBA.h"
 #include "vtkImageLabelOutline.h"
+#include "vtkIndexedPolyDataPlaneCutter.h"
 
 // SegmentationCore includes
 #include "vtkSegmentation.h"
@@ -42,8 +44,6 @@
 #include <vtkActor2D.h>
 #include <vtkCallbackCommand.h>
 #include <vtkCellArray.h>
-#include <vtkCompositeDataGeometryFilter.h>
-#include <vtkPlaneCutter.h>
 #include <vtkCleanPolyData.h>
 #include <vtkContourTriangulator.h>
 #include <vtkDataSetAttributes.h>
@@ -144,19 +144,16 @@ public:
       // Create poly data pipeline
       this->PolyDataOutlineActor = vtkSmartPointer<vtkActor2D>::New();
       this->PolyDataFillActor = vtkSmartPointer<vtkActor2D>::New();
-      this->Cutter = vtkSmartPointer<vtkPlaneCutter>::New();
+      this->Cutter = vtkSmartPointer<vtkIndexedPolyDataPlaneCutter>::New();
       this->ModelWarper = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
       this->Plane = vtkSmartPointer<vtkPlane>::New();
       this->Triangulator = vtkSmartPointer<vtkContourTriangulator>::New();
 
       // Set up poly data outline pipeline
       this->Cutter->SetInputConnection(this->ModelWarper->GetOutputPort());
-      this->Cutter->SetPlane(this->Plane);
-      this->Cutter->BuildTreeOff(); // the cutter crashes for complex geometries if build tree is enabled
+      this->Cutter->SetPlane(this->Plane); // triangles are indexed along the plane normal, index is reused while scrolling
       vtkSmartPointer<vtkTransformPolyDataFilter> polyDataOutlineTransformer = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
-      vtkNew<vtkCompositeDataGeometryFilter> geometryFilter; // merge multi-piece output of vtkPlaneCutter
-      geometryFilter->SetInputConnection(this->Cutter->GetOutputPort());
-      polyDataOutlineTransformer->SetInputConnection(geometryFilter->GetOutputPort());
+      polyDataOutlineTransformer->SetInputConnection(this->Cutter->GetOutputPort());
       polyDataOutlineTransformer->SetTransform(this->WorldToSliceTransform);
       vtkSmartPointer<vtkPolyDataMapper2D> polyDataOutlineMapper = vtkSmartPointer<vtkPolyDataMapper2D>::New();
       polyDataOutlineMapper->SetInputConnection(polyDataOutlineTransformer->GetOutputPort());
@@ -167,7 +164,7 @@ public:
       // Set up poly data fill pipeline
       vtkNew<vtkCleanPolyData> pointMerger;
       pointMerger->PointMergingOn();
-      pointMerger->SetInputConnection(geometryFilter->GetOutputPort());
+      pointMerger->SetInputConnection(this->Cutter->GetOutputPort());
       this->Triangulator->SetInputConnection(pointMerger->GetOutputPort());
       vtkSmartPointer<vtkTransformPolyDataFilter> polyDataFillTransformer = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
       polyDataFillTransformer->SetInputConnection(this->Triangulator->GetOutputPort());
@@ -187,6 +184,7 @@ public:
       this->LookupTableOutline = vtkSmartPointer<vtkLookupTable>::New();
       this->LookupTableFill = vtkSmartPointer<vtkLookupTable>::New();
       this->ImageThreshold = vtkSmartPointer<vtkImageThreshold>::New();
+      this->LabelMapToRGBA = vtkSmartPointer<vtkImageLabelMapToRGBA>::New();
 
       // Set up image pipeline
       this->Reslice->SetBackgroundColor(0.0, 0.0, 0.0, 0.0);
@@ -217,16 +215,22 @@ public:
       this->ImageOutlineActor->SetVisibility(0);
 
       // Image fill
-      vtkSmartPointer<vtkImageMapToRGBA> fillColorMapper = vtkSmartPointer<vtkImageMapToRGBA>::New();
-      fillColorMapper->SetInputConnection(this->Reslice->GetOutputPort());
-      fillColorMapper->SetOutputFormatToRGBA();
-      fillColorMapper->SetLookupTable(this->LookupTableFill);
+      this->FillColorMapper = vtkSmartPointer<vtkImageMapToRGBA>::New();
+      this->FillColorMapper->SetInputConnection(this->Reslice->GetOutputPort());
+      this->FillColorMapper->SetOutputFormatToRGBA();
+      this->FillColorMapper->SetLookupTable(this->LookupTableFill);
       vtkSmartPointer<vtkImageMapper> imageFillMapper = vtkSmartPointer<vtkImageMapper>::New();
-      imageFillMapper->SetInputConnection(fillColorMapper->GetOutputPort());
+      imageFillMapper->SetInputConnection(this->FillColorMapper->GetOutputPort());
       imageFillMapper->SetColorWindow(255);
       imageFillMapper->SetColorLevel(127.5);
       this->ImageFillActor->SetMapper(imageFillMapper);
       this->ImageFillActor->SetVisibility(0);
+
+      // Binary labelmap fill and outline in a single pass (displayed by the image fill actor).
+      // All segments of a shared labelmap layer are colorized by one filter, using the
+      // per-label color and opacity stored in the fill and outline lookup tables.
+      this->LabelMapToRGBA->SetFillLookupTable(this->LookupTableFill);
+      this->LabelMapToRGBA->SetOutlineLookupTable(this->LookupTableOutline);
       }
 
     vtkSmartPointer<vtkTransform> WorldToSliceTransform;
@@ -237,7 +241,7 @@ public:
     vtkSmartPointer<vtkActor2D> PolyDataFillActor;
     vtkSmartPointer<vtkTransformPolyDataFilter> ModelWarper;
     vtkSmartPointer<vtkPlane> Plane;
-    vtkSmartPointer<vtkPlaneCutter> Cutter;
+    vtkSmartPointer<vtkIndexedPolyDataPlaneCutter> Cutter;
     vtkSmartPointer<vtkContourTriangulator> Triangulator;
 
     vtkSmartPointer<vtkActor2D> ImageOutlineActor;
@@ -248,6 +252,8 @@ public:
     vtkSmartPointer<vtkLookupTable> LookupTableOutline;
     vtkSmartPointer<vtkLookupTable> LookupTableFill;
     vtkSmartPointer<vtkImageThreshold> ImageThreshold;
+    vtkSmartPointer<vtkImageMapToRGBA> FillColorMapper;
+    vtkSmartPointer<vtkImageLabelMapToRGBA> LabelMapToRGBA;
 
     vtkMTimeType SliceIntersectionUpdatedTime;
     };
@@ -769,9 +775,21 @@ void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::UpdateDisplayNodePip
       }
 
     bool pipelineVisiblity = false;
-    for (std::string segmentId : sharedSegmentIds)
+    if (imageData && !sharedSegmentIds.empty())
       {
-      pipelineVisiblity |= this->IsSegmentVisibleInCurrentSlice(displayNode, pipeline, segmentId);
+      // All segments in a shared labelmap have the same bounds, check only once
+      pipelineVisiblity = this->IsSegmentVisibleInCurrentSlice(displayNode, pipeline, sharedSegmentIds[0]);
+      }
+    else
+      {
+      for (std::string segmentId : sharedSegmentIds)
+        {
+        if (this->IsSegmentVisibleInCurrentSlice(displayNode, pipeline, segmentId))
+          {
+          pipelineVisiblity = true;
+          break;
+          }
+        }
       }
 
     if (!pipelineVisiblity)
@@ -886,10 +904,14 @@ void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::UpdateDisplayNodePip
           }
         }
 
+      // Binary labelmaps are colorized and outlined in a single pass and displayed by the fill actor.
+      // Fractional labelmaps need thresholding and color ramps, so they use separate fill and outline pipelines.
+      bool fractionalLabelmap = (shownRepresenatationName == vtkSegmentationConverter::GetFractionalLabelmapRepresentationName());
+
       // Update pipeline actors
-      pipeline->ImageOutlineActor->SetVisibility(outlineVisible);
+      pipeline->ImageOutlineActor->SetVisibility(outlineVisible && fractionalLabelmap);
       pipeline->ImageOutlineActor->SetPosition(0, 0);
-      pipeline->ImageFillActor->SetVisibility(fillVisible);
+      pipeline->ImageFillActor->SetVisibility(fractionalLabelmap ? fillVisible : (fillVisible || outlineVisible));
       pipeline->ImageFillActor->SetPosition(0, 0);
 
       if (!outlineVisible && !fillVisible)
@@ -898,7 +920,7 @@ void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::UpdateDisplayNodePip
         }
 
       // Set outline properties and turn it off if not shown
-      if (outlineVisible)
+      if (outlineVisible && fractionalLabelmap)
         {
         pipeline->LabelOutline->SetOutline(genericDisplayNode->GetSliceIntersectionThickness());
         }
@@ -906,6 +928,7 @@ void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::UpdateDisplayNodePip
         {
         pipeline->LabelOutline->SetInputConnection(nullptr);
         }
+      pipeline->LabelMapToRGBA->SetOutline(outlineVisible ? genericDisplayNode->GetSliceIntersectionThickness() : 0);
 
       // Set the range of the scalars in the image data from the ScalarRange field if it exists
       // Default to the scalar range of 0.0 to 1.0 otherwise
@@ -1079,11 +1102,24 @@ void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::UpdateDisplayNodePip
       int sliceOutputExtent[6] = { 0, dimensions[0] - 1, 0, dimensions[1] - 1, 0, dimensions[2] - 1 };
       pipeline->Reslice->SetOutputExtent(sliceOutputExtent);
 
-      // Smooth the border of fractional labelmaps
-      pipeline->LabelOutline->SetInputConnection(pipeline->Reslice->GetOutputPort());
-      pipeline->ImageFillActor->GetMapper()->GetInputAlgorithm()->SetInputConnection(pipeline->Reslice->GetOutputPort());
-      if (shownRepresenatationName == vtkSegmentationConverter::GetSegmentationFractionalLabelmapRepresentationName())
+      if (!fractionalLabelmap)
         {
+        // Single-pass fill and outline
+        pipeline->LabelMapToRGBA->SetInputConnection(pipeline->Reslice->GetOutputPort());
+        pipeline->ImageFillActor->GetMapper()->SetInputConnection(pipeline->LabelMapToRGBA->GetOutputPort());
+        pipeline->FillColorMapper->SetInputConnection(nullptr);
+        }
+      else
+        {
+        pipeline->LabelMapToRGBA->SetInputConnection(nullptr);
+        pipeline->FillColorMapper->SetInputConnection(pipeline->Reslice->GetOutputPort());
+        pipeline->ImageFillActor->GetMapper()->SetInputConnection(pipeline->FillColorMapper->GetOutputPort());
+        if (outlineVisible)
+          {
+          pipeline->LabelOutline->SetInputConnection(pipeline->Reslice->GetOutputPort());
+          }
+
+        // Smooth the border of fractional labelmaps
         // If ThresholdValue is not specified, then do not perform thresholding
         vtkDoubleArray* thresholdValue = vtkDoubleArray::SafeDownCast(
           imageData->GetFieldData()->GetAbstractArray(vtkSegmentationConverter::GetThresholdValueFieldName()));
@@ -1091,10 +1127,13 @@ void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::UpdateDisplayNodePip
           {
           if (!this->SmoothFractionalLabelMapBorder && thresholdValue && thresholdValue->GetNumberOfValues() == 1)
             {
-            pipeline->ImageFillActor->GetMapper()->GetInputAlgorithm()->SetInputConnection(pipeline->ImageThreshold->GetOutputPort());
+            pipeline->FillColorMapper->SetInputConnection(pipeline->ImageThreshold->GetOutputPort());
             }
           pipeline->ImageThreshold->ThresholdByLower(thresholdValue->GetValue(0));
-          pipeline->LabelOutline->SetInputConnection(pipeline->ImageThreshold->GetOutputPort());
+          if (outlineVisible)
+            {
+            pipeline->LabelOutline->SetInputConnection(pipeline->ImageThreshold->GetOutputPort());
+            }
           }
         }
       }
@@ -0,0 +1,193 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Segmentations includes
+#include "vtkOrientedImageData.h"
+#include "vtkOrientedImageDataResample.h"
+#include "vtkSlicerAnalyticBrushPainter.h"
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+
+// VTK includes
+#include <vtkCylinderSource.h>
+#include <vtkImageChangeInformation.h>
+#include <vtkImageStencilToImage.h>
+#include <vtkMath.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyDataNormals.h>
+#include <vtkPolyDataToImageStencil.h>
+#include <vtkSphereSource.h>
+#include <vtkTransform.h>
+#include <vtkTransformPolyDataFilter.h>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkOrientedImageData> CreateLabelmap()
+{
+  vtkSmartPointer<vtkOrientedImageData> labelmap = vtkSmartPointer<vtkOrientedImageData>::New();
+  labelmap->SetExtent(0, 79, 0, 79, 0, 39);
+  labelmap->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  labelmap->GetPointData()->GetScalars()->Fill(0);
+  return labelmap;
+}
+
+//----------------------------------------------------------------------------
+/// Paint the brushes the same way as the paint effect does for custom brush shapes:
+/// rasterize the brush model into a stencil once and add it to the labelmap at each position.
+void PaintStencilBrushes(vtkAlgorithmOutput* brushModel, vtkMatrix4x4* brushToIjkMatrix,
+  vtkPoints* positions_Ijk, vtkOrientedImageData* labelmap)
+{
+  vtkNew<vtkTransform> brushToIjkTransform;
+  brushToIjkTransform->SetMatrix(brushToIjkMatrix);
+  vtkNew<vtkTransformPolyDataFilter> brushToIjkTransformer;
+  brushToIjkTransformer->SetTransform(brushToIjkTransform);
+  brushToIjkTransformer->SetInputConnection(brushModel);
+  vtkNew<vtkPolyDataNormals> brushNormals;
+  brushNormals->SetInputConnection(brushToIjkTransformer->GetOutputPort());
+  brushNormals->AutoOrientNormalsOn();
+  brushNormals->Update();
+
+  double* boundsIjk = brushNormals->GetOutput()->GetBounds();
+  vtkNew<vtkPolyDataToImageStencil> polyDataToStencil;
+  polyDataToStencil->SetInputConnection(brushNormals->GetOutputPort());
+  polyDataToStencil->SetOutputSpacing(1.0, 1.0, 1.0);
+  polyDataToStencil->SetOutputWholeExtent(floor(boundsIjk[0]) - 1, ceil(boundsIjk[1]) + 1,
+    floor(boundsIjk[2]) - 1, ceil(boundsIjk[3]) + 1, floor(boundsIjk[4]) - 1, ceil(boundsIjk[5]) + 1);
+
+  vtkNew<vtkImageStencilToImage> stencilToImage;
+  stencilToImage->SetInputConnection(polyDataToStencil->GetOutputPort());
+  stencilToImage->SetInsideValue(1);
+  stencilToImage->SetOutsideValue(0);
+  stencilToImage->SetOutputScalarType(labelmap->GetScalarType());
+
+  vtkNew<vtkImageChangeInformation> brushPositioner;
+  brushPositioner->SetInputConnection(stencilToImage->GetOutputPort());
+  brushPositioner->SetOutputSpacing(labelmap->GetSpacing());
+  brushPositioner->SetOutputOrigin(labelmap->GetOrigin());
+  for (vtkIdType pointIndex = 0; pointIndex < positions_Ijk->GetNumberOfPoints(); ++pointIndex)
+    {
+    double* position = positions_Ijk->GetPoint(pointIndex);
+    int shift[3] = { vtkMath::Round(position[0]), vtkMath::Round(position[1]), vtkMath::Round(position[2]) };
+    brushPositioner->SetExtentTranslation(shift);
+    brushPositioner->Update();
+    vtkNew<vtkOrientedImageData> brushImage;
+    brushImage->ShallowCopy(brushPositioner->GetOutput());
+    brushImage->CopyDirections(labelmap);
+    vtkOrientedImageDataResample::ModifyImage(labelmap, brushImage, vtkOrientedImageDataResample::OPERATION_MAXIMUM);
+    }
+}
+
+//----------------------------------------------------------------------------
+/// Compare voxels painted analytically and through the stencil.
+/// Only voxels whose center is very close to the brush surface may differ, because the brush model is a polygonal
+/// approximation of the shape.
+int CompareBrushes(const char* brushName, vtkOrientedImageData* analyticLabelmap, vtkOrientedImageData* stencilLabelmap)
+{
+  unsigned char* analyticVoxels = static_cast<unsigned char*>(analyticLabelmap->GetScalarPointer());
+  unsigned char* stencilVoxels = static_cast<unsigned char*>(stencilLabelmap->GetScalarPointer());
+  vtkIdType numberOfAnalyticVoxels = 0;
+  vtkIdType numberOfStencilVoxels = 0;
+  vtkIdType numberOfDifferentVoxels = 0;
+  for (vtkIdType i = 0; i < analyticLabelmap->GetNumberOfPoints(); ++i)
+    {
+    numberOfAnalyticVoxels += (analyticVoxels[i] ? 1 : 0);
+    numberOfStencilVoxels += (stencilVoxels[i] ? 1 : 0);
+    numberOfDifferentVoxels += (analyticVoxels[i] != stencilVoxels[i] ? 1 : 0);
+    }
+  std::cout << brushName << ": " << numberOfAnalyticVoxels << " voxels painted analytically, "
+    << numberOfStencilVoxels << " through the stencil, " << numberOfDifferentVoxels << " different" << std::endl;
+  CHECK_BOOL(numberOfStencilVoxels > 0, true);
+  if (numberOfDifferentVoxels * 50 > numberOfStencilVoxels)
+    {
+    std::cerr << "Line " << __LINE__ << ": " << brushName << " brush painted analytically differs from the stencil in "
+      << numberOfDifferentVoxels << " voxels (more than 2% of " << numberOfStencilVoxels << ")" << std::endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkSlicerAnalyticBrushPainterTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  // Oblique brush orientation and anisotropic voxels, as in a rotated slice view of a volume with thick slices.
+  // Brush positions are farther from each other than the brush diameter, so the brushes are not swept between them.
+  vtkNew<vtkTransform> brushToIjkTransform;
+  brushToIjkTransform->Scale(1.0, 1.0, 0.5);
+  brushToIjkTransform->RotateZ(30.0);
+  brushToIjkTransform->RotateY(20.0);
+  vtkNew<vtkPoints> positions_Ijk;
+  positions_Ijk->InsertNextPoint(20.2, 20.4, 10.0);
+  positions_Ijk->InsertNextPoint(55.0, 25.0, 20.3);
+  positions_Ijk->InsertNextPoint(40.0, 58.7, 29.6);
+
+  // Sphere brush
+  vtkNew<vtkSphereSource> sphereSource;
+  sphereSource->SetRadius(9.0);
+  sphereSource->SetPhiResolution(32);
+  sphereSource->SetThetaResolution(32);
+
+  vtkNew<vtkSlicerAnalyticBrushPainter> painter;
+  painter->SetBrushShapeToSphere();
+  painter->SetRadius(sphereSource->GetRadius());
+  painter->SetCenter(sphereSource->GetCenter());
+  painter->SetBrushToIjkMatrix(brushToIjkTransform->GetMatrix());
+  painter->SetFillValue(1);
+
+  vtkSmartPointer<vtkOrientedImageData> analyticSphereLabelmap = CreateLabelmap();
+  int updateExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  CHECK_BOOL(painter->Paint(analyticSphereLabelmap, positions_Ijk, updateExtent), true);
+  vtkSmartPointer<vtkOrientedImageData> stencilSphereLabelmap = CreateLabelmap();
+  PaintStencilBrushes(sphereSource->GetOutputPort(), brushToIjkTransform->GetMatrix(), positions_Ijk, stencilSphereLabelmap);
+  CHECK_EXIT_SUCCESS(CompareBrushes("Sphere", analyticSphereLabelmap, stencilSphereLabelmap));
+
+  // Cylinder brush, with its axis rotated to the Z axis, as in slice views
+  vtkNew<vtkCylinderSource> cylinderSource;
+  cylinderSource->SetRadius(9.0);
+  cylinderSource->SetHeight(6.0);
+  cylinderSource->SetResolution(32);
+  vtkNew<vtkTransform> cylinderToIjkTransform;
+  cylinderToIjkTransform->Concatenate(brushToIjkTransform->GetMatrix());
+  cylinderToIjkTransform->RotateX(90.0);
+
+  painter->SetBrushShapeToCylinder();
+  painter->SetRadius(cylinderSource->GetRadius());
+  painter->SetHeight(cylinderSource->GetHeight());
+  painter->SetCenter(cylinderSource->GetCenter());
+  painter->SetBrushToIjkMatrix(cylinderToIjkTransform->GetMatrix());
+
+  vtkSmartPointer<vtkOrientedImageData> analyticCylinderLabelmap = CreateLabelmap();
+  CHECK_BOOL(painter->Paint(analyticCylinderLabelmap, positions_Ijk, updateExtent), true);
+  vtkSmartPointer<vtkOrientedImageData> stencilCylinderLabelmap = CreateLabelmap();
+  PaintStencilBrushes(cylinderSource->GetOutputPort(), cylinderToIjkTransform->GetMatrix(), positions_Ijk, stencilCylinderLabelmap);
+  CHECK_EXIT_SUCCESS(CompareBrushes("Cylinder", analyticCylinderLabelmap, stencilCylinderLabelmap));
+
+  // Multi-component labelmaps are not supported, the caller falls back to the stencil
+  vtkNew<vtkOrientedImageData> multiComponentLabelmap;
+  multiComponentLabelmap->SetExtent(0, 9, 0, 9, 0, 9);
+  multiComponentLabelmap->AllocateScalars(VTK_UNSIGNED_CHAR, 2);
+  CHECK_BOOL(painter->Paint(multiComponentLabelmap, positions_Ijk, updateExtent), false);
+
+  std::cout << "Analytic brush painter test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
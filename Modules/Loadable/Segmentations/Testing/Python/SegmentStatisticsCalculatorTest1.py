@@ -0,0 +1,142 @@
+import logging
+import time
+import unittest
+
+import numpy as np
+import vtk
+
+import slicer
+
+'''
+This class tests computation of segment statistics of all segments in a single pass.
+Results are compared to statistics computed by numpy for each segment separately.
+'''
+
+
+class SegmentStatisticsCalculatorTest1(unittest.TestCase):
+
+    # ------------------------------------------------------------------------------
+    def setUp(self):
+        """ Do whatever is needed to reset the state - typically a scene clear will be enough.
+        """
+        slicer.mrmlScene.Clear(0)
+
+    # ------------------------------------------------------------------------------
+    def runTest(self):
+        """Run as few or as many tests as needed here.
+        """
+        self.setUp()
+        self.test_SegmentStatisticsCalculatorTest1()
+
+    # ------------------------------------------------------------------------------
+    def test_SegmentStatisticsCalculatorTest1(self):
+        self.TestSection_CreateInputData()
+        self.TestSection_LabelmapStatistics()
+        self.TestSection_ScalarVolumeStatistics()
+        logging.info('Test finished')
+
+    # ------------------------------------------------------------------------------
+    def TestSection_CreateInputData(self):
+        # Noisy volume and a labelmap with a few boxes and a sphere
+        shape = (40, 50, 60)
+        randomState = np.random.RandomState(42)
+        self.volumeArray = randomState.randint(-100, 1000, shape).astype(np.int16)
+        self.labelArray = np.zeros(shape, dtype=np.int16)
+        self.labelArray[5:15, 10:30, 20:25] = 1
+        self.labelArray[20:35, 5:10, 5:50] = 2
+        z, y, x = np.mgrid[0:shape[0], 0:shape[1], 0:shape[2]]
+        self.labelArray[(z - 25) ** 2 + (y - 35) ** 2 + (x - 40) ** 2 < 64] = 5
+
+        ijkToRas = vtk.vtkMatrix4x4()
+        ijkToRas.SetElement(0, 0, -0.8)
+        ijkToRas.SetElement(1, 1, -1.2)
+        ijkToRas.SetElement(2, 2, 2.0)
+        ijkToRas.SetElement(0, 3, 10.0)
+        ijkToRas.SetElement(1, 3, -20.0)
+        ijkToRas.SetElement(2, 3, 5.0)
+        self.ijkToRas = ijkToRas
+
+        self.volumeNode = slicer.util.addVolumeFromArray(self.volumeArray, ijkToRas, "Volume")
+        labelmapNode = slicer.util.addVolumeFromArray(self.labelArray, ijkToRas, "Labels", "vtkMRMLLabelMapVolumeNode")
+        self.segmentationNode = slicer.mrmlScene.AddNewNodeByClass("vtkMRMLSegmentationNode")
+        slicer.modules.segmentations.logic().ImportLabelmapToSegmentationNode(labelmapNode, self.segmentationNode)
+        segmentation = self.segmentationNode.GetSegmentation()
+        self.assertEqual(segmentation.GetNumberOfSegments(), 3)
+        self.segmentIDs = [segmentation.GetNthSegmentID(index) for index in range(3)]
+        self.labelValues = [segmentation.GetSegment(segmentID).GetLabelValue() for segmentID in self.segmentIDs]
+
+    # ------------------------------------------------------------------------------
+    def ijkToRasPoints(self, ijkPoints):
+        matrix = slicer.util.arrayFromVTKMatrix(self.ijkToRas)
+        return ijkPoints @ matrix[:3, :3].T + matrix[:3, 3]
+
+    # ------------------------------------------------------------------------------
+    def TestSection_LabelmapStatistics(self):
+        calculator = slicer.vtkSlicerSegmentStatisticsCalculator()
+        calculator.SetSegmentationNode(self.segmentationNode)
+        startTime = time.time()
+        self.assertTrue(calculator.Compute())
+        logging.info(f'Labelmap statistics computation time: {time.time() - startTime:.3f} s')
+
+        voxelVolume = 0.8 * 1.2 * 2.0
+        for segmentID, labelValue in zip(self.segmentIDs, self.labelValues):
+            self.assertTrue(calculator.HasStatistics(segmentID))
+            self.assertFalse(calculator.HasScalarStatistics(segmentID))
+            k, j, i = np.nonzero(self.labelArray == labelValue)
+            self.assertEqual(calculator.GetVoxelCount(segmentID), len(i))
+            self.assertAlmostEqual(calculator.GetVolumeMm3(segmentID), len(i) * voxelVolume, places=3)
+            self.assertAlmostEqual(calculator.GetVolumeCm3(segmentID), len(i) * voxelVolume * 0.001, places=6)
+
+            extent = [0] * 6
+            self.assertTrue(calculator.GetExtent(segmentID, extent))
+            self.assertEqual(extent, [i.min(), i.max(), j.min(), j.max(), k.min(), k.max()])
+
+            rasPoints = self.ijkToRasPoints(np.stack([i, j, k], axis=1).astype(float))
+            centroid = [0.0] * 3
+            self.assertTrue(calculator.GetCentroidRAS(segmentID, centroid))
+            self.assertTrue(np.allclose(centroid, rasPoints.mean(axis=0)))
+
+            bounds = [0.0] * 6
+            self.assertTrue(calculator.GetBoundsRAS(segmentID, bounds))
+            halfVoxel = np.array([0.4, 0.6, 1.0])
+            self.assertTrue(np.allclose(bounds[0::2], rasPoints.min(axis=0) - halfVoxel))
+            self.assertTrue(np.allclose(bounds[1::2], rasPoints.max(axis=0) + halfVoxel))
+
+            expectedMoments, expectedAxes = np.linalg.eigh(np.cov(rasPoints.T, bias=True))
+            moments = [0.0] * 3
+            self.assertTrue(calculator.GetPrincipalMoments(segmentID, moments))
+            self.assertTrue(np.allclose(moments, expectedMoments))
+            for axisIndex in range(3):
+                if any(np.isclose(expectedMoments[axisIndex], expectedMoments[otherIndex]) for otherIndex in range(3) if otherIndex != axisIndex):
+                    # Axis of equal moments is not unique
+                    continue
+                axis = [0.0] * 3
+                self.assertTrue(calculator.GetPrincipalAxis(segmentID, axisIndex, axis))
+                self.assertAlmostEqual(abs(np.dot(axis, expectedAxes[:, axisIndex])), 1.0, places=6)
+            self.assertAlmostEqual(calculator.GetElongation(segmentID), np.sqrt(expectedMoments[2] / expectedMoments[1]), places=6)
+            self.assertAlmostEqual(calculator.GetFlatness(segmentID), np.sqrt(expectedMoments[1] / expectedMoments[0]), places=6)
+
+    # ------------------------------------------------------------------------------
+    def TestSection_ScalarVolumeStatistics(self):
+        calculator = slicer.vtkSlicerSegmentStatisticsCalculator()
+        calculator.SetSegmentationNode(self.segmentationNode)
+        calculator.SetScalarVolumeNode(self.volumeNode)
+        segmentIDs = vtk.vtkStringArray()
+        segmentIDs.InsertNextValue(self.segmentIDs[0])
+        segmentIDs.InsertNextValue(self.segmentIDs[2])
+        calculator.SetSegmentIDs(segmentIDs)
+        startTime = time.time()
+        self.assertTrue(calculator.Compute())
+        logging.info(f'Scalar volume statistics computation time: {time.time() - startTime:.3f} s')
+
+        self.assertFalse(calculator.HasStatistics(self.segmentIDs[1]))
+        for segmentID, labelValue in [(self.segmentIDs[0], self.labelValues[0]), (self.segmentIDs[2], self.labelValues[2])]:
+            self.assertTrue(calculator.HasScalarStatistics(segmentID))
+            values = np.sort(self.volumeArray[self.labelArray == labelValue].astype(float))
+            self.assertEqual(calculator.GetVoxelCount(segmentID), len(values))
+            self.assertEqual(calculator.GetMinimum(segmentID), values[0])
+            self.assertEqual(calculator.GetMaximum(segmentID), values[-1])
+            self.assertAlmostEqual(calculator.GetMean(segmentID), values.mean(), places=6)
+            self.assertAlmostEqual(calculator.GetStandardDeviation(segmentID), values.std(ddof=1), places=6)
+            # Lower median for even number of values
+            self.assertEqual(calculator.GetMedian(segmentID), values[(len(values) + 1) // 2 - 1])
@@ -0,0 +1,129 @@
+import logging
+import time
+import unittest
+
+import numpy as np
+import vtk
+from vtk.util import numpy_support
+
+import slicer
+
+'''
+This class tests the grow-cut filter used by the Grow from seeds effect.
+The multithreaded shortest path computation is compared to the single-threaded
+Dijkstra's algorithm (the results must match) and computation times are logged.
+'''
+
+
+class SegmentationsGrowCutTest1(unittest.TestCase):
+
+    # ------------------------------------------------------------------------------
+    def setUp(self):
+        """ Do whatever is needed to reset the state - typically a scene clear will be enough.
+        """
+        slicer.mrmlScene.Clear(0)
+
+    # ------------------------------------------------------------------------------
+    def runTest(self):
+        """Run as few or as many tests as needed here.
+        """
+        self.setUp()
+        self.test_SegmentationsGrowCutTest1()
+
+    # ------------------------------------------------------------------------------
+    def test_SegmentationsGrowCutTest1(self):
+        self.TestSection_CreateInputData()
+        self.TestSection_CompareFullComputation()
+        self.TestSection_CompareUpdate()
+        self.TestSection_UpdateRegionMargin()
+        logging.info('Test finished')
+
+    # ------------------------------------------------------------------------------
+    def createImage(self, array, scalarType):
+        image = vtk.vtkImageData()
+        image.SetDimensions(array.shape[2], array.shape[1], array.shape[0])
+        image.AllocateScalars(scalarType, 1)
+        imageArray = numpy_support.vtk_to_numpy(image.GetPointData().GetScalars()).reshape(array.shape)
+        imageArray[:] = array
+        return image
+
+    # ------------------------------------------------------------------------------
+    def setSeed(self, center, labelValue):
+        z, y, x = center
+        self.seedArray[z - 2:z + 3, y - 2:y + 3, x - 2:x + 3] = labelValue
+        seedImageArray = numpy_support.vtk_to_numpy(self.seedImage.GetPointData().GetScalars())
+        seedImageArray[:] = self.seedArray.ravel()
+        self.seedImage.Modified()
+
+    # ------------------------------------------------------------------------------
+    def runGrowCut(self, growCutFilter, description):
+        startTime = time.time()
+        growCutFilter.Update()
+        logging.info(f'{description}: {time.time() - startTime:.3f} s')
+        resultImage = growCutFilter.GetOutput()
+        return numpy_support.vtk_to_numpy(resultImage.GetPointData().GetScalars()).reshape(self.seedArray.shape).copy()
+
+    # ------------------------------------------------------------------------------
+    def createGrowCutFilter(self, multithreaded):
+        import vtkSlicerSegmentationsModuleLogicPython as vtkSlicerSegmentationsModuleLogic
+        growCutFilter = vtkSlicerSegmentationsModuleLogic.vtkImageGrowCutSegment()
+        growCutFilter.SetIntensityVolume(self.intensityImage)
+        growCutFilter.SetSeedLabelVolume(self.seedImage)
+        growCutFilter.SetDistancePenalty(0.5)
+        growCutFilter.SetMultithreaded(multithreaded)
+        return growCutFilter
+
+    # ------------------------------------------------------------------------------
+    def TestSection_CreateInputData(self):
+        # Two noisy spheres of different intensity on a dark background
+        size = 100
+        z, y, x = np.mgrid[0:size, 0:size, 0:size]
+        intensityArray = np.zeros((size, size, size), dtype=np.int16)
+        intensityArray[(x - 35) ** 2 + (y - 35) ** 2 + (z - 35) ** 2 < 20 ** 2] = 200
+        intensityArray[(x - 65) ** 2 + (y - 65) ** 2 + (z - 60) ** 2 < 15 ** 2] = 400
+        intensityArray += np.random.RandomState(42).randint(-20, 21, intensityArray.shape).astype(np.int16)
+        self.intensityImage = self.createImage(intensityArray, vtk.VTK_SHORT)
+
+        self.seedArray = np.zeros((size, size, size), dtype=np.int16)
+        self.seedImage = self.createImage(self.seedArray, vtk.VTK_SHORT)
+        self.setSeed((35, 35, 35), 1)
+        self.setSeed((60, 65, 65), 2)
+        self.setSeed((10, 85, 10), 3)
+
+    # ------------------------------------------------------------------------------
+    def TestSection_CompareFullComputation(self):
+        self.singleThreadedFilter = self.createGrowCutFilter(False)
+        self.multithreadedFilter = self.createGrowCutFilter(True)
+        singleThreadedResult = self.runGrowCut(self.singleThreadedFilter, 'Full computation, single-threaded')
+        multithreadedResult = self.runGrowCut(self.multithreadedFilter, 'Full computation, multithreaded')
+
+        # Distances are the same, only voxels that are at the same distance from different labels may differ
+        self.assertEqual(set(np.unique(multithreadedResult)), {1, 2, 3})
+        self.assertLess(np.count_nonzero(singleThreadedResult != multithreadedResult), singleThreadedResult.size * 0.001)
+
+    # ------------------------------------------------------------------------------
+    def TestSection_CompareUpdate(self):
+        # Adding seeds only propagates labels from the new seeds
+        self.setSeed((85, 15, 85), 4)
+        self.setSeed((20, 50, 50), 2)
+        singleThreadedResult = self.runGrowCut(self.singleThreadedFilter, 'Update, single-threaded')
+        multithreadedResult = self.runGrowCut(self.multithreadedFilter, 'Update, multithreaded')
+        self.assertLess(np.count_nonzero(singleThreadedResult != multithreadedResult), singleThreadedResult.size * 0.001)
+
+        # Multithreaded update gives the same result as full computation
+        fullComputationFilter = self.createGrowCutFilter(True)
+        fullComputationResult = self.runGrowCut(fullComputationFilter, 'Full computation after update, multithreaded')
+        self.assertTrue(np.array_equal(fullComputationResult, multithreadedResult))
+        self.previousResult = multithreadedResult
+
+    # ------------------------------------------------------------------------------
+    def TestSection_UpdateRegionMargin(self):
+        # Voxels farther than the margin from the new seeds keep their label
+        margin = 10
+        self.multithreadedFilter.SetUpdateRegionMargin(margin)
+        self.setSeed((85, 85, 85), 1)
+        result = self.runGrowCut(self.multithreadedFilter, 'Update in region, multithreaded')
+        changedVoxels = np.argwhere(result != self.previousResult)
+        self.assertGreater(len(changedVoxels), 0)
+        self.assertGreaterEqual(changedVoxels.min(), 85 - 2 - margin)
+        self.assertLessEqual(changedVoxels.max(), 85 + 2 + margin)
@@ -350,6 +350,8 @@ class SegmentationsModuleTest1(unittest.TestCase):
         result = slicer.vtkSlicerSegmentationsModuleLogic.ImportLabelmapToSegmentationNode(allSegmentsLabelmapNode, multiLabelImportSegmentationNode)
         self.assertTrue(result)
         self.assertEqual(multiLabelImportSegmentationNode.GetSegmentation().GetNumberOfSegments(), 3)
+        # All labels are imported into one shared layer
+        self.assertEqual(multiLabelImportSegmentationNode.GetSegmentation().GetNumberOfLayers(), 1)
 
         # Import labelmap into single segment
         singleLabelImportSegmentationNode = slicer.mrmlScene.AddNewNodeByClass('vtkMRMLSegmentationNode', 'SingleLabelImport')
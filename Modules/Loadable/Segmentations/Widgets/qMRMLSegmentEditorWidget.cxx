@@ -114,6 +114,9 @@
 // CTK includes
 #include <ctkCollapsibleButton.h>
 
+// STD includes
+#include <algorithm>
+
 static const int BINARY_LABELMAP_SCALAR_TYPE = VTK_UNSIGNED_CHAR;
 // static const unsigned char BINARY_LABELMAP_VOXEL_FULL = 1; // unused
 static const unsigned char BINARY_LABELMAP_VOXEL_EMPTY = 0;
@@ -193,6 +196,10 @@ public:
 
   bool updateReferenceGeometryImage();
 
+  /// Get the latest modification time of the segmentation, its segments and their representations.
+  /// Used for detecting if the mask labelmap has to be updated.
+  static vtkMTimeType segmentationContentMTime(vtkSegmentation* segmentation);
+
   static std::string getReferenceImageGeometryFromSegmentation(vtkSegmentation* segmentation);
   std::string referenceImageGeometry();
 
@@ -273,6 +280,24 @@ public:
   vtkMRMLVolumeNode* AlignedSourceVolumeUpdateSourceVolumeNode;
   vtkMRMLTransformNode* AlignedSourceVolumeUpdateSourceVolumeNodeTransform;
   vtkMRMLTransformNode* AlignedSourceVolumeUpdateSegmentationNodeTransform;
+  vtkMTimeType AlignedSourceVolumeUpdateSourceVolumeNodeMTime;
+  vtkMTimeType AlignedSourceVolumeUpdateSourceImageDataMTime;
+  vtkMTimeType AlignedSourceVolumeUpdateSourceVolumeNodeTransformMTime;
+  vtkMTimeType AlignedSourceVolumeUpdateSegmentationNodeTransformMTime;
+  /// Modification time of AlignedSourceVolume after the update, to detect if it was changed since then
+  vtkMTimeType AlignedSourceVolumeUpdateMTime;
+
+  /// Input data that is used for computing MaskLabelmap.
+  /// It is stored so that the mask is only regenerated when the segments or masking settings change.
+  vtkMRMLSegmentationNode* MaskLabelmapUpdateSegmentationNode;
+  std::string MaskLabelmapUpdateReferenceGeometry;
+  int MaskLabelmapUpdateMaskMode;
+  std::string MaskLabelmapUpdateSelectedSegmentID;
+  std::string MaskLabelmapUpdateMaskSegmentID;
+  vtkMTimeType MaskLabelmapUpdateSegmentationMTime;
+  vtkMTimeType MaskLabelmapUpdateDisplayNodeMTime;
+  /// Modification time of MaskLabelmap after the update, to detect if it was changed since then
+  vtkMTimeType MaskLabelmapUpdateMTime;
 
   int MaskModeComboBoxFixedItemsCount;
 
@@ -313,6 +338,16 @@ qMRMLSegmentEditorWidgetPrivate::qMRMLSegmentEditorWidgetPrivate(qMRMLSegmentEdi
   , AlignedSourceVolumeUpdateSourceVolumeNode(nullptr)
   , AlignedSourceVolumeUpdateSourceVolumeNodeTransform(nullptr)
   , AlignedSourceVolumeUpdateSegmentationNodeTransform(nullptr)
+  , AlignedSourceVolumeUpdateSourceVolumeNodeMTime(0)
+  , AlignedSourceVolumeUpdateSourceImageDataMTime(0)
+  , AlignedSourceVolumeUpdateSourceVolumeNodeTransformMTime(0)
+  , AlignedSourceVolumeUpdateSegmentationNodeTransformMTime(0)
+  , AlignedSourceVolumeUpdateMTime(0)
+  , MaskLabelmapUpdateSegmentationNode(nullptr)
+  , MaskLabelmapUpdateMaskMode(-1)
+  , MaskLabelmapUpdateSegmentationMTime(0)
+  , MaskLabelmapUpdateDisplayNodeMTime(0)
+  , MaskLabelmapUpdateMTime(0)
   , MaskModeComboBoxFixedItemsCount(0)
   , EffectButtonStyle(Qt::ToolButtonIconOnly)
   , RotateWarningInNodeSelectorLayout(true)
@@ -659,22 +694,15 @@ bool qMRMLSegmentEditorWidgetPrivate::updateAlignedSourceVolume()
     && this->AlignedSourceVolumeUpdateSourceVolumeNodeTransform == sourceVolumeNode->GetParentTransformNode()
     && this->AlignedSourceVolumeUpdateSegmentationNodeTransform == segmentationNode->GetParentTransformNode() )
     {
-    // Extents and nodes are matching, check if they have not been modified since the aligned master
+    // Extents and nodes are matching, check if they have not been modified since the aligned source
     // volume generation.
-    bool updateAlignedSourceVolumeRequired = false;
-    if (sourceVolumeNode->GetMTime() > this->AlignedSourceVolume->GetMTime())
-      {
-      updateAlignedSourceVolumeRequired = true;
-      }
-    else if (sourceVolumeNode->GetParentTransformNode() && sourceVolumeNode->GetParentTransformNode()->GetMTime() > this->AlignedSourceVolume->GetMTime())
-      {
-      updateAlignedSourceVolumeRequired = true;
-      }
-    else if (segmentationNode->GetParentTransformNode() && segmentationNode->GetParentTransformNode()->GetMTime() > this->AlignedSourceVolume->GetMTime())
-      {
-      updateAlignedSourceVolumeRequired = true;
-      }
-    if (!updateAlignedSourceVolumeRequired)
+    if (this->AlignedSourceVolumeUpdateSourceVolumeNodeMTime == sourceVolumeNode->GetMTime()
+      && this->AlignedSourceVolumeUpdateSourceImageDataMTime == sourceVolumeNode->GetImageData()->GetMTime()
+      && this->AlignedSourceVolumeUpdateSourceVolumeNodeTransformMTime ==
+        (sourceVolumeNode->GetParentTransformNode() ? sourceVolumeNode->GetParentTransformNode()->GetMTime() : 0)
+      && this->AlignedSourceVolumeUpdateSegmentationNodeTransformMTime ==
+        (segmentationNode->GetParentTransformNode() ? segmentationNode->GetParentTransformNode()->GetMTime() : 0)
+      && this->AlignedSourceVolumeUpdateMTime == this->AlignedSourceVolume->GetMTime())
       {
       return true;
       }
@@ -710,6 +738,13 @@ bool qMRMLSegmentEditorWidgetPrivate::updateAlignedSourceVolume()
   this->AlignedSourceVolumeUpdateSourceVolumeNode = sourceVolumeNode;
   this->AlignedSourceVolumeUpdateSourceVolumeNodeTransform = sourceVolumeNode->GetParentTransformNode();
   this->AlignedSourceVolumeUpdateSegmentationNodeTransform = segmentationNode->GetParentTransformNode();
+  this->AlignedSourceVolumeUpdateSourceVolumeNodeMTime = sourceVolumeNode->GetMTime();
+  this->AlignedSourceVolumeUpdateSourceImageDataMTime = sourceVolumeNode->GetImageData()->GetMTime();
+  this->AlignedSourceVolumeUpdateSourceVolumeNodeTransformMTime =
+    (sourceVolumeNode->GetParentTransformNode() ? sourceVolumeNode->GetParentTransformNode()->GetMTime() : 0);
+  this->AlignedSourceVolumeUpdateSegmentationNodeTransformMTime =
+    (segmentationNode->GetParentTransformNode() ? segmentationNode->GetParentTransformNode()->GetMTime() : 0);
+  this->AlignedSourceVolumeUpdateMTime = this->AlignedSourceVolume->GetMTime();
 
   return true;
 }
@@ -735,6 +770,32 @@ bool qMRMLSegmentEditorWidgetPrivate::updateMaskLabelmap()
     qCritical() << Q_FUNC_INFO << ": Cannot determine mask labelmap geometry";
     return false;
     }
+
+  // The mask only depends on the segments and masking settings, so it is not regenerated
+  // if none of them has changed since the last update.
+  int maskMode = this->ParameterSetNode->GetMaskMode();
+  bool visibleSegmentsMask = (maskMode == vtkMRMLSegmentationNode::EditAllowedInsideVisibleSegments
+    || maskMode == vtkMRMLSegmentationNode::EditAllowedOutsideVisibleSegments);
+  bool outsideSegmentsMask = (maskMode == vtkMRMLSegmentationNode::EditAllowedOutsideAllSegments
+    || maskMode == vtkMRMLSegmentationNode::EditAllowedOutsideVisibleSegments);
+  // Selected segment is only used when editing is allowed outside segments (it is excluded from the mask)
+  std::string selectedSegmentID = (outsideSegmentsMask && this->ParameterSetNode->GetSelectedSegmentID()) ?
+    this->ParameterSetNode->GetSelectedSegmentID() : "";
+  std::string maskSegmentID = this->ParameterSetNode->GetMaskSegmentID() ? this->ParameterSetNode->GetMaskSegmentID() : "";
+  vtkMTimeType segmentationMTime = qMRMLSegmentEditorWidgetPrivate::segmentationContentMTime(segmentationNode->GetSegmentation());
+  vtkMTimeType displayNodeMTime = (visibleSegmentsMask && segmentationNode->GetDisplayNode()) ? segmentationNode->GetDisplayNode()->GetMTime() : 0;
+  if (this->MaskLabelmapUpdateSegmentationNode == segmentationNode
+    && this->MaskLabelmapUpdateReferenceGeometry == referenceGeometryStr
+    && this->MaskLabelmapUpdateMaskMode == maskMode
+    && this->MaskLabelmapUpdateSelectedSegmentID == selectedSegmentID
+    && this->MaskLabelmapUpdateMaskSegmentID == maskSegmentID
+    && this->MaskLabelmapUpdateSegmentationMTime == segmentationMTime
+    && this->MaskLabelmapUpdateDisplayNodeMTime == displayNodeMTime
+    && this->MaskLabelmapUpdateMTime == this->MaskLabelmap->GetMTime())
+    {
+    return true;
+    }
+
   vtkNew<vtkOrientedImageData> referenceGeometry;
   if (!vtkSegmentationConverter::DeserializeImageGeometry(referenceGeometryStr, referenceGeometry, false))
     {
@@ -746,16 +807,50 @@ bool qMRMLSegmentEditorWidgetPrivate::updateMaskLabelmap()
   // editable intensity range is taken into account in qSlicerSegmentEditorAbstractEffect::modifySelectedSegmentByLabelmap.
   // It would simplify implementation if we passed source volume and intensity range to GenerateEditMask here
   // and removed intensity range based masking from modifySelectedSegmentByLabelmap.
-  if (!segmentationNode->GenerateEditMask(this->MaskLabelmap, this->ParameterSetNode->GetMaskMode(), referenceGeometry,
-    this->ParameterSetNode->GetSelectedSegmentID() ? this->ParameterSetNode->GetSelectedSegmentID() : "",
-    this->ParameterSetNode->GetMaskSegmentID() ? this->ParameterSetNode->GetMaskSegmentID() : ""))
+  if (!segmentationNode->GenerateEditMask(this->MaskLabelmap, maskMode, referenceGeometry, selectedSegmentID, maskSegmentID))
     {
     qCritical() << Q_FUNC_INFO << ": Mask generation failed";
+    this->MaskLabelmapUpdateSegmentationNode = nullptr;
     return false;
     }
+
+  this->MaskLabelmapUpdateSegmentationNode = segmentationNode;
+  this->MaskLabelmapUpdateReferenceGeometry = referenceGeometryStr;
+  this->MaskLabelmapUpdateMaskMode = maskMode;
+  this->MaskLabelmapUpdateSelectedSegmentID = selectedSegmentID;
+  this->MaskLabelmapUpdateMaskSegmentID = maskSegmentID;
+  this->MaskLabelmapUpdateSegmentationMTime = segmentationMTime;
+  this->MaskLabelmapUpdateDisplayNodeMTime = displayNodeMTime;
+  this->MaskLabelmapUpdateMTime = this->MaskLabelmap->GetMTime();
   return true;
 }
 
+//-----------------------------------------------------------------------------
+vtkMTimeType qMRMLSegmentEditorWidgetPrivate::segmentationContentMTime(vtkSegmentation* segmentation)
+{
+  if (!segmentation)
+    {
+    return 0;
+    }
+  vtkMTimeType mtime = segmentation->GetMTime();
+  std::vector<std::string> representationNames;
+  segmentation->GetContainedRepresentationNames(representationNames);
+  for (int segmentIndex = 0; segmentIndex < segmentation->GetNumberOfSegments(); ++segmentIndex)
+    {
+    vtkSegment* segment = segmentation->GetNthSegment(segmentIndex);
+    mtime = std::max(mtime, segment->GetMTime());
+    for (const std::string& representationName : representationNames)
+      {
+      vtkDataObject* representation = segment->GetRepresentation(representationName);
+      if (representation)
+        {
+        mtime = std::max(mtime, representation->GetMTime());
+        }
+      }
+    }
+  return mtime;
+}
+
 //-----------------------------------------------------------------------------
 bool qMRMLSegmentEditorWidgetPrivate::updateReferenceGeometryImage()
 {
@@ -449,11 +449,18 @@ class SegmentStatisticsLogic(ScriptedLoadableModuleLogic):
             if visibleSegmentIds.GetNumberOfValues() == 0:
                 logging.debug("computeStatistics will not return any results: there are no visible segments")
 
+            # let plugins compute all segments at once
+            segmentIDs = [visibleSegmentIds.GetValue(segmentIndex) for segmentIndex in range(visibleSegmentIds.GetNumberOfValues())]
+            for plugin in self.plugins:
+                if self.getParameterNode().GetParameter(plugin.__class__.__name__ + '.enabled') == 'True':
+                    plugin.prepareStatistics(segmentIDs)
+
             # update statistics for all segment IDs
-            for segmentIndex in range(visibleSegmentIds.GetNumberOfValues()):
-                segmentID = visibleSegmentIds.GetValue(segmentIndex)
+            for segmentID in segmentIDs:
                 self.updateStatisticsForSegment(segmentID)
         finally:
+            for plugin in self.plugins:
+                plugin.clearPreparedStatistics()
             if transformedSegmentationNode is not None:
                 # We made a copy and hardened the segmentation transform
                 self.getParameterNode().SetParameter("Segmentation", segmentationNode.GetID())
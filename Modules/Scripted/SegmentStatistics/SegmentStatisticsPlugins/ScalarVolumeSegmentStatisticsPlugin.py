@@ -11,8 +11,39 @@ class ScalarVolumeSegmentStatisticsPlugin(SegmentStatisticsPluginBase):
         self.name = "Scalar Volume"
         self.keys = ["voxel_count", "volume_mm3", "volume_cm3", "min", "max", "mean", "median", "stdev"]
         self.defaultKeys = self.keys  # calculate all measurements by default
+        self.preparedStatistics = None
         # ... developer may add extra options to configure other parameters
 
+    def prepareStatistics(self, segmentIDs):
+        """Compute statistics of all segments at once, in a single pass over each labelmap layer"""
+        self.preparedStatistics = None
+        if len(self.getRequestedKeys()) == 0:
+            return
+
+        segmentationNode = slicer.mrmlScene.GetNodeByID(self.getParameterNode().GetParameter("Segmentation"))
+        grayscaleNode = slicer.mrmlScene.GetNodeByID(self.getParameterNode().GetParameter("ScalarVolume"))
+        if (not segmentationNode or not grayscaleNode
+            or not grayscaleNode.GetImageData()
+            or not grayscaleNode.GetImageData().GetPointData()
+                or not grayscaleNode.GetImageData().GetPointData().GetScalars()):
+            return
+        if not segmentationNode.GetSegmentation().ContainsRepresentation(
+                slicer.vtkSegmentationConverter.GetSegmentationBinaryLabelmapRepresentationName()):
+            return
+
+        calculator = slicer.vtkSlicerSegmentStatisticsCalculator()
+        calculator.SetSegmentationNode(segmentationNode)
+        calculator.SetScalarVolumeNode(grayscaleNode)
+        segmentIDsArray = vtk.vtkStringArray()
+        for segmentID in segmentIDs:
+            segmentIDsArray.InsertNextValue(segmentID)
+        calculator.SetSegmentIDs(segmentIDsArray)
+        calculator.Compute()
+        self.preparedStatistics = calculator
+
+    def clearPreparedStatistics(self):
+        self.preparedStatistics = None
+
     def computeStatistics(self, segmentID):
         requestedKeys = self.getRequestedKeys()
 
@@ -22,6 +53,9 @@ class ScalarVolumeSegmentStatisticsPlugin(SegmentStatisticsPluginBase):
         if len(requestedKeys) == 0:
             return {}
 
+        if self.preparedStatistics and self.preparedStatistics.HasStatistics(segmentID):
+            return self.getPreparedStatistics(segmentID, requestedKeys)
+
         stencil = self.getStencilForVolume(segmentationNode, segmentID, grayscaleNode)
         if not stencil:
             return {}
@@ -60,6 +94,28 @@ class ScalarVolumeSegmentStatisticsPlugin(SegmentStatisticsPluginBase):
                 stats["median"] = medians.GetMedian()
         return stats
 
+    def getPreparedStatistics(self, segmentID, requestedKeys):
+        calculator = self.preparedStatistics
+        stats = {}
+        if "voxel_count" in requestedKeys:
+            stats["voxel_count"] = calculator.GetVoxelCount(segmentID)
+        if "volume_mm3" in requestedKeys:
+            stats["volume_mm3"] = calculator.GetVolumeMm3(segmentID)
+        if "volume_cm3" in requestedKeys:
+            stats["volume_cm3"] = calculator.GetVolumeCm3(segmentID)
+        if calculator.HasScalarStatistics(segmentID):
+            if "min" in requestedKeys:
+                stats["min"] = calculator.GetMinimum(segmentID)
+            if "max" in requestedKeys:
+                stats["max"] = calculator.GetMaximum(segmentID)
+            if "mean" in requestedKeys:
+                stats["mean"] = calculator.GetMean(segmentID)
+            if "stdev" in requestedKeys:
+                stats["stdev"] = calculator.GetStandardDeviation(segmentID)
+            if "median" in requestedKeys:
+                stats["median"] = calculator.GetMedian(segmentID)
+        return stats
+
     def getStencilForVolume(self, segmentationNode, segmentID, grayscaleNode):
         import vtkSegmentationCorePython as vtkSegmentationCore
 
@@ -58,6 +58,16 @@ class SegmentStatisticsPluginBase:
         """
         pass
 
+    def prepareStatistics(self, segmentIDs):
+        """Called before computeStatistics is called for each segment in segmentIDs.
+        Plugins may compute measurements of all the segments at once here and return them in computeStatistics.
+        """
+        pass
+
+    def clearPreparedStatistics(self):
+        """Called after all segments are processed, to release results of prepareStatistics"""
+        pass
+
     def getMeasurementInfo(self, key):
         """Get information (name, description, units, ...) about the measurement for the given key.
         Utilize createMeasurementInfo() to create the dictionary containing the measurement information.